@@ -0,0 +1,135 @@
+/**
+ *   StrokeEngine
+ *   A library to create a variety of stroking motions with a stepper or servo
+ * motor on an ESP32. https://github.com/theelims/StrokeEngine
+ *
+ * Copyright (C) 2022 theelims <elims@gmx.net>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license.  See the LICENSE file for details.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+
+/**************************************************************************/
+/*!
+  @brief  Ways a commanded motion can violate the machine physics
+*/
+/**************************************************************************/
+typedef enum {
+    CLIP_SPEED,         //!< Speed re-planned to the limit [steps/s]
+    CLIP_ACCELERATION,  //!< Acceleration re-planned to the limit [steps/s²]
+    CLIP_DURATION,      //!< Move stretched beyond its time [µs]
+    CLIP_RETARGET,      //!< Acceleration raised to brake in time [steps/s²]
+    CLIP_REJECTED,      //!< Servo refused a queue command, limited is 0
+    CLIP_TYPES
+} ClipType;
+
+/**************************************************************************/
+/*!
+  @brief  One clipped motion, in the units of its type
+*/
+/**************************************************************************/
+typedef struct {
+    int64_t time;       //!< esp_timer time of the clip in [µs]
+    int32_t requested;  //!< What the motion asked for
+    int32_t limited;    //!< What it got instead
+    uint8_t type;       //!< ClipType
+} ClipEvent;
+
+/**************************************************************************/
+/*!
+  @brief  Clip events of a session, counted by type
+*/
+/**************************************************************************/
+typedef struct {
+    uint32_t events[CLIP_TYPES];  //!< Clips of each ClipType
+    uint32_t dropped;             //!< Events lost because the trace was full
+} ClipCounters;
+
+/**************************************************************************/
+/*!
+  @brief  Records clipped motions without blocking the motion task. Every
+  event is counted, and while tracing is on it is also copied into a ring
+  for a slower task to format and print. The motion task is the only
+  producer and the printing task the only consumer, so neither of them ever
+  waits or allocates. Events that don't fit into the ring are only counted.
+  Capacity must be a power of two.
+*/
+/**************************************************************************/
+template <size_t Capacity = 32>
+class ClipLog {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0,
+                  "ClipLog capacity must be a power of two");
+
+  public:
+    //! Copies events into the ring from now on, or only counts them
+    void setTracing(bool isTracing) {
+        _isTracing.store(isTracing, std::memory_order_relaxed);
+    }
+
+    //! Clears the counters, events in the ring stay
+    void reset() {
+        for (size_t i = 0; i < CLIP_TYPES; i++) {
+            _events[i].store(0, std::memory_order_relaxed);
+        }
+        _dropped.store(0, std::memory_order_relaxed);
+    }
+
+    //! A motion was clipped. Only called from the motion task.
+    void record(ClipType type, int32_t requested, int32_t limited,
+                int64_t time) {
+        if (type >= CLIP_TYPES) {
+            return;
+        }
+        _events[type].fetch_add(1, std::memory_order_relaxed);
+        if (_isTracing.load(std::memory_order_relaxed) == false) {
+            return;
+        }
+
+        size_t head = _head.load(std::memory_order_relaxed);
+        if (head - _tail.load(std::memory_order_acquire) == Capacity) {
+            _dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        ClipEvent &event = _ring[head & (Capacity - 1)];
+        event.time = time;
+        event.requested = requested;
+        event.limited = limited;
+        event.type = type;
+        _head.store(head + 1, std::memory_order_release);
+    }
+
+    //! Oldest event of the trace, false if there is none. Only one task
+    //! may take events.
+    bool pop(ClipEvent &event) {
+        size_t tail = _tail.load(std::memory_order_relaxed);
+        if (_head.load(std::memory_order_acquire) == tail) {
+            return false;
+        }
+        event = _ring[tail & (Capacity - 1)];
+        _tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    //! Copies the counters, safe to call from any task
+    void getCounters(ClipCounters *counters) const {
+        for (size_t i = 0; i < CLIP_TYPES; i++) {
+            counters->events[i] = _events[i].load(std::memory_order_relaxed);
+        }
+        counters->dropped = _dropped.load(std::memory_order_relaxed);
+    }
+
+  private:
+    ClipEvent _ring[Capacity] = {};
+    std::atomic<size_t> _head{0};
+    std::atomic<size_t> _tail{0};
+    std::atomic<bool> _isTracing{false};
+    std::atomic<uint32_t> _events[CLIP_TYPES] = {};
+    std::atomic<uint32_t> _dropped{0};
+};
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <stdint.h>
+
+/**************************************************************************/
+/*!
+  @brief  Q16.16 fixed-point kernel for the per-stroke pattern math. Values
+  are stored in an int32_t with 16 fractional bits.
+
+  Patterns divide distances and speeds by stroke times. Instead of carrying
+  the time, they keep its reciprocal (a rate in 1/s) in Q16.16, computed once
+  whenever the time changes, so nextTarget() only needs integer multiplies
+  and shifts. Quantizing the rate is off by at most 2^-17 1/s, which keeps
+  results within one step of the float math for the speeds the machine can
+  run (below 40000 steps/s).
+*/
+/**************************************************************************/
+typedef int32_t q16_t;
+
+//! 1.0 in Q16.16
+constexpr q16_t Q16_ONE = 65536;
+
+/**************************************************************************/
+/*!
+  @brief  Converts to Q16.16 with rounding. Usable for constants.
+  @param value  value in the range of -32768 to 32767
+  @returns value in Q16.16
+*/
+/**************************************************************************/
+constexpr q16_t toQ16(double value) {
+    return q16_t(value * Q16_ONE + (value >= 0 ? 0.5 : -0.5));
+}
+
+/**************************************************************************/
+/*!
+  @brief  Converts back from Q16.16.
+  @param value  value in Q16.16
+  @returns value as float
+*/
+/**************************************************************************/
+inline float fromQ16(q16_t value) { return float(value) / Q16_ONE; }
+
+/**************************************************************************/
+/*!
+  @brief  Rate of a move that takes a given time.
+  @param seconds  duration in [s], at least 1/32767 s
+  @returns 1 / seconds in [1/s] and Q16.16. 0 for non-positive durations.
+*/
+/**************************************************************************/
+inline q16_t q16Rate(float seconds) {
+    if (seconds <= 0.0f) {
+        return 0;
+    }
+    return toQ16(1.0 / seconds);
+}
+
+/**************************************************************************/
+/*!
+  @brief  Multiplies an integer with a Q16.16 value and truncates towards
+  zero, like int(value * fraction) would.
+  @param value     integer, e.g. a distance in [steps]
+  @param fraction  factor in Q16.16
+  @returns value * fraction as integer
+*/
+/**************************************************************************/
+inline int q16Multiply(int value, q16_t fraction) {
+    int64_t product = int64_t(value) * fraction;
+    return product >= 0 ? int(product >> 16) : -int((-product) >> 16);
+}
+
+/**************************************************************************/
+/*!
+  @brief  The core of every pattern: int(factor * value / time) with the time
+  given as rate. Covers speeds (value is a distance) as well as accelerations
+  (value is a speed).
+  @param value   integer, e.g. a distance in [steps] or a speed in [steps/s]
+  @param factor  profile factor in Q16.16, e.g. toQ16(1.5) for the top speed
+                 of a 1/3 trapezoid
+  @param rate    reciprocal of the time in [1/s] and Q16.16, see q16Rate()
+  @returns factor * value * rate as integer, truncated towards zero
+*/
+/**************************************************************************/
+inline int q16Scale(int value, q16_t factor, q16_t rate) {
+    int64_t product = int64_t(value) * factor * rate;
+    return product >= 0 ? int(product >> 32) : -int((-product) >> 32);
+}
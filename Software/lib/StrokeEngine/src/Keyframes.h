@@ -0,0 +1,91 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**************************************************************************/
+/*!
+  @brief  Keyframe tables describe a pattern as a cycle of moves, so clients
+  can upload patterns without new firmware. Points are normalized: positions
+  are a percentage of the stroke, durations share the time of a stroke, so
+  the same table follows stroke, depth and speed like any other pattern.
+
+  Binary format, little endian:
+    uint8_t  version     KEYFRAME_VERSION
+    uint8_t  count       number of points, 2 to KEYFRAME_MAX_POINTS
+    count times:
+      uint8_t  position  0 - 100 % of the stroke, 100 is at depth
+      uint8_t  accel     % of the move spent accelerating and again braking,
+                         1 - 50, 0 for a third like SimpleStroke
+      uint16_t time      relative duration of the move towards this point,
+                         at least 1
+
+  The cycle starts with the move towards the first point and wraps around
+  from the last to the first.
+*/
+/**************************************************************************/
+#define KEYFRAME_VERSION 1
+#define KEYFRAME_MAX_POINTS 64
+
+typedef struct {
+    uint8_t position;
+    uint8_t accel;
+    uint16_t time;
+} KeyframePoint;
+
+typedef struct {
+    uint8_t count;
+    KeyframePoint points[KEYFRAME_MAX_POINTS];
+} KeyframeTable;
+
+/**************************************************************************/
+/*!
+  @brief  Two points with the trapezoid of SimpleStroke, the table played
+  until a client uploads one.
+*/
+/**************************************************************************/
+inline KeyframeTable defaultKeyframes() {
+    KeyframeTable table = {};
+    table.count = 2;
+    table.points[0] = {100, 0, 1};
+    table.points[1] = {0, 0, 1};
+    return table;
+}
+
+/**************************************************************************/
+/*!
+  @brief  Decodes and validates an uploaded table.
+  @param data  received bytes
+  @param length  number of bytes, exactly 2 + 4 * count
+  @param table  filled with the points, untouched if invalid
+  @returns true if the table is valid
+*/
+/**************************************************************************/
+inline bool decodeKeyframes(const uint8_t *data, size_t length,
+                            KeyframeTable &table) {
+    if (length < 2 || data[0] != KEYFRAME_VERSION) {
+        return false;
+    }
+    uint8_t count = data[1];
+    if (count < 2 || count > KEYFRAME_MAX_POINTS ||
+        length != 2 + 4 * (size_t)count) {
+        return false;
+    }
+
+    KeyframeTable decoded = {};
+    decoded.count = count;
+    for (int i = 0; i < count; i++) {
+        const uint8_t *point = data + 2 + 4 * i;
+        KeyframePoint &keyframe = decoded.points[i];
+        keyframe.position = point[0];
+        keyframe.accel = point[1];
+        keyframe.time = point[2] | (point[3] << 8);
+        if (keyframe.position > 100 || keyframe.accel > 50 ||
+            keyframe.time == 0) {
+            return false;
+        }
+    }
+
+    table = decoded;
+    return true;
+}
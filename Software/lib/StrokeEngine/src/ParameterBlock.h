@@ -0,0 +1,64 @@
+/**
+ *   StrokeEngine
+ *   A library to create a variety of stroking motions with a stepper or servo
+ * motor on an ESP32. https://github.com/theelims/StrokeEngine
+ *
+ * Copyright (C) 2022 theelims <elims@gmx.net>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license.  See the LICENSE file for details.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include <atomic>
+
+/**************************************************************************/
+/*!
+  @brief  Hands a block of parameters from one writer to one reader without
+  either of them ever waiting. The writer fills its back buffer and publishes
+  it by swapping it with the spare one, the reader takes the latest published
+  block by swapping the spare with its front buffer. With three buffers the
+  one being read is never written, and the swaps are single atomic
+  exchanges. Blocks published faster than the reader takes them are
+  replaced, the reader always gets the latest.
+*/
+/**************************************************************************/
+template <typename T>
+class ParameterBlock {
+  public:
+    //! Writer side: publishes a new block
+    void publish(const T &block) {
+        _buffers[_back] = block;
+        uint8_t spare =
+            _spare.exchange(_back | _fresh, std::memory_order_acq_rel);
+        _back = spare & _index;
+    }
+
+    //! True if a block was published since the last take()
+    bool isFresh() const {
+        return (_spare.load(std::memory_order_acquire) & _fresh) != 0;
+    }
+
+    //! Reader side: copies the latest block, false if there is nothing new
+    bool take(T &block) {
+        if (isFresh() == false) {
+            return false;
+        }
+        uint8_t spare = _spare.exchange(_front, std::memory_order_acq_rel);
+        _front = spare & _index;
+        block = _buffers[_front];
+        return true;
+    }
+
+  private:
+    static constexpr uint8_t _index = 0x03;
+    static constexpr uint8_t _fresh = 0x04;
+
+    T _buffers[3] = {};
+    uint8_t _back = 0;   // Only touched by the writer
+    uint8_t _front = 1;  // Only touched by the reader
+    std::atomic<uint8_t> _spare{2};
+};
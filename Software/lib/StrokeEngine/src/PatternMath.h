@@ -137,4 +137,248 @@ inline float mapSensationToFactor(float maximumFactor, float inputValue, float c
     
 }
 
+/**************************************************************************/
+/*!
+  @class FscaleTable
+  @brief  Table-driven fscale() over the input range 0 to 100 for a fixed
+  output range and curve. The table is filled once with fscale() and lookups
+  interpolate linearly between the entries, so no pow() is evaluated per call.
+  With curve = 0 the mapping is linear and the lookup is exact. Positive
+  curves rise steeply near 0, that first interval is the least accurate.
+  @tparam Size  number of table entries, at least 2
+*/
+/**************************************************************************/
+template <int Size = 65>
+class FscaleTable {
+    static_assert(Size >= 2, "FscaleTable needs at least 2 entries");
+
+  public:
+    //! Constructor
+    /*!
+      @param newBegin the value 0 gets mapped to
+      @param newEnd   the value 100 gets mapped to
+      @param curve    curve as in fscale(), from -10 to 10
+    */
+    FscaleTable(float newBegin, float newEnd, float curve = 0.0) {
+        for (int i = 0; i < Size; i++) {
+            _table[i] = fscale(0.0, 100.0, newBegin, newEnd,
+                               100.0 * i / (Size - 1), curve);
+        }
+    }
+
+    /*!
+      @param inputValue value from 0 to 100, constrained to that range
+      @returns same as fscale(0.0, 100.0, newBegin, newEnd, inputValue, curve)
+    */
+    float operator()(float inputValue) const {
+        if (inputValue <= 0.0) {
+            return _table[0];
+        }
+        if (inputValue >= 100.0) {
+            return _table[Size - 1];
+        }
+
+        float position = inputValue * ((Size - 1) / 100.0f);
+        int index = int(position);
+        float fraction = position - index;
+        return _table[index] + (_table[index + 1] - _table[index]) * fraction;
+    }
+
+  protected:
+    float _table[Size];
+};
+
+/**************************************************************************/
+/*!
+  @class SensationTable
+  @brief  Table-driven mapSensationToFactor() for a fixed maximumFactor and
+  curve. Built once, e.g. when a pattern is constructed, each lookup is an
+  interpolation between two entries instead of two pow() calls.
+  @tparam Size  number of table entries over the sensation range 0 to 100
+*/
+/**************************************************************************/
+template <int Size = 65>
+class SensationTable {
+  public:
+    //! Constructor
+    /*!
+      @param maximumFactor  the factor +100 gets mapped to. Should be > 1.0
+      @param curve          curve as in mapSensationToFactor()
+    */
+    SensationTable(float maximumFactor, float curve = 0.0)
+        : _scale(1.0, maximumFactor, curve) {}
+
+    /*!
+      @param inputValue  sensation from -100 to 100
+      @returns same as mapSensationToFactor(maximumFactor, inputValue, curve)
+    */
+    float operator()(float inputValue) const {
+        if (inputValue == 0.0) {
+            return 1.0;
+        }
+
+        float factor = _scale(fabs(inputValue));
+        return inputValue > 0.0 ? factor : 1.0 / factor;
+    }
+
+  protected:
+    FscaleTable<Size> _scale;
+};
+
+/**************************************************************************/
+/*!
+  @brief  Predicts the time a trapezoidal move needs to complete. It mirrors
+  the ramp generator of FastAccelStepper: accelerate with a constant rate up to
+  the top speed, cruise and decelerate to a full stop at the target. The move
+  may start with an initial speed. A negative initial speed denotes a motion
+  away from the target, which has to be stopped first.
+  @param distance       distance to the target in [steps], sign is ignored
+  @param speed          top speed in [steps/s]
+  @param acceleration   acceleration and deceleration in [steps/s²]
+  @param startSpeed     initial speed in [steps/s] towards the target.
+                        Defaults to 0 for a move from standstill.
+  @returns time until standstill at the target in [s]
+*/
+/**************************************************************************/
+inline float trapezoidalMoveTime(float distance, float speed, float acceleration, float startSpeed = 0.0) {
+  distance = fabs(distance);
+
+  if (speed <= 0.0 || acceleration <= 0.0) {
+    return 0.0;
+  }
+
+  float time = 0.0;
+
+  // Moving away from the target: stop first and start over from standstill
+  if (startSpeed < 0.0) {
+    time += -startSpeed / acceleration;
+    distance += (startSpeed * startSpeed) / (2.0 * acceleration);
+    startSpeed = 0.0;
+  }
+
+  // Faster than the top speed: the ramp generator decelerates to top speed
+  if (startSpeed > speed) {
+    startSpeed = speed;
+  }
+
+  // Too fast to stop in time: overshoot and come back from standstill
+  float stoppingDistance = (startSpeed * startSpeed) / (2.0 * acceleration);
+  if (stoppingDistance > distance) {
+    return time + startSpeed / acceleration +
+           trapezoidalMoveTime(stoppingDistance - distance, speed, acceleration);
+  }
+
+  // Peak speed of a triangular profile
+  float peakSpeed = sqrt(acceleration * distance + 0.5 * startSpeed * startSpeed);
+
+  if (peakSpeed <= speed) {
+    return time + (2.0 * peakSpeed - startSpeed) / acceleration;
+  }
+
+  // Full trapezoid with a cruising phase at top speed
+  float rampUpDistance = (speed * speed - startSpeed * startSpeed) / (2.0 * acceleration);
+  float rampDownDistance = (speed * speed) / (2.0 * acceleration);
+
+  return time + (speed - startSpeed) / acceleration + speed / acceleration +
+         (distance - rampUpDistance - rampDownDistance) / speed;
+}
+
+/**************************************************************************/
+/*!
+  @brief  Fits a trapezoidal move into the limits of the machine. A pattern
+  asking for too much speed or acceleration would otherwise be clamped and
+  take longer than planned. The first choice is a profile that still takes
+  the requested time, using the requested acceleration or, if that isn't
+  enough, the maximum acceleration. If the time can't be met at all, the
+  time-optimal profile at the limits is taken instead.
+  @param distance         distance of the move in [steps], sign is ignored
+  @param time             requested duration of the move in [s]
+  @param maxSpeed         top speed of the machine in [steps/s]
+  @param maxAcceleration  top acceleration of the machine in [steps/s²]
+  @param speed            requested speed in [steps/s], replaced by the
+                          speed of the fitted profile
+  @param acceleration     requested acceleration in [steps/s²], replaced by
+                          the acceleration of the fitted profile
+  @returns achievable duration of the move in [s], equal to time if the
+           requested rhythm can be kept
+*/
+/**************************************************************************/
+inline float planWithinLimits(float distance, float time, float maxSpeed,
+                              float maxAcceleration, float &speed,
+                              float &acceleration) {
+  distance = fabs(distance);
+
+  if (speed <= maxSpeed && acceleration <= maxAcceleration) {
+    return time;
+  }
+
+  if (distance == 0.0 || maxSpeed <= 0.0 || maxAcceleration <= 0.0) {
+    speed = fmin(speed, maxSpeed);
+    acceleration = fmin(acceleration, maxAcceleration);
+    return time;
+  }
 
+  // Same duration with a different shape: the top speed of a trapezoid with
+  // a given acceleration a and time T is (aT - sqrt(a²T² - 4ad)) / 2
+  const float candidates[2] = {fmin(acceleration, maxAcceleration),
+                               maxAcceleration};
+  for (float a : candidates) {
+    float discriminant = a * a * time * time - 4.0 * a * distance;
+    if (time > 0.0 && discriminant >= 0.0) {
+      float v = 0.5 * (a * time - sqrt(discriminant));
+      if (v <= maxSpeed) {
+        speed = v;
+        acceleration = a;
+        return time;
+      }
+    }
+  }
+
+  // Fastest possible move: full acceleration, top speed if it is reached
+  acceleration = maxAcceleration;
+  if (distance >= maxSpeed * maxSpeed / maxAcceleration) {
+    speed = maxSpeed;
+    return distance / maxSpeed + maxSpeed / maxAcceleration;
+  }
+  speed = sqrt(distance * maxAcceleration);
+  return 2.0 * speed / maxAcceleration;
+}
+
+/**************************************************************************/
+/*!
+  @brief  Acceleration for retargeting a running move. The ramp generator
+  picks up the new target at the current speed, so velocity stays continuous
+  and the pattern's acceleration is kept as long as it can brake in time.
+  Only if it can't is the brake made just as hard as needed: to a stop right
+  at the new target instead of overshooting it, or, heading away from it,
+  to a turnaround before the end of the envelope. This is the time-optimal
+  blend without overshoot. Above the limit of the machine an overshoot is
+  unavoidable and it brakes at the limit.
+  @param distance         signed distance to the new target in [steps]
+  @param speed            signed current speed in [steps/s]
+  @param acceleration     acceleration of the new move in [steps/s²]
+  @param maxAcceleration  top acceleration of the machine in [steps/s²]
+  @param room             distance left to the end of the envelope in the
+                          direction of travel in [steps]
+  @returns acceleration of the new move in [steps/s²], at least acceleration
+*/
+/**************************************************************************/
+inline float retargetAcceleration(float distance, float speed,
+                                  float acceleration, float maxAcceleration,
+                                  float room) {
+  if (speed == 0.0) {
+    return acceleration;
+  }
+
+  // Towards the target the stop must not pass it, otherwise the envelope
+  float limit = (distance > 0.0) == (speed > 0.0) ? fabs(distance) : room;
+  if (limit <= 0.0) {
+    return fmax(acceleration, maxAcceleration);
+  }
+
+  float required = (speed * speed) / (2.0 * limit);
+  if (required <= acceleration) {
+    return acceleration;
+  }
+  return fmax(acceleration, fmin(required, maxAcceleration));
+}
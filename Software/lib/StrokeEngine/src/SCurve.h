@@ -0,0 +1,145 @@
+/**
+ *   StrokeEngine
+ *   A library to create a variety of stroking motions with a stepper or servo
+ * motor on an ESP32. https://github.com/theelims/StrokeEngine
+ *
+ * Copyright (C) 2022 theelims <elims@gmx.net>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license.  See the LICENSE file for details.
+ */
+
+#pragma once
+
+#include <math.h>
+
+#include "StepQueue.h"
+
+/**************************************************************************/
+/*!
+  @brief  Jerk-limited (S-curve) profile of a move from standstill to
+  standstill. The acceleration ramps up and down with constant jerk instead
+  of jumping, which avoids the torque steps of a trapezoidal profile at the
+  start and at the reversal of a stroke. It is played through the
+  StepQueueExecutor.
+
+  The profile has up to seven phases: jerk up, constant acceleration, jerk
+  down, cruise and the same mirrored for the deceleration. Short moves drop
+  the cruise and, if needed, the constant acceleration phase.
+*/
+/**************************************************************************/
+class SCurveProfile : public Trajectory {
+  public:
+    /**************************************************************************/
+    /*!
+      @brief  Plans a move. Units only need to be consistent, e.g. steps,
+      steps/s, steps/s² and steps/s³.
+      @param distance      length of the move, sign is ignored
+      @param speed         top speed
+      @param acceleration  top acceleration
+      @param jerk          rate of change of the acceleration
+      @return TRUE if there is a move, FALSE for a zero distance or limits
+    */
+    /**************************************************************************/
+    bool plan(float distance, float speed, float acceleration, float jerk) {
+        _distance = fabs(distance);
+        _jerk = jerk;
+        _duration = 0.0;
+
+        if (_distance == 0.0 || speed <= 0.0 || acceleration <= 0.0 ||
+            jerk <= 0.0) {
+            _distance = 0.0;
+            return false;
+        }
+
+        // Peak acceleration can't be reached if the top speed comes first
+        _acceleration = fmin(acceleration, sqrt(speed * jerk));
+        _speed = speed;
+
+        // Too short to reach top speed: lower it until the ramps fit
+        if (_speed * (_speed / _acceleration + _acceleration / jerk) >
+            _distance) {
+            float jerkTime = acceleration / jerk;
+            _acceleration = acceleration;
+            _speed = 0.5 * _acceleration *
+                     (-jerkTime +
+                      sqrt(jerkTime * jerkTime + 4.0 * _distance / _acceleration));
+
+            // Not even top acceleration is reached, pure jerk ramps
+            if (_speed < _acceleration * jerkTime) {
+                _speed = pow(0.5 * _distance * sqrt(jerk), 2.0 / 3.0);
+                _acceleration = sqrt(_speed * jerk);
+            }
+        }
+
+        _jerkTime = _acceleration / jerk;
+        _accelerationTime = fmax(_speed / _acceleration - _jerkTime, 0.0);
+        float rampTime = 2.0 * _jerkTime + _accelerationTime;
+        _cruiseTime = fmax(_distance / _speed - rampTime, 0.0);
+        _duration = 2.0 * rampTime + _cruiseTime;
+        return true;
+    }
+
+    /**************************************************************************/
+    /*!
+      @brief  Position along the move.
+      @param time  time since the start of the move
+      @return distance covered, between 0 and the planned distance
+    */
+    /**************************************************************************/
+    float positionAt(float time) const override {
+        if (time <= 0.0) {
+            return 0.0;
+        }
+        if (time >= _duration) {
+            return _distance;
+        }
+
+        const float durations[7] = {_jerkTime, _accelerationTime, _jerkTime,
+                                    _cruiseTime, _jerkTime, _accelerationTime,
+                                    _jerkTime};
+        const float jerks[7] = {_jerk, 0.0, -_jerk, 0.0, -_jerk, 0.0, _jerk};
+
+        float position = 0.0;
+        float speed = 0.0;
+        float acceleration = 0.0;
+
+        for (int phase = 0; phase < 7; phase++) {
+            float t = fmin(time, durations[phase]);
+            float j = jerks[phase];
+            position += speed * t + acceleration * t * t / 2.0 +
+                        j * t * t * t / 6.0;
+            speed += acceleration * t + j * t * t / 2.0;
+            acceleration += j * t;
+
+            time -= t;
+            if (time <= 0.0) {
+                break;
+            }
+        }
+
+        return fmin(position, _distance);
+    }
+
+    //! Time the whole move takes, 0 if there is none
+    float getDuration() const override { return _duration; }
+
+    //! Highest speed of the move, may be below the requested top speed
+    float getPeakSpeed() const { return _speed; }
+
+    //! Highest acceleration of the move
+    float getPeakAcceleration() const { return _acceleration; }
+
+    //! Rate of change of the acceleration
+    float getJerk() const { return _jerk; }
+
+  protected:
+    float _distance = 0.0;
+    float _speed = 0.0;
+    float _acceleration = 0.0;
+    float _jerk = 0.0;
+    float _jerkTime = 0.0;
+    float _accelerationTime = 0.0;
+    float _cruiseTime = 0.0;
+    float _duration = 0.0;
+};
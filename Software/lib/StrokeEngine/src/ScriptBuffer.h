@@ -0,0 +1,162 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <atomic>
+
+// Clock errors beyond this are seeks of the client and applied at once
+#ifndef SCRIPT_SEEK_MS
+#define SCRIPT_SEEK_MS 250
+#endif
+
+/**************************************************************************/
+/*!
+  @brief  Timed position of a script, like a funscript action.
+*/
+/**************************************************************************/
+typedef struct {
+    uint32_t time;     //!< Script time in ms the position is reached at
+    uint8_t position;  //!< 0 - 100 % of the stroke, 100 is at depth
+} ScriptAction;
+
+/**************************************************************************/
+/*!
+  @brief  Ring of preloaded script actions between the upload (the only
+  producer) and the playing pattern (the only consumer). The storage is
+  handed in, so it can live in PSRAM when there is some. Clients keep it
+  filled ahead of the playback, actions are freed as they are played.
+*/
+/**************************************************************************/
+class ScriptBuffer {
+  public:
+    //! Uses capacity actions at storage
+    void begin(ScriptAction *storage, uint32_t capacity) {
+        _actions = storage;
+        _capacity = capacity;
+    }
+
+    uint32_t capacity() const { return _capacity; }
+
+    // Producer side
+
+    //! Appends an action. Fails if the buffer is full or the action is not
+    //! after the previous one.
+    bool push(const ScriptAction &action) {
+        uint32_t head = _head.load(std::memory_order_relaxed);
+        if (head - _start() >= _capacity) {
+            return false;
+        }
+        if (_appended > 0 && (int32_t)(action.time - _lastTime) <= 0) {
+            return false;
+        }
+
+        _actions[head % _capacity] = action;
+        _head.store(head + 1, std::memory_order_release);
+        _lastTime = action.time;
+        _appended++;
+        return true;
+    }
+
+    //! Number of actions pushed since the last clear, which is the index of
+    //! the next action in the script
+    uint32_t appended() const { return _appended; }
+
+    //! Room for this many more actions
+    uint32_t available() const {
+        return _capacity -
+               (_head.load(std::memory_order_relaxed) - _start());
+    }
+
+    //! Drops all actions. The consumer skips them with its next peek.
+    void clear() {
+        _clearTo.store(_head.load(std::memory_order_relaxed),
+                       std::memory_order_release);
+        _appended = 0;
+    }
+
+    // Consumer side
+
+    //! Oldest action without removing it
+    bool peek(ScriptAction &action) {
+        uint32_t tail = _skipCleared();
+        if (_head.load(std::memory_order_acquire) == tail) {
+            return false;
+        }
+        action = _actions[tail % _capacity];
+        _peeked = tail;
+        return true;
+    }
+
+    //! Removes the action of the last peek, unless it was cleared since
+    void pop() {
+        uint32_t tail = _skipCleared();
+        if (tail == _peeked && _head.load(std::memory_order_acquire) != tail) {
+            _tail.store(tail + 1, std::memory_order_release);
+        }
+    }
+
+  private:
+    ScriptAction *_actions = nullptr;
+    uint32_t _capacity = 0;
+    std::atomic<uint32_t> _head{0};
+    std::atomic<uint32_t> _tail{0};
+    std::atomic<uint32_t> _clearTo{0};
+    uint32_t _lastTime = 0;
+    uint32_t _appended = 0;
+    uint32_t _peeked = 0;
+
+    // First slot still in use as seen by the producer
+    uint32_t _start() const {
+        uint32_t tail = _tail.load(std::memory_order_acquire);
+        uint32_t clearTo = _clearTo.load(std::memory_order_acquire);
+        return (int32_t)(clearTo - tail) > 0 ? clearTo : tail;
+    }
+
+    uint32_t _skipCleared() {
+        uint32_t tail = _tail.load(std::memory_order_relaxed);
+        uint32_t clearTo = _clearTo.load(std::memory_order_acquire);
+        if ((int32_t)(clearTo - tail) > 0) {
+            tail = clearTo;
+            _tail.store(tail, std::memory_order_release);
+        }
+        return tail;
+    }
+};
+
+/**************************************************************************/
+/*!
+  @brief  Playback clock of a script, in ms since its start. Clients resync
+  it with their media time now and then. Small errors are halved with every
+  resync to smooth out transport jitter, seeks are followed at once.
+*/
+/**************************************************************************/
+class ScriptClock {
+  public:
+    //! Starts at scriptMs
+    void start(uint32_t scriptMs, uint32_t nowMs) {
+        _origin = nowMs - scriptMs;
+        _isRunning = true;
+    }
+
+    void stop() { _isRunning = false; }
+
+    bool isRunning() const { return _isRunning; }
+
+    //! Script time at nowMs
+    uint32_t now(uint32_t nowMs) const { return nowMs - _origin.load(); }
+
+    //! The client is at scriptMs at nowMs
+    void resync(uint32_t scriptMs, uint32_t nowMs) {
+        int32_t error = (int32_t)(scriptMs - now(nowMs));
+        if (abs(error) > SCRIPT_SEEK_MS) {
+            _origin -= error;
+        } else {
+            _origin -= error / 2;
+        }
+    }
+
+  private:
+    std::atomic<uint32_t> _origin{0};
+    std::atomic<bool> _isRunning{false};
+};
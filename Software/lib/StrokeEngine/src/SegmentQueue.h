@@ -0,0 +1,115 @@
+/**
+ *   StrokeEngine
+ *   A library to create a variety of stroking motions with a stepper or servo
+ * motor on an ESP32. https://github.com/theelims/StrokeEngine
+ *
+ * Copyright (C) 2022 theelims <elims@gmx.net>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license.  See the LICENSE file for details.
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+#include "pattern.h"
+
+// Number of segments the planner may compute ahead of the executor
+#ifndef SEGMENT_QUEUE_LENGTH
+#define SEGMENT_QUEUE_LENGTH 4
+#endif
+
+/**************************************************************************/
+/*!
+  @brief  A motion segment precomputed by the planner, tagged with the stroke
+  index it was planned for.
+*/
+/**************************************************************************/
+typedef struct {
+    int index;               //!< Stroke index passed to Pattern::nextTarget()
+    motionParameter motion;  //!< Motion parameters returned by the pattern
+} plannedSegment;
+
+/**************************************************************************/
+/*!
+  @brief  Fixed size ring buffer of planned segments between the planning
+  task and the stroking task. Access is guarded by a spinlock, the critical
+  sections only copy a few bytes and never block.
+*/
+/**************************************************************************/
+class SegmentQueue {
+  public:
+    /**************************************************************************/
+    /*!
+      @brief  Appends a segment at the end of the queue.
+      @param segment Segment to append
+      @return TRUE on success, FALSE if the queue is full
+    */
+    /**************************************************************************/
+    bool push(const plannedSegment &segment) {
+        bool success = false;
+        portENTER_CRITICAL(&_lock);
+        if (_count < SEGMENT_QUEUE_LENGTH) {
+            _segments[(_tail + _count) % SEGMENT_QUEUE_LENGTH] = segment;
+            _count++;
+            success = true;
+        }
+        portEXIT_CRITICAL(&_lock);
+        return success;
+    }
+
+    /**************************************************************************/
+    /*!
+      @brief  Removes the oldest segment from the queue.
+      @param segment Receives the segment
+      @return TRUE on success, FALSE if the queue is empty
+    */
+    /**************************************************************************/
+    bool pop(plannedSegment *segment) {
+        bool success = false;
+        portENTER_CRITICAL(&_lock);
+        if (_count > 0) {
+            *segment = _segments[_tail];
+            _tail = (_tail + 1) % SEGMENT_QUEUE_LENGTH;
+            _count--;
+            success = true;
+        }
+        portEXIT_CRITICAL(&_lock);
+        return success;
+    }
+
+    /**************************************************************************/
+    /*!
+      @brief  Discards all planned segments.
+    */
+    /**************************************************************************/
+    void flush() {
+        portENTER_CRITICAL(&_lock);
+        _tail = 0;
+        _count = 0;
+        portEXIT_CRITICAL(&_lock);
+    }
+
+    /**************************************************************************/
+    /*!
+      @brief  Number of segments waiting for execution.
+      @return Number of queued segments
+    */
+    /**************************************************************************/
+    unsigned int count() { return _count; }
+
+    /**************************************************************************/
+    /*!
+      @brief  Whether the planner has filled all slots.
+      @return TRUE if no more segments can be pushed
+    */
+    /**************************************************************************/
+    bool isFull() { return _count >= SEGMENT_QUEUE_LENGTH; }
+
+  protected:
+    plannedSegment _segments[SEGMENT_QUEUE_LENGTH];
+    unsigned int _tail = 0;
+    volatile unsigned int _count = 0;
+    portMUX_TYPE _lock = portMUX_INITIALIZER_UNLOCKED;
+};
@@ -0,0 +1,70 @@
+/**
+ *   StrokeEngine
+ *   A library to create a variety of stroking motions with a stepper or servo
+ * motor on an ESP32. https://github.com/theelims/StrokeEngine
+ *
+ * Copyright (C) 2022 theelims <elims@gmx.net>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license.  See the LICENSE file for details.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <atomic>
+
+/**************************************************************************/
+/*!
+  @brief  Strokes and distance of a session in whole steps. The motion task
+  reports every position a move ended at, or was retargeted from. Each
+  report adds the distance from the previous one, every move in a new
+  direction is half a stroke. Readers on other tasks convert to display
+  units themselves, the motion task never touches a float.
+*/
+/**************************************************************************/
+class SessionCounter {
+  public:
+    //! Starts a new session at position
+    void reset(int32_t position = 0) {
+        _last = position;
+        _direction = 0;
+        _halfStrokes.store(0, std::memory_order_relaxed);
+        _steps.store(0, std::memory_order_relaxed);
+    }
+
+    //! The motion reached position. Only called from the motion task.
+    void reach(int32_t position) {
+        int32_t delta = position - _last;
+        if (delta == 0) {
+            return;
+        }
+        _last = position;
+
+        // Out and back is one stroke, the first move starts one half
+        int8_t direction = delta > 0 ? 1 : -1;
+        if (direction != _direction) {
+            _direction = direction;
+            _halfStrokes.fetch_add(1, std::memory_order_relaxed);
+        }
+        _steps.fetch_add(abs(delta), std::memory_order_relaxed);
+    }
+
+    //! Complete strokes, each out and back
+    uint32_t getStrokes() const {
+        return _halfStrokes.load(std::memory_order_relaxed) / 2;
+    }
+
+    //! Distance travelled in [steps]
+    uint32_t getSteps() const {
+        return _steps.load(std::memory_order_relaxed);
+    }
+
+  private:
+    int32_t _last = 0;
+    int8_t _direction = 0;
+    std::atomic<uint32_t> _halfStrokes{0};
+    std::atomic<uint32_t> _steps{0};
+};
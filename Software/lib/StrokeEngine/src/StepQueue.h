@@ -0,0 +1,425 @@
+/**
+ *   StrokeEngine
+ *   A library to create a variety of stroking motions with a stepper or servo
+ * motor on an ESP32. https://github.com/theelims/StrokeEngine
+ *
+ * Copyright (C) 2022 theelims <elims@gmx.net>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license.  See the LICENSE file for details.
+ */
+
+#pragma once
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+// Longest interval of a single command of the servo's queue in [ticks]
+#define STEP_COMMAND_MAX_TICKS 65535
+// Most steps a single command of the servo's queue can hold
+#define STEP_COMMAND_MAX_STEPS 255
+
+/**************************************************************************/
+/*!
+  @brief  A motion to play through the step queue, given by its position
+  over time. Any profile works: S-curves, splines of streamed targets or
+  interpolated keyframes.
+*/
+/**************************************************************************/
+class Trajectory {
+  public:
+    //! Length of the motion in [s]
+    virtual float getDuration() const = 0;
+
+    //! Position relative to the start in [steps] at time [s]
+    virtual float positionAt(float time) const = 0;
+};
+
+/**************************************************************************/
+/*!
+  @brief  Brakes from a speed to a standstill. The deceleration ramps up
+  and down with constant jerk, or applies at once if there is no jerk. The
+  StepQueueExecutor ends a trajectory with it when it has to stop early.
+*/
+/**************************************************************************/
+class BrakingProfile : public Trajectory {
+  public:
+    /**************************************************************************/
+    /*!
+      @brief  Plans the braking. Units only need to be consistent, e.g.
+      steps/s, steps/s² and steps/s³.
+      @param speed         speed at the start, sign is ignored
+      @param deceleration  top deceleration
+      @param jerk          rate of change of the deceleration, 0 for none
+      @return TRUE if there is a speed to brake from, FALSE otherwise
+    */
+    /**************************************************************************/
+    bool plan(float speed, float deceleration, float jerk) {
+        _speed = fabs(speed);
+        _duration = 0.0;
+        _distance = 0.0;
+        if (_speed == 0.0 || deceleration <= 0.0) {
+            return false;
+        }
+
+        // Top deceleration can't be reached if the speed is gone before
+        _jerk = fmax(jerk, 0.0);
+        _deceleration = _jerk > 0.0 ? fmin(deceleration, sqrt(_speed * _jerk))
+                                    : deceleration;
+        _jerkTime = _jerk > 0.0 ? _deceleration / _jerk : 0.0;
+        _brakeTime = fmax(_speed / _deceleration - _jerkTime, 0.0);
+        _duration = 2.0 * _jerkTime + _brakeTime;
+        _distance = _integrate(_duration);
+        return true;
+    }
+
+    //! Distance covered at time [s], up to the braking distance
+    float positionAt(float time) const override {
+        if (time <= 0.0) {
+            return 0.0;
+        }
+        if (time >= _duration) {
+            return _distance;
+        }
+        return fmin(_integrate(time), _distance);
+    }
+
+    //! Time the braking takes, 0 if there is none
+    float getDuration() const override { return _duration; }
+
+    //! Distance it takes to stop
+    float getDistance() const { return _distance; }
+
+  protected:
+    float _speed = 0.0;
+    float _deceleration = 0.0;
+    float _jerk = 0.0;
+    float _jerkTime = 0.0;
+    float _brakeTime = 0.0;
+    float _duration = 0.0;
+    float _distance = 0.0;
+
+    // Jerk up the deceleration, hold it and jerk it down again
+    float _integrate(float time) const {
+        const float durations[3] = {_jerkTime, _brakeTime, _jerkTime};
+        const float jerks[3] = {-_jerk, 0.0, _jerk};
+
+        float position = 0.0;
+        float speed = _speed;
+        // Without jerk the full deceleration applies at once
+        float acceleration = _jerk > 0.0 ? 0.0 : -_deceleration;
+
+        for (int phase = 0; phase < 3 && time > 0.0; phase++) {
+            float t = fmin(time, durations[phase]);
+            float j = jerks[phase];
+            position += speed * t + acceleration * t * t / 2.0 +
+                        j * t * t * t / 6.0;
+            speed += acceleration * t + j * t * t / 2.0;
+            acceleration += j * t;
+            time -= t;
+        }
+        return position;
+    }
+};
+
+/**************************************************************************/
+/*!
+  @brief  One entry of the servo's command queue, the same fields as
+  FastAccelStepper's stepper_command_s: steps at equal intervals of ticks,
+  or a pause of ticks if there are no steps.
+*/
+/**************************************************************************/
+typedef struct {
+    uint16_t ticks;  //!< Interval between steps in [ticks]
+    uint8_t steps;   //!< Number of steps, 0 for a pause
+    bool countUp;    //!< Direction of the steps
+} StepCommand;
+
+/**************************************************************************/
+/*!
+  @brief  Encodes a slice of constant speed into queue commands. Steps are
+  split into batches of equal size, slow steps and pauses into parts of at
+  least half the longest interval, so no command ends up too short for the
+  queue to keep up with. The slice only uses whole intervals, ticksUsed()
+  tells how many. A slice faster than the servo can step is cut down to the
+  steps that fit, steps() tells how many those are.
+*/
+/**************************************************************************/
+class StepSlice {
+  public:
+    /**************************************************************************/
+    /*!
+      @brief  Starts a new slice
+      @param steps     signed number of steps
+      @param ticks     duration of the slice in [ticks]
+      @param minTicks  shortest interval between two steps in [ticks]
+    */
+    /**************************************************************************/
+    void begin(int32_t steps, uint32_t ticks, uint32_t minTicks) {
+        _countUp = steps >= 0;
+        _count = abs(steps);
+        if (minTicks == 0) {
+            minTicks = 1;
+        }
+        if (_count > 0 && ticks / _count < minTicks) {
+            _count = ticks / minTicks;
+        }
+
+        _interval = _count > 0 ? ticks / _count : ticks;
+        _batches =
+            (_count + STEP_COMMAND_MAX_STEPS - 1) / STEP_COMMAND_MAX_STEPS;
+        _batch = 0;
+        _done = 0;
+        _left = _count > 0 ? 0 : ticks;
+    }
+
+    //! Signed number of steps the slice makes
+    int32_t steps() const { return _countUp ? _count : -int32_t(_count); }
+
+    //! Duration of the encoded commands in [ticks]
+    uint32_t ticksUsed() const {
+        return _count > 0 ? _interval * _count : _interval;
+    }
+
+    //! Next command of the slice, false once all are taken
+    bool next(StepCommand &command) {
+        command.countUp = _countUp;
+
+        // A pause, or what is left of the interval of a slow step
+        if (_left > 0) {
+            uint32_t part = _part(_left);
+            command.ticks = part;
+            command.steps = 0;
+            _left -= part;
+            if (_left == 0 && _count > 0) {
+                _done++;
+            }
+            return true;
+        }
+        if (_done >= _count) {
+            return false;
+        }
+
+        // Slow steps take one command with the step and pauses for the rest
+        if (_interval > STEP_COMMAND_MAX_TICKS) {
+            uint32_t part = _part(_interval);
+            command.ticks = part;
+            command.steps = 1;
+            _left = _interval - part;
+            if (_left == 0) {
+                _done++;
+            }
+            return true;
+        }
+
+        // Batches of nearly equal size, the first ones take one step more
+        uint32_t size = _count / _batches + (_batch < _count % _batches);
+        command.ticks = _interval;
+        command.steps = size;
+        _batch++;
+        _done += size;
+        return true;
+    }
+
+  private:
+    bool _countUp = true;
+    uint32_t _count = 0;
+    uint32_t _interval = 0;
+    uint32_t _batches = 0;
+    uint32_t _batch = 0;
+    uint32_t _done = 0;
+    uint32_t _left = 0;
+
+    // Longest part, but never leave a remainder shorter than half of it
+    static uint32_t _part(uint32_t ticks) {
+        if (ticks <= STEP_COMMAND_MAX_TICKS) {
+            return ticks;
+        }
+        if (ticks <= 2 * STEP_COMMAND_MAX_TICKS) {
+            return (ticks + 1) / 2;
+        }
+        return STEP_COMMAND_MAX_TICKS;
+    }
+};
+
+/**************************************************************************/
+/*!
+  @brief  Plays a trajectory by feeding step commands straight into the
+  servo's command queue, bypassing its ramp generator. The trajectory is cut
+  into slices of constant speed, each slice into commands. Commands are
+  handed to a push function, which returns false if the queue is full; the
+  refused command is offered again with the next feed().
+
+  Ticks a slice can't use for whole step intervals are carried over to the
+  next one, so the motion keeps its time. Steps the servo is too slow for
+  are caught up in the following slices, if needed after the end of the
+  trajectory. brake() stops early without losing track of the steps.
+*/
+/**************************************************************************/
+class StepQueueExecutor {
+  public:
+    /**************************************************************************/
+    /*!
+      @brief  Starts playing a trajectory. It has to stay alive until the
+      executor is done or stopped.
+      @param trajectory  motion to play
+      @param direction   1 to play it as is, -1 to mirror it
+      @param sliceTicks  duration of the slices in [ticks]
+      @param minTicks    shortest interval between two steps in [ticks]
+      @param ticksPerS   ticks of the servo per second
+    */
+    /**************************************************************************/
+    void start(const Trajectory *trajectory, int direction,
+               uint32_t sliceTicks, uint32_t minTicks, uint32_t ticksPerS) {
+        _trajectory = trajectory;
+        _direction = direction < 0 ? -1 : 1;
+        _sliceTicks = sliceTicks > 0 ? sliceTicks : 1;
+        _minTicks = minTicks;
+        _ticksPerS = ticksPerS;
+        _duration = trajectory->getDuration();
+        _end = int32_t(lround(trajectory->positionAt(_duration)));
+        _fed = 0;
+        _fedBefore = 0;
+        _speed = 0.0;
+        _slice = 0;
+        _carry = 0;
+        _isSliceOpen = false;
+        _hasPending = false;
+
+        // A short remainder is added to the last slice instead of its own
+        float slices = _duration * ticksPerS / _sliceTicks;
+        _slices = slices < 1.0 ? 1 : uint32_t(slices);
+    }
+
+    //! Stops feeding, commands already queued still play out
+    void stop() { _trajectory = nullptr; }
+
+    /**************************************************************************/
+    /*!
+      @brief  Ends the trajectory early. Commands not fed yet are dropped,
+      the queued ones play out and a braking tail follows them, from the
+      speed of the last slice fed down to a standstill. Keep feeding until
+      the executor is done.
+      @param deceleration  top deceleration of the tail in [steps/s²]
+      @param jerk          rate of change of the deceleration in
+                           [steps/s³], 0 to brake at once
+      @returns true if there is a tail to feed
+    */
+    /**************************************************************************/
+    bool brake(float deceleration, float jerk) {
+        if (isActive() == false || isBraking()) {
+            return isActive();
+        }
+
+        // Only the steps of an open slice that were queued count
+        if (_isSliceOpen) {
+            _fed -= (_encoder.steps() - _pushed) * _direction;
+        }
+        int32_t fed = getFed();
+        float speed = _speed;
+
+        stop();
+        if (_tail.plan(speed, deceleration, jerk) == false) {
+            return false;
+        }
+        start(&_tail, speed < 0.0 ? -1 : 1, _sliceTicks, _minTicks,
+              _ticksPerS);
+        _fedBefore = fed;
+        return true;
+    }
+
+    //! True until all steps of the trajectory are fed
+    bool isActive() const { return _trajectory != nullptr; }
+
+    //! True while the braking tail is fed
+    bool isBraking() const { return _trajectory == &_tail; }
+
+    //! Steps fed so far, relative to the start and signed by direction
+    int32_t getFed() const { return _fedBefore + _fed * _direction; }
+
+    /**************************************************************************/
+    /*!
+      @brief  Feeds the commands of one slice
+      @param push  bool push(const StepCommand &) queues a command
+      @returns true if a complete slice was queued, false if the queue is
+      full or the trajectory is done
+    */
+    /**************************************************************************/
+    template <typename Push>
+    bool feed(Push push) {
+        if (isActive() == false) {
+            return false;
+        }
+        if (_isSliceOpen == false && _beginSlice() == false) {
+            stop();
+            return false;
+        }
+
+        while (_hasPending || _encoder.next(_pending)) {
+            _hasPending = true;
+            if (push(_pending) == false) {
+                return false;
+            }
+            _hasPending = false;
+            _pushed += _pending.countUp ? _pending.steps : -_pending.steps;
+            _speed = _sliceSpeed;
+        }
+        _isSliceOpen = false;
+        return true;
+    }
+
+  private:
+    const Trajectory *_trajectory = nullptr;
+    BrakingProfile _tail;
+    StepSlice _encoder;
+    StepCommand _pending = {};
+    bool _hasPending = false;
+    bool _isSliceOpen = false;
+    int _direction = 1;
+    uint32_t _sliceTicks = 1;
+    uint32_t _minTicks = 1;
+    uint32_t _ticksPerS = 1;
+    float _duration = 0.0;
+    int32_t _end = 0;
+    int32_t _fed = 0;
+    int32_t _fedBefore = 0;   // Steps of the trajectory a tail follows
+    int32_t _pushed = 0;      // Steps of the open slice queued so far
+    float _sliceSpeed = 0.0;  // Speed of the open slice in [steps/s]
+    float _speed = 0.0;       // Speed of the last slice queued in [steps/s]
+    uint32_t _slice = 0;
+    uint32_t _slices = 1;
+    uint32_t _carry = 0;
+
+    bool _beginSlice() {
+        // Past the end only steps that fell behind are caught up
+        if (_slice >= _slices && _fed == _end) {
+            return false;
+        }
+
+        float start = fmin(_slice * _duration / _slices, _duration);
+        float end = _slice + 1 >= _slices
+                        ? _duration
+                        : (_slice + 1) * _duration / _slices;
+        int32_t position = _slice + 1 >= _slices
+                               ? _end
+                               : int32_t(lround(_trajectory->positionAt(end)));
+
+        // Catch-up slices after the end are as long as a regular one
+        uint32_t ticks = _slice < _slices
+                             ? uint32_t((end - start) * _ticksPerS) + _carry
+                             : _sliceTicks;
+        if (ticks == 0) {
+            ticks = 1;
+        }
+        _encoder.begin((position - _fed) * _direction, ticks, _minTicks);
+        _carry = ticks - _encoder.ticksUsed();
+        _fed += _encoder.steps() * _direction;
+        _pushed = 0;
+        _sliceSpeed =
+            float(_encoder.steps()) * _ticksPerS / _encoder.ticksUsed();
+        _slice++;
+        _isSliceOpen = true;
+        return true;
+    }
+};
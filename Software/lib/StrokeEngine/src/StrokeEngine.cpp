@@ -2,6 +2,7 @@
 
 #include <Arduino.h>
 
+#include "PatternMath.h"
 #include "pattern.h"
 
 // static pointer to engine and _servo
@@ -32,46 +33,74 @@ void StrokeEngine::begin(machineGeometry *physics, motorProperties *motor,
     _timeOfStroke = 1.0;
     _sensation = 0.0;
 
+    // Motion tasks start out with these
+    _publishSettings(SETTINGS_RESTART);
+
     if (_servo) {
         _servo->setDirectionPin(_motor->directionPin, _motor->invertDirection);
         _servo->setEnablePin(_motor->enablePin, _motor->enableActiveLow);
         _servo->setAutoEnable(false);
         _servo->disableOutputs();
     }
-    Serial.println("_servo initialized");
 
-#ifdef DEBUG_TALKATIVE
-    Serial.println("Stroke Engine State: " + verboseState[_state]);
-#endif
-}
+    // One-shot timer waking the stroking task at the predicted end of a move
+    if (_moveTimer == NULL) {
+        esp_timer_create_args_t timerArgs = {};
+        timerArgs.callback = &StrokeEngine::_moveTimerImpl;
+        timerArgs.arg = this;
+        timerArgs.name = "StrokeMove";
+        esp_timer_create(&timerArgs, &_moveTimer);
+    }
 
-void StrokeEngine::setSpeed(float speed, bool applyNow = false) {
-    // Update pattern with new speed, will be used with the next stroke or on
-    // update request
-    if (xSemaphoreTake(_patternMutex, portMAX_DELAY) == pdTRUE) {
-        // Convert FPM into seconds to complete a full stroke
-        // Constrain stroke time between 10ms and 120 seconds
-        _timeOfStroke = constrain(60.0 / speed, 0.01, 120.0);
+    // Periodic timer pacing the motion tasks in LOOP_TIMER
+    if (_loopTimer == NULL) {
+        esp_timer_create_args_t timerArgs = {};
+        timerArgs.callback = &StrokeEngine::_loopTimerImpl;
+        timerArgs.arg = this;
+        timerArgs.name = "StrokeLoop";
+        timerArgs.skip_unhandled_events = true;
+        esp_timer_create(&timerArgs, &_loopTimer);
+    }
 
-        pattern->setTimeOfStroke(_timeOfStroke);
+    // Jitter buffer of the streaming mode
+    if (_streamQueue == NULL) {
+        _streamQueue = xQueueCreate(STREAM_BUFFER_LENGTH, sizeof(streamTarget));
+    }
+
+#ifdef DEBUG_CLIPPING
+    // Clipped motions are printed from here, far away from the motion task
+    if (_taskClippingHandle == NULL) {
+        _clips.setTracing(true);
+        xTaskCreatePinnedToCore(
+            this->_clippingImpl,   // Function that should be called
+            "Clipping",            // Name of the task (for debugging)
+            3072,                  // Stack size (bytes)
+            this,                  // Pass reference to this class instance
+            1,                     // Lowest task priority
+            &_taskClippingHandle,  // Task handle
+            0                      // Pin to protocol core
+        );
+    }
+#endif
+    Serial.println("_servo initialized");
 
 #ifdef DEBUG_TALKATIVE
-        Serial.println("setTimeOfStroke: " + String(_timeOfStroke, 2));
+    Serial.print("Stroke Engine State: ");
+    Serial.println(verboseState[_state]);
 #endif
+}
 
-        // When running a pattern and immediate update requested:
-        if ((_state == PATTERN) && (applyNow == true)) {
-            // set flag to apply update from stroking thread
-            _applyUpdate = true;
+void StrokeEngine::setSpeed(float speed, bool applyNow = false) {
+    // The pattern gets the new speed with the next stroke or on update
+    // request
+    // Convert FPM into seconds to complete a full stroke
+    // Constrain stroke time between 10ms and 120 seconds
+    _timeOfStroke = constrain(60.0 / speed, 0.01, 120.0);
+    _publishSettings(applyNow ? SETTINGS_APPLY_NOW : 0);
 
 #ifdef DEBUG_TALKATIVE
-            Serial.println("Apply New Settings Now");
+    Serial.println("setTimeOfStroke: " + String(_timeOfStroke, 2));
 #endif
-        }
-
-        // give back mutex
-        xSemaphoreGive(_patternMutex);
-    }
 }
 
 float StrokeEngine::getSpeed() {
@@ -80,30 +109,15 @@ float StrokeEngine::getSpeed() {
 }
 
 void StrokeEngine::setDepth(float depth, bool applyNow = false) {
-    if (xSemaphoreTake(_patternMutex, portMAX_DELAY) == pdTRUE) {
-        // Convert depth from mm into steps
-        // Constrain depth between minStep and maxStep
-        _depth = constrain(int(depth * _motor->stepsPerMillimeter), _minStep,
-                           _maxStep);
-
-        pattern->setDepth(_depth);
+    // Convert depth from mm into steps
+    // Constrain depth between minStep and maxStep
+    _depth =
+        constrain(int(depth * _motor->stepsPerMillimeter), _minStep, _maxStep);
+    _publishSettings(applyNow ? SETTINGS_APPLY_NOW : 0);
 
 #ifdef DEBUG_TALKATIVE
-        Serial.println("setDepth: " + String(_depth));
-#endif
-        // When running a pattern and immediate update requested:
-        if ((_state == PATTERN) && (applyNow == true)) {
-            // set flag to apply update from stroking thread
-            _applyUpdate = true;
-
-#ifdef DEBUG_TALKATIVE
-            Serial.println("Apply New Settings Now");
+    Serial.println("setDepth: " + String(_depth));
 #endif
-        }
-
-        // give back mutex
-        xSemaphoreGive(_patternMutex);
-    }
 
     // if in state SETUPDEPTH then adjust
     if (_state == SETUPDEPTH) {
@@ -117,33 +131,17 @@ float StrokeEngine::getDepth() {
 }
 
 void StrokeEngine::setStroke(float stroke, bool applyNow = false) {
-    // Update pattern with new stroke, will be used with the next stroke or on
-    // update request
-    if (xSemaphoreTake(_patternMutex, portMAX_DELAY) == pdTRUE) {
-        // Convert stroke from mm into steps
-        // Constrain stroke between minStep and maxStep
-        _stroke = constrain(int(stroke * _motor->stepsPerMillimeter), _minStep,
-                            _maxStep);
-
-        pattern->setStroke(_stroke);
-
-#ifdef DEBUG_TALKATIVE
-        Serial.println("setStroke: " + String(_stroke));
-#endif
-
-        // When running a pattern and immediate update requested:
-        if ((_state == PATTERN) && (applyNow == true)) {
-            // set flag to apply update from stroking thread
-            _applyUpdate = true;
+    // The pattern gets the new stroke with the next stroke or on update
+    // request
+    // Convert stroke from mm into steps
+    // Constrain stroke between minStep and maxStep
+    _stroke =
+        constrain(int(stroke * _motor->stepsPerMillimeter), _minStep, _maxStep);
+    _publishSettings(applyNow ? SETTINGS_APPLY_NOW : 0);
 
 #ifdef DEBUG_TALKATIVE
-            Serial.println("Apply New Settings Now");
+    Serial.println("setStroke: " + String(_stroke));
 #endif
-        }
-
-        // give back mutex
-        xSemaphoreGive(_patternMutex);
-    }
 
     // if in state SETUPDEPTH then adjust
     if (_state == SETUPDEPTH) {
@@ -157,32 +155,16 @@ float StrokeEngine::getStroke() {
 }
 
 void StrokeEngine::setSensation(float sensation, bool applyNow = false) {
-    // Update pattern with new sensation, will be used with the next stroke or
-    // on update request
-    if (xSemaphoreTake(_patternMutex, portMAX_DELAY) == pdTRUE) {
-        // Constrain sensation between -100 and 100
-        _sensation = constrain(sensation, -100, 100);
-
-        pattern->setSensation(_sensation);
+    // The pattern gets the new sensation with the next stroke or on update
+    // request
+    // Constrain sensation between -100 and 100
+    _sensation = constrain(sensation, -100, 100);
+    _publishSettings(applyNow ? SETTINGS_APPLY_NOW : 0);
 
 #ifdef DEBUG_TALKATIVE
-        Serial.println("setSensation: " + String(_sensation));
+    Serial.println("setSensation: " + String(_sensation));
 #endif
 
-        // When running a pattern and immediate update requested:
-        if ((_state == PATTERN) && (applyNow == true)) {
-            // set flag to apply update from stroking thread
-            _applyUpdate = true;
-
-#ifdef DEBUG_TALKATIVE
-            Serial.println("Apply New Settings Now");
-#endif
-        }
-
-        // give back mutex
-        xSemaphoreGive(_patternMutex);
-    }
-
     // if in state SETUPDEPTH then adjust
     if (_state == SETUPDEPTH) {
         _setupDepths();
@@ -191,52 +173,69 @@ void StrokeEngine::setSensation(float sensation, bool applyNow = false) {
 
 float StrokeEngine::getSensation() { return _sensation; }
 
-bool StrokeEngine::setPattern(Pattern *NextPattern,
-                              bool applyNow = false) {
-    // Free up memory from previous pattern
+bool StrokeEngine::setPattern(int patternIndex, bool applyNow = false) {
+    // Check wether pattern Index is in range
+    if (patternIndex < 0 || patternIndex >= (int)patternTableSize) {
+#ifdef DEBUG_TALKATIVE
+        Serial.println("Failed to set pattern: " + String(patternIndex));
+#endif
+        return false;
+    }
+
+    // The motion tasks inject the current motion parameters into the new
+    // pattern and start it over
+    _patternIndex = patternIndex;
+    _selected = patternTable[patternIndex];
+    _publishSettings(SETTINGS_RESTART | (applyNow ? SETTINGS_APPLY_NOW : 0));
+
+#ifdef DEBUG_TALKATIVE
+    Serial.println("setPattern: " + String(_selected->getName()));
+    Serial.println("setTimeOfStroke: " + String(_timeOfStroke, 2));
+    Serial.println("setDepth: " + String(_depth));
+    Serial.println("setStroke: " + String(_stroke));
+    Serial.println("setSensation: " + String(_sensation));
+#endif
+    return true;
+}
 
-    delete pattern;
-    pattern = NextPattern;
+int StrokeEngine::getPattern() { return _patternIndex; }
 
-    // Inject current motion parameters into new pattern
+void StrokeEngine::setKeyframes(const KeyframeTable &keyframes,
+                                bool applyNow = false) {
     if (xSemaphoreTake(_patternMutex, portMAX_DELAY) == pdTRUE) {
-        pattern->setSpeedLimit(_maxStepPerSecond, _maxStepAcceleration,
-                              _motor->stepsPerMillimeter);
-        pattern->setTimeOfStroke(_timeOfStroke);
-        pattern->setStroke(_stroke);
-        pattern->setDepth(_depth);
-        pattern->setSensation(_sensation);
+        tablePattern.setKeyframes(keyframes);
 
-        // When running a pattern and immediate update requested:
-        if ((_state == PATTERN) && (applyNow == true)) {
-            // set flag to apply update from stroking thread
-            _applyUpdate = true;
+        if (pattern == &tablePattern) {
+            _flushPlan();
 
-#ifdef DEBUG_TALKATIVE
-            Serial.println("Apply New Settings Now");
-#endif
+            // When running a pattern and immediate update requested:
+            if ((_state == PATTERN) && (applyNow == true)) {
+                // set flag to apply update from stroking thread
+                _applyUpdate = true;
+            }
         }
 
-        // Reset index counter
-        _index = -1;
-
         // give back mutex
         xSemaphoreGive(_patternMutex);
+
+        // wake stroking thread to apply the update right away
+        if (_applyUpdate == true) {
+            _wakeStroking();
+        }
     }
 
 #ifdef DEBUG_TALKATIVE
-    Serial.println("setPattern: " + String(pattern->getName()));
-    Serial.println("setTimeOfStroke: " + String(_timeOfStroke, 2));
-    Serial.println("setDepth: " + String(_depth));
-    Serial.println("setStroke: " + String(_stroke));
-    Serial.println("setSensation: " + String(_sensation));
+    Serial.println("setKeyframes: " + String(keyframes.count));
 #endif
-    return true;
 }
 
-int StrokeEngine::getPattern() { return 0; }
-
 bool StrokeEngine::startPattern() {
+    return _startPattern(patternTable[_patternIndex]);
+}
+
+bool StrokeEngine::startScript() { return _startPattern(&scriptPattern); }
+
+bool StrokeEngine::_startPattern(Pattern *selected) {
     // Only valid if state is ready
     if (_state == READY || _state == SETUPDEPTH) {
         // Stop current move, should one be pending (moveToMax or moveToMin)
@@ -250,15 +249,13 @@ bool StrokeEngine::startPattern() {
         // Set state to PATTERN
         _state = PATTERN;
 
-        // Reset Stroke and Motion parameters
-        _index = -1;
+        // Reset Stroke and Motion parameters. The stroking task is suspended,
+        // so the settings are taken over right here, even within an update.
+        _selected = selected;
+        _commitSettings(SETTINGS_RESTART);
         if (xSemaphoreTake(_patternMutex, portMAX_DELAY) == pdTRUE) {
-            pattern->setSpeedLimit(_maxStepPerSecond, _maxStepAcceleration,
-                                  _motor->stepsPerMillimeter);
-            pattern->setTimeOfStroke(_timeOfStroke);
-            pattern->setStroke(_stroke);
-            pattern->setDepth(_depth);
-            pattern->setSensation(_sensation);
+            _takeSettings();
+            _applyUpdate = false;
             xSemaphoreGive(_patternMutex);
         }
 
@@ -284,10 +281,29 @@ bool StrokeEngine::startPattern() {
             // Resume task, if it already exists
             vTaskResume(_taskStrokingHandle);
         }
+        _startLoopTimer();
+
+        if (_taskPlanningHandle == NULL) {
+            // Create planning task on the other core, so that patterns with
+            // expensive math never stall the motion core
+            xTaskCreatePinnedToCore(
+                this->_planningImpl,   // Function that should be called
+                "Planning",            // Name of the task (for debugging)
+                4096,                  // Stack size (bytes)
+                this,                  // Pass reference to this class instance
+                10,                    // Below the stroking task
+                &_taskPlanningHandle,  // Task handle
+                0                      // Pin to protocol core
+            );
+        } else {
+            // Fill the queue for the new pattern run
+            xTaskNotifyGive(_taskPlanningHandle);
+        }
 
 #ifdef DEBUG_TALKATIVE
         Serial.println("Started motion task");
-        Serial.println("Stroke Engine State: " + verboseState[_state]);
+        Serial.print("Stroke Engine State: ");
+        Serial.println(verboseState[_state]);
 #endif
 
         return true;
@@ -300,22 +316,118 @@ bool StrokeEngine::startPattern() {
     }
 }
 
+bool StrokeEngine::startStreaming() {
+    // Only valid if state is ready
+    if (_state == READY || _state == SETUPDEPTH) {
+        // Stop current move, should one be pending (moveToMax or moveToMin)
+        if (_servo->isRunning()) {
+            // Stop _servo motor as fast as legally allowed
+            _servo->setAcceleration(_maxStepAcceleration);
+            _servo->applySpeedAcceleration();
+            _servo->stopMove();
+        }
+
+        // Discard targets from a previous session
+        xQueueReset(_streamQueue);
+
+        // Set state to STREAMING
+        _state = STREAMING;
+
+        if (_taskStreamingHandle == NULL) {
+            // Create Streaming Task
+            xTaskCreatePinnedToCore(
+                this->_streamingImpl,   // Function that should be called
+                "Streaming",            // Name of the task (for debugging)
+                4096,                   // Stack size (bytes)
+                this,                   // Pass reference to this class instance
+                24,                     // Pretty high task priority
+                &_taskStreamingHandle,  // Task handle
+                1                       // Pin to application core
+            );
+        } else {
+            // Resume task, if it already exists
+            vTaskResume(_taskStreamingHandle);
+        }
+        _startLoopTimer();
+
+#ifdef DEBUG_TALKATIVE
+        Serial.println("Started streaming task");
+        Serial.print("Stroke Engine State: ");
+        Serial.println(verboseState[_state]);
+#endif
+
+        return true;
+
+    } else {
+#ifdef DEBUG_TALKATIVE
+        Serial.println("Failed to start streaming");
+#endif
+        return false;
+    }
+}
+
+bool StrokeEngine::streamTo(float position, unsigned int time) {
+    if (_state != STREAMING) {
+        return false;
+    }
+
+    streamTarget target;
+    // Convert position from mm into steps
+    // Constrain position between minStep and maxStep
+    target.position = constrain(int(position * _motor->stepsPerMillimeter),
+                                _minStep, _maxStep);
+    target.time = time;
+    target.arrival = esp_timer_get_time();
+
+    // Drop the oldest target if the buffer is full, the latest one matters
+    if (xQueueSend(_streamQueue, &target, 0) != pdTRUE) {
+        streamTarget dropped;
+        xQueueReceive(_streamQueue, &dropped, 0);
+        xQueueSend(_streamQueue, &target, 0);
+
+#ifdef DEBUG_TALKATIVE
+        Serial.println("Stream buffer overflow, dropped oldest target");
+#endif
+    }
+
+    return true;
+}
+
+void StrokeEngine::setStreamingDelay(unsigned int delay) {
+    _streamDelay = delay;
+}
+
 void StrokeEngine::stopMotion() {
     // only valid when
-    if (_state == PATTERN || _state == SETUPDEPTH) {
+    if (_state == PATTERN || _state == SETUPDEPTH || _state == STREAMING) {
+        // The stroking task feeds an S-curve, it brakes it there. The last
+        // slices of one that is all fed end at a standstill anyway.
+        bool isCurveFed = _curveActive;
+        bool isCurveQueued = esp_timer_get_time() < _curveEnd;
+        if (isCurveFed) {
+            _isBrakeRequested = true;
+        }
+
         // Set state
         _state = READY;
+        _wakeStroking();
 
         // Stop _servo motor as fast as legally allowed
-        _servo->setAcceleration(_maxStepAcceleration);
-        _servo->applySpeedAcceleration();
-        _servo->stopMove();
+        if (isCurveFed == false && isCurveQueued == false) {
+            _servo->setAcceleration(_maxStepAcceleration);
+            _servo->applySpeedAcceleration();
+            _servo->stopMove();
+        }
+        _stopAxes();
 
 #ifdef DEBUG_TALKATIVE
         Serial.println("Motion stopped");
 #endif
 
         // Wait for _servo stopped
+        while (_curveActive) {
+            vTaskDelay(1);
+        }
         while (_servo->isRunning())
             ;
 
@@ -328,7 +440,8 @@ void StrokeEngine::stopMotion() {
     }
 
 #ifdef DEBUG_TALKATIVE
-    Serial.println("Stroke Engine State: " + verboseState[_state]);
+    Serial.print("Stroke Engine State: ");
+    Serial.println(verboseState[_state]);
 #endif
 }
 
@@ -371,6 +484,7 @@ void StrokeEngine::enableAndHome(endstopProperties *endstop, float speed) {
         &_taskHomingHandle,          // Task handle
         1                            // Have it on application core
     );
+    _startLoopTimer();
 #ifdef DEBUG_TALKATIVE
     Serial.println("Homing task started");
 #endif
@@ -394,6 +508,7 @@ void StrokeEngine::thisIsHome(float speed) {
 
         // drive free of switch and set axis to 0
         _servo->moveTo(_minStep);
+        _homeAxes();
 
         // Change state
         _isHomed = true;
@@ -434,7 +549,8 @@ bool StrokeEngine::moveToMax(float speed) {
         }
 
 #ifdef DEBUG_TALKATIVE
-        Serial.println("Stroke Engine State: " + verboseState[_state]);
+        Serial.print("Stroke Engine State: ");
+        Serial.println(verboseState[_state]);
 #endif
 
         // Return success
@@ -469,7 +585,8 @@ bool StrokeEngine::moveToMin(float speed) {
         }
 
 #ifdef DEBUG_TALKATIVE
-        Serial.println("Stroke Engine State: " + verboseState[_state]);
+        Serial.print("Stroke Engine State: ");
+        Serial.println(verboseState[_state]);
 #endif
 
         // Return success
@@ -512,7 +629,8 @@ bool StrokeEngine::setupDepth(float speed, bool fancy) {
         allowed = true;
     }
 #ifdef DEBUG_TALKATIVE
-    Serial.println("Stroke Engine State: " + verboseState[_state]);
+    Serial.print("Stroke Engine State: ");
+    Serial.println(verboseState[_state]);
 #endif
     return allowed;
 }
@@ -525,6 +643,12 @@ void StrokeEngine::disable() {
 
     // Disable _servo motor
     _servo->disableOutputs();
+    for (auxAxis &axis : _axes) {
+        if (axis.servo != NULL) {
+            axis.servo->disableOutputs();
+            axis.isCentered = false;
+        }
+    }
 
     // Delete homing Task
     if (_taskHomingHandle != NULL) {
@@ -534,24 +658,24 @@ void StrokeEngine::disable() {
 
 #ifdef DEBUG_TALKATIVE
     Serial.println("_servo disabled. Call home to continue.");
-    Serial.println("Stroke Engine State: " + verboseState[_state]);
+    Serial.print("Stroke Engine State: ");
+    Serial.println(verboseState[_state]);
 #endif
 }
 
 String StrokeEngine::getPatternName(int index) {
-    return String("Invalid");
+    if (index >= 0 && index < (int)patternTableSize) {
+        return String(patternTable[index]->getName());
+    } else {
+        return String("Invalid");
+    }
 }
 
 void StrokeEngine::setMaxSpeed(float maxSpeed) {
-    // Update pattern with new speed limits
-    if (xSemaphoreTake(_patternMutex, portMAX_DELAY) == pdTRUE) {
-        // Convert speed into steps
-        _maxStepPerSecond =
-            int(0.5 + _motor->maxSpeed * _motor->stepsPerMillimeter);
-        pattern->setSpeedLimit(_maxStepPerSecond, _maxStepAcceleration,
-                              _motor->stepsPerMillimeter);
-        xSemaphoreGive(_patternMutex);
-    }
+    // The pattern gets the new speed limits with the next stroke
+    // Convert speed into steps
+    _maxStepPerSecond = int(0.5 + maxSpeed * _motor->stepsPerMillimeter);
+    _publishSettings(0);
 }
 
 float StrokeEngine::getMaxSpeed() {
@@ -559,27 +683,142 @@ float StrokeEngine::getMaxSpeed() {
 }
 
 void StrokeEngine::setMaxAcceleration(float maxAcceleration) {
-    // Update pattern with new speed limits
-    if (xSemaphoreTake(_patternMutex, portMAX_DELAY) == pdTRUE) {
-        // Convert acceleration into steps
-        _maxStepAcceleration =
-            int(0.5 + _motor->maxAcceleration * _motor->stepsPerMillimeter);
-        pattern->setSpeedLimit(_maxStepPerSecond, _maxStepAcceleration,
-                              _motor->stepsPerMillimeter);
-        xSemaphoreGive(_patternMutex);
-    }
+    // The pattern gets the new speed limits with the next stroke
+    // Convert acceleration into steps
+    _maxStepAcceleration =
+        int(0.5 + maxAcceleration * _motor->stepsPerMillimeter);
+    _publishSettings(0);
 }
 
 float StrokeEngine::getMaxAcceleration() {
     return float(_maxStepAcceleration / _motor->stepsPerMillimeter);
 }
 
+bool StrokeEngine::attachAxis(unsigned int axis, machineGeometry *physics,
+                              motorProperties *motor,
+                              FastAccelStepper *servo) {
+    if (axis >= STROKE_ENGINE_AUX_AXES) {
+        return false;
+    }
+
+    // Limits in steps, the same way begin() derives them for the stroke
+    auxAxis attached = {};
+    if (servo != NULL) {
+        float travel = physics->physicalTravel - 2 * physics->keepoutBoundary;
+        attached.servo = servo;
+        attached.maxStep = int(0.5 + travel * motor->stepsPerMillimeter);
+        attached.maxStepPerSecond =
+            int(0.5 + motor->maxSpeed * motor->stepsPerMillimeter);
+        attached.maxStepAcceleration =
+            int(0.5 + motor->maxAcceleration * motor->stepsPerMillimeter);
+
+        servo->setDirectionPin(motor->directionPin, motor->invertDirection);
+        servo->setEnablePin(motor->enablePin, motor->enableActiveLow);
+        servo->setAutoEnable(false);
+        servo->disableOutputs();
+    }
+    _axes[axis] = attached;
+    return true;
+}
+
+float StrokeEngine::getAxisPosition(unsigned int axis) {
+    if (axis >= STROKE_ENGINE_AUX_AXES || _axes[axis].servo == NULL ||
+        _axes[axis].maxStep <= 0) {
+        return 0.0;
+    }
+    const auxAxis &aux = _axes[axis];
+    return 2.0 * aux.servo->getCurrentPosition() / aux.maxStep - 1.0;
+}
+
+void StrokeEngine::setJerk(float jerk) {
+    // Takes effect with the next move
+    // Convert jerk into steps
+    _stepJerk = int(0.5 + max(jerk, 0.0f) * _motor->stepsPerMillimeter);
+    _publishSettings(0);
+}
+
+float StrokeEngine::getJerk() {
+    return float(_stepJerk / _motor->stepsPerMillimeter);
+}
+
 void StrokeEngine::registerTelemetryCallback(void (*callbackTelemetry)(float,
                                                                        float,
                                                                        bool)) {
     _callbackTelemetry = callbackTelemetry;
 }
 
+void StrokeEngine::registerProfileCallback(
+    void (*callbackProfile)(ProfileSection, uint32_t)) {
+    _callbackProfile = callbackProfile;
+}
+
+void StrokeEngine::registerSegmentCallback(
+    void (*callbackSegment)(SegmentEdge, int, int)) {
+    _callbackSegment = callbackSegment;
+}
+
+void StrokeEngine::registerClipCallback(
+    void (*callbackClip)(const ClipEvent &)) {
+    _callbackClip = callbackClip;
+}
+
+void StrokeEngine::setSessionCounter(SessionCounter *session) {
+    _session = session;
+}
+
+void StrokeEngine::getTiming(StrokeTiming *timing) {
+    portENTER_CRITICAL(&_timingLock);
+    *timing = _timing;
+    int64_t session = _timingSession;
+    portEXIT_CRITICAL(&_timingLock);
+    timing->sessionMs = uint32_t((esp_timer_get_time() - session) / 1000);
+}
+
+void StrokeEngine::resetTiming() {
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&_timingLock);
+    _timing.reset();
+    _timingSession = now;
+    _segmentEnd = 0;
+    _segmentRunning = false;
+    portEXIT_CRITICAL(&_timingLock);
+    _clips.reset();
+}
+
+void StrokeEngine::getClipping(ClipCounters *counters) {
+    _clips.getCounters(counters);
+}
+
+void StrokeEngine::setLoopMode(LoopMode mode) {
+    _loopMode = mode;
+    if (_loopTimer != NULL && mode != LOOP_TIMER) {
+        esp_timer_stop(_loopTimer);
+    }
+    _startLoopTimer();
+
+#ifdef DEBUG_TALKATIVE
+    Serial.println("setLoopMode: " + String(_loopMode));
+#endif
+}
+
+LoopMode StrokeEngine::getLoopMode() { return _loopMode; }
+
+void StrokeEngine::setLoopRate(int hz) {
+    _loopRate = constrain(hz, LOOP_RATE_MIN_HZ, LOOP_RATE_MAX_HZ);
+
+    // Restart a running timer with the new period
+    if (_loopTimer != NULL && esp_timer_is_active(_loopTimer)) {
+        esp_timer_stop(_loopTimer);
+        _startLoopTimer();
+    }
+
+#ifdef DEBUG_TALKATIVE
+    Serial.println("setLoopRate: " + String(_loopRate));
+#endif
+}
+
+int StrokeEngine::getLoopRate() { return _loopRate; }
+
 void StrokeEngine::_homingProcedure() {
     // Set feedrate for homing
     _servo->setSpeedInHz(_homeingSpeed);
@@ -637,8 +876,9 @@ void StrokeEngine::_homingProcedure() {
             break;
         }
 
-        // Pause the task for 20ms to allow other tasks
-        vTaskDelay(20 / portTICK_PERIOD_MS);
+        // Pause the task for 20ms to allow other tasks, or check the switch
+        // again on the next tick of the loop timer
+        _loopDelay(20);
     }
 
     // disable _servo if homing has not found the homing switch
@@ -652,6 +892,7 @@ void StrokeEngine::_homingProcedure() {
 
     } else {
         // Set state to ready
+        _homeAxes();
         _state = READY;
 
 #ifdef DEBUG_TALKATIVE
@@ -670,7 +911,8 @@ void StrokeEngine::_homingProcedure() {
     }
 
 #ifdef DEBUG_TALKATIVE
-    Serial.println("Stroke Engine State: " + verboseState[_state]);
+    Serial.print("Stroke Engine State: ");
+    Serial.println(verboseState[_state]);
 #endif
 
     // delete one-time task
@@ -680,45 +922,98 @@ void StrokeEngine::_homingProcedure() {
 
 void StrokeEngine::_stroking() {
     motionParameter currentMotion;
+    plannedSegment segment;
 
     while (1) {  // infinite loop
 
-        // Suspend task, if not in PATTERN state
-        if (_state != PATTERN) {
+        // Suspend task, if not in PATTERN state and done braking an S-curve
+        if (_state != PATTERN && _curveActive == false) {
             vTaskSuspend(_taskStrokingHandle);
         }
+        uint32_t passStart = esp_cpu_get_cycle_count();
+
+        // Only the synchronous paths need the mutex. Taking segments from the
+        // look-ahead queue never waits for the planner, and the planner holds
+        // the mutex for one segment at a time only. Setters never take it.
+
+        // Pick up new settings at the segment boundary
+        if (_hasNewSettings() &&
+            xSemaphoreTake(_patternMutex, portMAX_DELAY) == pdTRUE) {
+            _takeSettings();
+            xSemaphoreGive(_patternMutex);
+        }
 
-        // Take mutex to ensure no interference / race condition with
-        // communication threat on other core
-        if (xSemaphoreTake(_patternMutex, 0) == pdTRUE) {
-            if (_applyUpdate == true) {
+        // Keep the servo queue of a running S-curve filled
+        if (_curveActive) {
+            _feedSCurve();
+        }
+
+        if (_state != PATTERN) {
+            // Stopped, only the braking tail of an S-curve is left to feed
+        } else if (_applyUpdate == true && _curveActive) {
+            // An S-curve can't be retargeted on the fly. Let it finish, the
+            // next stroke is planned with the new parameters.
+            if (xSemaphoreTake(_patternMutex, portMAX_DELAY) == pdTRUE) {
+                _applyUpdate = false;
+                _flushPlan();
+                xSemaphoreGive(_patternMutex);
+            }
+        } else if (_applyUpdate == true) {
+            // Take mutex to ensure no interference / race condition with
+            // the planner on the other core
+            if (xSemaphoreTake(_patternMutex, portMAX_DELAY) == pdTRUE) {
                 // Ask pattern for update on motion parameters
-                currentMotion = pattern->nextTarget(_index);
+                currentMotion = pattern->target(_index);
 
-                // Increase deceleration if required to avoid crash
-                if (_servo->getAcceleration() > currentMotion.acceleration) {
-#ifdef DEBUG_CLIPPING
-                    Serial.print("Crash avoidance! Set Acceleration from " +
-                                 String(currentMotion.acceleration));
-                    Serial.println(" to " + String(_servo->getAcceleration()));
-#endif
-                    currentMotion.acceleration = _servo->getAcceleration();
-                }
+                // Blend into the new move from the current speed. Brake
+                // harder only if needed to not overshoot or hit the envelope.
+                _retarget(&currentMotion);
 
                 // Apply new trapezoidal motion profile to _servo
                 _applyMotionProfile(&currentMotion);
 
-                // clear update flag
+                // clear update flag and re-plan after the current index
                 _applyUpdate = false;
+                _flushPlan();
+
+                // give back mutex
+                xSemaphoreGive(_patternMutex);
             }
+        }
 
-            // If motor has stopped issue moveTo command to next position
-            else if (_servo->isRunning() == false) {
+        // If motor has stopped issue moveTo command to next position
+        else if (_curveActive == false && _servo->isRunning() == false) {
+            // Timestamp the end of the previous move
+            _recordSegmentFinish();
+
+            // Drop segments that were planned before the last flush
+            bool planned = false;
+            while (_queue.pop(&segment)) {
+                if (segment.index == _index + 1) {
+                    planned = true;
+                    break;
+                }
+            }
+
+            if (planned) {
+                _index = segment.index;
+                currentMotion = segment.motion;
+#ifdef DEBUG_STROKE
+                Serial.println("Stroking Index: " + String(_index));
+#endif
+                // Apply new trapezoidal motion profile to _servo
+                _applyMotionProfile(&currentMotion);
+
+                // Refill the slot in the background
+                xTaskNotifyGive(_taskPlanningHandle);
+
+            } else if (xSemaphoreTake(_patternMutex, portMAX_DELAY) == pdTRUE) {
+                // Queue ran dry or pattern can't be planned ahead
                 // Increment index for pattern
                 _index++;
 
                 // Querey new set of pattern parameters
-                currentMotion = pattern->nextTarget(_index);
+                currentMotion = pattern->target(_index);
 
                 // Pattern may introduce pauses between strokes
                 if (currentMotion.skip == false) {
@@ -733,75 +1028,492 @@ void StrokeEngine::_stroking() {
                     // valid stroke parameters are delivered
                     _index--;
                 }
+
+                // Planner continues after this index
+                _flushPlan();
+
+                // give back mutex
+                xSemaphoreGive(_patternMutex);
             }
+        }
 
-            // give back mutex
+        if (_callbackProfile != NULL) {
+            _callbackProfile(PROFILE_STROKING,
+                             esp_cpu_get_cycle_count() - passStart);
+        }
+
+        if (_loopMode == LOOP_MOVE_COMPLETION) {
+            // Sleep until the move is about to finish
+            _waitForMotion();
+        } else if (_loopMode == LOOP_TIMER) {
+            // Sleep until the next tick of the loop timer
+            _loopDelay(10);
+        } else {
+            // Delay 10ms
+            vTaskDelay(10 / portTICK_PERIOD_MS);
+        }
+    }
+}
+
+void StrokeEngine::_planning() {
+    plannedSegment segment;
+
+    while (1) {  // infinite loop
+
+        // Wait for the executor taking a segment, a flush or new settings
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        if (_hasNewSettings() &&
+            xSemaphoreTake(_patternMutex, portMAX_DELAY) == pdTRUE) {
+            _takeSettings();
             xSemaphoreGive(_patternMutex);
         }
 
-        // Delay 10ms
-        vTaskDelay(10 / portTICK_PERIOD_MS);
+        // The mutex is held for one segment at a time, so the stroking task
+        // never waits long for it
+        bool planning = true;
+        while (planning &&
+               xSemaphoreTake(_patternMutex, portMAX_DELAY) == pdTRUE) {
+            planning = _state == PATTERN && pattern->canPlanAhead() &&
+                       !_queue.isFull();
+            if (planning) {
+                segment.index = _plannedIndex + 1;
+                segment.motion = pattern->target(segment.index);
+
+                // Pauses are left to the executor
+                planning = segment.motion.skip == false;
+            }
+            if (planning) {
+                _queue.push(segment);
+                _plannedIndex = segment.index;
+            }
+
+            xSemaphoreGive(_patternMutex);
+        }
+    }
+}
+
+void StrokeEngine::_flushPlan() {
+    // Must be called while holding _patternMutex
+    _queue.flush();
+    _plannedIndex = _index;
+
+    if (_taskPlanningHandle != NULL) {
+        xTaskNotifyGive(_taskPlanningHandle);
     }
 }
 
+void StrokeEngine::beginUpdate() {
+    _isUpdating = true;
+    _hasHeldSettings = false;
+    _heldEvents = 0;
+}
+
+void StrokeEngine::endUpdate() {
+    _isUpdating = false;
+    if (_hasHeldSettings) {
+        _hasHeldSettings = false;
+        _commitSettings(_heldEvents);
+    }
+}
+
+void StrokeEngine::_publishSettings(uint8_t events) {
+    // Within an update the setters only collect their events
+    if (_isUpdating) {
+        _hasHeldSettings = true;
+        _heldEvents |= events;
+        return;
+    }
+    _commitSettings(events);
+}
+
+void StrokeEngine::_commitSettings(uint8_t events) {
+    // Setters on different tasks take turns publishing, the motion tasks
+    // never wait for them
+    motionSettings settings;
+    settings.pattern = _selected;
+    settings.timeOfStroke = _timeOfStroke;
+    settings.depth = _depth;
+    settings.stroke = _stroke;
+    settings.sensation = _sensation;
+    settings.maxStepPerSecond = _maxStepPerSecond;
+    settings.maxStepAcceleration = _maxStepAcceleration;
+    settings.stepJerk = _stepJerk;
+    portENTER_CRITICAL(&_settingsLock);
+    _settings.publish(settings);
+    _settingsEvents.fetch_or(events);
+    portEXIT_CRITICAL(&_settingsLock);
+
+    // The planner takes them over in the background, an immediate update
+    // is up to the stroking task
+    if (_taskPlanningHandle != NULL) {
+        xTaskNotifyGive(_taskPlanningHandle);
+    }
+    if ((events & SETTINGS_APPLY_NOW) && _state == PATTERN) {
+        _wakeStroking();
+    }
+}
+
+bool StrokeEngine::_hasNewSettings() {
+    return _settings.isFresh() || _settingsEvents.load() != 0;
+}
+
+void StrokeEngine::_takeSettings() {
+    // Must be called while holding _patternMutex
+    uint8_t events = _settingsEvents.exchange(0);
+    motionSettings next = _active;
+    _settings.take(next);
+    if (next.pattern == NULL) {
+        // Nothing published yet
+        return;
+    }
+
+    // A new pattern gets all parameters, a running one only what changed
+    bool restart = (events & SETTINGS_RESTART) || next.pattern != pattern;
+    if (restart) {
+        pattern = next.pattern;
+        _index = -1;
+    }
+    if (restart || next.maxStepPerSecond != _active.maxStepPerSecond ||
+        next.maxStepAcceleration != _active.maxStepAcceleration) {
+        pattern->setSpeedLimit(next.maxStepPerSecond, next.maxStepAcceleration,
+                              _motor->stepsPerMillimeter);
+    }
+    if (restart || next.timeOfStroke != _active.timeOfStroke) {
+        pattern->setTimeOfStroke(next.timeOfStroke);
+    }
+    if (restart || next.stroke != _active.stroke) {
+        pattern->setStroke(next.stroke);
+    }
+    if (restart || next.depth != _active.depth) {
+        pattern->setDepth(next.depth);
+    }
+    if (restart || next.sensation != _active.sensation) {
+        pattern->setSensation(next.sensation);
+    }
+    _active = next;
+    _flushPlan();
+
+    if ((events & SETTINGS_APPLY_NOW) && _state == PATTERN) {
+        _applyUpdate = true;
+    }
+}
+
+void StrokeEngine::_wakeStroking() {
+    if (_loopMode != LOOP_POLLING && _taskStrokingHandle != NULL) {
+        xTaskNotifyGive(_taskStrokingHandle);
+    }
+}
+
+void StrokeEngine::_loopTick() {
+    // Runs in the esp_timer task. Wakes the task that owns the motion.
+    TaskHandle_t task = _taskHomingHandle;
+    if (_state == PATTERN) {
+        task = _taskStrokingHandle;
+    } else if (_state == STREAMING) {
+        task = _taskStreamingHandle;
+    }
+
+    if (task != NULL) {
+        xTaskNotifyGive(task);
+    } else {
+        // Nothing in motion, the next start arms the timer again
+        esp_timer_stop(_loopTimer);
+    }
+}
+
+void StrokeEngine::_startLoopTimer() {
+    if (_loopMode == LOOP_TIMER && _loopTimer != NULL &&
+        esp_timer_is_active(_loopTimer) == false) {
+        esp_timer_start_periodic(_loopTimer, 1000000 / _loopRate);
+    }
+}
+
+void StrokeEngine::_loopDelay(int ms) {
+    if (_loopMode == LOOP_TIMER) {
+        // The timeout is a safety net only
+        ulTaskNotifyTake(pdTRUE, max(ms / portTICK_PERIOD_MS, TickType_t(1)));
+    } else {
+        vTaskDelay(ms / portTICK_PERIOD_MS);
+    }
+}
+
+void StrokeEngine::_waitForMotion() {
+    // Come back to feed the next S-curve slices before the queue runs dry
+    if (_curveActive) {
+        TickType_t ticks = SCURVE_LOOKAHEAD_MS / 2 / portTICK_PERIOD_MS;
+        ulTaskNotifyTake(pdTRUE, max(ticks, TickType_t(1)));
+        return;
+    }
+
+    // Servo is idle while a pattern pauses between strokes. Check back with
+    // the pattern in 10ms, same as in polling mode.
+    if (_servo->isRunning() == false) {
+        ulTaskNotifyTake(pdTRUE, 10 / portTICK_PERIOD_MS);
+        return;
+    }
+
+    float remaining = 0.0;
+    int64_t now = esp_timer_get_time();
+    if (_curveEnd > now) {
+        // The last slices of an S-curve are queued, they end on schedule
+        remaining = (_curveEnd - now) / 1.0e6;
+    } else {
+        // Predict the remaining time from the actual state of the ramp, so a
+        // retargeted move or an early wake-up is handled alike
+        int distance = _servo->targetPos() - _servo->getCurrentPosition();
+        float speed = _servo->getCurrentSpeedInMilliHz() / 1000.0;
+        if (distance < 0) {
+            speed = -speed;
+        }
+        remaining =
+            trapezoidalMoveTime(distance, _servo->getSpeedInMilliHz() / 1000.0,
+                                _servo->getAcceleration(), speed);
+    }
+
+    // Arm the one-shot timer. Never below 250us to not flood the task with
+    // wake-ups while the last steps are executed.
+    uint64_t timeout = max(uint64_t(remaining * 1.0e6), uint64_t(250));
+    esp_timer_stop(_moveTimer);
+    esp_timer_start_once(_moveTimer, timeout);
+
+    // Block until the timer fires or a parameter update wakes us early. The
+    // timeout is a safety net only.
+    ulTaskNotifyTake(pdTRUE, 100 / portTICK_PERIOD_MS);
+}
+
 void StrokeEngine::_streaming() {
+    streamTarget target;
+    motionParameter currentMotion;
+    int64_t due = 0;
+
     while (1) {  // infinite loop
 
         // Suspend task, if not in STREAMING state
         if (_state != STREAMING) {
+            due = 0;
             vTaskSuspend(_taskStreamingHandle);
         }
 
-        // Delay 10ms
-        vTaskDelay(10 / portTICK_PERIOD_MS);
+        // Wait for the next target
+        if (xQueueReceive(_streamQueue, &target, 100 / portTICK_PERIOD_MS) !=
+            pdTRUE) {
+            continue;
+        }
+
+        // Jitter buffer: play out a fixed delay after arrival, but keep the
+        // spacing between targets the sender asked for
+        int64_t start = max(target.arrival + int64_t(_streamDelay) * 1000, due);
+        int64_t wait = start - esp_timer_get_time();
+        if (_loopMode == LOOP_TIMER) {
+            // Play out on the first tick at or after the start
+            while (wait > 0 && _state == STREAMING) {
+                _loopDelay(10);
+                wait = start - esp_timer_get_time();
+            }
+        } else if (wait > 1000) {
+            vTaskDelay(wait / 1000 / portTICK_PERIOD_MS);
+        }
+        due = start + int64_t(target.time) * 1000;
+
+        // State may have changed while waiting
+        if (_state != STREAMING) {
+            continue;
+        }
+
+        // Limits changed by the setters apply from this target on
+        if (_hasNewSettings() &&
+            xSemaphoreTake(_patternMutex, portMAX_DELAY) == pdTRUE) {
+            _takeSettings();
+            xSemaphoreGive(_patternMutex);
+        }
+
+        // Trapezoidal profile with 1/3 acceleration, 1/3 coasting and
+        // 1/3 deceleration, same as SimpleStroke
+        float distance = abs(target.position - _servo->getCurrentPosition());
+        float time = max(target.time, 1u) / 1000.0;
+        currentMotion.stroke = target.position;
+        currentMotion.speed = max(int(1.5 * distance / time), 1);
+        currentMotion.acceleration =
+            max(int(3.0 * currentMotion.speed / time), 1);
+        currentMotion.skip = (distance == 0);
+        currentMotion.jerk = 0;
+
+#ifdef DEBUG_STROKE
+        Serial.println("Streaming to: " + String(target.position) + " in " +
+                       String(target.time) + "ms");
+#endif
+
+        // Apply new trapezoidal motion profile to _servo
+        _applyMotionProfile(&currentMotion);
+    }
+}
+
+void StrokeEngine::_homeAxes() {
+    // The axes have no endstop, they are centered where they are. Homing
+    // again for the next session keeps the center.
+    for (auxAxis &axis : _axes) {
+        if (axis.servo != NULL) {
+            axis.servo->enableOutputs();
+            if (axis.isCentered == false) {
+                axis.servo->setCurrentPosition(axis.maxStep / 2);
+                axis.isCentered = true;
+            }
+        }
+    }
+}
+
+void StrokeEngine::_moveAxes(motionParameter *motion, float duration) {
+    for (int i = 0; i < STROKE_ENGINE_AUX_AXES; i++) {
+        const auxAxis &axis = _axes[i];
+        if (axis.servo == NULL) {
+            continue;
+        }
+
+        float aux = constrain(motion->aux[i], -1.0f, 1.0f);
+        int target = int(0.5 + (aux + 1.0) * 0.5 * axis.maxStep);
+        float distance = abs(target - axis.servo->getCurrentPosition());
+        if (distance == 0) {
+            continue;
+        }
+
+        // Same 1/3 ramps as a plain stroke, arriving with the stroke unless
+        // the axis is too slow for that. A stroke standing still gives the
+        // axis as long as its limits require.
+        float speed = axis.maxStepPerSecond;
+        float acceleration = axis.maxStepAcceleration;
+        if (duration > 0.0) {
+            speed = 1.5 * distance / duration;
+            acceleration = 3.0 * speed / duration;
+        }
+        if (speed > axis.maxStepPerSecond ||
+            acceleration > axis.maxStepAcceleration) {
+            planWithinLimits(distance, duration, axis.maxStepPerSecond,
+                             axis.maxStepAcceleration, speed, acceleration);
+        }
+
+        axis.servo->setSpeedInHz(
+            constrain(int(speed), 1, axis.maxStepPerSecond));
+        axis.servo->setAcceleration(
+            constrain(int(acceleration), 1, axis.maxStepAcceleration));
+        axis.servo->moveTo(target);
     }
 }
 
+void StrokeEngine::_stopAxes() {
+    for (auxAxis &axis : _axes) {
+        if (axis.servo != NULL) {
+            axis.servo->setAcceleration(axis.maxStepAcceleration);
+            axis.servo->applySpeedAcceleration();
+            axis.servo->stopMove();
+        }
+    }
+}
+
+void StrokeEngine::_retarget(motionParameter *motion) {
+    if (motion->skip == true || _servo->isRunning() == false) {
+        return;
+    }
+
+    int position = _servo->getCurrentPosition();
+    float speed = _servo->getCurrentSpeedInMilliHz() / 1000.0;
+    int target = constrain(motion->stroke, _minStep, _maxStep);
+    float room = speed > 0.0 ? _maxStep - position : position - _minStep;
+    int acceleration =
+        int(retargetAcceleration(target - position, speed,
+                                 motion->acceleration,
+                                 _active.maxStepAcceleration, room) +
+            0.5);
+
+    if (acceleration > motion->acceleration) {
+        _clips.record(CLIP_RETARGET, motion->acceleration, acceleration,
+                      esp_timer_get_time());
+    }
+    motion->acceleration = acceleration;
+}
+
 void StrokeEngine::_applyMotionProfile(motionParameter *motion) {
+    uint32_t start = esp_cpu_get_cycle_count();
     bool clipping = false;
     float speed = 0.0;
     float position = 0.0;
 
     // Apply new trapezoidal motion profile to _servo if pattern does not skip
     if (motion->skip == false) {
-        // Constrain speed to below _maxStepPerSecond
-        if (motion->speed > _maxStepPerSecond) {
-#ifdef DEBUG_CLIPPING
-            Serial.println(
-                "Max Speed Exceeded: " +
-                String(float(motion->speed / _motor->stepsPerMillimeter), 2) +
-                "mm/s --> Limit: " +
-                String(float(_maxStepPerSecond / _motor->stepsPerMillimeter),
-                       2) +
-                "mm/s");
-#endif
-            motion->speed = _maxStepPerSecond;
-            clipping = true;
-        }
-
-        // Constrain acceleration between 1 step/sec^2 and _maxStepAcceleration
-        if (motion->acceleration > _maxStepAcceleration) {
-#ifdef DEBUG_CLIPPING
-            Serial.println(
-                "Max Acceleration Exceeded: " +
-                String(float(motion->acceleration / _motor->stepsPerMillimeter),
-                       2) +
-                "mm/s² --> Limit: " +
-                String(float(_maxStepAcceleration / _motor->stepsPerMillimeter),
-                       2) +
-                "mm/s²");
-#endif
-            motion->acceleration = _maxStepAcceleration;
-            clipping = true;
+        // The previous move ends here, or was retargeted from here
+        if (_session != NULL && (_state == PATTERN || _state == STREAMING)) {
+            _session->reach(_servo->getCurrentPosition());
         }
 
         // Constrain stroke to motion envelope
         int pos = constrain((motion->stroke), _minStep, _maxStep);
 
-        // write values to _servo
-        _servo->setSpeedInHz(motion->speed);
-        _servo->setAcceleration(motion->acceleration);
-        _servo->moveTo(pos);
+        // Re-plan moves exceeding the speed or acceleration limit, so the
+        // stroke keeps its duration if possible and is as fast as physically
+        // possible otherwise
+        if (motion->speed > _active.maxStepPerSecond ||
+            motion->acceleration > _active.maxStepAcceleration) {
+            float distance = pos - _servo->getCurrentPosition();
+            float speed = motion->speed;
+            float acceleration = motion->acceleration;
+            float requested =
+                trapezoidalMoveTime(distance, speed, acceleration);
+            float achieved = planWithinLimits(
+                distance, requested, _active.maxStepPerSecond,
+                _active.maxStepAcceleration, speed, acceleration);
+
+            // Constrain to at least 1 step/sec and 1 step/sec^2
+            int64_t now = esp_timer_get_time();
+            int limitedSpeed =
+                constrain(int(speed), 1, _active.maxStepPerSecond);
+            int limitedAcceleration =
+                constrain(int(acceleration), 1, _active.maxStepAcceleration);
+            if (motion->speed > _active.maxStepPerSecond) {
+                _clips.record(CLIP_SPEED, motion->speed, limitedSpeed, now);
+            }
+            if (motion->acceleration > _active.maxStepAcceleration) {
+                _clips.record(CLIP_ACCELERATION, motion->acceleration,
+                              limitedAcceleration, now);
+            }
+            motion->speed = limitedSpeed;
+            motion->acceleration = limitedAcceleration;
+            clipping = achieved > requested;
+            if (clipping) {
+                _clips.record(CLIP_DURATION, int32_t(requested * 1e6),
+                              int32_t(achieved * 1e6), now);
+            }
+        }
+
+        // Patterns may follow a jerk-limited S-curve, which needs the servo
+        // to stand still at the start
+        int from = _servo->getCurrentPosition();
+        int jerk = motion->jerk > 0 ? motion->jerk : _active.stepJerk;
+        float duration = 0.0;
+        if (jerk > 0 && _state == PATTERN && _servo->isRunning() == false) {
+            _startSCurve(pos, motion->speed, motion->acceleration, jerk);
+            duration = _curve.getDuration();
+        } else {
+            // A retargeted move continues at the current speed
+            int distance = pos - from;
+            float startSpeed = _servo->getCurrentSpeedInMilliHz() / 1000.0;
+            if (distance < 0) {
+                startSpeed = -startSpeed;
+            }
+            duration = trapezoidalMoveTime(distance, motion->speed,
+                                           motion->acceleration, startSpeed);
+
+            // write values to _servo
+            _servo->setSpeedInHz(motion->speed);
+            _servo->setAcceleration(motion->acceleration);
+            _servo->moveTo(pos);
+        }
+
+        if (_state == PATTERN) {
+            _recordSegmentStart(from, pos, duration);
+
+            // Auxiliary axes start right after, on the same stepper engine
+            _moveAxes(motion, duration);
+        }
 
         // Compile speed telemetry data
         speed = float(motion->speed / _motor->stepsPerMillimeter);
@@ -822,6 +1534,185 @@ void StrokeEngine::_applyMotionProfile(motionParameter *motion) {
             _callbackTelemetry(position, speed, clipping);
         }
     }
+
+    if (_callbackProfile != NULL) {
+        _callbackProfile(PROFILE_MOTION_PROFILE,
+                         esp_cpu_get_cycle_count() - start);
+    }
+}
+
+void StrokeEngine::_recordSegmentStart(int from, int to, float duration) {
+    int64_t now = esp_timer_get_time();
+
+    portENTER_CRITICAL(&_timingLock);
+    // Retargeted moves don't have a finish, skip them
+    if (_segmentEnd > 0 && _segmentRunning == false) {
+        _timing.reversal.record(uint32_t(max(now - _segmentEnd, int64_t(0))));
+        if (_segmentPeriod > 0) {
+            _timing.period.record(
+                uint32_t((now - _segmentStart) * 100 / _segmentPeriod));
+        }
+    }
+    _segmentStart = now;
+    _segmentPeriod = int64_t(duration * 1.0e6);
+    _segmentEnd = now + _segmentPeriod;
+    _segmentRunning = true;
+    portEXIT_CRITICAL(&_timingLock);
+
+    _segmentFrom = from;
+    _segmentTo = to;
+    if (_callbackSegment != NULL) {
+        _callbackSegment(SEGMENT_START, from, to);
+    }
+}
+
+void StrokeEngine::_recordSegmentFinish() {
+    if (_segmentRunning == false) {
+        return;
+    }
+    int64_t now = esp_timer_get_time();
+
+    portENTER_CRITICAL(&_timingLock);
+    _timing.latency.record(uint32_t(max(now - _segmentEnd, int64_t(0))));
+    _segmentRunning = false;
+    portEXIT_CRITICAL(&_timingLock);
+
+    if (_callbackSegment != NULL) {
+        _callbackSegment(SEGMENT_FINISH, _segmentFrom, _segmentTo);
+    }
+}
+
+void StrokeEngine::_startSCurve(int target, int speed, int acceleration,
+                                int jerk) {
+    int distance = target - _servo->getCurrentPosition();
+
+    if (_curve.plan(distance, speed, acceleration, jerk) == false) {
+        _curveActive = false;
+        return;
+    }
+
+    // Played straight from the command queue, at most at the top speed
+    _executor.start(&_curve, distance < 0 ? -1 : 1,
+                    TICKS_PER_S / 1000 * SCURVE_SLICE_MS,
+                    TICKS_PER_S / max(_active.maxStepPerSecond, 1),
+                    TICKS_PER_S);
+    _curveEnd = esp_timer_get_time() + int64_t(_curve.getDuration() * 1.0e6);
+    _curveActive = true;
+    _isBrakeRequested = false;
+
+#ifdef DEBUG_STROKE
+    Serial.println("S-curve: " + String(_curve.getDuration(), 3) + "s");
+#endif
+
+    _feedSCurve();
+}
+
+void StrokeEngine::_feedSCurve() {
+    const uint32_t lookahead = TICKS_PER_S / 1000 * SCURVE_LOOKAHEAD_MS;
+
+    auto push = [this](const StepCommand &command) {
+        struct stepper_command_s entry = {
+            .ticks = command.ticks,
+            .steps = command.steps,
+            .count_up = command.countUp,
+        };
+        // A full queue takes the command with the next feed. The slices
+        // queued so far end at speed, an error brakes from there. A tail
+        // that is rejected as well is left to play out.
+        int8_t result = _servo->addQueueEntry(&entry, true);
+        if (result < 0) {
+            _clips.record(CLIP_REJECTED, result, 0, esp_timer_get_time());
+            if (_executor.isBraking()) {
+                _executor.stop();
+            }
+            _brakeSCurve();
+        }
+        return result == AQE_OK;
+    };
+
+    if (_isBrakeRequested) {
+        _isBrakeRequested = false;
+        _brakeSCurve();
+    }
+
+    while (_curveActive && _servo->ticksInQueue() < lookahead) {
+        if (_executor.feed(push) == false) {
+            // Queue is full, or all of the move is fed
+            _curveActive = _executor.isActive();
+            break;
+        }
+    }
+}
+
+void StrokeEngine::_brakeSCurve() {
+    // stopMove() only ends a ramp, the raw slices of an S-curve would play
+    // on. The queued ones do, every step stays counted, and a tail brakes
+    // from their speed as hard as allowed instead of the rest of the curve.
+    if (_executor.isBraking() == false) {
+        _executor.brake(_active.maxStepAcceleration, _curve.getJerk());
+    }
+    _curveActive = _executor.isActive();
+    _curveEnd = 0;
+}
+
+void StrokeEngine::_printClipping() {
+    // Everything the motion task recorded is formatted here, at leisure
+    char line[96];
+    ClipEvent event;
+    uint32_t dropped = 0;
+
+    for (;;) {
+        while (_clips.pop(event)) {
+            if (_callbackClip != NULL) {
+                _callbackClip(event);
+            }
+
+            float requested = event.requested / _motor->stepsPerMillimeter;
+            float limited = event.limited / _motor->stepsPerMillimeter;
+            unsigned long ms = (unsigned long)(event.time / 1000);
+
+            switch (event.type) {
+                case CLIP_SPEED:
+                    snprintf(line, sizeof(line),
+                             "%lu Limits Exceeded: %.2fmm/s --> %.2fmm/s", ms,
+                             requested, limited);
+                    break;
+                case CLIP_ACCELERATION:
+                    snprintf(line, sizeof(line),
+                             "%lu Limits Exceeded: %.2fmm/s² --> %.2fmm/s²",
+                             ms, requested, limited);
+                    break;
+                case CLIP_DURATION:
+                    snprintf(line, sizeof(line),
+                             "%lu Stroke stretched: %.3fs --> %.3fs", ms,
+                             event.requested / 1e6, event.limited / 1e6);
+                    break;
+                case CLIP_RETARGET:
+                    snprintf(line, sizeof(line),
+                             "%lu Retarget brake! Acceleration %.2fmm/s² --> "
+                             "%.2fmm/s²",
+                             ms, requested, limited);
+                    break;
+                default:
+                    snprintf(line, sizeof(line),
+                             "%lu S-curve command rejected: %ld", ms,
+                             (long)event.requested);
+                    break;
+            }
+            Serial.println(line);
+        }
+
+        ClipCounters counters;
+        _clips.getCounters(&counters);
+        if (counters.dropped > dropped) {
+            snprintf(line, sizeof(line), "%lu clipping events not printed",
+                     (unsigned long)(counters.dropped - dropped));
+            Serial.println(line);
+        }
+        dropped = counters.dropped;
+
+        vTaskDelay(100 / portTICK_PERIOD_MS);
+    }
 }
 
 void StrokeEngine::_setupDepths() {
@@ -13,7 +13,16 @@
 
 #include <Arduino.h>
 
+#include "ClipLog.h"
 #include "FastAccelStepper.h"
+#include "ParameterBlock.h"
+#include "SCurve.h"
+#include "SegmentQueue.h"
+#include "SessionCounter.h"
+#include "StepQueue.h"
+#include "StrokeTiming.h"
+#include "esp_cpu.h"
+#include "esp_timer.h"
 #include "pattern.h"
 
 // Debug Levels
@@ -21,7 +30,8 @@
 // StrokeEngine on Serial #define DEBUG_STROKE                // Show debug
 // messaged for each individual stroke on Serial
 #define DEBUG_CLIPPING  // Show debug messages when motions violating the
-                        // machine physics are commanded
+                        // machine physics are commanded. They are printed
+                        // by a low priority task, never by the motion task
 
 /**************************************************************************/
 /*!
@@ -88,8 +98,118 @@ typedef enum {
     STREAMING    //!< Tracks the depth-position whenever depth is updated.
 } ServoState;
 
+/**************************************************************************/
+/*!
+  @brief  Enum selecting how the stroking task waits for the end of a move
+*/
+/**************************************************************************/
+typedef enum {
+    LOOP_POLLING,         //!< Poll the servo every 10ms whether the move has
+                          //!< finished.
+    LOOP_MOVE_COMPLETION,  //!< Block until the predicted end of the move. A
+                           //!< timer or an immediate update wakes the task.
+    LOOP_TIMER  //!< A periodic timer wakes the motion tasks at the loop rate,
+                //!< independent of the FreeRTOS tick.
+} LoopMode;
+
+/**************************************************************************/
+/*!
+  @brief  Enum naming the hot paths reported to the profile callback
+*/
+/**************************************************************************/
+typedef enum {
+    PROFILE_STROKING,        //!< One pass of the stroking task's loop
+    PROFILE_MOTION_PROFILE,  //!< Handing one move to the servo
+} ProfileSection;
+
+/**************************************************************************/
+/*!
+  @brief  Enum naming the edges of a pattern move reported to the segment
+  callback
+*/
+/**************************************************************************/
+typedef enum {
+    SEGMENT_START,   //!< The move was handed to the servo
+    SEGMENT_FINISH,  //!< The servo came to a stop at the end of the move
+} SegmentEdge;
+
+// Number of position targets the streaming jitter buffer can hold
+#ifndef STREAM_BUFFER_LENGTH
+#define STREAM_BUFFER_LENGTH 8
+#endif
+
+// Default delay between the arrival and the execution of a streamed target
+#ifndef STREAM_PLAYOUT_DELAY_MS
+#define STREAM_PLAYOUT_DELAY_MS 30
+#endif
+
+// S-curve moves are fed to the servo's command queue as constant speed slices
+// of this length
+#ifndef SCURVE_SLICE_MS
+#define SCURVE_SLICE_MS 5
+#endif
+
+// How far ahead S-curve slices are queued. A stop lets the queued slices play
+// and brakes from their speed.
+#ifndef SCURVE_LOOKAHEAD_MS
+#define SCURVE_LOOKAHEAD_MS 40
+#endif
+
+// Default and range of the loop rate in LOOP_TIMER
+#ifndef LOOP_RATE_HZ
+#define LOOP_RATE_HZ 1000
+#endif
+#define LOOP_RATE_MIN_HZ 500
+#define LOOP_RATE_MAX_HZ 2000
+
+/**************************************************************************/
+/*!
+  @brief  Timed position target of the STREAMING mode
+*/
+/**************************************************************************/
+typedef struct {
+    int position;       //!< Absolute target position in steps
+    unsigned int time;  //!< Time to reach the target in ms
+    int64_t arrival;    //!< Time the target was received in us
+} streamTarget;
+
+/**************************************************************************/
+/*!
+  @brief  Parameters of the motion, handed from the setters to the motion
+  tasks through a ParameterBlock. Lengths in steps, times in seconds.
+*/
+/**************************************************************************/
+typedef struct {
+    Pattern *pattern;         //!< Pattern to play
+    float timeOfStroke;       //!< Time of a full stroke in [s]
+    int depth;                //!< Depth in [steps]
+    int stroke;               //!< Stroke in [steps]
+    float sensation;          //!< Sensation from -100 to 100
+    int maxStepPerSecond;     //!< Speed limit in [steps/s]
+    int maxStepAcceleration;  //!< Acceleration limit in [steps/s²]
+    int stepJerk;             //!< Jerk of pattern moves in [steps/s³]
+} motionSettings;
+
+/**************************************************************************/
+/*!
+  @brief  Auxiliary axis moving along with the stroke, in steps of its own
+  motor
+*/
+/**************************************************************************/
+typedef struct {
+    FastAccelStepper *servo;  //!< Stepper of the axis, NULL if not attached
+    int maxStep;              //!< Travel of the axis in [steps]
+    int maxStepPerSecond;     //!< Speed limit in [steps/s]
+    int maxStepAcceleration;  //!< Acceleration limit in [steps/s²]
+    bool isCentered;          //!< Position is known, kept over begin()
+} auxAxis;
+
+// Events that come along with a motionSettings block
+#define SETTINGS_APPLY_NOW 0x01  // Retarget the running move
+#define SETTINGS_RESTART 0x02    // Start the pattern over from index 0
+
 // Verbose strings of states for debugging purposes
-static String verboseState[] = {
+static const char *const verboseState[] = {
     "[0] Servo disabled", "[1] Servo ready", "[2] Servo pattern running",
     "[3] Servo setup depth", "[4] Servo position streaming"};
 
@@ -204,7 +324,7 @@ class StrokeEngine {
                     pattern will be retained.
     */
     /**************************************************************************/
-    bool setPattern(Pattern *nextPattern, bool applyNow);
+    bool setPattern(int patternIndex, bool applyNow);
 
     /**************************************************************************/
     /*!
@@ -214,6 +334,34 @@ class StrokeEngine {
     /**************************************************************************/
     int getPattern();
 
+    /**************************************************************************/
+    /*!
+      @brief  Replaces the keyframes of the Custom pattern. If it is playing,
+      the new table takes effect with the next stroke, or immediately.
+      @param keyframes  Validated table, see decodeKeyframes()
+      @param applyNow Set to true if changes should take effect immediately
+    */
+    /**************************************************************************/
+    void setKeyframes(const KeyframeTable &keyframes, bool applyNow);
+
+    /**************************************************************************/
+    /*!
+      @brief  Starts an update of several settings. The setters called until
+      endUpdate() are handed to the motion tasks together, so they never
+      work with only some of them. All of them have to be called from the
+      task that started the update.
+    */
+    /**************************************************************************/
+    void beginUpdate();
+
+    /**************************************************************************/
+    /*!
+      @brief  Hands the settings of the update to the motion tasks in one go.
+      They take effect immediately if any of the setters asked for it.
+    */
+    /**************************************************************************/
+    void endUpdate();
+
     /**************************************************************************/
     /*!
       @brief  Creates a FreeRTOS task to run a stroking pattern. Only valid in
@@ -224,6 +372,50 @@ class StrokeEngine {
     /**************************************************************************/
     bool startPattern();
 
+    /**************************************************************************/
+    /*!
+      @brief  Like startPattern(), but plays the script preloaded into
+      scriptPattern on its clock instead of the selected pattern. The next
+      startPattern() goes back to the selected one.
+      @return TRUE when task was created and motion starts, FALSE on failure.
+    */
+    /**************************************************************************/
+    bool startScript();
+
+    /**************************************************************************/
+    /*!
+      @brief  Creates a FreeRTOS task to follow streamed position targets. Only
+      valid in state READY. If the task is running, state is STREAMING and
+      targets can be given with streamTo().
+      @return TRUE when task was created and streaming starts, FALSE on failure.
+    */
+    /**************************************************************************/
+    bool startStreaming();
+
+    /**************************************************************************/
+    /*!
+      @brief  Queues a timed position target in state STREAMING. Targets are
+      played out in order with a fixed delay after their arrival to absorb
+      jitter of the transport, but never before the time of the previous target
+      has elapsed. Each target becomes a trapezoidal move with 1/3
+      acceleration, 1/3 coasting and 1/3 deceleration. If the buffer is full
+      the oldest target is dropped.
+      @param position Target position in [mm]. Is constrained from 0 to TRAVEL
+      @param time     Time in [ms] the move should take to complete
+      @return TRUE if the target was queued, FALSE if not in state STREAMING.
+    */
+    /**************************************************************************/
+    bool streamTo(float position, unsigned int time);
+
+    /**************************************************************************/
+    /*!
+      @brief  Set the delay of the streaming jitter buffer. Larger values
+      smooth out irregular transports at the cost of latency.
+      @param delay Delay between arrival and execution of a target in [ms]
+    */
+    /**************************************************************************/
+    void setStreamingDelay(unsigned int delay);
+
     /**************************************************************************/
     /*!
       @brief  Stops the motion with MAX_ACCEL and deletes the stroking task. Is
@@ -340,7 +532,7 @@ class StrokeEngine {
       @return The number of pattern available.
     */
     /**************************************************************************/
-    unsigned int getNumberOfPattern() { return 0; };
+    unsigned int getNumberOfPattern() { return patternTableSize; };
 
     /**************************************************************************/
     /*!
@@ -376,6 +568,54 @@ class StrokeEngine {
     /**************************************************************************/
     float getMaxAcceleration();
 
+    /**************************************************************************/
+    /*!
+      @brief  Attaches an auxiliary axis, e.g. a twist, that patterns move
+      along with the stroke. Its moves start together with each stroke and
+      take the same time, as far as its own limits allow. The axis has no
+      homing of its own: whatever position it is in when the StrokeEngine
+      is homed the first time becomes the center of its travel, until
+      disable(). Stays attached over begin().
+      @param axis index of the axis, below STROKE_ENGINE_AUX_AXES
+      @param physics travel of the axis, in the units of the motor. A rotary
+      axis may use degrees and steps per degree alike.
+      @param motor limits and pins of the motor of the axis
+      @param servo stepper of the same FastAccelStepperEngine, NULL detaches
+      the axis
+      @return true on success, false if the axis doesn't exist
+    */
+    /**************************************************************************/
+    bool attachAxis(unsigned int axis, machineGeometry *physics,
+                    motorProperties *motor, FastAccelStepper *servo);
+
+    /**************************************************************************/
+    /*!
+      @brief  Position of an auxiliary axis
+      @param axis index of the axis
+      @return position from -1 to 1 across its travel, 0 if not attached
+    */
+    /**************************************************************************/
+    float getAxisPosition(unsigned int axis);
+
+    /**************************************************************************/
+    /*!
+      @brief  Sets the jerk limit of pattern moves. With a limit moves follow
+      a jerk-limited S-curve profile instead of a trapezoid, unless the
+      pattern requests its own jerk. Speed and acceleration limits still
+      apply. Streaming and depth setup always use trapezoids.
+      @param jerk jerk in mm/s³, 0 for trapezoidal moves
+    */
+    /**************************************************************************/
+    void setJerk(float jerk);
+
+    /**************************************************************************/
+    /*!
+      @brief  Get the current jerk limit of pattern moves
+      @return jerk in mm/s³, 0 for trapezoidal moves
+    */
+    /**************************************************************************/
+    float getJerk();
+
     /**************************************************************************/
     /*!
       @brief  Register a callback function that will update telemetry
@@ -390,6 +630,120 @@ class StrokeEngine {
     void registerTelemetryCallback(void (*callbackTelemetry)(float, float,
                                                              bool));
 
+    /**************************************************************************/
+    /*!
+      @brief  Register a callback function that receives every clipped motion
+      traced with DEBUG_CLIPPING, as recorded. It is called from the task that
+      prints them, never from the motion task.
+      @param callbackClip Function must be of type:
+      void callbackClip(const ClipEvent &event)
+    */
+    /**************************************************************************/
+    void registerClipCallback(void (*callbackClip)(const ClipEvent &));
+
+    /**************************************************************************/
+    /*!
+      @brief  Register a callback function that receives how long the hot
+      paths of the StrokeEngine took, in CPU cycles. It is called from the
+      motion tasks right after the section, so it must be quick. Without a
+      callback the sections aren't timed at all.
+      @param callbackProfile Function must be of type:
+      void callbackProfile(ProfileSection section, uint32_t cycles)
+    */
+    /**************************************************************************/
+    void registerProfileCallback(void (*callbackProfile)(ProfileSection,
+                                                         uint32_t));
+
+    /**************************************************************************/
+    /*!
+      @brief  Register a callback function that is called at both ends of
+      every pattern move, with the position the move started from and its
+      target in steps. It is called from the stroking task the moment the
+      edge is seen, so it must be quick. A retargeted move starts over
+      without a finish. Streaming and depth setup don't report segments.
+      @param callbackSegment Function must be of type:
+      void callbackSegment(SegmentEdge edge, int from, int to)
+    */
+    /**************************************************************************/
+    void registerSegmentCallback(void (*callbackSegment)(SegmentEdge, int,
+                                                         int));
+
+    /**************************************************************************/
+    /*!
+      @brief  Counts the strokes and distance of patterns and streaming.
+      Every move reports the position it starts from to the counter.
+      @param session counter to report to, NULL to stop counting
+    */
+    /**************************************************************************/
+    void setSessionCounter(SessionCounter *session);
+
+    /**************************************************************************/
+    /*!
+      @brief  Copies the timing statistics of the current session: reversal
+      dead time, actual vs commanded stroke period and the latency of the
+      stroking task. Safe to call from any task.
+      @param timing receives a snapshot of the statistics
+    */
+    /**************************************************************************/
+    void getTiming(StrokeTiming *timing);
+
+    /**************************************************************************/
+    /*!
+      @brief  Clears the timing statistics and starts a new session.
+    */
+    /**************************************************************************/
+    void resetTiming();
+
+    /**************************************************************************/
+    /*!
+      @brief  Copies how often motions were clipped to the machine physics
+      in the current session, by type. Counted with or without
+      DEBUG_CLIPPING, cleared by resetTiming(). Safe to call from any task.
+      @param counters receives a snapshot of the counters
+    */
+    /**************************************************************************/
+    void getClipping(ClipCounters *counters);
+
+    /**************************************************************************/
+    /*!
+      @brief  Selects how the stroking task waits for a move to finish. In
+      LOOP_POLLING the task checks the servo every 10ms, which adds up to 10ms
+      of dead time at every reversal. In LOOP_MOVE_COMPLETION the task sleeps
+      until the predicted end of the current ramp and issues the next target
+      the moment the servo comes to a halt. In LOOP_TIMER a periodic esp_timer
+      wakes the stroking, streaming and homing tasks at the loop rate: segment
+      hand-off, settings pickup and the play-out of streamed targets happen on
+      its ticks, whatever configTICK_RATE_HZ is.
+      @param mode LOOP_POLLING, LOOP_MOVE_COMPLETION or LOOP_TIMER
+    */
+    /**************************************************************************/
+    void setLoopMode(LoopMode mode);
+
+    /**************************************************************************/
+    /*!
+      @brief  Get the current loop mode of the stroking task
+      @return LOOP_POLLING, LOOP_MOVE_COMPLETION or LOOP_TIMER
+    */
+    /**************************************************************************/
+    LoopMode getLoopMode();
+
+    /**************************************************************************/
+    /*!
+      @brief  Sets how often the timer of LOOP_TIMER wakes the motion tasks.
+      Takes effect immediately, also while running.
+      @param hz rate in Hz, constrained to LOOP_RATE_MIN_HZ - LOOP_RATE_MAX_HZ
+    */
+    /**************************************************************************/
+    void setLoopRate(int hz);
+
+    /**************************************************************************/
+    /*!
+      @brief  Get the rate of the loop timer
+      @return rate in Hz
+    */
+    /**************************************************************************/
+    int getLoopRate();
+
   protected:
     ServoState _state = UNDEFINED;
     motorProperties *_motor;
@@ -399,7 +753,9 @@ class StrokeEngine {
     int _maxStep;
     int _maxStepPerSecond;
     int _maxStepAcceleration;
-    Pattern *pattern = new SimpleStroke("Simple Stroke");
+    int _stepJerk = 0;
+    Pattern *pattern = patternTable[0];
+    int _patternIndex = 0;
     bool _isHomed = false;
     int _index = 0;
     int _depth;
@@ -409,6 +765,7 @@ class StrokeEngine {
     float _timeOfStroke;
     float _sensation;
     bool _applyUpdate = false;
+    bool _startPattern(Pattern *selected);
     static void _homingProcedureImpl(void *_this) {
         static_cast<StrokeEngine *>(_this)->_homingProcedure();
     }
@@ -421,13 +778,84 @@ class StrokeEngine {
         static_cast<StrokeEngine *>(_this)->_streaming();
     }
     void _streaming();
+    static void _moveTimerImpl(void *_this) {
+        static_cast<StrokeEngine *>(_this)->_wakeStroking();
+    }
+    void _wakeStroking();
+    void _waitForMotion();
+    static void _loopTimerImpl(void *_this) {
+        static_cast<StrokeEngine *>(_this)->_loopTick();
+    }
+    void _loopTick();
+    void _startLoopTimer();
+    void _loopDelay(int ms);
+    static void _planningImpl(void *_this) {
+        static_cast<StrokeEngine *>(_this)->_planning();
+    }
+    void _planning();
+    void _flushPlan();
+    SegmentQueue _queue;
+    int _plannedIndex = -1;
+    TaskHandle_t _taskPlanningHandle = NULL;
+    LoopMode _loopMode = LOOP_POLLING;
+    esp_timer_handle_t _moveTimer = NULL;
+    esp_timer_handle_t _loopTimer = NULL;
+    int _loopRate = LOOP_RATE_HZ;
     TaskHandle_t _taskStrokingHandle = NULL;
     TaskHandle_t _taskHomingHandle = NULL;
     TaskHandle_t _taskStreamingHandle = NULL;
+    QueueHandle_t _streamQueue = NULL;
+    unsigned int _streamDelay = STREAM_PLAYOUT_DELAY_MS;
     SemaphoreHandle_t _patternMutex = xSemaphoreCreateMutex();
+    Pattern *_selected = patternTable[0];  // Pattern the setters picked
+    portMUX_TYPE _settingsLock = portMUX_INITIALIZER_UNLOCKED;
+    ParameterBlock<motionSettings> _settings;
+    std::atomic<uint8_t> _settingsEvents{0};
+    motionSettings _active = {};  // Settings the motion tasks work with
+    bool _isUpdating = false;  // Setters are held back for endUpdate()
+    bool _hasHeldSettings = false;
+    uint8_t _heldEvents = 0;
+    void _publishSettings(uint8_t events);
+    void _commitSettings(uint8_t events);
+    bool _hasNewSettings();
+    void _takeSettings();
+    SessionCounter *_session = NULL;
+    auxAxis _axes[STROKE_ENGINE_AUX_AXES] = {};
+    void _homeAxes();
+    void _moveAxes(motionParameter *motion, float duration);
+    void _stopAxes();
+    void _retarget(motionParameter *motion);
     void _applyMotionProfile(motionParameter *motion);
+    void _startSCurve(int target, int speed, int acceleration, int jerk);
+    void _feedSCurve();
+    void _brakeSCurve();
+    SCurveProfile _curve;
+    StepQueueExecutor _executor;
+    bool _curveActive = false;  // Slices of the S-curve are left to feed
+    volatile bool _isBrakeRequested = false;  // stopMotion() waits for it
+    int64_t _curveEnd = 0;  // esp_timer time the S-curve move finishes
+    StrokeTiming _timing;
+    portMUX_TYPE _timingLock = portMUX_INITIALIZER_UNLOCKED;
+    int64_t _timingSession = 0;   // esp_timer time the session started
+    int64_t _segmentStart = 0;    // esp_timer time the last move was issued
+    int64_t _segmentEnd = 0;      // predicted esp_timer time it finishes
+    int64_t _segmentPeriod = 0;   // commanded duration in [µs]
+    bool _segmentRunning = false; // finish of the last move not seen yet
+    int _segmentFrom = 0;         // start position of the last move
+    int _segmentTo = 0;           // target position of the last move
+    void _recordSegmentStart(int from, int to, float duration);
+    void _recordSegmentFinish();
+    ClipLog<> _clips;
+    TaskHandle_t _taskClippingHandle = NULL;
+    static void _clippingImpl(void *_this) {
+        static_cast<StrokeEngine *>(_this)->_printClipping();
+    }
+    void _printClipping();
     void (*_callBackHomeing)(bool) = NULL;
     void (*_callbackTelemetry)(float, float, bool) = NULL;
+    void (*_callbackClip)(const ClipEvent &) = NULL;
+    void (*_callbackProfile)(ProfileSection, uint32_t) = NULL;
+    void (*_callbackSegment)(SegmentEdge, int, int) = NULL;
     int _homeingSpeed;
     int _homeingPin;
     int _homeingToBack;
@@ -0,0 +1,88 @@
+/**
+ *   StrokeEngine
+ *   A library to create a variety of stroking motions with a stepper or servo
+ * motor on an ESP32. https://github.com/theelims/StrokeEngine
+ *
+ * Copyright (C) 2022 theelims <elims@gmx.net>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license.  See the LICENSE file for details.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+#define TIMING_BUCKETS 16  // Buckets of each timing histogram
+
+/**************************************************************************/
+/*!
+  @brief  Histogram with equally wide buckets. Values below the offset land
+  in the first, values beyond the last bucket in the last one. The layout is
+  packed, so it can be sent as is.
+  @tparam Offset  lower bound of the first bucket
+  @tparam Width   width of a bucket
+*/
+/**************************************************************************/
+template <uint32_t Offset, uint32_t Width>
+struct __attribute__((packed)) TimingHistogram {
+    uint32_t count;
+    uint32_t minimum;
+    uint32_t maximum;
+    uint64_t sum;
+    uint16_t buckets[TIMING_BUCKETS];  //!< Saturate at 65535
+
+    //! Clears all counts
+    void reset() {
+        memset(this, 0, sizeof(*this));
+        minimum = UINT32_MAX;
+    }
+
+    //! Adds one value to the histogram
+    void record(uint32_t value) {
+        uint32_t bucket = value > Offset ? (value - Offset) / Width : 0;
+        if (bucket >= TIMING_BUCKETS) {
+            bucket = TIMING_BUCKETS - 1;
+        }
+        if (buckets[bucket] < UINT16_MAX) {
+            buckets[bucket]++;
+        }
+
+        count++;
+        sum += value;
+        minimum = value < minimum ? value : minimum;
+        maximum = value > maximum ? value : maximum;
+    }
+
+    //! Average of all values, 0 if there are none
+    uint32_t mean() const { return count > 0 ? uint32_t(sum / count) : 0; }
+};
+
+/**************************************************************************/
+/*!
+  @brief  Timing statistics of a stroking session, collected from the
+  timestamps of segment start and finish in the stroking task:
+  - reversal: standstill between two strokes, from the predicted end of a
+    move to the start of the next one, in [µs]. Includes pauses a pattern
+    asks for.
+  - period: time from one stroke to the next relative to the time the move
+    was commanded to take, in [%]. 100 means the machine keeps the rhythm.
+  - latency: delay between the predicted end of a move and the stroking task
+    noticing it, in [µs].
+*/
+/**************************************************************************/
+struct __attribute__((packed)) StrokeTiming {
+    uint32_t sessionMs;  //!< Duration of the session so far in [ms]
+    TimingHistogram<0, 2000> reversal;
+    TimingHistogram<80, 5> period;
+    TimingHistogram<0, 500> latency;
+
+    //! Starts a new session
+    void reset() {
+        sessionMs = 0;
+        reversal.reset();
+        period.reset();
+        latency.reset();
+    }
+};
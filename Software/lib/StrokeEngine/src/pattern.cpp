@@ -0,0 +1,88 @@
+/**
+ *   Patterns of the StrokeEngine
+ *   A library to create a variety of stroking motions with a stepper or servo
+ * motor on an ESP32. https://github.com/theelims/StrokeEngine
+ *
+ * Copyright (C) 2021 theelims <elims@gmx.net>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license.  See the LICENSE file for details.
+ */
+
+#include "pattern.h"
+
+/**************************************************************************/
+/*!
+  @brief  The cycle of the pattern that ran last, with the parameters it was
+  computed for. Only one pattern is asked for targets at a time, always under
+  the pattern mutex of the StrokeEngine.
+*/
+/**************************************************************************/
+static struct {
+    const Pattern *owner = NULL;
+    unsigned int length = 0;
+    int stroke;
+    int depth;
+    float timeOfStroke;
+    float sensation;
+    unsigned int maxSpeed;
+    unsigned int maxAcceleration;
+    unsigned int stepsPerMM;
+    motionParameter moves[PATTERN_CYCLE_MAX];
+} cycle;
+
+motionParameter Pattern::target(unsigned int index) {
+    unsigned int length = cycleLength();
+    if (length == 0 || length > PATTERN_CYCLE_MAX) {
+        return nextTarget(index);
+    }
+
+    bool isValid = cycle.owner == this && cycle.length == length &&
+                   cycle.stroke == _stroke && cycle.depth == _depth &&
+                   cycle.timeOfStroke == _timeOfStroke &&
+                   cycle.sensation == _sensation &&
+                   cycle.maxSpeed == _maxSpeed &&
+                   cycle.maxAcceleration == _maxAcceleration &&
+                   cycle.stepsPerMM == _stepsPerMM;
+    if (isValid == false) {
+        // From index 0 on, so patterns that count strokes start over
+        for (unsigned int i = 0; i < length; i++) {
+            cycle.moves[i] = nextTarget(i);
+        }
+        cycle.owner = this;
+        cycle.length = length;
+        cycle.stroke = _stroke;
+        cycle.depth = _depth;
+        cycle.timeOfStroke = _timeOfStroke;
+        cycle.sensation = _sensation;
+        cycle.maxSpeed = _maxSpeed;
+        cycle.maxAcceleration = _maxAcceleration;
+        cycle.stepsPerMM = _stepsPerMM;
+    }
+
+    _index = index;
+    _nextMove = cycle.moves[index % length];
+    return _nextMove;
+}
+
+static SimpleStroke simpleStroke("Simple Stroke");
+static TeasingPounding teasingPounding("Teasing Pounding");
+static RoboStroke roboStroke("Robo Stroke");
+static HalfnHalf halfnHalf("Half'n'Half");
+static Deeper deeper("Deeper");
+static StopNGo stopNGo("Stop'n'Go");
+static Insist insist("Insist");
+static Knot knot("Knot");
+static Struggle struggle("Struggle");
+TablePattern tablePattern("Custom");
+static Twist twist("Twist");
+
+Pattern *patternTable[] = {&simpleStroke, &teasingPounding, &roboStroke,
+                           &halfnHalf,    &deeper,          &stopNGo,
+                           &insist,       &knot,            &struggle,
+                           &tablePattern, &twist};
+
+const unsigned int patternTableSize =
+    sizeof(patternTable) / sizeof(patternTable[0]);
+
+ScriptPattern scriptPattern("Script");
@@ -14,6 +14,9 @@
 #include <Arduino.h>
 #include <math.h>
 
+#include "FixedPoint.h"
+#include "Keyframes.h"
+#include "ScriptBuffer.h"
 #include "PatternMath.h"
 
 #define DEBUG_PATTERN  // Print some debug informations over Serial
@@ -24,6 +27,17 @@
         // should exceed this value
 #endif
 
+// Number of auxiliary axes, e.g. a twist, a pattern can move along with
+// the stroke
+#ifndef STROKE_ENGINE_AUX_AXES
+#define STROKE_ENGINE_AUX_AXES 1
+#endif
+
+// Longest cycle of moves target() caches, longer ones are computed per index
+#ifndef PATTERN_CYCLE_MAX
+#define PATTERN_CYCLE_MAX 64
+#endif
+
 /**************************************************************************/
 /*!
   @brief  struct to return all parameters FastAccelStepper needs to calculate
@@ -37,6 +51,12 @@ typedef struct {
     int acceleration;  //!< Acceleration to get to speed or halt
     bool skip;  //!< no valid stroke, skip this set an query for the next -->
                 //!< allows pauses between strokes
+    int jerk;   //!< Jerk limit in Steps/second³ requesting an S-curve move.
+                //!< 0 leaves the choice to the StrokeEngine.
+    float aux[STROKE_ENGINE_AUX_AXES];  //!< Targets of the auxiliary axes
+                                        //!< from -1 to 1 across their travel,
+                                        //!< 0 is the center. Reached together
+                                        //!< with stroke.
 } motionParameter;
 
 /**************************************************************************/
@@ -65,7 +85,7 @@ class Pattern {
     /*!
       @param speed time of a full stroke in [sec]
     */
-    virtual void setTimeOfStroke(float speed) { _timeOfStroke = speed; }
+    virtual void setTimeOfStroke(float speed) { _setTimeOfStroke(speed); }
 
     //! Set the maximum stroke a pattern may have
     /*!
@@ -120,20 +140,59 @@ class Pattern {
         _stepsPerMM = stepsPerMM;
     }
 
+    //! Tells the StrokeEngine whether segments may be computed ahead of time
+    //! by the planner. Patterns creating pauses with _startDelay() depend on
+    //! being asked the moment the previous move has finished and must opt out.
+    /*!
+      @return True, if nextTarget() only depends on the index and parameters.
+    */
+    virtual bool canPlanAhead() { return true; }
+
+    //! Number of indices after which nextTarget() repeats itself, for
+    //! patterns whose moves only depend on the index within that cycle and on
+    //! the parameters. 0 opts out of the cycle cache, which patterns with
+    //! pauses, a clock or randomness must do.
+    /*!
+      @return cycle length in indices, or 0
+    */
+    virtual unsigned int cycleLength() { return 0; }
+
+    //! The move of an index, as nextTarget() would compute it. For patterns
+    //! with a cycleLength() the whole cycle is computed once for the current
+    //! parameters, after that it is a table lookup. Setting any parameter to
+    //! a new value invalidates the cycle. One cycle is cached for all
+    //! patterns, so switching patterns computes it again.
+    /*!
+      @param index index of a stroke. Increments with every new stroke.
+      @return Set of motion parameteres like speed, acceleration & position
+    */
+    motionParameter target(unsigned int index);
+
   protected:
     int _stroke;
     int _depth;
     float _timeOfStroke;
+    q16_t _strokeRate = 0;  //!< 1 / _timeOfStroke in Q16.16
     float _sensation = 0.0;
     int _index = -1;
     char _name[STRING_LEN];
-    motionParameter _nextMove = {0, 0, 0, false};
+    motionParameter _nextMove = {};
     int _startDelayMillis = 0;
     int _delayInMillis = 0;
     unsigned int _maxSpeed = 0;
     unsigned int _maxAcceleration = 0;
     unsigned int _stepsPerMM = 0;
 
+    /*!
+      @brief Sets the time of a stroke together with the rate the fixed-point
+      math in nextTarget() works with.
+      @param time time of a stroke in [sec]
+    */
+    void _setTimeOfStroke(float time) {
+        _timeOfStroke = time;
+        _strokeRate = q16Rate(time);
+    }
+
     /*!
       @brief Start a delay timer which can be polled by calling
       _isStillDelayed(). Uses internally the millis()-function.
@@ -168,17 +227,20 @@ class SimpleStroke : public Pattern {
   public:
     SimpleStroke(const char *str) : Pattern(str) {}
 
+    unsigned int cycleLength() { return 2; }
+
     void setTimeOfStroke(float speed = 0) {
         // In & Out have same time, so we need to divide by 2
-        _timeOfStroke = 0.5 * speed;
+        _setTimeOfStroke(0.5 * speed);
     }
 
     motionParameter nextTarget(unsigned int index) {
         // maximum speed of the trapezoidal motion
-        _nextMove.speed = int(1.5 * _stroke / _timeOfStroke);
+        _nextMove.speed = q16Scale(_stroke, toQ16(1.5), _strokeRate);
 
         // acceleration to meet the profile
-        _nextMove.acceleration = int(3.0 * _nextMove.speed / _timeOfStroke);
+        _nextMove.acceleration =
+            q16Scale(_nextMove.speed, toQ16(3.0), _strokeRate);
 
         // odd stroke is moving out
         if (index % 2) {
@@ -194,6 +256,29 @@ class SimpleStroke : public Pattern {
     }
 };
 
+/**************************************************************************/
+/*!
+  @brief  Simple Stroke with a twist. The strokes are the same as Simple
+  Stroke, while the first auxiliary axis turns one way on the way in and
+  back on the way out, arriving together with the stroke. Sensation sets
+  how far it turns, from not at all at -100 to the full travel of the axis
+  at 100. Without an auxiliary axis it plays like Simple Stroke.
+*/
+/**************************************************************************/
+class Twist : public SimpleStroke {
+  public:
+    Twist(const char *str) : SimpleStroke(str) {}
+
+    motionParameter nextTarget(unsigned int index) {
+        SimpleStroke::nextTarget(index);
+
+        // Turned in while moving in, back while moving out
+        float amount = (_sensation + 100.0) / 200.0;
+        _nextMove.aux[0] = (index % 2) ? -amount : amount;
+        return _nextMove;
+    }
+};
+
 /**************************************************************************/
 /*!
   @brief  Simple pattern where the sensation value can change the speed
@@ -206,32 +291,33 @@ class SimpleStroke : public Pattern {
 class TeasingPounding : public Pattern {
   public:
     TeasingPounding(const char *str) : Pattern(str) {}
+    unsigned int cycleLength() { return 2; }
     void setSensation(float sensation) {
         _sensation = sensation;
         _updateStrokeTiming();
     }
     void setTimeOfStroke(float speed = 0) {
-        _timeOfStroke = speed;
+        _setTimeOfStroke(speed);
         _updateStrokeTiming();
     }
     motionParameter nextTarget(unsigned int index) {
         // odd stroke is moving out
         if (index % 2) {
             // maximum speed of the trapezoidal motion
-            _nextMove.speed = int(1.5 * _stroke / _timeOfOutStroke);
+            _nextMove.speed = q16Scale(_stroke, toQ16(1.5), _outRate);
 
             // acceleration to meet the profile
             _nextMove.acceleration =
-                int(3.0 * float(_nextMove.speed) / _timeOfOutStroke);
+                q16Scale(_nextMove.speed, toQ16(3.0), _outRate);
             _nextMove.stroke = _depth - _stroke;
             // even stroke is moving in
         } else {
             // maximum speed of the trapezoidal motion
-            _nextMove.speed = int(1.5 * _stroke / _timeOfInStroke);
+            _nextMove.speed = q16Scale(_stroke, toQ16(1.5), _inRate);
 
             // acceleration to meet the profile
             _nextMove.acceleration =
-                int(3.0 * float(_nextMove.speed) / _timeOfInStroke);
+                q16Scale(_nextMove.speed, toQ16(3.0), _inRate);
             _nextMove.stroke = _depth;
         }
         _index = index;
@@ -240,13 +326,17 @@ class TeasingPounding : public Pattern {
 
   protected:
     float _timeOfFastStroke = 1.0;
+    // fscale(0.0, 100.0, 1.0, 5.0, x, 0.0), linear so two entries are exact
+    FscaleTable<2> _fastStrokeScale{1.0, 5.0};
     float _timeOfInStroke = 1.0;
     float _timeOfOutStroke = 1.0;
+    q16_t _inRate = Q16_ONE;
+    q16_t _outRate = Q16_ONE;
     void _updateStrokeTiming() {
         // calculate the time it takes to complete the faster stroke
         // Division by 2 because reference is a half stroke
         _timeOfFastStroke = (0.5 * _timeOfStroke) /
-                            fscale(0.0, 100.0, 1.0, 5.0, abs(_sensation), 0.0);
+                            _fastStrokeScale(abs(_sensation));
         // positive sensation, in is faster
         if (_sensation > 0.0) {
             _timeOfInStroke = _timeOfFastStroke;
@@ -256,6 +346,8 @@ class TeasingPounding : public Pattern {
             _timeOfOutStroke = _timeOfFastStroke;
             _timeOfInStroke = _timeOfStroke - _timeOfFastStroke;
         }
+        _inRate = q16Rate(_timeOfInStroke);
+        _outRate = q16Rate(_timeOfOutStroke);
 #ifdef DEBUG_PATTERN
         Serial.println("TimeOfInStroke: " + String(_timeOfInStroke));
         Serial.println("TimeOfOutStroke: " + String(_timeOfOutStroke));
@@ -275,19 +367,23 @@ class RoboStroke : public Pattern {
   public:
     RoboStroke(const char *str) : Pattern(str) {}
 
+    unsigned int cycleLength() { return 2; }
+
     void setTimeOfStroke(float speed = 0) {
         // In & Out have same time, so we need to divide by 2
-        _timeOfStroke = 0.5 * speed;
+        _setTimeOfStroke(0.5 * speed);
+        _updateRates();
     }
 
     void setSensation(float sensation = 0) {
         _sensation = sensation;
         // scale sensation into the range [0.05, 0.5] where 0 = 1/3
         if (sensation >= 0) {
-            _x = fscale(0.0, 100.0, 1.0 / 3.0, 0.5, sensation, 0.0);
+            _x = _accelerationScale(sensation);
         } else {
-            _x = fscale(0.0, 100.0, 1.0 / 3.0, 0.05, -sensation, 0.0);
+            _x = _decelerationScale(-sensation);
         }
+        _updateRates();
 #ifdef DEBUG_PATTERN
         Serial.println("Sensation:" + String(sensation, 0) + " --> " +
                        String(_x, 6));
@@ -296,11 +392,10 @@ class RoboStroke : public Pattern {
 
     motionParameter nextTarget(unsigned int index) {
         // maximum speed of the trapezoidal motion
-        float speed = float(_stroke) / ((1 - _x) * _timeOfStroke);
-        _nextMove.speed = int(speed);
+        _nextMove.speed = q16Scale(_stroke, Q16_ONE, _speedRate);
 
         // acceleration to meet the profile
-        _nextMove.acceleration = int(speed / (_x * _timeOfStroke));
+        _nextMove.acceleration = q16Scale(_stroke, Q16_ONE, _accelerationRate);
 
         // odd stroke is moving out
         if (index % 2) {
@@ -317,6 +412,17 @@ class RoboStroke : public Pattern {
 
   protected:
     float _x = 1.0 / 3.0;
+    // 1 / ((1 - _x) * _timeOfStroke) and 1 / ((1 - _x) * _x * _timeOfStroke²)
+    q16_t _speedRate = 0;
+    q16_t _accelerationRate = 0;
+    void _updateRates() {
+        _speedRate = q16Rate((1 - _x) * _timeOfStroke);
+        _accelerationRate =
+            q16Rate((1 - _x) * _x * _timeOfStroke * _timeOfStroke);
+    }
+    // Linear fscale() mappings of the sensation onto _x
+    FscaleTable<2> _accelerationScale{1.0 / 3.0, 0.5};
+    FscaleTable<2> _decelerationScale{1.0 / 3.0, 0.05};
 };
 
 /**************************************************************************/
@@ -332,12 +438,14 @@ class RoboStroke : public Pattern {
 class HalfnHalf : public Pattern {
   public:
     HalfnHalf(const char *str) : Pattern(str) {}
+    // A half and a full stroke, each in and out
+    unsigned int cycleLength() { return 4; }
     void setSensation(float sensation) {
         _sensation = sensation;
         _updateStrokeTiming();
     }
     void setTimeOfStroke(float speed = 0) {
-        _timeOfStroke = speed;
+        _setTimeOfStroke(speed);
         _updateStrokeTiming();
     }
     motionParameter nextTarget(unsigned int index) {
@@ -358,22 +466,22 @@ class HalfnHalf : public Pattern {
         // odd stroke is moving out
         if (index % 2) {
             // maximum speed of the trapezoidal motion
-            _nextMove.speed = int(1.5 * stroke / _timeOfOutStroke);
+            _nextMove.speed = q16Scale(stroke, toQ16(1.5), _outRate);
 
             // acceleration to meet the profile
             _nextMove.acceleration =
-                int(3.0 * float(_nextMove.speed) / _timeOfOutStroke);
+                q16Scale(_nextMove.speed, toQ16(3.0), _outRate);
             _nextMove.stroke = _depth - _stroke;
             // every second move is half
             _half = !_half;
             // even stroke is moving in
         } else {
             // maximum speed of the trapezoidal motion
-            _nextMove.speed = int(1.5 * stroke / _timeOfInStroke);
+            _nextMove.speed = q16Scale(stroke, toQ16(1.5), _inRate);
 
             // acceleration to meet the profile
             _nextMove.acceleration =
-                int(3.0 * float(_nextMove.speed) / _timeOfInStroke);
+                q16Scale(_nextMove.speed, toQ16(3.0), _inRate);
             _nextMove.stroke = (_depth - _stroke) + stroke;
         }
         _index = index;
@@ -382,14 +490,18 @@ class HalfnHalf : public Pattern {
 
   protected:
     float _timeOfFastStroke = 1.0;
+    // fscale(0.0, 100.0, 1.0, 5.0, x, 0.0), linear so two entries are exact
+    FscaleTable<2> _fastStrokeScale{1.0, 5.0};
     float _timeOfInStroke = 1.0;
     float _timeOfOutStroke = 1.0;
+    q16_t _inRate = Q16_ONE;
+    q16_t _outRate = Q16_ONE;
     bool _half = true;
     void _updateStrokeTiming() {
         // calculate the time it takes to complete the faster stroke
         // Division by 2 because reference is a half stroke
         _timeOfFastStroke = (0.5 * _timeOfStroke) /
-                            fscale(0.0, 100.0, 1.0, 5.0, abs(_sensation), 0.0);
+                            _fastStrokeScale(abs(_sensation));
         // positive sensation, in is faster
         if (_sensation > 0.0) {
             _timeOfInStroke = _timeOfFastStroke;
@@ -399,6 +511,8 @@ class HalfnHalf : public Pattern {
             _timeOfOutStroke = _timeOfFastStroke;
             _timeOfInStroke = _timeOfStroke - _timeOfFastStroke;
         }
+        _inRate = q16Rate(_timeOfInStroke);
+        _outRate = q16Rate(_timeOfOutStroke);
 #ifdef DEBUG_PATTERN
         Serial.println("TimeOfInStroke: " + String(_timeOfInStroke));
         Serial.println("TimeOfOutStroke: " + String(_timeOfOutStroke));
@@ -419,7 +533,7 @@ class Deeper : public Pattern {
 
     void setTimeOfStroke(float speed = 0) {
         // In & Out have same time, so we need to divide by 2
-        _timeOfStroke = 0.5 * speed;
+        _setTimeOfStroke(0.5 * speed);
     }
 
     void setSensation(float sensation) {
@@ -436,6 +550,9 @@ class Deeper : public Pattern {
 #endif
     }
 
+    // One ramp, every stroke in and out
+    unsigned int cycleLength() { return 2 * _countStrokesForRamp; }
+
     motionParameter nextTarget(unsigned int index) {
         // How many steps is each stroke advancing
         int slope = _stroke / (_countStrokesForRamp);
@@ -456,10 +573,11 @@ class Deeper : public Pattern {
 #endif
 
         // maximum speed of the trapezoidal motion
-        _nextMove.speed = int(1.5 * amplitude / _timeOfStroke);
+        _nextMove.speed = q16Scale(amplitude, toQ16(1.5), _strokeRate);
 
         // acceleration to meet the profile
-        _nextMove.acceleration = int(3.0 * _nextMove.speed / _timeOfStroke);
+        _nextMove.acceleration =
+            q16Scale(_nextMove.speed, toQ16(3.0), _strokeRate);
 
         // odd stroke is moving out
         if (index % 2) {
@@ -491,7 +609,7 @@ class StopNGo : public Pattern {
 
     void setTimeOfStroke(float speed = 0) {
         // In & Out have same time, so we need to divide by 2
-        _timeOfStroke = 0.5 * speed;
+        _setTimeOfStroke(0.5 * speed);
     }
 
     void setSensation(float sensation) {
@@ -501,12 +619,16 @@ class StopNGo : public Pattern {
         _updateDelay(map(sensation, -100, 100, 100, 10000));
     }
 
+    // pauses are timed from the moment a stroke is issued
+    bool canPlanAhead() { return false; }
+
     motionParameter nextTarget(unsigned int index) {
         // maximum speed of the trapezoidal motion
-        _nextMove.speed = int(1.5 * _stroke / _timeOfStroke);
+        _nextMove.speed = q16Scale(_stroke, toQ16(1.5), _strokeRate);
 
         // acceleration to meet the profile
-        _nextMove.acceleration = int(3.0 * _nextMove.speed / _timeOfStroke);
+        _nextMove.acceleration =
+            q16Scale(_nextMove.speed, toQ16(3.0), _strokeRate);
 
         // adds a delay between each stroke
         if (_isStillDelayed() == false) {
@@ -576,6 +698,8 @@ class Insist : public Pattern {
   public:
     Insist(const char *str) : Pattern(str) {}
 
+    unsigned int cycleLength() { return 2; }
+
     void setSensation(float sensation) {
         _sensation = sensation;
 
@@ -589,7 +713,7 @@ class Insist : public Pattern {
 
     void setTimeOfStroke(float speed = 0) {
         // In & Out have same time, so we need to divide by 2
-        _timeOfStroke = 0.5 * speed;
+        _setTimeOfStroke(0.5 * speed);
         _updateStrokeTiming();
     }
 
@@ -666,30 +790,39 @@ class Knot : public Pattern {
     Knot(const char *str) : Pattern(str) {}
 
     void setTimeOfStroke(float speed = 0) {
-        _timeOfStroke = 0.5 * speed;
+        _setTimeOfStroke(0.5 * speed);
         _speed = speed;
     }
 
     void setSensation(float sensation) {
         _sensation = float(abs((sensation) / 1000) + 0.001);
+        _sensationFactor = toQ16(_sensation);
     }
 
+    // pauses are timed from the moment a stroke is issued
+    bool canPlanAhead() { return false; }
+
     motionParameter nextTarget(unsigned int index) {
-        _nextMove.acceleration = int(3 * _nextMove.speed / _timeOfStroke);
+        _nextMove.acceleration =
+            q16Scale(_nextMove.speed, toQ16(3.0), _strokeRate);
         // Fancy equation to calculate the pause in milliseconds using the current speed as an input
         _delayInMillis = ((sqrt((350000 * _speed) + 60000)) + 550);
 
         if (_isStillDelayed() == false) {
             if (index % 5 == 1) {
-                _nextMove.acceleration = int(2 * _nextMove.speed / _timeOfStroke);
-                _nextMove.speed = int(0.8 * _stroke / _timeOfStroke);
+                _nextMove.acceleration =
+                    q16Scale(_nextMove.speed, toQ16(2.0), _strokeRate);
+                _nextMove.speed = q16Scale(_stroke, toQ16(0.8), _strokeRate);
                 // 70% of the stroke looks good visually
-                _nextMove.stroke = int((_depth - _stroke) + (_stroke * 0.70));
+                _nextMove.stroke =
+                    (_depth - _stroke) + q16Multiply(_stroke, toQ16(0.70));
             } else if (index % 5 == 2) {
                 _startDelay();
             } else if (index % 5 == 3) {
-                _nextMove.acceleration = int(2.3 * _nextMove.speed / _timeOfStroke);
-                _nextMove.speed = int(_sensation * _stroke / _timeOfStroke);
+                _nextMove.acceleration =
+                    q16Scale(_nextMove.speed, toQ16(2.3), _strokeRate);
+                _nextMove.speed =
+                    q16Scale(_stroke, _sensationFactor, _strokeRate);
                 _nextMove.stroke = _depth;
 #ifdef DEBUG_PATTERN
                 //Serial.println("Speed: " + String(_speed));
@@ -698,8 +831,9 @@ class Knot : public Pattern {
             } else if (index % 5 == 4) {
                 _startDelay();
             } else {
-                _nextMove.acceleration = int(2 * _nextMove.speed / _timeOfStroke);
-                _nextMove.speed = int(1.0 * _stroke / _timeOfStroke);
+                _nextMove.acceleration =
+                    q16Scale(_nextMove.speed, toQ16(2.0), _strokeRate);
+                _nextMove.speed = q16Scale(_stroke, Q16_ONE, _strokeRate);
                 _nextMove.stroke = _depth - _stroke;
             }
             _nextMove.skip = false;
@@ -713,6 +847,7 @@ class Knot : public Pattern {
 
   protected:
     float _speed = 1.0;
+    q16_t _sensationFactor = 0;
 };
 
 /**************************************************************************/
@@ -731,28 +866,36 @@ class Struggle : public Pattern {
     Struggle(const char *str) : Pattern(str) {}
 
     void setTimeOfStroke(float speed = 0) {
-        _timeOfStroke = 0.5 * speed;
+        _setTimeOfStroke(0.5 * speed);
     }
 
     void setSensation(float sensation) {
         _sensation = ((abs(sensation) / 250) + 0.5);
+        _sensationFactor = toQ16(_sensation);
     }
 
+    unsigned int cycleLength() { return 3; }
+
     motionParameter nextTarget(unsigned int index) {
-        _nextMove.speed = int(1.5 * _stroke / _timeOfStroke);
-        _nextMove.acceleration = int(3.0 * _nextMove.speed / _timeOfStroke);
+        _nextMove.speed = q16Scale(_stroke, toQ16(1.5), _strokeRate);
+        _nextMove.acceleration =
+            q16Scale(_nextMove.speed, toQ16(3.0), _strokeRate);
 
         if (index % 3 == 1) {
-            _nextMove.acceleration = int(6 * _nextMove.speed / _timeOfStroke);
-            _nextMove.speed = int(1.5 * _stroke / _timeOfStroke);
-            _nextMove.stroke = int((_depth - _stroke) + (_stroke * float(_sensation)));
+            _nextMove.acceleration =
+                q16Scale(_nextMove.speed, toQ16(6.0), _strokeRate);
+            _nextMove.speed = q16Scale(_stroke, toQ16(1.5), _strokeRate);
+            _nextMove.stroke =
+                (_depth - _stroke) + q16Multiply(_stroke, _sensationFactor);
         } else if (index % 3 == 2) {
-            _nextMove.acceleration = int(3 * _nextMove.speed / _timeOfStroke);
-            _nextMove.speed = int(0.5 * _stroke / _timeOfStroke);
+            _nextMove.acceleration =
+                q16Scale(_nextMove.speed, toQ16(3.0), _strokeRate);
+            _nextMove.speed = q16Scale(_stroke, toQ16(0.5), _strokeRate);
             _nextMove.stroke = _depth;
         } else {
-            _nextMove.acceleration = int(3 * _nextMove.speed / _timeOfStroke);
-            _nextMove.speed = int(1.5 * _stroke / _timeOfStroke);
+            _nextMove.acceleration =
+                q16Scale(_nextMove.speed, toQ16(3.0), _strokeRate);
+            _nextMove.speed = q16Scale(_stroke, toQ16(1.5), _strokeRate);
             _nextMove.stroke = _depth - _stroke;
         }
 
@@ -760,4 +903,184 @@ class Struggle : public Pattern {
         _index = index;
         return _nextMove;
     }
+
+  protected:
+    q16_t _sensationFactor = 0;
+};
+
+/**************************************************************************/
+/*!
+  @brief  Custom: plays an uploaded keyframe table (see Keyframes.h). The
+  moves are computed whenever stroke, depth, speed or the table change, so
+  nextTarget() only picks the segment of the index. Every move is a
+  trapezoid that accelerates and brakes for the accel share of its time.
+  Until a table is uploaded it strokes like Simple Stroke. Sensation has no
+  effect.
+*/
+/**************************************************************************/
+class TablePattern : public Pattern {
+  public:
+    TablePattern(const char *str) : Pattern(str) {
+        _stroke = 0;
+        _depth = 0;
+        _timeOfStroke = 0;
+        _keyframes = defaultKeyframes();
+        _planSegments();
+    }
+
+    void setTimeOfStroke(float speed = 0) {
+        _setTimeOfStroke(speed);
+        _planSegments();
+    }
+
+    void setStroke(int stroke) {
+        _stroke = stroke;
+        _planSegments();
+    }
+
+    void setDepth(int depth) {
+        _depth = depth;
+        _planSegments();
+    }
+
+    //! Replaces the table. Like the other setters it must not run while the
+    //! planner asks for targets, StrokeEngine::setKeyframes() takes care.
+    void setKeyframes(const KeyframeTable &keyframes) {
+        _keyframes = keyframes;
+        _planSegments();
+    }
+
+    motionParameter nextTarget(unsigned int index) {
+        _index = index;
+        _nextMove = _segments[index % _keyframes.count];
+        return _nextMove;
+    }
+
+  protected:
+    KeyframeTable _keyframes;
+    motionParameter _segments[KEYFRAME_MAX_POINTS];
+
+    int _target(int point) {
+        return (_depth - _stroke) +
+               _stroke * _keyframes.points[point].position / 100;
+    }
+
+    void _planSegments() {
+        unsigned int total = 0;
+        for (int i = 0; i < _keyframes.count; i++) {
+            total += _keyframes.points[i].time;
+        }
+
+        int previous = _target(_keyframes.count - 1);
+        for (int i = 0; i < _keyframes.count; i++) {
+            const KeyframePoint &point = _keyframes.points[i];
+            motionParameter &segment = _segments[i];
+            segment.stroke = _target(i);
+            segment.skip = false;
+            segment.jerk = 0;
+
+            // v = d / (t (1 - a)), acceleration = v / (a t)
+            float time = _timeOfStroke * point.time / total;
+            float accel = point.accel > 0 ? point.accel / 100.0f : 1.0f / 3;
+            float distance = abs(segment.stroke - previous);
+            float speed = time > 0 ? distance / (time * (1.0f - accel)) : 0;
+            segment.speed = max(1, int(speed));
+            segment.acceleration =
+                max(1, int(time > 0 ? segment.speed / (accel * time) : 0));
+            previous = segment.stroke;
+        }
+    }
 };
+
+/**************************************************************************/
+/*!
+  @brief  Plays a preloaded script on its playback clock. Not part of the
+  pattern table, StrokeEngine::startScript() selects it. Every action
+  becomes a trapezoidal move with 1/3 acceleration, 1/3 coasting and 1/3
+  deceleration that starts once the previous action is due and ends when the
+  action is. Moves are timed from the clock when they start, so they can't
+  be planned ahead, but late moves or clock resyncs don't add up. Actions
+  that are already due are skipped. Speed and sensation have no effect.
+*/
+/**************************************************************************/
+class ScriptPattern : public Pattern {
+  public:
+    ScriptPattern(const char *str) : Pattern(str) {}
+
+    bool canPlanAhead() { return false; }
+
+    motionParameter nextTarget(unsigned int index) {
+        _index = index;
+        _nextMove.skip = true;
+        _nextMove.jerk = 0;
+
+        if (index == 0) {
+            _isHolding = false;
+        }
+
+        if (!clock.isRunning()) {
+            return _nextMove;
+        }
+        uint32_t now = clock.now(millis());
+
+        // Hold the position until the action before is due
+        if (_isHolding && (int32_t)(_holdUntil - now) > 0) {
+            return _nextMove;
+        }
+
+        ScriptAction action;
+        while (buffer.peek(action) && (int32_t)(action.time - now) <= 0) {
+            buffer.pop();
+        }
+        if (!buffer.peek(action)) {
+            return _nextMove;
+        }
+        buffer.pop();
+
+        // The first move starts from wherever the machine is, somewhere
+        // between home and depth. Plan it for the farthest, it arrives early
+        // and holds.
+        int target = _target(action);
+        float distance = index == 0 ? max(target, _depth - target)
+                                    : abs(target - _lastTarget);
+        float time = max((int32_t)(action.time - now), 1) / 1000.0f;
+        _nextMove.stroke = target;
+        _nextMove.speed = max(int(1.5f * distance / time), 1);
+        _nextMove.acceleration = max(int(3.0f * _nextMove.speed / time), 1);
+        _nextMove.skip = false;
+
+        _lastTarget = _nextMove.stroke;
+        _holdUntil = action.time;
+        _isHolding = true;
+        return _nextMove;
+    }
+
+    ScriptBuffer buffer;
+    ScriptClock clock;
+
+  protected:
+    int _lastTarget = 0;
+    uint32_t _holdUntil = 0;
+    bool _isHolding = false;
+
+    int _target(const ScriptAction &action) {
+        return (_depth - _stroke) + _stroke * action.position / 100;
+    }
+};
+
+/**************************************************************************/
+/*!
+  @brief  Table of all available patterns. The instances are allocated
+  statically in pattern.cpp and live as long as the program, the StrokeEngine
+  only selects one of them by index. Keep the order in sync with the pattern
+  list of the main program.
+*/
+/**************************************************************************/
+extern Pattern *patternTable[];
+extern const unsigned int patternTableSize;
+
+//! The Custom pattern of the table, for uploading keyframes to
+extern TablePattern tablePattern;
+
+//! Script playback, see StrokeEngine::startScript()
+extern ScriptPattern scriptPattern;
@@ -0,0 +1,69 @@
+#ifndef OSSM_SOFTWARE_COALESCER_H
+#define OSSM_SOFTWARE_COALESCER_H
+
+#include <cstdint>
+
+#include "structs/CommandValue.h"
+
+// Keeps only the newest value per set: parameter so a burst of slider updates
+// is applied once instead of being replayed in order. Other commands (go:,
+// stream:) are never coalesced.
+class CommandCoalescer {
+  public:
+    // Returns false if the command can't be coalesced and should be applied
+    // directly, after flushing whatever is pending.
+    bool add(const CommandValue &command) {
+        int slot = slotOf(command.command);
+        if (slot < 0) {
+            return false;
+        }
+
+        if (hasPending[slot]) {
+            superseded++;
+        }
+        pending[slot] = command;
+        hasPending[slot] = true;
+        return true;
+    }
+
+    // Applies pending values in a fixed order and clears them.
+    template <typename Apply>
+    void flush(Apply apply) {
+        for (int slot = 0; slot < slotCount; slot++) {
+            if (!hasPending[slot]) {
+                continue;
+            }
+            hasPending[slot] = false;
+            apply(pending[slot]);
+        }
+    }
+
+    // Number of set: commands that were replaced by a newer value
+    uint32_t getSupersededCount() const { return superseded; }
+
+  private:
+    static constexpr int slotCount = 5;
+
+    static int slotOf(Commands command) {
+        switch (command) {
+            case Commands::setSpeed:
+                return 0;
+            case Commands::setStroke:
+                return 1;
+            case Commands::setDepth:
+                return 2;
+            case Commands::setSensation:
+                return 3;
+            case Commands::setPattern:
+                return 4;
+            default:
+                return -1;
+        }
+    }
+
+    CommandValue pending[slotCount] = {};
+    bool hasPending[slotCount] = {};
+    uint32_t superseded = 0;
+};
+
+#endif  // OSSM_SOFTWARE_COALESCER_H
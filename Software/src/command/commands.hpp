@@ -1,10 +1,12 @@
 #ifndef OSSM_SOFTWARE_COMMANDS_H
 #define OSSM_SOFTWARE_COMMANDS_H
 
-#include <regex>
 #include <string>
+#include <string_view>
 
 #include "Arduino.h"
+#include "command/reader.hpp"
+#include "structs/CommandValue.h"
 
 // These are BLE commands that we will process and send to the state machine.
 // The state machine will execute these commands if appropiate
@@ -12,81 +14,212 @@
 namespace Prefix {
     const char goTo[] PROGMEM = "go:";
     const char setValue[] PROGMEM = "set:";
+    const char stream[] PROGMEM = "stream:";
 }
 
-enum class Commands {
-    // GO TO
-    goToStrokeEngine,
-    goToSimplePenetration,
-    goToStreaming,
-    goToMenu,
-
-    // SET VALUES
-    setDepth,
-    setSensation,
-    setPattern,
-    setSpeed,
-    setStroke,
-
-    ignore
-};
-
-struct CommandValue {
-    Commands command;
-    int value;
-};
-
-inline CommandValue setCommandValue(const String& str) {
-    // Check if string starts with "set:" and has two colons
-    int firstColon = str.indexOf(':');
-    int lastColon = str.lastIndexOf(':');
-    if (firstColon == -1 || lastColon == -1 || firstColon == lastColon) {
-        ESP_LOGI("COMMANDS", "Command not well formed: %s", str.c_str());
-        return {Commands::ignore, 0};
-    }
+// Names of the parameters in set: commands, indexed by SetValue
+static const char* const setValueNames[setValueCount] = {
+    "speed", "stroke", "depth", "sensation", "pattern"};
 
-    // Get value after last colon and validate it's a number between 0-100
-    String command =
-        str.substring(4, str.lastIndexOf(':'));  // Skip "set:" and get command
-    String valueStr = str.substring(lastColon + 1);
-    int value = valueStr.toInt();
-    if (value < 0 || value > 100 || valueStr != String(value)) {
-        ESP_LOGI("COMMANDS", "Invalid value: %s", str.c_str());
-        return {Commands::ignore, 0};
+// Writes hundredths of a percent in their shortest form, "50.25" or "50"
+inline int formatPercent(char* buffer, size_t size, int value) {
+    int whole = value / setValueScale;
+    int hundredths = value % setValueScale;
+    if (hundredths == 0) {
+        return snprintf(buffer, size, "%d", whole);
+    }
+    if (hundredths % 10 == 0) {
+        return snprintf(buffer, size, "%d.%d", whole, hundredths / 10);
     }
+    return snprintf(buffer, size, "%d.%02d", whole, hundredths);
+}
 
-    if (command == "depth") {
-        return {Commands::setDepth, value};
-    } else if (command == "sensation") {
-        return {Commands::setSensation, value};
-    } else if (command == "pattern") {
-        return {Commands::setPattern, value};
-    } else if (command == "speed") {
-        return {Commands::setSpeed, value};
-    } else if (command == "stroke") {
-        return {Commands::setStroke, value};
+// Names of the play modes in go: commands
+static const char* const goNames[] = {"simplePenetration", "strokeEngine",
+                                      "streaming", "menu"};
+
+// Takes "speed:50;depth:30;..." after "set:", each parameter at most once.
+// A single parameter is its own command, "set:speed:50" is setSpeed.
+inline bool parseSetValues(CommandReader& reader, CommandValue& command) {
+    static const Commands commands[setValueCount] = {
+        Commands::setSpeed, Commands::setStroke, Commands::setDepth,
+        Commands::setSensation, Commands::setPattern};
+
+    CommandValue parsed = {Commands::setValues, 0};
+    int index = -1;
+    do {
+        index = reader.word(setValueNames, setValueCount);
+        int value = 0;
+        if (index < 0 || (parsed.value & (1 << index)) || !reader.skip(':') ||
+            !reader.percent(setValueScale, value) ||
+            (index == setValuePattern && value % setValueScale != 0)) {
+            return false;
+        }
+        parsed.value |= 1 << index;
+        parsed.values[index] = value;
+    } while (reader.skip(';'));
+
+    if (!reader.atEnd()) {
+        return false;
+    }
+    if (parsed.value == (1 << index)) {
+        command = {commands[index], parsed.values[index]};
     } else {
-        return {Commands::ignore, 0};
+        command = parsed;
+    }
+    return true;
+}
+
+// Validates and decodes a text command in one pass over the received bytes,
+// see BLE_Protocol.md for the grammar. Values beyond their range fail like
+// malformed commands. False leaves command untouched.
+inline bool parseCommand(const char* str, size_t length,
+                         CommandValue& command) {
+    static const Commands goCommands[] = {
+        Commands::goToSimplePenetration, Commands::goToStrokeEngine,
+        Commands::goToStreaming, Commands::goToMenu};
+
+    CommandReader reader(str, length);
+    if (reader.literal(Prefix::goTo)) {
+        int index = reader.word(goNames, 4);
+        if (index < 0 || !reader.atEnd()) {
+            return false;
+        }
+        command = {goCommands[index], 0};
+        return true;
+    }
+
+    if (reader.literal(Prefix::setValue)) {
+        return parseSetValues(reader, command);
+    }
+
+    if (reader.literal(Prefix::stream)) {
+        // Position is 0-100 of the stroke selected on the device, the time
+        // is given in milliseconds
+        int position = 0;
+        int time = 0;
+        if (!reader.number(100, position) || !reader.skip(':') ||
+            !reader.number(65535, time) || !reader.atEnd()) {
+            return false;
+        }
+        command = {Commands::streamPosition, position, time};
+        return true;
     }
+
+    return false;
 }
 
 static const char ignore_str[] PROGMEM = "ignore";
 
-inline CommandValue commandFromString(const String& str) {
-    if (str.startsWith("go:")) {
-        if (str == "go:strokeEngine") return {Commands::goToStrokeEngine, 0};
-        if (str == "go:simplePenetration")
-            return {Commands::goToSimplePenetration, 0};
-        if (str == "go:streaming") return {Commands::goToStreaming, 0};
-        if (str == "go:menu") return {Commands::goToMenu, 0};
-        return {Commands::goToMenu, 0};  // Default
+// Decodes a text command, ignore if it isn't well formed. Works on a view of
+// the received bytes, so nothing is copied or allocated.
+inline CommandValue commandFromString(std::string_view str) {
+    CommandValue command = {Commands::ignore, 0};
+    if (!parseCommand(str.data(), str.size(), command)) {
+        ESP_LOGI("COMMANDS", "Invalid command: %.*s", (int)str.size(),
+                 str.data());
+    }
+    return command;
+}
+
+// Writes the text form of a decoded command into buffer, the inverse of
+// commandFromString. Returns the length written, 0 for ignored commands.
+inline size_t commandToString(const CommandValue& command, char* buffer,
+                              size_t size) {
+    const char* name = nullptr;
+    int written = 0;
+
+    switch (command.command) {
+        case Commands::goToStrokeEngine:
+            written = snprintf(buffer, size, "go:strokeEngine");
+            break;
+        case Commands::goToSimplePenetration:
+            written = snprintf(buffer, size, "go:simplePenetration");
+            break;
+        case Commands::goToStreaming:
+            written = snprintf(buffer, size, "go:streaming");
+            break;
+        case Commands::goToMenu:
+            written = snprintf(buffer, size, "go:menu");
+            break;
+        case Commands::setDepth:
+            name = "depth";
+            break;
+        case Commands::setSensation:
+            name = "sensation";
+            break;
+        case Commands::setPattern:
+            name = "pattern";
+            break;
+        case Commands::setSpeed:
+            name = "speed";
+            break;
+        case Commands::setStroke:
+            name = "stroke";
+            break;
+        case Commands::setValues:
+            written = snprintf(buffer, size, "set:");
+            for (int i = 0; i < setValueCount; i++) {
+                if (!(command.value & (1 << i)) || written <= 0 ||
+                    (size_t)written >= size) {
+                    continue;
+                }
+                written += snprintf(buffer + written, size - written,
+                                    "%s%s:", written > 4 ? ";" : "",
+                                    setValueNames[i]);
+                if ((size_t)written < size) {
+                    written += formatPercent(buffer + written, size - written,
+                                             command.values[i]);
+                }
+            }
+            break;
+        case Commands::streamPosition:
+            written = snprintf(buffer, size, "stream:%d:%d", command.value,
+                               command.time);
+            break;
+        case Commands::playScript:
+        case Commands::pauseScript:
+            // Only sent on the script characteristic
+        case Commands::ignore:
+            break;
     }
 
-    if (str.startsWith("set:")) {
-        return setCommandValue(str);
+    if (name != nullptr) {
+        written = snprintf(buffer, size, "set:%s:", name);
+        if ((size_t)written < size) {
+            written += formatPercent(buffer + written, size - written,
+                                     command.value);
+        }
     }
 
-    return {Commands::ignore, 0};
+    if (written <= 0) {
+        if (size > 0) buffer[0] = '\0';
+        return 0;
+    }
+    return (size_t)written < size ? (size_t)written : size - 1;
+}
+
+// Commands that start or drive motion. BLE is up while the machine homes,
+// these are refused until it is done.
+inline bool isMotionCommand(Commands command) {
+    switch (command) {
+        case Commands::goToStrokeEngine:
+        case Commands::goToSimplePenetration:
+        case Commands::goToStreaming:
+        case Commands::setSpeed:
+        case Commands::streamPosition:
+        case Commands::playScript:
+            return true;
+        default:
+            return false;
+    }
+}
+
+inline bool isMotionCommand(const CommandValue& command) {
+    if (command.command == Commands::setValues) {
+        return (command.value & (1 << setValueSpeed)) != 0;
+    }
+    return isMotionCommand(command.command);
 }
 
 #endif  // OSSM_SOFTWARE_COMMANDS_H
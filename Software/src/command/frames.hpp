@@ -0,0 +1,202 @@
+#ifndef OSSM_SOFTWARE_FRAMES_H
+#define OSSM_SOFTWARE_FRAMES_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "structs/CommandValue.h"
+
+// Binary counterpart of the text commands in commands.hpp.
+//
+// A frame is a one byte opcode followed by a little endian uint16 value and
+// an optional sequence number that is echoed back in the acknowledgement:
+//
+//   [opcode][value lo][value hi]([seq])
+//
+// The stream opcode carries an additional uint16 time in ms after the value:
+//
+//   [0x20][position lo][position hi][time lo][time hi]([seq])
+//
+// The set values opcode carries a mask of SetValue bits, followed by one
+// uint16 value per set bit in SetValue order. They are applied together:
+//
+//   [0x06][mask]([value lo][value hi])...([seq])
+//
+// Set values are whole percent 0-100. With the fine bit (0x40) added to
+// their opcode they are hundredths of a percent 0-10000 instead, so 0x41
+// with 5025 sets the speed to 50.25%. The pattern stays a whole index.
+//
+// Decoding never allocates, so frames can be handled straight from the BLE
+// host task.
+
+namespace Opcode {
+    constexpr uint8_t setSpeed = 0x01;
+    constexpr uint8_t setStroke = 0x02;
+    constexpr uint8_t setDepth = 0x03;
+    constexpr uint8_t setSensation = 0x04;
+    constexpr uint8_t setPattern = 0x05;
+    constexpr uint8_t setValues = 0x06;
+    // Added to the set opcodes for values in hundredths of a percent
+    constexpr uint8_t fine = 0x40;
+
+    constexpr uint8_t goToStrokeEngine = 0x10;
+    constexpr uint8_t goToSimplePenetration = 0x11;
+    constexpr uint8_t goToStreaming = 0x12;
+    constexpr uint8_t goToMenu = 0x13;
+
+    constexpr uint8_t streamPosition = 0x20;
+}
+
+enum class FrameStatus : uint8_t {
+    ok = 0x00,
+    malformed = 0x01,
+    unknownOpcode = 0x02,
+    outOfRange = 0x03,
+    busy = 0x04,
+    notReady = 0x05,  // Motion commands while homing
+};
+
+inline uint16_t readFrameU16(const uint8_t* data) {
+    return (uint16_t)(data[0] | (data[1] << 8));
+}
+
+inline bool isFineOpcode(uint8_t opcode) {
+    return opcode >= (Opcode::fine | Opcode::setSpeed) &&
+           opcode <= (Opcode::fine | Opcode::setValues);
+}
+
+// Opcode without the fine bit
+inline uint8_t baseOpcode(uint8_t opcode) {
+    return isFineOpcode(opcode) ? opcode & ~Opcode::fine : opcode;
+}
+
+// Converts a set value of a frame to hundredths of a percent, false if it is
+// out of range
+inline bool frameSetValue(int index, uint16_t raw, bool isFine, int& value) {
+    value = isFine ? raw : raw * setValueScale;
+    return value <= 100 * setValueScale &&
+           (index != setValuePattern || value % setValueScale == 0);
+}
+
+// Length of a frame without its sequence number, 0 if it can't be told
+inline size_t commandFramePayload(const uint8_t* data, size_t length) {
+    if (data == nullptr || length < 1) {
+        return 0;
+    }
+    if (data[0] == Opcode::streamPosition) {
+        return 5;
+    }
+    if (baseOpcode(data[0]) != Opcode::setValues) {
+        return 3;
+    }
+    if (length < 2) {
+        return 0;
+    }
+
+    size_t values = 0;
+    for (int i = 0; i < setValueCount; i++) {
+        values += (data[1] >> i) & 1;
+    }
+    return 2 + 2 * values;
+}
+
+inline FrameStatus decodeSetValuesFrame(const uint8_t* data,
+                                        CommandValue& command) {
+    bool isFine = isFineOpcode(data[0]);
+    uint8_t mask = data[1];
+    if (mask == 0 || (mask >> setValueCount) != 0) {
+        return FrameStatus::malformed;
+    }
+
+    const uint8_t* value = &data[2];
+    for (int i = 0; i < setValueCount; i++) {
+        if (!(mask & (1 << i))) {
+            continue;
+        }
+        if (!frameSetValue(i, readFrameU16(value), isFine,
+                           command.values[i])) {
+            command = {Commands::ignore, 0};
+            return FrameStatus::outOfRange;
+        }
+        value += 2;
+    }
+
+    command.command = Commands::setValues;
+    command.value = mask;
+    return FrameStatus::ok;
+}
+
+inline FrameStatus decodeCommandFrame(const uint8_t* data, size_t length,
+                                      CommandValue& command, uint8_t& seq) {
+    command = {Commands::ignore, 0};
+    seq = 0;
+
+    // Only the stream and set values opcodes differ in length
+    size_t payload = commandFramePayload(data, length);
+    if (payload < 2 || (length != payload && length != payload + 1)) {
+        return FrameStatus::malformed;
+    }
+    if (length == payload + 1) {
+        seq = data[payload];
+    }
+
+    bool isFine = isFineOpcode(data[0]);
+    uint8_t opcode = baseOpcode(data[0]);
+    if (opcode == Opcode::setValues) {
+        return decodeSetValuesFrame(data, command);
+    }
+    int value = readFrameU16(&data[1]);
+
+    // Set opcodes follow the order of SetValue
+    if (opcode >= Opcode::setSpeed && opcode <= Opcode::setPattern &&
+        !frameSetValue(opcode - Opcode::setSpeed, value, isFine, value)) {
+        return FrameStatus::outOfRange;
+    }
+
+    switch (opcode) {
+        case Opcode::setSpeed:
+            command.command = Commands::setSpeed;
+            break;
+        case Opcode::setStroke:
+            command.command = Commands::setStroke;
+            break;
+        case Opcode::setDepth:
+            command.command = Commands::setDepth;
+            break;
+        case Opcode::setSensation:
+            command.command = Commands::setSensation;
+            break;
+        case Opcode::setPattern:
+            command.command = Commands::setPattern;
+            break;
+        case Opcode::goToStrokeEngine:
+            command.command = Commands::goToStrokeEngine;
+            return FrameStatus::ok;
+        case Opcode::goToSimplePenetration:
+            command.command = Commands::goToSimplePenetration;
+            return FrameStatus::ok;
+        case Opcode::goToStreaming:
+            command.command = Commands::goToStreaming;
+            return FrameStatus::ok;
+        case Opcode::goToMenu:
+            command.command = Commands::goToMenu;
+            return FrameStatus::ok;
+        case Opcode::streamPosition:
+            command.command = Commands::streamPosition;
+            command.time = readFrameU16(&data[3]);
+
+            // Same 0-100 range as the text protocol
+            if (value > 100) {
+                command = {Commands::ignore, 0};
+                return FrameStatus::outOfRange;
+            }
+            break;
+        default:
+            return FrameStatus::unknownOpcode;
+    }
+
+    command.value = value;
+    return FrameStatus::ok;
+}
+
+#endif  // OSSM_SOFTWARE_FRAMES_H
@@ -0,0 +1,116 @@
+#ifndef OSSM_SOFTWARE_COMMAND_GPIO_H
+#define OSSM_SOFTWARE_COMMAND_GPIO_H
+
+#include <cstddef>
+
+#include "command/reader.hpp"
+#include "utils/GpioRules.h"
+
+// Levels of GPIO writes, in the order isHigh takes them
+static const char* const gpioLevelNames[] = {"low", "high"};
+
+// Decodes a GPIO write "<index>:<level>", the level being low, high, 0 or 1
+// in any case. Spaces may surround the index and trail the level. The index
+// isn't checked against the pins, huge ones saturate. False if the write
+// isn't well formed.
+inline bool parseGpioCommand(const char* str, size_t length, int& index,
+                             bool& isHigh) {
+    CommandReader reader(str, length);
+    reader.skipSpaces();
+    int parsed = 0;
+    if (!reader.digits(parsed)) {
+        return false;
+    }
+    reader.skipSpaces();
+    if (!reader.skip(':')) {
+        return false;
+    }
+
+    int level = reader.word(gpioLevelNames, 2, true);
+    if (level < 0) {
+        if (reader.skip('0')) {
+            level = 0;
+        } else if (reader.skip('1')) {
+            level = 1;
+        } else {
+            return false;
+        }
+    }
+
+    reader.skipSpaces();
+    if (!reader.atEnd()) {
+        return false;
+    }
+    index = parsed;
+    isHigh = level == 1;
+    return true;
+}
+
+// Names of the rule triggers and actions, in the order of their enums
+static const char* const gpioTriggerNames[] = {"depth", "retract", "in",
+                                               "out"};
+static const char* const gpioActionNames[] = {"low", "high", "toggle",
+                                              "pulse"};
+
+// Decodes a GPIO rule "rule:<slot>:<index>:<trigger>:<action>", the trigger
+// being depth, retract, in:<mm> or out:<mm> and the action low, high, toggle
+// or pulse:<ms>. Positions take up to two decimals. "rule:<slot>:off"
+// clears the slot. False if the rule isn't well formed.
+inline bool parseGpioRule(const char* str, size_t length, int& slot,
+                          GpioRule& rule) {
+    CommandReader reader(str, length);
+    int parsedSlot = 0;
+    if (!reader.literal("rule:") ||
+        !reader.number(GPIO_RULE_COUNT - 1, parsedSlot) ||
+        !reader.skip(':')) {
+        return false;
+    }
+    if (reader.literal("off") && reader.atEnd()) {
+        slot = parsedSlot;
+        rule = GpioRule();
+        return true;
+    }
+
+    GpioRule parsed;
+    int index = 0;
+    int trigger = -1;
+    if (!reader.number(4, index) || index == 0 || !reader.skip(':') ||
+        (trigger = reader.word(gpioTriggerNames, 4)) < 0) {
+        return false;
+    }
+    parsed.index = index;
+    parsed.trigger = (GpioTrigger)trigger;
+
+    if (parsed.trigger == GpioTrigger::inward ||
+        parsed.trigger == GpioTrigger::outward) {
+        int hundredths = 0;
+        if (!reader.skip(':') || !reader.decimal(1000, 100, hundredths)) {
+            return false;
+        }
+        parsed.positionMm = hundredths / 100.0f;
+    }
+
+    int action = -1;
+    if (!reader.skip(':') || (action = reader.word(gpioActionNames, 4)) < 0) {
+        return false;
+    }
+    parsed.action = (GpioAction)action;
+
+    if (parsed.action == GpioAction::pulse) {
+        int pulseMs = 0;
+        if (!reader.skip(':') || !reader.number(10000, pulseMs) ||
+            pulseMs == 0) {
+            return false;
+        }
+        parsed.pulseMs = pulseMs;
+    }
+
+    if (!reader.atEnd()) {
+        return false;
+    }
+    slot = parsedSlot;
+    rule = parsed;
+    return true;
+}
+
+#endif  // OSSM_SOFTWARE_COMMAND_GPIO_H
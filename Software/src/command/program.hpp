@@ -0,0 +1,94 @@
+#ifndef OSSM_SOFTWARE_COMMAND_PROGRAM_H
+#define OSSM_SOFTWARE_COMMAND_PROGRAM_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "utils/ProgramPlayer.h"
+
+// Messages of the program characteristic. Each write is a one byte opcode,
+// values are little endian:
+//
+//   [0x01]                        clear the program
+//   [0x02][first u16]{step}       append steps, first is the index of the
+//                                 first one in the program
+//   [0x03][loop u8]               play from the start, once or looping
+//   [0x04]                        pause, the settings stay where they are
+//   [0x05]                        resume
+//   [0x06]                        stop and ease the speed down to 0
+//
+// A step is [time u32][parameter u8][easing u8][value u16], the parameter a
+// SetValue, the easing a ProgramEasing and the value in hundredths of a
+// percent. As with scripts, chunks may overlap what was appended already.
+
+namespace ProgramOpcode {
+    constexpr uint8_t clear = 0x01;
+    constexpr uint8_t append = 0x02;
+    constexpr uint8_t play = 0x03;
+    constexpr uint8_t pause = 0x04;
+    constexpr uint8_t resume = 0x05;
+    constexpr uint8_t stop = 0x06;
+}
+
+enum class ProgramResult : uint8_t {
+    ok = 0x00,
+    malformed = 0x01,
+    gap = 0x02,      // Chunk starts after the next expected step
+    full = 0x03,     // The program holds PROGRAM_MAX_STEPS steps
+    invalid = 0x04,  // Value out of range or time before the previous step
+    busy = 0x05,     // Changing the program while it plays or is paused
+    refused = 0x06,  // Playing outside the stroke engine, or an empty program
+};
+
+// Status the characteristic answers every write with, 16 bytes.
+struct __attribute__((packed)) ProgramStatus {
+    uint8_t state;   // ProgramState
+    uint8_t result;  // ProgramResult of the last write
+    uint16_t next;   // Index of the next step to append
+    uint32_t duration;  // Time of the last step in ms
+    uint32_t time;      // Time of the current pass in ms
+    uint32_t loops;     // Passes a looping program completed
+};
+
+static_assert(sizeof(ProgramStatus) == 16, "ProgramStatus must be 16 bytes");
+
+constexpr size_t programStepSize = 8;
+
+inline uint16_t readProgramU16(const uint8_t* data) {
+    return (uint16_t)(data[0] | (data[1] << 8));
+}
+
+inline uint32_t readProgramU32(const uint8_t* data) {
+    return (uint32_t)data[0] | ((uint32_t)data[1] << 8) |
+           ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+}
+
+// Appends the steps of an append message, data points after the opcode.
+inline ProgramResult appendProgramChunk(Program& program, const uint8_t* data,
+                                        size_t length) {
+    if (length < 2 || (length - 2) % programStepSize != 0) {
+        return ProgramResult::malformed;
+    }
+
+    uint32_t first = readProgramU16(data);
+    uint32_t count = (length - 2) / programStepSize;
+    if (first > program.size()) {
+        return ProgramResult::gap;
+    }
+
+    for (uint32_t i = program.size() - first; i < count; i++) {
+        const uint8_t* point = data + 2 + i * programStepSize;
+        ProgramStep step = {readProgramU32(point), point[4],
+                            (ProgramEasing)point[5],
+                            readProgramU16(point + 6)};
+        if (program.available() == 0) {
+            return ProgramResult::full;
+        }
+        if (!program.append(step)) {
+            return ProgramResult::invalid;
+        }
+    }
+    return ProgramResult::ok;
+}
+
+#endif  // OSSM_SOFTWARE_COMMAND_PROGRAM_H
@@ -0,0 +1,168 @@
+#ifndef OSSM_SOFTWARE_READER_H
+#define OSSM_SOFTWARE_READER_H
+
+#include <cstddef>
+#include <cstring>
+
+// Cursor over a received text command, for parsers that validate and decode
+// in one pass. Works on the received bytes, nothing is copied, allocated or
+// needs to be null terminated.
+//
+// Every read either takes what it matched and returns true, or leaves the
+// cursor where it was and returns false.
+class CommandReader {
+  public:
+    CommandReader(const char* str, size_t length)
+        : at(str), end(str + length) {}
+
+    bool atEnd() const { return at == end; }
+
+    // Takes c if it comes next
+    bool skip(char c) {
+        if (at == end || *at != c) {
+            return false;
+        }
+        at++;
+        return true;
+    }
+
+    void skipSpaces() {
+        while (at != end && isSpace(*at)) {
+            at++;
+        }
+    }
+
+    // Takes text if it comes next, letters compared ignoring their case if
+    // asked to
+    bool literal(const char* text, bool ignoreCase = false) {
+        const char* next = at;
+        for (; *text != '\0'; text++, next++) {
+            if (next == end || !same(*next, *text, ignoreCase)) {
+                return false;
+            }
+        }
+        at = next;
+        return true;
+    }
+
+    // Takes the longest run of letters and returns its index in names, -1
+    // if it isn't one of them
+    int word(const char* const* names, int count, bool ignoreCase = false) {
+        const char* next = at;
+        while (next != end && isLetter(*next)) {
+            next++;
+        }
+        size_t length = next - at;
+        for (int i = 0; length > 0 && i < count; i++) {
+            if (strlen(names[i]) == length && matches(names[i], ignoreCase)) {
+                at = next;
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    // Takes a number in its canonical form, so "05" or "+5" are rejected.
+    // False if there is none or it exceeds max.
+    bool number(int max, int& value) {
+        const char* next = at;
+        int parsed = 0;
+        int digits = 0;
+        while (next != end && isDigit(*next)) {
+            if (++digits > 9) {
+                return false;
+            }
+            parsed = parsed * 10 + (*next++ - '0');
+        }
+        if (digits == 0 || (digits > 1 && *at == '0') || parsed > max) {
+            return false;
+        }
+        at = next;
+        value = parsed;
+        return true;
+    }
+
+    // Takes a run of digits as written, leading zeros and all. Saturates at
+    // 999999999 instead of overflowing.
+    bool digits(int& value) {
+        if (at == end || !isDigit(*at)) {
+            return false;
+        }
+        value = 0;
+        while (at != end && isDigit(*at)) {
+            value = value < 100000000 ? value * 10 + (*at - '0') : 999999999;
+            at++;
+        }
+        return true;
+    }
+
+    // Takes a number up to max with as many decimals as scale has zeros,
+    // scaled, so "50.25" is 5025 with a scale of 100. The whole part is
+    // canonical as for number.
+    bool decimal(int max, int scale, int& value) {
+        const char* start = at;
+        int whole = 0;
+        if (!number(max, whole)) {
+            return false;
+        }
+        int parsed = whole * scale;
+
+        if (skip('.')) {
+            int digits = 0;
+            for (int place = scale / 10; at != end && isDigit(*at);
+                 place /= 10) {
+                if (place == 0) {
+                    at = start;
+                    return false;
+                }
+                parsed += (*at++ - '0') * place;
+                digits++;
+            }
+            if (digits == 0) {
+                at = start;
+                return false;
+            }
+        }
+
+        if (parsed > max * scale) {
+            at = start;
+            return false;
+        }
+        value = parsed;
+        return true;
+    }
+
+    // Takes a percentage 0-100 in hundredths with a scale of 100
+    bool percent(int scale, int& value) { return decimal(100, scale, value); }
+
+  private:
+    static bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+    static bool isLetter(char c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+    }
+
+    static bool isSpace(char c) {
+        return c == ' ' || (c >= '\t' && c <= '\r');
+    }
+
+    static char lower(char c) { return c >= 'A' && c <= 'Z' ? c + 32 : c; }
+
+    static bool same(char a, char b, bool ignoreCase) {
+        return ignoreCase ? lower(a) == lower(b) : a == b;
+    }
+
+    bool matches(const char* name, bool ignoreCase) const {
+        for (const char* next = at; *name != '\0'; name++, next++) {
+            if (!same(*next, *name, ignoreCase)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    const char* at;
+    const char* end;
+};
+
+#endif  // OSSM_SOFTWARE_READER_H
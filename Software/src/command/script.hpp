@@ -0,0 +1,87 @@
+#ifndef OSSM_SOFTWARE_SCRIPT_H
+#define OSSM_SOFTWARE_SCRIPT_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "ScriptBuffer.h"
+
+// Messages of the script characteristic. Each write is a one byte opcode,
+// values are little endian:
+//
+//   [0x01]                                   clear the buffer
+//   [0x02][first u32]{[time u32][position]}  append actions, first is the
+//                                            index of the first one in the
+//                                            script
+//   [0x03][time u32]                         play from script time ms
+//   [0x04]                                   pause, back to streaming
+//   [0x05][time u32]                         the client is at time ms now
+//
+// Chunks that overlap what was appended already are accepted from the first
+// new action on, so a client can resend a chunk whose status it missed.
+
+namespace ScriptOpcode {
+    constexpr uint8_t clear = 0x01;
+    constexpr uint8_t append = 0x02;
+    constexpr uint8_t play = 0x03;
+    constexpr uint8_t pause = 0x04;
+    constexpr uint8_t sync = 0x05;
+}
+
+enum class ScriptResult : uint8_t {
+    ok = 0x00,
+    malformed = 0x01,
+    gap = 0x02,      // Chunk starts after the next expected action
+    full = 0x03,     // Only part of the chunk fit, resend the rest later
+    invalid = 0x04,  // Position above 100 or time not after the previous
+};
+
+// Status the characteristic answers every write with, 16 bytes.
+struct __attribute__((packed)) ScriptStatus {
+    uint8_t isPlaying;
+    uint8_t result;     // ScriptResult of the last write
+    uint16_t reserved;
+    uint32_t next;      // Index of the next action to append
+    uint32_t available; // Actions that fit into the buffer
+    uint32_t time;      // Script time in ms, 0 while paused
+};
+
+static_assert(sizeof(ScriptStatus) == 16, "ScriptStatus must be 16 bytes");
+
+constexpr size_t scriptActionSize = 5;
+
+inline uint32_t readScriptU32(const uint8_t* data) {
+    return (uint32_t)data[0] | ((uint32_t)data[1] << 8) |
+           ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+}
+
+// Appends the actions of an append message, data points after the opcode.
+inline ScriptResult appendScriptChunk(ScriptBuffer& buffer, const uint8_t* data,
+                                      size_t length) {
+    if (length < 4 || (length - 4) % scriptActionSize != 0) {
+        return ScriptResult::malformed;
+    }
+
+    uint32_t first = readScriptU32(data);
+    uint32_t count = (length - 4) / scriptActionSize;
+    if (first > buffer.appended()) {
+        return ScriptResult::gap;
+    }
+
+    for (uint32_t i = buffer.appended() - first; i < count; i++) {
+        const uint8_t* point = data + 4 + i * scriptActionSize;
+        ScriptAction action = {readScriptU32(point), point[4]};
+        if (action.position > 100) {
+            return ScriptResult::invalid;
+        }
+        if (buffer.available() == 0) {
+            return ScriptResult::full;
+        }
+        if (!buffer.push(action)) {
+            return ScriptResult::invalid;
+        }
+    }
+    return ScriptResult::ok;
+}
+
+#endif  // OSSM_SOFTWARE_SCRIPT_H
@@ -8,7 +8,7 @@
 #include "constants/LogTags.h"
 #include "constants/UserConfig.h"
 #include "services/communication/nimble.h"
-#include "services/led.h"
+#include "services/tasks.h"
 
 // Task handle
 TaskHandle_t headerBarTaskHandle = nullptr;
@@ -156,6 +156,22 @@ void drawSpeedKnobIcon() {
     }
 }
 
+// Icons scene, also drawn again over every new page
+static void drawIcons() {
+    clearIcons();
+    drawSpeedKnobIcon();
+    drawBleIcon();
+    drawWifiIcon();
+}
+
+void notifyHeaderBar() {
+    if (headerBarTaskHandle != nullptr) {
+        xTaskNotifyGive(headerBarTaskHandle);
+    }
+}
+
+static void onWifiEvent(arduino_event_id_t event) { notifyHeaderBar(); }
+
 // --- Header Bar Task ---
 [[noreturn]] void headerBarTask(void* pvParameters) {
     // Initial delay to let other systems initialize
@@ -163,59 +179,37 @@ void drawSpeedKnobIcon() {
 
     ESP_LOGI(HEADERBAR_TAG, "Header bar task started");
 
-    if (xSemaphoreTake(displayMutex, 100) == pdTRUE) {
-        clearIcons();
-        drawSpeedKnobIcon();
-        drawBleIcon();
-        drawWifiIcon();
-
-        refreshIcons();
-        xSemaphoreGive(displayMutex);
-    }
+    drawScene(DisplayLayer::icons, drawIcons);
 
     while (true) {
+        // Sleep until a WiFi, BLE or speed knob change is posted
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
         bool shouldDrawWifi = shouldDrawWifiIcon();
         bool shouldDrawBle = shouldDrawBleIcon();
         bool shouldDrawSpeedKnob = shouldDrawSpeedKnobIcon();
 
-        // Update LED for machine status (checks homing first, then BLE status)
-        updateLEDForMachineStatus();
-
         // Only redraw if something changed
         if (!shouldDrawWifi && !shouldDrawBle && !shouldDrawSpeedKnob) {
-            vTaskDelay(100 / portTICK_PERIOD_MS);
             continue;
         }
 
-        // Take display mutex
-        if (xSemaphoreTake(displayMutex, 100) == pdTRUE) {
-            // Clear icon area
-            clearIcons();
-            drawSpeedKnobIcon();
-            drawBleIcon();
-            drawWifiIcon();
-            refreshIcons();
-
-            // Release display mutex
-            xSemaphoreGive(displayMutex);
-        } else {
-            ESP_LOGW(HEADERBAR_TAG, "Failed to acquire display mutex");
-        }
-
-        vTaskDelay(100 / portTICK_PERIOD_MS);
+        drawScene(DisplayLayer::icons, drawIcons);
     }
 }
 
 void initHeaderBar() {
     ESP_LOGI(HEADERBAR_TAG, "Initializing header bar task");
 
+    WiFi.onEvent(onWifiEvent);
+
     BaseType_t result =
         xTaskCreatePinnedToCore(headerBarTask, "headerBar",
                                 4 * configMINIMAL_STACK_SIZE,  // Stack size
                                 nullptr,
-                                tskIDLE_PRIORITY + 1,  // Priority
+                                Tasks::renderPriority,  // Priority
                                 &headerBarTaskHandle,
-                                0  // Core 0
+                                Tasks::renderCore  // Core 0
         );
 
     if (result != pdPASS) {
@@ -38,6 +38,10 @@ void drawSpeedKnobIcon();
 [[noreturn]] void headerBarTask(void* pvParameters);
 void initHeaderBar();
 
+// Wakes the header bar to check the WiFi, BLE and speed knob status. Call it
+// whenever one of them may have changed.
+void notifyHeaderBar();
+
 // Task handle
 extern TaskHandle_t headerBarTaskHandle;
 
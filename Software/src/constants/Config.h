@@ -14,7 +14,8 @@ namespace Config {
     */
     namespace Driver {
 
-        // Top linear speed of the device.
+        // Top linear speed of the device, unless the auto tune (in the menu)
+        // measured the limits of this machine.
         // Calculated from MAX_RPM 1500: (1500/60) * 20 * 2 = 1000 mm/s
         constexpr float maxSpeedMmPerSecond = 666.0f;
 
@@ -24,6 +25,11 @@ namespace Config {
         // Original: 20000.0f, reduced for better torque under load.
         constexpr float maxAcceleration = 10000.0f;
 
+        // Jerk limit of pattern moves in mm/s^3. Smooths the start and reversal
+        // of each stroke, which may allow raising maxAcceleration back towards
+        // the original 20000.0f. 0 keeps the plain trapezoidal profile.
+        constexpr float jerk = 0.0f;
+
         // This should match the step/rev of your stepper or servo.
         // N.b. the iHSV57 has a table on the side for setting the DIP switches
         // to your preference.
@@ -41,6 +47,54 @@ namespace Config {
         // reached the end of its stroke. during "Homing".
         constexpr float sensorlessCurrentLimit = 1.5f;
 
+        // A rise of the current by this much between two short sample
+        // windows is also treated as reaching the end of the stroke.
+        constexpr float sensorlessCurrentStep = 0.75f;
+
+        // While stroking, a mean current of more than governorDerateCurrent
+        // (percent above the idle current, like the homing limits) derates
+        // the acceleration and speed limits, down to governorMinScale of
+        // them. They are restored step by step after governorRestoreMs below
+        // governorRestoreCurrent. A governorDerateCurrent of 0 turns it off.
+        constexpr float governorDerateCurrent = 3.0f;
+        constexpr float governorRestoreCurrent = 2.0f;
+        constexpr float governorMinScale = 0.5f;
+        constexpr int governorRestoreMs = 1000;
+
+        // Homing approaches quickly and slows down for the last part of a
+        // stroke that is already known from a previous homing.
+        constexpr float homingFastSpeedMm = 50.0f;
+        constexpr float homingSlowSpeedMm = 25.0f;
+        constexpr float homingSlowZoneMm = 20.0f;
+
+        // Quick homing after a stop: drive to just short of the homed rear
+        // end at quickHomingSpeedMm and touch it off at homingSlowSpeedMm.
+        // Full homing takes over if the end is more than
+        // quickHomingToleranceMm off, or the idle current moved by more than
+        // quickHomingOffsetTolerance percent since the last full homing.
+        constexpr float quickHomingSpeedMm = 100.0f;
+        constexpr float quickHomingToleranceMm = 5.0f;
+        constexpr float quickHomingOffsetTolerance = 0.5f;
+
+        // Auto tune: autoTuneStrokes test strokes per trial, starting at
+        // the autoTuneStart limits and growing by autoTuneStepFactor up to
+        // the autoTuneMax limits. A trial is unreliable if the mean current
+        // goes over autoTuneCurrentLimit (percent above the idle current,
+        // like the homing limits) or the touch-off after it finds the rear
+        // end more than autoTuneToleranceMm off, i.e. steps were lost.
+        // autoTuneRefineSteps bisections close in on the first unreliable
+        // trial, and autoTuneMargin of the highest reliable limits are kept.
+        constexpr float autoTuneStartSpeedMm = 200.0f;
+        constexpr float autoTuneStartAcceleration = 5000.0f;
+        constexpr float autoTuneMaxSpeedMm = 1000.0f;
+        constexpr float autoTuneMaxAcceleration = 40000.0f;
+        constexpr float autoTuneStepFactor = 1.2f;
+        constexpr int autoTuneRefineSteps = 2;
+        constexpr float autoTuneMargin = 0.8f;
+        constexpr int autoTuneStrokes = 10;
+        constexpr float autoTuneCurrentLimit = 6.0f;
+        constexpr float autoTuneToleranceMm = 2.0f;
+
         constexpr float stepsPerMM =
             motorStepPerRevolution / (pulleyToothCount * beltPitchMm);
 
@@ -69,6 +123,16 @@ namespace Config {
         // If the stroke length is less than this value, then the stroke is
         // likely the result of a poor homing.
         constexpr float minStrokeLengthMm = 50.0_mm;
+
+        // A second actuator, e.g. a twist, driven next to the stroke from the
+        // same stepper engine. It is used once Pins::Driver::auxStepPin is
+        // set. Its travel is in whatever unit auxStepsPerUnit is given in,
+        // degrees for a twist, and is centered where the actuator stands at
+        // the first homing. Patterns like Twist move it with every stroke.
+        constexpr float auxTravel = 180.0f;
+        constexpr float auxStepsPerUnit = 800.0f / 360.0f;
+        constexpr float auxMaxSpeed = 720.0f;
+        constexpr float auxMaxAcceleration = 7200.0f;
     }
 
     /**
@@ -84,12 +148,19 @@ namespace Config {
 
     /**
         Font Config. These must be the "f" variants of the font to support other
-       languages.
+       languages. Builds with only ASCII copy (see pack_assets.py glyphs) can
+       set OSSM_ASCII_FONTS for the smaller "r" variants.
 */
     namespace Font {
+#ifdef OSSM_ASCII_FONTS
+        static auto bold = u8g2_font_helvB08_tr;
+        static auto base = u8g2_font_helvR08_tr;
+        static auto small = u8g2_font_6x10_tr;
+#else
         static auto bold = u8g2_font_helvB08_tf;
         static auto base = u8g2_font_helvR08_tf;
         static auto small = u8g2_font_6x10_tf;
+#endif
     }
 
     /**
@@ -109,6 +180,85 @@ namespace Config {
 
         constexpr float accelerationScaling = 100.0f;
 
+        // StrokeEngine and streaming apply setting changes as soon as they
+        // are published, but at most once per this many milliseconds, so a
+        // fast spinning encoder doesn't replan the motion on every detent.
+        constexpr int settingApplyIntervalMs = 20;
+        // How long they sleep without changes before checking their state
+        constexpr int settingWaitTimeoutMs = 100;
+        // Streamed targets play out on the ticks of a timer at this rate
+        // (500 - 2000 Hz) instead of the FreeRTOS tick. 0 keeps the tick.
+        constexpr int streamingLoopRateHz = 1000;
+
+        // Pages that only change with the encoder wait this long for input
+        // before they check whether their state (or the WiFi) changed.
+        constexpr int inputWaitTimeoutMs = 250;
+
+        // Motion telemetry characteristic: sample rate while a client is
+        // subscribed, the highest rate a client may ask for and how long
+        // samples may wait before a partly filled notification goes out.
+        constexpr int telemetryRateHz = 50;
+        constexpr int telemetryMaxRateHz = 200;
+        constexpr int telemetryFlushMs = 100;
+
+        // Latency characteristic: how often the stepper is polled for the
+        // first step of a probed command and when a probe gives up.
+        constexpr int latencyPollUs = 250;
+        constexpr int latencyTimeoutMs = 500;
+
+        // GPIO rules: how often the step position is compared with the
+        // positions of inward and outward rules, and pulses are ended.
+        constexpr int gpioRulePollUs = 250;
+
+        // Compressed updates: how often a dropped download is resumed before
+        // giving up, the pause in between and how long a read may stall.
+        constexpr int otaRetries = 5;
+        constexpr int otaRetryDelayMs = 2000;
+        constexpr int otaReadTimeoutMs = 5000;
+
+        // UDP control (OSSM_UDP_CONTROL): the port it listens on, and how
+        // long the peer may stay silent before the machine eases to a stop.
+        // The state goes out on change, and at least this often.
+        constexpr uint16_t udpControlPort = 7520;
+        constexpr int udpPeerTimeoutMs = 2000;
+        constexpr int udpStateIntervalMs = 1000;
+
+        // Net log (OSSM_NET_LOG): the port it takes subscriptions on, and how
+        // long a subscriber may stay silent before it stops getting the log.
+        constexpr uint16_t netLogPort = 7521;
+        constexpr int netLogPeerTimeoutMs = 10000;
+
+        // Script characteristic: actions the preloaded script buffer holds
+        // in PSRAM, and in internal RAM on boards without it. 8 bytes each.
+        constexpr uint32_t scriptPsramActions = 65536;
+        constexpr uint32_t scriptRamActions = 1024;
+
+        // Programs: how often a playing program updates the settings, and
+        // how long its fail-safe stop eases the speed down.
+        constexpr int programTickMs = 20;
+        constexpr int programStopRampMs = 2000;
+
+        // Coexistence: how often the state and the BLE connection are
+        // checked for a new radio plan.
+        constexpr int coexPollMs = 250;
+
+        // How long the button and BLE commands wait for a free slot in the
+        // event queue before an event is dropped. Stops are never dropped.
+        constexpr int eventPostWaitMs = 20;
+
+        // Heap monitor: fragmentation in percent and largest free block in
+        // bytes that raise an alert, and the periods of samples (one per
+        // second) the largest block may shrink in a row.
+        constexpr uint8_t heapFragmentedPercent = 60;
+        constexpr uint32_t heapLowBlockBytes = 16384;
+        constexpr uint16_t heapTrendPeriodSamples = 60;
+        constexpr uint8_t heapShrinkPeriods = 5;
+
+        // Memory budgets of the subsystems that allocate at run time. The
+        // script budget fits the PSRAM buffer, see scriptPsramActions.
+        constexpr uint32_t jsonBudgetBytes = 16384;
+        constexpr uint32_t scriptBudgetBytes = scriptPsramActions * 8;
+
     }
 
 }
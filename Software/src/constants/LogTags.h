@@ -11,4 +11,12 @@ static const char* HEADERBAR_TAG = "HeaderBar";
 
 static const char* NIMBLE_TAG = "NIMBLE";
 
+static const char* STROKE_TIMING_TAG = "StrokeTiming";
+
+static const char* UDP_TAG = "UDP";
+
+static const char* NET_LOG_TAG = "NetLog";
+
+static const char* COEX_TAG = "Coex";
+
 #endif  // SOFTWARE_LOGTAGS_H
@@ -12,6 +12,7 @@ enum Menu {
     UpdateOSSM,
     WiFiSetup,
     Help,
+    AutoTune,
     Restart,
     NUM_OPTIONS
 };
@@ -20,7 +21,7 @@ static const char* menuStrings[Menu::NUM_OPTIONS] = {
     UserConfig::language.SimplePenetration, UserConfig::language.StrokeEngine,
     UserConfig::language.Streaming,         UserConfig::language.Update,
     UserConfig::language.WiFiSetup,         UserConfig::language.GetHelp,
-    UserConfig::language.Restart,
+    UserConfig::language.AutoTune,          UserConfig::language.Restart,
 };
 
 #endif  // OSSM_SOFTWARE_MENU_H
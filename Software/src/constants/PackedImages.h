@@ -0,0 +1,69 @@
+#ifndef OSSM_SOFTWARE_PACKEDIMAGES_H
+#define OSSM_SOFTWARE_PACKEDIMAGES_H
+
+#include <Arduino.h>
+
+#include "utils/PackBits.h"
+
+// Generated by support/pack_assets.py from support/images, don't edit.
+namespace Images {
+    // 50x50, 350 bytes unpacked
+    const uint8_t KMLogoData[] PROGMEM = {
+        0x07, 0x00, 0xf0, 0xff, 0x7f, 0x00, 0x1f, 0x00, 0x18, 0xff, 0x00, 0x04,
+        0x40, 0x80, 0x60, 0x00, 0x04, 0xff, 0x00, 0x04, 0x20, 0x40, 0x80, 0x00,
+        0x02, 0xff, 0x00, 0x03, 0x10, 0x20, 0x00, 0x01, 0xfe, 0x00, 0x01, 0x08,
+        0x18, 0xff, 0x00, 0x00, 0x01, 0xff, 0x00, 0xff, 0x04, 0x01, 0x00, 0x02,
+        0xfe, 0x00, 0xff, 0x02, 0xfc, 0x00, 0xff, 0x01, 0xfd, 0x00, 0xff, 0x80,
+        0xfc, 0x00, 0xff, 0x40, 0xfc, 0x00, 0x01, 0x30, 0x20, 0xfc, 0x00, 0x03,
+        0x08, 0x20, 0x00, 0x7c, 0xfe, 0x00, 0x00, 0x04, 0xff, 0x00, 0x00, 0x02,
+        0xfe, 0x00, 0x01, 0x02, 0x40, 0xfc, 0x00, 0x00, 0x01, 0xfc, 0x00, 0x04,
+        0x80, 0x00, 0x01, 0x00, 0x01, 0xff, 0x00, 0x00, 0x40, 0xff, 0x80, 0xfd,
+        0x00, 0x03, 0x20, 0x40, 0x10, 0x80, 0xfe, 0x00, 0x04, 0x10, 0x20, 0x00,
+        0x01, 0x04, 0xfe, 0x00, 0x01, 0x18, 0x20, 0xfc, 0x00, 0x02, 0x04, 0x00,
+        0x40, 0xfb, 0x00, 0xff, 0x02, 0xfe, 0x00, 0x01, 0x04, 0x40, 0xfc, 0x00,
+        0x02, 0x08, 0x00, 0x20, 0xfd, 0x00, 0x03, 0x10, 0x00, 0x04, 0x01, 0xff,
+        0x00, 0x03, 0x10, 0x20, 0x80, 0x10, 0xfe, 0x00, 0x03, 0x20, 0x40, 0x00,
+        0x88, 0xfe, 0x00, 0x03, 0x40, 0x80, 0x00, 0x01, 0xfe, 0x00, 0x02, 0x80,
+        0x00, 0x01, 0xfc, 0x00, 0x02, 0x01, 0x00, 0x40, 0xfd, 0x00, 0x02, 0x02,
+        0x00, 0x02, 0xfd, 0x00, 0x02, 0x04, 0x00, 0x3c, 0xfd, 0x00, 0x01, 0x08,
+        0x10, 0xfc, 0x00, 0x01, 0x10, 0x20, 0xfc, 0x00, 0x01, 0x20, 0x40, 0xfc,
+        0x00, 0x01, 0x40, 0x80, 0xfc, 0x00, 0x03, 0x80, 0x00, 0x01, 0x78, 0xfd,
+        0x00, 0x01, 0x01, 0x02, 0xfc, 0x00, 0x01, 0x02, 0x04, 0xfc, 0x00, 0x01,
+        0x04, 0x08, 0xfc, 0x00, 0x01, 0x08, 0x10, 0xfc, 0x00, 0x01, 0x10, 0x20,
+        0xfc, 0x00, 0x01, 0x20, 0x40, 0xfc, 0x00, 0x01, 0x40, 0x80, 0xfc, 0x00,
+        0x04, 0x80, 0x00, 0x01, 0x00, 0x01, 0xfe, 0x00, 0x04, 0x01, 0x00, 0x02,
+        0xe0, 0x0f, 0xff, 0x00, 0x03, 0xfe, 0x01, 0x00, 0x02, 0xfc, 0x00, 0x01,
+        0x01, 0x04, 0xfd, 0x00, 0x02, 0x80, 0x00, 0x18, 0xfd, 0x00, 0x01, 0x60,
+        0x00,
+    };
+    const PackedXbm KMLogo = {50, 50, 301, KMLogoData};
+
+    // 57x50, 400 bytes unpacked
+    const uint8_t RDLogoData[] PROGMEM = {
+        0x01, 0x00, 0x78, 0xfa, 0x00, 0x01, 0x84, 0x07, 0xfb, 0x00, 0x01, 0x02,
+        0x78, 0xfa, 0x00, 0x01, 0x80, 0x0f, 0xfc, 0x00, 0x03, 0x01, 0x00, 0xf0,
+        0x01, 0xfa, 0x00, 0x00, 0x1e, 0xfa, 0x00, 0x01, 0xe0, 0x01, 0xfe, 0x00,
+        0xff, 0xff, 0x02, 0x0f, 0x00, 0x1e, 0xfc, 0x00, 0x03, 0x10, 0x00, 0xe0,
+        0x01, 0xfd, 0x00, 0x00, 0x20, 0xff, 0x00, 0x00, 0x1e, 0xfd, 0x00, 0x00,
+        0x40, 0xff, 0x00, 0x00, 0x60, 0xff, 0x00, 0x02, 0xfc, 0xff, 0x07, 0xff,
+        0x00, 0x00, 0x80, 0xf9, 0x00, 0x00, 0x01, 0xee, 0x00, 0x00, 0x04, 0xfe,
+        0x00, 0x04, 0x01, 0x00, 0xfc, 0xff, 0x43, 0xf2, 0x00, 0x00, 0x20, 0xff,
+        0x00, 0x04, 0x80, 0x00, 0x20, 0xfc, 0xff, 0xf9, 0x00, 0x00, 0x01, 0xfa,
+        0x00, 0x00, 0x20, 0xfd, 0x00, 0x00, 0x10, 0xff, 0x00, 0x00, 0x02, 0xff,
+        0x00, 0x00, 0x40, 0xfd, 0x00, 0x00, 0x40, 0xfa, 0x00, 0x00, 0x84, 0xff,
+        0xff, 0xff, 0x00, 0x01, 0xc0, 0x03, 0xfd, 0x00, 0x02, 0x03, 0x00, 0x08,
+        0xfc, 0x00, 0x00, 0x04, 0xfa, 0x00, 0x00, 0x20, 0xfd, 0x00, 0x00, 0x80,
+        0xff, 0xff, 0xf9, 0x00, 0x00, 0x08, 0xf8, 0x00, 0x00, 0x04, 0xfc, 0x00,
+        0x00, 0x10, 0xe8, 0x00, 0x02, 0x02, 0x00, 0x38, 0xf2, 0x00, 0x00, 0xc6,
+        0xfc, 0x00, 0x00, 0x02, 0xfd, 0x00, 0x00, 0x80, 0xfc, 0x00, 0x02, 0x80,
+        0xff, 0x7f, 0xff, 0x00, 0x02, 0x0c, 0x00, 0xc6, 0xfc, 0x00, 0x00, 0xf0,
+        0xfc, 0x00, 0x00, 0x02, 0xff, 0x00, 0x02, 0x0f, 0x38, 0xf8, 0xff, 0xff,
+        0x00, 0x01, 0xff, 0x00, 0x00, 0xf0, 0xf9, 0x00, 0x00, 0x0f, 0xfa, 0x00,
+        0x00, 0xf0, 0xfe, 0x00, 0x00, 0x02, 0xfd, 0x00, 0x00, 0x1f, 0xfa, 0x00,
+        0x01, 0xe0, 0x03, 0xfa, 0x00, 0x02, 0x3c, 0x00, 0x01, 0xfc, 0x00, 0x01,
+        0xc0, 0x83, 0xff, 0x00,
+    };
+    const PackedXbm RDLogo = {57, 50, 256, RDLogoData};
+}
+
+#endif  // OSSM_SOFTWARE_PACKEDIMAGES_H
@@ -43,6 +43,12 @@ namespace Pins {
         // Pin for motor enable - likely labelled ENA on drivers.
         constexpr int motorEnablePin = 26;
 
+        // Step, direction and enable pins of a second actuator, see
+        // Config::Driver::auxTravel. -1 if there is none.
+        constexpr int auxStepPin = -1;
+        constexpr int auxDirectionPin = -1;
+        constexpr int auxEnablePin = -1;
+
         // define the IO pin the emergency stop switch is connected to
         constexpr int stopPin = 19;
         // define the IO pin where the limit(homingStart) switch(es) are
@@ -4,6 +4,9 @@
 #include "structs/LanguageStruct.h"
 
 // English copy - All strings stored in PROGMEM
+static const char enUs_AutoTune[] PROGMEM = "Auto Tune";
+static const char enUs_AutoTuneLost[] PROGMEM =
+    "Auto tune lost the rail. Please check your belt and try again.";
 static const char enUs_DeepThroatTrainerSync[] PROGMEM = "DeepThroat Sync";
 static const char enUs_Error[] PROGMEM = "Error";
 static const char enUs_GetHelp[] PROGMEM = "Get Help";
@@ -59,6 +62,10 @@ static const char enUs_StrokeEngineDescriptions_7[] PROGMEM =
     "Multi-phase stroke with pauses; sensation controls final push speed.";
 static const char enUs_StrokeEngineDescriptions_8[] PROGMEM =
     "Slows down end of stroke; sensation controls slow portion amount.";
+static const char enUs_StrokeEngineDescriptions_9[] PROGMEM =
+    "Plays the keyframes uploaded over Bluetooth; no sensation.";
+static const char enUs_StrokeEngineDescriptions_10[] PROGMEM =
+    "Simple stroke with a twist actuator; sensation sets the twist.";
 
 static const char enUs_StrokeEngineNames_0[] PROGMEM = "Simple Stroke";
 static const char enUs_StrokeEngineNames_1[] PROGMEM = "Teasing Pounding";
@@ -69,8 +76,12 @@ static const char enUs_StrokeEngineNames_5[] PROGMEM = "Stop'n'Go";
 static const char enUs_StrokeEngineNames_6[] PROGMEM = "Insist";
 static const char enUs_StrokeEngineNames_7[] PROGMEM = "Knot";
 static const char enUs_StrokeEngineNames_8[] PROGMEM = "Struggle";
+static const char enUs_StrokeEngineNames_9[] PROGMEM = "Custom";
+static const char enUs_StrokeEngineNames_10[] PROGMEM = "Twist";
 
 static const LanguageStruct enUs = {
+    .AutoTune = enUs_AutoTune,
+    .AutoTuneLost = enUs_AutoTuneLost,
     .DeepThroatTrainerSync = enUs_DeepThroatTrainerSync,
     .Error = enUs_Error,
     .GetHelp = enUs_GetHelp,
@@ -108,11 +119,14 @@ static const LanguageStruct enUs = {
                                  enUs_StrokeEngineDescriptions_5,
                                  enUs_StrokeEngineDescriptions_6,
                                  enUs_StrokeEngineDescriptions_7,
-                                 enUs_StrokeEngineDescriptions_8},
+                                 enUs_StrokeEngineDescriptions_8,
+                                 enUs_StrokeEngineDescriptions_9,
+                                 enUs_StrokeEngineDescriptions_10},
     .StrokeEngineNames = {enUs_StrokeEngineNames_0, enUs_StrokeEngineNames_1,
                           enUs_StrokeEngineNames_2, enUs_StrokeEngineNames_3,
                           enUs_StrokeEngineNames_4, enUs_StrokeEngineNames_5,
                           enUs_StrokeEngineNames_6, enUs_StrokeEngineNames_7,
-                          enUs_StrokeEngineNames_8}};
+                          enUs_StrokeEngineNames_8, enUs_StrokeEngineNames_9,
+                          enUs_StrokeEngineNames_10}};
 
 #endif  // OSSM_SOFTWARE_EN_US_H
@@ -6,6 +6,9 @@
 // TODO: Requires validation by a native french speaker.
 //  These have been translated by Google Translate.
 // French copy - All strings stored in PROGMEM
+static const char fr_AutoTune[] PROGMEM = "Réglage auto";
+static const char fr_AutoTuneLost[] PROGMEM =
+    "Le réglage auto a perdu le rail. Vérifiez la courroie et réessayez.";
 static const char fr_DeepThroatTrainerSync[] PROGMEM = "DeepThroat Sync";
 static const char fr_Error[] PROGMEM = "Erreur";
 static const char fr_GetHelp[] PROGMEM = "Aide";
@@ -65,6 +68,11 @@ static const char fr_StrokeEngineDescriptions_7[] PROGMEM =
     "Coup multi-phase avec pauses ; la sensation contrôle la vitesse finale.";
 static const char fr_StrokeEngineDescriptions_8[] PROGMEM =
     "Ralentit la fin du coup ; la sensation contrôle la portion lente.";
+static const char fr_StrokeEngineDescriptions_9[] PROGMEM =
+    "Joue les images clés envoyées par Bluetooth ; sans sensation.";
+static const char fr_StrokeEngineDescriptions_10[] PROGMEM =
+    "Coup simple avec un actionneur de torsion ; la sensation règle la "
+    "torsion.";
 
 static const char fr_StrokeEngineNames_0[] PROGMEM = "Simple Stroke";
 static const char fr_StrokeEngineNames_1[] PROGMEM = "Teasing Pounding";
@@ -75,8 +83,12 @@ static const char fr_StrokeEngineNames_5[] PROGMEM = "Stop'n'Go";
 static const char fr_StrokeEngineNames_6[] PROGMEM = "Insist";
 static const char fr_StrokeEngineNames_7[] PROGMEM = "Knot";
 static const char fr_StrokeEngineNames_8[] PROGMEM = "Struggle";
+static const char fr_StrokeEngineNames_9[] PROGMEM = "Custom";
+static const char fr_StrokeEngineNames_10[] PROGMEM = "Torsion";
 
 static const LanguageStruct fr = {
+    .AutoTune = fr_AutoTune,
+    .AutoTuneLost = fr_AutoTuneLost,
     .DeepThroatTrainerSync = fr_DeepThroatTrainerSync,
     .Error = fr_Error,
     .GetHelp = fr_GetHelp,
@@ -114,11 +126,14 @@ static const LanguageStruct fr = {
                                  fr_StrokeEngineDescriptions_5,
                                  fr_StrokeEngineDescriptions_6,
                                  fr_StrokeEngineDescriptions_7,
-                                 fr_StrokeEngineDescriptions_8},
+                                 fr_StrokeEngineDescriptions_8,
+                                 fr_StrokeEngineDescriptions_9,
+                                 fr_StrokeEngineDescriptions_10},
     .StrokeEngineNames = {fr_StrokeEngineNames_0, fr_StrokeEngineNames_1,
                           fr_StrokeEngineNames_2, fr_StrokeEngineNames_3,
                           fr_StrokeEngineNames_4, fr_StrokeEngineNames_5,
                           fr_StrokeEngineNames_6, fr_StrokeEngineNames_7,
-                          fr_StrokeEngineNames_8}};
+                          fr_StrokeEngineNames_8, fr_StrokeEngineNames_9,
+                          fr_StrokeEngineNames_10}};
 
 #endif  // OSSM_SOFTWARE_FR_H
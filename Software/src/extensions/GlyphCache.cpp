@@ -0,0 +1,149 @@
+#include "GlyphCache.h"
+
+#include <esp_log.h>
+
+#include <cstdlib>
+
+#include "services/display.h"
+#include "utils/Xbm.h"
+
+static auto TAG = "GLYPHS";
+
+#define GLYPH_FIRST 0x20
+#define GLYPH_COUNT 95  // Printable ASCII
+#define GLYPH_MAX_WIDTH 16
+#define GLYPH_MAX_HEIGHT 16  // The two tile rows of the scratch buffer
+#define GLYPH_FONTS 4
+
+struct CachedGlyph {
+    bool isRendered;
+    uint8_t width;  // Advance, the bitmap is as wide
+    uint8_t bits[xbmRowBytes(GLYPH_MAX_WIDTH) * GLYPH_MAX_HEIGHT];
+};
+
+struct CachedFont {
+    const uint8_t *font;
+    int8_t ascent;
+    uint8_t height;
+    CachedGlyph *glyphs;  // GLYPH_COUNT of them, allocated on first use
+};
+
+static CachedFont fonts[GLYPH_FONTS];
+
+// Glyphs are rendered here, never sent anywhere
+static u8g2_t scratch;
+static bool hasScratch = false;
+
+static CachedFont *cachedFont(const uint8_t *font) {
+    for (CachedFont &cached : fonts) {
+        if (cached.font == font) {
+            return cached.glyphs != nullptr ? &cached : nullptr;
+        }
+    }
+
+    for (CachedFont &cached : fonts) {
+        if (cached.font != nullptr) {
+            continue;
+        }
+
+        if (!hasScratch) {
+            u8g2_Setup_ssd1306_i2c_128x64_noname_2(
+                &scratch, U8G2_R0, u8x8_byte_empty, u8x8_dummy_cb);
+            u8g2_SetFontMode(&scratch, 1);
+            hasScratch = true;
+        }
+
+        u8g2_SetFont(&scratch, font);
+        cached.font = font;
+        cached.ascent = u8g2_GetAscent(&scratch);
+        cached.height = cached.ascent - u8g2_GetDescent(&scratch);
+
+        // Fonts too tall for the scratch buffer stay uncached
+        if (cached.ascent > 0 && cached.height <= GLYPH_MAX_HEIGHT) {
+            cached.glyphs =
+                (CachedGlyph *)calloc(GLYPH_COUNT, sizeof(CachedGlyph));
+        }
+        ESP_LOGD(TAG, "Caching font with height %d: %d", cached.height,
+                 cached.glyphs != nullptr);
+        return cached.glyphs != nullptr ? &cached : nullptr;
+    }
+
+    return nullptr;
+}
+
+static CachedGlyph *cachedGlyph(CachedFont &cached, char c) {
+    if (c < GLYPH_FIRST || c >= GLYPH_FIRST + GLYPH_COUNT) {
+        return nullptr;
+    }
+
+    CachedGlyph &glyph = cached.glyphs[c - GLYPH_FIRST];
+    if (!glyph.isRendered) {
+        u8g2_SetFont(&scratch, cached.font);
+        u8g2_ClearBuffer(&scratch);
+        int width = u8g2_DrawGlyph(&scratch, 0, cached.ascent, c);
+
+        glyph.isRendered = true;
+        glyph.width = width <= GLYPH_MAX_WIDTH ? width : 0xFF;
+        if (glyph.width <= GLYPH_MAX_WIDTH) {
+            pageToXbm(u8g2_GetBufferPtr(&scratch), SCREEN_WIDTH, glyph.width,
+                      cached.height, glyph.bits);
+        }
+    }
+
+    return glyph.width <= GLYPH_MAX_WIDTH ? &glyph : nullptr;
+}
+
+// Renders the glyphs of str that aren't cached yet, false if any can't be
+static bool cacheAll(CachedFont *cached, const char *str) {
+    if (cached == nullptr) {
+        return false;
+    }
+    for (const char *c = str; *c; c++) {
+        if (cachedGlyph(*cached, *c) == nullptr) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int drawCached::text(const uint8_t *font, int x, int y, const char *str) {
+    display.setFont(font);
+    CachedFont *cached = cachedFont(font);
+    if (!cacheAll(cached, str)) {
+        return display.drawUTF8(x, y, str);
+    }
+
+    // Only the glyph pixels, like transparent text
+    u8g2_t *u8g2 = display.getU8g2();
+    uint8_t transparency = u8g2->bitmap_transparency;
+    u8g2->bitmap_transparency = 1;
+
+    int start = x;
+    for (const char *c = str; *c; c++) {
+        CachedGlyph *glyph = cachedGlyph(*cached, *c);
+        display.drawXBM(x, y - cached->ascent, glyph->width, cached->height,
+                        glyph->bits);
+        x += glyph->width;
+    }
+
+    u8g2->bitmap_transparency = transparency;
+    return x - start;
+}
+
+int drawCached::width(const uint8_t *font, const char *str) {
+    CachedFont *cached = cachedFont(font);
+    if (!cacheAll(cached, str)) {
+        // Measuring doesn't change the font of whoever draws next
+        const uint8_t *current = display.getU8g2()->font;
+        display.setFont(font);
+        int width = display.getUTF8Width(str);
+        display.setFont(current);
+        return width;
+    }
+
+    int width = 0;
+    for (const char *c = str; *c; c++) {
+        width += cachedGlyph(*cached, *c)->width;
+    }
+    return width;
+}
@@ -0,0 +1,22 @@
+#ifndef OSSM_SOFTWARE_GLYPHCACHE_H
+#define OSSM_SOFTWARE_GLYPHCACHE_H
+
+#include <cstdint>
+
+/**
+ * Pre-rendered glyphs for text that is drawn over and over, like the values
+ * of the play controls. Each printable ASCII glyph of a font is rendered
+ * once into a scratch buffer and kept as an XBM bitmap, after that drawing
+ * is a blit. Text with other characters is drawn with U8G2 as usual.
+ *
+ * Only for the render task, like the display itself.
+ */
+namespace drawCached {
+    // Draws str in font with its baseline at y, returns its width
+    int text(const uint8_t* font, int x, int y, const char* str);
+
+    // Width of str in font, without drawing it
+    int width(const uint8_t* font, const char* str);
+}
+
+#endif  // OSSM_SOFTWARE_GLYPHCACHE_H
@@ -0,0 +1,136 @@
+#include "Widgets.h"
+
+#include "GlyphCache.h"
+#include "services/display.h"
+
+using namespace ui;
+
+void Widget::erase() {
+    if (box.isEmpty()) {
+        return;
+    }
+    display.setDrawColor(0);
+    display.drawBox(box.x, box.y, box.w, box.h);
+    display.setDrawColor(1);
+}
+
+void Widget::draw() {
+    box = paint();
+    dirty = false;
+}
+
+Box Label::paint() {
+    int width = drawCached::width(font, text.c_str());
+    int left = x;
+    if (align == Align::center) {
+        left = (display.getDisplayWidth() - width) / 2;
+    } else if (align == Align::right) {
+        left = x - width;
+    }
+
+    drawCached::text(font, left, y, text.c_str());
+    int ascent = display.getAscent();
+    return {(int16_t)left, (int16_t)(y - ascent), (int16_t)width,
+            (int16_t)(ascent - display.getDescent())};
+}
+
+Box Paragraph::paint() {
+    drawStr::multiLine(x, y, text);
+
+    // Wrapped text may run down to the bottom of the screen
+    int top = y - display.getAscent();
+    return {(int16_t)x, (int16_t)top,
+            (int16_t)(display.getDisplayWidth() - x),
+            (int16_t)(display.getDisplayHeight() - top)};
+}
+
+Box ValueBar::paint() {
+    if (isSmall) {
+        return drawShape::settingBarSmall(value, x, y);
+    }
+
+    // The label is placed using the base font, as on the play controls
+    display.setFont(Config::Font::base);
+    return drawShape::settingBar(name, value, x, y, alignment, textPadding);
+}
+
+Box List::paint() {
+    // Drawing Variables.
+    int leftPadding = 6;  // Padding on the left side of the screen
+    int fontSize = 8;
+    int itemHeight = 20;   // Height of each item
+    int visibleItems = 3;  // Number of items visible on the screen
+
+    // Loop around to make an infinite menu.
+    int lastIdx = selected - 1 < 0 ? count - 1 : selected - 1;
+    int nextIdx = selected + 1 > count - 1 ? 0 : selected + 1;
+
+    display.setFont(Config::Font::base);
+    display.drawUTF8(leftPadding, itemHeight * (1), items[lastIdx]);
+    display.drawUTF8(leftPadding, itemHeight * (3), items[nextIdx]);
+
+    // Draw the current item
+    display.setFont(Config::Font::bold);
+    display.drawUTF8(leftPadding, itemHeight * (2), items[selected]);
+
+    // Draw a rounded rectangle around the center item
+    display.drawRFrame(
+        0, itemHeight * (visibleItems / 2) - (fontSize - itemHeight) / 2, 120,
+        itemHeight, 2);
+
+    // Draw Shadow.
+    display.drawLine(2, 2 + fontSize / 2 + 2 * itemHeight, 119,
+                     2 + fontSize / 2 + 2 * itemHeight);
+    display.drawLine(120, 4 + fontSize / 2 + itemHeight, 120,
+                     1 + fontSize / 2 + 2 * itemHeight);
+
+    // From the top of the first item to below the last one
+    int top = itemHeight - fontSize - 2;
+    return {0, (int16_t)top, 121,
+            (int16_t)(display.getDisplayHeight() - top)};
+}
+
+void Screen::render() {
+    bool isCovered = !hasRendered || pageScenesDrawn() != renderedScene + 1;
+    hasRendered = true;
+    renderedScene = pageScenesDrawn();
+
+    if (isCovered) {
+        clearPage(true, includeHeader);
+        for (Widget *widget : widgets) {
+            widget->invalidate();
+        }
+    } else {
+        display.setClipWindow(0, includeHeader ? 0 : 8, 128, 64);
+    }
+
+    // Clearing a dirty widget may cut into its neighbours, they are drawn
+    // again as well until no more boxes are touched.
+    bool isSpreading = !isCovered;
+    while (isSpreading) {
+        isSpreading = false;
+        for (Widget *widget : widgets) {
+            if (!widget->isDirty()) {
+                continue;
+            }
+            for (Widget *other : widgets) {
+                if (!other->isDirty() &&
+                    other->bounds().overlaps(widget->bounds())) {
+                    other->invalidate();
+                    isSpreading = true;
+                }
+            }
+        }
+    }
+
+    for (Widget *widget : widgets) {
+        if (widget->isDirty()) {
+            widget->erase();
+        }
+    }
+    for (Widget *widget : widgets) {
+        if (widget->isDirty()) {
+            widget->draw();
+        }
+    }
+}
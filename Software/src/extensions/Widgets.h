@@ -0,0 +1,180 @@
+#ifndef OSSM_SOFTWARE_WIDGETS_H
+#define OSSM_SOFTWARE_WIDGETS_H
+
+#include <Arduino.h>
+
+#include <initializer_list>
+#include <vector>
+
+#include "structs/Points.h"
+#include "u8g2Extensions.h"
+
+/**
+ * Retained widgets for screens that change a little at a time. A widget
+ * keeps what it shows and the box it last drew into, and setting a value only
+ * marks it dirty when the value differs. Rendering a screen redraws the dirty
+ * widgets over their old box and leaves the rest of the frame alone, so the
+ * flush task only sends the tiles that actually changed.
+ *
+ * Widgets belong to the render task: a screen's task creates them, but only
+ * sets and renders them in its scenes.
+ */
+namespace ui {
+    class Widget {
+      public:
+        virtual ~Widget() = default;
+
+        bool isDirty() const { return dirty; }
+        void invalidate() { dirty = true; }
+
+        // Box of the last draw, empty before the first
+        const Box &bounds() const { return box; }
+
+        // Clears the box of the last draw
+        void erase();
+
+        // Draws the current value and remembers where
+        void draw();
+
+      protected:
+        // Draws the value, returns the box it drew into
+        virtual Box paint() = 0;
+
+        template <typename T>
+        void update(T &field, const T &value) {
+            if (!(field == value)) {
+                field = value;
+                dirty = true;
+            }
+        }
+
+      private:
+        Box box = {0, 0, 0, 0};
+        bool dirty = true;
+    };
+
+    enum class Align { left, center, right };
+
+    // One line of text, x is its left edge, center or right edge
+    class Label : public Widget {
+      public:
+        Label(const uint8_t *font, int x, int y, Align align = Align::left)
+            : font(font), x(x), y(y), align(align) {}
+
+        void set(const String &value) { update(text, value); }
+
+      protected:
+        Box paint() override;
+
+      private:
+        const uint8_t *font;
+        int x;
+        int y;
+        Align align;
+        String text;
+    };
+
+    // Text wrapped over as many lines as it takes, like drawStr::multiLine
+    class Paragraph : public Widget {
+      public:
+        Paragraph(int x, int y) : x(x), y(y) {}
+
+        void set(const String &value) { update(text, value); }
+
+      protected:
+        Box paint() override;
+
+      private:
+        int x;
+        int y;
+        String text;
+    };
+
+    // drawShape::settingBar, or settingBarSmall without a name
+    class ValueBar : public Widget {
+      public:
+        explicit ValueBar(int x, int y = 0) : x(x), y(y), isSmall(true) {}
+        ValueBar(const String &name, int x = 0, int y = 0,
+                 Alignment alignment = LEFT_ALIGNED, int textPadding = 0)
+            : name(name),
+              x(x),
+              y(y),
+              alignment(alignment),
+              textPadding(textPadding),
+              isSmall(false) {}
+
+        void set(float percent) { update(value, percent); }
+        void setName(const String &text) { update(name, text); }
+
+      protected:
+        Box paint() override;
+
+      private:
+        String name;
+        int x;
+        int y;
+        Alignment alignment = LEFT_ALIGNED;
+        int textPadding = 0;
+        bool isSmall;
+        float value = 0;
+    };
+
+    // drawShape::scroll
+    class ScrollBar : public Widget {
+      public:
+        void set(long percent) { update(position, percent); }
+
+      protected:
+        Box paint() override { return drawShape::scroll(position); }
+
+      private:
+        long position = 0;
+    };
+
+    // Three rows of an endless list around the selected item, as the menu
+    class List : public Widget {
+      public:
+        List(const char *const *items, int count) : items(items), count(count) {}
+
+        void select(int index) { update(selected, index); }
+
+      protected:
+        Box paint() override;
+
+      private:
+        const char *const *items;
+        int count;
+        int selected = 0;
+    };
+
+    /**
+     * The widgets of a page. The first render, and any render after some
+     * other page was drawn, clears the page and draws everything. After that
+     * only dirty widgets are drawn again, along with clean ones whose box
+     * overlaps a box that was cleared.
+     */
+    class Screen {
+      public:
+        explicit Screen(bool includeHeader = false)
+            : includeHeader(includeHeader) {}
+        Screen(std::initializer_list<Widget *> widgets,
+               bool includeHeader = false)
+            : widgets(widgets), includeHeader(includeHeader) {}
+
+        Screen &add(Widget *widget) {
+            widgets.push_back(widget);
+            return *this;
+        }
+
+        // Call from the screen's scenes, on the render task
+        void render();
+
+      private:
+        std::vector<Widget *> widgets;
+        bool includeHeader;
+        bool hasRendered = false;
+        uint32_t renderedScene = 0;
+    };
+}
+
+#endif  // OSSM_SOFTWARE_WIDGETS_H
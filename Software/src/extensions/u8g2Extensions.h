@@ -5,10 +5,12 @@
 
 #include <utility>
 
+#include "GlyphCache.h"
 #include "U8g2lib.h"
 #include "constants/Config.h"
 #include "services/display.h"
 #include "structs/Points.h"
+#include "utils/PackBits.h"
 
 // NOLINTBEGIN(hicpp-signed-bitwise)
 static int getUTF8CharLength(const unsigned char c) {
@@ -174,7 +176,8 @@ enum Alignment {
 };
 
 namespace drawShape {
-    static void scroll(long position) {
+    // Returns the box it drew into, like the other shapes
+    static Box scroll(long position) {
         int topMargin = 10;  // Margin at the top of the screen
 
         int scrollbarHeight = 64 - topMargin;  // Height of the scrollbar
@@ -196,10 +199,13 @@ namespace drawShape {
 
         // Draw the rectangle to represent the current position
         display.drawBox(scrollbarX, rectY, scrollbarWidth, scrollbarWidth);
+
+        return {(int16_t)scrollbarX, (int16_t)scrollbarY,
+                (int16_t)scrollbarWidth, (int16_t)scrollbarHeight};
     };
 
     // Function to draw a setting bar with label and percentage
-    static void settingBar(const String &name, float value, int x = 0,
+    static Box settingBar(const String &name, float value, int x = 0,
                            int y = 0, Alignment alignment = LEFT_ALIGNED,
                            int textPadding = 0, float minValue = 0,
                            float maxValue = 100) {
@@ -219,7 +225,9 @@ namespace drawShape {
         int barStartX = (alignment == LEFT_ALIGNED) ? x : x - w;
         int textStartX = (alignment == LEFT_ALIGNED)
                              ? x + w + padding + textPadding
-                             : x - display.getUTF8Width(name.c_str()) -
+                             : x -
+                                   drawCached::width(display.getU8g2()->font,
+                                                     name.c_str()) -
                                    padding - w - textPadding;
 
         // Calculate actual y positions (bottom-aligned)
@@ -231,10 +239,9 @@ namespace drawShape {
         display.drawBox(barStartX, barFillY, w, boxHeight);
         display.drawFrame(barStartX, barTopY, w, h);
 
-        // Set font for label and draw it (bottom-aligned)
-        display.setFont(
-            Config::Font::bold);  // Make sure Config::Font::base is defined
-        display.drawUTF8(textStartX, barTopY + lh1, name.c_str());
+        // Draw the label in bold (bottom-aligned), it stays the font after
+        int textWidth = drawCached::text(Config::Font::bold, textStartX,
+                                         barTopY + lh1, name.c_str());
 
         // Calculate quartile positions (bottom-aligned)
         int firstQuartile = barTopY + h * 3 / 4;
@@ -263,9 +270,15 @@ namespace drawShape {
         display.drawPixel(barStartX + 6, firstQuartile);
 
         display.setDrawColor(1);
+
+        Box bar = {(int16_t)barStartX, (int16_t)barTopY, (int16_t)w,
+                   (int16_t)h};
+        Box label = {(int16_t)textStartX, (int16_t)barTopY, (int16_t)textWidth,
+                     (int16_t)(lh1 - display.getDescent())};
+        return bar.merged(label);
     }
 
-    static void settingBarSmall(float value, int x = 0, int y = 0,
+    static Box settingBarSmall(float value, int x = 0, int y = 0,
                                 float minValue = 0, float maxValue = 100) {
         int w = 3;
         int mid = (w - 1) / 2;
@@ -287,6 +300,8 @@ namespace drawShape {
 
         // draw a box 3px wide (bottom-aligned)
         display.drawBox(x, barFillY, w, boxHeight);
+
+        return {(int16_t)x, (int16_t)barTopY, (int16_t)w, (int16_t)h};
     }
 
     // Function to draw lines between a variadic number of points
@@ -306,4 +321,19 @@ namespace drawShape {
 
 }
 
+namespace drawImage {
+    // Images are unpacked into this before drawing, it fits the whole
+    // screen. Scenes are drawn one at a time, so one buffer does.
+    static uint8_t scratch[128 * 64 / 8];
+
+    static void packed(int x, int y, const PackedXbm &image) {
+        if (!unpackXbm(image, scratch, sizeof(scratch))) {
+            ESP_LOGE("Display", "Packed image of %dx%d doesn't unpack",
+                     image.width, image.height);
+            return;
+        }
+        display.drawXBM(x, y, image.width, image.height, scratch);
+    }
+}
+
 #endif  // OSSM_SOFTWARE_U8G2EXTENSIONS_H
@@ -1,15 +1,22 @@
 #include "Arduino.h"
-#include "OneButton.h"
 #include "components/HeaderBar.h"
 #include "ossm/Events.h"
 #include "ossm/OSSM.h"
 #include "ossm/OSSMI.h"
 #include "services/board.h"
+#include "services/coex.h"
 #include "services/communication/nimble.h"
 #include "services/display.h"
 #include "services/encoder.h"
+#include "services/input.h"
 #include "services/stepper.h"
+#include "services/tasks.h"
 #include "services/led.h"
+#include "services/netlog.h"
+#include "services/outputs.h"
+#include "services/player.h"
+#include "services/profiler.h"
+#include "services/udp.h"
 #include "services/wm.h"
 
 /*
@@ -29,51 +36,82 @@
  * contribute, fork, branch and share!
  */
 
-OneButton button(Pins::Remote::encoderSwitch, false);
-
 void setup() {
     /** Board setup */
     initBoard();
 
+#if OSSM_NET_LOG
+    // From here on the log goes through a ring, and over WiFi once it's up
+    initNetLog();
+#endif
+
     ESP_LOGD("MAIN", "Starting OSSM");
 
     initWM();
 
+    // Shares the radio between WiFi and the BLE control link
+    initCoex();
+
+#if OSSM_UDP_CONTROL
+    // Realtime control over WiFi, next to BLE
+    initUdpControl();
+#endif
+
     // Display
     initDisplay();
 
     // Initialize header bar task
     initHeaderBar();
 
+    // Record stack usage of all tasks from the start
+    initStackMonitor();
+
+    // Hot path cycles, with OSSM_PROFILE
+    initProfiler();
+
+    // GPIO rules that follow the stroke
+    initOutputs();
+
     ossm = new OSSM(display, encoder, stepper);
     ossmInterface = ossm;
 
-    // Initialize LED for BLE and machine status indication
-    ESP_LOGI("MAIN", "LED initialized for BLE and machine status indication");
-    updateLEDForMachineStatus();  // Set initial LED state
+    // Setting programs, played on the device
+    initPlayer();
 
     // // link functions to be called on events.
-    button.attachClick([]() { ossm->sm->process_event(ButtonPress{}); });
-    button.attachDoubleClick([]() { ossm->sm->process_event(DoublePress{}); });
-    button.attachLongPressStart([]() { ossm->sm->process_event(LongPress{}); });
+    // A long press stops the motor from in here already, see postEvent()
+    button.attachClick([]() {
+        ossm->skipHello();
+        ossm->postEvent(EventId::buttonPress, -1,
+                        pdMS_TO_TICKS(Config::Advanced::eventPostWaitMs));
+    });
+    button.attachDoubleClick([]() {
+        ossm->postEvent(EventId::doublePress, -1,
+                        pdMS_TO_TICKS(Config::Advanced::eventPostWaitMs));
+    });
+    button.attachLongPressStart([]() { ossm->postEvent(EventId::longPress); });
+
+    // Button gestures and encoder wake ups are driven by their interrupts
+    initInput();
 
+#if OSSM_FAST_BOOT
+    // Commands are accepted while homing, the state machine only acts on
+    // the ones that apply
     xTaskCreatePinnedToCore(
         [](void *pvParameters) {
-            while (true) {
-                button.tick();
-                vTaskDelay(25 / portTICK_PERIOD_MS);
-            }
+            ESP_LOGD("MAIN", "Initializing NimBLE");
+            initNimble();
+            vTaskDelete(nullptr);
         },
-        "buttonTask", 4 * configMINIMAL_STACK_SIZE, nullptr,
-        configMAX_PRIORITIES - 1, nullptr, 0);
-
+        "initNimbleTask", 6 * configMINIMAL_STACK_SIZE, nullptr,
+        Tasks::communicationPriority, nullptr, Tasks::communicationCore);
+#else
     // Initialize NimBLE only when in menu.idle state
     xTaskCreatePinnedToCore(
         [](void *pvParameters) {
             bool initialized = false;
             while (true) {
-                if ((ossm->sm->is("menu.idle"_s) ||
-                     ossm->sm->is("error.idle"_s)) &&
+                if (isInState(StateId::menuIdle, StateId::errorIdle) &&
                     !initialized) {
                     ESP_LOGD("MAIN", "Initializing NimBLE");
                     initNimble();
@@ -84,7 +122,8 @@ void setup() {
             }
         },
         "initNimbleTask", 6 * configMINIMAL_STACK_SIZE, nullptr,
-        configMAX_PRIORITIES - 1, nullptr, 0);
+        Tasks::communicationPriority, nullptr, Tasks::communicationCore);
+#endif
 };
 
 void loop() { vTaskDelete(nullptr); };
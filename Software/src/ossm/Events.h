@@ -6,11 +6,11 @@ namespace sml = boost::sml;
 
 /**
  * These are the events that the OSSM state machine can respond to.
- * They are used in OSSM.h and can be called from anywhere in the code that has
- * access to an OSSM state machine
+ * They are used in OSSM.h and can be posted from anywhere in the code that has
+ * access to the OSSM, by their EventId. The dispatcher task processes them.
  *
  * For Example:
- *  ossm->sm.process_event(ButtonPress{});
+ *  ossm->postEvent(EventId::buttonPress);
  *
  *
  * There's nothing special about these events, they are just structs.
@@ -29,6 +29,59 @@ struct Home {};
 
 struct BleClick {};
 
+// Numeric ids for the state trace. Events that aren't listed here, like SML's
+// internal entry/exit and anonymous events, are not traced.
+enum class EventId : uint8_t {
+    buttonPress,
+    longPress,
+    doublePress,
+    done,
+    error,
+    emergencyStop,
+    home,
+    bleClick,
+
+    internal = 0xFF
+};
+
+template <class TEvent>
+struct EventIdOf {
+    static constexpr EventId value = EventId::internal;
+};
+
+template <>
+struct EventIdOf<ButtonPress> {
+    static constexpr EventId value = EventId::buttonPress;
+};
+template <>
+struct EventIdOf<LongPress> {
+    static constexpr EventId value = EventId::longPress;
+};
+template <>
+struct EventIdOf<DoublePress> {
+    static constexpr EventId value = EventId::doublePress;
+};
+template <>
+struct EventIdOf<Done> {
+    static constexpr EventId value = EventId::done;
+};
+template <>
+struct EventIdOf<Error> {
+    static constexpr EventId value = EventId::error;
+};
+template <>
+struct EventIdOf<EmergencyStop> {
+    static constexpr EventId value = EventId::emergencyStop;
+};
+template <>
+struct EventIdOf<Home> {
+    static constexpr EventId value = EventId::home;
+};
+template <>
+struct EventIdOf<BleClick> {
+    static constexpr EventId value = EventId::bleClick;
+};
+
 // Definitions to make the table easier to read.
 static auto bleClick = sml::event<BleClick>;
 static auto buttonPress = sml::event<ButtonPress>;
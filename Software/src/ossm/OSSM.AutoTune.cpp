@@ -0,0 +1,237 @@
+#include "OSSM.h"
+
+#include <Preferences.h>
+
+#include <atomic>
+
+#include "extensions/u8g2Extensions.h"
+#include "services/adc.h"
+
+// The ADC task delivers about one current sample per millisecond
+static constexpr size_t currentWindow = 32;
+
+// Highest mean current of a trial, fed from the ADC task while it strokes
+static float currentOffset = 0;
+static float currentSum = 0;
+static size_t currentCount = 0;
+static std::atomic<float> peakCurrent{0};
+
+static void onAutoTuneCurrentSample(float percent) {
+    currentSum += percent - currentOffset;
+    if (++currentCount < currentWindow) {
+        return;
+    }
+    float mean = currentSum / currentWindow;
+    currentSum = 0;
+    currentCount = 0;
+    if (mean > peakCurrent.load()) {
+        peakCurrent.store(mean);
+    }
+}
+
+// Bounds a stored result has to be in to be used
+static constexpr MachineLimits floorLimits = {
+    Config::Driver::autoTuneMargin * Config::Driver::autoTuneStartSpeedMm,
+    Config::Driver::autoTuneMargin *
+        Config::Driver::autoTuneStartAcceleration};
+static constexpr MachineLimits ceilingLimits = {
+    Config::Driver::autoTuneMaxSpeedMm,
+    Config::Driver::autoTuneMaxAcceleration};
+
+/**
+ * Auto tune methods
+ *
+ * Runs trials of test strokes at rising limits, see LimitSearch. Every trial
+ * ends with a touch-off of the rear end like quick homing. Steps lost on the
+ * way show up as the end being somewhere else, and the step counter is put
+ * back onto the end before the next trial.
+ */
+OSSM::TouchOff OSSM::runAutoTuneTrial(const MachineLimits &trialLimits,
+                                      bool &isReliable) {
+    // Away from both ends, in case steps get lost
+    int32_t near = -round(0.1f * measuredStrokeSteps);
+    int32_t far = -round(0.9f * measuredStrokeSteps);
+
+    currentOffset = currentSensorOffset;
+    currentSum = 0;
+    currentCount = 0;
+    peakCurrent.store(0);
+    setADCSampleCallback(AdcChannel::current, onAutoTuneCurrentSample);
+
+    stepper->setSpeedInHz(trialLimits.maxSpeedMmPerSecond *
+                          Config::Driver::stepsPerMM);
+    stepper->setAcceleration(trialLimits.maxAcceleration *
+                             Config::Driver::stepsPerMM);
+    for (int i = 0;
+         i < Config::Driver::autoTuneStrokes && isInMode(StateId::autoTune);
+         i++) {
+        stepper->moveTo(far, true);
+        stepper->moveTo(near, true);
+    }
+    setADCSampleCallback(AdcChannel::current, nullptr);
+
+    if (!isInMode(StateId::autoTune)) {
+        return TouchOff::left;
+    }
+
+    // Lost steps can move the end either way, the search goes past the
+    // slow zone and the touch-off finds it from in front of the slow zone
+    float backOff = 10_mm;
+    float tolerance =
+        Config::Driver::autoTuneToleranceMm * Config::Driver::stepsPerMM;
+    int32_t limit = round(backOff + Config::Driver::homingSlowZoneMm *
+                                        Config::Driver::stepsPerMM);
+    int32_t stallPosition = 0;
+    stepper->setAcceleration(1000_mm);
+    TouchOff touchOff = touchOffRear(StateId::autoTune, limit,
+                                     xTaskGetTickCount(),
+                                     pdMS_TO_TICKS(10000), stallPosition);
+    if (touchOff != TouchOff::found) {
+        return touchOff;
+    }
+
+    float peak = peakCurrent.load();
+    bool isOnTarget = isTouchOffConfirmed(stallPosition, backOff, tolerance);
+    isReliable = isOnTarget && peak <= Config::Driver::autoTuneCurrentLimit;
+    ESP_LOGI("AutoTune",
+             "%.0f mm/s, %.0f mm/s^2: end %.1fmm off, peak current %.2f, %s",
+             trialLimits.maxSpeedMmPerSecond, trialLimits.maxAcceleration,
+             (stallPosition - backOff) / Config::Driver::stepsPerMM, peak,
+             isReliable ? "reliable" : "unreliable");
+
+    // Back onto the end, for the next trial
+    stepper->moveTo(stallPosition - backOff, true);
+    stepper->setCurrentPosition(0);
+    stepper->forceStopAndNewPosition(0);
+    return TouchOff::found;
+}
+
+void OSSM::startAutoTuneTask(void *pvParameters) {
+    OSSM *ossm = (OSSM *)pvParameters;
+
+    // The speed phase runs at the start acceleration, strokes give it no
+    // room to go any faster than this
+    float travelMm = 0.8f * ossm->measuredStrokeSteps / (1_mm);
+    MachineLimits start = {Config::Driver::autoTuneStartSpeedMm,
+                           Config::Driver::autoTuneStartAcceleration};
+    MachineLimits ceiling = ceilingLimits;
+    ceiling.maxSpeedMmPerSecond =
+        min(ceiling.maxSpeedMmPerSecond,
+            reachableSpeed(start.maxAcceleration, travelMm));
+
+    LimitSearch tune(start, ceiling, Config::Driver::autoTuneStepFactor,
+                     Config::Driver::autoTuneRefineSteps,
+                     Config::Driver::autoTuneMargin);
+
+    ossm->stepper->enableOutputs();
+    while (!tune.isDone()) {
+        MachineLimits trialLimits = tune.next();
+        ossm->drawAutoTune(tune.getTrials() + 1, trialLimits);
+
+        bool isReliable = false;
+        TouchOff touchOff = ossm->runAutoTuneTrial(trialLimits, isReliable);
+        if (touchOff == TouchOff::left) {
+            vTaskDelete(nullptr);
+            return;
+        }
+
+        if (touchOff != TouchOff::found) {
+            // Where the rail is isn't known anymore, it needs a full homing
+            ESP_LOGE("AutoTune", "Rear end not found after a trial");
+            ossm->stepper->forceStop();
+            ossm->isRailKnown = false;
+            ossm->errorMessage = UserConfig::language.AutoTuneLost;
+            ossm->postEvent(EventId::error, -1, portMAX_DELAY);
+            vTaskDelete(nullptr);
+            return;
+        }
+
+        tune.report(isReliable);
+    }
+
+    ossm->isAutoTuneFound = tune.hasResult();
+    if (ossm->isAutoTuneFound) {
+        ossm->limits = tune.result();
+        ossm->saveLimits();
+        ESP_LOGI("AutoTune", "Limits after %u trials: %.0f mm/s, %.0f mm/s^2",
+                 tune.getTrials(), ossm->limits.maxSpeedMmPerSecond,
+                 ossm->limits.maxAcceleration);
+    } else {
+        ESP_LOGW("AutoTune", "Start limits unreliable, limits kept");
+    }
+
+    ossm->postEvent(EventId::done, -1, portMAX_DELAY);
+    vTaskDelete(nullptr);
+}
+
+void OSSM::startAutoTune() {
+    int stackSize = 10 * configMINIMAL_STACK_SIZE;
+    xTaskCreatePinnedToCore(startAutoTuneTask, "startAutoTuneTask",
+                            stackSize, this, Tasks::operationPriority,
+                            &Tasks::runAutoTuneTaskH,
+                            Tasks::operationTaskCore);
+}
+
+void OSSM::loadLimits() {
+    Preferences preferences;
+    if (!preferences.begin("autotune", true)) {
+        return;
+    }
+    MachineLimits stored = {preferences.getFloat("speed", 0),
+                            preferences.getFloat("accel", 0)};
+    preferences.end();
+
+    if (stored.isValid(floorLimits, ceilingLimits)) {
+        limits = stored;
+        ESP_LOGI("AutoTune", "Stored limits: %.0f mm/s, %.0f mm/s^2",
+                 limits.maxSpeedMmPerSecond, limits.maxAcceleration);
+    }
+}
+
+void OSSM::saveLimits() {
+    Preferences preferences;
+    preferences.begin("autotune", false);
+    preferences.putFloat("speed", limits.maxSpeedMmPerSecond);
+    preferences.putFloat("accel", limits.maxAcceleration);
+    preferences.end();
+}
+
+void OSSM::drawAutoTune(int trial, MachineLimits trialLimits) {
+    drawScene(DisplayLayer::page, [this, trial, trialLimits]() {
+        clearPage(true, true);
+        drawStr::title(UserConfig::language.AutoTune);
+        drawStr::multiLine(0, 24, F("Keep clear of the machine. Long press "
+                                    "to stop."));
+
+        if (trial > 0) {
+            char line[32];
+            snprintf(line, sizeof(line), "#%d %.0fmm/s %.0fmm/s2", trial,
+                     trialLimits.maxSpeedMmPerSecond,
+                     trialLimits.maxAcceleration);
+            display.drawUTF8(0, 62, line);
+        }
+    });
+}
+
+void OSSM::drawAutoTuneResult() {
+    MachineLimits shown = limits;
+    bool isFound = isAutoTuneFound;
+    drawScene(DisplayLayer::page, [this, shown, isFound]() {
+        clearPage(true, true);
+        drawStr::title(UserConfig::language.AutoTune);
+
+        if (isFound) {
+            char line[32];
+            snprintf(line, sizeof(line), "Speed: %.0f mm/s",
+                     shown.maxSpeedMmPerSecond);
+            display.drawUTF8(0, 26, line);
+            snprintf(line, sizeof(line), "Accel: %.0f mm/s2",
+                     shown.maxAcceleration);
+            display.drawUTF8(0, 38, line);
+        } else {
+            drawStr::multiLine(0, 24, F("No reliable limits, the old ones "
+                                        "are kept."));
+        }
+        display.drawUTF8(0, 62, UserConfig::language.Skip);
+    });
+}
@@ -0,0 +1,35 @@
+#include "OSSM.h"
+
+#include "services/adc.h"
+#include "utils/AccelerationGovernor.h"
+
+// The ADC task delivers about one current sample per millisecond
+static constexpr size_t governorWindow = 32;
+
+// Fed with current samples from the ADC task while a motion task runs.
+static AccelerationGovernor<governorWindow> governor(
+    Config::Driver::governorDerateCurrent,
+    Config::Driver::governorRestoreCurrent, Config::Driver::governorMinScale,
+    Config::Driver::governorRestoreMs / governorWindow);
+
+static float governorOffset = 0;
+
+static void onGovernorCurrentSample(float percent) {
+    if (governor.update(percent - governorOffset)) {
+        // Wake the motion task to apply the new limits
+        xSemaphoreGive(OSSM::settingChanged);
+    }
+}
+
+void OSSM::startGovernor() {
+    governorOffset = currentSensorOffset;
+    governor.reset();
+    setADCSampleCallback(AdcChannel::current, onGovernorCurrentSample);
+}
+
+void OSSM::stopGovernor() {
+    setADCSampleCallback(AdcChannel::current, nullptr);
+    governor.reset();
+}
+
+float OSSM::getGovernorScale() { return governor.getScale(); }
@@ -5,7 +5,7 @@
 #include "qrcode.h"
 
 void OSSM::drawHelp() {
-    if (xSemaphoreTake(displayMutex, 100) == pdTRUE) {
+    drawScene(DisplayLayer::page, [this]() {
         clearPage(true, true);
 
         static QRCode qrcode;
@@ -44,7 +44,5 @@ void OSSM::drawHelp() {
         display.drawUTF8(0, 26, UserConfig::language.GetHelpLine1);
         display.drawUTF8(0, 38, UserConfig::language.GetHelpLine2);
         display.drawUTF8(0, 62, UserConfig::language.Skip);
-        display.sendBuffer();
-        xSemaphoreGive(displayMutex);
-    }
+    });
 }
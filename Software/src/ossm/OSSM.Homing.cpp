@@ -1,13 +1,37 @@
 #include "OSSM.h"
 
+#include <Preferences.h>
+
 #include "Events.h"
 #include "constants/UserConfig.h"
-#include "utils/analog.h"
+#include "services/adc.h"
 #include "services/led.h"
+#include "utils/StallDetector.h"
 
 namespace sml = boost::sml;
 using namespace sml;
 
+// Fed with current samples from the ADC task while homing is running.
+static StallDetector<8> stallDetector(Config::Driver::sensorlessCurrentLimit,
+                                      Config::Driver::sensorlessCurrentStep,
+                                      150);
+
+// The task waiting for a stall
+static TaskHandle_t stallWaiter = nullptr;
+
+static void onHomingCurrentSample(float percent) {
+    if (stallDetector.update(percent - ossm->currentSensorOffset)) {
+        xTaskNotifyGive(stallWaiter);
+    }
+}
+
+// Feeds the stall detector, a stall wakes the calling task
+static void watchForStall() {
+    stallWaiter = xTaskGetCurrentTaskHandle();
+    stallDetector.reset();
+    setADCSampleCallback(AdcChannel::current, onHomingCurrentSample);
+}
+
 /** OSSM Homing methods
  *
  * This is a collection of methods that are associated with the homing state on
@@ -25,14 +49,11 @@ void OSSM::clearHoming() {
     // Set acceleration and deceleration in steps/s^2
     stepper->setAcceleration(1000_mm);
     // Set speed in steps/s
-    stepper->setSpeedInHz(25_mm);
+    stepper->setSpeedInHz(Config::Driver::homingFastSpeedMm *
+                          Config::Driver::stepsPerMM);
 
     // Clear the stored values.
     this->measuredStrokeSteps = 0;
-
-    // Recalibrate the current sensor offset.
-    this->currentSensorOffset = (getAnalogAveragePercent(
-        SampleOnPin{Pins::Driver::currentSensorPin, 1000}));
 };
 
 void OSSM::startHomingTask(void *pvParameters) {
@@ -44,26 +65,45 @@ void OSSM::startHomingTask(void *pvParameters) {
 #ifdef AJ_DEVELOPMENT_HARDWARE
     ossm->stepper->setCurrentPosition(0);
     ossm->stepper->forceStopAndNewPosition(0);
-    ossm->sm->process_event(Done{});
+    ossm->postEvent(EventId::done, -1, portMAX_DELAY);
     vTaskDelete(nullptr);
     return;
 #endif
 
+    // Right after boot the driver may still be resetting
+    waitForStepperReady();
+
+    // Recalibrate the current sensor offset.
+    ossm->currentSensorOffset = getADCPercent(AdcChannel::current);
+
     // Stroke Engine and Simple Penetration treat this differently.
     ossm->stepper->enableOutputs();
     ossm->stepper->setDirectionPin(Pins::Driver::motorDirectionPin, false);
-    int16_t sign = ossm->sm->is("homing.backward"_s) ? 1 : -1;
+    int16_t sign = isInState(StateId::homingBackward) ? 1 : -1;
 
     int32_t targetPositionInSteps =
         round(sign * Config::Driver::maxStrokeSteps);
 
     ESP_LOGD("Homing", "Target position in steps: %d", targetPositionInSteps);
+
+    // On the way back the end of the stroke is roughly known from the last
+    // homing, so only the final part is run at the slow speed.
+    bool isSlowZoneKnown = sign > 0 && ossm->lastMeasuredStrokeSteps > 0;
+    float slowZoneStart = ossm->lastMeasuredStrokeSteps + 10_mm -
+                          Config::Driver::homingSlowZoneMm *
+                              Config::Driver::stepsPerMM;
+    bool isSlow = false;
+
+    ossm->stepper->setSpeedInHz(Config::Driver::homingFastSpeedMm *
+                                Config::Driver::stepsPerMM);
     ossm->stepper->moveTo(targetPositionInSteps, false);
 
+    watchForStall();
+    bool isFinished = false;
+
     auto isInCorrectState = [](OSSM *ossm) {
         // Add any states that you want to support here.
-        return ossm->sm->is("homing"_s) || ossm->sm->is("homing.forward"_s) ||
-               ossm->sm->is("homing.backward"_s);
+        return isInMode(StateId::homing);
     };
 
     // run loop for 15second or until loop exits
@@ -82,26 +122,32 @@ void OSSM::startHomingTask(void *pvParameters) {
             
             // Clear homing active flag for LED indication
             setHomingActive(false);
-            
-            ossm->sm->process_event(Error{});
+
+            setADCSampleCallback(AdcChannel::current, nullptr);
+            isFinished = true;
+            ossm->postEvent(EventId::error, -1, portMAX_DELAY);
             break;
         }
 
-        // measure the current analog value.
-        float current = getAnalogAveragePercent(
-                            SampleOnPin{Pins::Driver::currentSensorPin, 200}) -
-                        ossm->currentSensorOffset;
-
-        ESP_LOGV("Homing", "Current: %f", current);
-        bool isCurrentOverLimit =
-            current > Config::Driver::sensorlessCurrentLimit;
+        if (isSlowZoneKnown && !isSlow &&
+            ossm->stepper->getCurrentPosition() > slowZoneStart) {
+            ossm->stepper->setSpeedInHz(Config::Driver::homingSlowSpeedMm *
+                                        Config::Driver::stepsPerMM);
+            ossm->stepper->applySpeedAcceleration();
+            isSlow = true;
+        }
 
-        if (!isCurrentOverLimit) {
-            vTaskDelay(10); // Increased from 1ms to 10ms to reduce CPU load
+        // The stall detector runs on every current sample and wakes us up.
+        if (!stallDetector.hasStalled()) {
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(10));
             continue;
         }
 
-        ESP_LOGD("Homing", "Current over limit: %f", current);
+        setADCSampleCallback(AdcChannel::current, nullptr);
+        isFinished = true;
+
+        ESP_LOGD("Homing", "Current over limit: %f",
+                 stallDetector.getStallCurrent());
         ossm->stepper->stopMove();
 
         // step away from the hard stop, with your hands in the air!
@@ -113,26 +159,217 @@ void OSSM::startHomingTask(void *pvParameters) {
             min(float(abs(ossm->stepper->getCurrentPosition())),
                 Config::Driver::maxStrokeSteps);
 
+        // Remember the stroke, so the next homing knows where to slow down
+        // and a quick homing can confirm it
+        if (sign > 0) {
+            ossm->lastMeasuredStrokeSteps = ossm->measuredStrokeSteps;
+            ossm->calibration = {ossm->measuredStrokeSteps,
+                                 ossm->currentSensorOffset};
+            ossm->isRailKnown = true;
+            ossm->saveCalibration();
+        }
+
         ossm->stepper->setCurrentPosition(0);
         ossm->stepper->forceStopAndNewPosition(0);
 
         // Clear homing active flag for LED indication
         setHomingActive(false);
 
-        ossm->sm->process_event(Done{});
+        ossm->postEvent(EventId::done, -1, portMAX_DELAY);
         break;
     };
 
+    // Left the homing states without reaching the end. Otherwise the callback
+    // is already cleared, before the next homing task could register its own.
+    if (!isFinished) {
+        setADCSampleCallback(AdcChannel::current, nullptr);
+    }
+
     vTaskDelete(nullptr);
 }
 
 void OSSM::startHoming() {
     int stackSize = 10 * configMINIMAL_STACK_SIZE;
     xTaskCreatePinnedToCore(startHomingTask, "startHomingTask", stackSize, this,
-                            configMAX_PRIORITIES - 1, &Tasks::runHomingTaskH,
+                            Tasks::operationPriority, &Tasks::runHomingTaskH,
                             Tasks::operationTaskCore);
 }
 
+/**
+ * Quick homing: the step counter still knows where the rail is, it may just
+ * have been pushed a little while the motor was off. Drive to just short of
+ * the rear end and touch it off slowly. Finding it where it should be
+ * confirms the stored stroke, anything else sends an Error and full homing
+ * takes over.
+ */
+void OSSM::startQuickHomingTask(void *pvParameters) {
+    OSSM *ossm = (OSSM *)pvParameters;
+    TickType_t startTick = xTaskGetTickCount();
+
+    waitForStepperReady();
+    ossm->currentSensorOffset = getADCPercent(AdcChannel::current);
+
+    float backOff = 10_mm;
+    float tolerance =
+        Config::Driver::quickHomingToleranceMm * Config::Driver::stepsPerMM;
+
+    auto fallBack = [ossm](const char *reason) {
+        ESP_LOGI("Homing", "Quick homing failed, %s", reason);
+        setADCSampleCallback(AdcChannel::current, nullptr);
+        ossm->stepper->forceStop();
+        ossm->isRailKnown = false;
+        ossm->postEvent(EventId::error, -1, portMAX_DELAY);
+        vTaskDelete(nullptr);
+    };
+
+    if (!isSensorOffsetConfirmed(ossm->calibration,
+                                 ossm->currentSensorOffset,
+                                 Config::Driver::quickHomingOffsetTolerance)) {
+        fallBack("current sensor offset moved");
+        return;
+    }
+
+    ossm->stepper->enableOutputs();
+    ossm->stepper->setDirectionPin(Pins::Driver::motorDirectionPin, false);
+
+    int32_t stallPosition = 0;
+    TouchOff touchOff = ossm->touchOffRear(
+        StateId::homing, round(backOff + 2 * tolerance), startTick,
+        pdMS_TO_TICKS(10000), stallPosition);
+    switch (touchOff) {
+        case TouchOff::left:
+            vTaskDelete(nullptr);
+            return;
+        case TouchOff::timeout:
+            fallBack("took too long");
+            return;
+        case TouchOff::notFound:
+            fallBack("no end found");
+            return;
+        default:
+            break;
+    }
+
+    // Something in the way before the slow zone is not the end of the rail
+    if (touchOff == TouchOff::early ||
+        !isTouchOffConfirmed(stallPosition, backOff, tolerance)) {
+        ESP_LOGD("Homing", "Stalled at %d, expected %d", stallPosition,
+                 (int32_t)backOff);
+        fallBack("end not where it was");
+        return;
+    }
+
+    // step away from the hard stop, with your hands in the air!
+    ossm->stepper->moveTo(stallPosition - backOff, true);
+    ossm->measuredStrokeSteps = ossm->calibration.strokeSteps;
+    ossm->stepper->setCurrentPosition(0);
+    ossm->stepper->forceStopAndNewPosition(0);
+
+    ESP_LOGI("Homing", "Quick homing done in %lums",
+             (unsigned long)pdTICKS_TO_MS(xTaskGetTickCount() - startTick));
+
+    setHomingActive(false);
+    ossm->postEvent(EventId::done, -1, portMAX_DELAY);
+    vTaskDelete(nullptr);
+}
+
+OSSM::TouchOff OSSM::touchOffRear(StateId mode, int32_t limit,
+                                  TickType_t startTick, TickType_t timeout,
+                                  int32_t &stallPosition) {
+    watchForStall();
+
+    // Fast to the start of the slow zone, then slowly past the expected end
+    int32_t approach =
+        -round(Config::Driver::homingSlowZoneMm * Config::Driver::stepsPerMM);
+    stepper->setSpeedInHz(Config::Driver::quickHomingSpeedMm *
+                          Config::Driver::stepsPerMM);
+    stepper->moveTo(approach, false);
+    bool isTouchingOff = false;
+    TouchOff result = TouchOff::found;
+
+    while (!stallDetector.hasStalled()) {
+        if (!isInMode(mode)) {
+            result = TouchOff::left;
+            break;
+        }
+        if (xTaskGetTickCount() - startTick > timeout) {
+            result = TouchOff::timeout;
+            break;
+        }
+
+        if (!stepper->isRunning()) {
+            if (isTouchingOff) {
+                result = TouchOff::notFound;
+                break;
+            }
+            isTouchingOff = true;
+            stepper->setSpeedInHz(Config::Driver::homingSlowSpeedMm *
+                                  Config::Driver::stepsPerMM);
+            stepper->moveTo(limit, false);
+        }
+
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(10));
+    }
+
+    setADCSampleCallback(AdcChannel::current, nullptr);
+    if (result != TouchOff::found) {
+        return result;
+    }
+
+    stepper->stopMove();
+    stallPosition = stepper->getCurrentPosition();
+    return isTouchingOff ? TouchOff::found : TouchOff::early;
+}
+
+void OSSM::startQuickHoming() {
+    int stackSize = 10 * configMINIMAL_STACK_SIZE;
+    xTaskCreatePinnedToCore(startQuickHomingTask, "startQuickHomingTask",
+                            stackSize, this, Tasks::operationPriority,
+                            &Tasks::runHomingTaskH, Tasks::operationTaskCore);
+}
+
+bool OSSM::canQuickHome() {
+#ifdef AJ_DEVELOPMENT_HARDWARE
+    return false;
+#else
+    return isRailKnown &&
+           calibration.isValid(Config::Driver::minStrokeLengthMm,
+                               Config::Driver::maxStrokeSteps);
+#endif
+}
+
+// The stroke and the idle current of the last full homing
+void OSSM::loadCalibration() {
+    Preferences preferences;
+    if (!preferences.begin("homing", true)) {
+        return;
+    }
+    RailCalibration stored = {preferences.getFloat("stroke", 0),
+                              preferences.getFloat("offset", 0)};
+    preferences.end();
+
+    if (stored.isValid(Config::Driver::minStrokeLengthMm,
+                       Config::Driver::maxStrokeSteps)) {
+        calibration = stored;
+        lastMeasuredStrokeSteps = stored.strokeSteps;
+        ESP_LOGI("Homing", "Stored stroke: %.1fmm",
+                 stored.strokeSteps / Config::Driver::stepsPerMM);
+    }
+}
+
+void OSSM::saveCalibration() {
+    Preferences preferences;
+    preferences.begin("homing", false);
+    // Flash wear: only written when the measurement actually changed
+    if (preferences.getFloat("stroke", 0) != calibration.strokeSteps) {
+        preferences.putFloat("stroke", calibration.strokeSteps);
+    }
+    if (preferences.getFloat("offset", 0) != calibration.sensorOffset) {
+        preferences.putFloat("offset", calibration.sensorOffset);
+    }
+    preferences.end();
+}
+
 auto OSSM::isStrokeTooShort() -> bool {
     if (measuredStrokeSteps > Config::Driver::minStrokeLengthMm) {
         return false;
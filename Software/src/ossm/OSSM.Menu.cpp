@@ -1,11 +1,20 @@
 #include "OSSM.h"
 
+#include <memory>
+
 #include "constants/Config.h"
 #include "constants/Images.h"
-#include "extensions/u8g2Extensions.h"
+#include "extensions/Widgets.h"
 #include "services/display.h"
+#include "services/input.h"
 #include "utils/analog.h"
 
+struct MenuPage {
+    ui::List list{menuStrings, Menu::NUM_OPTIONS};
+    ui::ScrollBar scroll;
+    ui::Screen screen{{&list, &scroll}};
+};
+
 void OSSM::drawMenuTask(void *pvParameters) {
     bool isFirstDraw = true;
     OSSM *ossm = (OSSM *)pvParameters;
@@ -29,9 +38,12 @@ void OSSM::drawMenuTask(void *pvParameters) {
 
     auto isInCorrectState = [](OSSM *ossm) {
         // Add any states that you want to support here.
-        return ossm->sm->is("menu"_s) || ossm->sm->is("menu.idle"_s);
+        return isInMode(StateId::menu);
     };
 
+    // Only the render task touches the widgets
+    auto page = std::make_shared<MenuPage>();
+
     while (isInCorrectState(ossm)) {
         wl_status_t newWifiState = WiFiClass::status();
         
@@ -39,7 +51,7 @@ void OSSM::drawMenuTask(void *pvParameters) {
         bool shouldRedraw = isFirstDraw || ossm->encoder.encoderChanged() || (wifiState != newWifiState);
         
         if (!shouldRedraw) {
-            vTaskDelay(50);
+            waitForInput(pdMS_TO_TICKS(Config::Advanced::inputWaitTimeoutMs));
             continue;
         }
 
@@ -48,90 +60,43 @@ void OSSM::drawMenuTask(void *pvParameters) {
         isFirstDraw = false;
         currentEncoderValue = ossm->encoder.readEncoder();
 
-        if (xSemaphoreTake(displayMutex, 100) == pdTRUE) {
-            clearPage(true, false); // Clear page content but preserve header icons
-
-            // Drawing Variables.
-            int leftPadding = 6;  // Padding on the left side of the screen
-            int fontSize = 8;
-            int itemHeight = 20;   // Height of each item
-            int visibleItems = 3;  // Number of items visible on the screen
-
-            auto menuOption = ossm->menuOption;
-            if (abs(currentEncoderValue % maxClicks -
-                    lastEncoderValue % maxClicks) >= clicksPerRow) {
-                lastEncoderValue = currentEncoderValue % maxClicks;
-                menuOption = (Menu)floor(lastEncoderValue / clicksPerRow);
-
-                ossm->menuOption = menuOption;
-            }
-
-            ESP_LOGD(
-                "Menu",
-                "currentEncoderValue: %d, lastEncoderValue: %d, menuOption: %d",
-                currentEncoderValue, lastEncoderValue, menuOption);
-
-            drawShape::scroll(100 * ossm->encoder.readEncoder() /
-                              (clicksPerRow * Menu::NUM_OPTIONS - 1));
-            const char *menuName = menuStrings[menuOption];
-            ESP_LOGD("Menu", "Hovering over state: %s", menuName);
-
-            // Loop around to make an infinite menu.
-            int lastIdx =
-                menuOption - 1 < 0 ? Menu::NUM_OPTIONS - 1 : menuOption - 1;
-            int nextIdx =
-                menuOption + 1 > Menu::NUM_OPTIONS - 1 ? 0 : menuOption + 1;
-
-            ossm->display.setFont(Config::Font::base);
-
-            // Draw the previous item
-            if (lastIdx >= 0) {
-                ossm->display.drawUTF8(leftPadding, itemHeight * (1),
-                                       menuStrings[lastIdx]);
-            }
-
-            // Draw the next item
-            if (nextIdx < Menu::NUM_OPTIONS) {
-                ossm->display.drawUTF8(leftPadding, itemHeight * (3),
-                                       menuStrings[nextIdx]);
-            }
-
-            // Draw the current item
-            ossm->display.setFont(Config::Font::bold);
-            ossm->display.drawUTF8(leftPadding, itemHeight * (2), menuName);
-
-            // Draw a rounded rectangle around the center item
-            ossm->display.drawRFrame(
-                0,
-                itemHeight * (visibleItems / 2) - (fontSize - itemHeight) / 2,
-                120, itemHeight, 2);
-
-            // Draw Shadow.
-            ossm->display.drawLine(2, 2 + fontSize / 2 + 2 * itemHeight, 119,
-                                   2 + fontSize / 2 + 2 * itemHeight);
-            ossm->display.drawLine(120, 4 + fontSize / 2 + itemHeight, 120,
-                                   1 + fontSize / 2 + 2 * itemHeight);
-
-            refreshPage(true, true); // Include both footer and header in refresh
-            xSemaphoreGive(displayMutex);
+        auto menuOption = ossm->menuOption;
+        if (abs(currentEncoderValue % maxClicks -
+                lastEncoderValue % maxClicks) >= clicksPerRow) {
+            lastEncoderValue = currentEncoderValue % maxClicks;
+            menuOption = (Menu)floor(lastEncoderValue / clicksPerRow);
+
+            ossm->menuOption = menuOption;
         }
 
+        ESP_LOGD(
+            "Menu",
+            "currentEncoderValue: %d, lastEncoderValue: %d, menuOption: %d",
+            currentEncoderValue, lastEncoderValue, menuOption);
+
+        int scrollPercent = 100 * ossm->encoder.readEncoder() /
+                            (clicksPerRow * Menu::NUM_OPTIONS - 1);
+
+        drawScene(DisplayLayer::page, [page, menuOption, scrollPercent]() {
+            ESP_LOGD("Menu", "Hovering over state: %s",
+                     menuStrings[menuOption]);
+            page->list.select(menuOption);
+            page->scroll.set(scrollPercent);
+            page->screen.render();
+        });
+
         vTaskDelay(1);
     };
 
     // Clear header icons when exiting menu
-    if (xSemaphoreTake(displayMutex, 100) == pdTRUE) {
-        clearIcons(); // Clear the header icons
-        ossm->display.setMaxClipWindow(); // Reset clipping 
-        ossm->display.sendBuffer(); // Send the cleared buffer to display
-        xSemaphoreGive(displayMutex);
-    }
+    drawScene(DisplayLayer::icons, []() { clearIcons(); });
 
     vTaskDelete(nullptr);
 }
 
 void OSSM::drawMenu() {
     int stackSize = 5 * configMINIMAL_STACK_SIZE;
-    xTaskCreate(drawMenuTask, "drawMenuTask", stackSize, this, 1,
-                &Tasks::drawMenuTaskH);
+    xTaskCreatePinnedToCore(drawMenuTask, "drawMenuTask", stackSize, this,
+                            Tasks::renderPriority, &Tasks::drawMenuTaskH,
+                            Tasks::renderCore);
 }
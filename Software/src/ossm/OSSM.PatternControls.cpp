@@ -1,25 +1,34 @@
 #include "OSSM.h"
 
-#include "extensions/u8g2Extensions.h"
+#include <memory>
+
+#include "extensions/Widgets.h"
+#include "services/input.h"
 #include "utils/analog.h"
 #include "utils/format.h"
 
 size_t numberOfDescriptions =
     sizeof(UserConfig::language.StrokeEngineDescriptions) /
     sizeof(UserConfig::language.StrokeEngineDescriptions[0]);
-size_t numberOfPatterns = 9;
+size_t numberOfPatterns = patternTableSize;
+
+struct PatternControlsPage {
+    ui::Label name{Config::Font::bold, 0, 8, ui::Align::center};
+    ui::Paragraph description{0, 20};
+    ui::ScrollBar scroll;
+    ui::Screen screen{{&name, &description, &scroll}, true};
+};
 
 void OSSM::drawPatternControlsTask(void *pvParameters) {
     // parse ossm from the parameters
     OSSM *ossm = (OSSM *)pvParameters;
-    SettingPercents savedSettings = OSSM::setting;
 
     auto isInCorrectState = [](OSSM *ossm) {
         // Add any states that you want to support here.
-        return ossm->sm->is("strokeEngine.pattern"_s);
+        return isInState(StateId::strokeEnginePattern);
     };
 
-    int nextPattern = (int)OSSM::setting.pattern;
+    int nextPattern = (int)OSSM::setting.load().pattern;
     bool shouldUpdateDisplay = true;
     const char *patternName = "nextPattern";
     const char *patternDescription =
@@ -30,12 +39,16 @@ void OSSM::drawPatternControlsTask(void *pvParameters) {
     ossm->encoder.setBoundaries(0, numberOfPatterns * 3 - 1, true);
     ossm->encoder.setEncoderValue(nextPattern * 3);
 
+    // Only the render task touches the widgets
+    auto page = std::make_shared<PatternControlsPage>();
+
     while (isInCorrectState(ossm)) {
         nextPattern = ossm->encoder.readEncoder() / 3;
-        shouldUpdateDisplay =
-            shouldUpdateDisplay || (int)OSSM::setting.pattern != nextPattern;
+        bool isPatternChanged =
+            (int)OSSM::setting.load().pattern != nextPattern;
+        shouldUpdateDisplay = shouldUpdateDisplay || isPatternChanged;
         if (!shouldUpdateDisplay) {
-            vTaskDelay(100);
+            waitForInput(pdMS_TO_TICKS(Config::Advanced::inputWaitTimeoutMs));
             continue;
         }
 
@@ -48,21 +61,21 @@ void OSSM::drawPatternControlsTask(void *pvParameters) {
             patternDescription = "No description available";
         }
 
-        OSSM::setting.pattern = (StrokePatterns)nextPattern;
-
-        if (xSemaphoreTake(displayMutex, 100) == pdTRUE) {
-            clearPage(true, true);
-
-            // Draw the title
-            drawStr::title(patternName);
-            drawStr::multiLine(0, 20, patternDescription);
-            drawShape::scroll(100 * nextPattern / numberOfPatterns);
-
-            refreshPage(true, true);
-            xSemaphoreGive(displayMutex);
+        if (isPatternChanged) {
+            OSSM::updateSetting([=](SettingPercents &s) {
+                s.pattern = (StrokePatterns)nextPattern;
+            });
         }
 
-        vTaskDelay(200);
+        drawScene(DisplayLayer::page, [=]() {
+            page->name.set(patternName);
+            page->description.set(patternDescription);
+            page->scroll.set(100 * nextPattern / numberOfPatterns);
+            page->screen.render();
+        });
+        shouldUpdateDisplay = false;
+
+        waitForInput(pdMS_TO_TICKS(Config::Advanced::inputWaitTimeoutMs));
     }
 
     vTaskDelete(nullptr);
@@ -70,6 +83,8 @@ void OSSM::drawPatternControlsTask(void *pvParameters) {
 
 void OSSM::drawPatternControls() {
     int stackSize = 3 * configMINIMAL_STACK_SIZE;
-    xTaskCreate(drawPatternControlsTask, "drawPatternControlsTask", stackSize,
-                this, 1, &Tasks::drawPatternControlsTaskH);
+    xTaskCreatePinnedToCore(drawPatternControlsTask, "drawPatternControlsTask",
+                            stackSize, this, Tasks::renderPriority,
+                            &Tasks::drawPatternControlsTaskH,
+                            Tasks::renderCore);
 }
@@ -1,26 +1,73 @@
 #include "OSSM.h"
 
+#include <memory>
+
 #include "constants/UserConfig.h"
-#include "extensions/u8g2Extensions.h"
+#include "extensions/Widgets.h"
+#include "services/adc.h"
+#include "services/input.h"
 #include "services/tasks.h"
-#include "utils/analog.h"
 #include "utils/format.h"
 
+/**
+ * Widgets of the play controls, laid out for the selected control. The
+ * selected one gets the large bar, the others a small one next to it. Simple
+ * penetration only has speed and stroke.
+ */
+struct PlayControlsPage {
+    PlayControlsPage(PlayControls control, bool hasPatternControls,
+                     bool hasDistance)
+        : speed(UserConfig::language.Speed),
+          stroke(control == PlayControls::STROKE || !hasPatternControls
+                     ? ui::ValueBar(UserConfig::language.Stroke, 118, 0,
+                                    RIGHT_ALIGNED)
+                     : ui::ValueBar(108)),
+          depth(control == PlayControls::DEPTH
+                    ? ui::ValueBar(F("Depth"), 123, 0, RIGHT_ALIGNED, 5)
+                    : ui::ValueBar(control == PlayControls::STROKE ? 120
+                                                                   : 113)),
+          sensation(control == PlayControls::SENSATION
+                        ? ui::ValueBar(F("Sensation"), 128, 0, RIGHT_ALIGNED,
+                                       10)
+                        : ui::ValueBar(125)),
+          strokeCount(Config::Font::small, 14, 64),
+          distance(Config::Font::small, 104, 56, ui::Align::right),
+          time(Config::Font::small, 104, 64, ui::Align::right) {
+        screen.add(&speed).add(&stroke).add(&strokeCount).add(&time);
+        if (hasPatternControls) {
+            screen.add(&depth).add(&sensation);
+        }
+        if (hasDistance) {
+            screen.add(&distance);
+        }
+    }
+
+    ui::ValueBar speed;
+    ui::ValueBar stroke;
+    ui::ValueBar depth;
+    ui::ValueBar sensation;
+    ui::Label strokeCount;
+    ui::Label distance;
+    ui::Label time;
+    ui::Screen screen;
+};
+
 void OSSM::drawPlayControlsTask(void *pvParameters) {
     // parse ossm from the parameters
     OSSM *ossm = (OSSM *)pvParameters;
     ossm->encoder.setAcceleration(10);
     ossm->encoder.setBoundaries(0, 100, false);
+    SettingPercents current = OSSM::setting.load();
     // Clean up!
     switch (ossm->playControl) {
         case PlayControls::STROKE:
-            ossm->encoder.setEncoderValue(OSSM::setting.stroke);
+            ossm->encoder.setEncoderValue(current.stroke);
             break;
         case PlayControls::SENSATION:
-            ossm->encoder.setEncoderValue(OSSM::setting.sensation);
+            ossm->encoder.setEncoderValue(current.sensation);
             break;
         case PlayControls::DEPTH:
-            ossm->encoder.setEncoderValue(OSSM::setting.depth);
+            ossm->encoder.setEncoderValue(current.depth);
             break;
     }
 
@@ -40,20 +87,17 @@ void OSSM::drawPlayControlsTask(void *pvParameters) {
      */
     auto isInCorrectState = [](OSSM *ossm) {
         // Add any states that you want to support here.
-        return ossm->sm->is("simplePenetration"_s) ||
-               ossm->sm->is("simplePenetration.idle"_s) ||
-               ossm->sm->is("strokeEngine"_s) ||
-               ossm->sm->is("strokeEngine.idle"_s) ||
-               ossm->sm->is("streaming"_s);
+        return isInState(StateId::simplePenetration,
+                         StateId::simplePenetrationIdle, StateId::strokeEngine,
+                         StateId::strokeEngineIdle, StateId::streaming,
+                         StateId::streamingIdle);
     };
 
-    // Line heights
-    short lh3 = 56;
-    short lh4 = 64;
     static float encoder = 0;
 
     bool isStrokeEngine =
-        ossm->sm->is("strokeEngine"_s) || ossm->sm->is("strokeEngine.idle"_s);
+        isInState(StateId::strokeEngine, StateId::strokeEngineIdle);
+    bool isStreaming = isInState(StateId::streaming, StateId::streamingIdle);
 
     bool shouldUpdateDisplay = false;
 
@@ -62,114 +106,136 @@ void OSSM::drawPlayControlsTask(void *pvParameters) {
 
     String headerText = "";
 
+    // Rebuilt when the selected control changes, only the render task
+    // touches the widgets
+    std::shared_ptr<PlayControlsPage> page;
+    PlayControls pageControl = ossm->playControl;
+
+    // Session strings are only formatted again when their value changed
+    long formattedStrokeCount = -1;
+    int64_t formattedSteps = -1;
+    long formattedSeconds = -1;
+    String strokeCount;
+    String distance;
+    String time;
+
     while (isInCorrectState(ossm)) {
         // Always assume the display should not update.
         shouldUpdateDisplay = false;
 
+        current = OSSM::setting.load();
+
 #ifdef AJ_DEVELOPMENT_HARDWARE
         next.speedKnob = 0;
 #else
-        next.speedKnob =
-            getAnalogAveragePercent(SampleOnPin{Pins::Remote::speedPotPin, 50});
+        next.speedKnob = getADCPercent(AdcChannel::speedPot);
 #endif
-        OSSM::setting.speedKnob = next.speedKnob;
+        float knob = next.speedKnob;
         encoder = ossm->encoder.readEncoder();
 
-        if (USE_SPEED_KNOB_AS_LIMIT || !OSSM::setting.speedBLE.has_value()) {
+        if (USE_SPEED_KNOB_AS_LIMIT || !current.speedBLE.has_value()) {
             next.speed =
-                next.speedKnob * (OSSM::setting.speedBLE.value_or(100)) / 100;
+                next.speedKnob * (current.speedBLE.value_or(100)) / 100;
         } else {
-            next.speedKnob = OSSM::setting.speedBLE.value_or(100);
-            next.speed = OSSM::setting.speedBLE.value_or(100);
+            next.speedKnob = current.speedBLE.value_or(100);
+            next.speed = current.speedBLE.value_or(100);
         }
 
-        if (next.speed != OSSM::setting.speed) {
+        if (next.speed != current.speed) {
             shouldUpdateDisplay = true;
-            OSSM::setting.speed = next.speed;
         }
 
+        // The encoder drives whichever control is selected
+        float SettingPercents::*control = &SettingPercents::depth;
         switch (ossm->playControl) {
             case PlayControls::STROKE:
-                next.stroke = encoder;
-                shouldUpdateDisplay = shouldUpdateDisplay ||
-                                      next.stroke - OSSM::setting.stroke >= 1;
-                OSSM::setting.stroke = next.stroke;
+                control = &SettingPercents::stroke;
                 break;
             case PlayControls::SENSATION:
-                next.sensation = encoder;
-                shouldUpdateDisplay =
-                    shouldUpdateDisplay ||
-                    next.sensation - OSSM::setting.sensation >= 1;
-                OSSM::setting.sensation = next.sensation;
+                control = &SettingPercents::sensation;
                 break;
             case PlayControls::DEPTH:
-                next.depth = encoder;
-                shouldUpdateDisplay = shouldUpdateDisplay ||
-                                      next.depth - OSSM::setting.depth >= 1;
-                OSSM::setting.depth = next.depth;
+                control = &SettingPercents::depth;
                 break;
         }
+        // Only a turn of the encoder moves the control. Values from BLE are
+        // finer than its steps and stay as they are while it agrees.
+        next.*control = encoder == lround(current.*control) ? current.*control
+                                                            : encoder;
+        shouldUpdateDisplay =
+            shouldUpdateDisplay || next.*control - current.*control >= 1;
+
+        // Only publish the fields this task owns, and only when they moved,
+        // so BLE writes in between are kept and readers aren't woken for
+        // nothing.
+        if (knob != current.speedKnob || next.speed != current.speed ||
+            next.*control != current.*control) {
+            OSSM::updateSetting([&](SettingPercents &s) {
+                s.speedKnob = knob;
+                s.speed = next.speed;
+                s.*control = next.*control;
+            });
+        }
 
         shouldUpdateDisplay =
             shouldUpdateDisplay || millis() - displayLastUpdated > 1000;
 
+        // The speed knob is analog and still needs a look now and then
         if (!shouldUpdateDisplay) {
-            vTaskDelay(100);
+            waitForInput(pdMS_TO_TICKS(100));
             continue;
         }
 
         displayLastUpdated = millis();
 
-        String strokeString = UserConfig::language.Stroke;
-        auto stringWidth = ossm->display.getUTF8Width(strokeString.c_str());
+        // Check and update the header text... don't worry if this is the
+        // same as last time, nothing happens.
+        if (isStrokeEngine) {
+            headerText =
+                UserConfig::language.StrokeEngineNames[(int)current.pattern];
+        } else if (isStreaming) {
+            headerText = UserConfig::language.Streaming;
+        } else {
+            headerText = UserConfig::language.SimplePenetration;
+        }
+
+        // Everything the page shows is copied, the render task draws it later.
+        SettingPercents shown = OSSM::setting.load();
+        float speedKnob = next.speedKnob;
+        long encoderValue = ossm->encoder.readEncoder();
+        PlayControls playControl = ossm->playControl;
+        // Counted in whole strokes and steps, converted for display only
+        if (ossm->session.getStrokes() != formattedStrokeCount) {
+            formattedStrokeCount = ossm->session.getStrokes();
+            strokeCount = "# " + String(formattedStrokeCount);
+        }
+        if (ossm->session.getSteps() != formattedSteps) {
+            formattedSteps = ossm->session.getSteps();
+            distance = formatDistance(formattedSteps /
+                                      Config::Driver::stepsPerMM / 1000.0);
+        }
+        long seconds = (displayLastUpdated - ossm->sessionStartTime) / 1000;
+        if (seconds != formattedSeconds) {
+            formattedSeconds = seconds;
+            time = formatTime(seconds * 1000);
+        }
 
-        if (xSemaphoreTake(displayMutex, 100) == pdTRUE) {
-            // Check and update the header text... don't worry if this is the
-            // same as last time, nothing happens.
-            if (isStrokeEngine) {
-                headerText = UserConfig::language
-                                 .StrokeEngineNames[(int)OSSM::setting.pattern];
-            } else {
-                headerText = UserConfig::language.SimplePenetration;
-            }
+        if (!page || playControl != pageControl) {
+            pageControl = playControl;
+            page = std::make_shared<PlayControlsPage>(
+                playControl, isStrokeEngine || isStreaming, !isStrokeEngine);
+        }
+
+        drawScene(DisplayLayer::page, [=]() mutable {
             setHeader(headerText);
 
-            // Now draw the page...
-            clearPage(true);
-            ossm->display.setFont(Config::Font::base);
-
-            drawShape::settingBar(UserConfig::language.Speed, next.speedKnob);
-
-            if (isStrokeEngine) {
-                switch (ossm->playControl) {
-                    case PlayControls::STROKE:
-                        drawShape::settingBarSmall(OSSM::setting.sensation,
-                                                   125);
-                        drawShape::settingBarSmall(OSSM::setting.depth, 120);
-                        drawShape::settingBar(strokeString,
-                                              OSSM::setting.stroke, 118, 0,
-                                              RIGHT_ALIGNED);
-                        break;
-                    case PlayControls::SENSATION:
-                        drawShape::settingBar(F("Sensation"),
-                                              OSSM::setting.sensation, 128, 0,
-                                              RIGHT_ALIGNED, 10);
-                        drawShape::settingBarSmall(OSSM::setting.depth, 113);
-                        drawShape::settingBarSmall(OSSM::setting.stroke, 108);
-
-                        break;
-                    case PlayControls::DEPTH:
-                        drawShape::settingBarSmall(OSSM::setting.sensation,
-                                                   125);
-                        drawShape::settingBar(F("Depth"), OSSM::setting.depth,
-                                              123, 0, RIGHT_ALIGNED, 5);
-                        drawShape::settingBarSmall(OSSM::setting.stroke, 108);
-
-                        break;
-                }
+            page->speed.set(speedKnob);
+            if (isStrokeEngine || isStreaming) {
+                page->stroke.set(shown.stroke);
+                page->depth.set(shown.depth);
+                page->sensation.set(shown.sensation);
             } else {
-                drawShape::settingBar(strokeString, ossm->encoder.readEncoder(),
-                                      118, 0, RIGHT_ALIGNED);
+                page->stroke.set(encoderValue);
             }
 
             /**
@@ -179,9 +245,7 @@ void OSSM::drawPlayControlsTask(void *pvParameters) {
              *
              * These controls are associated with stroke and distance
              */
-            ossm->display.setFont(Config::Font::small);
-            strokeString = "# " + String(ossm->sessionStrokeCount);
-            ossm->display.drawUTF8(14, lh4, strokeString.c_str());
+            page->strokeCount.set(strokeCount);
 
             /**
              * /////////////////////////////////////////////
@@ -190,25 +254,13 @@ void OSSM::drawPlayControlsTask(void *pvParameters) {
              *
              * These controls are associated with stroke and distance
              */
+            page->distance.set(distance);
+            page->time.set(time);
 
-            if (!isStrokeEngine) {
-                strokeString = formatDistance(ossm->sessionDistanceMeters);
-                stringWidth = ossm->display.getUTF8Width(strokeString.c_str());
-                ossm->display.drawUTF8(104 - stringWidth, lh3,
-                                       strokeString.c_str());
-            }
-
-            strokeString =
-                formatTime(displayLastUpdated - ossm->sessionStartTime).c_str();
-            stringWidth = ossm->display.getUTF8Width(strokeString.c_str());
-            ossm->display.drawUTF8(104 - stringWidth, lh4,
-                                   strokeString.c_str());
-
-            refreshPage(true);
-            xSemaphoreGive(displayMutex);
-        }
+            page->screen.render();
+        });
 
-        vTaskDelay(200);
+        waitForInput(pdMS_TO_TICKS(200));
     }
 
     vTaskDelete(nullptr);
@@ -216,6 +268,7 @@ void OSSM::drawPlayControlsTask(void *pvParameters) {
 
 void OSSM::drawPlayControls() {
     int stackSize = 3 * configMINIMAL_STACK_SIZE;
-    xTaskCreate(drawPlayControlsTask, "drawPlayControlsTask", stackSize, this,
-                1, &Tasks::drawPlayControlsTaskH);
+    xTaskCreatePinnedToCore(drawPlayControlsTask, "drawPlayControlsTask",
+                            stackSize, this, Tasks::renderPriority,
+                            &Tasks::drawPlayControlsTaskH, Tasks::renderCore);
 }
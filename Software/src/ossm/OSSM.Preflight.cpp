@@ -1,9 +1,18 @@
 #include "OSSM.h"
 
-#include "extensions/u8g2Extensions.h"
-#include "utils/analog.h"
+#include <memory>
+
+#include "extensions/Widgets.h"
+#include "services/adc.h"
 #include "utils/format.h"
 
+struct PreflightPage {
+    ui::Label title{Config::Font::bold, 0, 8, ui::Align::center};
+    ui::Label speed{Config::Font::bold, 0, 25, ui::Align::center};
+    ui::Paragraph warning{0, 40};
+    ui::Screen screen{{&title, &speed, &warning}, true};
+};
+
 void OSSM::drawPreflightTask(void *pvParameters) {
     // parse ossm from the parameters
     OSSM *ossm = (OSSM *)pvParameters;
@@ -27,33 +36,33 @@ void OSSM::drawPreflightTask(void *pvParameters) {
 
     auto isInPreflight = [](OSSM *ossm) {
         // Add your preflight checks states here.
-        return ossm->sm->is("simplePenetration.preflight"_s) ||
-               ossm->sm->is("strokeEngine.preflight"_s);
+        return isInState(StateId::simplePenetrationPreflight,
+                         StateId::strokeEnginePreflight,
+                         StateId::streamingPreflight);
     };
 
+    // Only the render task touches the widgets
+    auto page = std::make_shared<PreflightPage>();
+
     do {
 #ifdef AJ_DEVELOPMENT_HARDWARE
         speedPercentage = 0;
 #else
-        speedPercentage =
-            getAnalogAveragePercent(SampleOnPin{Pins::Remote::speedPotPin, 50});
+        speedPercentage = getADCPercent(AdcChannel::speedPot);
 #endif
         if (speedPercentage < Config::Advanced::commandDeadZonePercentage) {
-            ossm->sm->process_event(Done{});
+            ossm->postEvent(EventId::done, -1, portMAX_DELAY);
             break;
         };
 
-        if (xSemaphoreTake(displayMutex, 100) == pdTRUE) {
-            clearPage(true, true);
-            drawStr::title(menuString);
+        drawScene(DisplayLayer::page, [=]() {
             String speedString = UserConfig::language.Speed + String(": ") +
                                  String((int)speedPercentage) + "%";
-            drawStr::centered(25, speedString);
-            drawStr::multiLine(0, 40, UserConfig::language.SpeedWarning);
-
-            refreshPage(true, true);
-            xSemaphoreGive(displayMutex);
-        }
+            page->title.set(menuString);
+            page->speed.set(speedString);
+            page->warning.set(UserConfig::language.SpeedWarning);
+            page->screen.render();
+        });
 
         vTaskDelay(100);
     } while (isInPreflight(ossm));
@@ -63,6 +72,7 @@ void OSSM::drawPreflightTask(void *pvParameters) {
 
 void OSSM::drawPreflight() {
     int stackSize = 3 * configMINIMAL_STACK_SIZE;
-    xTaskCreate(drawPreflightTask, "drawPlayControlsTask", stackSize, this, 1,
-                &Tasks::drawPreflightTaskH);
+    xTaskCreatePinnedToCore(drawPreflightTask, "drawPreflightTask",
+                            stackSize, this, Tasks::renderPriority,
+                            &Tasks::drawPreflightTaskH, Tasks::renderCore);
 }
@@ -2,64 +2,137 @@
 
 #include <queue>
 
+#include "PatternMath.h"
 #include "constants/Config.h"
 #include "services/communication/nimble.h"
 
+// Time until the ramp of the stepper starts braking for targetPosition, 0 once
+// it brakes or stands at the target.
+static float timeUntilBraking(FastAccelStepper *stepper,
+                              int32_t targetPosition) {
+    float distance = targetPosition - stepper->getCurrentPosition();
+    float speed = stepper->getCurrentSpeedInMilliHz() / 1000.0;
+    float maxSpeed = stepper->getSpeedInMilliHz() / 1000.0;
+    float acceleration = stepper->getAcceleration();
+    if (distance < 0) {
+        speed = -speed;
+    }
+    distance = abs(distance);
+
+    // Within a step of the braking point, or past it
+    if (acceleration <= 0 ||
+        (speed >= 0 && speed * speed / (2.0 * acceleration) + 1 >= distance)) {
+        return 0.0;
+    }
+
+    float peakSpeed = min(
+        float(sqrt(acceleration * distance + 0.5 * speed * speed)), maxSpeed);
+    float remaining =
+        trapezoidalMoveTime(distance, maxSpeed, acceleration, speed);
+    return max(remaining - peakSpeed / acceleration, 0.0f);
+}
+
+// Hands new limits to the move in progress, the ramp generator blends over to
+// them with the set acceleration. Slowing down lowers the acceleration too,
+// which must not push the braking point past the target, so it stays high
+// enough to stop in the remaining distance, up to the machine's limit.
+static void applySpeed(FastAccelStepper *stepper, int32_t targetPosition,
+                       float speed, float acceleration) {
+    float distance = abs(targetPosition - stepper->getCurrentPosition());
+    float currentSpeed = abs(stepper->getCurrentSpeedInMilliHz() / 1000.0);
+    if (distance > 0) {
+        float needed = currentSpeed * currentSpeed / (2.0 * distance);
+        acceleration = max(
+            acceleration,
+            min(needed, float((1_mm) * ossm->limits.maxAcceleration)));
+    }
+
+    stepper->setSpeedInHz(speed);
+    stepper->setAcceleration(acceleration);
+    stepper->applySpeedAcceleration();
+}
+
 void OSSM::startSimplePenetrationTask(void *pvParameters) {
     OSSM *ossm = (OSSM *)pvParameters;
 
-    int fullStrokeCount = 0;
     static int32_t targetPosition = 0;
 
     auto isInCorrectState = [](OSSM *ossm) {
         // Add any states that you want to support here.
-        return ossm->sm->is("simplePenetration"_s) ||
-               ossm->sm->is("simplePenetration.idle"_s);
+        return isInState(StateId::simplePenetration,
+                         StateId::simplePenetrationIdle);
     };
 
-    double lastSpeed = 0;
+    float lastSpeed = -1;
+    float lastScale = 1.0f;
+    ossm->startGovernor();
 
     bool stopped = false;
 
+    uint32_t settingVersion = 0;
+    SettingPercents current = OSSM::setting.load(&settingVersion);
+
     while (isInCorrectState(ossm)) {
-        auto speed = (1_mm) * Config::Driver::maxSpeedMmPerSecond *
-                     OSSM::setting.speed / 100.0;
-        auto acceleration = (1_mm) * Config::Driver::maxSpeedMmPerSecond *
-                            OSSM::setting.speed * OSSM::setting.speed /
+        if (OSSM::setting.getVersion() != settingVersion) {
+            current = OSSM::setting.load(&settingVersion);
+        }
+
+        // A speed ramp is followed in steps of the apply interval
+        bool isRamping = isSpeedRamping();
+        TickType_t maxWait =
+            isRamping ? pdMS_TO_TICKS(Config::Advanced::settingApplyIntervalMs)
+                      : pdMS_TO_TICKS(Config::Advanced::settingWaitTimeoutMs);
+        float speedPercent = rampedSpeed(current.speed);
+
+        const MachineLimits &limits = ossm->limits;
+        auto speed =
+            (1_mm) * limits.maxSpeedMmPerSecond * speedPercent / 100.0;
+        auto acceleration = (1_mm) * limits.maxSpeedMmPerSecond *
+                            speedPercent * speedPercent /
                             Config::Advanced::accelerationScaling;
 
-        bool isSpeedZero = OSSM::setting.speedKnob <
-                           Config::Advanced::commandDeadZonePercentage;
-        bool isSpeedChanged =
-            !isSpeedZero && abs(speed - lastSpeed) >
-                                5 * Config::Advanced::commandDeadZonePercentage;
-        bool isAtTarget =
-            abs(targetPosition - ossm->stepper->getCurrentPosition()) == 0;
+        // Loaded strokes run with derated limits, unloaded ones at full
+        float scale = getGovernorScale();
+        speed = fmin(speed, (1_mm) * limits.maxSpeedMmPerSecond * scale);
+        acceleration =
+            fmin(acceleration, (1_mm) * limits.maxAcceleration * scale);
+
+        bool isSpeedZero =
+            current.speedKnob < Config::Advanced::commandDeadZonePercentage ||
+            speedPercent < Config::Advanced::commandDeadZonePercentage;
+        // The knob is already median filtered by the ADC service, so every
+        // published change is a real one
+        bool isSpeedChanged = !isSpeedZero && (speedPercent != lastSpeed ||
+                                               scale != lastScale);
 
         // If the speed is zero, then stop the stepper and wait for the next
         if (isSpeedZero) {
             ossm->stepper->stopMove();
             stopped = true;
-            vTaskDelay(100);
+            xSemaphoreTake(settingChanged, maxWait);
             continue;
         } else if (stopped) {
             ossm->stepper->moveTo(targetPosition, false);
             stopped = false;
         }
 
-        // If the speed is greater than the dead-zone, and the speed has changed
-        // by more than the dead-zone, then update the stepper.
+        // Apply a new speed to the move in progress instead of waiting for
+        // the next stroke.
         // This must be done in the same task that the stepper is running in.
         if (isSpeedChanged) {
-            lastSpeed = speed;
-            ossm->stepper->setAcceleration(acceleration);
-            ossm->stepper->setSpeedInHz(speed);
+            lastSpeed = speedPercent;
+            lastScale = scale;
+            applySpeed(ossm->stepper, targetPosition, speed, acceleration);
         }
 
-        // If the stepper is not at the target, then wait for the next loop
-        if (!isAtTarget) {
-            vTaskDelay(1);
-            // more than zero
+        // Sleep until the move starts braking, a new setting wakes us early.
+        // Waking up to a tick late is fine, the reversal happens anywhere
+        // within the braking phase.
+        float untilBraking = timeUntilBraking(ossm->stepper, targetPosition);
+        if (untilBraking > 0) {
+            TickType_t ticks = ceil(untilBraking * 1000.0 / portTICK_PERIOD_MS);
+            xSemaphoreTake(settingChanged,
+                           constrain(ticks, TickType_t(1), maxWait));
             continue;
         }
 
@@ -67,7 +140,7 @@ void OSSM::startSimplePenetrationTask(void *pvParameters) {
         ossm->isForward = nextDirection;
 
         if (ossm->isForward) {
-            targetPosition = -abs(((float)OSSM::setting.stroke / 100.0) *
+            targetPosition = -abs(((float)current.stroke / 100.0) *
                                   ossm->measuredStrokeSteps);
         } else {
             targetPosition = 0;
@@ -76,25 +149,23 @@ void OSSM::startSimplePenetrationTask(void *pvParameters) {
         ESP_LOGV("SimplePenetration", "target: %f,\tspeed: %f,\tacc: %f",
                  targetPosition, speed, acceleration);
 
+        // The previous move ends here, it is braking for its target
+        ossm->session.reach(ossm->stepper->getCurrentPosition());
+
+        // Retargeting while braking lets the ramp generator turn around at
+        // the end of the stroke without coming to a rest first. The next
+        // stroke starts from the nominal limits again.
+        ossm->stepper->setSpeedInHz(speed);
+        ossm->stepper->setAcceleration(acceleration);
         ossm->stepper->moveTo(targetPosition, false);
 
-        if (OSSM::setting.speed > Config::Advanced::commandDeadZonePercentage &&
-            OSSM::setting.stroke >
-                (long)Config::Advanced::commandDeadZonePercentage) {
-            fullStrokeCount++;
-            ossm->sessionStrokeCount = floor(fullStrokeCount / 2);
-
-            // This calculation assumes that at the end of every stroke you have
-            // a whole positive distance, equal to maximum target position.
-            ossm->sessionDistanceMeters +=
-                (((float)OSSM::setting.stroke / 100.0) *
-                 ossm->measuredStrokeSteps / (1_mm)) /
-                1000.0;
+        // Nothing to move, e.g. a stroke of 0
+        if (targetPosition == ossm->stepper->getCurrentPosition()) {
+            xSemaphoreTake(settingChanged, maxWait);
         }
-
-        vTaskDelay(1);
     }
 
+    stopGovernor();
     vTaskDelete(nullptr);
 }
 
@@ -103,6 +174,6 @@ void OSSM::startSimplePenetration() {
 
     xTaskCreatePinnedToCore(
         startSimplePenetrationTask, "startSimplePenetrationTask", stackSize,
-        this, configMAX_PRIORITIES - 1, &Tasks::runSimplePenetrationTaskH,
+        this, Tasks::operationPriority, &Tasks::runSimplePenetrationTaskH,
         Tasks::operationTaskCore);
 }
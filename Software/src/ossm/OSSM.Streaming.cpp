@@ -0,0 +1,120 @@
+#include "OSSM.h"
+
+#include "services/stepper.h"
+
+void OSSM::startStreamingTask(void *pvParameters) {
+    OSSM *ossm = (OSSM *)pvParameters;
+    float measuredStrokeMm = abs(ossm->measuredStrokeSteps / (1_mm));
+
+    machineGeometry streamingMachine = {.physicalTravel = measuredStrokeMm,
+                                        .keepoutBoundary = 6.0};
+    uint32_t settingVersion = 0;
+    SettingPercents lastSetting = OSSM::setting.load(&settingVersion);
+
+    applyMachineLimits(ossm->limits);
+    Stroker.begin(&streamingMachine, &servoMotor, ossm->stepper);
+    if (Config::Advanced::streamingLoopRateHz > 0) {
+        Stroker.setLoopRate(Config::Advanced::streamingLoopRateHz);
+        Stroker.setLoopMode(LOOP_TIMER);
+    } else {
+        Stroker.setLoopMode(LOOP_POLLING);
+    }
+    Stroker.thisIsHome();
+    ossm->session.reset(ossm->stepper->getCurrentPosition());
+    Stroker.setSessionCounter(&ossm->session);
+
+    Stroker.setDepth(0.01f * lastSetting.depth * measuredStrokeMm, false);
+    Stroker.setStroke(0.01f * lastSetting.stroke * measuredStrokeMm, false);
+    Stroker.startStreaming();
+
+    auto isInCorrectState = [](OSSM *ossm) {
+        // Add any states that you want to support here.
+        return isInState(StateId::streaming, StateId::streamingIdle);
+    };
+
+    while (isInCorrectState(ossm)) {
+        if (OSSM::setting.getVersion() == settingVersion) {
+            waitForSettingChange();
+            continue;
+        }
+        SettingPercents current = OSSM::setting.load(&settingVersion);
+
+        Stroker.beginUpdate();
+
+        // The speed knob limits how fast the machine may follow the stream,
+        // BLE speeds are taken as they are
+        if (isChangeSignificant(lastSetting.speed, current.speed) ||
+            ossm->wasLastSpeedCommandFromBLE(true)) {
+            float maxSpeed =
+                0.01f * current.speed * ossm->limits.maxSpeedMmPerSecond;
+            ESP_LOGD("UTILS", "change streaming speed limit: %f", maxSpeed);
+            Stroker.setMaxSpeed(max(maxSpeed, 1.0f));
+            lastSetting.speed = current.speed;
+        }
+
+        if (lastSetting.stroke != current.stroke) {
+            Stroker.setStroke(0.01f * current.stroke * measuredStrokeMm,
+                              false);
+            lastSetting.stroke = current.stroke;
+        }
+
+        if (lastSetting.depth != current.depth) {
+            Stroker.setDepth(0.01f * current.depth * measuredStrokeMm, false);
+            lastSetting.depth = current.depth;
+        }
+        Stroker.endUpdate();
+
+        waitForSettingChange();
+    }
+
+    scriptPattern.clock.stop();
+    Stroker.stopMotion();
+
+    vTaskDelete(nullptr);
+}
+
+void OSSM::startStreaming() {
+    int stackSize = 8 * configMINIMAL_STACK_SIZE;
+
+    xTaskCreatePinnedToCore(startStreamingTask, "startStreamingTask",
+                            stackSize, this, Tasks::operationPriority,
+                            &Tasks::runStreamingTaskH,
+                            Tasks::operationTaskCore);
+}
+
+void OSSM::moveTo(float intensity, uint16_t inTime) {
+    targetPosition = constrain(intensity, 0.0f, 100.0f);
+    targetTime = inTime;
+
+    // Targets are ignored outside of streaming and while the speed knob is
+    // turned all the way down
+    if (!isInState(StateId::streamingIdle) || setting.load().speed < 0.1f) {
+        return;
+    }
+
+    // Map the position into the window between depth - stroke and depth,
+    // the same interval the patterns use
+    float position = Stroker.getDepth() - Stroker.getStroke() +
+                     0.01f * targetPosition * Stroker.getStroke();
+    Stroker.streamTo(max(position, 0.0f), targetTime);
+}
+
+void OSSM::playScript(uint32_t time) {
+    if (!isInState(StateId::streamingIdle)) {
+        return;
+    }
+
+    scriptPattern.clock.start(time, millis());
+    if (Stroker.getState() == STREAMING) {
+        Stroker.stopMotion();
+        Stroker.startScript();
+    }
+}
+
+void OSSM::pauseScript() {
+    scriptPattern.clock.stop();
+    if (isInState(StateId::streamingIdle) && Stroker.getState() == PATTERN) {
+        Stroker.stopMotion();
+        Stroker.startStreaming();
+    }
+}
@@ -1,6 +1,7 @@
 #include "OSSM.h"
 
 #include "services/stepper.h"
+#include "utils/StrokeTimingLog.h"
 
 void OSSM::startStrokeEngineTask(void *pvParameters) {
     OSSM *ossm = (OSSM *)pvParameters;
@@ -9,112 +10,113 @@ void OSSM::startStrokeEngineTask(void *pvParameters) {
     machineGeometry strokingMachine = {
         .physicalTravel = abs(ossm->measuredStrokeSteps / (1_mm)),
         .keepoutBoundary = 6.0};
-    SettingPercents lastSetting = OSSM::setting;
+    uint32_t settingVersion = 0;
+    SettingPercents current = OSSM::setting.load(&settingVersion);
+    SettingPercents lastSetting = current;
 
+    applyMachineLimits(ossm->limits);
     Stroker.begin(&strokingMachine, &servoMotor, ossm->stepper);
+    Stroker.setLoopMode(LOOP_MOVE_COMPLETION);
     Stroker.thisIsHome();
+    ossm->session.reset(ossm->stepper->getCurrentPosition());
+    Stroker.setSessionCounter(&ossm->session);
+    Stroker.setJerk(Config::Driver::jerk);
+    Stroker.resetTiming();
 
-    Stroker.setSensation(calculateSensation(OSSM::setting.sensation), true);
+    Stroker.setSensation(calculateSensation(current.sensation), true);
 
-    Stroker.setDepth(0.01f * OSSM::setting.depth * abs(measuredStrokeMm), true);
-    Stroker.setStroke(0.01f * OSSM::setting.stroke * abs(measuredStrokeMm),
-                      true);
+    // Full limits until the current says otherwise
+    float governorScale = 1.0f;
+    Stroker.setMaxSpeed(servoMotor.maxSpeed);
+    Stroker.setMaxAcceleration(servoMotor.maxAcceleration);
+    ossm->startGovernor();
+
+    Stroker.setDepth(0.01f * current.depth * abs(measuredStrokeMm), true);
+    Stroker.setStroke(0.01f * current.stroke * abs(measuredStrokeMm), true);
 
     auto isInCorrectState = [](OSSM *ossm) {
         // Add any states that you want to support here.
-        return ossm->sm->is("strokeEngine"_s) ||
-               ossm->sm->is("strokeEngine.idle"_s) ||
-               ossm->sm->is("strokeEngine.pattern"_s);
+        return isInState(StateId::strokeEngine, StateId::strokeEngineIdle,
+                         StateId::strokeEnginePattern);
     };
 
     while (isInCorrectState(ossm)) {
-        if (isChangeSignificant(lastSetting.speed, OSSM::setting.speed) || ossm->wasLastSpeedCommandFromBLE(true)) {
+        // One version compare tells whether any setting was published
+        bool isSettingChanged = OSSM::setting.getVersion() != settingVersion;
+        if (isSettingChanged) {
+            current = OSSM::setting.load(&settingVersion);
+        }
+
+        // Everything that changed with this publish reaches the motion
+        // tasks together
+        Stroker.beginUpdate();
+
+        // A speed ramp is followed closely, every step of it is applied
+        bool isRamping = isSpeedRamping();
+        float speed = rampedSpeed(current.speed);
+        if ((isRamping && speed != lastSetting.speed) ||
+            isChangeSignificant(lastSetting.speed, speed) ||
+            ossm->wasLastSpeedCommandFromBLE(true)) {
             //Speed is float, so give a little wiggle room here to assume 0
-            if (OSSM::setting.speed < 0.1f) {
+            if (speed < 0.1f) {
                 Stroker.stopMotion();
             } else if (Stroker.getState() == READY) {
                 Stroker.startPattern();
             }
 
-            Stroker.setSpeed(OSSM::setting.speed * 3, true);
-            lastSetting.speed = OSSM::setting.speed;
+            Stroker.setSpeed(speed * 3, true);
+            lastSetting.speed = speed;
         }
 
-        if (lastSetting.stroke != OSSM::setting.stroke) {
-            float newStroke =
-                0.01f * OSSM::setting.stroke * abs(measuredStrokeMm);
-            ESP_LOGD("UTILS", "change stroke: %f %f", OSSM::setting.stroke,
+        if (isSettingChanged && lastSetting.stroke != current.stroke) {
+            float newStroke = 0.01f * current.stroke * abs(measuredStrokeMm);
+            ESP_LOGD("UTILS", "change stroke: %f %f", current.stroke,
                      newStroke);
             Stroker.setStroke(newStroke, true);
-            lastSetting.stroke = OSSM::setting.stroke;
+            lastSetting.stroke = current.stroke;
         }
 
-        if (lastSetting.depth != OSSM::setting.depth) {
-            float newDepth =
-                0.01f * OSSM::setting.depth * abs(measuredStrokeMm);
-            ESP_LOGD("UTILS", "change depth: %f %f", OSSM::setting.depth,
-                     newDepth);
-            Stroker.setDepth(newDepth, false);
-            lastSetting.depth = OSSM::setting.depth;
+        if (isSettingChanged && lastSetting.depth != current.depth) {
+            float newDepth = 0.01f * current.depth * abs(measuredStrokeMm);
+            ESP_LOGD("UTILS", "change depth: %f %f", current.depth, newDepth);
+            Stroker.setDepth(newDepth, true);
+            lastSetting.depth = current.depth;
         }
 
-        if (lastSetting.sensation != OSSM::setting.sensation) {
-            float newSensation = calculateSensation(OSSM::setting.sensation);
-            ESP_LOGD("UTILS", "change sensation: %f %f",
-                     OSSM::setting.sensation, newSensation);
-            Stroker.setSensation(newSensation, false);
-            lastSetting.sensation = OSSM::setting.sensation;
+        if (isSettingChanged && lastSetting.sensation != current.sensation) {
+            float newSensation = calculateSensation(current.sensation);
+            ESP_LOGD("UTILS", "change sensation: %f %f", current.sensation,
+                     newSensation);
+            Stroker.setSensation(newSensation, true);
+            lastSetting.sensation = current.sensation;
         }
 
-        if (lastSetting.pattern != OSSM::setting.pattern) {
-            ESP_LOGD("UTILS", "change pattern: %d", OSSM::setting.pattern);
-
-            switch (OSSM::setting.pattern) {
-                case StrokePatterns::SimpleStroke:
-                    Stroker.setPattern(new SimpleStroke("Simple Stroke"),
-                                       false);
-                    break;
-                case StrokePatterns::TeasingPounding:
-                    Stroker.setPattern(new TeasingPounding("Teasing Pounding"),
-                                       false);
-                    break;
-                case StrokePatterns::RoboStroke:
-                    Stroker.setPattern(new RoboStroke("Robo Stroke"), false);
-                    break;
-                case StrokePatterns::HalfnHalf:
-                    Stroker.setPattern(new HalfnHalf("Half'n'Half"), false);
-                    break;
-                case StrokePatterns::Deeper:
-                    Stroker.setPattern(new Deeper("Deeper"), false);
-                    break;
-                case StrokePatterns::StopNGo:
-                    Stroker.setPattern(new StopNGo("Stop'n'Go"), false);
-                    break;
-                case StrokePatterns::Insist:
-                    Stroker.setPattern(new Insist("Insist"), false);
-                    break;
-                case StrokePatterns::Knot:
-                    Stroker.setPattern(new Knot("Knot"), false);
-                    break;
-                case StrokePatterns::Struggle:
-                    Stroker.setPattern(new Struggle("Struggle"), false);
-                    break;
-                default:
-                    break;
-            }
+        if (isSettingChanged && lastSetting.pattern != current.pattern) {
+            ESP_LOGD("UTILS", "change pattern: %d", current.pattern);
+
+            // StrokePatterns follows the order of the pattern table
+            Stroker.setPattern(static_cast<int>(current.pattern), false);
 
-            lastSetting.pattern = OSSM::setting.pattern;
+            lastSetting.pattern = current.pattern;
         }
 
-        if(ossm->hasActiveBLEConnection) {
-            // When connected to BLE, update more frequently for improved responsiveness
-            vTaskDelay(100);
-        } else {
-            vTaskDelay(400);
+        // Loaded strokes run with derated limits, unloaded ones at full
+        float scale = getGovernorScale();
+        if (scale != governorScale) {
+            ESP_LOGD("UTILS", "change limits: %.0f%%", scale * 100.0f);
+            Stroker.setMaxSpeed(scale * servoMotor.maxSpeed);
+            Stroker.setMaxAcceleration(scale * servoMotor.maxAcceleration);
+            governorScale = scale;
         }
+        Stroker.endUpdate();
+
+        // Sleep until the next setting is published
+        waitForSettingChange();
     }
 
+    stopGovernor();
     Stroker.stopMotion();
+    dumpStrokeTiming();
 
     vTaskDelete(nullptr);
 }
@@ -123,7 +125,7 @@ void OSSM::startStrokeEngine() {
     int stackSize = 12 * configMINIMAL_STACK_SIZE;
 
     xTaskCreatePinnedToCore(startStrokeEngineTask, "startStrokeEngineTask",
-                            stackSize, this, configMAX_PRIORITIES - 1,
+                            stackSize, this, Tasks::operationPriority,
                             &Tasks::runStrokeEngineTaskH,
                             Tasks::operationTaskCore);
 }
@@ -4,32 +4,38 @@
 #include "extensions/u8g2Extensions.h"
 
 void OSSM::drawUpdate() {
-    if (xSemaphoreTake(displayMutex, 100) == pdTRUE) {
+    drawScene(DisplayLayer::page, []() {
         clearPage(true, true);
         drawStr::title(F("Checking for update..."));
 
         // TODO - Add a spinner here
-        refreshPage(true, true);
-        xSemaphoreGive(displayMutex);
-    }
+    });
 }
 
 void OSSM::drawNoUpdate() {
-    if (xSemaphoreTake(displayMutex, 100) == pdTRUE) {
+    drawScene(DisplayLayer::page, [this]() {
         clearPage(true, true);
         drawStr::title(F("No Update Available"));
         display.drawUTF8(0, 62, UserConfig::language.Skip);
-        refreshPage(true, true);
-        xSemaphoreGive(displayMutex);
-    }
+    });
 }
 
-void OSSM::drawUpdating() {
-    if (xSemaphoreTake(displayMutex, 100) == pdTRUE) {
+void OSSM::drawUpdating(int percent) {
+    // Redrawing the same percentage again would only cost display time
+    static int lastPercent = -1;
+    if (percent >= 0 && percent == lastPercent) {
+        return;
+    }
+    lastPercent = percent;
+
+    drawScene(DisplayLayer::page, [this, percent]() {
         clearPage(true, true);
         drawStr::title(F("Updating OSSM..."));
         drawStr::multiLine(0, 24, UserConfig::language.UpdateMessage);
-        refreshPage(true, true);
-        xSemaphoreGive(displayMutex);
-    }
+
+        if (percent >= 0) {
+            display.drawFrame(0, 56, 128, 8);
+            display.drawBox(2, 58, 124 * min(percent, 100) / 100, 4);
+        }
+    });
 }
@@ -7,7 +7,7 @@
 #include "qrcode.h"
 
 void OSSM::drawWiFi() {
-    if (xSemaphoreTake(displayMutex, 100) == pdTRUE) {
+    drawScene(DisplayLayer::page, [this]() {
         clearPage(true, true);
 
         static QRCode qrcode;
@@ -45,9 +45,7 @@ void OSSM::drawWiFi() {
         display.drawUTF8(0, 26, UserConfig::language.WiFiSetupLine1);
         display.drawUTF8(0, 38, UserConfig::language.WiFiSetupLine2);
         display.drawUTF8(0, 62, UserConfig::language.Restart);
-        refreshPage(true, true);
-        xSemaphoreGive(displayMutex);
-    }
+    });
 
     wm.setConfigPortalBlocking(false);
     wm.setCleanConnect(true);
@@ -60,7 +58,7 @@ void OSSM::drawWiFi() {
 
             auto isInCorrectState = [](OSSM *ossm) {
                 // Add any states that you want to support here.
-                return ossm->sm->is("wifi"_s) || ossm->sm->is("wifi.idle"_s);
+                return isInMode(StateId::wifi);
             };
 
             while (isInCorrectState(ossm)) {
@@ -72,5 +70,5 @@ void OSSM::drawWiFi() {
             vTaskDelete(nullptr);
         },
         "wmProcessTask", 4 * configMINIMAL_STACK_SIZE, this,
-        configMAX_PRIORITIES - 1, nullptr, 0);
+        Tasks::renderPriority, nullptr, Tasks::renderCore);
 }
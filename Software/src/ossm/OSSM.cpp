@@ -10,12 +10,23 @@ using namespace sml;
 
 OSSM *ossm = nullptr;
 
+std::atomic<StateId> currentStateId{StateId::idle};
+std::atomic<StateId> currentModeId{StateId::idle};
+
+#if OSSM_STATE_TRACE
+TraceRing<StateTraceRecord, STATE_TRACE_LENGTH> stateTrace;
+portMUX_TYPE stateTraceLock = portMUX_INITIALIZER_UNLOCKED;
+#endif
+
 // Static member definition
-SettingPercents OSSM::setting = {.speed = 0,
-                                 .stroke = 50,
-                                 .sensation = 50,
-                                 .depth = 10,
-                                 .pattern = StrokePatterns::SimpleStroke};
+Seqlock<SettingPercents> OSSM::setting({.speed = 0,
+                                         .stroke = 50,
+                                         .sensation = 50,
+                                         .depth = 10,
+                                         .pattern = StrokePatterns::SimpleStroke});
+portMUX_TYPE OSSM::settingLock = portMUX_INITIALIZER_UNLOCKED;
+SemaphoreHandle_t OSSM::settingChanged = nullptr;
+Seqlock<SpeedRamp> OSSM::speedRamp;
 
 // Now we can define the OSSM constructor since OSSMStateMachine::operator() is
 // fully defined
@@ -27,8 +38,146 @@ OSSM::OSSM(U8G2_SSD1306_128X64_NONAME_F_HW_I2C &display,
       sm(std::make_unique<
           sml::sm<OSSMStateMachine, sml::thread_safe<ESP32RecursiveMutex>,
                   sml::logger<StateLogger>>>(logger, *this)) {
+    settingChanged = xSemaphoreCreateBinary();
+    loadCalibration();
+    loadLimits();
+
+    // From here on only the dispatcher runs the state machine
+    xTaskCreatePinnedToCore(dispatchTask, "dispatchTask",
+                            5 * configMINIMAL_STACK_SIZE, this,
+                            Tasks::dispatchPriority, &dispatchTaskH,
+                            Tasks::dispatchCore);
+
     // All initializations are done, so start the state machine.
-    sm->process_event(Done{});
+    postEvent(EventId::done);
+}
+
+bool OSSM::postEvent(EventId event, int menu, TickType_t wait) {
+    bool isStop =
+        event == EventId::longPress || event == EventId::emergencyStop;
+    if (isStop && hasEmergencyStop(getStateId())) {
+        stopMotorNow();
+    }
+
+    PostedEvent posted = {event, (int8_t)menu, esp_cpu_get_cycle_count()};
+    TickType_t start = xTaskGetTickCount();
+    while (!events.push(posted)) {
+        if (isStop) {
+            // Dispatched right after the events that filled the queue
+            pendingStop.store(event);
+            break;
+        }
+        if (xTaskGetTickCount() - start >= wait) {
+            ESP_LOGE("OSSM", "Event queue full, event %d dropped", (int)event);
+            return false;
+        }
+        vTaskDelay(1);
+    }
+    xTaskNotifyGive(dispatchTaskH);
+    return true;
+}
+
+void OSSM::dispatch(const PostedEvent &event) {
+    if (event.menu >= 0) {
+        menuOption = static_cast<Menu>(event.menu);
+    }
+
+    switch (event.id) {
+        case EventId::buttonPress:
+            sm->process_event(ButtonPress{});
+            break;
+        case EventId::longPress:
+            sm->process_event(LongPress{});
+            break;
+        case EventId::doublePress:
+            sm->process_event(DoublePress{});
+            break;
+        case EventId::done:
+            sm->process_event(Done{});
+            break;
+        case EventId::error:
+            sm->process_event(Error{});
+            break;
+        case EventId::emergencyStop:
+            sm->process_event(EmergencyStop{});
+            break;
+        case EventId::home:
+            sm->process_event(Home{});
+            break;
+        case EventId::bleClick:
+            sm->process_event(BleClick{});
+            break;
+        case EventId::internal:
+            break;
+    }
+}
+
+// Actions run here, in the order their events were posted. A producer
+// notifies after its event is published, so a wake up never finds the
+// queue empty for good.
+void OSSM::dispatchTask(void *pvParameters) {
+    OSSM *ossm = (OSSM *)pvParameters;
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        PostedEvent event;
+        while (ossm->events.pop(event)) {
+#if OSSM_PROFILE
+            recordProfile(ProfileProbe::eventWait,
+                          esp_cpu_get_cycle_count() - event.postedAt);
+#endif
+            ossm->dispatch(event);
+        }
+
+        EventId stop = ossm->pendingStop.exchange(EventId::internal);
+        if (stop != EventId::internal) {
+            ossm->dispatch({stop, -1, esp_cpu_get_cycle_count()});
+        }
+    }
+}
+
+void OSSM::waitForSettingChange() {
+    static TickType_t lastWake = 0;
+    const TickType_t interval =
+        pdMS_TO_TICKS(Config::Advanced::settingApplyIntervalMs);
+
+    // A speed ramp is followed in steps of the apply interval
+    int timeoutMs = isSpeedRamping() ? Config::Advanced::settingApplyIntervalMs
+                                     : Config::Advanced::settingWaitTimeoutMs;
+    xSemaphoreTake(settingChanged, pdMS_TO_TICKS(timeoutMs));
+
+    // Coalesce bursts: whatever else is published while we wait out the
+    // interval is picked up by the same load()
+    TickType_t elapsed = xTaskGetTickCount() - lastWake;
+    if (elapsed < interval) {
+        vTaskDelay(interval - elapsed);
+    }
+    lastWake = xTaskGetTickCount();
+}
+
+static std::atomic<bool> isHelloSkipped{false};
+
+/**
+ * Waits between the frames and screens of the splash.
+ * @return false if the splash should end instead: with OSSM_FAST_BOOT once
+ * it was skipped or homing is done.
+ */
+static bool helloDelay(int ms) {
+#if OSSM_FAST_BOOT
+    TickType_t end = xTaskGetTickCount() + pdMS_TO_TICKS(ms);
+    while (!isHelloSkipped &&
+           (isInMode(StateId::idle) || isInMode(StateId::homing))) {
+        TickType_t now = xTaskGetTickCount();
+        if ((int32_t)(end - now) <= 0) {
+            return true;
+        }
+        vTaskDelay(min(end - now, pdMS_TO_TICKS(1000 / DISPLAY_MAX_FPS)));
+    }
+    return false;
+#else
+    vTaskDelay(pdMS_TO_TICKS(ms));
+    return true;
+#endif
 }
 
 /**
@@ -41,9 +190,6 @@ OSSM::OSSM(U8G2_SSD1306_128X64_NONAME_F_HW_I2C &display,
  * @param pvParameters
  */
 void OSSM::drawHelloTask(void *pvParameters) {
-    // parse ossm from the parameters
-    OSSM *ossm = (OSSM *)pvParameters;
-
     int frameIdx = 0;
     const int nFrames = 8;
 
@@ -55,7 +201,8 @@ void OSSM::drawHelloTask(void *pvParameters) {
     std::array<int, 4> heights = {0, 0, 0, 0};
     int letterSpacing = 20;
 
-    while (frameIdx < nFrames + 9) {
+    bool isPlaying = true;
+    while (isPlaying && frameIdx < nFrames + 9) {
         if (frameIdx < nFrames) {
             heights[0] = framesY[frameIdx] - offsetY;
         }
@@ -71,50 +218,49 @@ void OSSM::drawHelloTask(void *pvParameters) {
         // increment the frame index
         frameIdx++;
 
-        if (xSemaphoreTake(displayMutex, 100) == pdTRUE) {
+        drawScene(DisplayLayer::page, [=]() {
             clearPage(true, true);
-            ossm->display.setFont(u8g2_font_maniac_tf);
-            ossm->display.drawUTF8(startX, heights[0], "O");
-            ossm->display.drawUTF8(startX + letterSpacing, heights[1], "S");
-            ossm->display.drawUTF8(startX + letterSpacing * 2, heights[2], "S");
-            ossm->display.drawUTF8(startX + letterSpacing * 3, heights[3], "M");
-            refreshPage(true, true);
-            xSemaphoreGive(displayMutex);
-        }
-        // Saying hi to the watchdog :).
-        vTaskDelay(1);
+            display.setFont(u8g2_font_maniac_tr);
+            display.drawUTF8(startX, heights[0], "O");
+            display.drawUTF8(startX + letterSpacing, heights[1], "S");
+            display.drawUTF8(startX + letterSpacing * 2, heights[2], "S");
+            display.drawUTF8(startX + letterSpacing * 3, heights[3], "M");
+        });
+        // One animation frame per display frame.
+        isPlaying = helloDelay(1000 / DISPLAY_MAX_FPS);
     };
 
     // Delay for a second, then show the RDLogo.
-    vTaskDelay(1500);
-
-    if (xSemaphoreTake(displayMutex, 100) == pdTRUE) {
-        clearPage(true, true);
-        drawStr::title("Research & Desire         ");   // Padding to offset from BLE icons
-        ossm->display.drawXBMP(35, 14, 57, 50, Images::RDLogo);
-        refreshPage(true, true);
-        xSemaphoreGive(displayMutex);
+    isPlaying = isPlaying && helloDelay(1500);
+    if (isPlaying) {
+        drawScene(DisplayLayer::page, []() {
+            clearPage(true, true);
+            drawStr::title("Research & Desire         ");   // Padding to offset from BLE icons
+            drawImage::packed(35, 14, Images::RDLogo);
+        });
     }
 
-    vTaskDelay(1000);
-
-    if (xSemaphoreTake(displayMutex, 100) == pdTRUE) {
-        clearPage(true, true);
-        drawStr::title("Kinky Makers       ");   // Padding to offset from BLE icons
-        ossm->display.drawXBMP(40, 14, 50, 50, Images::KMLogo);
-        refreshPage(true, true);
-        xSemaphoreGive(displayMutex);
+    isPlaying = isPlaying && helloDelay(1000);
+    if (isPlaying) {
+        drawScene(DisplayLayer::page, []() {
+            clearPage(true, true);
+            drawStr::title("Kinky Makers       ");   // Padding to offset from BLE icons
+            drawImage::packed(40, 14, Images::KMLogo);
+        });
     }
 
-    vTaskDelay(1000);
+    if (isPlaying) {
+        helloDelay(1000);
+    }
 
-    if (xSemaphoreTake(displayMutex, 100) == pdTRUE) {
-        clearPage(true, true);
-        std::string measuringStrokeTitle = std::string(UserConfig::language.MeasuringStroke) + "         ";   // Padding to offset from BLE icons
-        drawStr::title(measuringStrokeTitle.c_str());
-        ossm->display.drawXBMP(40, 14, 50, 50, Images::KMLogo);
-        refreshPage(true, true);
-        xSemaphoreGive(displayMutex);
+    // Homing may be done already, the menu is on the screen then.
+    if (isInMode(StateId::idle) || isInMode(StateId::homing)) {
+        drawScene(DisplayLayer::page, []() {
+            clearPage(true, true);
+            std::string measuringStrokeTitle = std::string(UserConfig::language.MeasuringStroke) + "         ";   // Padding to offset from BLE icons
+            drawStr::title(measuringStrokeTitle.c_str());
+            drawImage::packed(40, 14, Images::KMLogo);
+        });
     }
 
     // delete the task
@@ -124,10 +270,13 @@ void OSSM::drawHelloTask(void *pvParameters) {
 void OSSM::drawHello() {
     // 3 x minimum stack
     int stackSize = 3 * configMINIMAL_STACK_SIZE;
-    xTaskCreate(drawHelloTask, "drawHello", stackSize, this, 1,
-                &Tasks::drawHelloTaskH);
+    xTaskCreatePinnedToCore(drawHelloTask, "drawHello", stackSize, this,
+                            Tasks::renderPriority, &Tasks::drawHelloTaskH,
+                            Tasks::renderCore);
 }
 
+void OSSM::skipHello() { isHelloSkipped = true; }
+
 void OSSM::drawError() {
     // Throw the e-break on the stepper
     try {
@@ -136,11 +285,9 @@ void OSSM::drawError() {
         ESP_LOGD("OSSM::drawError", "Caught exception: %s", e.what());
     }
 
-    if (xSemaphoreTake(displayMutex, 100) == pdTRUE) {
+    drawScene(DisplayLayer::page, [message = errorMessage]() {
         clearPage(true, true);
         drawStr::title(UserConfig::language.Error);
-        drawStr::multiLine(0, 20, errorMessage);
-        refreshPage(true, true);
-        xSemaphoreGive(displayMutex);
-    }
+        drawStr::multiLine(0, 20, message);
+    });
 }
@@ -12,6 +12,7 @@
 #include "FastAccelStepper.h"
 #include "Guard.h"
 #include "OSSMI.h"
+#include "States.h"
 #include "U8g2lib.h"
 #include "WiFiManager.h"
 #include "boost/sml.hpp"
@@ -20,16 +21,28 @@
 #include "constants/Pins.h"
 #include "constants/UserConfig.h"
 #include "esp_log.h"
+#include "services/adc.h"
+#include "services/profiler.h"
 #include "services/tasks.h"
+#include "structs/LinkStatus.h"
 #include "structs/SettingPercents.h"
+#include "structs/StateSnapshot.h"
+#include "utils/LimitSearch.h"
+#include "utils/MpscRing.h"
+#include "utils/RailCalibration.h"
 #include "utils/RecursiveMutex.h"
+#include "utils/Seqlock.h"
+#include "utils/SpeedRamp.h"
+#include "utils/StateJson.h"
 #include "utils/StateLogger.h"
 #include "utils/StrokeEngineHelper.h"
-#include "utils/analog.h"
 #include "utils/update.h"
 
 namespace sml = boost::sml;
 
+// Events waiting for the dispatcher, see OSSM::postEvent()
+#define EVENT_QUEUE_LENGTH 16
+
 class OSSM : public OSSMInterface {
   private:
     /**
@@ -78,34 +91,68 @@ class OSSM : public OSSMInterface {
             // armpit: Distinct defaults for StrokeEngine and SimplePenetration
             // for more tailored UX
             auto resetSettingsStrokeEngine = [](OSSM &o) {
-                OSSM::setting.speed = 0;
-                OSSM::setting.stroke = 50;
-                OSSM::setting.depth = 10;
-                OSSM::setting.sensation = 50;
+                OSSM::updateSetting([](SettingPercents &s) {
+                    s.speed = 0;
+                    s.stroke = 50;
+                    s.depth = 10;
+                    s.sensation = 50;
+                });
                 o.playControl = PlayControls::DEPTH;
 
                 // Prepare the encoder
                 o.encoder.setBoundaries(0, 100, false);
                 o.encoder.setAcceleration(10);
-                o.encoder.setEncoderValue(OSSM::setting.depth);
+                o.encoder.setEncoderValue(OSSM::setting.load().depth);
+
+                o.sessionStartTime = millis();
+                o.session.reset(o.stepper->getCurrentPosition());
             };
 
             auto resetSettingsSimplePen = [](OSSM &o) {
-                OSSM::setting.speed = 0;
-                OSSM::setting.stroke = 0;
-                OSSM::setting.depth = 50;
-                OSSM::setting.sensation = 50;
+                OSSM::updateSetting([](SettingPercents &s) {
+                    s.speed = 0;
+                    s.stroke = 0;
+                    s.depth = 50;
+                    s.sensation = 50;
+                });
                 o.playControl = PlayControls::STROKE;
 
                 // Prepare the encoder
                 o.encoder.setBoundaries(0, 100, false);
                 o.encoder.setAcceleration(10);
-                o.encoder.setEncoderValue(OSSM::setting.stroke);
+                o.encoder.setEncoderValue(OSSM::setting.load().stroke);
 
                 // record session start time rounded to the nearest second
                 o.sessionStartTime = millis();
-                o.sessionStrokeCount = 0;
-                o.sessionDistanceMeters = 0;
+                o.session.reset(o.stepper->getCurrentPosition());
+            };
+
+            auto resetSettingsStreaming = [](OSSM &o) {
+                OSSM::updateSetting([](SettingPercents &s) {
+                    s.speed = 0;
+                    s.stroke = 50;
+                    s.depth = 50;
+                });
+                o.playControl = PlayControls::DEPTH;
+
+                // Prepare the encoder
+                o.encoder.setBoundaries(0, 100, false);
+                o.encoder.setAcceleration(10);
+                o.encoder.setEncoderValue(OSSM::setting.load().depth);
+
+                o.sessionStartTime = millis();
+                o.session.reset(o.stepper->getCurrentPosition());
+            };
+
+            // Streaming has no use for sensation, toggle stroke and depth only
+            auto toggleStreamingControl = [](OSSM &o) {
+                if (o.playControl == PlayControls::DEPTH) {
+                    o.playControl = PlayControls::STROKE;
+                    o.encoder.setEncoderValue(OSSM::setting.load().stroke);
+                } else {
+                    o.playControl = PlayControls::DEPTH;
+                    o.encoder.setEncoderValue(OSSM::setting.load().depth);
+                }
             };
 
             auto incrementControl = [](OSSM &o) {
@@ -114,13 +161,13 @@ class OSSM : public OSSMInterface {
 
                 switch (o.playControl) {
                     case PlayControls::STROKE:
-                        o.encoder.setEncoderValue(OSSM::setting.stroke);
+                        o.encoder.setEncoderValue(OSSM::setting.load().stroke);
                         break;
                     case PlayControls::DEPTH:
-                        o.encoder.setEncoderValue(OSSM::setting.depth);
+                        o.encoder.setEncoderValue(OSSM::setting.load().depth);
                         break;
                     case PlayControls::SENSATION:
-                        o.encoder.setEncoderValue(OSSM::setting.sensation);
+                        o.encoder.setEncoderValue(OSSM::setting.load().sensation);
                         break;
                 }
             };
@@ -130,17 +177,21 @@ class OSSM : public OSSMInterface {
             };
 
             auto startStrokeEngine = [](OSSM &o) { o.startStrokeEngine(); };
-            auto emergencyStop = [](OSSM &o) {
-                o.stepper->forceStop();
-                o.stepper->disableOutputs();
-            };
+            auto startStreaming = [](OSSM &o) { o.startStreaming(); };
+            auto emergencyStop = [](OSSM &o) { o.stopMotorNow(); };
             auto drawHelp = [](OSSM &o) { o.drawHelp(); };
             auto drawWiFi = [](OSSM &o) { o.drawWiFi(); };
             auto drawUpdate = [](OSSM &o) { o.drawUpdate(); };
             auto drawNoUpdate = [](OSSM &o) { o.drawNoUpdate(); };
             auto drawUpdating = [](OSSM &o) { o.drawUpdating(); };
+            auto startUpdate = [](OSSM &o) {
+                updateOSSM([&o](int percent) { o.drawUpdating(percent); });
+            };
             auto stopWifiPortal = [](OSSM &o) {};
             auto drawError = [](OSSM &o) { o.drawError(); };
+            auto drawAutoTune = [](OSSM &o) { o.drawAutoTune(); };
+            auto drawAutoTuneResult = [](OSSM &o) { o.drawAutoTuneResult(); };
+            auto startAutoTune = [](OSSM &o) { o.startAutoTune(); };
 
             // Guard definitions to make the table easier to read.
             auto isStrokeTooShort = [](OSSM &o) {
@@ -156,8 +207,7 @@ class OSSM : public OSSMInterface {
             };
 
             auto isPreflightSafe = [](OSSM &o) {
-                return getAnalogAveragePercent(
-                           {Pins::Remote::speedPotPin, 50}) <
+                return getADCPercent(AdcChannel::speedPot) <
                        Config::Advanced::commandDeadZonePercentage;
             };
 
@@ -170,6 +220,11 @@ class OSSM : public OSSMInterface {
                 return false;
             };
             auto isNotHomed = [](OSSM &o) { return o.isHomed == false; };
+            auto canQuickHome = [](OSSM &o) { return o.canQuickHome(); };
+            auto startQuickHoming = [](OSSM &o) {
+                o.clearHoming();
+                o.startQuickHoming();
+            };
             auto setHomed = [](OSSM &o) { o.isHomed = true; };
             auto setNotHomed = [](OSSM &o) { o.isHomed = false; };
 
@@ -181,7 +236,14 @@ class OSSM : public OSSMInterface {
                 *"idle"_s + done / drawHello = "homing"_s,
 #endif
 
+                "homing"_s [canQuickHome] / startQuickHoming = "homing.quick"_s,
                 "homing"_s / startHoming = "homing.forward"_s,
+                "homing.quick"_s + error / startHoming = "homing.forward"_s,
+                "homing.quick"_s + done[(isOption(Menu::SimplePenetration))] / setHomed = "simplePenetration"_s,
+                "homing.quick"_s + done[(isOption(Menu::StrokeEngine))] / setHomed = "strokeEngine"_s,
+                "homing.quick"_s + done[(isOption(Menu::Streaming))] / setHomed = "streaming"_s,
+                "homing.quick"_s + done[(isOption(Menu::AutoTune))] / setHomed = "autoTune"_s,
+                "homing.quick"_s + done / setHomed = "menu"_s,
                 "homing.forward"_s + error = "error"_s,
                 "homing.forward"_s + done / startHoming = "homing.backward"_s,
                 "homing.backward"_s + error = "error"_s,
@@ -190,6 +252,7 @@ class OSSM : public OSSMInterface {
                 "homing.backward"_s + done[(isOption(Menu::SimplePenetration))] / setHomed = "simplePenetration"_s,
                 "homing.backward"_s + done[(isOption(Menu::StrokeEngine))] / setHomed = "strokeEngine"_s,
                 "homing.backward"_s + done[(isOption(Menu::Streaming))] / setHomed = "streaming"_s,
+                "homing.backward"_s + done[(isOption(Menu::AutoTune))] / setHomed = "autoTune"_s,
 
                 "menu"_s / (drawMenu) = "menu.idle"_s,
                 "menu.idle"_s + buttonPress[(isOption(Menu::SimplePenetration))] = "simplePenetration"_s,
@@ -198,6 +261,7 @@ class OSSM : public OSSMInterface {
                 "menu.idle"_s + buttonPress[(isOption(Menu::UpdateOSSM))] = "update"_s,
                 "menu.idle"_s + buttonPress[(isOption(Menu::WiFiSetup))] = "wifi"_s,
                 "menu.idle"_s + buttonPress[isOption(Menu::Help)] = "help"_s,
+                "menu.idle"_s + buttonPress[(isOption(Menu::AutoTune))] = "autoTune"_s,
                 "menu.idle"_s + buttonPress[(isOption(Menu::Restart))] = "restart"_s,
 
                 "simplePenetration"_s [isNotHomed] = "homing"_s,
@@ -219,9 +283,17 @@ class OSSM : public OSSMInterface {
                 "strokeEngine.pattern"_s + longPress / (emergencyStop, setNotHomed) = "menu"_s,
                 "strokeEngine.idle"_s + longPress / (emergencyStop, setNotHomed) = "menu"_s,
 
+                "streaming"_s [isNotHomed] = "homing"_s,
+                "streaming"_s [isPreflightSafe] / (resetSettingsStreaming, drawPlayControls, startStreaming) = "streaming.idle"_s,
+                "streaming"_s / drawPreflight = "streaming.preflight"_s,
+                "streaming.preflight"_s + done / (resetSettingsStreaming, drawPlayControls, startStreaming) = "streaming.idle"_s,
+                "streaming.preflight"_s + longPress / (emergencyStop, setNotHomed) = "menu"_s,
+                "streaming.idle"_s + buttonPress / toggleStreamingControl = "streaming.idle"_s,
+                "streaming.idle"_s + longPress / (emergencyStop, setNotHomed) = "menu"_s,
+
                 "update"_s [isOnline] / drawUpdate = "update.checking"_s,
                 "update"_s = "wifi"_s,
-                "update.checking"_s [isUpdateAvailable] / (drawUpdating, updateOSSM) = "update.updating"_s,
+                "update.checking"_s [isUpdateAvailable] / (drawUpdating, startUpdate) = "update.updating"_s,
                 "update.checking"_s / drawNoUpdate = "update.idle"_s,
                 "update.idle"_s + buttonPress = "menu"_s,
                 "update.updating"_s  = X,
@@ -230,6 +302,13 @@ class OSSM : public OSSMInterface {
                 "wifi.idle"_s + done / stopWifiPortal = "menu"_s,
                 "wifi.idle"_s + buttonPress / stopWifiPortal = "menu"_s,
 
+                "autoTune"_s [isNotHomed] = "homing"_s,
+                "autoTune"_s / (drawAutoTune, startAutoTune) = "autoTune.running"_s,
+                "autoTune.running"_s + done / drawAutoTuneResult = "autoTune.idle"_s,
+                "autoTune.running"_s + error = "error"_s,
+                "autoTune.running"_s + longPress / (emergencyStop, setNotHomed) = "menu"_s,
+                "autoTune.idle"_s + buttonPress = "menu"_s,
+
                 "help"_s / drawHelp = "help.idle"_s,
                 "help.idle"_s + buttonPress = "menu"_s,
 
@@ -254,16 +333,34 @@ class OSSM : public OSSMInterface {
     // Homing Variables
     bool isForward = true;
 
-    String errorMessage = "";
+    const char *errorMessage = "";
 
     unsigned long sessionStartTime = 0;
-    int sessionStrokeCount = 0;
-    double sessionDistanceMeters = 0;
+    // Strokes and steps of the session, counted by the motion task
+    SessionCounter session;
 
     PlayControls playControl = PlayControls::STROKE;
 
     bool lastSpeedCommandWasFromBLE = false;
     bool hasActiveBLEConnection = false;
+    // Written by the NimBLE host, read when the state is sent
+    LinkStatus bleLink;
+    portMUX_TYPE bleLinkLock = portMUX_INITIALIZER_UNLOCKED;
+
+    // An event on its way to the dispatcher
+    struct PostedEvent {
+        EventId id;
+        int8_t menu;        // Selected before the event, unless negative
+        uint32_t postedAt;  // Cycle count, for ProfileProbe::eventWait
+    };
+    MpscRing<PostedEvent, EVENT_QUEUE_LENGTH> events;
+    // A stop that didn't fit the queue, dispatched after it. internal if
+    // there is none. Stops are never dropped.
+    std::atomic<EventId> pendingStop{EventId::internal};
+    TaskHandle_t dispatchTaskH = nullptr;
+
+    void dispatch(const PostedEvent &event);
+    static void dispatchTask(void *pvParameters);
 
     /**
      * ///////////////////////////////////////////
@@ -276,8 +373,51 @@ class OSSM : public OSSMInterface {
 
     void startHoming();
 
+    // Quick homing, only once a full homing since boot put the position
+    // counter on the rail and its calibration was stored.
+    bool canQuickHome();
+    void startQuickHoming();
+    static void startQuickHomingTask(void *pvParameters);
+
+    // How a touch-off of the rear end went: found it in the slow zone,
+    // stalled early before it, didn't find it up to the limit, ran out of
+    // time or the machine left the mode.
+    enum class TouchOff { found, early, notFound, timeout, left };
+
+    // Drives to just short of the rear end and touches it off slowly, up to
+    // limit. Stopped at the end, stallPosition is where it stalled. Runs on
+    // the calling task, until timeout ticks after startTick.
+    TouchOff touchOffRear(StateId mode, int32_t limit, TickType_t startTick,
+                          TickType_t timeout, int32_t &stallPosition);
+
+    void loadCalibration();
+    void saveCalibration();
+
+    // Test strokes up to the limits of the machine, from a homed rail. The
+    // limits found are stored and used by every play mode.
+    void startAutoTune();
+    static void startAutoTuneTask(void *pvParameters);
+    // Strokes at limits, then touches off the rear end. Reliable if neither
+    // the current nor the end position show trouble.
+    TouchOff runAutoTuneTrial(const MachineLimits &limits, bool &isReliable);
+    // False when the last auto tune kept the old limits
+    bool isAutoTuneFound = false;
+
+    void loadLimits();
+    void saveLimits();
+
+    void drawAutoTune(int trial = 0, MachineLimits trialLimits = {});
+    void drawAutoTuneResult();
+
     void startSimplePenetration();
 
+    // Derates the motion limits while the motor is loaded, from the start
+    // to the stop of a motion task. The scale applies to the acceleration
+    // and speed limits, a change wakes the task like a new setting.
+    void startGovernor();
+    static void stopGovernor();
+    static float getGovernorScale();
+
     bool isStrokeTooShort();
 
     void drawError();
@@ -304,6 +444,8 @@ class OSSM : public OSSMInterface {
 
     void startStrokeEngine();
 
+    void startStreaming();
+
     static void drawHelloTask(void *pvParameters);
 
     static void drawMenuTask(void *pvParameters);
@@ -314,7 +456,8 @@ class OSSM : public OSSMInterface {
     void drawUpdate();
     void drawNoUpdate();
 
-    void drawUpdating();
+    // Shows a progress bar for percent from 0 to 100
+    void drawUpdating(int percent = -1);
 
     void drawPreflight();
     static void drawPreflightTask(void *pvParameters);
@@ -323,6 +466,8 @@ class OSSM : public OSSMInterface {
 
     static void startStrokeEngineTask(void *pvParameters);
 
+    static void startStreamingTask(void *pvParameters);
+
     bool isHomed;
 
   public:
@@ -335,7 +480,53 @@ class OSSM : public OSSMInterface {
                 sml::logger<StateLogger>>>
         sm = nullptr;  // The state machine
 
-    static SettingPercents setting;
+    // Published settings. Any task may load() a consistent copy, writes go
+    // through updateSetting() so writers on both cores never overlap.
+    static Seqlock<SettingPercents> setting;
+    static portMUX_TYPE settingLock;
+    // Given after every write, the running motion task waits on it instead
+    // of polling.
+    static SemaphoreHandle_t settingChanged;
+
+    template <typename Update>
+    static void updateSetting(Update update) {
+        portENTER_CRITICAL(&settingLock);
+        setting.write(update);
+        portEXIT_CRITICAL(&settingLock);
+
+        if (settingChanged != nullptr) {
+            xSemaphoreGive(settingChanged);
+        }
+    }
+
+    // Blocks until a setting was written, or for
+    // Config::Advanced::settingWaitTimeoutMs
+    static void waitForSettingChange();
+
+    // Speed transition the motion tasks follow, written under settingLock
+    // like the settings. Inactive unless rampSpeed() was called.
+    static Seqlock<SpeedRamp> speedRamp;
+
+    template <typename Update>
+    static void updateSpeedRamp(Update update) {
+        portENTER_CRITICAL(&settingLock);
+        speedRamp.write(update);
+        portEXIT_CRITICAL(&settingLock);
+    }
+
+    // Speed in percent the motion tasks run at: the ramp while one is
+    // active, the published speed otherwise.
+    static float rampedSpeed(float speed) {
+        SpeedRamp ramp = speedRamp.load();
+        uint32_t now = millis();
+        return ramp.isActive(now) ? ramp.at(now) : speed;
+    }
+
+    static bool isSpeedRamping() { return speedRamp.load().isActive(millis()); }
+
+    // Ends the boot splash early, only with OSSM_FAST_BOOT.
+    void skipHello();
+
     Menu menuOption;
 
     /**
@@ -359,6 +550,16 @@ class OSSM : public OSSMInterface {
      */
     float currentSensorOffset = 0;
     float measuredStrokeSteps = 0;
+    // Stroke of the previous homing, 0 if unknown. Loaded from NVS at boot.
+    float lastMeasuredStrokeSteps = 0;
+    // Stored by the last full homing, confirmed by quick homing
+    RailCalibration calibration;
+    // Set by the first successful homing, the step counter is trusted after
+    bool isRailKnown = false;
+    // Speed and acceleration limits of the play modes, from the last auto
+    // tune or Config::Driver. Loaded from NVS at boot.
+    MachineLimits limits = {Config::Driver::maxSpeedMmPerSecond,
+                            Config::Driver::maxAcceleration};
 
     /**
      * ///////////////////////////////////////////
@@ -371,93 +572,212 @@ class OSSM : public OSSMInterface {
     float targetVelocity = 0;
     uint16_t targetTime = 0;
 
-    int getSpeed() { return this->setting.speed; }
+    int getSpeed() { return setting.load().speed; }
+
+    // The speed setting is changed right away, the motion tasks ease over to
+    // it from the speed they run at. A BLE speed command ends the ramp.
+    void rampSpeed(float target, uint32_t durationMs) {
+        float from = rampedSpeed(setting.load().speed);
+        updateSpeedRamp([&](SpeedRamp &ramp) {
+            ramp = SpeedRamp(from, target, millis(), durationMs);
+        });
+        updateSetting([&](SettingPercents &s) { s.speedBLE = target; });
+    }
+    /**
+     * Hands an event to the dispatcher task, the only task that runs the
+     * state machine. Producers never take its lock or run its actions, so
+     * they can't be held up by actions of other tasks. menu, unless
+     * negative, is selected right before the event is processed.
+     *
+     * While the queue is full it waits up to wait ticks for a free slot.
+     * Tasks whose done or error the state machine can't do without wait
+     * with portMAX_DELAY. False if the event was dropped. A long press or
+     * emergency stop is never dropped, and in a state it stops the motor in
+     * the motor is stopped right here, before the dispatcher gets to it.
+     */
+    bool postEvent(EventId event, int menu = -1, TickType_t wait = 0);
+
+    // The emergency stop: halts the motor and releases it
+    void stopMotorNow() {
+        stepper->forceStop();
+        stepper->disableOutputs();
+    }
+
     // Implement the interface methods
     template <typename EventType>
-    void process_event(const EventType &event) {
-        sm->process_event(event);
+    bool process_event(const EventType &event) {
+        static_assert(EventIdOf<EventType>::value != EventId::internal,
+                      "Only events with an EventId can be posted");
+        return postEvent(EventIdOf<EventType>::value, -1,
+                         pdMS_TO_TICKS(Config::Advanced::eventPostWaitMs));
     }
-    void ble_click(String commandString) {
-        // Visit current state to handle state-specific commands
-
+    void ble_click(const char *command, size_t length) {
+        OSSM_PROFILE_SCOPE(bleCommand);
         ESP_LOGD("OSSM", "PROCESSING CLICK");
-        CommandValue command = commandFromString(commandString);
-        ESP_LOGD("OSSM", "COMMAND: %d", command.command);
+        ble_command(commandFromString(std::string_view(command, length)));
+    }
 
-        String currentState;
-        sm->visit_current_states(
-            [&currentState](auto state) { currentState = state.c_str(); });
+    void ble_command(const CommandValue &command) {
+        ESP_LOGD("OSSM", "COMMAND: %d", command.command);
+        TickType_t postWait = pdMS_TO_TICKS(Config::Advanced::eventPostWaitMs);
 
         switch (command.command) {
             case Commands::goToStrokeEngine:
-                menuOption = Menu::StrokeEngine;
-                sm->process_event(ButtonPress{});
+                postEvent(EventId::buttonPress, Menu::StrokeEngine, postWait);
                 break;
             case Commands::goToSimplePenetration:
-                menuOption = Menu::SimplePenetration;
-                sm->process_event(ButtonPress{});
+                postEvent(EventId::buttonPress, Menu::SimplePenetration,
+                          postWait);
                 break;
             case Commands::goToStreaming:
-                menuOption = Menu::Streaming;
-                sm->process_event(ButtonPress{});
+                postEvent(EventId::buttonPress, Menu::Streaming, postWait);
                 break;
             case Commands::goToMenu:
-                sm->process_event(LongPress{});
+                postEvent(EventId::longPress);
                 break;
             case Commands::setSpeed:
                 // BLE devices can be trusted to send true value
                 // and can bypass potentiomer smoothing logic
                 lastSpeedCommandWasFromBLE = true;
+                updateSpeedRamp([](SpeedRamp &ramp) { ramp = SpeedRamp(); });
                 // Use speed knob config to determine how to handle BLE speed
                 // command
-                setting.speedBLE = command.value;
+                updateSetting([&](SettingPercents &s) {
+                    s.speedBLE = percentOf(command.value);
+                });
                 break;
+            // The setting keeps its decimals, the encoder follows after it
+            // in whole steps
             case Commands::setStroke:
                 playControl = PlayControls::STROKE;
-                encoder.setEncoderValue(command.value);
-                setting.stroke = command.value;
+                updateSetting([&](SettingPercents &s) {
+                    s.stroke = percentOf(command.value);
+                });
+                encoder.setEncoderValue(lround(percentOf(command.value)));
                 break;
             case Commands::setDepth:
                 playControl = PlayControls::DEPTH;
-                encoder.setEncoderValue(command.value);
-                setting.depth = command.value;
+                updateSetting([&](SettingPercents &s) {
+                    s.depth = percentOf(command.value);
+                });
+                encoder.setEncoderValue(lround(percentOf(command.value)));
                 break;
             case Commands::setSensation:
                 playControl = PlayControls::SENSATION;
-                encoder.setEncoderValue(command.value);
-                setting.sensation = command.value;
+                updateSetting([&](SettingPercents &s) {
+                    s.sensation = percentOf(command.value);
+                });
+                encoder.setEncoderValue(lround(percentOf(command.value)));
                 break;
             case Commands::setPattern:
-                setting.pattern =
-                    static_cast<StrokePatterns>(command.value % 9);
+                updateSetting([&](SettingPercents &s) {
+                    s.pattern = static_cast<StrokePatterns>(
+                        command.value / setValueScale % patternTableSize);
+                });
+                break;
+            case Commands::setValues:
+                setValues(command);
+                break;
+            case Commands::streamPosition:
+                moveTo(command.value, command.time);
+                break;
+            case Commands::playScript:
+                playScript(command.value);
+                break;
+            case Commands::pauseScript:
+                pauseScript();
                 break;
             case Commands::ignore:
                 break;
         }
     }
 
-    void moveTo(float intensity, uint16_t inTime) {
-        targetPosition = constrain(intensity, 0.0f, 100.0f);
-        targetTime = inTime;
+    // Applies the values of a setValues command as a single publish, so the
+    // motion tasks never see only some of them.
+    void setValues(const CommandValue &command) {
+        auto has = [&](SetValue value) {
+            return (command.value & (1 << value)) != 0;
+        };
+
+        if (has(setValueSpeed)) {
+            lastSpeedCommandWasFromBLE = true;
+            updateSpeedRamp([](SpeedRamp &ramp) { ramp = SpeedRamp(); });
+        }
+
+        updateSetting([&](SettingPercents &s) {
+            if (has(setValueSpeed)) {
+                s.speedBLE = percentOf(command.values[setValueSpeed]);
+            }
+            if (has(setValueStroke)) {
+                s.stroke = percentOf(command.values[setValueStroke]);
+            }
+            if (has(setValueDepth)) {
+                s.depth = percentOf(command.values[setValueDepth]);
+            }
+            if (has(setValueSensation)) {
+                s.sensation = percentOf(command.values[setValueSensation]);
+            }
+            if (has(setValuePattern)) {
+                s.pattern = static_cast<StrokePatterns>(
+                    command.values[setValuePattern] / setValueScale %
+                    patternTableSize);
+            }
+        });
+
+        // The encoder keeps the control it is on, with its new value
+        int controlValue = -1;
+        if (playControl == PlayControls::STROKE && has(setValueStroke)) {
+            controlValue = command.values[setValueStroke];
+        } else if (playControl == PlayControls::DEPTH &&
+                   has(setValueDepth)) {
+            controlValue = command.values[setValueDepth];
+        } else if (playControl == PlayControls::SENSATION &&
+                   has(setValueSensation)) {
+            controlValue = command.values[setValueSensation];
+        }
+        if (controlValue >= 0) {
+            encoder.setEncoderValue(lround(percentOf(controlValue)));
+        }
+    }
+
+    // Streams a position (0-100 of the selected stroke) to be reached in
+    // inTime ms. Only has an effect in "streaming.idle".
+    void moveTo(float intensity, uint16_t inTime);
+
+    // Plays the preloaded script from time ms instead of following streamed
+    // positions, or goes back to them. Only has an effect in
+    // "streaming.idle".
+    void playScript(uint32_t time);
+    void pauseScript();
+
+    // Writes the current state as JSON into buffer, returns the length.
+    // Truncated if the buffer is too small, 160 bytes always fit.
+    size_t getCurrentState(char *buffer, size_t size) {
+        OSSM_PROFILE_SCOPE(stateJson);
+        LinkStatus link;
+        bool connected = hasActiveBLEConnection;
+        if (connected) {
+            portENTER_CRITICAL(&bleLinkLock);
+            link = bleLink;
+            portEXIT_CRITICAL(&bleLinkLock);
+        }
+
+        return formatStateJson(buffer, size, stateName(currentStateId.load()),
+                               setting.load(), connected ? &link : nullptr);
     }
 
-    // get current state
-    String getCurrentState() {
-        String currentState;
-        sm->visit_current_states(
-            [&currentState](auto state) { currentState = state.c_str(); });
-
-        String json = "{";
-        json += "\"state\":\"" + currentState + "\",";
-        json += "\"speed\":" + String((int)setting.speed) + ",";
-        json += "\"stroke\":" + String((int)setting.stroke) + ",";
-        json += "\"sensation\":" + String((int)setting.sensation) + ",";
-        json += "\"depth\":" + String((int)setting.depth) + ",";
-        json += "\"pattern\":" + String(static_cast<int>(setting.pattern));
-        json += "}";
-        currentState = json;
-
-        return currentState;
+    StateSnapshot getStateSnapshot() {
+        SettingPercents current = setting.load();
+        return {.state = static_cast<uint8_t>(currentStateId.load()),
+                .speed = static_cast<uint8_t>(current.speed),
+                .stroke = static_cast<uint8_t>(current.stroke),
+                .sensation = static_cast<uint8_t>(current.sensation),
+                .depth = static_cast<uint8_t>(current.depth),
+                .pattern = static_cast<uint8_t>(current.pattern),
+                .sequence = 0,
+                .strokes = session.getStrokes(),
+                .distance = uint32_t(session.getSteps() /
+                                     Config::Driver::stepsPerMM)};
     }
 
     // BLE command tracking methods
@@ -480,6 +800,12 @@ class OSSM : public OSSMInterface {
     void setBLEConnectionStatus(bool isConnected) {
         hasActiveBLEConnection = isConnected;
     }
+
+    void setBLELinkStatus(const LinkStatus &link) {
+        portENTER_CRITICAL(&bleLinkLock);
+        bleLink = link;
+        portEXIT_CRITICAL(&bleLinkLock);
+    }
 };
 
 extern OSSM *ossm;
@@ -4,6 +4,9 @@
 #include <Arduino.h>
 
 #include "Events.h"  // for your event types like emergencyStop, home, etc.
+#include "structs/CommandValue.h"
+#include "structs/LinkStatus.h"
+#include "structs/StateSnapshot.h"
 
 class OSSMInterface {
   public:
@@ -11,16 +14,25 @@ class OSSMInterface {
     template <typename EventType>
     void process_event(const EventType& event);  // Ensure proper type handling
 
-    virtual void ble_click(String command) = 0;
+    virtual void ble_click(const char* command, size_t length) = 0;
+    // Same as ble_click, for commands that are already decoded
+    virtual void ble_command(const CommandValue& command) = 0;
     virtual void moveTo(float intensity = 0,
                         uint16_t inTime = 0) = 0;  // intensity: 0-10
 
-    // get current state
-    virtual String getCurrentState() = 0;
+    // Writes the current state as JSON into buffer, returns the length
+    virtual size_t getCurrentState(char* buffer, size_t size) = 0;
+    // Cheap alternative to getCurrentState, the sequence is left at 0
+    virtual StateSnapshot getStateSnapshot() = 0;
     virtual int getSpeed() = 0;
+    // Eases the speed over to target (0-100) within durationMs, carried out
+    // by the motion task itself
+    virtual void rampSpeed(float target, uint32_t durationMs) = 0;
 
     // BLE connection tracking
     virtual void setBLEConnectionStatus(bool isConnected) = 0;
+    // Parameters of the newest connection, shown in the state
+    virtual void setBLELinkStatus(const LinkStatus& link) = 0;
 
     // target position
     uint16_t targetPosition;
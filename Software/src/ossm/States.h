@@ -0,0 +1,174 @@
+#ifndef OSSM_SOFTWARE_STATES_H
+#define OSSM_SOFTWARE_STATES_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+// Numeric ids for the states in the OSSM state machine (OSSM.h). The ids are
+// part of the BLE protocol, only append new states at the end.
+enum class StateId : uint8_t {
+    idle,
+    homing,
+    homingForward,
+    homingBackward,
+    menu,
+    menuIdle,
+    simplePenetration,
+    simplePenetrationIdle,
+    simplePenetrationPreflight,
+    strokeEngine,
+    strokeEngineIdle,
+    strokeEnginePreflight,
+    strokeEnginePattern,
+    streaming,
+    streamingIdle,
+    streamingPreflight,
+    update,
+    updateChecking,
+    updateUpdating,
+    updateIdle,
+    wifi,
+    wifiIdle,
+    help,
+    helpIdle,
+    error,
+    errorIdle,
+    errorHelp,
+    restart,
+    homingQuick,
+    autoTune,
+    autoTuneRunning,
+    autoTuneIdle,
+
+    unknown = 0xFF
+};
+
+// Indexed by StateId
+static constexpr const char* stateNames[] = {
+    "idle",
+    "homing",
+    "homing.forward",
+    "homing.backward",
+    "menu",
+    "menu.idle",
+    "simplePenetration",
+    "simplePenetration.idle",
+    "simplePenetration.preflight",
+    "strokeEngine",
+    "strokeEngine.idle",
+    "strokeEngine.preflight",
+    "strokeEngine.pattern",
+    "streaming",
+    "streaming.idle",
+    "streaming.preflight",
+    "update",
+    "update.checking",
+    "update.updating",
+    "update.idle",
+    "wifi",
+    "wifi.idle",
+    "help",
+    "help.idle",
+    "error",
+    "error.idle",
+    "error.help",
+    "restart",
+    "homing.quick",
+    "autoTune",
+    "autoTune.running",
+    "autoTune.idle",
+};
+
+static constexpr size_t stateCount = sizeof(stateNames) / sizeof(stateNames[0]);
+
+// Compares the first length characters, or up to the end of a if length is
+// negative.
+constexpr bool stateNameEquals(const char* a, const char* b, int length = -1) {
+    for (int i = 0; length < 0 || i < length; i++) {
+        if (a[i] != b[i]) {
+            return false;
+        }
+        if (a[i] == '\0') {
+            return true;
+        }
+    }
+    return b[length] == '\0';
+}
+
+constexpr StateId stateIdFromName(const char* name, int length = -1) {
+    for (size_t i = 0; i < stateCount; i++) {
+        if (stateNameEquals(name, stateNames[i], length)) {
+            return static_cast<StateId>(i);
+        }
+    }
+    return StateId::unknown;
+}
+
+// The top level state a state belongs to, e.g. strokeEngine for
+// strokeEngine.idle. Top level states are their own mode.
+constexpr StateId modeOf(StateId id) {
+    size_t index = static_cast<size_t>(id);
+    if (index >= stateCount) {
+        return StateId::unknown;
+    }
+
+    const char* name = stateNames[index];
+    for (int i = 0; name[i] != '\0'; i++) {
+        if (name[i] == '.') {
+            return stateIdFromName(name, i);
+        }
+    }
+    return id;
+}
+
+static_assert(modeOf(StateId::strokeEngineIdle) == StateId::strokeEngine,
+              "modeOf must resolve the parent state");
+
+// Modes that drive the machine from live settings or positions. The BLE
+// link and the radio are tuned for latency while one runs.
+constexpr bool isPlayMode(StateId id) {
+    StateId mode = modeOf(id);
+    return mode == StateId::simplePenetration ||
+           mode == StateId::strokeEngine || mode == StateId::streaming;
+}
+
+// States a long press leaves with an emergency stop, see the longPress rows
+// in OSSM.h. Any other state a long press leaves lets the motor be.
+constexpr bool hasEmergencyStop(StateId id) {
+    return (isPlayMode(id) && id != StateId::simplePenetrationPreflight) ||
+           id == StateId::autoTuneRunning;
+}
+
+inline const char* stateName(StateId id) {
+    size_t index = static_cast<size_t>(id);
+    return index < stateCount ? stateNames[index] : "unknown";
+}
+
+// Published by the StateLogger on every state change.
+extern std::atomic<StateId> currentStateId;
+extern std::atomic<StateId> currentModeId;
+
+/**
+ * Lock free state checks for tasks. Unlike sm->is(...) these never take the
+ * state machine mutex. The ids are published before the transition's action
+ * runs, so a task started from an action already sees its own state.
+ */
+inline StateId getStateId() {
+    return currentStateId.load(std::memory_order_relaxed);
+}
+
+inline StateId getModeId() {
+    return currentModeId.load(std::memory_order_relaxed);
+}
+
+template <typename... Ids>
+inline bool isInState(Ids... ids) {
+    StateId id = getStateId();
+    return ((id == ids) || ...);
+}
+
+// True for the mode itself and all of its sub states
+inline bool isInMode(StateId mode) { return getModeId() == mode; }
+
+#endif  // OSSM_SOFTWARE_STATES_H
@@ -0,0 +1,140 @@
+#include "adc.h"
+
+#include <atomic>
+
+#include "constants/LogTags.h"
+#include "constants/Pins.h"
+#include "services/tasks.h"
+#include "utils/filters.h"
+
+/**
+ * The speed pot and the current sensor are sampled at roughly 1kHz by a
+ * background task and the filtered values are kept in atomics, so readers
+ * never have to run their own blocking analogRead loops.
+ *
+ * On Arduino-ESP32 3.x the ADC runs in continuous (DMA) mode and the task only
+ * wakes up when a frame is done. Older cores fall back to analogRead.
+ */
+
+struct AdcChannelState {
+    int pin;
+    std::atomic<AdcFilter> filter;
+    IirFilter iir;
+    MedianFilter<5> median;
+    std::atomic<float> percent;
+    std::atomic<AdcSampleCallback> callback;
+};
+
+static AdcChannelState channels[] = {
+    {Pins::Remote::speedPotPin, {AdcFilter::median}, IirFilter(0.1f), {}, {0},
+     {nullptr}},
+    {Pins::Driver::currentSensorPin, {AdcFilter::iir}, IirFilter(0.05f), {},
+     {0}, {nullptr}},
+};
+
+static constexpr size_t channelCount = sizeof(channels) / sizeof(channels[0]);
+
+static TaskHandle_t adcTaskH = nullptr;
+
+static void feedSample(AdcChannelState &channel, int raw) {
+    float sample = 100.0f * raw / 4096.0f;  // 12 bit resolution
+
+    // Both filters keep running so switching between them is seamless
+    float iir = channel.iir.update(sample);
+    float median = channel.median.update(sample);
+
+    channel.percent.store(channel.filter.load() == AdcFilter::iir ? iir
+                                                                   : median,
+                          std::memory_order_relaxed);
+
+    AdcSampleCallback callback = channel.callback.load();
+    if (callback != nullptr) {
+        callback(sample);
+    }
+}
+
+#if ESP_ARDUINO_VERSION_MAJOR >= 3
+
+static void ARDUINO_ISR_ATTR onConversionDone() {
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(adcTaskH, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+static void adcTask(void *pvParameters) {
+    adc_continuous_data_t *result = nullptr;
+
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        if (!analogContinuousRead(&result, 0)) {
+            continue;
+        }
+
+        // Results are in the same order as the pins passed to analogContinuous
+        for (size_t i = 0; i < channelCount; i++) {
+            feedSample(channels[i], result[i].avg_read_raw);
+        }
+    }
+}
+
+static bool startSampling() {
+    uint8_t pins[channelCount];
+    for (size_t i = 0; i < channelCount; i++) {
+        pins[i] = channels[i].pin;
+    }
+
+    analogContinuousSetWidth(12);
+    analogContinuousSetAtten(ADC_11db);
+
+    // 8 conversions per pin at 20kHz gives a filtered frame every ~0.8ms
+    if (!analogContinuous(pins, channelCount, 8, 20000, &onConversionDone)) {
+        return false;
+    }
+    return analogContinuousStart();
+}
+
+#else
+
+static void adcTask(void *pvParameters) {
+    TickType_t lastWakeTime = xTaskGetTickCount();
+
+    while (true) {
+        for (size_t i = 0; i < channelCount; i++) {
+            feedSample(channels[i], analogRead(channels[i].pin));
+        }
+        vTaskDelayUntil(&lastWakeTime, 1);
+    }
+}
+
+static bool startSampling() { return true; }
+
+#endif
+
+void initADC() {
+    // Seed the filters so the first reads are valid before the task runs
+    for (size_t i = 0; i < channelCount; i++) {
+        feedSample(channels[i], analogRead(channels[i].pin));
+    }
+
+    xTaskCreatePinnedToCore(adcTask, "adcTask", 3 * configMINIMAL_STACK_SIZE,
+                            nullptr, Tasks::inputPriority, &adcTaskH,
+                            Tasks::inputCore);
+
+    if (!startSampling()) {
+        ESP_LOGE("ADC", "Failed to start continuous ADC sampling");
+    }
+}
+
+float getADCPercent(AdcChannel channel) {
+    return channels[static_cast<int>(channel)].percent.load(
+        std::memory_order_relaxed);
+}
+
+void setADCFilter(AdcChannel channel, AdcFilter filter) {
+    channels[static_cast<int>(channel)].filter.store(filter);
+}
+
+void setADCSampleCallback(AdcChannel channel, AdcSampleCallback callback) {
+    channels[static_cast<int>(channel)].callback.store(callback);
+}
@@ -0,0 +1,29 @@
+#ifndef OSSM_SOFTWARE_ADC_H
+#define OSSM_SOFTWARE_ADC_H
+
+#include <Arduino.h>
+
+// Analog inputs that are sampled continuously in the background.
+enum class AdcChannel {
+    speedPot,
+    current,
+};
+
+enum class AdcFilter {
+    iir,     // smooth, for slowly changing values
+    median,  // rejects spikes, for knobs
+};
+
+void initADC();
+
+// Latest filtered reading in percent of the 12 bit range. Never blocks.
+float getADCPercent(AdcChannel channel);
+
+void setADCFilter(AdcChannel channel, AdcFilter filter);
+
+// Called from the sampling task with every unfiltered sample (in percent).
+// Keep it short. Pass nullptr to remove it.
+typedef void (*AdcSampleCallback)(float percent);
+void setADCSampleCallback(AdcChannel channel, AdcSampleCallback callback);
+
+#endif  // OSSM_SOFTWARE_ADC_H
@@ -20,6 +20,7 @@ void initBoard() {
 
     analogReadResolution(12);
     analogSetAttenuation(ADC_11db);  // allows us to read almost full 3.3V range
+    initADC();
     initStepper();
     initEncoder();
     initLED();
@@ -5,10 +5,20 @@
 #include <NimBLEDevice.h>
 
 #include "constants/Pins.h"
+#include "services/adc.h"
 #include "services/encoder.h"
 #include "services/stepper.h"
 #include "services/led.h"
 
+/**
+ * Fast boot: the driver reset, splash, WiFi and NimBLE start up side by side
+ * and the splash ends as soon as homing is done or the button is pressed.
+ * Build with -DOSSM_FAST_BOOT=0 for the original one after the other boot.
+ */
+#ifndef OSSM_FAST_BOOT
+#define OSSM_FAST_BOOT 1
+#endif
+
 extern bool USE_SPEED_KNOB_AS_LIMIT;
 void initBoard();
 
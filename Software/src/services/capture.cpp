@@ -0,0 +1,94 @@
+#include "capture.h"
+
+#include <Arduino.h>
+
+#include <cstring>
+
+#include "constants/LogTags.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "utils/TraceRing.h"
+
+#if OSSM_CAPTURE
+static TraceRing<CommandCaptureRecord, COMMAND_CAPTURE_LENGTH> commandCapture;
+static portMUX_TYPE captureLock = portMUX_INITIALIZER_UNLOCKED;
+
+void captureCommand(CaptureSource source, const uint8_t* data, size_t length) {
+    CommandCaptureRecord record;
+    record.timeUs = (uint32_t)esp_timer_get_time();
+    record.source = (uint8_t)source;
+    record.length = length < 255 ? length : 255;
+    size_t kept = length < COMMAND_CAPTURE_DATA ? length : COMMAND_CAPTURE_DATA;
+    memcpy(record.data, data, kept);
+    memset(record.data + kept, 0, COMMAND_CAPTURE_DATA - kept);
+
+    portENTER_CRITICAL(&captureLock);
+    commandCapture.record(record);
+    portEXIT_CRITICAL(&captureLock);
+}
+#endif
+
+void clearCapture() {
+#if OSSM_CAPTURE
+    portENTER_CRITICAL(&captureLock);
+    commandCapture.clear();
+    portEXIT_CRITICAL(&captureLock);
+#endif
+}
+
+size_t copyCapture(size_t first, CommandCaptureRecord* records, size_t max) {
+#if OSSM_CAPTURE
+    portENTER_CRITICAL(&captureLock);
+    size_t count = commandCapture.copyFrom(first, records, max);
+    portEXIT_CRITICAL(&captureLock);
+    return count;
+#else
+    return 0;
+#endif
+}
+
+size_t getCaptureSize() {
+#if OSSM_CAPTURE
+    portENTER_CRITICAL(&captureLock);
+    size_t size = commandCapture.size();
+    portEXIT_CRITICAL(&captureLock);
+    return size;
+#else
+    return 0;
+#endif
+}
+
+uint32_t getCaptureCount() {
+#if OSSM_CAPTURE
+    portENTER_CRITICAL(&captureLock);
+    uint32_t count = commandCapture.getRecordedCount();
+    portEXIT_CRITICAL(&captureLock);
+    return count;
+#else
+    return 0;
+#endif
+}
+
+// One line per record: time, source, length and the bytes in hex, so a log
+// can be turned back into a trace
+void dumpCapture() {
+    static const char* const sourceNames[] = {"text", "binary", "udp"};
+    ESP_LOGI(NIMBLE_TAG, "Command capture, %u records:",
+             (unsigned)getCaptureSize());
+
+    CommandCaptureRecord record;
+    for (size_t i = 0; copyCapture(i, &record, 1) == 1; i++) {
+        char hex[2 * COMMAND_CAPTURE_DATA + 1];
+        size_t kept = record.length < COMMAND_CAPTURE_DATA
+                          ? record.length
+                          : COMMAND_CAPTURE_DATA;
+        for (size_t j = 0; j < kept; j++) {
+            snprintf(hex + 2 * j, 3, "%02x", record.data[j]);
+        }
+        hex[2 * kept] = '\0';
+        const char* source =
+            record.source < 3 ? sourceNames[record.source] : "?";
+        ESP_LOGI(NIMBLE_TAG, "%10lu %-6s %3u %s",
+                 (unsigned long)record.timeUs, source, record.length, hex);
+    }
+}
@@ -0,0 +1,45 @@
+#ifndef OSSM_SOFTWARE_CAPTURE_H
+#define OSSM_SOFTWARE_CAPTURE_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "structs/CommandCaptureRecord.h"
+
+/**
+ * Command capture: every command write from the text and binary command
+ * characteristics and from UDP control goes into a RAM ring as it arrived,
+ * with its arrival time in µs, valid or not. The ring is downloaded over the
+ * capture characteristic or printed to the serial log, and played back on
+ * the host by the replayer of the simulator test to reproduce the write
+ * pattern of an app.
+ *
+ * Off by default, build with -DOSSM_CAPTURE=1. The ring takes 64 bytes per
+ * record. Without the flag captureCommand() compiles to nothing.
+ */
+#ifndef OSSM_CAPTURE
+#define OSSM_CAPTURE 0
+#endif
+
+#define COMMAND_CAPTURE_LENGTH 256
+
+#if OSSM_CAPTURE
+void captureCommand(CaptureSource source, const uint8_t* data, size_t length);
+#else
+inline void captureCommand(CaptureSource, const uint8_t*, size_t) {}
+#endif
+
+// Empties the ring, the capture goes on with the next write
+void clearCapture();
+
+// Copies up to max records from index first of the ones held, oldest first
+size_t copyCapture(size_t first, CommandCaptureRecord* records, size_t max);
+
+// Records held, and all recorded since the last clear
+size_t getCaptureSize();
+uint32_t getCaptureCount();
+
+// Prints the held records to the serial log, oldest first
+void dumpCapture();
+
+#endif  // OSSM_SOFTWARE_CAPTURE_H
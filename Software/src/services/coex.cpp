@@ -0,0 +1,148 @@
+#include "coex.h"
+
+#include <Arduino.h>
+#include <WiFi.h>
+
+#include "constants/Config.h"
+#include "constants/LogTags.h"
+#include "esp_coexist.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "ossm/States.h"
+#include "services/netlog.h"
+#include "services/tasks.h"
+#include "services/udp.h"
+#include "services/wm.h"
+#include "utils/ConnEventMonitor.h"
+
+// Only the WiFi these builds use for control or the log keeps it awake
+static constexpr bool isWifiControl = OSSM_UDP_CONTROL || OSSM_NET_LOG;
+
+// Written by the BLE host task, read by the coexistence task and the
+// characteristic
+static ConnEventMonitor monitor;
+static uint16_t lastInterval = 0;
+static CoexPolicy policy = static_cast<CoexPolicy>(OSSM_COEX_POLICY);
+static bool isConnected = false;
+static CoexPlan plan;
+static uint32_t planSinceMs = 0;
+static portMUX_TYPE coexLock = portMUX_INITIALIZER_UNLOCKED;
+
+static void applyPlan(const CoexPlan& next, const CoexPlan& previous) {
+    esp_coex_preference_set(next.isBlePreferred ? ESP_COEX_PREFER_BT
+                                                : ESP_COEX_PREFER_BALANCE);
+
+    if (next.wifi == CoexWifi::off) {
+        WiFi.disconnect(true);
+        return;
+    }
+    if (previous.wifi == CoexWifi::off) {
+        connectWiFi();
+    }
+    WiFi.setSleep(next.wifi == CoexWifi::sleep ? WIFI_PS_MAX_MODEM
+                                               : WIFI_PS_MIN_MODEM);
+}
+
+// The counts of the plan that ends, before they start over
+static void logPeriod(const CoexRecord& record) {
+    if (record.events == 0) {
+        return;
+    }
+    ESP_LOGI(COEX_TAG,
+             "%lu of %lu connection events missed (%.2f%%), worst run %u, "
+             "in %lums with BLE %s, WiFi %s",
+             (unsigned long)record.missed, (unsigned long)record.events,
+             100.0f * record.missed / record.events, record.worstRun,
+             (unsigned long)record.periodMs,
+             record.isBlePreferred ? "preferred" : "balanced",
+             coexWifiName((CoexWifi)record.wifi));
+}
+
+[[noreturn]] static void coexTask(void* pvParameters) {
+    while (true) {
+        portENTER_CRITICAL(&coexLock);
+        CoexPlan next = planCoex(policy, getStateId(), isConnected,
+                                 isWifiControl);
+        CoexPlan previous = plan;
+        portEXIT_CRITICAL(&coexLock);
+
+        if (next != previous) {
+            logPeriod(getCoexRecord());
+            ESP_LOGI(COEX_TAG, "%s in %s: BLE %s, WiFi %s",
+                     coexPolicyName(getCoexPolicy()), stateName(getStateId()),
+                     next.isBlePreferred ? "preferred" : "balanced",
+                     coexWifiName(next.wifi));
+            applyPlan(next, previous);
+
+            portENTER_CRITICAL(&coexLock);
+            plan = next;
+            planSinceMs = millis();
+            monitor.reset();
+            portEXIT_CRITICAL(&coexLock);
+        }
+
+        vTaskDelay(pdMS_TO_TICKS(Config::Advanced::coexPollMs));
+    }
+}
+
+void initCoex() {
+    planSinceMs = millis();
+    xTaskCreatePinnedToCore(coexTask, "coexTask", 3 * configMINIMAL_STACK_SIZE,
+                            nullptr, Tasks::renderPriority, nullptr,
+                            Tasks::renderCore);
+}
+
+void setCoexConnected(bool connected) {
+    portENTER_CRITICAL(&coexLock);
+    isConnected = connected;
+    // A new client has a cadence of its own
+    monitor.reset();
+    portEXIT_CRITICAL(&coexLock);
+}
+
+void noteClientWrite(uint16_t interval) {
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&coexLock);
+    monitor.record(now, interval);
+    lastInterval = interval;
+    portEXIT_CRITICAL(&coexLock);
+}
+
+void setCoexPolicy(CoexPolicy next) {
+    portENTER_CRITICAL(&coexLock);
+    policy = next;
+    portEXIT_CRITICAL(&coexLock);
+}
+
+CoexPolicy getCoexPolicy() {
+    portENTER_CRITICAL(&coexLock);
+    CoexPolicy current = policy;
+    portEXIT_CRITICAL(&coexLock);
+    return current;
+}
+
+CoexRecord getCoexRecord() {
+    CoexRecord record = {};
+    uint32_t now = millis();
+    portENTER_CRITICAL(&coexLock);
+    record.policy = (uint8_t)policy;
+    record.isBlePreferred = plan.isBlePreferred;
+    record.wifi = (uint8_t)plan.wifi;
+    record.events = monitor.getEvents();
+    record.missed = monitor.getMissed();
+    uint32_t worstRun = monitor.getWorstRun();
+    record.worstRun = worstRun < 0xFFFF ? worstRun : 0xFFFF;
+    record.interval = lastInterval;
+    record.cadenceUs = monitor.getCadenceUs();
+    record.periodMs = now - planSinceMs;
+    portEXIT_CRITICAL(&coexLock);
+    record.isWifiUp = WiFi.status() == WL_CONNECTED;
+    return record;
+}
+
+void resetCoexStats() {
+    portENTER_CRITICAL(&coexLock);
+    monitor.reset();
+    planSinceMs = millis();
+    portEXIT_CRITICAL(&coexLock);
+}
@@ -0,0 +1,42 @@
+#ifndef OSSM_SOFTWARE_COEX_H
+#define OSSM_SOFTWARE_COEX_H
+
+#include <cstdint>
+
+#include "structs/CoexRecord.h"
+#include "utils/CoexPlan.h"
+
+/**
+ * Radio sharing of WiFi and BLE, see CoexPlan.h for the policies. A low
+ * priority task checks the state and the BLE connection every
+ * Config::Advanced::coexPollMs and changes the coexistence preference, the
+ * modem sleep and the WiFi connection when the plan changes.
+ *
+ * Writes to the command characteristics are timed to count missed
+ * connection events, see ConnEventMonitor. The counts start over on every
+ * plan change, the old ones go to the log, so policies can be compared.
+ *
+ * The policy defaults to OSSM_COEX_POLICY (0 balanced, 1 preferBle,
+ * 2 bleOnly) and can be changed until the next restart over the
+ * coexistence characteristic.
+ */
+#ifndef OSSM_COEX_POLICY
+#define OSSM_COEX_POLICY 1
+#endif
+
+// Starts the coexistence task
+void initCoex();
+
+// Called by the BLE host task on connection changes
+void setCoexConnected(bool isConnected);
+
+// Called by the BLE host task for every command write
+void noteClientWrite(uint16_t interval);
+
+void setCoexPolicy(CoexPolicy policy);
+CoexPolicy getCoexPolicy();
+
+CoexRecord getCoexRecord();
+void resetCoexStats();
+
+#endif  // OSSM_SOFTWARE_COEX_H
@@ -0,0 +1,83 @@
+#ifndef OSSM_COMMUNICATION_BINARY_HPP
+#define OSSM_COMMUNICATION_BINARY_HPP
+
+#include "NimBLECharacteristic.h"
+#include "NimBLEService.h"
+#include "NimBLEUUID.h"
+#include "command/frames.hpp"
+#include "events.h"
+#include "latency.hpp"
+#include "queue.h"
+#include "services/capture.h"
+#include "services/coex.h"
+#include "services/led.h"
+
+/** Handler class for the binary command characteristic */
+class BinaryCommandCallbacks : public NimBLECharacteristicCallbacks {
+    void onWrite(NimBLECharacteristic* pCharacteristic,
+                 NimBLEConnInfo& connInfo) override {
+        NimBLEAttValue frame = pCharacteristic->getValue();
+        captureCommand(CaptureSource::binary, frame.data(), frame.length());
+        noteClientWrite(connInfo.getConnInterval());
+
+        CommandValue command;
+        uint8_t seq = 0;
+        FrameStatus status =
+            decodeCommandFrame(frame.data(), frame.length(), command, seq);
+
+        if (status == FrameStatus::ok && !isCommandAllowed(command)) {
+            status = FrameStatus::notReady;
+        }
+
+        // Frames with a sequence number are probed for latency, unless they
+        // have to wait behind others in the queue
+        if (status == FrameStatus::ok && commandQueue.empty()) {
+            size_t payload = commandFramePayload(frame.data(), frame.length());
+            if (frame.length() == payload + 1) {
+                beginLatency(seq);
+            }
+        }
+
+        if (status == FrameStatus::ok && !queueCommand(command)) {
+            status = FrameStatus::busy;
+        }
+
+        if (status != FrameStatus::ok) {
+            ESP_LOGD("NIMBLE_COMMAND", "Rejected frame, status: %d",
+                     (int)status);
+        }
+
+        // Acknowledge with the echoed sequence number and the status
+        uint8_t ack[2] = {seq, (uint8_t)status};
+        pCharacteristic->setValue(ack, sizeof(ack));
+        pCharacteristic->notify();
+
+        if (status == FrameStatus::ok) {
+            signalNimble(NimbleEvents::command);
+
+            // Trigger LED communication pulse for received command
+            pulseForCommunication();
+        }
+    }
+
+    void onStatus(NimBLECharacteristic* pCharacteristic, int code) override {
+        ESP_LOGV("NIMBLE_COMMAND",
+                 "Binary command notification return code: %d, %s", code,
+                 NimBLEUtils::returnCodeToString(code));
+    }
+} binaryCommandCallbacks;
+
+NimBLECharacteristic* initBinaryCommandCharacteristic(NimBLEService* pService,
+                                                      NimBLEUUID uuid) {
+    // Write without response keeps high rate slider updates cheap, the ack is
+    // available through notify or read.
+    NimBLECharacteristic* pChar = pService->createCharacteristic(
+        uuid, NIMBLE_PROPERTY::WRITE | NIMBLE_PROPERTY::WRITE_NR |
+                  NIMBLE_PROPERTY::READ | NIMBLE_PROPERTY::NOTIFY);
+
+    pChar->setCallbacks(&binaryCommandCallbacks);
+
+    return pChar;
+}
+
+#endif  // OSSM_COMMUNICATION_BINARY_HPP
@@ -0,0 +1,89 @@
+#ifndef OSSM_COMMUNICATION_CAPTURE_HPP
+#define OSSM_COMMUNICATION_CAPTURE_HPP
+
+#include "NimBLECharacteristic.h"
+#include "NimBLEService.h"
+#include "NimBLEUUID.h"
+#include "constants/LogTags.h"
+#include "esp_log.h"
+#include "link.hpp"
+#include "services/capture.h"
+
+// Writes to the capture characteristic
+namespace CaptureOpcode {
+    constexpr uint8_t clear = 0x01;
+    constexpr uint8_t dump = 0x02;      // Print to the serial log
+    constexpr uint8_t download = 0x03;  // [first u16], notify from there
+}
+
+/**
+ * Download of the command capture. Reads return the CommandCaptureHeader,
+ * a download notifies the records from the index written on, as many whole
+ * records per notification as the MTU allows, each behind the u16 index of
+ * its first record. If the host runs out of buffers the client writes the
+ * index it got to.
+ */
+class CaptureCallbacks : public NimBLECharacteristicCallbacks {
+    void onRead(NimBLECharacteristic* pCharacteristic,
+                NimBLEConnInfo& connInfo) override {
+        CommandCaptureHeader header = {getCaptureCount(),
+                                       (uint16_t)getCaptureSize(),
+                                       sizeof(CommandCaptureRecord),
+                                       OSSM_CAPTURE};
+        pCharacteristic->setValue((uint8_t*)&header, sizeof(header));
+    }
+
+    void onWrite(NimBLECharacteristic* pCharacteristic,
+                 NimBLEConnInfo& connInfo) override {
+        NimBLEAttValue value = pCharacteristic->getValue();
+        const uint8_t* data = value.data();
+        size_t length = value.length();
+        uint8_t opcode = length > 0 ? data[0] : 0;
+
+        if (opcode == CaptureOpcode::clear && length == 1) {
+            clearCapture();
+        } else if (opcode == CaptureOpcode::dump && length == 1) {
+            dumpCapture();
+        } else if (opcode == CaptureOpcode::download && length == 3) {
+            download(pCharacteristic, connInfo, data[1] | (data[2] << 8));
+        } else {
+            ESP_LOGW(NIMBLE_TAG, "Invalid capture write");
+        }
+    }
+
+    static void download(NimBLECharacteristic* pCharacteristic,
+                         NimBLEConnInfo& connInfo, size_t first) {
+        size_t limit = min((size_t)(connInfo.getMTU() - 3),
+                           (size_t)(LinkTuning::preferredMtu - 3));
+        size_t perChunk = (limit - 2) / sizeof(CommandCaptureRecord);
+        uint8_t chunk[LinkTuning::preferredMtu - 3];
+        CommandCaptureRecord* records = (CommandCaptureRecord*)(chunk + 2);
+
+        size_t count;
+        while (perChunk > 0 &&
+               (count = copyCapture(first, records, perChunk)) > 0) {
+            chunk[0] = first & 0xFF;
+            chunk[1] = first >> 8;
+            size_t chunkLength = 2 + count * sizeof(CommandCaptureRecord);
+            if (!pCharacteristic->notify(chunk, chunkLength,
+                                         connInfo.getConnHandle())) {
+                ESP_LOGD(NIMBLE_TAG, "Capture paused at %u",
+                         (unsigned)first);
+                break;
+            }
+            first += count;
+        }
+    }
+} captureCallbacks;
+
+NimBLECharacteristic* initCaptureCharacteristic(NimBLEService* pService,
+                                                NimBLEUUID uuid) {
+    NimBLECharacteristic* pCaptureChar = pService->createCharacteristic(
+        uuid, NIMBLE_PROPERTY::READ | NIMBLE_PROPERTY::WRITE |
+                  NIMBLE_PROPERTY::NOTIFY);
+    pCaptureChar->setCallbacks(&captureCallbacks);
+
+    return pCaptureChar;
+}
+
+#endif  // OSSM_COMMUNICATION_CAPTURE_HPP
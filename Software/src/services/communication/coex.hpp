@@ -0,0 +1,54 @@
+#ifndef OSSM_COMMUNICATION_COEX_HPP
+#define OSSM_COMMUNICATION_COEX_HPP
+
+#include "NimBLECharacteristic.h"
+#include "NimBLEService.h"
+#include "NimBLEUUID.h"
+#include "constants/LogTags.h"
+#include "esp_log.h"
+#include "services/coex.h"
+
+// Writes to the coexistence characteristic
+namespace CoexOpcode {
+    constexpr uint8_t reset = 0x01;   // Start the counts over
+    constexpr uint8_t policy = 0x02;  // [policy u8], until the next restart
+}
+
+/**
+ * Radio plan and missed connection events. Reads return the CoexRecord.
+ */
+class CoexCallbacks : public NimBLECharacteristicCallbacks {
+    void onRead(NimBLECharacteristic* pCharacteristic,
+                NimBLEConnInfo& connInfo) override {
+        CoexRecord record = getCoexRecord();
+        pCharacteristic->setValue((uint8_t*)&record, sizeof(record));
+    }
+
+    void onWrite(NimBLECharacteristic* pCharacteristic,
+                 NimBLEConnInfo& connInfo) override {
+        NimBLEAttValue value = pCharacteristic->getValue();
+        const uint8_t* data = value.data();
+        size_t length = value.length();
+        uint8_t opcode = length > 0 ? data[0] : 0;
+
+        if (opcode == CoexOpcode::reset && length == 1) {
+            resetCoexStats();
+        } else if (opcode == CoexOpcode::policy && length == 2 &&
+                   data[1] <= (uint8_t)CoexPolicy::bleOnly) {
+            setCoexPolicy((CoexPolicy)data[1]);
+        } else {
+            ESP_LOGW(NIMBLE_TAG, "Invalid coexistence write");
+        }
+    }
+} coexCallbacks;
+
+NimBLECharacteristic* initCoexCharacteristic(NimBLEService* pService,
+                                             NimBLEUUID uuid) {
+    NimBLECharacteristic* pCoexChar = pService->createCharacteristic(
+        uuid, NIMBLE_PROPERTY::READ | NIMBLE_PROPERTY::WRITE);
+    pCoexChar->setCallbacks(&coexCallbacks);
+
+    return pCoexChar;
+}
+
+#endif  // OSSM_COMMUNICATION_COEX_HPP
@@ -1,36 +1,70 @@
 #ifndef OSSM_COMMUNICATION_COMMAND_HPP
 #define OSSM_COMMUNICATION_COMMAND_HPP
 
-#include <queue>
-#include <regex>
+#include <algorithm>
 
 #include "Arduino.h"
 #include "NimBLECharacteristic.h"
 #include "NimBLEService.h"
 #include "NimBLEUUID.h"
+#include "command/commands.hpp"
+#include "events.h"
 #include "queue.h"
+#include "services/capture.h"
+#include "services/coex.h"
 #include "services/led.h"
 
-static const std::regex commandRegex(
-    R"(go:(simplePenetration|strokeEngine|menu)|set:(speed|stroke|depth|sensation|pattern):\d+)");
-
 /** Handler class for characteristic actions */
 class CharacteristicCallbacks : public NimBLECharacteristicCallbacks {
     uint32_t lastWriteTime = 0;
     float writeHz = 0;
     const float alpha = 0.1;  // Smoothing factor for exponential moving average
 
+    // Answers with "fail:<command>", long commands are truncated
+    static void fail(NimBLECharacteristic* pCharacteristic,
+                     std::string_view cmd) {
+        char response[64];
+        int length = snprintf(response, sizeof(response), "fail:%.*s",
+                              (int)cmd.size(), cmd.data());
+        pCharacteristic->setValue(
+            (uint8_t*)response,
+            std::min((size_t)length, sizeof(response) - 1));
+    }
+
     void onWrite(NimBLECharacteristic* pCharacteristic,
                  NimBLEConnInfo& connInfo) override {
-        std::string cmd = pCharacteristic->getValue();
+        // View of the received bytes, the command is never copied
+        NimBLEAttValue value = pCharacteristic->getValue();
+        std::string_view cmd((const char*)value.data(), value.length());
+        captureCommand(CaptureSource::text, value.data(), value.length());
+        noteClientWrite(connInfo.getConnInterval());
+
+        // Decode here so the queue only holds plain values
+        CommandValue command = {Commands::ignore, 0};
+        if (!parseCommand(cmd.data(), cmd.size(), command)) {
+            ESP_LOGD("NIMBLE_COMMAND", "Invalid command: %.*s",
+                     (int)cmd.size(), cmd.data());
+            fail(pCharacteristic, cmd);
+            return;
+        }
 
-        if (!std::regex_match(cmd, commandRegex)) {
-            ESP_LOGD("NIMBLE_COMMAND", "Invalid command: %s", cmd.c_str());
-            pCharacteristic->setValue("fail:" + String(cmd.c_str()));
+        if (!isCommandAllowed(command)) {
+            ESP_LOGD("NIMBLE_COMMAND", "Not homed yet: %.*s", (int)cmd.size(),
+                     cmd.data());
+            fail(pCharacteristic, cmd);
             return;
         }
-        messageQueue.push(String(cmd.c_str()));
-        
+
+        if (!queueCommand(command)) {
+            ESP_LOGW("NIMBLE_COMMAND", "Command queue full, dropped: %.*s (%u)",
+                     (int)cmd.size(), cmd.data(),
+                     commandQueue.getOverflowCount());
+            fail(pCharacteristic, cmd);
+            return;
+        }
+
+        signalNimble(NimbleEvents::command);
+
         // Trigger LED communication pulse for received command
         pulseForCommunication();
     }
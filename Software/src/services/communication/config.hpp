@@ -6,6 +6,7 @@
 #include <NimBLEUUID.h>
 
 #include "Arduino.h"
+#include "components/HeaderBar.h"
 
 /** Handler class for speed knob config characteristic */
 class SpeedKnobConfigCallbacks : public NimBLECharacteristicCallbacks {
@@ -35,6 +36,8 @@ class SpeedKnobConfigCallbacks : public NimBLECharacteristicCallbacks {
                      configValue.c_str());
             pCharacteristic->setValue(String(FPSTR(error_invalid)));
         }
+
+        notifyHeaderBar();
     }
 
     void onRead(NimBLECharacteristic* pCharacteristic,
@@ -0,0 +1,29 @@
+#ifndef OSSM_COMMUNICATION_EVENTS_H
+#define OSSM_COMMUNICATION_EVENTS_H
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
+
+// Reasons to wake nimbleLoop. Anything that isn't signalled (e.g. an encoder
+// change) is picked up by the poll timeout.
+namespace NimbleEvents {
+    constexpr EventBits_t command = (1 << 0);
+    constexpr EventBits_t stateChange = (1 << 1);
+    constexpr EventBits_t connection = (1 << 2);
+    constexpr EventBits_t latency = (1 << 3);
+
+    constexpr EventBits_t all = command | stateChange | connection | latency;
+
+    // Upper bound on how stale a state notification may be
+    constexpr TickType_t pollTicks = pdMS_TO_TICKS(50);
+}
+
+extern EventGroupHandle_t nimbleEvents;
+
+inline void signalNimble(EventBits_t bits) {
+    if (nimbleEvents != nullptr) {
+        xEventGroupSetBits(nimbleEvents, bits);
+    }
+}
+
+#endif  // OSSM_COMMUNICATION_EVENTS_H
@@ -1,53 +1,51 @@
 #ifndef OSSM_GPIO_HPP
 #define OSSM_GPIO_HPP
 
-#include <regex>
-
 #include "Arduino.h"
 #include "NimBLECharacteristic.h"
 #include "NimBLEService.h"
 #include "NimBLEUUID.h"
+#include "command/gpio.hpp"
 #include "constants/LogTags.h"
-#include "constants/Pins.h"
+#include "services/outputs.h"
+
+class GPIOCallbacks : public NimBLECharacteristicCallbacks {
+    // "rule:..." writes set the outputs that follow the stroke
+    static void onRule(NimBLECharacteristic* pCharacteristic, const char* str,
+                       size_t length) {
+        int slot = 0;
+        GpioRule rule;
+        if (!parseGpioRule(str, length, slot, rule) ||
+            !setGpioRule(slot, rule)) {
+            static const char err[] PROGMEM = "error:invalid_rule";
+            ESP_LOGW(NIMBLE_TAG, "GPIO rule invalid: %.*s", (int)length, str);
+            pCharacteristic->setValue(String(FPSTR(err)));
+            return;
+        }
 
-// Simple helper to map 1-4 to actual board pins
-static int mapGpioIndexToPin(int index) {
-    switch (index) {
-        case 1:
-            return Pins::GPIO::pin1;
-        case 2:
-            return Pins::GPIO::pin2;
-        case 3:
-            return Pins::GPIO::pin3;
-        case 4:
-            return Pins::GPIO::pin4;
-        default:
-            return -1;
+        ESP_LOGD(NIMBLE_TAG, "GPIO rule %d set: %.*s", slot, (int)length, str);
+        pCharacteristic->setValue(String("ok:rule:") + slot);
     }
-}
 
-class GPIOCallbacks : public NimBLECharacteristicCallbacks {
     void onWrite(NimBLECharacteristic* pCharacteristic,
                  NimBLEConnInfo& /*connInfo*/) override {
-        std::string raw = pCharacteristic->getValue();
-        String input = String(raw.c_str());
-        input.trim();
-
-        static const std::regex rx(R"(^\s*(\d+)\s*:(low|high|0|1)\s*$)",
-                                   std::regex::icase);
+        NimBLEAttValue value = pCharacteristic->getValue();
+        if (value.length() >= 5 && memcmp(value.data(), "rule:", 5) == 0) {
+            onRule(pCharacteristic, (const char*)value.data(), value.length());
+            return;
+        }
 
-        if (!std::regex_match(raw, rx)) {
+        int index = 0;
+        bool isHigh = false;
+        if (!parseGpioCommand((const char*)value.data(), value.length(), index,
+                              isHigh)) {
             static const char err[] PROGMEM = "error:invalid_format";
-            ESP_LOGW(NIMBLE_TAG, "GPIO write invalid format: %s", raw.c_str());
+            ESP_LOGW(NIMBLE_TAG, "GPIO write invalid format: %.*s",
+                     (int)value.length(), (const char*)value.data());
             pCharacteristic->setValue(String(FPSTR(err)));
             return;
         }
 
-        int sep = input.indexOf(':');
-        int index = input.substring(0, sep).toInt();
-        String stateStr = input.substring(sep + 1);
-        stateStr.toLowerCase();
-
         int targetPin = mapGpioIndexToPin(index);
         if (targetPin < 0) {
             static const char err[] PROGMEM = "error:pin_out_of_range";
@@ -56,8 +54,8 @@ class GPIOCallbacks : public NimBLECharacteristicCallbacks {
             return;
         }
 
-        int level = (stateStr == "high" || stateStr == "1") ? HIGH : LOW;
-        digitalWrite(targetPin, level);
+        int level = isHigh ? HIGH : LOW;
+        writeGpio(index, isHigh);
 
         ESP_LOGD(NIMBLE_TAG, "GPIO set pin%d (GPIO %d) to %s", index, targetPin,
                  level == HIGH ? "HIGH" : "LOW");
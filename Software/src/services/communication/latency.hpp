@@ -0,0 +1,139 @@
+#ifndef OSSM_COMMUNICATION_LATENCY_HPP
+#define OSSM_COMMUNICATION_LATENCY_HPP
+
+#include <atomic>
+
+#include "NimBLECharacteristic.h"
+#include "NimBLEService.h"
+#include "NimBLEUUID.h"
+#include "constants/Config.h"
+#include "constants/LogTags.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "events.h"
+#include "services/stepper.h"
+#include "utils/LatencyProbe.h"
+
+/**
+ * Command latency: while a client is subscribed, binary commands carrying a
+ * sequence number are followed from the radio to the motor, one at a time.
+ * Each stage is stamped with esp_timer_get_time() by the task that reaches
+ * it, a one shot esp_timer that re-arms itself polls the stepper for the
+ * first step and the finished record is notified from nimbleLoop.
+ */
+static LatencyProbe latencyProbe;
+static portMUX_TYPE latencyLock = portMUX_INITIALIZER_UNLOCKED;
+static esp_timer_handle_t latencyTimer = nullptr;
+static NimBLECharacteristic* pLatencyCharacteristic = nullptr;
+
+static std::atomic<int> latencySubscribers{0};
+static int32_t latencyPosition = 0;  // Stepper position when applied
+static LatencyRecord latencyRecord = {};
+static bool latencyPending = false;
+
+static uint32_t latencyNow() { return (uint32_t)esp_timer_get_time(); }
+
+// Called by the BLE host task for every accepted frame with a sequence
+// number, before it is queued.
+static void beginLatency(uint8_t seq) {
+    if (latencySubscribers == 0) {
+        return;
+    }
+
+    portENTER_CRITICAL(&latencyLock);
+    bool started = latencyProbe.begin(seq, latencyNow());
+    portEXIT_CRITICAL(&latencyLock);
+
+    if (started) {
+        esp_timer_start_once(latencyTimer, Config::Advanced::latencyPollUs);
+    }
+}
+
+static void markLatency(LatencyStage stage) {
+    // Read before taking the lock, the stepper has a lock of its own
+    int32_t position =
+        stage == LatencyStage::applied ? stepper->getCurrentPosition() : 0;
+
+    portENTER_CRITICAL(&latencyLock);
+    if (latencyProbe.mark(stage, latencyNow()) &&
+        stage == LatencyStage::applied) {
+        latencyPosition = position;
+    }
+    portEXIT_CRITICAL(&latencyLock);
+}
+
+// Runs in the esp_timer task while a probe is active.
+static void pollLatency(void* arg) {
+    int32_t position = stepper->getCurrentPosition();
+    uint32_t now = latencyNow();
+    bool done = false;
+
+    portENTER_CRITICAL(&latencyLock);
+    if (latencyProbe.reached(LatencyStage::applied) &&
+        position != latencyPosition) {
+        latencyProbe.mark(LatencyStage::moving, now);
+    }
+    if (latencyProbe.reached(LatencyStage::moving) ||
+        latencyProbe.elapsed(now) >=
+            Config::Advanced::latencyTimeoutMs * 1000U) {
+        latencyRecord = latencyProbe.finish();
+        latencyPending = true;
+        done = true;
+    }
+    portEXIT_CRITICAL(&latencyLock);
+
+    // Only begin() arms the timer while it is idle, so this can't race
+    if (done) {
+        signalNimble(NimbleEvents::latency);
+    } else {
+        esp_timer_start_once(latencyTimer, Config::Advanced::latencyPollUs);
+    }
+}
+
+// Called from nimbleLoop, notifies the newest finished record.
+static void publishLatency() {
+    LatencyRecord record;
+    bool pending;
+
+    portENTER_CRITICAL(&latencyLock);
+    record = latencyRecord;
+    pending = latencyPending;
+    latencyPending = false;
+    portEXIT_CRITICAL(&latencyLock);
+
+    if (pending) {
+        pLatencyCharacteristic->setValue((uint8_t*)&record, sizeof(record));
+        pLatencyCharacteristic->notify();
+    }
+}
+
+/** Handler class for the command latency characteristic */
+class LatencyCallbacks : public NimBLECharacteristicCallbacks {
+    // Commands are only probed while someone listens for the records.
+    void onSubscribe(NimBLECharacteristic* pCharacteristic,
+                     NimBLEConnInfo& connInfo, uint16_t subValue) override {
+        if (subValue > 0) {
+            latencySubscribers++;
+        } else if (latencySubscribers > 0) {
+            latencySubscribers--;
+        }
+        ESP_LOGD(NIMBLE_TAG, "Latency subscribers: %d",
+                 (int)latencySubscribers);
+    }
+} latencyCallbacks;
+
+NimBLECharacteristic* initLatencyCharacteristic(NimBLEService* pService,
+                                                NimBLEUUID uuid) {
+    pLatencyCharacteristic = pService->createCharacteristic(
+        uuid, NIMBLE_PROPERTY::READ | NIMBLE_PROPERTY::NOTIFY);
+    pLatencyCharacteristic->setCallbacks(&latencyCallbacks);
+
+    esp_timer_create_args_t timerArgs = {};
+    timerArgs.callback = &pollLatency;
+    timerArgs.name = "latency";
+    esp_timer_create(&timerArgs, &latencyTimer);
+
+    return pLatencyCharacteristic;
+}
+
+#endif  // OSSM_COMMUNICATION_LATENCY_HPP
@@ -0,0 +1,105 @@
+#ifndef OSSM_COMMUNICATION_LINK_HPP
+#define OSSM_COMMUNICATION_LINK_HPP
+
+#include <NimBLEDevice.h>
+#include <NimBLEServer.h>
+
+#include "constants/LogTags.h"
+#include "esp_log.h"
+#include "ossm/OSSMI.h"
+#include "ossm/States.h"
+#include "structs/LinkStatus.h"
+
+/**
+ * Link tuning: phones pick slow connection parameters unless the peripheral
+ * asks for better ones. After connecting, the OSSM asks for 2M PHY and the
+ * longest data length, and for a short connection interval while a play mode
+ * runs. Anywhere else it relaxes the interval to save power.
+ */
+namespace LinkTuning {
+    // Answered when a client starts the MTU exchange
+    constexpr uint16_t preferredMtu = 247;
+    // Largest link layer payload with data length extension
+    constexpr uint16_t dataLength = 251;
+
+    // Play modes: 7.5-15ms, every connection event
+    constexpr uint16_t fastMinInterval = 6;
+    constexpr uint16_t fastMaxInterval = 12;
+    constexpr uint16_t fastLatency = 0;
+
+    // Everything else: 30-60ms, up to 4 events may be skipped
+    constexpr uint16_t relaxedMinInterval = 24;
+    constexpr uint16_t relaxedMaxInterval = 48;
+    constexpr uint16_t relaxedLatency = 4;
+
+    // 4s, has to exceed (1 + latency) * interval * 2
+    constexpr uint16_t supervisionTimeout = 400;
+}
+
+// Play modes get the short interval
+inline bool isLatencySensitive(StateId state) { return isPlayMode(state); }
+
+static void requestConnParams(NimBLEServer* pServer, uint16_t connHandle,
+                              bool fast) {
+    if (fast) {
+        pServer->updateConnParams(connHandle, LinkTuning::fastMinInterval,
+                                  LinkTuning::fastMaxInterval,
+                                  LinkTuning::fastLatency,
+                                  LinkTuning::supervisionTimeout);
+    } else {
+        pServer->updateConnParams(connHandle, LinkTuning::relaxedMinInterval,
+                                  LinkTuning::relaxedMaxInterval,
+                                  LinkTuning::relaxedLatency,
+                                  LinkTuning::supervisionTimeout);
+    }
+}
+
+// Called once a client connected.
+static void tuneLink(NimBLEServer* pServer, NimBLEConnInfo& connInfo) {
+    uint16_t connHandle = connInfo.getConnHandle();
+    pServer->setDataLen(connHandle, LinkTuning::dataLength);
+    pServer->updatePhy(connHandle, BLE_GAP_LE_PHY_2M_MASK,
+                       BLE_GAP_LE_PHY_2M_MASK, BLE_GAP_LE_PHY_CODED_ANY);
+    requestConnParams(pServer, connHandle, isLatencySensitive(getStateId()));
+}
+
+// Called by nimbleLoop whenever the state changes. Only asks the clients for
+// new parameters when the profile changes.
+static void updateLinkProfile(NimBLEServer* pServer, StateId state) {
+    static bool lastFast = false;
+
+    bool fast = isLatencySensitive(state);
+    if (fast == lastFast) {
+        return;
+    }
+    lastFast = fast;
+
+    ESP_LOGD(NIMBLE_TAG, "Requesting %s connection interval",
+             fast ? "fast" : "relaxed");
+    for (uint16_t connHandle : pServer->getPeerDevices()) {
+        requestConnParams(pServer, connHandle, fast);
+    }
+}
+
+// Publishes the parameters of a connection in the state characteristic.
+static void reportLink(NimBLEConnInfo& connInfo, uint8_t phy = 0) {
+    static uint8_t lastPhy = 1;
+    if (phy != 0) {
+        lastPhy = phy;
+    }
+
+    LinkStatus link;
+    link.interval = connInfo.getConnInterval();
+    link.latency = connInfo.getConnLatency();
+    link.timeout = connInfo.getConnTimeout();
+    link.mtu = connInfo.getMTU();
+    link.phy = lastPhy;
+
+    ESP_LOGD(NIMBLE_TAG, "Link: interval %.2fms, latency %u, MTU %u, PHY %u",
+             link.interval * 1.25f, link.latency, link.mtu, link.phy);
+    if (ossmInterface) {
+        ossmInterface->setBLELinkStatus(link);
+    }
+}
+
+#endif  // OSSM_COMMUNICATION_LINK_HPP
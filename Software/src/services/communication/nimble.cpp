@@ -6,34 +6,52 @@
 #include <services/board.h>
 #include <services/tasks.h>
 
-#include <queue>
+#include "components/HeaderBar.h"
 
+#include "binary.hpp"
+#include "capture.hpp"
+#include "coex.hpp"
 #include "command.hpp"
+#include "command/coalescer.hpp"
 #include "command/commands.hpp"
 #include "config.hpp"
+#include "events.h"
 #include "gpio.hpp"
+#include "latency.hpp"
+#include "link.hpp"
 #include "patterns.hpp"
+#include "profile.hpp"
+#include "program.hpp"
+#include "reconnect.hpp"
+#include "script.hpp"
 #include "services/led.h"
+#include "ossm/States.h"
 #include "state.hpp"
+#include "taskstats.hpp"
+#include "telemetry.hpp"
+#include "timing.hpp"
+#include "trace.hpp"
 
 // Define the global variables
 NimBLEServer* pServer = nullptr;
 
 NimBLECharacteristic* pStateCharacteristic = nullptr;
 
+NimBLECharacteristic* pBinaryStateCharacteristic = nullptr;
+
 NimBLECharacteristic* pSpeedKnobConfigCharacteristic = nullptr;
 
 NimBLECharacteristic* pCommandCharacteristic = nullptr;
 
+EventGroupHandle_t nimbleEvents = nullptr;
+
+NimBLECharacteristic* pBinaryCommandCharacteristic = nullptr;
+
 static long lostConnectionTime = 0;
 static int speedOnLostConnection = 0;
 static const unsigned long RAMP_DURATION_MS =
     2000;  // Duration for speed ramp to zero
 
-double easeInOutSine(double t) {
-    return 0.5 * (1 + sin(3.1415926 * (t - 0.5)));
-}
-
 /** Handler class for server actions */
 class ServerCallbacks : public NimBLEServerCallbacks {
     void onConnect(NimBLEServer* pServer, NimBLEConnInfo& connInfo) override {
@@ -46,8 +64,24 @@ class ServerCallbacks : public NimBLEServerCallbacks {
         if (ossmInterface) {
             ossmInterface->setBLEConnectionStatus(true);
         }
+        setCoexConnected(true);
+
+        // Ask for a faster link than the client would pick by itself
+        tuneLink(pServer, connInfo);
+        reportLink(connInfo);
+
+        // Bonded peers encrypt with their stored keys, new ones pair once
+        NimBLEDevice::startSecurity(connInfo.getConnHandle());
 
         lostConnectionTime = 0;
+        signalNimble(NimbleEvents::connection);
+        notifyHeaderBar();
+    }
+
+    void onAuthenticationComplete(NimBLEConnInfo& connInfo) override {
+        ESP_LOGI(NIMBLE_TAG, "Connection encrypted: %d, bonded: %d",
+                 connInfo.isEncrypted(), connInfo.isBonded());
+        rememberPeer(connInfo);
     }
 
     void onDisconnect(NimBLEServer* pServer, NimBLEConnInfo& connInfo,
@@ -60,50 +94,124 @@ class ServerCallbacks : public NimBLEServerCallbacks {
         // Set BLE connection status to false when no connections remain
         if (ossmInterface && pServer->getConnectedCount() == 0) {
             ossmInterface->setBLEConnectionStatus(false);
+            ossmInterface->setBLELinkStatus(LinkStatus());
         }
+        setCoexConnected(pServer->getConnectedCount() > 0);
 
         // Capture current speed when connection is lost
         speedOnLostConnection = ossmInterface->getSpeed();
         ESP_LOGI(NIMBLE_TAG, "Speed on disconnect: %d", speedOnLostConnection);
 
-        // Restart advertising when client disconnects
+        // Restart advertising when client disconnects, directed at the peer
+        // that just left if it is bonded
+        rememberPeer(connInfo);
         if (pServer->getConnectedCount() == 0) {
             ESP_LOGI(NIMBLE_TAG,
                      "No connections remaining, restarting advertising");
-            pServer->startAdvertising();
+            isDirectedPending = true;
+            startReconnectAdvertising();
         }
 
+        forgetStateSubscriber(connInfo.getConnHandle());
         lostConnectionTime = millis();
+        signalNimble(NimbleEvents::connection);
+        notifyHeaderBar();
     }
 
     void onMTUChange(uint16_t MTU, NimBLEConnInfo& connInfo) override {
         ESP_LOGD(NIMBLE_TAG, "MTU changed to: %d for connection: %s", MTU,
                  connInfo.getAddress().toString().c_str());
+        reportLink(connInfo);
+    }
+
+    void onConnParamsUpdate(NimBLEConnInfo& connInfo) override {
+        reportLink(connInfo);
+    }
+
+    void onPhyUpdate(NimBLEConnInfo& connInfo, uint8_t txPhy,
+                     uint8_t rxPhy) override {
+        reportLink(connInfo, txPhy);
     }
 } serverCallbacks;
 
+// Sleeps until a command, state change or connection change is signalled, or
+// the poll timeout passes.
+static void waitForNimbleEvents() {
+    xEventGroupWaitBits(nimbleEvents, NimbleEvents::all, pdTRUE, pdFALSE,
+                        NimbleEvents::pollTicks);
+}
+
+// Applies the queued commands. set: commands are coalesced so only the
+// newest value per parameter is applied each cycle, everything else is
+// applied in order.
+static void applyQueuedCommands(CommandCoalescer& coalescer,
+                                uint32_t& lastSupersededCount) {
+    CommandValue command;
+    bool processed = false;
+    auto applyCommand = [](const CommandValue& command) {
+        markLatency(LatencyStage::dispatched);
+        ossmInterface->ble_command(command);
+
+        char response[80] = "ok:";
+        size_t length = 3 + commandToString(command, response + 3,
+                                            sizeof(response) - 3);
+        pStateCharacteristic->setValue((uint8_t*)response, length);
+    };
+
+    while (commandQueue.pop(command)) {
+        processed = true;
+        if (!coalescer.add(command)) {
+            coalescer.flush(applyCommand);
+            applyCommand(command);
+        }
+    }
+
+    if (processed) {
+        coalescer.flush(applyCommand);
+
+        // Trigger LED communication pulse for command processing
+        pulseForCommunication();
+
+        if (coalescer.getSupersededCount() != lastSupersededCount) {
+            lastSupersededCount = coalescer.getSupersededCount();
+            ESP_LOGV(NIMBLE_TAG, "Superseded commands: %u",
+                     lastSupersededCount);
+        }
+    }
+}
+
 void nimbleLoop(void* pvParameters) {
     NimBLEServer* pServer = (NimBLEServer*)pvParameters;
     /** Loop here and send notifications to connected peers */
 
-    String lastState = "";
-    int lastConnCount = 0;
+    StateSnapshot lastSnapshot = {};
+    bool forceSend = true;
+    // Last sent JSON state, for subscribers that still have to catch up
+    char state[160];
+    size_t stateLength = 0;
+    CommandCoalescer coalescer;
+    uint32_t lastSupersededCount = 0;
     int lastMessageTime = 0;
     while (true) {
+        // Commands also arrive over WiFi, with or without a BLE connection
+        applyQueuedCommands(coalescer, lastSupersededCount);
+
         // Check if we should be advertising (no connections)
         if (pServer->getConnectedCount() == 0) {
-            // If not advertising and no connections, restart advertising
-            if (!pServer->getAdvertising()) {
+            // If not advertising and no connections, restart advertising.
+            // Also where directed advertising falls back to undirected.
+            if (!NimBLEDevice::getAdvertising()->isAdvertising()) {
                 ESP_LOGI(NIMBLE_TAG,
                          "No connections and not advertising, restarting "
                          "advertising");
-                pServer->startAdvertising();
+                startReconnectAdvertising();
+                notifyHeaderBar();
             }
 
             if (lostConnectionTime > 0) {
                 // Skip ramp-down if speed was already zero when connection was
-                // lost
-                if (speedOnLostConnection <= 0) {
+                // lost, unless a program may still raise it
+                if (speedOnLostConnection <= 0 && !isProgramPlaying()) {
                     lostConnectionTime = 0;
                     continue;
                 }
@@ -116,117 +224,111 @@ void nimbleLoop(void* pvParameters) {
                     continue;
                 }
 
-                if (elapsed > 1000 + RAMP_DURATION_MS) {
-                    ESP_LOGI(
-                        NIMBLE_TAG,
-                        "Speed ramp duration exceeded, setting speed to 0");
-                    lostConnectionTime = 0;
-                    speedOnLostConnection = 0;
-                    ossmInterface->ble_click("set:speed:0");
-                    continue;
-                }
-
-                // Calculate easing factor (0 to 1) over ramp duration
-                double progress = constrain(
-                    (elapsed - 1000) / (double)RAMP_DURATION_MS, 0.0, 1.0);
-                double t = easeInOutSine(progress);
-
-                // Ramp from current speed to zero
-                int targetSpeed = (int)(speedOnLostConnection * (1.0 - t));
-                ESP_LOGI(NIMBLE_TAG,
-                         "Target speed: %d (from %d, progress: %.2f)",
-                         targetSpeed, speedOnLostConnection, progress);
-
-                ossmInterface->ble_click("set:speed:" + String(targetSpeed));
-
-                // Stop processing when easing is complete
-                if (t >= 1) {
-                    lostConnectionTime = 0;
+                // A program that plays once ends without the link, the
+                // ramp waits for it. A looping one gets it right away.
+                if (isProgramPlayingOnce()) {
+                    vTaskDelay(pdMS_TO_TICKS(50));
                     continue;
                 }
 
-                vTaskDelay(pdMS_TO_TICKS(50));
+                // The motion task eases down by itself
+                ESP_LOGI(NIMBLE_TAG, "Ramping speed from %d to 0 in %lums",
+                         speedOnLostConnection, RAMP_DURATION_MS);
+                ossmInterface->rampSpeed(0, RAMP_DURATION_MS);
+                lostConnectionTime = 0;
                 continue;
             }
 
-            vTaskDelay(pdMS_TO_TICKS(200));
+            EventBits_t wakeBits =
+                NimbleEvents::connection | NimbleEvents::command;
+            xEventGroupWaitBits(nimbleEvents, wakeBits, pdTRUE, pdFALSE,
+                                pdMS_TO_TICKS(200));
             continue;
         }
 
-        String currentState = ossmInterface->getCurrentState();
-        int currentConnCount = pServer->getConnectedCount();
 
-        // Clear last state when connection count changes
-        if (currentConnCount != lastConnCount) {
-            lastState = "";
-            lastConnCount = currentConnCount;
-        }
+        publishLatency();
 
-        NimBLEService* pSvc = pServer->getServiceByUUID(SERVICE_UUID);
-        if (!pSvc) {
-            lastState = "";
-            vTaskDelay(pdMS_TO_TICKS(1000));
-            continue;
-        }
+        // Comparing the packed snapshot is a handful of byte compares, the
+        // JSON view is only built when something is actually sent.
+        StateSnapshot snapshot = ossmInterface->getStateSnapshot();
+        snapshot.sequence = lastSnapshot.sequence;
 
-        NimBLECharacteristic* pChr =
-            pSvc->getCharacteristic(CHARACTERISTIC_STATE_UUID);
-        if (!pChr) {
-            lastState = "";
-            vTaskDelay(pdMS_TO_TICKS(1000));
-            continue;
-        }
+        int currentTime = millis();
+        bool stateChanged =
+            forceSend ||
+            memcmp(&snapshot, &lastSnapshot, stateSnapshotCompared) != 0;
+        bool timeElapsed = (currentTime - lastMessageTime) > 1000;
 
-        // mannage message queue
-        while (!messageQueue.empty()) {
-            String cmd = messageQueue.front();
-            messageQueue.pop();
-            ossmInterface->ble_click(cmd);
-            pChr->setValue("ok:" + cmd);
+        if (stateChanged || timeElapsed) {
+            lastMessageTime = currentTime;
+            forceSend = false;
 
-            // Trigger LED communication pulse for command processing
-            pulseForCommunication();
+            if (stateChanged) {
+                snapshot.sequence++;
+                ESP_LOGD(NIMBLE_TAG, "State changed to: %s",
+                         stateName(static_cast<StateId>(snapshot.state)));
+                updateLinkProfile(pServer,
+                                  static_cast<StateId>(snapshot.state));
+            }
 
-            vTaskDelay(1);
-        }
+            stateLength = ossmInterface->getCurrentState(state, sizeof(state));
 
-        int currentTime = millis();
-        bool stateChanged = currentState != lastState;
-        bool timeElapsed = (currentTime - lastMessageTime) > 1000;
+            // Marked before the broadcast, so a client subscribing in
+            // between is caught up below rather than missed
+            markStateSent(snapshot.sequence);
 
-        if (!stateChanged && !timeElapsed) {
-            vTaskDelay(1);
-            continue;
-        }
-        lastMessageTime = currentTime;
+            pBinaryStateCharacteristic->setValue((uint8_t*)&snapshot,
+                                                 sizeof(StateSnapshot));
+            pBinaryStateCharacteristic->notify();
+
+            pStateCharacteristic->setValue((uint8_t*)state, stateLength);
+            pStateCharacteristic->notify();
 
-        if (stateChanged) {
-            ESP_LOGD(NIMBLE_TAG, "State changed to: %s", currentState.c_str());
+            // Trigger LED communication pulse for state update
+            pulseForCommunication();
+
+            lastSnapshot = snapshot;
         }
-        pChr->setValue(currentState);
-        pChr->notify();
 
-        // Trigger LED communication pulse for state update
-        pulseForCommunication();
+        // New subscribers only get the current state, on their connection
+        catchUpStateSubscribers(pBinaryStateCharacteristic,
+                                binaryStateSubscribers, lastSnapshot.sequence,
+                                (uint8_t*)&lastSnapshot, sizeof(StateSnapshot));
+        catchUpStateSubscribers(pStateCharacteristic, stateSubscribers,
+                                lastSnapshot.sequence, (uint8_t*)state,
+                                stateLength);
 
-        lastState = currentState;
-        vTaskDelay(1);
+        waitForNimbleEvents();
     }
 }
 
 void initNimble() {
     /** Initialize NimBLE and set the device name */
     NimBLEDevice::init("OSSM");
+    NimBLEDevice::setMTU(LinkTuning::preferredMtu);
+
+    nimbleEvents = xEventGroupCreate();
 
-    NimBLEDevice::setSecurityAuth(BLE_SM_PAIR_AUTHREQ_SC);
+    // Bond, so known clients can reconnect without pairing again
+    NimBLEDevice::setSecurityAuth(BLE_SM_PAIR_AUTHREQ_BOND |
+                                  BLE_SM_PAIR_AUTHREQ_SC);
+    NimBLEDevice::setSecurityIOCap(BLE_HS_IO_NO_INPUT_OUTPUT);
     pServer = NimBLEDevice::createServer();
     pServer->setCallbacks(&serverCallbacks);
+    // Advertising is restarted by startReconnectAdvertising()
+    pServer->advertiseOnDisconnect(false);
 
     // Create Service
     NimBLEService* pService = pServer->createService(SERVICE_UUID);
 
     pCommandCharacteristic =
         initCommandCharacteristic(pService, NimBLEUUID(CHARACTERISTIC_UUID));
+    pBinaryCommandCharacteristic = initBinaryCommandCharacteristic(
+        pService, NimBLEUUID(CHARACTERISTIC_BINARY_COMMAND_UUID));
+    initScriptCharacteristic(pService, NimBLEUUID(CHARACTERISTIC_SCRIPT_UUID));
+    initProgramCharacteristic(pService,
+                              NimBLEUUID(CHARACTERISTIC_PROGRAM_UUID));
 
     pSpeedKnobConfigCharacteristic = initSpeedKnobConfigCharacteristic(
         pService, NimBLEUUID(CHARACTERISTIC_SPEED_KNOB_CONFIG_UUID));
@@ -234,14 +336,50 @@ void initNimble() {
     pStateCharacteristic = initStateCharacteristic(
         pService, NimBLEUUID(CHARACTERISTIC_STATE_UUID));
 
+    pBinaryStateCharacteristic = initBinaryStateCharacteristic(
+        pService, NimBLEUUID(CHARACTERISTIC_BINARY_STATE_UUID));
+
+    initTelemetryCharacteristic(pService,
+                                NimBLEUUID(CHARACTERISTIC_TELEMETRY_UUID));
+
     initPatternsCharacteristic(pService,
                                NimBLEUUID(CHARACTERISTIC_PATTERNS_UUID));
     initPatternDataCharacteristic(
         pService, NimBLEUUID(CHARACTERISTIC_GET_PATTERN_DATA_UUID));
+    initKeyframesCharacteristic(pService,
+                                NimBLEUUID(CHARACTERISTIC_KEYFRAMES_UUID));
+    initCatalogInfoCharacteristic(
+        pService, NimBLEUUID(CHARACTERISTIC_CATALOG_INFO_UUID));
+    initCatalogCharacteristic(pService,
+                              NimBLEUUID(CHARACTERISTIC_CATALOG_UUID));
 
     // GPIO write/read characteristic
     initGPIOCharacteristic(pService, NimBLEUUID(CHARACTERISTIC_GPIO_UUID));
 
+    initStateTraceCharacteristic(pService,
+                                 NimBLEUUID(CHARACTERISTIC_STATE_TRACE_UUID));
+
+    initStrokeTimingCharacteristic(
+        pService, NimBLEUUID(CHARACTERISTIC_STROKE_TIMING_UUID));
+
+    initTaskStatsCharacteristic(pService,
+                                NimBLEUUID(CHARACTERISTIC_TASK_STATS_UUID));
+
+    initStackUsageCharacteristic(pService,
+                                 NimBLEUUID(CHARACTERISTIC_STACK_USAGE_UUID));
+
+    initLatencyCharacteristic(pService, NimBLEUUID(CHARACTERISTIC_LATENCY_UUID));
+
+    initProfileCharacteristic(pService,
+                              NimBLEUUID(CHARACTERISTIC_PROFILE_UUID));
+
+    initCaptureCharacteristic(pService,
+                              NimBLEUUID(CHARACTERISTIC_CAPTURE_UUID));
+
+    initCoexCharacteristic(pService, NimBLEUUID(CHARACTERISTIC_COEX_UUID));
+
+    initHeapCharacteristic(pService, NimBLEUUID(CHARACTERISTIC_HEAP_UUID));
+
     // Start the services
     pService->start();
 
@@ -276,9 +414,15 @@ void initNimble() {
     pAdvertising->setMinInterval(0x20);  // 20ms minimum interval
     pAdvertising->setMaxInterval(0x40);  // 40ms maximum interval
 
-    pAdvertising->start();
-
-    xTaskCreatePinnedToCore(
-        nimbleLoop, "nimbleLoop", 5 * configMINIMAL_STACK_SIZE, pServer,
-        configMAX_PRIORITIES - 1, nullptr, Tasks::stepperCore);
+    pServer->start();
+    indicateServiceChanges();
+    startReconnectAdvertising();
+    notifyHeaderBar();
+
+    // nimbleLoop mostly sleeps, keep it away from the step generation on the
+    // stepper core.
+    xTaskCreatePinnedToCore(nimbleLoop, "nimbleLoop",
+                            5 * configMINIMAL_STACK_SIZE, pServer,
+                            Tasks::communicationPriority, nullptr,
+                            Tasks::communicationCore);
 }
@@ -23,6 +23,12 @@
 #define CHARACTERISTIC_UUID "522b443a-4f53-534d-1000-420badbabe69"
 #define CHARACTERISTIC_SPEED_KNOB_CONFIG_UUID \
     "522b443a-4f53-534d-1010-420badbabe69"
+#define CHARACTERISTIC_BINARY_COMMAND_UUID \
+    "522b443a-4f53-534d-1020-420badbabe69"
+// Upload and playback of preloaded scripts, see ScriptBuffer.
+#define CHARACTERISTIC_SCRIPT_UUID "522b443a-4f53-534d-1030-420badbabe69"
+// Upload and playback of setting programs, see ProgramPlayer.
+#define CHARACTERISTIC_PROGRAM_UUID "522b443a-4f53-534d-1040-420badbabe69"
 
 // **********************************************************
 // State Characteristics
@@ -33,6 +39,10 @@
 
 // Clients should read the current state from this char.
 #define CHARACTERISTIC_STATE_UUID "522b443a-4f53-534d-2000-420badbabe69"
+// Packed binary version of the state, see StateSnapshot.
+#define CHARACTERISTIC_BINARY_STATE_UUID "522b443a-4f53-534d-2010-420badbabe69"
+// Sampled position and speed, batched into notifications by TelemetryPacker.
+#define CHARACTERISTIC_TELEMETRY_UUID "522b443a-4f53-534d-2020-420badbabe69"
 
 // ************************************************
 // Pattern Characteristics
@@ -42,6 +52,13 @@
 #define CHARACTERISTIC_PATTERNS_UUID "522b443a-4f53-534d-3000-420badbabe69"
 #define CHARACTERISTIC_GET_PATTERN_DATA_UUID \
     "522b443a-4f53-534d-3010-420badbabe69"
+// Keyframe table of the Custom pattern, see Keyframes.h.
+#define CHARACTERISTIC_KEYFRAMES_UUID "522b443a-4f53-534d-3020-420badbabe69"
+// Hash and length of the pattern catalog, see Catalog.h.
+#define CHARACTERISTIC_CATALOG_INFO_UUID \
+    "522b443a-4f53-534d-3030-420badbabe69"
+// Pattern catalog, notified in chunks from the offset written to it.
+#define CHARACTERISTIC_CATALOG_UUID "522b443a-4f53-534d-3040-420badbabe69"
 
 // ************************************************
 // GPIO Characteristics
@@ -50,6 +67,31 @@
 // ************************************************
 #define CHARACTERISTIC_GPIO_UUID "522b443a-4f53-534d-4000-420badbabe69"
 
+// ************************************************
+// Statistics Characteristics
+// - Range: E000-EFFF
+// - Description: Diagnostics for development, may change between releases.
+// ************************************************
+// Packed state machine trace, see StateTraceRecord.
+#define CHARACTERISTIC_STATE_TRACE_UUID "522b443a-4f53-534d-e000-420badbabe69"
+// Stroke timing histograms of the current session, see StrokeTiming.
+#define CHARACTERISTIC_STROKE_TIMING_UUID \
+    "522b443a-4f53-534d-e001-420badbabe69"
+// Core and task loads, see TaskStatsRecord.
+#define CHARACTERISTIC_TASK_STATS_UUID "522b443a-4f53-534d-e002-420badbabe69"
+// Smallest free stack per task, see StackUsageRecord.
+#define CHARACTERISTIC_STACK_USAGE_UUID "522b443a-4f53-534d-e003-420badbabe69"
+// Stage timestamps of probed binary commands, see LatencyRecord.
+#define CHARACTERISTIC_LATENCY_UUID "522b443a-4f53-534d-e004-420badbabe69"
+// Cycles of the hot paths, see ProfileRecord.
+#define CHARACTERISTIC_PROFILE_UUID "522b443a-4f53-534d-e005-420badbabe69"
+// Captured command writes for the replayer, see CommandCaptureRecord.
+#define CHARACTERISTIC_CAPTURE_UUID "522b443a-4f53-534d-e006-420badbabe69"
+// Radio plan and missed connection events, see CoexRecord.
+#define CHARACTERISTIC_COEX_UUID "522b443a-4f53-534d-e007-420badbabe69"
+// Heap fragmentation and memory budgets, see HeapHeader.
+#define CHARACTERISTIC_HEAP_UUID "522b443a-4f53-534d-e008-420badbabe69"
+
 // ************************************************
 // ****************** ETC *************************
 // ************************************************
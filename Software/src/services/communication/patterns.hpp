@@ -3,9 +3,34 @@
 
 #include "ArduinoJson.h"
 #include "NimBLEService.h"
+#include "StrokeEngine.h"
 #include "constants/LogTags.h"
 #include "constants/UserConfig.h"
 #include "esp_log.h"
+#include "link.hpp"
+#include "services/json.h"
+#include "services/stepper.h"
+#include "utils/Catalog.h"
+
+// Translated name where available, the pattern's own name otherwise
+static const char* patternName(int index) {
+    int namesCount = sizeof(UserConfig::language.StrokeEngineNames) /
+                     sizeof(UserConfig::language.StrokeEngineNames[0]);
+    if (index < namesCount) {
+        return UserConfig::language.StrokeEngineNames[index];
+    }
+    return patternTable[index]->getName();
+}
+
+static const char* patternDescription(int index) {
+    int descriptionsCount =
+        sizeof(UserConfig::language.StrokeEngineDescriptions) /
+        sizeof(UserConfig::language.StrokeEngineDescriptions[0]);
+    if (index < descriptionsCount) {
+        return UserConfig::language.StrokeEngineDescriptions[index];
+    }
+    return "";
+}
 
 NimBLECharacteristic* initPatternsCharacteristic(NimBLEService* pService,
                                                  NimBLEUUID uuid) {
@@ -13,17 +38,19 @@ NimBLECharacteristic* initPatternsCharacteristic(NimBLEService* pService,
     NimBLECharacteristic* pPatternsChar =
         pService->createCharacteristic(uuid, NIMBLE_PROPERTY::READ);
     // Use ArduinoJson to construct the patterns JSON
-    JsonDocument doc;
+    JsonDocument doc(&jsonAllocator);
     JsonArray arr = doc.to<JsonArray>();
 
-    for (int i = 0; i < sizeof(UserConfig::language.StrokeEngineNames) /
-                            sizeof(UserConfig::language.StrokeEngineNames[0]);
-         i++) {
+    // Generated from the pattern table, with translated names where available
+    for (int i = 0; i < (int)patternTableSize; i++) {
         JsonObject pattern = arr.createNestedObject();
-        pattern["name"] = UserConfig::language.StrokeEngineNames[i];
+        pattern["name"] = patternName(i);
         pattern["idx"] = i;
     }
 
+    if (doc.overflowed()) {
+        ESP_LOGE(NIMBLE_TAG, "Pattern list over the JSON budget");
+    }
     String jsonString;
     serializeJson(arr, jsonString);
     pPatternsChar->setValue(jsonString.c_str());
@@ -80,4 +107,138 @@ NimBLECharacteristic* initPatternDataCharacteristic(NimBLEService* pService,
     return pPatternDataChar;
 }
 
+/**
+ * Keyframes of the Custom pattern, see Keyframes.h for the format. A valid
+ * table replaces the current one right away, an invalid one is ignored and
+ * the characteristic keeps the table that is playing, so clients can read it
+ * back to check their upload. Tables are kept in RAM until the next restart.
+ */
+class KeyframesCallbacks : public NimBLECharacteristicCallbacks {
+    void onWrite(NimBLECharacteristic* pCharacteristic,
+                 NimBLEConnInfo& connInfo) override {
+        std::string value = pCharacteristic->getValue();
+
+        KeyframeTable table;
+        if (!decodeKeyframes((const uint8_t*)value.data(), value.size(),
+                             table)) {
+            ESP_LOGW(NIMBLE_TAG, "Invalid keyframe table of %u bytes",
+                     (unsigned)value.size());
+            pCharacteristic->setValue(accepted);
+            return;
+        }
+
+        Stroker.setKeyframes(table, true);
+        accepted = value;
+        ESP_LOGD(NIMBLE_TAG, "Keyframe table with %d points", table.count);
+    }
+
+    std::string accepted;
+} keyframesCallbacks;
+
+NimBLECharacteristic* initKeyframesCharacteristic(NimBLEService* pService,
+                                                  NimBLEUUID uuid) {
+    NimBLECharacteristic* pKeyframesChar = pService->createCharacteristic(
+        uuid, NIMBLE_PROPERTY::WRITE | NIMBLE_PROPERTY::READ,
+        2 + 4 * KEYFRAME_MAX_POINTS);
+
+    pKeyframesChar->setCallbacks(&keyframesCallbacks);
+    return pKeyframesChar;
+}
+
+/**
+ * Pattern catalog: names, descriptions and the parameters of all patterns in
+ * one JSON blob, built once at init. The info characteristic holds its hash,
+ * clients that have the blob for that hash already skip the download. Writing
+ * an offset to the catalog characteristic notifies the blob from there on in
+ * chunks as large as the MTU allows, until the end or the host runs out of
+ * buffers, in which case the client writes the offset it got to.
+ */
+static String catalog;
+
+static void buildCatalog() {
+    JsonDocument doc(&jsonAllocator);
+    doc["v"] = CATALOG_VERSION;
+
+    // Parameters all patterns share, as set with set:<name>:<value>
+    JsonArray params = doc.createNestedArray("params");
+    const char* names[] = {"speed", "stroke", "depth", "sensation"};
+    for (const char* name : names) {
+        JsonObject param = params.createNestedObject();
+        param["name"] = name;
+        param["min"] = 0;
+        param["max"] = 100;
+    }
+    params[3]["neutral"] = 50;
+
+    JsonArray patterns = doc.createNestedArray("patterns");
+    for (int i = 0; i < (int)patternTableSize; i++) {
+        JsonObject pattern = patterns.createNestedObject();
+        pattern["idx"] = i;
+        pattern["name"] = patternName(i);
+        pattern["description"] = patternDescription(i);
+    }
+
+    if (doc.overflowed()) {
+        ESP_LOGE(NIMBLE_TAG, "Pattern catalog over the JSON budget");
+    }
+    serializeJson(doc, catalog);
+}
+
+class CatalogCallbacks : public NimBLECharacteristicCallbacks {
+    void onWrite(NimBLECharacteristic* pCharacteristic,
+                 NimBLEConnInfo& connInfo) override {
+        if (pCharacteristic->getValue().size() != sizeof(uint32_t)) {
+            ESP_LOGW(NIMBLE_TAG, "Invalid catalog offset");
+            return;
+        }
+
+        uint32_t offset = pCharacteristic->getValue<uint32_t>();
+        size_t limit = min((size_t)(connInfo.getMTU() - 3),
+                           (size_t)(LinkTuning::preferredMtu - 3));
+        uint8_t chunk[LinkTuning::preferredMtu - 3];
+
+        size_t length;
+        while ((length = catalogChunk((const uint8_t*)catalog.c_str(),
+                                      catalog.length(), offset, chunk,
+                                      limit)) > 0) {
+            if (!pCharacteristic->notify(chunk, length,
+                                         connInfo.getConnHandle())) {
+                ESP_LOGD(NIMBLE_TAG, "Catalog paused at %u",
+                         (unsigned)offset);
+                break;
+            }
+            offset += length - catalogChunkHeader;
+        }
+    }
+} catalogCallbacks;
+
+NimBLECharacteristic* initCatalogInfoCharacteristic(NimBLEService* pService,
+                                                    NimBLEUUID uuid) {
+    if (catalog.length() == 0) {
+        buildCatalog();
+    }
+
+    NimBLECharacteristic* pInfoChar =
+        pService->createCharacteristic(uuid, NIMBLE_PROPERTY::READ);
+    CatalogInfo info =
+        catalogInfo((const uint8_t*)catalog.c_str(), catalog.length());
+    pInfoChar->setValue((uint8_t*)&info, sizeof(info));
+
+    ESP_LOGI(NIMBLE_TAG, "Pattern catalog of %u bytes, hash %08lx",
+             (unsigned)info.length, (unsigned long)info.hash);
+    return pInfoChar;
+}
+
+NimBLECharacteristic* initCatalogCharacteristic(NimBLEService* pService,
+                                                NimBLEUUID uuid) {
+    if (catalog.length() == 0) {
+        buildCatalog();
+    }
+
+    NimBLECharacteristic* pCatalogChar = pService->createCharacteristic(
+        uuid, NIMBLE_PROPERTY::WRITE | NIMBLE_PROPERTY::NOTIFY);
+    pCatalogChar->setCallbacks(&catalogCallbacks);
+    return pCatalogChar;
+}
+
 #endif  // OSSM_PATTERNS_HPP
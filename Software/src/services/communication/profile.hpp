@@ -0,0 +1,35 @@
+#ifndef OSSM_COMMUNICATION_PROFILE_HPP
+#define OSSM_COMMUNICATION_PROFILE_HPP
+
+#include "NimBLECharacteristic.h"
+#include "NimBLEService.h"
+#include "NimBLEUUID.h"
+#include "services/profiler.h"
+
+/** Handler class for the profile characteristic */
+class ProfileCallbacks : public NimBLECharacteristicCallbacks {
+    // Reads return the cycles of every probe since boot.
+    void onRead(NimBLECharacteristic* pCharacteristic,
+                NimBLEConnInfo& connInfo) override {
+        struct __attribute__((packed)) {
+            ProfileHeader header;
+            ProfileRecord records[(size_t)ProfileProbe::count];
+        } profile;
+        size_t count = copyProfile(&profile.header, profile.records,
+                                   (size_t)ProfileProbe::count);
+        pCharacteristic->setValue(
+            (uint8_t*)&profile,
+            sizeof(ProfileHeader) + count * sizeof(ProfileRecord));
+    }
+} profileCallbacks;
+
+NimBLECharacteristic* initProfileCharacteristic(NimBLEService* pService,
+                                                NimBLEUUID uuid) {
+    NimBLECharacteristic* pProfileChar =
+        pService->createCharacteristic(uuid, NIMBLE_PROPERTY::READ);
+    pProfileChar->setCallbacks(&profileCallbacks);
+
+    return pProfileChar;
+}
+
+#endif  // OSSM_COMMUNICATION_PROFILE_HPP
@@ -0,0 +1,72 @@
+#ifndef OSSM_COMMUNICATION_PROGRAM_HPP
+#define OSSM_COMMUNICATION_PROGRAM_HPP
+
+#include "NimBLECharacteristic.h"
+#include "NimBLEService.h"
+#include "NimBLEUUID.h"
+#include "command/program.hpp"
+#include "constants/LogTags.h"
+#include "services/led.h"
+#include "services/player.h"
+
+/**
+ * Setting programs, uploaded and controlled from the BLE host task. The
+ * program task plays them, see services/player.h.
+ */
+class ProgramCallbacks : public NimBLECharacteristicCallbacks {
+    void onWrite(NimBLECharacteristic* pCharacteristic,
+                 NimBLEConnInfo& connInfo) override {
+        NimBLEAttValue value = pCharacteristic->getValue();
+        const uint8_t* data = value.data();
+        size_t length = value.length();
+        ProgramResult result = ProgramResult::malformed;
+
+        uint8_t opcode = length > 0 ? data[0] : 0;
+        if (opcode == ProgramOpcode::clear && length == 1) {
+            result = clearProgram();
+        } else if (opcode == ProgramOpcode::append) {
+            result = appendProgram(data + 1, length - 1);
+        } else if (opcode == ProgramOpcode::play && length == 2) {
+            result = playProgram(data[1] != 0);
+        } else if (opcode == ProgramOpcode::pause && length == 1) {
+            result = pauseProgram();
+        } else if (opcode == ProgramOpcode::resume && length == 1) {
+            result = resumeProgram();
+        } else if (opcode == ProgramOpcode::stop && length == 1) {
+            stopProgram();
+            result = ProgramResult::ok;
+        }
+
+        if (result != ProgramResult::ok) {
+            ESP_LOGD(NIMBLE_TAG, "Program write %02x rejected: %d", opcode,
+                     (int)result);
+        }
+
+        ProgramStatus status = getProgramStatus(result);
+        pCharacteristic->setValue((uint8_t*)&status, sizeof(status));
+        pCharacteristic->notify();
+
+        pulseForCommunication();
+    }
+
+    void onRead(NimBLECharacteristic* pCharacteristic,
+                NimBLEConnInfo& connInfo) override {
+        ProgramStatus status = getProgramStatus(ProgramResult::ok);
+        pCharacteristic->setValue((uint8_t*)&status, sizeof(status));
+    }
+} programCallbacks;
+
+NimBLECharacteristic* initProgramCharacteristic(NimBLEService* pService,
+                                                NimBLEUUID uuid) {
+    NimBLECharacteristic* pChar = pService->createCharacteristic(
+        uuid, NIMBLE_PROPERTY::WRITE | NIMBLE_PROPERTY::READ |
+                  NIMBLE_PROPERTY::NOTIFY);
+
+    pChar->setCallbacks(&programCallbacks);
+
+    ProgramStatus status = getProgramStatus(ProgramResult::ok);
+    pChar->setValue((uint8_t*)&status, sizeof(status));
+    return pChar;
+}
+
+#endif  // OSSM_COMMUNICATION_PROGRAM_HPP
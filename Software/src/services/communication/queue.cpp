@@ -1,3 +1,14 @@
 #include "queue.h"
 
-std::queue<String> messageQueue = {};
+#include "freertos/FreeRTOS.h"
+
+SpscRing<CommandValue, COMMAND_QUEUE_LENGTH> commandQueue;
+
+static portMUX_TYPE commandQueueLock = portMUX_INITIALIZER_UNLOCKED;
+
+bool queueCommand(const CommandValue& command) {
+    portENTER_CRITICAL(&commandQueueLock);
+    bool isQueued = commandQueue.push(command);
+    portEXIT_CRITICAL(&commandQueueLock);
+    return isQueued;
+}
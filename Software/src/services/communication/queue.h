@@ -1,10 +1,26 @@
 #ifndef OSSM_COMMUNICATION_QUEUE_H
 #define OSSM_COMMUNICATION_QUEUE_H
 
-#include <Arduino.h>
+#include "command/commands.hpp"
+#include "ossm/States.h"
+#include "structs/CommandValue.h"
+#include "utils/SpscRing.h"
 
-#include <queue>
+#define COMMAND_QUEUE_LENGTH 32
 
-extern std::queue<String> messageQueue;
+// Decoded commands from the BLE host task and the UDP control task to
+// nimbleLoop (the only consumer). Text and binary commands share the same
+// queue. Producers push through queueCommand().
+extern SpscRing<CommandValue, COMMAND_QUEUE_LENGTH> commandQueue;
+
+// Pushes a command, false if the queue is full. The producers take turns,
+// so the ring still only ever sees one of them at a time.
+bool queueCommand(const CommandValue& command);
+
+// Whether a decoded command may be queued right now
+inline bool isCommandAllowed(const CommandValue& command) {
+    return !isMotionCommand(command) ||
+           !(isInMode(StateId::idle) || isInMode(StateId::homing));
+}
 
 #endif  // OSSM_COMMUNICATION_QUEUE_H
@@ -0,0 +1,90 @@
+#ifndef OSSM_COMMUNICATION_RECONNECT_HPP
+#define OSSM_COMMUNICATION_RECONNECT_HPP
+
+#include <NimBLEDevice.h>
+#include <Preferences.h>
+
+#include "constants/LogTags.h"
+#include "esp_log.h"
+#include "esp_ota_ops.h"
+#include "services/gatt/ble_svc_gatt.h"
+
+/**
+ * Fast reconnects: clients are asked to pair (just works) and NimBLE keeps
+ * the bonds in NVS. Whenever the OSSM starts advertising after a boot or a
+ * disconnect, it first advertises directed at the newest bonded peer, which
+ * reconnects within a few connection events, then falls back to undirected
+ * advertising for everyone else.
+ *
+ * Bonded clients cache the GATT table. After a firmware update the table may
+ * have changed, so they get a service changed indication and discover again.
+ */
+namespace ReconnectTuning {
+    // High duty cycle directed advertising, the controller stops it after
+    // 1.28s anyway
+    constexpr uint32_t directedMs = 1280;
+}
+
+static NimBLEAddress lastBondedPeer;
+// Directed advertising is tried once per boot or disconnect
+static bool isDirectedPending = true;
+
+// Called once a connection is encrypted, and on disconnect.
+static void rememberPeer(NimBLEConnInfo& connInfo) {
+    if (connInfo.isBonded()) {
+        lastBondedPeer = connInfo.getIdAddress();
+    }
+}
+
+// Starts advertising unless it is running already.
+static void startReconnectAdvertising() {
+    NimBLEAdvertising* pAdvertising = NimBLEDevice::getAdvertising();
+    if (pAdvertising->isAdvertising()) {
+        return;
+    }
+
+    // Bonds are stored oldest first
+    int bonds = NimBLEDevice::getNumBonds();
+    if (lastBondedPeer.isNull() && bonds > 0) {
+        lastBondedPeer = NimBLEDevice::getBondedAddress(bonds - 1);
+    }
+
+    if (isDirectedPending && !lastBondedPeer.isNull() &&
+        NimBLEDevice::isBonded(lastBondedPeer)) {
+        isDirectedPending = false;
+        pAdvertising->setConnectableMode(BLE_GAP_CONN_MODE_DIR);
+        if (pAdvertising->start(ReconnectTuning::directedMs,
+                                &lastBondedPeer)) {
+            ESP_LOGI(NIMBLE_TAG, "Advertising directed at %s",
+                     lastBondedPeer.toString().c_str());
+            return;
+        }
+    }
+    isDirectedPending = false;
+
+    pAdvertising->setConnectableMode(BLE_GAP_CONN_MODE_UND);
+    pAdvertising->start();
+}
+
+// Sends the service changed indication once per firmware build, to connected
+// and, as soon as they are back, bonded clients.
+static void indicateServiceChanges() {
+#if ESP_ARDUINO_VERSION_MAJOR >= 3
+    const esp_app_desc_t* app = esp_app_get_description();
+#else
+    const esp_app_desc_t* app = esp_ota_get_app_description();
+#endif
+    uint32_t build;
+    memcpy(&build, app->app_elf_sha256, sizeof(build));
+
+    Preferences preferences;
+    preferences.begin("ble", false);
+    if (preferences.getUInt("build", 0) != build) {
+        ESP_LOGI(NIMBLE_TAG, "New firmware, indicating service changes");
+        ble_svc_gatt_changed(0x0001, 0xFFFF);
+        preferences.putUInt("build", build);
+    }
+    preferences.end();
+}
+
+#endif  // OSSM_COMMUNICATION_RECONNECT_HPP
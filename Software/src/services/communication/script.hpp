@@ -0,0 +1,105 @@
+#ifndef OSSM_COMMUNICATION_SCRIPT_HPP
+#define OSSM_COMMUNICATION_SCRIPT_HPP
+
+#include "NimBLECharacteristic.h"
+#include "NimBLEService.h"
+#include "NimBLEUUID.h"
+#include "command/script.hpp"
+#include "constants/Config.h"
+#include "constants/LogTags.h"
+#include "esp_heap_caps.h"
+#include "events.h"
+#include "queue.h"
+#include "services/heap.h"
+#include "services/led.h"
+#include "services/stepper.h"
+
+/**
+ * Preloaded scripts for the streaming mode. Actions are appended straight
+ * into scriptPattern's buffer from the BLE host task, only play and pause go
+ * through the command queue since they change the motion. Clock resyncs are
+ * applied here as well, the pattern picks them up with its next move.
+ */
+class ScriptCallbacks : public NimBLECharacteristicCallbacks {
+    void onWrite(NimBLECharacteristic* pCharacteristic,
+                 NimBLEConnInfo& connInfo) override {
+        NimBLEAttValue value = pCharacteristic->getValue();
+        const uint8_t* data = value.data();
+        size_t length = value.length();
+        ScriptResult result = ScriptResult::malformed;
+
+        uint8_t opcode = length > 0 ? data[0] : 0;
+        if (opcode == ScriptOpcode::clear && length == 1) {
+            scriptPattern.buffer.clear();
+            result = ScriptResult::ok;
+        } else if (opcode == ScriptOpcode::append) {
+            result = appendScriptChunk(scriptPattern.buffer, data + 1,
+                                       length - 1);
+        } else if (opcode == ScriptOpcode::sync && length == 5) {
+            scriptPattern.clock.resync(readScriptU32(data + 1), millis());
+            result = ScriptResult::ok;
+        } else if ((opcode == ScriptOpcode::play && length == 5) ||
+                   (opcode == ScriptOpcode::pause && length == 1)) {
+            CommandValue command = {Commands::pauseScript, 0};
+            if (opcode == ScriptOpcode::play) {
+                command = {Commands::playScript, (int)readScriptU32(data + 1)};
+            }
+            if (isCommandAllowed(command) && queueCommand(command)) {
+                signalNimble(NimbleEvents::command);
+                result = ScriptResult::ok;
+            }
+        }
+
+        if (result != ScriptResult::ok) {
+            ESP_LOGD(NIMBLE_TAG, "Script write %02x rejected: %d", opcode,
+                     (int)result);
+        }
+
+        ScriptStatus status = {};
+        status.isPlaying = scriptPattern.clock.isRunning();
+        status.result = (uint8_t)result;
+        status.next = scriptPattern.buffer.appended();
+        status.available = scriptPattern.buffer.available();
+        status.time =
+            status.isPlaying ? scriptPattern.clock.now(millis()) : 0;
+        pCharacteristic->setValue((uint8_t*)&status, sizeof(status));
+        pCharacteristic->notify();
+
+        pulseForCommunication();
+    }
+} scriptCallbacks;
+
+NimBLECharacteristic* initScriptCharacteristic(NimBLEService* pService,
+                                               NimBLEUUID uuid) {
+    // The buffer lives as long as the program, in PSRAM if there is some
+    uint32_t capacity = Config::Advanced::scriptPsramActions;
+    ScriptAction* storage = (ScriptAction*)budgetMalloc(
+        MemoryPool::script, capacity * sizeof(ScriptAction),
+        MALLOC_CAP_SPIRAM);
+    if (storage == nullptr) {
+        capacity = Config::Advanced::scriptRamActions;
+        storage = (ScriptAction*)budgetMalloc(
+            MemoryPool::script, capacity * sizeof(ScriptAction),
+            MALLOC_CAP_8BIT);
+    }
+    if (storage == nullptr) {
+        capacity = 0;
+        ESP_LOGE(NIMBLE_TAG, "No memory for the script buffer");
+    }
+    scriptPattern.buffer.begin(storage, capacity);
+    ESP_LOGI(NIMBLE_TAG, "Script buffer holds %lu actions",
+             (unsigned long)capacity);
+
+    NimBLECharacteristic* pChar = pService->createCharacteristic(
+        uuid, NIMBLE_PROPERTY::WRITE | NIMBLE_PROPERTY::WRITE_NR |
+                  NIMBLE_PROPERTY::READ | NIMBLE_PROPERTY::NOTIFY);
+
+    pChar->setCallbacks(&scriptCallbacks);
+
+    ScriptStatus status = {};
+    status.available = capacity;
+    pChar->setValue((uint8_t*)&status, sizeof(status));
+    return pChar;
+}
+
+#endif  // OSSM_COMMUNICATION_SCRIPT_HPP
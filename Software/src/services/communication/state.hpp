@@ -5,16 +5,107 @@
 #include "NimBLECharacteristic.h"
 #include "NimBLEService.h"
 #include "NimBLEUUID.h"
+#include "constants/LogTags.h"
+#include "events.h"
+#include "structs/StateSnapshot.h"
+#include "utils/SubscriberTable.h"
+
+/**
+ * State notifications: changes are broadcast to every subscriber at once,
+ * clients that subscribe in between are caught up with the last sent value
+ * on their own connection, so the others don't get it again.
+ */
+using StateSubscribers = SubscriberTable<CONFIG_BT_NIMBLE_MAX_CONNECTIONS>;
+
+static StateSubscribers stateSubscribers;
+static StateSubscribers binaryStateSubscribers;
+static portMUX_TYPE stateSubscribersLock = portMUX_INITIALIZER_UNLOCKED;
+
+/** Handler class for both state characteristics */
+class StateCallbacks : public NimBLECharacteristicCallbacks {
+  public:
+    explicit StateCallbacks(StateSubscribers& subscribers)
+        : subscribers(subscribers) {}
+
+    void onSubscribe(NimBLECharacteristic* pCharacteristic,
+                     NimBLEConnInfo& connInfo, uint16_t subValue) override {
+        portENTER_CRITICAL(&stateSubscribersLock);
+        if (subValue > 0) {
+            subscribers.subscribe(connInfo.getConnHandle());
+        } else {
+            subscribers.unsubscribe(connInfo.getConnHandle());
+        }
+        portEXIT_CRITICAL(&stateSubscribersLock);
+
+        ESP_LOGD(NIMBLE_TAG, "State subscription %d for connection %d",
+                 subValue, connInfo.getConnHandle());
+        signalNimble(NimbleEvents::connection);
+    }
+
+  private:
+    StateSubscribers& subscribers;
+};
+
+static StateCallbacks stateCallbacks(stateSubscribers);
+static StateCallbacks binaryStateCallbacks(binaryStateSubscribers);
+
+// Called on disconnect, in case the unsubscribe is never reported
+static void forgetStateSubscriber(uint16_t conn) {
+    portENTER_CRITICAL(&stateSubscribersLock);
+    stateSubscribers.unsubscribe(conn);
+    binaryStateSubscribers.unsubscribe(conn);
+    portEXIT_CRITICAL(&stateSubscribersLock);
+}
+
+// Everyone subscribed now gets the broadcast that follows
+static void markStateSent(uint32_t version) {
+    portENTER_CRITICAL(&stateSubscribersLock);
+    stateSubscribers.markAllSent(version);
+    binaryStateSubscribers.markAllSent(version);
+    portEXIT_CRITICAL(&stateSubscribersLock);
+}
+
+// Notifies the value of version to the subscribers of pChar that haven't
+// seen it yet, one connection at a time.
+static void catchUpStateSubscribers(NimBLECharacteristic* pChar,
+                                    StateSubscribers& subscribers,
+                                    uint32_t version, const uint8_t* data,
+                                    size_t length) {
+    // Collected under the lock, notified outside of it
+    uint16_t behind[CONFIG_BT_NIMBLE_MAX_CONNECTIONS];
+    size_t count = 0;
+    portENTER_CRITICAL(&stateSubscribersLock);
+    subscribers.catchUp(version,
+                        [&](uint16_t conn) { behind[count++] = conn; });
+    portEXIT_CRITICAL(&stateSubscribersLock);
+
+    for (size_t i = 0; i < count; i++) {
+        pChar->notify(data, length, behind[i]);
+    }
+}
 
 NimBLECharacteristic* initStateCharacteristic(NimBLEService* pService,
                                               NimBLEUUID uuid) {
     // State characteristic (read/notify string payload for state)
     NimBLECharacteristic* pStateChar = pService->createCharacteristic(
         uuid, NIMBLE_PROPERTY::READ | NIMBLE_PROPERTY::NOTIFY);
+    pStateChar->setCallbacks(&stateCallbacks);
     static const char boot_state[] PROGMEM = "ok:boot";
     pStateChar->setValue(String(FPSTR(boot_state)));
 
     return pStateChar;
 }
 
+NimBLECharacteristic* initBinaryStateCharacteristic(NimBLEService* pService,
+                                                    NimBLEUUID uuid) {
+    // Binary state characteristic (read/notify packed StateSnapshot)
+    NimBLECharacteristic* pStateChar = pService->createCharacteristic(
+        uuid, NIMBLE_PROPERTY::READ | NIMBLE_PROPERTY::NOTIFY);
+    pStateChar->setCallbacks(&binaryStateCallbacks);
+    StateSnapshot boot = {};
+    pStateChar->setValue((uint8_t*)&boot, sizeof(StateSnapshot));
+
+    return pStateChar;
+}
+
 #endif  // OSSM_COMMUNICATION_STATE_HPP
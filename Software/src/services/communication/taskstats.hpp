@@ -0,0 +1,101 @@
+#ifndef OSSM_COMMUNICATION_TASKSTATS_HPP
+#define OSSM_COMMUNICATION_TASKSTATS_HPP
+
+#include "NimBLECharacteristic.h"
+#include "NimBLEService.h"
+#include "NimBLEUUID.h"
+#include "services/heap.h"
+#include "services/tasks.h"
+
+/** Handler class for the task statistics characteristic */
+class TaskStatsCallbacks : public NimBLECharacteristicCallbacks {
+    // Reads return a task report covering the time since the previous one.
+    void onRead(NimBLECharacteristic* pCharacteristic,
+                NimBLEConnInfo& connInfo) override {
+        struct __attribute__((packed)) {
+            TaskStatsHeader header;
+            TaskStatsRecord records[Tasks::maxReportedTasks];
+        } report;
+        size_t count = collectTaskStats(&report.header, report.records,
+                                        Tasks::maxReportedTasks);
+        pCharacteristic->setValue(
+            (uint8_t*)&report,
+            sizeof(TaskStatsHeader) + count * sizeof(TaskStatsRecord));
+    }
+
+    // Any write prints a task report to the serial log.
+    void onWrite(NimBLECharacteristic* pCharacteristic,
+                 NimBLEConnInfo& connInfo) override {
+        logTaskStats();
+    }
+} taskStatsCallbacks;
+
+NimBLECharacteristic* initTaskStatsCharacteristic(NimBLEService* pService,
+                                                  NimBLEUUID uuid) {
+    NimBLECharacteristic* pTaskStatsChar = pService->createCharacteristic(
+        uuid, NIMBLE_PROPERTY::READ | NIMBLE_PROPERTY::WRITE);
+    pTaskStatsChar->setCallbacks(&taskStatsCallbacks);
+
+    return pTaskStatsChar;
+}
+
+/** Handler class for the stack usage characteristic */
+class StackUsageCallbacks : public NimBLECharacteristicCallbacks {
+    // Reads return the smallest free stack seen per task.
+    void onRead(NimBLECharacteristic* pCharacteristic,
+                NimBLEConnInfo& connInfo) override {
+        StackUsageRecord records[Tasks::maxStackRecords];
+        size_t count = copyStackUsage(records, Tasks::maxStackRecords);
+        pCharacteristic->setValue((uint8_t*)records,
+                                  count * sizeof(StackUsageRecord));
+    }
+
+    // Any write prints the stack usage to the serial log.
+    void onWrite(NimBLECharacteristic* pCharacteristic,
+                 NimBLEConnInfo& connInfo) override {
+        logStackUsage();
+    }
+} stackUsageCallbacks;
+
+NimBLECharacteristic* initStackUsageCharacteristic(NimBLEService* pService,
+                                                   NimBLEUUID uuid) {
+    NimBLECharacteristic* pStackChar = pService->createCharacteristic(
+        uuid, NIMBLE_PROPERTY::READ | NIMBLE_PROPERTY::WRITE);
+    pStackChar->setCallbacks(&stackUsageCallbacks);
+
+    return pStackChar;
+}
+
+/** Handler class for the heap characteristic */
+class HeapCallbacks : public NimBLECharacteristicCallbacks {
+    // Reads return the last heap sample and the use of every memory budget.
+    void onRead(NimBLECharacteristic* pCharacteristic,
+                NimBLEConnInfo& connInfo) override {
+        struct __attribute__((packed)) {
+            HeapHeader header;
+            HeapBudgetRecord records[(size_t)MemoryPool::count];
+        } report;
+        size_t count = collectHeapStats(&report.header, report.records,
+                                        (size_t)MemoryPool::count);
+        pCharacteristic->setValue(
+            (uint8_t*)&report,
+            sizeof(HeapHeader) + count * sizeof(HeapBudgetRecord));
+    }
+
+    // Any write prints a heap report to the serial log.
+    void onWrite(NimBLECharacteristic* pCharacteristic,
+                 NimBLEConnInfo& connInfo) override {
+        logHeapStats();
+    }
+} heapCallbacks;
+
+NimBLECharacteristic* initHeapCharacteristic(NimBLEService* pService,
+                                             NimBLEUUID uuid) {
+    NimBLECharacteristic* pHeapChar = pService->createCharacteristic(
+        uuid, NIMBLE_PROPERTY::READ | NIMBLE_PROPERTY::WRITE);
+    pHeapChar->setCallbacks(&heapCallbacks);
+
+    return pHeapChar;
+}
+
+#endif  // OSSM_COMMUNICATION_TASKSTATS_HPP
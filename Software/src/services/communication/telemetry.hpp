@@ -0,0 +1,169 @@
+#ifndef OSSM_COMMUNICATION_TELEMETRY_HPP
+#define OSSM_COMMUNICATION_TELEMETRY_HPP
+
+#include <atomic>
+
+#include "NimBLECharacteristic.h"
+#include "NimBLEService.h"
+#include "NimBLEUUID.h"
+#include "constants/Config.h"
+#include "constants/LogTags.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "latency.hpp"
+#include "services/stepper.h"
+#include "services/tasks.h"
+#include "utils/SpscRing.h"
+#include "utils/TelemetryPacker.h"
+
+// Samples waiting to be packed, 320ms at the highest rate
+#define TELEMETRY_QUEUE_LENGTH 64
+// Largest notification payload, MTU 247 minus the ATT header
+#define TELEMETRY_PACKET_SIZE 244
+
+/**
+ * Motion telemetry: an esp_timer samples position and speed of the stepper
+ * while a client is subscribed. telemetryLoop packs the samples into as few
+ * notifications as the MTU allows, so the radio sends a few large packets
+ * instead of one per sample.
+ */
+typedef TelemetryPacker<TELEMETRY_PACKET_SIZE> TelemetryPacket;
+
+static SpscRing<TelemetrySample, TELEMETRY_QUEUE_LENGTH> telemetrySamples;
+static esp_timer_handle_t telemetryTimer = nullptr;
+static TaskHandle_t telemetryTaskH = nullptr;
+static NimBLECharacteristic* pTelemetryCharacteristic = nullptr;
+
+static std::atomic<uint16_t> telemetryRateHz{Config::Advanced::telemetryRateHz};
+static std::atomic<size_t> telemetryLimit{20};  // Default MTU of 23
+static std::atomic<size_t> telemetryBatch{1};   // Samples per notification
+static std::atomic<bool> telemetryClipping{false};
+static int telemetrySubscribers = 0;
+
+// Registered with the StrokeEngine, it reports whether the current move got
+// clipped whenever a move starts. That is also when a probed command counts as
+// applied.
+static void onStrokeTelemetry(float position, float speed, bool clipping) {
+    telemetryClipping = clipping;
+    markLatency(LatencyStage::applied);
+}
+
+// Runs in the esp_timer task, so it must stay short.
+static void sampleTelemetry(void* arg) {
+    TelemetrySample sample = {(uint32_t)millis(),
+                              stepper->getCurrentPosition(),
+                              stepper->getCurrentSpeedInMilliHz() / 1000,
+                              telemetryClipping};
+    telemetrySamples.push(sample);
+
+    if (telemetrySamples.size() >= telemetryBatch) {
+        xTaskNotifyGive(telemetryTaskH);
+    }
+}
+
+// (Re)starts sampling at the current rate while anyone is subscribed.
+static void restartTelemetry() {
+    esp_timer_stop(telemetryTimer);
+
+    uint16_t rate = telemetryRateHz;
+    if (telemetrySubscribers > 0 && rate > 0) {
+        esp_timer_start_periodic(telemetryTimer, 1000000 / rate);
+    }
+}
+
+static void sendTelemetry(TelemetryPacket& packet) {
+    size_t length = packet.finish();
+    pTelemetryCharacteristic->setValue(packet.data(), length);
+    pTelemetryCharacteristic->notify();
+}
+
+static void telemetryLoop(void* pvParameters) {
+    TelemetryPacket packet;
+    TelemetrySample sample;
+    uint16_t sequence = 0;
+
+    while (true) {
+        // Woken once a notification is full, partial ones go out on timeout
+        ulTaskNotifyTake(pdTRUE,
+                         pdMS_TO_TICKS(Config::Advanced::telemetryFlushMs));
+
+        uint8_t intervalMs = 1000 / max((int)telemetryRateHz, 1);
+        packet.begin(sequence, intervalMs, telemetryLimit);
+
+        while (telemetrySamples.pop(sample)) {
+            if (!packet.add(sample)) {
+                sendTelemetry(packet);
+                packet.begin(++sequence, intervalMs, telemetryLimit);
+                packet.add(sample);
+            }
+        }
+
+        if (packet.size() > 0) {
+            sendTelemetry(packet);
+            sequence++;
+        }
+    }
+}
+
+/** Handler class for the motion telemetry characteristic */
+class TelemetryCallbacks : public NimBLECharacteristicCallbacks {
+    // Sampling only runs while a client is subscribed. Notifications are
+    // sized for the smallest MTU among the subscribers.
+    void onSubscribe(NimBLECharacteristic* pCharacteristic,
+                     NimBLEConnInfo& connInfo, uint16_t subValue) override {
+        size_t limit = connInfo.getMTU() - 3;
+        if (subValue > 0) {
+            telemetrySubscribers++;
+            if (telemetrySubscribers == 1 || limit < telemetryLimit) {
+                telemetryLimit = min(limit, (size_t)TELEMETRY_PACKET_SIZE);
+            }
+        } else if (telemetrySubscribers > 0) {
+            telemetrySubscribers--;
+        }
+
+        telemetryBatch =
+            max(TelemetryPacket::capacity(telemetryLimit), (size_t)1);
+        ESP_LOGD(NIMBLE_TAG, "Telemetry subscribers: %d, %u samples per packet",
+                 telemetrySubscribers, (unsigned)telemetryBatch);
+        restartTelemetry();
+    }
+
+    // A uint16 sets the sample rate in Hz, 0 pauses the telemetry.
+    void onWrite(NimBLECharacteristic* pCharacteristic,
+                 NimBLEConnInfo& connInfo) override {
+        if (pCharacteristic->getValue().size() < sizeof(uint16_t)) {
+            ESP_LOGW(NIMBLE_TAG, "Invalid telemetry rate");
+            return;
+        }
+
+        uint16_t rate = pCharacteristic->getValue<uint16_t>();
+        telemetryRateHz =
+            min(rate, (uint16_t)Config::Advanced::telemetryMaxRateHz);
+        ESP_LOGD(NIMBLE_TAG, "Telemetry rate: %u Hz",
+                 (unsigned)telemetryRateHz);
+        restartTelemetry();
+    }
+} telemetryCallbacks;
+
+NimBLECharacteristic* initTelemetryCharacteristic(NimBLEService* pService,
+                                                  NimBLEUUID uuid) {
+    pTelemetryCharacteristic = pService->createCharacteristic(
+        uuid, NIMBLE_PROPERTY::NOTIFY | NIMBLE_PROPERTY::WRITE);
+    pTelemetryCharacteristic->setCallbacks(&telemetryCallbacks);
+
+    Stroker.registerTelemetryCallback(onStrokeTelemetry);
+
+    esp_timer_create_args_t timerArgs = {};
+    timerArgs.callback = &sampleTelemetry;
+    timerArgs.name = "telemetry";
+    esp_timer_create(&timerArgs, &telemetryTimer);
+
+    xTaskCreatePinnedToCore(telemetryLoop, "telemetryLoop",
+                            3 * configMINIMAL_STACK_SIZE, nullptr,
+                            Tasks::communicationPriority, &telemetryTaskH,
+                            Tasks::communicationCore);
+
+    return pTelemetryCharacteristic;
+}
+
+#endif  // OSSM_COMMUNICATION_TELEMETRY_HPP
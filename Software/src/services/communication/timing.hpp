@@ -0,0 +1,35 @@
+#ifndef OSSM_COMMUNICATION_TIMING_HPP
+#define OSSM_COMMUNICATION_TIMING_HPP
+
+#include "NimBLECharacteristic.h"
+#include "NimBLEService.h"
+#include "NimBLEUUID.h"
+#include "utils/StrokeTimingLog.h"
+
+/** Handler class for the stroke timing characteristic */
+class StrokeTimingCallbacks : public NimBLECharacteristicCallbacks {
+    // Reads return the packed statistics of the current session.
+    void onRead(NimBLECharacteristic* pCharacteristic,
+                NimBLEConnInfo& connInfo) override {
+        StrokeTiming timing;
+        Stroker.getTiming(&timing);
+        pCharacteristic->setValue((uint8_t*)&timing, sizeof(timing));
+    }
+
+    // Any write prints the statistics to the serial log.
+    void onWrite(NimBLECharacteristic* pCharacteristic,
+                 NimBLEConnInfo& connInfo) override {
+        dumpStrokeTiming();
+    }
+} strokeTimingCallbacks;
+
+NimBLECharacteristic* initStrokeTimingCharacteristic(NimBLEService* pService,
+                                                     NimBLEUUID uuid) {
+    NimBLECharacteristic* pTimingChar = pService->createCharacteristic(
+        uuid, NIMBLE_PROPERTY::READ | NIMBLE_PROPERTY::WRITE);
+    pTimingChar->setCallbacks(&strokeTimingCallbacks);
+
+    return pTimingChar;
+}
+
+#endif  // OSSM_COMMUNICATION_TIMING_HPP
@@ -0,0 +1,38 @@
+#ifndef OSSM_COMMUNICATION_TRACE_HPP
+#define OSSM_COMMUNICATION_TRACE_HPP
+
+#include "NimBLECharacteristic.h"
+#include "NimBLEService.h"
+#include "NimBLEUUID.h"
+#include "constants/LogTags.h"
+#include "esp_log.h"
+#include "utils/StateLogger.h"
+
+/** Handler class for the state trace characteristic */
+class StateTraceCallbacks : public NimBLECharacteristicCallbacks {
+    // Reads return the newest trace records, oldest first.
+    void onRead(NimBLECharacteristic* pCharacteristic,
+                NimBLEConnInfo& connInfo) override {
+        StateTraceRecord records[STATE_TRACE_LENGTH];
+        size_t count = copyStateTrace(records, STATE_TRACE_LENGTH);
+        pCharacteristic->setValue((uint8_t*)records,
+                                  count * sizeof(StateTraceRecord));
+    }
+
+    // Any write prints the trace to the serial log.
+    void onWrite(NimBLECharacteristic* pCharacteristic,
+                 NimBLEConnInfo& connInfo) override {
+        dumpStateTrace();
+    }
+} stateTraceCallbacks;
+
+NimBLECharacteristic* initStateTraceCharacteristic(NimBLEService* pService,
+                                                   NimBLEUUID uuid) {
+    NimBLECharacteristic* pTraceChar = pService->createCharacteristic(
+        uuid, NIMBLE_PROPERTY::READ | NIMBLE_PROPERTY::WRITE);
+    pTraceChar->setCallbacks(&stateTraceCallbacks);
+
+    return pTraceChar;
+}
+
+#endif  // OSSM_COMMUNICATION_TRACE_HPP
@@ -2,7 +2,11 @@
 
 #include <esp_log.h>
 
-SemaphoreHandle_t displayMutex = nullptr;
+#include <cstring>
+
+#include "services/profiler.h"
+#include "services/tasks.h"
+
 static auto TAG = "DISPLAY";
 
 static auto ROTATION = U8G2_R0;
@@ -13,75 +17,210 @@ U8G2_SSD1306_128X64_NONAME_F_HW_I2C display(ROTATION, Pins::Display::oledReset,
 
 const char EMPTY_STRING[] PROGMEM = "";
 
-void initDisplay() {
-    ESP_LOGI(TAG, "Initializing display...");
-    if (displayMutex == nullptr) {
-        displayMutex = xSemaphoreCreateMutex();
-        if (displayMutex == nullptr) {
-            ESP_LOGE(TAG, "Failed to create display mutex");
+#define TILE_COLUMNS (SCREEN_WIDTH / 8)
+#define TILE_ROWS (SCREEN_HEIGHT / 8)
+#define TILE_BYTES 8
+#define FRAME_BYTES (SCREEN_WIDTH * SCREEN_HEIGHT / 8)
+
+// A finished frame is copied from the U8G2 buffer into pendingFrame, and the
+// flush task sends it from its own copy while the next frame is drawn.
+// shownFrame is what is currently on the panel, only tiles that differ from
+// it are sent.
+static uint8_t pendingFrame[FRAME_BYTES];
+static uint8_t sendingFrame[FRAME_BYTES];
+static uint8_t shownFrame[FRAME_BYTES];
+static portMUX_TYPE frameLock = portMUX_INITIALIZER_UNLOCKED;
+
+static void sendChangedTiles() {
+    OSSM_PROFILE_SCOPE(displayFlush);
+    u8x8_t *u8x8 = display.getU8x8();
+
+    for (uint8_t row = 0; row < TILE_ROWS; row++) {
+        int spanStart = -1;
+
+        // One past the end to close a span that reaches the last column
+        for (uint8_t column = 0; column <= TILE_COLUMNS; column++) {
+            size_t offset = (row * TILE_COLUMNS + column) * TILE_BYTES;
+            bool isDirty = column < TILE_COLUMNS &&
+                           memcmp(&sendingFrame[offset], &shownFrame[offset],
+                                  TILE_BYTES) != 0;
+
+            if (isDirty && spanStart < 0) {
+                spanStart = column;
+            } else if (!isDirty && spanStart >= 0) {
+                // Send adjacent dirty tiles in one transfer
+                size_t start = (row * TILE_COLUMNS + spanStart) * TILE_BYTES;
+                u8x8_DrawTile(u8x8, spanStart, row, column - spanStart,
+                              &sendingFrame[start]);
+                spanStart = -1;
+            }
+        }
+    }
+
+    memcpy(shownFrame, sendingFrame, FRAME_BYTES);
+}
+
+[[noreturn]] static void flushTask(void *pvParameters) {
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        // Frames queued during the last transfer collapse into the newest.
+        portENTER_CRITICAL(&frameLock);
+        memcpy(sendingFrame, pendingFrame, FRAME_BYTES);
+        portEXIT_CRITICAL(&frameLock);
+
+        sendChangedTiles();
+    }
+}
+
+// Hands the current frame to the flush task and returns right away.
+static void queueFrame() {
+    portENTER_CRITICAL(&frameLock);
+    memcpy(pendingFrame, display.getBufferPtr(), FRAME_BYTES);
+    portEXIT_CRITICAL(&frameLock);
+
+    if (Tasks::displayFlushTaskH != nullptr) {
+        xTaskNotifyGive(Tasks::displayFlushTaskH);
+    }
+}
+
+// Blocking send of the whole frame, only used before the tasks run.
+static void sendFullBuffer() {
+    display.setMaxClipWindow();
+    display.sendBuffer();
+    memcpy(shownFrame, display.getBufferPtr(), FRAME_BYTES);
+}
+
+// Newest scene per layer. Producers swap their scene in and the render task
+// swaps it out, so nothing is allocated or freed while the lock is held.
+struct SceneSlot {
+    DisplayScene scene;
+    bool isPending = false;
+};
+
+static SceneSlot sceneSlots[(int)DisplayLayer::count];
+static portMUX_TYPE sceneLock = portMUX_INITIALIZER_UNLOCKED;
+static uint32_t pageScenes = 0;
+
+uint32_t pageScenesDrawn() { return pageScenes; }
+
+void drawScene(DisplayLayer layer, DisplayScene scene) {
+    SceneSlot &slot = sceneSlots[(int)layer];
+
+    portENTER_CRITICAL(&sceneLock);
+    std::swap(slot.scene, scene);
+    slot.isPending = true;
+    portEXIT_CRITICAL(&sceneLock);
+
+    if (Tasks::renderTaskH != nullptr) {
+        xTaskNotifyGive(Tasks::renderTaskH);
+    }
+    // The replaced scene is released here, outside the lock.
+}
+
+[[noreturn]] static void renderTask(void *pvParameters) {
+    DisplayScene scenes[(int)DisplayLayer::count];
+    const TickType_t framePeriod = pdMS_TO_TICKS(1000 / DISPLAY_MAX_FPS);
+
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        TickType_t frameStart = xTaskGetTickCount();
+
+        bool isPending[(int)DisplayLayer::count] = {};
+        portENTER_CRITICAL(&sceneLock);
+        for (int layer = 0; layer < (int)DisplayLayer::count; layer++) {
+            if (sceneSlots[layer].isPending) {
+                std::swap(sceneSlots[layer].scene, scenes[layer]);
+                sceneSlots[layer].isPending = false;
+                isPending[layer] = true;
+            }
+        }
+        portEXIT_CRITICAL(&sceneLock);
+
+        const int page = (int)DisplayLayer::page;
+        const int icons = (int)DisplayLayer::icons;
+
+        if (isPending[page] && scenes[page]) {
+            scenes[page]();
+            pageScenes++;
+        }
+        // Pages are free to clear the icon area, so the icons are drawn again
+        // on top of every new page.
+        if ((isPending[page] || isPending[icons]) && scenes[icons]) {
+            scenes[icons]();
         }
+
+        queueFrame();
+
+        // Scenes that arrive before the next frame are merged into it.
+        vTaskDelayUntil(&frameStart, framePeriod);
     }
+}
+
+void initDisplay() {
+    ESP_LOGI(TAG, "Initializing display...");
     display.begin();
     display.setI2CAddress(0x3C << 1);  // 0x3C is common for 128x64 OLEDs
     display.setPowerSave(0);
     display.setContrast(255);
     display.clearBuffer();
-    display.sendBuffer();
+    sendFullBuffer();
+
+    if (Tasks::displayFlushTaskH == nullptr) {
+        xTaskCreatePinnedToCore(flushTask, "displayFlushTask",
+                                3 * configMINIMAL_STACK_SIZE, nullptr,
+                                Tasks::renderPriority,
+                                &Tasks::displayFlushTaskH, Tasks::renderCore);
+        if (Tasks::displayFlushTaskH == nullptr) {
+            ESP_LOGE(TAG, "Failed to create display flush task");
+        }
+    }
+
+    if (Tasks::renderTaskH == nullptr) {
+        xTaskCreatePinnedToCore(renderTask, "renderTask",
+                                6 * configMINIMAL_STACK_SIZE, nullptr,
+                                Tasks::renderPriority, &Tasks::renderTaskH,
+                                Tasks::renderCore);
+        if (Tasks::renderTaskH == nullptr) {
+            ESP_LOGE(TAG, "Failed to create render task");
+        }
+    }
 
     ESP_LOGI(TAG, "Display initialization complete.");
 }
 
 #define ICON_TILES 4
 
-void clearIcons() {
-    display.setClipWindow(128 - 8 * ICON_TILES, 0, 128, 8);
-    display.clearBuffer();
+// What setHeader() drew last, forgotten when the header is cleared
+static String lastHeaderText = EMPTY_STRING;
+
+// Clears the region and leaves it as the clip window. clearBuffer() would
+// wipe the whole frame, which is fine while only the region gets sent, but
+// the flush task sends every tile that changed.
+static void clearRegion(int x0, int y0, int x1, int y1) {
+    display.setClipWindow(x0, y0, x1, y1);
+    display.setDrawColor(0);
+    display.drawBox(x0, y0, x1 - x0, y1 - y0);
+    display.setDrawColor(1);
 }
 
+void clearIcons() { clearRegion(128 - 8 * ICON_TILES, 0, 128, 8); }
+
 void clearHeader() {
-    display.setClipWindow(0, 0, 128 - 8 * ICON_TILES, 8);
-    display.clearBuffer();
+    clearRegion(0, 0, 128 - 8 * ICON_TILES, 8);
+    lastHeaderText = EMPTY_STRING;
 }
 
-void clearFooter() {
-    display.setClipWindow(0, 64, 128, 64);
-    display.clearBuffer();
-}
+void clearFooter() { clearRegion(0, 56, 128, 64); }
 
 auto clearPage(const bool includeFooter, const bool includeHeader) -> void {
     const int y1 = includeHeader ? 0 : 8;
     const int y2 = includeFooter ? 64 : 56;
 
-    display.setClipWindow(0, y1, 128, y2);
-    display.clearBuffer();
-}
-
-void refreshIcons() {
-    display.setMaxClipWindow();
-    display.updateDisplayArea(16 - ICON_TILES, 0, ICON_TILES, 1);
-}
-
-void refreshHeader() {
-    display.setMaxClipWindow();
-    display.updateDisplayArea(0, 0, 16 - ICON_TILES, 1);
-}
-
-void refreshPage(bool includeFooter, bool includeHeader) {
-    display.setMaxClipWindow();
-
-    if (includeFooter) {
-        refreshFooter();
-    }
+    clearRegion(0, y1, 128, y2);
     if (includeHeader) {
-        refreshHeader();
+        lastHeaderText = EMPTY_STRING;
     }
-
-    display.updateDisplayArea(0, 1, 16, 6);
-}
-
-void refreshFooter() {
-    display.setMaxClipWindow();
-    display.updateDisplayArea(0, 7, 16, 1);
 }
 
 int drawWrappedText(const int x, const int y, const String& text,
@@ -158,7 +297,6 @@ int drawWrappedText(const int x, const int y, const String& text,
     return lineCount;
 }
 
-static String lastHeaderText = EMPTY_STRING;
 static String lastFooterLeftText = EMPTY_STRING;
 static String lastFooterRightText = EMPTY_STRING;
 
@@ -166,12 +304,11 @@ void setHeader(String& text) {
     if (text == lastHeaderText) {
         return;
     }
+    clearHeader();
     lastHeaderText = text;
     text.toUpperCase();
-    clearHeader();
     display.setFont(u8g2_font_spleen5x8_mu);
     display.drawStr(0, 8, text.c_str());
-    refreshHeader();
 }
 
 void setFooter(String& left, String& right) {
@@ -187,5 +324,4 @@ void setFooter(String& left, String& right) {
     display.drawStr(0, 64, left.c_str());
     display.drawStr(128 - display.getStrWidth(right.c_str()) - 8, 64,
                     right.c_str());
-    refreshFooter();
 }
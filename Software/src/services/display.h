@@ -2,6 +2,8 @@
 #define OSSM_SOFTWARE_DISPLAY_H
 #include <U8g2lib.h>
 
+#include <functional>
+
 #include "constants/Pins.h"
 #include "freertos/semphr.h"
 #include "utils/RecursiveMutex.h"
@@ -23,28 +25,42 @@
 #define SCREEN_WIDTH 128  // OLED display width, in pixels
 #define SCREEN_HEIGHT 64  // OLED display height, in pixels
 #define OLED_RESET U8X8_PIN_NONE
+#define DISPLAY_MAX_FPS 30
 
 extern U8G2_SSD1306_128X64_NONAME_F_HW_I2C display;
-extern SemaphoreHandle_t displayMutex;
 
+/**
+ * The render task is the only task that touches the display. Everyone else
+ * hands it a scene, a function that draws into the frame buffer. Scenes are
+ * drawn bottom to top, and the icons are drawn again over every new page.
+ */
+enum class DisplayLayer : uint8_t { page, icons, count };
+
+using DisplayScene = std::function<void()>;
+
+// Never blocks. Only the newest scene of a layer is drawn, and the changed
+// tiles are sent after all pending scenes ran, at most DISPLAY_MAX_FPS times
+// per second. The I2C transfer runs on its own task, from its own copy of the
+// frame, while the render task draws the next one. Scenes run on the render
+// task, so capture values, not locals by reference.
+void drawScene(DisplayLayer layer, DisplayScene scene);
+
+// Page scenes the render task ran so far. Retained screens compare it to
+// tell whether another page was drawn since theirs. Render task only.
+uint32_t pageScenesDrawn();
+
+// Starts the render and flush tasks
 void initDisplay();
 
 void clearIcons();
-void refreshIcons();
 
 void clearHeader();
 void clearFooter();
 void clearPage(bool includeFooter = false, bool includeHeader = false);
 
-void refreshHeader();
-
-void refreshFooter();
-
 void setHeader(String &text);
 void setFooter(String &left, String &right);
 
-void refreshPage(bool includeFooter = false, bool includeHeader = false);
-
 int drawWrappedText(int x, int y, const String &text, bool center = false);
 
 #endif  // OSSM_SOFTWARE_DISPLAY_H
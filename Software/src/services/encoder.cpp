@@ -1,5 +1,7 @@
 #include "encoder.h"
 
+#include "services/input.h"
+
 // Define the global encoder instance
 AiEsp32RotaryEncoder encoder(
     Pins::Remote::encoderA, 
@@ -9,8 +11,9 @@ AiEsp32RotaryEncoder encoder(
     Pins::Remote::encoderStepsPerNotch
 );
 
-void IRAM_ATTR readEncoderISR() { 
-    encoder.readEncoder_ISR(); 
+void IRAM_ATTR readEncoderISR() {
+    encoder.readEncoder_ISR();
+    pushInputFromISR(InputType::encoder);
 }
 
 void initEncoder() {
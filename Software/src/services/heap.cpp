@@ -0,0 +1,179 @@
+#include "heap.h"
+
+#include <Arduino.h>
+
+#include <cstddef>
+
+#include "constants/Config.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "utils/HeapTrend.h"
+
+static const char* TAG = "HEAP";
+
+static HeapTrend heapTrend(Config::Advanced::heapFragmentedPercent,
+                           Config::Advanced::heapLowBlockBytes,
+                           Config::Advanced::heapTrendPeriodSamples,
+                           Config::Advanced::heapShrinkPeriods);
+static HeapHeader lastSample = {};
+static uint32_t alertCount = 0;
+
+// Indexed by MemoryPool
+static MemoryBudget budgets[(size_t)MemoryPool::count] = {
+    MemoryBudget(Config::Advanced::jsonBudgetBytes),
+    MemoryBudget(Config::Advanced::scriptBudgetBytes),
+};
+static const char* const poolNames[(size_t)MemoryPool::count] = {"json",
+                                                                 "script"};
+static portMUX_TYPE heapLock = portMUX_INITIALIZER_UNLOCKED;
+
+void sampleHeap() {
+    uint32_t caps = MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT;
+    HeapHeader sample = {};
+    sample.freeBytes = heap_caps_get_free_size(caps);
+    sample.largestBlock = heap_caps_get_largest_free_block(caps);
+    sample.minimumFree = heap_caps_get_minimum_free_size(caps);
+    sample.psramFree = heap_caps_get_free_size(MALLOC_CAP_SPIRAM);
+
+    portENTER_CRITICAL(&heapLock);
+    uint8_t raised = heapTrend.add(sample.freeBytes, sample.largestBlock);
+    for (uint8_t bits = raised; bits != 0; bits &= bits - 1) {
+        alertCount++;
+    }
+    sample.fragmentation = heapTrend.getFragmentation();
+    sample.peakFragmentation = heapTrend.getPeakFragmentation();
+    sample.alerts = heapTrend.getAlerts();
+    uint8_t shrinkRun = heapTrend.getShrinkRun();
+    lastSample = sample;
+    portEXIT_CRITICAL(&heapLock);
+
+    if (raised & HeapAlert::fragmented) {
+        ESP_LOGW(TAG, "Heap fragmented: %u%% of %lu free bytes outside the "
+                 "largest block", sample.fragmentation,
+                 (unsigned long)sample.freeBytes);
+    }
+    if (raised & HeapAlert::lowBlock) {
+        ESP_LOGW(TAG, "Largest free block down to %lu bytes",
+                 (unsigned long)sample.largestBlock);
+    }
+    if (raised & HeapAlert::shrinking) {
+        ESP_LOGW(TAG, "Largest free block shrank %u periods in a row, now "
+                 "%lu bytes", shrinkRun, (unsigned long)sample.largestBlock);
+    }
+}
+
+size_t collectHeapStats(HeapHeader* header, HeapBudgetRecord* records,
+                        size_t max) {
+    size_t count = 0;
+    portENTER_CRITICAL(&heapLock);
+    *header = lastSample;
+    header->alertCount = alertCount;
+    for (; count < max && count < (size_t)MemoryPool::count; count++) {
+        const MemoryBudget& budget = budgets[count];
+        records[count] = {(uint8_t)count,        0,
+                          budget.getFailures(), budget.getLimit(),
+                          budget.getUsed(),     budget.getPeak()};
+    }
+    portEXIT_CRITICAL(&heapLock);
+    header->count = (uint8_t)count;
+    return count;
+}
+
+void logHeapStats() {
+    HeapHeader header;
+    HeapBudgetRecord records[(size_t)MemoryPool::count];
+    size_t count =
+        collectHeapStats(&header, records, (size_t)MemoryPool::count);
+
+    ESP_LOGI(TAG,
+             "Heap: %lu free, largest block %lu (%u%% fragmented, peak "
+             "%u%%), minimum %lu, PSRAM %lu, %lu alerts",
+             (unsigned long)header.freeBytes,
+             (unsigned long)header.largestBlock, header.fragmentation,
+             header.peakFragmentation, (unsigned long)header.minimumFree,
+             (unsigned long)header.psramFree,
+             (unsigned long)header.alertCount);
+    for (size_t i = 0; i < count; i++) {
+        const HeapBudgetRecord& record = records[i];
+        ESP_LOGI(TAG, "%-8s %6lu of %6lu bytes, peak %6lu, %u refused",
+                 poolNames[record.pool], (unsigned long)record.used,
+                 (unsigned long)record.limit, (unsigned long)record.peak,
+                 record.failures);
+    }
+}
+
+// Every budget allocation starts with its size and capabilities, padded so
+// the memory handed out keeps the alignment of the heap
+struct BudgetPrefix {
+    uint32_t size;
+    uint32_t caps;
+};
+static constexpr size_t prefixSize =
+    alignof(std::max_align_t) > sizeof(BudgetPrefix)
+        ? alignof(std::max_align_t)
+        : sizeof(BudgetPrefix);
+
+static bool reserve(MemoryPool pool, size_t size) {
+    portENTER_CRITICAL(&heapLock);
+    bool isReserved = budgets[(size_t)pool].reserve(size);
+    portEXIT_CRITICAL(&heapLock);
+    return isReserved;
+}
+
+static void release(MemoryPool pool, size_t size, bool isFailed) {
+    portENTER_CRITICAL(&heapLock);
+    budgets[(size_t)pool].release(size);
+    if (isFailed) {
+        budgets[(size_t)pool].fail();
+    }
+    portEXIT_CRITICAL(&heapLock);
+}
+
+void* budgetMalloc(MemoryPool pool, size_t size, uint32_t caps) {
+    if (!reserve(pool, size)) {
+        return nullptr;
+    }
+    auto* prefix = (BudgetPrefix*)heap_caps_malloc(prefixSize + size, caps);
+    if (prefix == nullptr) {
+        release(pool, size, true);
+        return nullptr;
+    }
+    *prefix = {(uint32_t)size, caps};
+    return (uint8_t*)prefix + prefixSize;
+}
+
+void* budgetRealloc(MemoryPool pool, void* ptr, size_t size) {
+    if (ptr == nullptr) {
+        return budgetMalloc(pool, size, MALLOC_CAP_8BIT);
+    }
+    auto* prefix = (BudgetPrefix*)((uint8_t*)ptr - prefixSize);
+    size_t oldSize = prefix->size;
+    uint32_t caps = prefix->caps;
+
+    // Only the growth has to fit, shrinking always does
+    if (size > oldSize && !reserve(pool, size - oldSize)) {
+        return nullptr;
+    }
+    auto* moved =
+        (BudgetPrefix*)heap_caps_realloc(prefix, prefixSize + size, caps);
+    if (moved == nullptr) {
+        if (size > oldSize) {
+            release(pool, size - oldSize, true);
+        }
+        return nullptr;
+    }
+    if (size < oldSize) {
+        release(pool, oldSize - size, false);
+    }
+    *moved = {(uint32_t)size, caps};
+    return (uint8_t*)moved + prefixSize;
+}
+
+void budgetFree(MemoryPool pool, void* ptr) {
+    if (ptr == nullptr) {
+        return;
+    }
+    auto* prefix = (BudgetPrefix*)((uint8_t*)ptr - prefixSize);
+    release(pool, prefix->size, false);
+    heap_caps_free(prefix);
+}
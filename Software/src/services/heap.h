@@ -0,0 +1,38 @@
+#ifndef OSSM_SOFTWARE_HEAP_H
+#define OSSM_SOFTWARE_HEAP_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "structs/HeapRecord.h"
+
+/**
+ * Memory diagnostics. The stack monitor samples the internal heap every
+ * Tasks::stackSampleIntervalMs: free bytes, the largest free block and the
+ * lowest free heap since boot. A HeapTrend turns the samples into alerts,
+ * which go to the log when they are raised.
+ *
+ * Subsystems that allocate at run time do so from a MemoryPool with a fixed
+ * budget from Config::Advanced, so one of them can't starve NimBLE or the
+ * WiFi, and their use and peak show up in the heap report.
+ */
+
+// Samples the heap right away, called by the stack monitor.
+void sampleHeap();
+
+// Collects a heap report, returns the number of budget records written.
+size_t collectHeapStats(HeapHeader* header, HeapBudgetRecord* records,
+                        size_t max);
+
+// Prints a heap report to the serial log.
+void logHeapStats();
+
+// heap_caps_malloc from the budget of pool. nullptr if it doesn't fit the
+// budget or the heap.
+void* budgetMalloc(MemoryPool pool, size_t size, uint32_t caps);
+// Keeps the capabilities of the first allocation. ptr stays valid if the
+// new size doesn't fit.
+void* budgetRealloc(MemoryPool pool, void* ptr, size_t size);
+void budgetFree(MemoryPool pool, void* ptr);
+
+#endif  // OSSM_SOFTWARE_HEAP_H
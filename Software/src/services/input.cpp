@@ -0,0 +1,95 @@
+#include "input.h"
+
+#include <atomic>
+
+#include "constants/LogTags.h"
+#include "constants/Pins.h"
+#include "esp_timer.h"
+#include "freertos/queue.h"
+#include "services/tasks.h"
+#include "utils/ButtonTicking.h"
+
+#define INPUT_QUEUE_LENGTH 32
+// OneButton needs ticks to time clicks and long presses, and to see an edge
+// once it held for its debounce time, see isButtonTicking(). This is the
+// debounce time OneButton has by default.
+#define BUTTON_TICK_MS 10
+#define BUTTON_DEBOUNCE_MS 50
+
+OneButton button(Pins::Remote::encoderSwitch, false);
+
+static QueueHandle_t inputQueue = nullptr;
+static EventGroupHandle_t inputEvents = nullptr;
+static std::atomic<uint32_t> lastInputUs{0};
+static std::atomic<uint32_t> droppedEvents{0};
+
+void IRAM_ATTR pushInputFromISR(InputType type) {
+    if (inputQueue == nullptr) {
+        return;
+    }
+    InputEvent event = {type, (uint32_t)esp_timer_get_time()};
+    BaseType_t woken = pdFALSE;
+    if (xQueueSendFromISR(inputQueue, &event, &woken) != pdTRUE) {
+        droppedEvents++;
+    }
+    portYIELD_FROM_ISR(woken);
+}
+
+static void IRAM_ATTR onButtonEdge() { pushInputFromISR(InputType::button); }
+
+[[noreturn]] static void inputTask(void *pvParameters) {
+    InputEvent event;
+    while (true) {
+        bool isTicking =
+            isButtonTicking(button.isIdle(), (uint32_t)esp_timer_get_time(),
+                            lastInputUs, BUTTON_DEBOUNCE_MS * 1000);
+        TickType_t timeout =
+            isTicking ? pdMS_TO_TICKS(BUTTON_TICK_MS) : portMAX_DELAY;
+        EventBits_t bits = 0;
+
+        // Drain everything that is waiting, the consumers get one wake up
+        while (xQueueReceive(inputQueue, &event, bits == 0 ? timeout : 0) ==
+               pdTRUE) {
+            lastInputUs = event.timeUs;
+            bits |= event.type == InputType::encoder ? InputEvents::encoder
+                                                     : InputEvents::button;
+        }
+
+        // Runs the gestures on edges and while they are timing
+        button.tick();
+
+        if (bits != 0) {
+            xEventGroupSetBits(inputEvents, bits);
+        }
+
+        if (droppedEvents > 0) {
+            ESP_LOGW("INPUT", "Input queue full, dropped %u events",
+                     droppedEvents.exchange(0));
+        }
+    }
+}
+
+void initInput() {
+    inputQueue = xQueueCreate(INPUT_QUEUE_LENGTH, sizeof(InputEvent));
+    inputEvents = xEventGroupCreate();
+
+    // Encoder edges come from readEncoderISR()
+    attachInterrupt(digitalPinToInterrupt(Pins::Remote::encoderSwitch),
+                    onButtonEdge, CHANGE);
+
+    xTaskCreatePinnedToCore(inputTask, "inputTask",
+                            4 * configMINIMAL_STACK_SIZE, nullptr,
+                            Tasks::inputPriority, nullptr, Tasks::inputCore);
+}
+
+EventBits_t waitForInput(TickType_t timeout) {
+    if (inputEvents == nullptr) {
+        vTaskDelay(timeout);
+        return 0;
+    }
+    return xEventGroupWaitBits(inputEvents, InputEvents::all, pdTRUE, pdFALSE,
+                               timeout) &
+           InputEvents::all;
+}
+
+uint32_t getLastInputUs() { return lastInputUs; }
@@ -0,0 +1,51 @@
+#ifndef OSSM_SOFTWARE_INPUT_H
+#define OSSM_SOFTWARE_INPUT_H
+
+#include <Arduino.h>
+
+#include "OneButton.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
+
+/**
+ * Encoder and button input. The GPIO interrupts of both timestamp every edge
+ * into a queue, the input task drains it, runs the button gestures and
+ * wakes whoever waits in waitForInput(). Nothing polls while the controls
+ * are left alone.
+ */
+namespace InputEvents {
+    constexpr EventBits_t encoder = (1 << 0);
+    constexpr EventBits_t button = (1 << 1);
+
+    constexpr EventBits_t all = encoder | button;
+}
+
+enum class InputType : uint8_t {
+    encoder,  // The encoder moved, read its value
+    button,   // The switch changed, OneButton reads its level
+};
+
+struct InputEvent {
+    InputType type;
+    uint32_t timeUs;  // esp_timer_get_time() in the interrupt
+};
+
+// The encoder switch. Attach the gesture handlers before initInput().
+extern OneButton button;
+
+void initInput();
+
+// Queues an event from a GPIO interrupt, dropped before initInput().
+void IRAM_ATTR pushInputFromISR(InputType type);
+
+/**
+ * Blocks until the encoder moves or the button changes, or for timeout.
+ * Only one task should wait at a time, the UI task of the current state.
+ * @return the InputEvents that happened, 0 on timeout
+ */
+EventBits_t waitForInput(TickType_t timeout);
+
+// Time of the newest input in esp_timer_get_time() microseconds
+uint32_t getLastInputUs();
+
+#endif  // OSSM_SOFTWARE_INPUT_H
@@ -0,0 +1,31 @@
+#ifndef OSSM_SOFTWARE_JSON_H
+#define OSSM_SOFTWARE_JSON_H
+
+#include <ArduinoJson.h>
+
+#include "esp_heap_caps.h"
+#include "services/heap.h"
+
+/**
+ * Allocator for JsonDocuments, from the json budget of services/heap.h:
+ *   JsonDocument doc(&jsonAllocator);
+ * A document that runs out of budget reports overflowed().
+ */
+class JsonBudgetAllocator : public ArduinoJson::Allocator {
+  public:
+    void* allocate(size_t size) override {
+        return budgetMalloc(MemoryPool::json, size, MALLOC_CAP_8BIT);
+    }
+
+    void deallocate(void* pointer) override {
+        budgetFree(MemoryPool::json, pointer);
+    }
+
+    void* reallocate(void* pointer, size_t size) override {
+        return budgetRealloc(MemoryPool::json, pointer, size);
+    }
+};
+
+inline JsonBudgetAllocator jsonAllocator;
+
+#endif  // OSSM_SOFTWARE_JSON_H
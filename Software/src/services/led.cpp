@@ -1,85 +1,245 @@
 #include "led.h"
 #include <esp_log.h>
+
+#include <atomic>
+
 #include "components/HeaderBar.h"
+#include "services/profiler.h"
+#include "services/tasks.h"
 
-CRGB leds[NUM_LEDS];
+static CRGB leds[NUM_LEDS];
 static auto TAG = "LED";
 
+static TaskHandle_t ledTaskHandle = nullptr;
+
+// Requests, written by any task and picked up with the next frame
+static portMUX_TYPE ledLock = portMUX_INITIALIZER_UNLOCKED;
+static LedAnimation requested;
+static bool isRequested = false;
+static std::atomic<uint8_t> brightness{128};  // 50% by default
+static std::atomic<uint32_t> commPulseTime{0};
+static std::atomic<bool> homingActiveFlag{false};
+
+static const uint8_t baseDimLevel = 30;  // Dim level when connected (out of 255)
+static const uint32_t RAINBOW_MS = 1000;  // Rainbow when the BLE status changes
+static const uint32_t CONNECTED_FADE_MS = 2000;
+static const uint32_t COMM_PULSE_MS = 100;
+static const uint8_t COMM_PULSE_BOOST = 15;
+static const uint32_t ADVERTISING_TIMEOUT = 30000;  // 30 seconds in milliseconds
+
+static LedAnimation makeAnimation(LedEffect effect, uint32_t color,
+                                  uint16_t periodMs, uint8_t from, uint8_t to,
+                                  uint32_t startMs, uint32_t durationMs = 0) {
+    LedAnimation animation;
+    animation.effect = effect;
+    animation.color = color;
+    animation.periodMs = periodMs;
+    animation.from = from;
+    animation.to = to;
+    animation.startMs = startMs;
+    animation.durationMs = durationMs;
+    return animation;
+}
+
+static uint32_t toRGB(CRGB color) {
+    return ((uint32_t)color.r << 16) | ((uint32_t)color.g << 8) | color.b;
+}
+
+/**
+ * Status animation, in order of priority:
+ *  - homing: deep purple breathing
+ *  - advertising: rainbow, then fast blue breathing, dimmed after 30s
+ *  - connected: rainbow, then blue fading to a dim level, pulsing on traffic
+ *  - disconnected: off
+ */
+class StatusAnimation {
+  public:
+    LedFrame render(uint32_t now) {
+        if (homingActiveFlag) {
+            return renderLedAnimation(
+                makeAnimation(LedEffect::breathe, toRGB(COLOR_DEEP_PURPLE),
+                              1400, baseDimLevel, 255, 0),
+                now);
+        }
+
+        BleStatus status = getBleStatus();
+        if (status != lastStatus) {
+            ESP_LOGI(TAG, "BLE status changed to: %d", (int)status);
+            lastStatus = status;
+            changeTime = now;
+        }
+        uint32_t elapsed = now - changeTime;
+
+        switch (status) {
+            case BleStatus::ADVERTISING:
+                if (elapsed < RAINBOW_MS) {
+                    return rainbow(now);
+                }
+                if (elapsed < ADVERTISING_TIMEOUT) {
+                    return renderLedAnimation(
+                        makeAnimation(LedEffect::breathe, toRGB(CRGB::Blue),
+                                      1000, 0, 255, changeTime),
+                        now);
+                }
+                return renderLedAnimation(
+                    makeAnimation(LedEffect::breathe, toRGB(CRGB::Blue), 2600,
+                                  baseDimLevel, baseDimLevel + 40,
+                                  changeTime + ADVERTISING_TIMEOUT),
+                    now);
+
+            case BleStatus::CONNECTED: {
+                if (elapsed < RAINBOW_MS) {
+                    return rainbow(now);
+                }
+                LedFrame frame = renderLedAnimation(
+                    makeAnimation(LedEffect::fade, toRGB(CRGB::Blue),
+                                  CONNECTED_FADE_MS, 255, baseDimLevel,
+                                  changeTime + RAINBOW_MS),
+                    now);
+
+                // Communication pulse overlay, fading from +15 to +0
+                uint32_t pulseElapsed = now - commPulseTime.load();
+                if (commPulseTime.load() != 0 && pulseElapsed < COMM_PULSE_MS) {
+                    uint8_t boost =
+                        lerpLevel(COMM_PULSE_BOOST, 0, pulseElapsed,
+                                  COMM_PULSE_MS);
+                    frame.level = min(255, frame.level + boost);
+                }
+                return frame;
+            }
+
+            default:
+                // LED should be off
+                return LedFrame();
+        }
+    }
+
+    // Traffic only pulses once the connected fade is over
+    bool isConnectedDimmed(uint32_t now) const {
+        return lastStatus == BleStatus::CONNECTED &&
+               now - changeTime >= RAINBOW_MS + CONNECTED_FADE_MS;
+    }
+
+  private:
+    LedFrame rainbow(uint32_t now) const {
+        return renderLedAnimation(
+            makeAnimation(LedEffect::rainbow, 0, RAINBOW_MS, 0, 255,
+                          changeTime),
+            now);
+    }
+
+    BleStatus lastStatus = BleStatus::DISCONNECTED;
+    uint32_t changeTime = 0;
+};
+
+static StatusAnimation statusAnimation;
+static std::atomic<bool> isConnectedDimmed{false};
+
+static CRGB toColor(const LedFrame &frame) {
+    CRGB color = frame.isHue ? CRGB(CHSV(frame.hue, 255, 255))
+                             : CRGB(frame.color);
+    color.nscale8(frame.level);
+    return color;
+}
+
+// Renders one frame every LED_FRAME_MS. The LED is only written when the
+// frame differs from what it shows.
+[[noreturn]] static void ledTask(void* pvParameters) {
+    CRGB shown = COLOR_OFF;
+    uint8_t shownBrightness = 0;
+    bool isFirst = true;
+    TickType_t lastWake = xTaskGetTickCount();
+
+    while (true) {
+        uint32_t now = millis();
+
+        LedAnimation animation;
+        bool hasAnimation;
+        portENTER_CRITICAL(&ledLock);
+        if (isRequested && requested.isDone(now)) {
+            isRequested = false;
+        }
+        animation = requested;
+        hasAnimation = isRequested;
+        portEXIT_CRITICAL(&ledLock);
+
+        // The status animation keeps track of its changes even while hidden
+        LedFrame frame = statusAnimation.render(now);
+        isConnectedDimmed = statusAnimation.isConnectedDimmed(now);
+        if (hasAnimation) {
+            frame = renderLedAnimation(animation, now);
+        }
+
+        CRGB color = toColor(frame);
+        uint8_t level = brightness.load();
+        if (isFirst || color != shown || level != shownBrightness) {
+            leds[0] = color;
+            FastLED.setBrightness(level);
+            {
+                OSSM_PROFILE_SCOPE(ledShow);
+                FastLED.show();
+            }
+            shown = color;
+            shownBrightness = level;
+            isFirst = false;
+        }
+
+        vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(LED_FRAME_MS));
+    }
+}
+
 void initLED() {
     ESP_LOGI(TAG, "Initializing RGB LED on pin %d...", Pins::Display::ledPin);
-    
+
     FastLED.addLeds<LED_TYPE, Pins::Display::ledPin, COLOR_ORDER>(leds, NUM_LEDS);
-    FastLED.setBrightness(128); // Set to 50% brightness by default
-    
-    // Turn off LED initially
-    setLEDOff();
-    
+
+    xTaskCreatePinnedToCore(ledTask, "ledTask",
+                            3 * configMINIMAL_STACK_SIZE, nullptr,
+                            Tasks::renderPriority, &ledTaskHandle,
+                            Tasks::renderCore);
+
     ESP_LOGI(TAG, "RGB LED initialization complete.");
 }
 
-void setLEDColor(CRGB color) {
-    leds[0] = color;
-    FastLED.show();
+void playLED(LedAnimation animation) {
+    animation.startMs = millis();
+    portENTER_CRITICAL(&ledLock);
+    requested = animation;
+    isRequested = true;
+    portEXIT_CRITICAL(&ledLock);
 }
 
-void setLEDColor(uint8_t r, uint8_t g, uint8_t b) {
-    leds[0] = CRGB(r, g, b);
-    FastLED.show();
+void clearLED() {
+    portENTER_CRITICAL(&ledLock);
+    isRequested = false;
+    portEXIT_CRITICAL(&ledLock);
 }
 
-void setLEDOff() {
-    leds[0] = COLOR_OFF;
-    FastLED.show();
+void setLEDColor(CRGB color) {
+    playLED(makeAnimation(LedEffect::solid, toRGB(color), 0, 0, 255, 0));
 }
 
-void setLEDBrightness(uint8_t brightness) {
-    FastLED.setBrightness(brightness);
-    FastLED.show();
+void setLEDColor(uint8_t r, uint8_t g, uint8_t b) {
+    setLEDColor(CRGB(r, g, b));
 }
 
+// Holds the LED dark until clearLED()
+void setLEDOff() { setLEDColor(COLOR_OFF); }
+
+void setLEDBrightness(uint8_t level) { brightness = level; }
+
 void flashLED(CRGB color, int duration_ms) {
-    setLEDColor(color);
-    delay(duration_ms);
-    setLEDOff();
+    playLED(makeAnimation(LedEffect::solid, toRGB(color), 0, 0, 255, 0,
+                          duration_ms));
 }
 
 void breatheLED(CRGB color, int period_ms) {
-    static unsigned long lastUpdate = 0;
-    static int breatheValue = 0;
-    static bool increasing = true;
-    
-    unsigned long currentTime = millis();
-    if (currentTime - lastUpdate > (period_ms / 510)) {  // 255 steps up + 255 steps down
-        lastUpdate = currentTime;
-        
-        if (increasing) {
-            breatheValue++;
-            if (breatheValue >= 255) {
-                increasing = false;
-            }
-        } else {
-            breatheValue--;
-            if (breatheValue <= 0) {
-                increasing = true;
-            }
-        }
-        
-        CRGB dimmedColor = color;
-        dimmedColor.nscale8(breatheValue);
-        setLEDColor(dimmedColor);
-    }
+    playLED(
+        makeAnimation(LedEffect::breathe, toRGB(color), period_ms, 0, 255, 0));
 }
 
 void cycleLED(int period_ms) {
-    static unsigned long lastUpdate = 0;
-    static uint8_t hue = 0;
-    
-    unsigned long currentTime = millis();
-    if (currentTime - lastUpdate > (period_ms / 256)) {
-        lastUpdate = currentTime;
-        hue++;
-        setLEDColor(CHSV(hue, 255, 255));
-    }
+    playLED(makeAnimation(LedEffect::rainbow, 0, period_ms, 0, 255, 0));
 }
 
 // Status indication functions
@@ -108,277 +268,17 @@ void setLEDStatusConnecting() {
     ESP_LOGD(TAG, "LED status: CONNECTING (Purple)");
 }
 
-// BLE status indication functions
-static BleStatus lastBLEStatus = BleStatus::DISCONNECTED;
-static unsigned long bleStatusChangeTime = 0;
-static unsigned long rainbowStartTime = 0;
-static bool rainbowActive = false;
-static bool fadeActive = false;
-static bool connectedDimmed = false;  // New flag for dimmed connected state
-static uint8_t fadeValue = 255;
-static unsigned long lastPulseTime = 0;
-static int pulseCount = 0;
-static bool pulseState = false;
-
-// Communication pulse variables
-static bool commPulseActive = false;
-static unsigned long commPulseStartTime = 0;
-static uint8_t baseDimLevel = 30;  // Dim level when connected (out of 255)
-
-// Advertising timeout variables
-static bool advertisingDimmed = false;  // Flag for dimmed advertising after timeout
-static unsigned long advertisingStartTime = 0;  // When advertising started
-static const unsigned long ADVERTISING_TIMEOUT = 30000;  // 30 seconds in milliseconds
-
-void updateLEDForBLEStatus() {
-    BleStatus currentStatus = getBleStatus();
-    unsigned long currentTime = millis();
-    
-    // Check if BLE status changed
-    if (currentStatus != lastBLEStatus) {
-        lastBLEStatus = currentStatus;
-        bleStatusChangeTime = currentTime;
-        rainbowActive = false;
-        fadeActive = false;
-        connectedDimmed = false;
-        pulseCount = 0;
-        pulseState = false;
-        
-        ESP_LOGI(TAG, "BLE status changed to: %d", (int)currentStatus);
-        
-        switch (currentStatus) {
-            case BleStatus::ADVERTISING:
-                // Rainbow will be handled in the continuous loop
-                rainbowActive = true;
-                rainbowStartTime = currentTime;
-                advertisingStartTime = currentTime;  // Track when advertising started
-                advertisingDimmed = false;  // Reset dimmed flag
-                break;
-            case BleStatus::CONNECTED:
-                // Rainbow will be handled in the continuous loop
-                rainbowActive = true;
-                rainbowStartTime = currentTime;
-                advertisingDimmed = false;  // Reset advertising flags
-                break;
-            case BleStatus::DISCONNECTED:
-                showBLEDisconnected();
-                advertisingDimmed = false;  // Reset advertising flags
-                break;
-            default:
-                break;
-        }
-    }
-    
-    // Handle ongoing effects based on current status
-    switch (currentStatus) {
-        case BleStatus::ADVERTISING:
-            if (rainbowActive) {
-                showBLERainbow(1000);
-                if (millis() - rainbowStartTime >= 1000) {
-                    rainbowActive = false;
-                }
-            } else {
-                // Check if advertising timeout has been reached
-                unsigned long advertisingElapsed = currentTime - advertisingStartTime;
-                if (advertisingElapsed >= ADVERTISING_TIMEOUT && !advertisingDimmed) {
-                    advertisingDimmed = true;
-                    ESP_LOGI(TAG, "Advertising timeout reached, switching to dimmed pulsing");
-                }
-                
-                if (advertisingDimmed) {
-                    showBLEAdvertisingDimmed();
-                } else {
-                    showBLEAdvertising();
-                }
-            }
-            break;
-            
-        case BleStatus::CONNECTED:
-            if (rainbowActive) {
-                showBLERainbow(1000);
-                if (millis() - rainbowStartTime >= 1000) {
-                    rainbowActive = false;
-                    fadeActive = true;
-                    fadeValue = 255;
-                }
-            } else if (fadeActive) {
-                showBLEConnected();
-            } else if (connectedDimmed) {
-                showBLEConnected();
-            } else {
-                // Stay dimmed once fade is complete
-                connectedDimmed = true;
-                showBLEConnected();
-            }
-            break;
-            
-        case BleStatus::DISCONNECTED:
-            // LED should be off
-            break;
-            
-        default:
-            break;
-    }
-}
-
-void showBLERainbow(int duration_ms) {
-    if (!rainbowActive) {
-        rainbowActive = true;
-        rainbowStartTime = millis();
-    }
-    
-    unsigned long elapsed = millis() - rainbowStartTime;
-    if (elapsed < duration_ms && rainbowActive) {
-        // Calculate hue based on time elapsed - full rainbow cycle in duration_ms
-        uint8_t hue = (elapsed * 255) / duration_ms;
-        setLEDColor(CHSV(hue, 255, 255));
-    }
-}
-
-void showBLEAdvertising() {
-    // Fast breathing blue effect (10x faster than original)
-    unsigned long currentTime = millis();
-    static unsigned long lastBreathUpdate = 0;
-    static uint8_t breathValue = 0;
-    static bool increasing = true;
-    
-    if (currentTime - lastBreathUpdate >= 1) { // Update every 1ms for very smooth fast breathing
-        lastBreathUpdate = currentTime;
-        
-        if (increasing) {
-            breathValue += 20; // Much larger step for faster breathing (10x increase from 2)
-            if (breathValue >= 255) {
-                increasing = false;
-                breathValue = 255;
-            }
-        } else {
-            breathValue -= 20; // Much larger step for faster breathing (10x increase from 2)  
-            if (breathValue <= 0) {
-                increasing = true;
-                breathValue = 0;
-            }
-        }
-        
-        // Create blue color with breathing intensity
-        CRGB color = CRGB::Blue;
-        color.nscale8(breathValue);
-        setLEDColor(color);
-    }
-}
-
-void showBLEAdvertisingDimmed() {
-    // Dimmed breathing blue effect after 30 second timeout
-    unsigned long currentTime = millis();
-    static unsigned long lastBreathUpdateDimmed = 0;
-    static uint8_t breathValueDimmed = baseDimLevel; // Start at base dim level
-    static bool increasingDimmed = true;
-    
-    if (currentTime - lastBreathUpdateDimmed >= 8) { // Update every 8ms for slower, more subtle breathing
-        lastBreathUpdateDimmed = currentTime;
-        
-        // Pulse range: baseDimLevel (30) to baseDimLevel + 40 (70) - much smaller range
-        uint8_t minLevel = baseDimLevel;
-        uint8_t maxLevel = baseDimLevel + 40; // Only +40 brightness instead of full range
-        
-        if (increasingDimmed) {
-            breathValueDimmed += 3; // Slower step for gentler pulsing
-            if (breathValueDimmed >= maxLevel) {
-                increasingDimmed = false;
-                breathValueDimmed = maxLevel;
-            }
-        } else {
-            breathValueDimmed -= 3; // Slower step for gentler pulsing
-            if (breathValueDimmed <= minLevel) {
-                increasingDimmed = true;
-                breathValueDimmed = minLevel;
-            }
-        }
-        
-        // Create blue color with dimmed breathing intensity
-        CRGB color = CRGB::Blue;
-        color.nscale8(breathValueDimmed);
-        setLEDColor(color);
-    }
-}
-
-void showBLEConnected() {
-    if (fadeActive) {
-        // Fade down to dim level (not all the way to 0)
-        unsigned long currentTime = millis();
-        static unsigned long lastFadeTime = 0;
-        
-        if (currentTime - lastFadeTime >= 20) { // Update every 20ms for smooth fade
-            lastFadeTime = currentTime;
-            
-            if (fadeValue > baseDimLevel) {
-                fadeValue -= 2; // Fade speed
-                if (fadeValue <= baseDimLevel) {
-                    fadeValue = baseDimLevel;
-                    fadeActive = false;
-                    connectedDimmed = true;
-                }
-            }
-            
-            // Handle communication pulse overlay
-            uint8_t displayValue = fadeValue;
-            if (commPulseActive) {
-                unsigned long pulseElapsed = currentTime - commPulseStartTime;
-                if (pulseElapsed < 100) { // 100ms pulse duration (shorter)
-                    // Subtle increase brightness for communication pulse
-                    uint8_t pulseBoost = map(pulseElapsed, 0, 100, 15, 0); // Fade from +15 to +0 (much more subtle)
-                    displayValue = min(255, fadeValue + pulseBoost);
-                } else {
-                    commPulseActive = false;
-                }
-            }
-            
-            CRGB color = CRGB::Blue;
-            color.nscale8(displayValue);
-            setLEDColor(color);
-        }
-    } else if (connectedDimmed) {
-        // Stay at dim level, but handle communication pulses
-        unsigned long currentTime = millis();
-        uint8_t displayValue = baseDimLevel;
-        
-        if (commPulseActive) {
-            unsigned long pulseElapsed = currentTime - commPulseStartTime;
-            if (pulseElapsed < 100) { // 100ms pulse duration (shorter)
-                // Subtle increase brightness for communication pulse
-                uint8_t pulseBoost = map(pulseElapsed, 0, 100, 15, 0); // Fade from +15 to +0 (much more subtle)
-                displayValue = min(255, baseDimLevel + pulseBoost);
-            } else {
-                commPulseActive = false;
-            }
-        }
-        
-        CRGB color = CRGB::Blue;
-        color.nscale8(displayValue);
-        setLEDColor(color);
-    }
-}
-
-void showBLEDisconnected() {
-    setLEDOff();
-    ESP_LOGD(TAG, "BLE LED status: DISCONNECTED (Off)");
-}
-
 // Communication pulse functions
 void pulseForCommunication() {
     // Only pulse if we're in connected dimmed state
-    if (connectedDimmed) {
-        commPulseActive = true;
-        commPulseStartTime = millis();
-        ESP_LOGD(TAG, "Communication pulse triggered");
+    if (isConnectedDimmed) {
+        commPulseTime = millis();
     }
 }
 
 // Machine status functions
-static bool homingActiveFlag = false;
-
 void setHomingActive(bool active) {
-    if (homingActiveFlag != active) {
-        homingActiveFlag = active;
+    if (homingActiveFlag.exchange(active) != active) {
         ESP_LOGI(TAG, "Homing status changed: %s", active ? "ACTIVE" : "INACTIVE");
     }
 }
@@ -386,45 +286,3 @@ void setHomingActive(bool active) {
 bool isHomingActive() {
     return homingActiveFlag;
 }
-
-void updateLEDForMachineStatus() {
-    // Check if homing is active - this takes priority over BLE status
-    if (isHomingActive()) {
-        showHomingBreathing();
-    } else {
-        // Fall back to BLE status
-        updateLEDForBLEStatus();
-    }
-}
-
-void showHomingBreathing() {
-    // Breathing deep purple effect for homing
-    static unsigned long lastHomingUpdate = 0;
-    static uint8_t homingBreathValue = 0;
-    static bool homingIncreasing = true;
-    
-    unsigned long currentTime = millis();
-    
-    if (currentTime - lastHomingUpdate >= 15) { // Update every 15ms for smooth breathing
-        lastHomingUpdate = currentTime;
-        
-        if (homingIncreasing) {
-            homingBreathValue += 5;
-            if (homingBreathValue >= 255) {
-                homingIncreasing = false;
-                homingBreathValue = 255;
-            }
-        } else {
-            homingBreathValue -= 5;
-            if (homingBreathValue <= baseDimLevel) { // Don't go completely dark
-                homingIncreasing = true;
-                homingBreathValue = baseDimLevel;
-            }
-        }
-        
-        // Create deep purple color with breathing intensity
-        CRGB color = COLOR_DEEP_PURPLE;
-        color.nscale8(homingBreathValue);
-        setLEDColor(color);
-    }
-}
\ No newline at end of file
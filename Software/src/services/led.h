@@ -4,6 +4,7 @@
 #include <Arduino.h>
 #include <FastLED.h>
 #include "constants/Pins.h"
+#include "utils/LedAnimation.h"
 
 // LED configuration
 #define NUM_LEDS 1
@@ -31,10 +32,23 @@
 // Special effect colors
 #define COLOR_DEEP_PURPLE CRGB(75, 0, 130)  // Deep purple for homing breathing
 
-extern CRGB leds[NUM_LEDS];
+// Frame rate of the LED engine
+#define LED_FRAME_MS 20
 
-// LED service functions
+/**
+ * The LED engine task owns FastLED. It renders the status animation (homing,
+ * BLE advertising, connected) or a requested one at a fixed frame rate and
+ * only calls FastLED.show() when the frame changed. All functions below are
+ * requests that return right away, they are safe from any task.
+ */
 void initLED();
+
+// Plays an animation in place of the status one until it is done, see
+// utils/LedAnimation.h. startMs is set by the call.
+void playLED(LedAnimation animation);
+// Back to the status animation
+void clearLED();
+
 void setLEDColor(CRGB color);
 void setLEDColor(uint8_t r, uint8_t g, uint8_t b);
 void setLEDOff();
@@ -50,21 +64,11 @@ void setLEDStatusError();
 void setLEDStatusHoming();
 void setLEDStatusConnecting();
 
-// BLE status indication functions
-void updateLEDForBLEStatus();
-void showBLERainbow(int duration_ms = 1000);
-void showBLEAdvertising();  // Breathing blue
-void showBLEAdvertisingDimmed();  // Dimmed breathing blue after timeout
-void showBLEConnected();    // Dimmed blue
-void showBLEDisconnected(); // Off
-
 // Communication pulse functions
 void pulseForCommunication();  // Brief brightness increase for BLE communication
 
 // Machine status functions
 void setHomingActive(bool active);
 bool isHomingActive();
-void updateLEDForMachineStatus();
-void showHomingBreathing();  // Breathing deep purple
 
 #endif // OSSM_SOFTWARE_LED_H
\ No newline at end of file
@@ -0,0 +1,173 @@
+#include "netlog.h"
+
+#include <WiFi.h>
+
+#include <cstdarg>
+#include <cstdio>
+
+#include "constants/Config.h"
+#include "constants/LogTags.h"
+#include "esp_log.h"
+#include "lwip/sockets.h"
+#include "services/stepper.h"
+#include "services/tasks.h"
+#include "utils/LogRing.h"
+
+// How often the task drains the ring and checks for subscribers
+#define NET_LOG_DRAIN_MS 20
+#define NET_LOG_DATAGRAM_SIZE (NET_LOG_LINE_SIZE + 1)
+
+static LogRing<NET_LOG_RING_SIZE> netLogRing;
+static portMUX_TYPE netLogLock = portMUX_INITIALIZER_UNLOCKED;
+
+static TaskHandle_t netLogTaskH = nullptr;
+
+/**
+ * The subscriber is only touched by the log task. It gets everything from
+ * the moment it subscribed, the ring isn't replayed.
+ */
+struct NetLogPeer {
+    sockaddr_in address;
+    bool isActive;
+    uint32_t lastSeenMs;
+};
+
+bool netLogRecord(uint8_t type, const void *payload, size_t length) {
+    portENTER_CRITICAL(&netLogLock);
+    bool isPushed = netLogRing.push(type, payload, length);
+    portEXIT_CRITICAL(&netLogLock);
+    return isPushed;
+}
+
+// Replaces the UART output of esp_log. Formatting happens on the caller's
+// stack, with less of it than the UART path needs, and only the copy into
+// the ring is locked.
+static int netLogVprintf(const char *format, va_list args) {
+    char line[NET_LOG_LINE_SIZE];
+    int length = vsnprintf(line, sizeof(line), format, args);
+    if (length < 0) {
+        return length;
+    }
+    if (length >= (int)sizeof(line)) {
+        length = sizeof(line) - 1;
+        line[length - 1] = '\n';
+    }
+    netLogRecord(NetLogRecord::text, line, length);
+    return length;
+}
+
+// Called from the clipping task of the StrokeEngine
+static void onClip(const ClipEvent &event) {
+    NetLogClipRecord record = {(uint32_t)(event.time / 1000), event.type,
+                               event.requested, event.limited};
+    netLogRecord(NetLogRecord::clip, &record, sizeof(record));
+}
+
+static int openSocket() {
+    int sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (sock < 0) {
+        return -1;
+    }
+
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(Config::Advanced::netLogPort);
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (bind(sock, (sockaddr *)&address, sizeof(address)) < 0) {
+        close(sock);
+        return -1;
+    }
+    return sock;
+}
+
+// Any datagram subscribes its sender, the newest one takes over
+static void receiveSubscriptions(int sock, NetLogPeer &peer) {
+    uint8_t received[8];
+    sockaddr_in from = {};
+    socklen_t fromLength = sizeof(from);
+    while (recvfrom(sock, received, sizeof(received), MSG_DONTWAIT,
+                    (sockaddr *)&from, &fromLength) >= 0) {
+        if (!peer.isActive ||
+            peer.address.sin_addr.s_addr != from.sin_addr.s_addr ||
+            peer.address.sin_port != from.sin_port) {
+            ESP_LOGI(NET_LOG_TAG, "Subscriber: %s:%u",
+                     inet_ntoa(from.sin_addr), (unsigned)ntohs(from.sin_port));
+            peer.address = from;
+            peer.isActive = true;
+        }
+        peer.lastSeenMs = millis();
+        fromLength = sizeof(from);
+    }
+
+    if (peer.isActive && millis() - peer.lastSeenMs >
+                             (uint32_t)Config::Advanced::netLogPeerTimeoutMs) {
+        ESP_LOGI(NET_LOG_TAG, "Subscriber timed out");
+        peer = {};
+    }
+}
+
+static void emit(int sock, const NetLogPeer &peer, const uint8_t *datagram,
+                 size_t length) {
+    if (datagram[0] == NetLogRecord::text) {
+        Serial.write(datagram + 1, length - 1);
+    }
+    if (sock >= 0 && peer.isActive) {
+        sendto(sock, datagram, length, 0, (const sockaddr *)&peer.address,
+               sizeof(peer.address));
+    }
+}
+
+static void netLogTask(void *pvParameters) {
+    int sock = -1;
+    NetLogPeer peer = {};
+    uint8_t datagram[NET_LOG_DATAGRAM_SIZE];
+    uint32_t reportedDrops = 0;
+
+    while (true) {
+        if (sock < 0 && WiFi.status() == WL_CONNECTED) {
+            sock = openSocket();
+            if (sock >= 0) {
+                ESP_LOGI(NET_LOG_TAG, "Logging to subscribers of %s:%u",
+                         WiFi.localIP().toString().c_str(),
+                         (unsigned)Config::Advanced::netLogPort);
+            }
+        }
+        if (sock >= 0) {
+            receiveSubscriptions(sock, peer);
+        }
+
+        while (true) {
+            portENTER_CRITICAL(&netLogLock);
+            int length =
+                netLogRing.pop(datagram[0], datagram + 1, sizeof(datagram) - 1);
+            uint32_t drops = netLogRing.getDroppedCount();
+            portEXIT_CRITICAL(&netLogLock);
+            if (length < 0) {
+                break;
+            }
+            emit(sock, peer, datagram, length + 1);
+
+            if (drops != reportedDrops) {
+                datagram[0] = NetLogRecord::text;
+                int textLength = snprintf(
+                    (char *)datagram + 1, sizeof(datagram) - 1,
+                    "%lu log records dropped\n",
+                    (unsigned long)(drops - reportedDrops));
+                emit(sock, peer, datagram, textLength + 1);
+                reportedDrops = drops;
+            }
+        }
+
+        vTaskDelay(pdMS_TO_TICKS(NET_LOG_DRAIN_MS));
+    }
+}
+
+void initNetLog() {
+    xTaskCreatePinnedToCore(netLogTask, "netLogTask",
+                            4 * configMINIMAL_STACK_SIZE, nullptr,
+                            Tasks::renderPriority, &netLogTaskH,
+                            Tasks::renderCore);
+
+    Stroker.registerClipCallback(onClip);
+    esp_log_set_vprintf(netLogVprintf);
+}
@@ -0,0 +1,56 @@
+#ifndef OSSM_SOFTWARE_NETLOG_H
+#define OSSM_SOFTWARE_NETLOG_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Log and trace sink over WiFi. Off by default, build with -DOSSM_NET_LOG=1.
+ *
+ * ESP_LOG output is formatted on the caller's stack and copied into a RAM
+ * ring, the state machine trace and clipped motions go in as binary records.
+ * A low priority task drains the ring: it writes the log lines to Serial and
+ * sends every record as a UDP datagram [type][payload] to the subscriber on
+ * Config::Advanced::netLogPort. Any datagram subscribes its sender until it
+ * has been silent for netLogPeerTimeoutMs. Records that don't fit into the
+ * ring are dropped and reported later.
+ *
+ * Only output that goes through esp_log_set_vprintf is captured, Arduino's
+ * log_x macros need USE_ESP_IDF_LOG for that. Serial.print goes straight out.
+ */
+#ifndef OSSM_NET_LOG
+#define OSSM_NET_LOG 0
+#endif
+
+#define NET_LOG_RING_SIZE 8192
+// Longer log lines are cut
+#define NET_LOG_LINE_SIZE 160
+
+namespace NetLogRecord {
+    // One formatted log line
+    constexpr uint8_t text = 0x00;
+    // StateTraceRecord, 8 bytes
+    constexpr uint8_t stateTrace = 0x01;
+    // NetLogClipRecord, 13 bytes
+    constexpr uint8_t clip = 0x02;
+}
+
+// One clipped motion of the StrokeEngine, see ClipEvent for the units.
+struct __attribute__((packed)) NetLogClipRecord {
+    uint32_t timeMs;
+    uint8_t type;  // ClipType
+    int32_t requested;
+    int32_t limited;
+};
+
+static_assert(sizeof(NetLogClipRecord) == 13,
+              "NetLogClipRecord must stay packed");
+
+// Installs the log hook and starts the task, it waits for the WiFi by
+// itself. Lines are printed to Serial until then.
+void initNetLog();
+
+// Copies a record into the ring, safe from any task. False if it was dropped.
+bool netLogRecord(uint8_t type, const void* payload, size_t length);
+
+#endif  // OSSM_SOFTWARE_NETLOG_H
@@ -0,0 +1,255 @@
+#include "ota.h"
+
+#include <HTTPClient.h>
+#include <Preferences.h>
+#include <WiFi.h>
+
+#include <memory>
+
+#include "constants/Config.h"
+#include "constants/LogTags.h"
+#include "esp32/rom/miniz.h"
+#include "esp_ota_ops.h"
+#include "esp_partition.h"
+#include "esp_rom_crc.h"
+#include "utils/OtaImage.h"
+
+/**
+ * Chunks are downloaded with one Range request from the first missing chunk
+ * to the end of the file. Each is inflated into RAM, checked against its
+ * CRC, written to flash and only then recorded as done, so whatever is
+ * recorded in NVS is known to be on flash. After a dropped connection the
+ * next request starts at the first missing chunk. Once the last chunk is
+ * written, esp_ota_set_boot_partition() verifies the whole image.
+ */
+
+#define OTA_FLASH_SECTOR 4096
+
+// ~43KB, allocated for the duration of an update only
+struct OtaDownload {
+    OtaImageHeader header;
+    uint32_t offsets[OTA_MAX_CHUNKS + 1];
+    uint32_t crcs[OTA_MAX_CHUNKS];
+    uint32_t imageId;  // CRC of header and index
+    const esp_partition_t *partition;
+    tinfl_decompressor inflator;
+    uint8_t input[1024];
+    uint8_t output[OTA_CHUNK_SIZE];
+};
+
+static bool readExactly(WiFiClient *stream, void *buffer, size_t length) {
+    return stream->readBytes((uint8_t *)buffer, length) == length;
+}
+
+// Requests the file from offset to the end. Servers that ignore the Range
+// header send everything, the part before offset is skipped then.
+static bool openRange(HTTPClient &http, WiFiClient &client,
+                      OtaDownload &download, const String &url,
+                      uint32_t offset, int &code) {
+    char range[32];
+    snprintf(range, sizeof(range), "bytes=%lu-", (unsigned long)offset);
+
+    http.begin(client, url);
+    http.addHeader("Range", range);
+    code = http.GET();
+    if (code != HTTP_CODE_PARTIAL_CONTENT && code != HTTP_CODE_OK) {
+        return false;
+    }
+
+    WiFiClient *stream = http.getStreamPtr();
+    stream->setTimeout(Config::Advanced::otaReadTimeoutMs);
+    if (code == HTTP_CODE_OK) {
+        while (offset > 0) {
+            size_t length = min(offset, (uint32_t)sizeof(download.output));
+            if (!readExactly(stream, download.output, length)) {
+                return false;
+            }
+            offset -= length;
+        }
+    }
+    return true;
+}
+
+static OtaResult readIndex(OtaDownload &download, const String &url) {
+    HTTPClient http;
+    WiFiClient client;
+    OtaImageHeader &header = download.header;
+    int code = 0;
+
+    if (!openRange(http, client, download, url, 0, code)) {
+        http.end();
+        ESP_LOGW(UPDATE_TAG, "No compressed image at %s (%d)", url.c_str(),
+                 code);
+        return code < 0 ? OtaResult::failed : OtaResult::unavailable;
+    }
+
+    WiFiClient *stream = http.getStreamPtr();
+    if (!readExactly(stream, &header, sizeof(header)) ||
+        !isValidOtaHeader(header, download.partition->size)) {
+        http.end();
+        ESP_LOGW(UPDATE_TAG, "Not a compressed image: %s", url.c_str());
+        return OtaResult::unavailable;
+    }
+
+    uint32_t count = header.chunkCount;
+    bool complete =
+        readExactly(stream, download.offsets, (count + 1) * sizeof(uint32_t)) &&
+        readExactly(stream, download.crcs, count * sizeof(uint32_t));
+    http.end();
+    if (!complete || !isValidOtaIndex(header, download.offsets)) {
+        ESP_LOGW(UPDATE_TAG, "Incomplete image index");
+        return OtaResult::failed;
+    }
+
+    download.imageId = esp_rom_crc32_le(0, (uint8_t *)&header, sizeof(header));
+    download.imageId =
+        esp_rom_crc32_le(download.imageId, (uint8_t *)download.offsets,
+                         (count + 1) * sizeof(uint32_t));
+    download.imageId = esp_rom_crc32_le(
+        download.imageId, (uint8_t *)download.crcs, count * sizeof(uint32_t));
+    return OtaResult::ok;
+}
+
+// Inflates the next chunk of the stream into download.output.
+static bool inflateChunk(OtaDownload &download, WiFiClient *stream,
+                         uint32_t chunk) {
+    uint32_t remaining = download.offsets[chunk + 1] - download.offsets[chunk];
+    size_t produced = 0;
+    tinfl_status status = TINFL_STATUS_NEEDS_MORE_INPUT;
+    tinfl_init(&download.inflator);
+
+    while (status == TINFL_STATUS_NEEDS_MORE_INPUT && remaining > 0) {
+        size_t length = min(remaining, (uint32_t)sizeof(download.input));
+        if (!readExactly(stream, download.input, length)) {
+            return false;
+        }
+        remaining -= length;
+
+        // The output buffer holds the whole chunk, so all input is consumed
+        // unless the chunk ends
+        size_t inSize = length;
+        size_t outSize = sizeof(download.output) - produced;
+        mz_uint32 flags = TINFL_FLAG_PARSE_ZLIB_HEADER |
+                          TINFL_FLAG_USING_NON_WRAPPING_OUTPUT_BUF |
+                          (remaining > 0 ? TINFL_FLAG_HAS_MORE_INPUT : 0);
+        status = tinfl_decompress(&download.inflator, download.input, &inSize,
+                                  download.output, download.output + produced,
+                                  &outSize, flags);
+        produced += outSize;
+    }
+
+    return status == TINFL_STATUS_DONE && remaining == 0 &&
+           produced == otaChunkLength(download.header, chunk);
+}
+
+static bool writeChunk(OtaDownload &download, uint32_t chunk) {
+    uint32_t length = otaChunkLength(download.header, chunk);
+    if (esp_rom_crc32_le(0, download.output, length) != download.crcs[chunk]) {
+        ESP_LOGW(UPDATE_TAG, "CRC mismatch in chunk %lu", (unsigned long)chunk);
+        return false;
+    }
+
+    // Pad the last chunk to whole flash words
+    uint32_t padded = (length + 15) & ~15U;
+    memset(download.output + length, 0xFF, padded - length);
+
+    uint32_t address = chunk * OTA_CHUNK_SIZE;
+    uint32_t erase = (padded + OTA_FLASH_SECTOR - 1) & ~(OTA_FLASH_SECTOR - 1);
+    return esp_partition_erase_range(download.partition, address, erase) ==
+               ESP_OK &&
+           esp_partition_write(download.partition, address, download.output,
+                               padded) == ESP_OK;
+}
+
+// Chunks recorded as done are read back, in case something else wrote to
+// the partition since. Returns the first one that doesn't match.
+static uint32_t verifyWritten(OtaDownload &download, uint32_t chunks) {
+    for (uint32_t chunk = 0; chunk < chunks; chunk++) {
+        uint32_t length = otaChunkLength(download.header, chunk);
+        if (esp_partition_read(download.partition, chunk * OTA_CHUNK_SIZE,
+                               download.output, length) != ESP_OK ||
+            esp_rom_crc32_le(0, download.output, length) !=
+                download.crcs[chunk]) {
+            return chunk;
+        }
+    }
+    return chunks;
+}
+
+OtaResult updateFromCompressedImage(const String &url, OtaProgress progress) {
+    std::unique_ptr<OtaDownload> download(new (std::nothrow) OtaDownload());
+    if (!download) {
+        ESP_LOGE(UPDATE_TAG, "Not enough memory for the update");
+        return OtaResult::failed;
+    }
+
+    download->partition = esp_ota_get_next_update_partition(nullptr);
+    if (download->partition == nullptr) {
+        return OtaResult::failed;
+    }
+
+    OtaResult result = readIndex(*download, url);
+    if (result != OtaResult::ok) {
+        return result;
+    }
+
+    uint32_t count = download->header.chunkCount;
+    Preferences progressStore;
+    progressStore.begin("ota", false);
+    uint32_t chunk = otaResumeChunk(
+        progressStore.getUInt("image", 0), progressStore.getUInt("partition", 0),
+        progressStore.getUInt("chunk", 0), download->imageId,
+        download->partition->address, count);
+    chunk = verifyWritten(*download, chunk);
+    progressStore.putUInt("image", download->imageId);
+    progressStore.putUInt("partition", download->partition->address);
+    progressStore.putUInt("chunk", chunk);
+
+    ESP_LOGI(UPDATE_TAG, "Compressed image: %lu bytes in %lu chunks, from %lu",
+             (unsigned long)download->header.imageSize, (unsigned long)count,
+             (unsigned long)chunk);
+    progress(100 * chunk / count);
+
+    int attempts = 0;
+    while (chunk < count) {
+        if (attempts > Config::Advanced::otaRetries) {
+            ESP_LOGE(UPDATE_TAG, "Giving up at chunk %lu",
+                     (unsigned long)chunk);
+            progressStore.end();
+            return OtaResult::failed;
+        }
+
+        HTTPClient http;
+        WiFiClient client;
+        int code = 0;
+        if (openRange(http, client, *download, url, download->offsets[chunk],
+                      code)) {
+            WiFiClient *stream = http.getStreamPtr();
+            while (chunk < count && inflateChunk(*download, stream, chunk) &&
+                   writeChunk(*download, chunk)) {
+                progressStore.putUInt("chunk", ++chunk);
+                attempts = 0;
+                progress(100 * chunk / count);
+            }
+        }
+        http.end();
+
+        if (chunk < count) {
+            attempts++;
+            ESP_LOGW(UPDATE_TAG, "Download stopped at chunk %lu (%d), retrying",
+                     (unsigned long)chunk, code);
+            delay(Config::Advanced::otaRetryDelayMs);
+        }
+    }
+
+    // Starts over next time if the image turns out to be broken
+    progressStore.clear();
+    progressStore.end();
+
+    esp_err_t error = esp_ota_set_boot_partition(download->partition);
+    if (error != ESP_OK) {
+        ESP_LOGE(UPDATE_TAG, "Image rejected: %s", esp_err_to_name(error));
+        return OtaResult::failed;
+    }
+    return OtaResult::ok;
+}
@@ -0,0 +1,22 @@
+#ifndef OSSM_SOFTWARE_OTA_H
+#define OSSM_SOFTWARE_OTA_H
+
+#include <Arduino.h>
+
+#include <functional>
+
+enum class OtaResult {
+    ok,           // Written and set as boot partition, restart to run it
+    unavailable,  // No compressed image at the URL, use the plain one
+    failed,
+};
+
+// Percent of the image written so far
+typedef std::function<void(int percent)> OtaProgress;
+
+// Downloads a compressed image (see utils/OtaImage.h) into the next OTA
+// partition. Every written chunk is recorded in NVS, so a dropped connection
+// or a restart continues where it stopped instead of starting over.
+OtaResult updateFromCompressedImage(const String &url, OtaProgress progress);
+
+#endif  // OSSM_SOFTWARE_OTA_H
@@ -0,0 +1,137 @@
+#include "outputs.h"
+
+#include <Arduino.h>
+
+#include "constants/Config.h"
+#include "constants/Pins.h"
+#include "esp_timer.h"
+#include "services/stepper.h"
+
+static GpioRuleTable<> gpioRules(Config::Driver::stepsPerMM);
+static portMUX_TYPE gpioRuleLock = portMUX_INITIALIZER_UNLOCKED;
+
+static esp_timer_handle_t gpioRuleTimer = nullptr;
+static bool isTimerRunning = false;
+
+// Output state of GPIO 1-4, the end of their pulse if one is running
+static bool levels[4] = {};
+static int64_t pulseEnds[4] = {};
+
+int mapGpioIndexToPin(int index) {
+    switch (index) {
+        case 1:
+            return Pins::GPIO::pin1;
+        case 2:
+            return Pins::GPIO::pin2;
+        case 3:
+            return Pins::GPIO::pin3;
+        case 4:
+            return Pins::GPIO::pin4;
+        default:
+            return -1;
+    }
+}
+
+static void writeLevel(int index, bool level) {
+    levels[index - 1] = level;
+    digitalWrite(mapGpioIndexToPin(index), level ? HIGH : LOW);
+}
+
+// Called with the lock held
+static void applyRule(const GpioRule& rule) {
+    int output = rule.index - 1;
+    switch (rule.action) {
+        case GpioAction::low:
+            pulseEnds[output] = 0;
+            writeLevel(rule.index, false);
+            break;
+        case GpioAction::high:
+            pulseEnds[output] = 0;
+            writeLevel(rule.index, true);
+            break;
+        case GpioAction::toggle:
+            pulseEnds[output] = 0;
+            writeLevel(rule.index, !levels[output]);
+            break;
+        case GpioAction::pulse:
+            pulseEnds[output] = esp_timer_get_time() + rule.pulseMs * 1000;
+            writeLevel(rule.index, true);
+            break;
+    }
+}
+
+// Called from the stroking task of the StrokeEngine
+static void onSegment(SegmentEdge edge, int from, int to) {
+    if (edge != SEGMENT_FINISH) {
+        return;
+    }
+
+    portENTER_CRITICAL(&gpioRuleLock);
+    gpioRules.finish(from, to, applyRule);
+    portEXIT_CRITICAL(&gpioRuleLock);
+}
+
+// Samples the step position and ends pulses, runs while any rule is set
+static void pollOutputs(void* arg) {
+    ServoState state = Stroker.getState();
+    bool isMoving = state == PATTERN || state == STREAMING;
+    int position = stepper != nullptr ? stepper->getCurrentPosition() : 0;
+    int64_t now = esp_timer_get_time();
+
+    portENTER_CRITICAL(&gpioRuleLock);
+    if (isMoving) {
+        gpioRules.sample(position, applyRule);
+    } else {
+        // Homing and depth setup move the frame, nothing crosses meanwhile
+        gpioRules.resetPosition();
+    }
+    for (int output = 0; output < 4; output++) {
+        if (pulseEnds[output] != 0 && now >= pulseEnds[output]) {
+            pulseEnds[output] = 0;
+            writeLevel(output + 1, false);
+        }
+    }
+    portEXIT_CRITICAL(&gpioRuleLock);
+}
+
+void initOutputs() {
+    esp_timer_create_args_t timerArgs = {};
+    timerArgs.callback = &pollOutputs;
+    timerArgs.name = "outputs";
+    esp_timer_create(&timerArgs, &gpioRuleTimer);
+
+    Stroker.registerSegmentCallback(onSegment);
+}
+
+bool writeGpio(int index, bool isHigh) {
+    if (mapGpioIndexToPin(index) < 0) {
+        return false;
+    }
+    portENTER_CRITICAL(&gpioRuleLock);
+    pulseEnds[index - 1] = 0;
+    writeLevel(index, isHigh);
+    portEXIT_CRITICAL(&gpioRuleLock);
+    return true;
+}
+
+// Only called from the GPIO characteristic, so the timer is started and
+// stopped from one task
+bool setGpioRule(int slot, const GpioRule& rule) {
+    portENTER_CRITICAL(&gpioRuleLock);
+    bool isSet = slot >= 0 && gpioRules.set(slot, rule);
+    bool isEmpty = gpioRules.empty();
+    if (isEmpty) {
+        gpioRules.resetPosition();
+    }
+    portEXIT_CRITICAL(&gpioRuleLock);
+
+    if (!isEmpty && !isTimerRunning) {
+        esp_timer_start_periodic(gpioRuleTimer,
+                                 Config::Advanced::gpioRulePollUs);
+        isTimerRunning = true;
+    } else if (isEmpty && isTimerRunning) {
+        esp_timer_stop(gpioRuleTimer);
+        isTimerRunning = false;
+    }
+    return isSet;
+}
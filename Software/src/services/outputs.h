@@ -0,0 +1,27 @@
+#ifndef OSSM_SOFTWARE_OUTPUTS_H
+#define OSSM_SOFTWARE_OUTPUTS_H
+
+#include "utils/GpioRules.h"
+
+/**
+ * GPIO outputs that follow the stroke, so accessories don't wait for BLE.
+ *
+ * Depth and retract rules fire from the stroking task the moment a pattern
+ * move comes to a stop. Inward and outward rules compare samples of the step
+ * position, taken every Config::Advanced::gpioRulePollUs while such a rule
+ * is set, in patterns and streaming alike. Pulses end on the same timer.
+ */
+
+// Maps GPIO 1-4 to the board pins, -1 for other indices
+int mapGpioIndexToPin(int index);
+
+// Sets GPIO 1-4 right away, ending a pulse on it. False for other indices.
+bool writeGpio(int index, bool isHigh);
+
+// Hooks the rules into the StrokeEngine
+void initOutputs();
+
+// Sets or, with an index of 0, clears a rule. False if the slot is invalid.
+bool setGpioRule(int slot, const GpioRule& rule);
+
+#endif  // OSSM_SOFTWARE_OUTPUTS_H
@@ -0,0 +1,188 @@
+#include "player.h"
+
+#include <Arduino.h>
+
+#include "constants/Config.h"
+#include "constants/LogTags.h"
+#include "esp_log.h"
+#include "ossm/OSSMI.h"
+#include "ossm/States.h"
+#include "services/communication/events.h"
+#include "services/communication/queue.h"
+#include "services/tasks.h"
+
+static TaskHandle_t playerTaskH = nullptr;
+
+// The program and the player are shared by the BLE host task, which changes
+// them, and the program task, which plays them. The program only changes
+// while the player is idle or finished.
+static Program program;
+static ProgramPlayer player;
+static portMUX_TYPE programLock = portMUX_INITIALIZER_UNLOCKED;
+
+// Values last queued, so only changes are sent
+static int sentValues[setValueCount] = {};
+
+// Settings as the OSSM has them now, in set value units
+static void currentValues(int* values) {
+    StateSnapshot snapshot = ossmInterface->getStateSnapshot();
+    values[setValueSpeed] = snapshot.speed * setValueScale;
+    values[setValueStroke] = snapshot.stroke * setValueScale;
+    values[setValueDepth] = snapshot.depth * setValueScale;
+    values[setValueSensation] = snapshot.sensation * setValueScale;
+    values[setValuePattern] = snapshot.pattern * setValueScale;
+}
+
+[[noreturn]] static void playerTask(void* pvParameters) {
+    bool isPlaying = false;
+    while (true) {
+        TickType_t wait =
+            isPlaying ? pdMS_TO_TICKS(Config::Advanced::programTickMs)
+                      : portMAX_DELAY;
+        ulTaskNotifyTake(pdTRUE, wait);
+
+        bool isStroking = isInMode(StateId::strokeEngine);
+        CommandValue command = {Commands::setValues, 0};
+
+        portENTER_CRITICAL(&programLock);
+        if (!isStroking && player.isActive()) {
+            player.stop();
+        }
+        int values[setValueCount];
+        for (int i = 0; i < setValueCount; i++) {
+            values[i] = sentValues[i];
+        }
+        if (player.update(program, millis(), values)) {
+            for (int i = 0; i < setValueCount; i++) {
+                if (values[i] != sentValues[i]) {
+                    command.value |= 1 << i;
+                    command.values[i] = values[i];
+                    sentValues[i] = values[i];
+                }
+            }
+        }
+        isPlaying = player.getState() == ProgramState::playing;
+        portEXIT_CRITICAL(&programLock);
+
+        // A full queue drops the values, the next tick sends them again
+        if (command.value != 0 && queueCommand(command)) {
+            signalNimble(NimbleEvents::command);
+        } else if (command.value != 0) {
+            portENTER_CRITICAL(&programLock);
+            for (int i = 0; i < setValueCount; i++) {
+                if (command.value & (1 << i)) {
+                    sentValues[i] = -1;
+                }
+            }
+            portEXIT_CRITICAL(&programLock);
+        }
+    }
+}
+
+void initPlayer() {
+    xTaskCreatePinnedToCore(playerTask, "playerTask",
+                            3 * configMINIMAL_STACK_SIZE, nullptr,
+                            Tasks::communicationPriority, &playerTaskH,
+                            Tasks::communicationCore);
+}
+
+ProgramResult clearProgram() {
+    ProgramResult result = ProgramResult::busy;
+    portENTER_CRITICAL(&programLock);
+    if (!player.isActive()) {
+        program.clear();
+        result = ProgramResult::ok;
+    }
+    portEXIT_CRITICAL(&programLock);
+    return result;
+}
+
+ProgramResult appendProgram(const uint8_t* data, size_t length) {
+    ProgramResult result = ProgramResult::busy;
+    portENTER_CRITICAL(&programLock);
+    if (!player.isActive()) {
+        result = appendProgramChunk(program, data, length);
+    }
+    portEXIT_CRITICAL(&programLock);
+    return result;
+}
+
+ProgramResult playProgram(bool isLooping) {
+    if (!isInMode(StateId::strokeEngine)) {
+        return ProgramResult::refused;
+    }
+    int current[setValueCount];
+    currentValues(current);
+
+    ProgramResult result = ProgramResult::refused;
+    portENTER_CRITICAL(&programLock);
+    if (program.size() > 0) {
+        player.play(millis(), isLooping, current);
+        for (int i = 0; i < setValueCount; i++) {
+            sentValues[i] = current[i];
+        }
+        result = ProgramResult::ok;
+    }
+    portEXIT_CRITICAL(&programLock);
+
+    if (result == ProgramResult::ok) {
+        ESP_LOGI(NIMBLE_TAG, "Playing a program of %u steps, %lums",
+                 (unsigned)program.size(),
+                 (unsigned long)program.getDurationMs());
+        xTaskNotifyGive(playerTaskH);
+    }
+    return result;
+}
+
+ProgramResult pauseProgram() {
+    portENTER_CRITICAL(&programLock);
+    player.pause(millis());
+    portEXIT_CRITICAL(&programLock);
+    return ProgramResult::ok;
+}
+
+ProgramResult resumeProgram() {
+    portENTER_CRITICAL(&programLock);
+    player.resume(millis());
+    portEXIT_CRITICAL(&programLock);
+    xTaskNotifyGive(playerTaskH);
+    return ProgramResult::ok;
+}
+
+void stopProgram() {
+    portENTER_CRITICAL(&programLock);
+    player.stop();
+    portEXIT_CRITICAL(&programLock);
+
+    ESP_LOGI(NIMBLE_TAG, "Program stopped, ramping speed to 0 in %dms",
+             Config::Advanced::programStopRampMs);
+    ossmInterface->rampSpeed(0, Config::Advanced::programStopRampMs);
+}
+
+bool isProgramPlaying() {
+    portENTER_CRITICAL(&programLock);
+    bool isPlaying = player.getState() == ProgramState::playing;
+    portEXIT_CRITICAL(&programLock);
+    return isPlaying;
+}
+
+bool isProgramPlayingOnce() {
+    portENTER_CRITICAL(&programLock);
+    bool isPlayingOnce = player.isPlayingOnce();
+    portEXIT_CRITICAL(&programLock);
+    return isPlayingOnce;
+}
+
+ProgramStatus getProgramStatus(ProgramResult result) {
+    ProgramStatus status = {};
+    uint32_t now = millis();
+    portENTER_CRITICAL(&programLock);
+    status.state = (uint8_t)player.getState();
+    status.next = program.size();
+    status.duration = program.getDurationMs();
+    status.time = player.time(now);
+    status.loops = player.getLoops();
+    portEXIT_CRITICAL(&programLock);
+    status.result = (uint8_t)result;
+    return status;
+}
@@ -0,0 +1,42 @@
+#ifndef OSSM_SOFTWARE_PLAYER_H
+#define OSSM_SOFTWARE_PLAYER_H
+
+#include "command/program.hpp"
+
+/**
+ * Programs of settings over time, uploaded once and played on the device,
+ * see ProgramPlayer. A task in the communication group evaluates the program
+ * every Config::Advanced::programTickMs while it plays and queues the values
+ * that changed as a setValues command, so they are applied like any other.
+ * A setting changed by hand keeps its value until the program moves it
+ * again.
+ *
+ * Programs only play in the stroke engine and stop when it is left. When
+ * the BLE link drops, a program that plays once still plays to its end
+ * before the speed eases down. A looping one would never end, it gets the
+ * disconnect ramp right away.
+ */
+
+// Starts the program task
+void initPlayer();
+
+// Change the uploaded program, busy while it plays or is paused
+ProgramResult clearProgram();
+ProgramResult appendProgram(const uint8_t* data, size_t length);
+
+// Plays from the start, refused outside the stroke engine or if empty
+ProgramResult playProgram(bool isLooping);
+ProgramResult pauseProgram();
+ProgramResult resumeProgram();
+
+// Fail-safe stop, the program ends and the speed eases down to 0 over
+// Config::Advanced::programStopRampMs
+void stopProgram();
+
+bool isProgramPlaying();
+bool isProgramPlayingOnce();
+
+// Status with result as the result of the last write
+ProgramStatus getProgramStatus(ProgramResult result);
+
+#endif  // OSSM_SOFTWARE_PLAYER_H
@@ -0,0 +1,51 @@
+#include "profiler.h"
+
+#include <Arduino.h>
+
+#include "services/stepper.h"
+#include "utils/ProfileStats.h"
+
+#if OSSM_PROFILE
+static ProfileStats profileTable[(size_t)ProfileProbe::count];
+static portMUX_TYPE profileLock = portMUX_INITIALIZER_UNLOCKED;
+
+void recordProfile(ProfileProbe probe, uint32_t cycles) {
+    portENTER_CRITICAL(&profileLock);
+    profileTable[(size_t)probe].add(cycles);
+    portEXIT_CRITICAL(&profileLock);
+}
+
+// Called from the motion tasks of the StrokeEngine
+static void onProfile(ProfileSection section, uint32_t cycles) {
+    recordProfile(section == PROFILE_STROKING ? ProfileProbe::stroking
+                                              : ProfileProbe::motionProfile,
+                  cycles);
+}
+#endif
+
+void initProfiler() {
+#if OSSM_PROFILE
+    Stroker.registerProfileCallback(onProfile);
+#endif
+}
+
+size_t copyProfile(ProfileHeader* header, ProfileRecord* records, size_t max) {
+    size_t count = 0;
+#if OSSM_PROFILE
+    ProfileStats stats[(size_t)ProfileProbe::count];
+    portENTER_CRITICAL(&profileLock);
+    for (size_t i = 0; i < (size_t)ProfileProbe::count; i++) {
+        stats[i] = profileTable[i];
+    }
+    portEXIT_CRITICAL(&profileLock);
+
+    for (; count < max && count < (size_t)ProfileProbe::count; count++) {
+        records[count] = stats[count].toRecord((ProfileProbe)count);
+    }
+#endif
+
+    header->cpuMhz = getCpuFrequencyMhz();
+    header->count = count;
+    header->enabled = OSSM_PROFILE;
+    return count;
+}
@@ -0,0 +1,58 @@
+#ifndef OSSM_SOFTWARE_PROFILER_H
+#define OSSM_SOFTWARE_PROFILER_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "esp_cpu.h"
+#include "structs/ProfileRecord.h"
+
+/**
+ * Hot path profiler: every instrumented scope adds the CPU cycles it took to
+ * a fixed table of count, min, mean and max per ProfileProbe, read through
+ * the profile characteristic. Recording is a cycle counter read and a few
+ * stores under a spinlock.
+ *
+ * Off by default, build with -DOSSM_PROFILE=1. Without it the scopes compile
+ * to nothing. Cycles include the time other tasks preempted the scope, and
+ * are only meaningful for tasks pinned to a core.
+ */
+#ifndef OSSM_PROFILE
+#define OSSM_PROFILE 0
+#endif
+
+#if OSSM_PROFILE
+void recordProfile(ProfileProbe probe, uint32_t cycles);
+
+// Times its own lifetime.
+class ProfileScope {
+  public:
+    explicit ProfileScope(ProfileProbe probe)
+        : probe(probe), start(esp_cpu_get_cycle_count()) {}
+    ~ProfileScope() {
+        recordProfile(probe, esp_cpu_get_cycle_count() - start);
+    }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+  private:
+    ProfileProbe probe;
+    uint32_t start;
+};
+
+#define OSSM_PROFILE_CONCAT(a, b) a##b
+#define OSSM_PROFILE_NAME(line) OSSM_PROFILE_CONCAT(profileScope, line)
+#define OSSM_PROFILE_SCOPE(probe) \
+    ProfileScope OSSM_PROFILE_NAME(__LINE__)(ProfileProbe::probe)
+#else
+#define OSSM_PROFILE_SCOPE(probe)
+#endif
+
+// Hooks the StrokeEngine sections into the table.
+void initProfiler();
+
+// Copies one record per probe, in ProfileProbe order. Returns the count.
+size_t copyProfile(ProfileHeader* header, ProfileRecord* records, size_t max);
+
+#endif  // OSSM_SOFTWARE_PROFILER_H
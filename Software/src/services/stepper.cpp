@@ -1,10 +1,45 @@
 #include "stepper.h"
 
+#include "constants/Config.h"
+#include "freertos/event_groups.h"
+#include "services/board.h"
+#include "services/tasks.h"
+
 FastAccelStepperEngine stepperEngine = FastAccelStepperEngine();
 FastAccelStepper *stepper = nullptr;
+FastAccelStepper *auxStepper = nullptr;
 class StrokeEngine Stroker;
 
+static machineGeometry auxMachine = {
+    .physicalTravel = Config::Driver::auxTravel, .keepoutBoundary = 0.0};
+
+static motorProperties auxMotor = {
+    .maxSpeed = Config::Driver::auxMaxSpeed,
+    .maxAcceleration = Config::Driver::auxMaxAcceleration,
+    .stepsPerMillimeter = Config::Driver::auxStepsPerUnit,
+    .invertDirection = false,
+    .enableActiveLow = true,
+    .stepPin = Pins::Driver::auxStepPin,
+    .directionPin = Pins::Driver::auxDirectionPin,
+    .enablePin = Pins::Driver::auxEnablePin};
+
+static EventGroupHandle_t stepperEvents = nullptr;
+static constexpr EventBits_t stepperReady = (1 << 0);
+
+// disable motor briefly in case we are against a hard stop.
+static void resetDriver() {
+    digitalWrite(Pins::Driver::motorEnablePin, HIGH);
+    vTaskDelay(pdMS_TO_TICKS(600));
+    digitalWrite(Pins::Driver::motorEnablePin, LOW);
+    // Lets the driver and the filtered current reading settle, homing takes
+    // its current offset right after.
+    vTaskDelay(pdMS_TO_TICKS(100));
+    xEventGroupSetBits(stepperEvents, stepperReady);
+}
+
 void initStepper() {
+    stepperEvents = xEventGroupCreate();
+
     stepperEngine.init();
     stepper = stepperEngine.stepperConnectToPin(Pins::Driver::motorStepPin);
     if (stepper) {
@@ -13,9 +48,31 @@ void initStepper() {
         stepper->setAutoEnable(false);
     }
 
-    // disable motor briefly in case we are against a hard stop.
-    digitalWrite(Pins::Driver::motorEnablePin, HIGH);
-    delay(600);
-    digitalWrite(Pins::Driver::motorEnablePin, LOW);
-    delay(100);
+    // The second actuator shares the engine, so its moves start in step
+    // with the stroke
+    if (Pins::Driver::auxStepPin >= 0) {
+        auxStepper =
+            stepperEngine.stepperConnectToPin(Pins::Driver::auxStepPin);
+        if (auxStepper) {
+            Stroker.attachAxis(0, &auxMachine, &auxMotor, auxStepper);
+        }
+    }
+
+#if OSSM_FAST_BOOT
+    // The rest of the boot carries on while the driver is reset
+    xTaskCreatePinnedToCore(
+        [](void *pvParameters) {
+            resetDriver();
+            vTaskDelete(nullptr);
+        },
+        "resetDriver", 2 * configMINIMAL_STACK_SIZE, nullptr,
+        Tasks::operationPriority, nullptr, Tasks::operationTaskCore);
+#else
+    resetDriver();
+#endif
+}
+
+void waitForStepperReady() {
+    xEventGroupWaitBits(stepperEvents, stepperReady, pdFALSE, pdTRUE,
+                        portMAX_DELAY);
 }
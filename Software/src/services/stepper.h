@@ -7,8 +7,15 @@
 
 extern FastAccelStepperEngine stepperEngine;
 extern FastAccelStepper *stepper;
+// Second actuator, nullptr unless Pins::Driver::auxStepPin is set
+extern FastAccelStepper *auxStepper;
 extern class StrokeEngine Stroker;
 
+// Connects the stepper and resets the driver, in the background with
+// OSSM_FAST_BOOT.
 void initStepper();
 
+// Blocks until the driver reset of initStepper() is done.
+void waitForStepperReady();
+
 #endif  // SOFTWARE_STEPPER_H
@@ -1,5 +1,11 @@
 #include "tasks.h"
 
+#include <algorithm>
+#include <cstring>
+
+#include "esp_log.h"
+#include "services/heap.h"
+
 namespace Tasks {
     TaskHandle_t drawHelloTaskH = nullptr;
     TaskHandle_t drawMenuTaskH = nullptr;
@@ -11,4 +17,195 @@ namespace Tasks {
     TaskHandle_t runHomingTaskH = nullptr;
     TaskHandle_t runSimplePenetrationTaskH = nullptr;
     TaskHandle_t runStrokeEngineTaskH = nullptr;
-} 
\ No newline at end of file
+    TaskHandle_t runStreamingTaskH = nullptr;
+    TaskHandle_t runAutoTuneTaskH = nullptr;
+
+    TaskHandle_t renderTaskH = nullptr;
+    TaskHandle_t displayFlushTaskH = nullptr;
+}
+
+static const char* TAG = "TASKS";
+
+// Run time counters of the previous report, to report loads of the window
+// in between. Tasks are matched by handle.
+struct TaskRunTime {
+    TaskHandle_t handle;
+    uint32_t runTime;
+};
+static TaskRunTime lastRunTimes[Tasks::maxReportedTasks];
+static size_t lastRunTimeCount = 0;
+static uint32_t lastTotalRunTime = 0;
+static uint32_t lastReportMs = 0;
+static portMUX_TYPE taskStatsLock = portMUX_INITIALIZER_UNLOCKED;
+
+static uint32_t previousRunTime(TaskHandle_t handle) {
+    for (size_t i = 0; i < lastRunTimeCount; i++) {
+        if (lastRunTimes[i].handle == handle) {
+            return lastRunTimes[i].runTime;
+        }
+    }
+    return 0;
+}
+
+size_t collectTaskStats(TaskStatsHeader* header, TaskStatsRecord* records,
+                        size_t max) {
+    static TaskStatus_t status[Tasks::maxReportedTasks];
+    uint32_t totalRunTime = 0;
+    UBaseType_t count =
+        uxTaskGetSystemState(status, Tasks::maxReportedTasks, &totalRunTime);
+    uint32_t nowMs = pdTICKS_TO_MS(xTaskGetTickCount());
+
+    portENTER_CRITICAL(&taskStatsLock);
+    uint32_t window = totalRunTime - lastTotalRunTime;
+    header->windowMs = nowMs - lastReportMs;
+    header->coreLoad[0] = 0;
+    header->coreLoad[1] = 0;
+    header->runTimeStats = configGENERATE_RUN_TIME_STATS ? 1 : 0;
+
+    size_t written = 0;
+    for (UBaseType_t i = 0; i < count; i++) {
+        const TaskStatus_t& task = status[i];
+        BaseType_t affinity = xTaskGetAffinity(task.xHandle);
+        uint8_t core = affinity == tskNO_AFFINITY ? 0xFF : (uint8_t)affinity;
+
+        uint32_t runTime = task.ulRunTimeCounter - previousRunTime(task.xHandle);
+        uint16_t load =
+            window > 0 ? (uint16_t)((uint64_t)runTime * 1000 / window) : 0;
+
+        // The idle task of a core runs whenever nothing else does
+        if (strncmp(task.pcTaskName, "IDLE", 4) == 0 && core < 2) {
+            header->coreLoad[core] = load < 1000 ? 1000 - load : 0;
+        }
+
+        if (written < max) {
+            TaskStatsRecord& record = records[written++];
+            memset(record.name, 0, sizeof(record.name));
+            strncpy(record.name, task.pcTaskName, sizeof(record.name));
+            record.priority = (uint8_t)task.uxCurrentPriority;
+            record.core = core;
+            record.load = load;
+        }
+
+        lastRunTimes[i] = {task.xHandle, task.ulRunTimeCounter};
+    }
+
+    lastRunTimeCount = count;
+    lastTotalRunTime = totalRunTime;
+    lastReportMs = nowMs;
+    header->count = (uint8_t)written;
+    portEXIT_CRITICAL(&taskStatsLock);
+
+    return written;
+}
+
+void logTaskStats() {
+    TaskStatsHeader header;
+    TaskStatsRecord records[Tasks::maxReportedTasks];
+    size_t count = collectTaskStats(&header, records, Tasks::maxReportedTasks);
+
+    if (!header.runTimeStats) {
+        ESP_LOGI(TAG, "Built without run time stats, loads are not available");
+    }
+    ESP_LOGI(TAG, "Tasks over %lu ms, core 0: %u.%u%%, core 1: %u.%u%%",
+             (unsigned long)header.windowMs, header.coreLoad[0] / 10,
+             header.coreLoad[0] % 10, header.coreLoad[1] / 10,
+             header.coreLoad[1] % 10);
+    for (size_t i = 0; i < count; i++) {
+        const TaskStatsRecord& record = records[i];
+        char name[sizeof(record.name) + 1] = {};
+        memcpy(name, record.name, sizeof(record.name));
+
+        ESP_LOGI(TAG, "%-12s core %c  prio %2u  %3u.%u%%", name,
+                 record.core == 0xFF ? '-' : '0' + record.core,
+                 record.priority, record.load / 10, record.load % 10);
+    }
+}
+
+// Smallest free stack seen per task name, kept after a task is deleted
+static StackUsageRecord stackUsage[Tasks::maxStackRecords];
+static size_t stackUsageCount = 0;
+static portMUX_TYPE stackUsageLock = portMUX_INITIALIZER_UNLOCKED;
+
+// Returns the record of a task, or a new one. nullptr if the table is full.
+static StackUsageRecord* findStackUsage(const char* name) {
+    for (size_t i = 0; i < stackUsageCount; i++) {
+        if (strncmp(stackUsage[i].name, name, sizeof(stackUsage[i].name)) ==
+            0) {
+            return &stackUsage[i];
+        }
+    }
+    if (stackUsageCount == Tasks::maxStackRecords) {
+        return nullptr;
+    }
+
+    StackUsageRecord* record = &stackUsage[stackUsageCount++];
+    memset(record->name, 0, sizeof(record->name));
+    strncpy(record->name, name, sizeof(record->name));
+    record->minFree = UINT16_MAX;
+    return record;
+}
+
+void sampleStackUsage() {
+    static TaskStatus_t status[Tasks::maxReportedTasks];
+    UBaseType_t count =
+        uxTaskGetSystemState(status, Tasks::maxReportedTasks, nullptr);
+
+    for (UBaseType_t i = 0; i < count; i++) {
+        const TaskStatus_t& task = status[i];
+        // In bytes, ESP-IDF stacks are made of uint8_t
+        uint16_t free = (uint16_t)std::min(
+            (uint32_t)task.usStackHighWaterMark, (uint32_t)UINT16_MAX);
+
+        portENTER_CRITICAL(&stackUsageLock);
+        StackUsageRecord* record = findStackUsage(task.pcTaskName);
+        bool lower = record != nullptr && free < record->minFree;
+        if (lower) {
+            record->minFree = free;
+        }
+        portEXIT_CRITICAL(&stackUsageLock);
+
+        if (!lower) {
+            continue;
+        }
+        if (free < Tasks::stackWarningBytes) {
+            ESP_LOGW(TAG, "%s is low on stack, %u bytes free",
+                     task.pcTaskName, free);
+        } else {
+            ESP_LOGD(TAG, "%s stack minimum: %u bytes free", task.pcTaskName,
+                     free);
+        }
+    }
+}
+
+size_t copyStackUsage(StackUsageRecord* records, size_t max) {
+    portENTER_CRITICAL(&stackUsageLock);
+    size_t count = std::min(stackUsageCount, max);
+    memcpy(records, stackUsage, count * sizeof(StackUsageRecord));
+    portEXIT_CRITICAL(&stackUsageLock);
+    return count;
+}
+
+void logStackUsage() {
+    StackUsageRecord records[Tasks::maxStackRecords];
+    size_t count = copyStackUsage(records, Tasks::maxStackRecords);
+
+    ESP_LOGI(TAG, "Smallest free stack of %u tasks:", (unsigned)count);
+    for (size_t i = 0; i < count; i++) {
+        char name[sizeof(records[i].name) + 1] = {};
+        memcpy(name, records[i].name, sizeof(records[i].name));
+        ESP_LOGI(TAG, "%-12s %5u bytes", name, records[i].minFree);
+    }
+}
+
+void initStackMonitor() {
+    xTaskCreatePinnedToCore(
+        [](void* pvParameters) {
+            while (true) {
+                sampleStackUsage();
+                sampleHeap();
+                vTaskDelay(pdMS_TO_TICKS(Tasks::stackSampleIntervalMs));
+            }
+        },
+        "stackMonitor", 3 * configMINIMAL_STACK_SIZE, nullptr,
+        Tasks::renderPriority, nullptr, Tasks::renderCore);
+}
@@ -1,9 +1,33 @@
 #ifndef OSSM_SOFTWARE_TASKS_H
 #define OSSM_SOFTWARE_TASKS_H
 
+#include <cstddef>
+
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "structs/TaskStatsRecord.h"
 
+/**
+ * Core and priority plan. Every task is created with the values below:
+ *
+ * | Group         | Tasks                                        | Core | Prio |
+ * | ------------- | -------------------------------------------- | ---- | ---- |
+ * | Motion        | FastAccelStepper, StrokeEngine stroking (24), | 1    | lib  |
+ * |               | streaming (24), homing (20), planning (10)    |      |      |
+ * | Operation     | homing, simple penetration, stroke engine,    | 0    | 23   |
+ * |               | streaming, auto tune tasks of the OSSM,       |      |      |
+ * |               | driver reset                                  |      |      |
+ * | Dispatch      | state machine dispatcher, runs all actions    | 0    | 15   |
+ * | Input         | input (encoder, button), ADC                  | 0    | 10   |
+ * | Communication | nimbleLoop, telemetry, NimBLE init, UDP       | 0    | 5    |
+ * |               | control, program player                       |      |      |
+ * | UI            | render, flush, draw tasks, header bar, LED,   | 0    | 1    |
+ * |               | WiFi portal, stack monitor, net log,          |      |      |
+ * |               | coexistence                                  |      |      |
+ *
+ * Core 1 belongs to step generation, nothing of the OSSM runs there. On core
+ * 0 the NimBLE host (21) and esp_timer (22) sit between operation and input.
+ */
 namespace Tasks {
     // Declare variables as extern
     extern TaskHandle_t drawHelloTaskH;
@@ -16,10 +40,76 @@ namespace Tasks {
     extern TaskHandle_t runHomingTaskH;
     extern TaskHandle_t runSimplePenetrationTaskH;
     extern TaskHandle_t runStrokeEngineTaskH;
+    extern TaskHandle_t runStreamingTaskH;
+    extern TaskHandle_t runAutoTuneTaskH;
+
+    extern TaskHandle_t renderTaskH;
+    extern TaskHandle_t displayFlushTaskH;
 
     // Constants can stay in the header
     constexpr int stepperCore = 1;
+
+    // Operation tasks forward settings to the motion, they mostly sleep
     constexpr int operationTaskCore = 0;
+    constexpr int operationPriority = configMAX_PRIORITIES - 2;
+
+    // The state machine: every event is processed here, producers only
+    // post them. Above input and communication, so their events are handled
+    // before they post the next, below the NimBLE host.
+    constexpr int dispatchCore = 0;
+    constexpr int dispatchPriority = 15;
+
+    // Button and ADC sampling
+    constexpr int inputCore = 0;
+    constexpr int inputPriority = 10;
+
+    // BLE service loop (nimbleLoop), shares the core with the NimBLE host
+    constexpr int communicationCore = 0;
+    constexpr int communicationPriority = 5;
+
+    // Display render and flush tasks, own the display. Everything else that
+    // only draws or blinks runs here as well.
+    constexpr int renderCore = 0;
+    constexpr int renderPriority = 1;
+
+    // Largest number of tasks a report covers
+    constexpr size_t maxReportedTasks = 32;
+
+    // The stack monitor samples the high-water mark of every task this often
+    // and warns about tasks with less free stack than stackWarningBytes. It
+    // keeps the minimum per task name, for up to maxStackRecords names.
+    constexpr int stackSampleIntervalMs = 1000;
+    constexpr uint32_t stackWarningBytes = 512;
+    constexpr size_t maxStackRecords = 40;
 }
 
+/**
+ * Collects a task report: the load of each core and of every task since the
+ * previous report. Loads need CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS, without
+ * it they are reported as 0.
+ * @return number of records written
+ */
+size_t collectTaskStats(TaskStatsHeader* header, TaskStatsRecord* records,
+                        size_t max);
+
+// Prints a task report to the serial log.
+void logTaskStats();
+
+/**
+ * Starts the stack monitor. It covers every task, including the ones inside
+ * the StrokeEngine and the ones that only run in some states, so the stack
+ * sizes can be trimmed from what a session actually needed. The same loop
+ * samples the heap for services/heap.h.
+ */
+void initStackMonitor();
+
+// Samples the stack high-water mark of every task right away.
+void sampleStackUsage();
+
+// Copies up to max records of the smallest free stack seen per task.
+size_t copyStackUsage(StackUsageRecord* records, size_t max);
+
+// Prints the smallest free stack seen per task to the serial log.
+void logStackUsage();
+
 #endif  // OSSM_SOFTWARE_TASKS_H
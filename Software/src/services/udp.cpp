@@ -0,0 +1,277 @@
+#include "udp.h"
+
+#include <WiFi.h>
+
+#include <cstring>
+
+#include "command/frames.hpp"
+#include "constants/Config.h"
+#include "constants/LogTags.h"
+#include "esp_log.h"
+#include "lwip/sockets.h"
+#include "ossm/OSSMI.h"
+#include "services/communication/events.h"
+#include "services/capture.h"
+#include "services/communication/queue.h"
+#include "services/led.h"
+#include "services/stepper.h"
+#include "services/tasks.h"
+#include "utils/TelemetryPacker.h"
+
+// Largest datagram handled, a command frame is at most 13 bytes
+#define UDP_RECEIVE_SIZE 64
+// Telemetry packets are as large as a BLE notification at the highest MTU
+#define UDP_TELEMETRY_SIZE 244
+// Same ease down as for a lost BLE connection
+#define UDP_STOP_RAMP_MS 2000
+
+typedef TelemetryPacker<UDP_TELEMETRY_SIZE> UdpTelemetryPacket;
+
+/**
+ * The peer is only touched by the control task. It eases the machine to a
+ * stop when it goes silent, but only if it commanded anything, so a client
+ * that just watched doesn't stop a session driven over BLE.
+ */
+struct UdpPeer {
+    sockaddr_in address;
+    bool isActive;
+    bool hasCommanded;
+    uint32_t lastSeenMs;
+    uint16_t telemetryRateHz;
+};
+
+static TaskHandle_t udpControlTaskH = nullptr;
+
+static int openSocket() {
+    int sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (sock < 0) {
+        return -1;
+    }
+
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(Config::Advanced::udpControlPort);
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (bind(sock, (sockaddr *)&address, sizeof(address)) < 0) {
+        close(sock);
+        return -1;
+    }
+    return sock;
+}
+
+static void setReceiveTimeout(int sock, uint32_t timeoutMs) {
+    timeval timeout = {.tv_sec = 0, .tv_usec = (long)timeoutMs * 1000};
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+}
+
+static void sendTo(int sock, const sockaddr_in &address, uint8_t channel,
+                   const uint8_t *data, size_t length) {
+    uint8_t datagram[UDP_TELEMETRY_SIZE + 1];
+    if (length >= sizeof(datagram)) {
+        return;
+    }
+    datagram[0] = channel;
+    memcpy(datagram + 1, data, length);
+    sendto(sock, datagram, length + 1, 0, (const sockaddr *)&address,
+           sizeof(address));
+}
+
+static bool isSameAddress(const sockaddr_in &a, const sockaddr_in &b) {
+    return a.sin_addr.s_addr == b.sin_addr.s_addr && a.sin_port == b.sin_port;
+}
+
+// Decodes and queues a command frame the same way the BLE characteristic
+// does, and acknowledges it.
+static bool handleCommand(int sock, const sockaddr_in &from,
+                          const uint8_t *frame, size_t length) {
+    captureCommand(CaptureSource::udp, frame, length);
+
+    CommandValue command;
+    uint8_t seq = 0;
+    FrameStatus status = decodeCommandFrame(frame, length, command, seq);
+
+    if (status == FrameStatus::ok && !isCommandAllowed(command)) {
+        status = FrameStatus::notReady;
+    }
+    if (status == FrameStatus::ok && !queueCommand(command)) {
+        status = FrameStatus::busy;
+    }
+
+    uint8_t ack[2] = {seq, (uint8_t)status};
+    sendTo(sock, from, UdpChannel::command, ack, sizeof(ack));
+
+    if (status != FrameStatus::ok) {
+        ESP_LOGD(UDP_TAG, "Rejected frame, status: %d", (int)status);
+        return false;
+    }
+    signalNimble(NimbleEvents::command);
+    pulseForCommunication();
+    return true;
+}
+
+// Clips of the StrokeEngine so far, a sample clips if the count went up
+static uint32_t countClips() {
+    ClipCounters counters;
+    Stroker.getClipping(&counters);
+    uint32_t count = 0;
+    for (int i = 0; i < CLIP_TYPES; i++) {
+        count += counters.events[i];
+    }
+    return count;
+}
+
+static void udpControlTask(void *pvParameters) {
+    while (WiFi.status() != WL_CONNECTED) {
+        vTaskDelay(pdMS_TO_TICKS(500));
+    }
+
+    int sock = openSocket();
+    if (sock < 0) {
+        ESP_LOGE(UDP_TAG, "Could not listen on port %u",
+                 (unsigned)Config::Advanced::udpControlPort);
+        vTaskDelete(nullptr);
+        return;
+    }
+    ESP_LOGI(UDP_TAG, "Listening on %s:%u", WiFi.localIP().toString().c_str(),
+             (unsigned)Config::Advanced::udpControlPort);
+
+    UdpPeer peer = {};
+    uint8_t received[UDP_RECEIVE_SIZE];
+
+    StateSnapshot lastSnapshot = {};
+    uint32_t lastStateMs = 0;
+
+    UdpTelemetryPacket packet;
+    uint16_t telemetrySequence = 0;
+    uint32_t nextSampleMs = 0;
+    uint32_t packetStartMs = 0;
+    uint32_t lastClips = countClips();
+
+    while (true) {
+        // Wake up in time for the next sample, or to check the state
+        uint32_t now = millis();
+        uint32_t waitMs = NimbleEvents::pollTicks * portTICK_PERIOD_MS;
+        if (peer.isActive && peer.telemetryRateHz > 0) {
+            int32_t untilSample = int32_t(nextSampleMs - now);
+            waitMs = constrain(untilSample, 1, (int32_t)waitMs);
+        }
+        setReceiveTimeout(sock, waitMs);
+
+        sockaddr_in from = {};
+        socklen_t fromLength = sizeof(from);
+        int length = recvfrom(sock, received, sizeof(received), 0,
+                              (sockaddr *)&from, &fromLength);
+        now = millis();
+
+        if (peer.isActive &&
+            now - peer.lastSeenMs >
+                (uint32_t)Config::Advanced::udpPeerTimeoutMs) {
+            ESP_LOGI(UDP_TAG, "Peer timed out");
+            if (peer.hasCommanded && ossmInterface != nullptr) {
+                ossmInterface->rampSpeed(0, UDP_STOP_RAMP_MS);
+            }
+            peer = {};
+        }
+
+        // Other clients are ignored until the peer timed out, a datagram
+        // from the LAN doesn't take a running machine away from it
+        if (length > 0 && peer.isActive &&
+            !isSameAddress(peer.address, from)) {
+            ESP_LOGD(UDP_TAG, "Ignored %s:%u, the peer is active",
+                     inet_ntoa(from.sin_addr), (unsigned)ntohs(from.sin_port));
+            length = 0;
+        }
+
+        if (length > 0) {
+            if (!peer.isActive) {
+                ESP_LOGI(UDP_TAG, "Peer: %s:%u", inet_ntoa(from.sin_addr),
+                         (unsigned)ntohs(from.sin_port));
+                peer = {};
+                peer.address = from;
+                peer.isActive = true;
+                lastStateMs = 0;
+            }
+            peer.lastSeenMs = now;
+
+            uint8_t channel = received[0];
+            if (channel == UdpChannel::command) {
+                peer.hasCommanded |=
+                    handleCommand(sock, from, received + 1, length - 1);
+            } else if (channel == UdpChannel::state) {
+                lastStateMs = 0;
+            } else if (channel == UdpChannel::telemetry && length == 3) {
+                uint16_t rate = received[1] | (received[2] << 8);
+                peer.telemetryRateHz =
+                    min(rate, (uint16_t)Config::Advanced::telemetryMaxRateHz);
+                nextSampleMs = now;
+
+                // A partly filled packet of the old rate is dropped
+                packet.begin(telemetrySequence, 0, UDP_TELEMETRY_SIZE);
+            }
+        }
+
+        if (!peer.isActive) {
+            continue;
+        }
+
+        // State on change, and now and then so a lost datagram heals
+        if (ossmInterface != nullptr) {
+            StateSnapshot snapshot = ossmInterface->getStateSnapshot();
+            snapshot.sequence = lastSnapshot.sequence;
+            bool isChanged =
+                memcmp(&snapshot, &lastSnapshot, stateSnapshotCompared) != 0;
+            if (isChanged || lastStateMs == 0 ||
+                now - lastStateMs >=
+                    (uint32_t)Config::Advanced::udpStateIntervalMs) {
+                if (isChanged) {
+                    snapshot.sequence++;
+                }
+                sendTo(sock, peer.address, UdpChannel::state,
+                       (const uint8_t *)&snapshot, sizeof(snapshot));
+                lastSnapshot = snapshot;
+                lastStateMs = now;
+            }
+        }
+
+        if (peer.telemetryRateHz == 0 || int32_t(now - nextSampleMs) < 0) {
+            continue;
+        }
+
+        uint32_t intervalMs = 1000 / peer.telemetryRateHz;
+        nextSampleMs += intervalMs;
+        if (int32_t(now - nextSampleMs) > (int32_t)intervalMs) {
+            nextSampleMs = now + intervalMs;  // Fell behind, don't catch up
+        }
+
+        uint32_t clips = countClips();
+        TelemetrySample sample = {now, stepper->getCurrentPosition(),
+                                  stepper->getCurrentSpeedInMilliHz() / 1000,
+                                  clips != lastClips};
+        lastClips = clips;
+
+        if (packet.size() == 0) {
+            packet.begin(telemetrySequence, intervalMs, UDP_TELEMETRY_SIZE);
+            packetStartMs = now;
+        }
+        bool isAdded = packet.add(sample);
+        if (!isAdded || now - packetStartMs >=
+                            (uint32_t)Config::Advanced::telemetryFlushMs) {
+            size_t packetLength = packet.finish();
+            sendTo(sock, peer.address, UdpChannel::telemetry, packet.data(),
+                   packetLength);
+            telemetrySequence++;
+            packet.begin(telemetrySequence, intervalMs, UDP_TELEMETRY_SIZE);
+            packetStartMs = now;
+            if (!isAdded) {
+                packet.add(sample);
+            }
+        }
+    }
+}
+
+void initUdpControl() {
+    xTaskCreatePinnedToCore(udpControlTask, "udpControlTask",
+                            4 * configMINIMAL_STACK_SIZE, nullptr,
+                            Tasks::communicationPriority, &udpControlTaskH,
+                            Tasks::communicationCore);
+}
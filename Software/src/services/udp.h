@@ -0,0 +1,32 @@
+#ifndef OSSM_SOFTWARE_UDP_H
+#define OSSM_SOFTWARE_UDP_H
+
+#include <cstdint>
+
+/**
+ * Realtime control over WiFi. Off by default, build with
+ * -DOSSM_UDP_CONTROL=1 to listen on Config::Advanced::udpControlPort.
+ *
+ * Every datagram starts with a channel byte and carries the same frames as
+ * the BLE characteristic of that channel, see BLE_Protocol.md. Commands go
+ * into the same queue as the ones from BLE. The last client that sent
+ * anything is the peer, it gets the state and telemetry until it has been
+ * silent for udpPeerTimeoutMs.
+ */
+#ifndef OSSM_UDP_CONTROL
+#define OSSM_UDP_CONTROL 0
+#endif
+
+namespace UdpChannel {
+    // Binary command frame, answered with [0x01][seq][status]
+    constexpr uint8_t command = 0x01;
+    // Empty, answered with [0x02][StateSnapshot]. Sent to the peer on change.
+    constexpr uint8_t state = 0x02;
+    // uint16 rate in Hz, 0 stops. Packets are [0x03][TelemetryPacker].
+    constexpr uint8_t telemetry = 0x03;
+}
+
+// Starts the UDP control task, it waits for the WiFi by itself.
+void initUdpControl();
+
+#endif  // OSSM_SOFTWARE_UDP_H
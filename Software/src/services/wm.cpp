@@ -6,7 +6,10 @@ WiFiManager wm;
 
 void initWM() {
     WiFi.useStaticBuffers(true);
+    connectWiFi();
+}
 
+void connectWiFi() {
 #if defined(WIFI_SSID) && defined(WIFI_PASSWORD)
     WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
 #else
@@ -7,4 +7,7 @@ extern WiFiManager wm;
 
 void initWM();
 
+// Joins the configured network, or the one stored by the portal
+void connectWiFi();
+
 #endif  // OSSM_WM_H
@@ -0,0 +1,21 @@
+#ifndef SOFTWARE_COEXRECORD_H
+#define SOFTWARE_COEXRECORD_H
+
+#include <cstdint>
+
+// What the coexistence characteristic reads, packed as sent over BLE. The
+// counts cover the time since the plan last changed, see ConnEventMonitor.
+struct __attribute__((packed)) CoexRecord {
+    uint8_t policy;          // CoexPolicy
+    uint8_t isBlePreferred;  // The radio prefers BLE now
+    uint8_t wifi;            // CoexWifi now
+    uint8_t isWifiUp;        // Associated with an access point
+    uint32_t events;         // Connection events spanned by client writes
+    uint32_t missed;         // Of those, events without the expected write
+    uint16_t worstRun;       // Most events missed in a row
+    uint16_t interval;       // Connection interval in 1.25ms units
+    uint32_t cadenceUs;      // Write cadence of the client, 0 if unknown
+    uint32_t periodMs;       // Time since the plan last changed
+};
+
+#endif  // SOFTWARE_COEXRECORD_H
@@ -0,0 +1,35 @@
+#ifndef SOFTWARE_COMMANDCAPTURERECORD_H
+#define SOFTWARE_COMMANDCAPTURERECORD_H
+
+#include <cstdint>
+
+// Where a captured command was written to.
+enum class CaptureSource : uint8_t {
+    text,    // Command characteristic, a text command
+    binary,  // Binary command characteristic, a frame
+    udp,     // UDP control, the frame after the channel byte
+};
+
+// What the capture characteristic reads, packed as sent over BLE.
+struct __attribute__((packed)) CommandCaptureHeader {
+    uint32_t recorded;   // Records since the last clear, held or overwritten
+    uint16_t held;       // Records the ring holds, index 0 is the oldest
+    uint8_t recordSize;  // sizeof(CommandCaptureRecord)
+    uint8_t enabled;     // 0 if built without OSSM_CAPTURE
+};
+
+// Bytes of a command a record holds, longer writes are cut off
+#define COMMAND_CAPTURE_DATA 58
+
+// One command write as it arrived, packed as sent over BLE. 64 bytes.
+struct __attribute__((packed)) CommandCaptureRecord {
+    uint32_t timeUs;  // esp_timer_get_time() on arrival, low 32 bits
+    uint8_t source;   // CaptureSource
+    uint8_t length;   // Length of the write, above COMMAND_CAPTURE_DATA if cut
+    uint8_t data[COMMAND_CAPTURE_DATA];
+};
+
+static_assert(sizeof(CommandCaptureRecord) == 64,
+              "CommandCaptureRecord must stay packed");
+
+#endif  // SOFTWARE_COMMANDCAPTURERECORD_H
@@ -0,0 +1,54 @@
+#ifndef SOFTWARE_COMMANDVALUE_H
+#define SOFTWARE_COMMANDVALUE_H
+
+enum class Commands {
+    // GO TO
+    goToStrokeEngine,
+    goToSimplePenetration,
+    goToStreaming,
+    goToMenu,
+
+    // SET VALUES, value in hundredths of a percent (setValueScale)
+    setDepth,
+    setSensation,
+    setPattern,
+    setSpeed,
+    setStroke,
+    // Several of the above at once, value is a mask of SetValue bits
+    setValues,
+
+    // STREAMING
+    streamPosition,
+    // Preloaded script, value is the script time to start at in ms
+    playScript,
+    pauseScript,
+
+    ignore
+};
+
+// Parameters of a setValues command, in the order of the binary opcodes
+enum SetValue {
+    setValueSpeed,
+    setValueStroke,
+    setValueDepth,
+    setValueSensation,
+    setValuePattern,
+    setValueCount
+};
+
+// Set values are carried in hundredths of a percent, 5025 is 50.25%. The
+// pattern is an index, always a whole multiple of the scale.
+constexpr int setValueScale = 100;
+
+inline float percentOf(int value) { return float(value) / setValueScale; }
+
+struct CommandValue {
+    Commands command;
+    int value;
+    // Time in ms to reach a streamed position
+    int time = 0;
+    // Values of a setValues command, only those in the mask are valid
+    int values[setValueCount] = {};
+};
+
+#endif  // SOFTWARE_COMMANDVALUE_H
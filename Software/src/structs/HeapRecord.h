@@ -0,0 +1,41 @@
+#ifndef SOFTWARE_HEAPRECORD_H
+#define SOFTWARE_HEAPRECORD_H
+
+#include <cstdint>
+
+// Subsystems with a memory budget, the index of their HeapBudgetRecord.
+enum class MemoryPool : uint8_t {
+    json,    // JsonDocuments of the pattern list, catalog and update check
+    script,  // The preloaded script buffer
+    count
+};
+
+// Start of a heap report, packed as sent over BLE. The numbers are of the
+// internal heap, where NimBLE, WiFi and the tasks allocate.
+struct __attribute__((packed)) HeapHeader {
+    uint32_t freeBytes;
+    uint32_t largestBlock;  // Largest allocation that would succeed
+    uint32_t minimumFree;   // Lowest free heap since boot
+    uint32_t psramFree;     // 0 without PSRAM
+    uint32_t alertCount;    // Alerts raised since boot
+    uint8_t fragmentation;  // Percent of the free heap outside largestBlock
+    uint8_t peakFragmentation;
+    uint8_t alerts;  // HeapAlert bits active now
+    uint8_t count;   // Number of HeapBudgetRecords that follow
+};
+
+// Budget of one MemoryPool, packed as sent over BLE.
+struct __attribute__((packed)) HeapBudgetRecord {
+    uint8_t pool;       // MemoryPool
+    uint8_t reserved;
+    uint16_t failures;  // Allocations refused, over budget or out of memory
+    uint32_t limit;
+    uint32_t used;
+    uint32_t peak;
+};
+
+static_assert(sizeof(HeapHeader) == 24, "HeapHeader must stay packed");
+static_assert(sizeof(HeapBudgetRecord) == 16,
+              "HeapBudgetRecord must stay packed");
+
+#endif  // SOFTWARE_HEAPRECORD_H
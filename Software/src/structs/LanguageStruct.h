@@ -4,6 +4,8 @@
 #include <Arduino.h>
 
 struct LanguageStruct {
+    const char* AutoTune;
+    const char* AutoTuneLost;
     const char* DeepThroatTrainerSync;
     const char* Error;
     const char* GetHelp;
@@ -33,8 +35,8 @@ struct LanguageStruct {
     const char* WiFiSetupLine1;
     const char* WiFiSetupLine2;
     const char* YouShouldNotBeHere;
-    const char* StrokeEngineDescriptions[9];
-    const char* StrokeEngineNames[9];
+    const char* StrokeEngineDescriptions[11];
+    const char* StrokeEngineNames[11];
 };
 
 #endif  // OSSM_SOFTWARE_LANGUAGESTRUCT_H
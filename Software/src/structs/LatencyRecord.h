@@ -0,0 +1,27 @@
+#ifndef OSSM_SOFTWARE_LATENCYRECORD_H
+#define OSSM_SOFTWARE_LATENCYRECORD_H
+
+#include <cstdint>
+
+// Stages a probed command passes on its way to the motor, in order.
+enum class LatencyStage : uint8_t {
+    received = 0,  // binary frame arrived in the BLE host task
+    dispatched,    // nimbleLoop handed it to the OSSM
+    applied,       // the StrokeEngine planned a move with it
+    moving,        // the stepper position changed after that
+};
+
+// Timing of one probed command, packed as sent over BLE. The times of the
+// later stages are relative to received.
+struct __attribute__((packed)) LatencyRecord {
+    uint8_t seq;            // Sequence number of the binary frame
+    uint8_t stages;         // Bit n is set if stage n was reached
+    uint32_t receivedUs;    // esp_timer_get_time() on arrival, low 32 bits
+    uint32_t dispatchedUs;  // 0 unless the stage was reached
+    uint32_t appliedUs;
+    uint32_t movingUs;
+};
+
+static_assert(sizeof(LatencyRecord) == 18, "LatencyRecord must stay packed");
+
+#endif  // OSSM_SOFTWARE_LATENCYRECORD_H
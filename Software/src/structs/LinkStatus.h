@@ -0,0 +1,15 @@
+#ifndef SOFTWARE_LINKSTATUS_H
+#define SOFTWARE_LINKSTATUS_H
+
+#include <cstdint>
+
+// Parameters of the newest BLE connection, as reported by the NimBLE host.
+struct LinkStatus {
+    uint16_t interval = 0;  // Connection interval in 1.25ms units
+    uint16_t latency = 0;   // Connection events the peripheral may skip
+    uint16_t timeout = 0;   // Supervision timeout in 10ms units
+    uint16_t mtu = 23;
+    uint8_t phy = 1;  // TX PHY: 1 = 1M, 2 = 2M, 3 = coded
+};
+
+#endif  // SOFTWARE_LINKSTATUS_H
@@ -8,4 +8,34 @@ struct Point {
     u8g2_uint_t y;
 };
 
+struct Box {
+    int16_t x;
+    int16_t y;
+    int16_t w;
+    int16_t h;
+
+    bool isEmpty() const { return w <= 0 || h <= 0; }
+
+    bool overlaps(const Box &other) const {
+        return !isEmpty() && !other.isEmpty() && x < other.x + other.w &&
+               other.x < x + w && y < other.y + other.h && other.y < y + h;
+    }
+
+    // Smallest box around both
+    Box merged(const Box &other) const {
+        if (isEmpty()) {
+            return other;
+        }
+        if (other.isEmpty()) {
+            return *this;
+        }
+        int16_t left = x < other.x ? x : other.x;
+        int16_t top = y < other.y ? y : other.y;
+        int16_t right = x + w > other.x + other.w ? x + w : other.x + other.w;
+        int16_t bottom =
+            y + h > other.y + other.h ? y + h : other.y + other.h;
+        return {left, top, (int16_t)(right - left), (int16_t)(bottom - top)};
+    }
+};
+
 #endif  // SOFTWARE_POINTS_H
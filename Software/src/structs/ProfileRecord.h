@@ -0,0 +1,39 @@
+#ifndef SOFTWARE_PROFILERECORD_H
+#define SOFTWARE_PROFILERECORD_H
+
+#include <cstdint>
+
+// Hot paths the profiler times, the index of their ProfileRecord.
+enum class ProfileProbe : uint8_t {
+    stroking,        // One pass of the StrokeEngine stroking loop
+    motionProfile,   // StrokeEngine handing one move to the servo
+    bleCommand,      // OSSM::ble_click, parsing and executing a command
+    stateJson,       // OSSM::getCurrentState, formatting the state
+    displayFlush,    // Sending a frame to the display
+    analogSample,    // getAnalogAveragePercent
+    ledShow,         // FastLED.show()
+    processEvent,    // One state machine process_event, without the lock wait
+    eventWait,       // A posted event until the dispatcher takes it
+    count
+};
+
+// Start of a profile, packed as sent over BLE.
+struct __attribute__((packed)) ProfileHeader {
+    uint16_t cpuMhz;  // Cycles per µs
+    uint8_t count;    // Number of ProfileRecords that follow
+    uint8_t enabled;  // 0 if built without OSSM_PROFILE, the records are empty
+};
+
+// Timing of one probe since boot, packed as sent over BLE.
+struct __attribute__((packed)) ProfileRecord {
+    uint8_t probe;  // ProfileProbe
+    uint32_t count;
+    uint32_t minCycles;
+    uint32_t meanCycles;
+    uint32_t maxCycles;
+};
+
+static_assert(sizeof(ProfileHeader) == 4, "ProfileHeader must stay packed");
+static_assert(sizeof(ProfileRecord) == 17, "ProfileRecord must stay packed");
+
+#endif  // SOFTWARE_PROFILERECORD_H
@@ -1,6 +1,8 @@
 #ifndef SOFTWARE_SETTINGPERCENTS_H
 #define SOFTWARE_SETTINGPERCENTS_H
 
+#include <optional>
+
 enum class StrokePatterns {
     SimpleStroke,
     TeasingPounding,
@@ -11,6 +13,8 @@ enum class StrokePatterns {
     Insist,
     Knot,
     Struggle,
+    Custom,
+    Twist,
 };
 
 struct SettingPercents {
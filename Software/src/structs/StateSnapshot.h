@@ -0,0 +1,29 @@
+#ifndef SOFTWARE_STATESNAPSHOT_H
+#define SOFTWARE_STATESNAPSHOT_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Packed view of the machine state as sent over BLE. The fields up to the
+// sequence are plain bytes, so two snapshots can be compared with a single
+// memcmp over stateSnapshotCompared bytes.
+struct __attribute__((packed)) StateSnapshot {
+    uint8_t state;  // StateId
+    uint8_t speed;
+    uint8_t stroke;
+    uint8_t sensation;
+    uint8_t depth;
+    uint8_t pattern;
+    // Incremented by the sender every time the snapshot changes
+    uint16_t sequence;
+    // Session statistics. They change with every stroke and only ride along
+    // with changes of the fields above and the heartbeat.
+    uint32_t strokes;
+    uint32_t distance;  // [mm]
+};
+
+static_assert(sizeof(StateSnapshot) == 16, "StateSnapshot must stay packed");
+
+constexpr size_t stateSnapshotCompared = offsetof(StateSnapshot, sequence);
+
+#endif  // SOFTWARE_STATESNAPSHOT_H
@@ -0,0 +1,25 @@
+#ifndef SOFTWARE_STATETRACERECORD_H
+#define SOFTWARE_STATETRACERECORD_H
+
+#include <cstdint>
+
+enum class StateTraceKind : uint8_t {
+    event,
+    guardPassed,
+    guardFailed,
+    stateChange,
+};
+
+// One state machine trace entry, packed as sent over BLE.
+struct __attribute__((packed)) StateTraceRecord {
+    uint32_t timeMs;
+    StateTraceKind kind;
+    uint8_t event;  // EventId
+    uint8_t src;    // StateId, the current state for events and guards
+    uint8_t dst;    // StateId, only set for state changes
+};
+
+static_assert(sizeof(StateTraceRecord) == 8,
+              "StateTraceRecord must stay packed");
+
+#endif  // SOFTWARE_STATETRACERECORD_H
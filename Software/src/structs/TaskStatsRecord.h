@@ -0,0 +1,34 @@
+#ifndef SOFTWARE_TASKSTATSRECORD_H
+#define SOFTWARE_TASKSTATSRECORD_H
+
+#include <cstdint>
+
+// Start of a task report, packed as sent over BLE.
+struct __attribute__((packed)) TaskStatsHeader {
+    uint32_t windowMs;     // Time since the previous report
+    uint16_t coreLoad[2];  // Busy time of each core in permille
+    uint8_t count;         // Number of TaskStatsRecords that follow
+    uint8_t runTimeStats;  // 0 if built without run time stats, loads are 0
+};
+
+// One task of a task report, packed as sent over BLE.
+struct __attribute__((packed)) TaskStatsRecord {
+    char name[12];  // Truncated, zero padded
+    uint8_t priority;
+    uint8_t core;   // 0xFF for tasks that aren't pinned
+    uint16_t load;  // Share of one core since the previous report in permille
+};
+
+// Smallest free stack a task ever had, packed as sent over BLE. Tasks are
+// told apart by name, so a task started again adds to the same record.
+struct __attribute__((packed)) StackUsageRecord {
+    char name[12];     // Truncated, zero padded
+    uint16_t minFree;  // Stack high-water mark in bytes
+};
+
+static_assert(sizeof(TaskStatsHeader) == 10, "TaskStatsHeader must stay packed");
+static_assert(sizeof(TaskStatsRecord) == 16, "TaskStatsRecord must stay packed");
+static_assert(sizeof(StackUsageRecord) == 14,
+              "StackUsageRecord must stay packed");
+
+#endif  // SOFTWARE_TASKSTATSRECORD_H
@@ -0,0 +1,14 @@
+#ifndef OSSM_SOFTWARE_TELEMETRYSAMPLE_H
+#define OSSM_SOFTWARE_TELEMETRYSAMPLE_H
+
+#include <cstdint>
+
+// One sample of the motion telemetry, taken from the stepper.
+struct TelemetrySample {
+    uint32_t timeMs;    // millis() when sampled
+    int32_t position;   // current position in steps
+    int32_t velocity;   // current speed in steps/s, negative when retracting
+    bool clipping;      // the current move was clipped by the speed limits
+};
+
+#endif  // OSSM_SOFTWARE_TELEMETRYSAMPLE_H
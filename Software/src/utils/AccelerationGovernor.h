@@ -0,0 +1,88 @@
+#ifndef OSSM_SOFTWARE_ACCELERATIONGOVERNOR_H
+#define OSSM_SOFTWARE_ACCELERATIONGOVERNOR_H
+
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+
+/**
+ * Derates the motion limits while the motor works close to a stall, from a
+ * stream of current samples (in percent, offset already removed).
+ *
+ * The mean of every Window samples is checked. Above derateAt the scale of
+ * the limits drops in proportion to the overload, down to minScale. Once the
+ * mean stays below restoreAt for restoreWindows windows in a row, the scale
+ * comes back up by one step. The scale moves in steps only, so the limits
+ * are touched rarely.
+ *
+ * update() is called from the sampling task, getScale() from anywhere.
+ */
+template <size_t Window = 32>
+class AccelerationGovernor {
+  public:
+    static constexpr float step = 0.05f;
+
+    AccelerationGovernor(float derateAt, float restoreAt, float minScale,
+                         size_t restoreWindows)
+        : derateAt(derateAt),
+          restoreAt(restoreAt),
+          minScale(minScale),
+          restoreWindows(restoreWindows) {}
+
+    void reset() {
+        count = 0;
+        sum = 0;
+        quietWindows = 0;
+        scale.store(1.0f);
+    }
+
+    // Returns true when the scale changed with this sample.
+    bool update(float sample) {
+        sum += sample;
+        if (++count < Window) {
+            return false;
+        }
+
+        float mean = sum / Window;
+        count = 0;
+        sum = 0;
+
+        float current = scale.load();
+        float next = current;
+        if (derateAt > 0 && mean > derateAt) {
+            // Down to the next step below the proportional scale
+            next = std::floor(current * derateAt / mean / step) * step;
+            next = std::fmax(std::fmin(next, current - step), minScale);
+            quietWindows = 0;
+        } else if (mean < restoreAt) {
+            if (++quietWindows >= restoreWindows) {
+                next = std::fmin(current + step, 1.0f);
+                quietWindows = 0;
+            }
+        } else {
+            quietWindows = 0;
+        }
+
+        if (next == current) {
+            return false;
+        }
+        scale.store(next);
+        return true;
+    }
+
+    // Factor for the acceleration and speed limits, minScale to 1
+    float getScale() const { return scale.load(); }
+
+  private:
+    float derateAt;
+    float restoreAt;
+    float minScale;
+    size_t restoreWindows;
+
+    size_t count = 0;
+    float sum = 0;
+    size_t quietWindows = 0;
+    std::atomic<float> scale{1.0f};
+};
+
+#endif  // OSSM_SOFTWARE_ACCELERATIONGOVERNOR_H
@@ -0,0 +1,19 @@
+#ifndef OSSM_SOFTWARE_BUTTONTICKING_H
+#define OSSM_SOFTWARE_BUTTONTICKING_H
+
+#include <cstdint>
+
+/**
+ * Whether the input task has to keep ticking OneButton, or may sleep until
+ * the next edge. OneButton debounces the level: right after an edge the
+ * level hasn't held for the debounce time yet, so a tick leaves it idle,
+ * and the edge only reaches its state machine on a tick after the debounce
+ * time. It may sleep once the button is idle and the newest edge is more
+ * than debounceUs ago. Unsigned differences keep this right across a wrap.
+ */
+inline bool isButtonTicking(bool isIdle, uint32_t nowUs, uint32_t lastEdgeUs,
+                            uint32_t debounceUs) {
+    return !isIdle || nowUs - lastEdgeUs <= debounceUs;
+}
+
+#endif  // OSSM_SOFTWARE_BUTTONTICKING_H
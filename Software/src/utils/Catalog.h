@@ -0,0 +1,68 @@
+#ifndef OSSM_SOFTWARE_CATALOG_H
+#define OSSM_SOFTWARE_CATALOG_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+/**
+ * Pattern catalog: one blob with everything a client shows about the
+ * patterns, addressed by its hash. Clients keep the blob and only fetch it
+ * again when the hash changes, see BLE_Protocol.md.
+ */
+
+// Bump when the layout of the blob changes
+#define CATALOG_VERSION 1
+
+// What the info characteristic reads, little endian.
+struct __attribute__((packed)) CatalogInfo {
+    uint8_t version;
+    uint8_t reserved[3];
+    uint32_t hash;    // catalogHash() of the blob
+    uint32_t length;  // Bytes in the blob
+};
+
+static_assert(sizeof(CatalogInfo) == 12, "CatalogInfo must be 12 bytes");
+
+// Chunks start with the offset of their first byte in the blob
+constexpr size_t catalogChunkHeader = 4;
+
+// 32 bit FNV-1a, good enough to tell catalogs apart
+inline uint32_t catalogHash(const uint8_t* data, size_t length) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= data[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+inline CatalogInfo catalogInfo(const uint8_t* blob, size_t length) {
+    CatalogInfo info = {};
+    info.version = CATALOG_VERSION;
+    info.hash = catalogHash(blob, length);
+    info.length = (uint32_t)length;
+    return info;
+}
+
+// Writes the chunk of the blob at offset into out, at most limit bytes
+// including the header. Returns its size, 0 if offset is past the end.
+inline size_t catalogChunk(const uint8_t* blob, size_t length, uint32_t offset,
+                           uint8_t* out, size_t limit) {
+    if (offset >= length || limit <= catalogChunkHeader) {
+        return 0;
+    }
+
+    size_t count = length - offset;
+    if (count > limit - catalogChunkHeader) {
+        count = limit - catalogChunkHeader;
+    }
+
+    for (size_t i = 0; i < catalogChunkHeader; i++) {
+        out[i] = (uint8_t)(offset >> (8 * i));
+    }
+    memcpy(out + catalogChunkHeader, blob + offset, count);
+    return catalogChunkHeader + count;
+}
+
+#endif  // OSSM_SOFTWARE_CATALOG_H
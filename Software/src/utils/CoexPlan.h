@@ -0,0 +1,77 @@
+#ifndef OSSM_SOFTWARE_COEXPLAN_H
+#define OSSM_SOFTWARE_COEXPLAN_H
+
+#include <cstdint>
+
+#include "ossm/States.h"
+
+/**
+ * WiFi and BLE share the radio of the ESP32. With the default coexistence
+ * the WiFi gets its share of air time even while a BLE client drives the
+ * machine, and connection events that fall into it are late or missed.
+ *
+ * The policy decides how much of the radio the WiFi keeps while a play mode
+ * runs with a BLE client:
+ *  - balanced:  as ESP-IDF shares it, nothing changes.
+ *  - preferBle: BLE wins the radio. The WiFi stays up, in modem sleep unless
+ *               the build controls or logs over WiFi.
+ *  - bleOnly:   as preferBle, and the WiFi disconnects unless the build
+ *               controls or logs over WiFi.
+ * Outside play modes, and without a BLE client, the WiFi is fully up, so
+ * the update and wifi modes always have it.
+ */
+enum class CoexPolicy : uint8_t { balanced, preferBle, bleOnly };
+
+// full is the least modem sleep ESP-IDF allows while BT is on
+enum class CoexWifi : uint8_t { full, sleep, off };
+
+struct CoexPlan {
+    bool isBlePreferred = false;
+    CoexWifi wifi = CoexWifi::full;
+
+    constexpr bool operator==(const CoexPlan& other) const {
+        return isBlePreferred == other.isBlePreferred && wifi == other.wifi;
+    }
+    constexpr bool operator!=(const CoexPlan& other) const {
+        return !(*this == other);
+    }
+};
+
+// isWifiControl: the build takes commands or sends its log over WiFi
+constexpr CoexPlan planCoex(CoexPolicy policy, StateId state,
+                            bool isBleConnected, bool isWifiControl) {
+    if (policy == CoexPolicy::balanced || !isBleConnected ||
+        !isPlayMode(state)) {
+        return {false, CoexWifi::full};
+    }
+    if (policy == CoexPolicy::preferBle) {
+        return {true, isWifiControl ? CoexWifi::full : CoexWifi::sleep};
+    }
+    return {true, isWifiControl ? CoexWifi::sleep : CoexWifi::off};
+}
+
+inline const char* coexPolicyName(CoexPolicy policy) {
+    switch (policy) {
+        case CoexPolicy::balanced:
+            return "balanced";
+        case CoexPolicy::preferBle:
+            return "preferBle";
+        case CoexPolicy::bleOnly:
+            return "bleOnly";
+    }
+    return "unknown";
+}
+
+inline const char* coexWifiName(CoexWifi wifi) {
+    switch (wifi) {
+        case CoexWifi::full:
+            return "full";
+        case CoexWifi::sleep:
+            return "sleep";
+        case CoexWifi::off:
+            return "off";
+    }
+    return "unknown";
+}
+
+#endif  // OSSM_SOFTWARE_COEXPLAN_H
@@ -0,0 +1,85 @@
+#ifndef OSSM_SOFTWARE_CONNEVENTMONITOR_H
+#define OSSM_SOFTWARE_CONNEVENTMONITOR_H
+
+#include <cstdint>
+
+/**
+ * Estimates missed BLE connection events from the arrival times of the
+ * writes of a client. The host doesn't report connection events, but a
+ * client that streams commands writes at a steady cadence, so a write that
+ * arrives whole connection intervals later than its cadence waited for
+ * events that didn't happen, or were taken by the WiFi.
+ *
+ * The cadence is the mean of the first learnGaps gaps between writes, and a
+ * running average after that. Writes within half an interval share a
+ * connection event. A gap of more than maxLateEvents intervals past the
+ * cadence is a pause of the client, not a miss, and the cadence is learned
+ * again.
+ */
+class ConnEventMonitor {
+  public:
+    static constexpr int64_t maxLateEvents = 8;
+    static constexpr int learnGaps = 8;
+
+    // A write arrived at nowUs, on a link with interval in 1.25ms units
+    void record(int64_t nowUs, uint16_t interval) {
+        if (interval == 0) {
+            return;
+        }
+        int64_t intervalUs = int64_t(interval) * 1250;
+        if (!isStarted) {
+            isStarted = true;
+            lastUs = nowUs;
+            return;
+        }
+
+        int64_t gap = nowUs - lastUs;
+        if (gap < intervalUs / 2) {
+            return;
+        }
+        lastUs = nowUs;
+        if (learnedGaps < learnGaps) {
+            learnedGaps++;
+            cadenceUs += (gap - cadenceUs) / learnedGaps;
+            return;
+        }
+        if (gap > cadenceUs + maxLateEvents * intervalUs) {
+            cadenceUs = 0;
+            learnedGaps = 0;
+            return;
+        }
+
+        // Late by a quarter interval less, so jitter doesn't count
+        int64_t late = gap - cadenceUs + intervalUs / 4;
+        uint32_t lateEvents = late > 0 ? uint32_t(late / intervalUs) : 0;
+        events += 1 + lateEvents;
+        missed += lateEvents;
+        if (lateEvents > worstRun) {
+            worstRun = lateEvents;
+        }
+        cadenceUs += (gap - cadenceUs) / 8;
+    }
+
+    void reset() { *this = ConnEventMonitor(); }
+
+    // Connection events the writes spanned, missed ones included
+    uint32_t getEvents() const { return events; }
+    uint32_t getMissed() const { return missed; }
+    // Most events missed in a row
+    uint32_t getWorstRun() const { return worstRun; }
+    // 0 until the cadence is known
+    uint32_t getCadenceUs() const {
+        return learnedGaps < learnGaps ? 0 : uint32_t(cadenceUs);
+    }
+
+  private:
+    bool isStarted = false;
+    int64_t lastUs = 0;
+    int64_t cadenceUs = 0;
+    int learnedGaps = 0;
+    uint32_t events = 0;
+    uint32_t missed = 0;
+    uint32_t worstRun = 0;
+};
+
+#endif  // OSSM_SOFTWARE_CONNEVENTMONITOR_H
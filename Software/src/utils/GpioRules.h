@@ -0,0 +1,129 @@
+#ifndef OSSM_SOFTWARE_GPIORULES_H
+#define OSSM_SOFTWARE_GPIORULES_H
+
+#include <cstddef>
+#include <cstdint>
+
+#define GPIO_RULE_COUNT 8
+
+// When a rule fires. Deeper is towards higher step positions.
+enum class GpioTrigger : uint8_t {
+    depth,    // A pattern move came to a stop at its deep end
+    retract,  // A pattern move came to a stop at its shallow end
+    inward,   // The stepper crossed the position going deeper
+    outward,  // The stepper crossed the position going back
+};
+
+enum class GpioAction : uint8_t { low, high, toggle, pulse };
+
+// Output that follows the stroke, set over the GPIO characteristic.
+struct GpioRule {
+    uint8_t index = 0;  // GPIO 1-4, 0 for an empty slot
+    GpioTrigger trigger = GpioTrigger::depth;
+    GpioAction action = GpioAction::high;
+    uint16_t pulseMs = 0;    // How long a pulse stays high
+    float positionMm = 0.0;  // Position inward and outward rules cross
+};
+
+/**
+ * Fixed table of GPIO rules, fed with the ends of the pattern moves and with
+ * samples of the step position. Each feed calls fire(const GpioRule&) for
+ * every rule it triggers, in slot order. Not thread safe, the caller locks.
+ */
+template <size_t Count = GPIO_RULE_COUNT>
+class GpioRuleTable {
+  public:
+    explicit GpioRuleTable(float stepsPerMm) : stepsPerMm(stepsPerMm) {}
+
+    // False if there is no such slot. A rule with index 0 clears the slot.
+    bool set(size_t slot, const GpioRule& rule) {
+        if (slot >= Count) {
+            return false;
+        }
+        rules[slot] = rule;
+        thresholds[slot] = int(rule.positionMm * stepsPerMm + 0.5f);
+        return true;
+    }
+
+    void clear() {
+        for (size_t slot = 0; slot < Count; slot++) {
+            rules[slot] = GpioRule();
+        }
+    }
+
+    const GpioRule& get(size_t slot) const { return rules[slot]; }
+
+    bool empty() const {
+        for (const GpioRule& rule : rules) {
+            if (rule.index != 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // True if some rule needs the step position sampled
+    bool hasThresholds() const {
+        for (const GpioRule& rule : rules) {
+            if (rule.index != 0 && isThreshold(rule.trigger)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // A pattern move from one step position to another came to a stop
+    template <class Fire>
+    void finish(int from, int to, Fire&& fire) const {
+        if (from == to) {
+            return;
+        }
+        GpioTrigger trigger =
+            to > from ? GpioTrigger::depth : GpioTrigger::retract;
+        for (const GpioRule& rule : rules) {
+            if (rule.index != 0 && rule.trigger == trigger) {
+                fire(rule);
+            }
+        }
+    }
+
+    // Fires the rules whose position lies between the previous sample and
+    // this one, passed in their direction. A rule exactly at the previous
+    // sample already fired with it. The first sample only sets the start.
+    template <class Fire>
+    void sample(int position, Fire&& fire) {
+        if (hasLast && position != last) {
+            for (size_t slot = 0; slot < Count; slot++) {
+                const GpioRule& rule = rules[slot];
+                int threshold = thresholds[slot];
+                bool isCrossed =
+                    (rule.trigger == GpioTrigger::inward && last < threshold &&
+                     position >= threshold) ||
+                    (rule.trigger == GpioTrigger::outward &&
+                     last > threshold && position <= threshold);
+                if (rule.index != 0 && isCrossed) {
+                    fire(rule);
+                }
+            }
+        }
+        last = position;
+        hasLast = true;
+    }
+
+    // Forgets the last sample, e.g. while homing moved the frame
+    void resetPosition() { hasLast = false; }
+
+  private:
+    static bool isThreshold(GpioTrigger trigger) {
+        return trigger == GpioTrigger::inward ||
+               trigger == GpioTrigger::outward;
+    }
+
+    GpioRule rules[Count];
+    int thresholds[Count] = {};
+    float stepsPerMm;
+    int last = 0;
+    bool hasLast = false;
+};
+
+#endif  // OSSM_SOFTWARE_GPIORULES_H
@@ -0,0 +1,143 @@
+#ifndef OSSM_SOFTWARE_HEAPTREND_H
+#define OSSM_SOFTWARE_HEAPTREND_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace HeapAlert {
+    // Much of the free heap is outside the largest block
+    constexpr uint8_t fragmented = 0x01;
+    // The largest block is below the floor, large allocations start failing
+    constexpr uint8_t lowBlock = 0x02;
+    // The smallest largest block of a period fell, period after period
+    constexpr uint8_t shrinking = 0x04;
+}
+
+// Percent of the free heap that isn't in the largest block
+constexpr uint8_t fragmentationOf(uint32_t freeBytes, uint32_t largestBlock) {
+    return freeBytes == 0 || largestBlock >= freeBytes
+               ? 0
+               : uint8_t(100 - uint64_t(largestBlock) * 100 / freeBytes);
+}
+
+/**
+ * Watches heap samples for fragmentation. fragmented and lowBlock are set
+ * from each sample and clear with some hysteresis, so a heap close to the
+ * limit doesn't raise them over and over. shrinking compares the smallest
+ * largest block of each periodSamples samples with the one before: a block
+ * that keeps getting smaller for shrinkPeriods periods in a row is the
+ * leak or churn of a long session, before it gets critical.
+ */
+class HeapTrend {
+  public:
+    HeapTrend(uint8_t fragmentedPercent, uint32_t lowBlockBytes,
+              uint16_t periodSamples, uint8_t shrinkPeriods)
+        : fragmentedPercent(fragmentedPercent),
+          lowBlockBytes(lowBlockBytes),
+          periodSamples(periodSamples),
+          shrinkPeriods(shrinkPeriods) {}
+
+    // Adds a sample, returns the alerts it raised
+    uint8_t add(uint32_t freeBytes, uint32_t largestBlock) {
+        fragmentation = fragmentationOf(freeBytes, largestBlock);
+        if (fragmentation > peakFragmentation) {
+            peakFragmentation = fragmentation;
+        }
+
+        uint8_t next = 0;
+        bool wasFragmented = (alerts & HeapAlert::fragmented) != 0;
+        if (fragmentation >= fragmentedPercent ||
+            (wasFragmented && fragmentation + 10 >= fragmentedPercent)) {
+            next |= HeapAlert::fragmented;
+        }
+        bool wasLow = (alerts & HeapAlert::lowBlock) != 0;
+        if (largestBlock < lowBlockBytes ||
+            (wasLow && largestBlock < lowBlockBytes + lowBlockBytes / 4)) {
+            next |= HeapAlert::lowBlock;
+        }
+
+        if (periodCount == 0 || largestBlock < periodMinimum) {
+            periodMinimum = largestBlock;
+        }
+        if (++periodCount == periodSamples) {
+            bool isLower = hasPeriod && periodMinimum < lastMinimum;
+            shrinkRun = isLower ? shrinkRun + 1 : 0;
+            lastMinimum = periodMinimum;
+            hasPeriod = true;
+            periodCount = 0;
+        }
+        if (shrinkRun >= shrinkPeriods) {
+            next |= HeapAlert::shrinking;
+        }
+
+        uint8_t raised = next & ~alerts;
+        alerts = next;
+        return raised;
+    }
+
+    uint8_t getAlerts() const { return alerts; }
+    uint8_t getFragmentation() const { return fragmentation; }
+    uint8_t getPeakFragmentation() const { return peakFragmentation; }
+    // Periods in a row the largest block got smaller
+    uint8_t getShrinkRun() const { return shrinkRun; }
+
+  private:
+    uint8_t fragmentedPercent;
+    uint32_t lowBlockBytes;
+    uint16_t periodSamples;
+    uint8_t shrinkPeriods;
+
+    uint8_t alerts = 0;
+    uint8_t fragmentation = 0;
+    uint8_t peakFragmentation = 0;
+    uint16_t periodCount = 0;
+    uint32_t periodMinimum = 0;
+    uint32_t lastMinimum = 0;
+    bool hasPeriod = false;
+    uint8_t shrinkRun = 0;
+};
+
+/**
+ * Fixed budget of a subsystem. Allocations are reserved before they are
+ * made and released when they are freed, so used never exceeds limit. Not
+ * thread safe, the owner locks.
+ */
+class MemoryBudget {
+  public:
+    explicit MemoryBudget(uint32_t limit = 0) : limit(limit) {}
+
+    // False, and counted, if bytes don't fit into what is left
+    bool reserve(size_t bytes) {
+        if (bytes > limit - used) {
+            fail();
+            return false;
+        }
+        used += bytes;
+        if (used > peak) {
+            peak = used;
+        }
+        return true;
+    }
+
+    void release(size_t bytes) { used -= bytes < used ? bytes : used; }
+
+    // An allocation that fit the budget, but not the heap
+    void fail() {
+        if (failures < UINT16_MAX) {
+            failures++;
+        }
+    }
+
+    uint32_t getLimit() const { return limit; }
+    uint32_t getUsed() const { return used; }
+    uint32_t getPeak() const { return peak; }
+    uint16_t getFailures() const { return failures; }
+
+  private:
+    uint32_t limit;
+    uint32_t used = 0;
+    uint32_t peak = 0;
+    uint16_t failures = 0;
+};
+
+#endif  // OSSM_SOFTWARE_HEAPTREND_H
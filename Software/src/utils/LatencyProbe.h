@@ -0,0 +1,77 @@
+#ifndef OSSM_SOFTWARE_LATENCYPROBE_H
+#define OSSM_SOFTWARE_LATENCYPROBE_H
+
+#include <cstdint>
+
+#include "structs/LatencyRecord.h"
+
+/**
+ * Follows one command at a time from the radio to the motor. begin() starts
+ * the clock for a sequence number, mark() stamps every stage the first time
+ * it is reached after the stage before it, so events of other commands that
+ * arrive out of order are ignored. finish() hands out the record and frees
+ * the probe for the next command.
+ *
+ * Not thread safe, the callers share one lock.
+ */
+class LatencyProbe {
+  public:
+    // Returns false while another command is being followed.
+    bool begin(uint8_t seq, uint32_t now) {
+        if (active) {
+            return false;
+        }
+        active = true;
+        record = {};
+        record.seq = seq;
+        record.stages = bit(LatencyStage::received);
+        record.receivedUs = now;
+        return true;
+    }
+
+    // Returns true if the stage got stamped by this call.
+    bool mark(LatencyStage stage, uint32_t now) {
+        if (!active || stage == LatencyStage::received || reached(stage) ||
+            !reached(LatencyStage(uint8_t(stage) - 1))) {
+            return false;
+        }
+
+        uint32_t elapsed = now - record.receivedUs;
+        switch (stage) {
+            case LatencyStage::dispatched:
+                record.dispatchedUs = elapsed;
+                break;
+            case LatencyStage::applied:
+                record.appliedUs = elapsed;
+                break;
+            default:
+                record.movingUs = elapsed;
+                break;
+        }
+        record.stages |= bit(stage);
+        return true;
+    }
+
+    bool reached(LatencyStage stage) const {
+        return active && (record.stages & bit(stage)) != 0;
+    }
+
+    bool isActive() const { return active; }
+
+    uint32_t elapsed(uint32_t now) const {
+        return active ? now - record.receivedUs : 0;
+    }
+
+    LatencyRecord finish() {
+        active = false;
+        return record;
+    }
+
+  private:
+    static uint8_t bit(LatencyStage stage) { return 1 << uint8_t(stage); }
+
+    bool active = false;
+    LatencyRecord record = {};
+};
+
+#endif  // OSSM_SOFTWARE_LATENCYPROBE_H
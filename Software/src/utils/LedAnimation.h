@@ -0,0 +1,91 @@
+#ifndef OSSM_SOFTWARE_LEDANIMATION_H
+#define OSSM_SOFTWARE_LEDANIMATION_H
+
+#include <cstdint>
+
+/**
+ * Declarative LED animations. An animation only describes what the LED does
+ * over time, the LED engine task renders a frame of it whenever it draws.
+ * Rendering is a pure function of the time, so nothing has to be stepped
+ * and a late frame simply shows the right phase.
+ */
+enum class LedEffect : uint8_t {
+    solid,    // color at level to
+    breathe,  // color, level going from -> to -> from every periodMs
+    fade,     // color, level going from -> to within periodMs, then kept
+    rainbow,  // one hue cycle every periodMs at level to
+};
+
+struct LedAnimation {
+    LedEffect effect = LedEffect::solid;
+    uint32_t color = 0;  // 0xRRGGBB
+    uint16_t periodMs = 1000;
+    uint8_t from = 0;
+    uint8_t to = 255;
+    uint32_t startMs = 0;
+    // The animation is over after this long, 0 runs until it is replaced
+    uint32_t durationMs = 0;
+
+    bool isDone(uint32_t now) const {
+        return durationMs > 0 && now - startMs >= durationMs;
+    }
+};
+
+// One rendered frame: a color or a hue, scaled to level.
+struct LedFrame {
+    uint32_t color = 0;  // 0xRRGGBB, unused if isHue
+    bool isHue = false;
+    uint8_t hue = 0;
+    uint8_t level = 0;
+
+    bool operator==(const LedFrame &other) const {
+        return color == other.color && isHue == other.isHue &&
+               hue == other.hue && level == other.level;
+    }
+    bool operator!=(const LedFrame &other) const { return !(*this == other); }
+};
+
+// Level between from (t = 0) and to (t = 1)
+inline uint8_t lerpLevel(uint8_t from, uint8_t to, uint32_t t, uint32_t span) {
+    if (span == 0 || t >= span) {
+        return to;
+    }
+    return (uint8_t)(from + ((int32_t)to - from) * (int32_t)t / (int32_t)span);
+}
+
+inline LedFrame renderLedAnimation(const LedAnimation &animation,
+                                   uint32_t now) {
+    LedFrame frame;
+    frame.color = animation.color;
+    frame.level = animation.to;
+
+    uint32_t elapsed = now - animation.startMs;
+    uint32_t period = animation.periodMs > 0 ? animation.periodMs : 1;
+
+    switch (animation.effect) {
+        case LedEffect::solid:
+            break;
+        case LedEffect::breathe: {
+            // Linear up and down, like the original stepping
+            uint32_t phase = elapsed % period;
+            uint32_t half = period / 2;
+            frame.level =
+                phase < half
+                    ? lerpLevel(animation.from, animation.to, phase, half)
+                    : lerpLevel(animation.to, animation.from, phase - half,
+                                period - half);
+            break;
+        }
+        case LedEffect::fade:
+            frame.level =
+                lerpLevel(animation.from, animation.to, elapsed, period);
+            break;
+        case LedEffect::rainbow:
+            frame.isHue = true;
+            frame.hue = (uint8_t)((elapsed % period) * 256 / period);
+            break;
+    }
+    return frame;
+}
+
+#endif  // OSSM_SOFTWARE_LEDANIMATION_H
@@ -0,0 +1,159 @@
+#ifndef OSSM_SOFTWARE_LIMITSEARCH_H
+#define OSSM_SOFTWARE_LIMITSEARCH_H
+
+#include <cmath>
+#include <cstdint>
+
+/**
+ * Motion limits of a machine, in mm/s and mm/s². The defaults come from
+ * Config::Driver, an auto tune replaces them with what this machine
+ * reliably reached. Kept in NVS.
+ */
+struct MachineLimits {
+    float maxSpeedMmPerSecond = 0;
+    float maxAcceleration = 0;
+
+    bool isValid(const MachineLimits &floor,
+                 const MachineLimits &ceiling) const {
+        return std::isfinite(maxSpeedMmPerSecond) &&
+               std::isfinite(maxAcceleration) &&
+               maxSpeedMmPerSecond >= floor.maxSpeedMmPerSecond &&
+               maxSpeedMmPerSecond <= ceiling.maxSpeedMmPerSecond &&
+               maxAcceleration >= floor.maxAcceleration &&
+               maxAcceleration <= ceiling.maxAcceleration;
+    }
+};
+
+// Top speed of a move over distanceMm that accelerates for the first half
+// and brakes for the second. Faster trials couldn't go faster than this.
+inline float reachableSpeed(float acceleration, float distanceMm) {
+    return std::sqrt(std::fmax(acceleration * distanceMm, 0.0f));
+}
+
+/**
+ * Search for the limits of a machine, one trial at a time. The speed is
+ * raised first at the start acceleration, then the acceleration at the
+ * highest reliable speed. Each grows by stepFactor per trial, up to the
+ * ceiling. After the first unreliable trial refineSteps bisections between
+ * it and the last reliable one close in on the limit. The result is margin
+ * of the highest reliable values.
+ *
+ * Unreliable start limits end the search without a result.
+ */
+class LimitSearch {
+  public:
+    enum class Phase : uint8_t { speed, acceleration, done };
+
+    LimitSearch(const MachineLimits &start, const MachineLimits &ceiling,
+             float stepFactor, uint8_t refineSteps, float margin)
+        : ceiling(ceiling),
+          stepFactor(stepFactor),
+          refineSteps(refineSteps),
+          margin(margin),
+          trialLimits(start) {}
+
+    // Limits of the next trial
+    const MachineLimits &next() const { return trialLimits; }
+
+    // Result of the trial at next(), false if it lost steps or overloaded
+    void report(bool isReliable) {
+        if (phase == Phase::done) {
+            return;
+        }
+        trials++;
+
+        float &value = phase == Phase::speed
+                           ? trialLimits.maxSpeedMmPerSecond
+                           : trialLimits.maxAcceleration;
+        float top = phase == Phase::speed ? ceiling.maxSpeedMmPerSecond
+                                          : ceiling.maxAcceleration;
+
+        if (isReliable) {
+            reliable = value;
+        } else {
+            unreliable = value;
+        }
+
+        if (reliable == 0) {
+            // Not even the start of the search was reliable
+            phase = Phase::done;
+            isFound = false;
+            return;
+        }
+
+        if (unreliable == 0) {
+            if (reliable >= top) {
+                endPhase();
+                return;
+            }
+            value = std::fmin(value * stepFactor, top);
+            return;
+        }
+
+        if (bisections == refineSteps) {
+            endPhase();
+            return;
+        }
+        bisections++;
+        value = 0.5f * (reliable + unreliable);
+    }
+
+    bool isDone() const { return phase == Phase::done; }
+
+    // False if the search ended without reliable limits
+    bool hasResult() const { return isDone() && isFound; }
+
+    // margin of the highest reliable limits, once done
+    MachineLimits result() const {
+        MachineLimits limits;
+        limits.maxSpeedMmPerSecond = margin * found.maxSpeedMmPerSecond;
+        limits.maxAcceleration = margin * found.maxAcceleration;
+        return limits;
+    }
+
+    Phase getPhase() const { return phase; }
+    uint8_t getTrials() const { return trials; }
+
+  private:
+    void endPhase() {
+        if (phase == Phase::speed) {
+            // The acceleration search starts out from the fastest reliable
+            // trial, which ran at the start acceleration
+            found.maxSpeedMmPerSecond = reliable;
+            trialLimits.maxSpeedMmPerSecond = reliable;
+            phase = Phase::acceleration;
+            float acceleration = trialLimits.maxAcceleration;
+            if (acceleration >= ceiling.maxAcceleration) {
+                found.maxAcceleration = acceleration;
+                phase = Phase::done;
+                return;
+            }
+            reliable = acceleration;
+            unreliable = 0;
+            bisections = 0;
+            trialLimits.maxAcceleration =
+                std::fmin(acceleration * stepFactor, ceiling.maxAcceleration);
+            return;
+        }
+        found.maxAcceleration = reliable;
+        trialLimits.maxAcceleration = reliable;
+        phase = Phase::done;
+    }
+
+    MachineLimits ceiling;
+    float stepFactor;
+    uint8_t refineSteps;
+    float margin;
+
+    Phase phase = Phase::speed;
+    MachineLimits trialLimits;
+    MachineLimits found;
+    // Highest reliable and lowest unreliable value of this phase, 0 if none
+    float reliable = 0;
+    float unreliable = 0;
+    uint8_t bisections = 0;
+    bool isFound = true;
+    uint8_t trials = 0;
+};
+
+#endif  // OSSM_SOFTWARE_LIMITSEARCH_H
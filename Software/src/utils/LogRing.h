@@ -0,0 +1,92 @@
+#ifndef OSSM_SOFTWARE_LOGRING_H
+#define OSSM_SOFTWARE_LOGRING_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+/**
+ * Byte ring of variable length records, each a type byte and a payload.
+ *
+ * Producers copy a finished record in, one consumer takes them out in order.
+ * A record that doesn't fit is dropped and counted, records nobody took yet
+ * are never overwritten. Stored as [type][length:u16][payload].
+ *
+ * Not synchronized: producers on different tasks lock around push, the
+ * consumer around pop. Capacity must be a power of two.
+ */
+template <size_t Capacity>
+class LogRing {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0,
+                  "LogRing capacity must be a power of two");
+
+  public:
+    static constexpr size_t headerSize = 3;
+    static constexpr size_t maxPayload =
+        Capacity - headerSize < 0xFFFF ? Capacity - headerSize : 0xFFFF;
+
+    bool push(uint8_t type, const void *payload, size_t length) {
+        if (length > maxPayload || headerSize + length > free()) {
+            dropped++;
+            return false;
+        }
+
+        uint8_t header[headerSize] = {type, (uint8_t)(length & 0xFF),
+                                      (uint8_t)(length >> 8)};
+        write(header, headerSize);
+        write(payload, length);
+        return true;
+    }
+
+    // Takes the oldest record and returns its payload length, -1 if the ring
+    // is empty. Payload beyond max is dropped with the record.
+    int pop(uint8_t &type, void *payload, size_t max) {
+        if (head == tail) {
+            return -1;
+        }
+
+        uint8_t header[headerSize];
+        read(header, headerSize);
+        type = header[0];
+        size_t length = header[1] | (header[2] << 8);
+
+        size_t copied = length < max ? length : max;
+        read(payload, copied);
+        tail += length - copied;
+        return (int)copied;
+    }
+
+    bool empty() const { return head == tail; }
+
+    size_t used() const { return head - tail; }
+
+    size_t free() const { return Capacity - used(); }
+
+    // Records that didn't fit since the start
+    uint32_t getDroppedCount() const { return dropped; }
+
+  private:
+    void write(const void *data, size_t length) {
+        size_t start = head & (Capacity - 1);
+        size_t first = length < Capacity - start ? length : Capacity - start;
+        memcpy(bytes + start, data, first);
+        memcpy(bytes, (const uint8_t *)data + first, length - first);
+        head += length;
+    }
+
+    void read(void *data, size_t length) {
+        size_t start = tail & (Capacity - 1);
+        size_t first = length < Capacity - start ? length : Capacity - start;
+        memcpy(data, bytes + start, first);
+        memcpy((uint8_t *)data + first, bytes, length - first);
+        tail += length;
+    }
+
+    uint8_t bytes[Capacity] = {};
+    // Free running, wrapped into the ring on access
+    size_t head = 0;
+    size_t tail = 0;
+    uint32_t dropped = 0;
+};
+
+#endif  // OSSM_SOFTWARE_LOGRING_H
@@ -0,0 +1,99 @@
+#ifndef OSSM_SOFTWARE_MPSCRING_H
+#define OSSM_SOFTWARE_MPSCRING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Bounded multi-producer/single-consumer ring buffer.
+ *
+ * Every cell carries a sequence number: producers claim a cell by moving
+ * head with a compare and swap and publish it by advancing its sequence, so
+ * push never takes a lock and never waits for another producer. The consumer
+ * only writes tail. Items are copied in and out by value, a full ring
+ * rejects new items and counts them as overflows.
+ *
+ * A producer preempted between claiming and publishing its cell holds up
+ * the consumer at that cell until it runs again, pop reports the ring as
+ * empty meanwhile.
+ *
+ * Capacity must be a power of two.
+ */
+template <typename T, size_t Capacity>
+class MpscRing {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0,
+                  "MpscRing capacity must be a power of two");
+
+  public:
+    MpscRing() {
+        for (size_t i = 0; i < Capacity; i++) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    // Producer side, any number of them
+    bool push(const T &item) {
+        size_t head = this->head.load(std::memory_order_relaxed);
+        while (true) {
+            Cell &cell = cells[head & (Capacity - 1)];
+            size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            intptr_t lag = (intptr_t)sequence - (intptr_t)head;
+            if (lag == 0) {
+                if (this->head.compare_exchange_weak(
+                        head, head + 1, std::memory_order_relaxed)) {
+                    cell.item = item;
+                    cell.sequence.store(head + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (lag < 0) {
+                overflows.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            } else {
+                head = this->head.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Consumer side
+    bool pop(T &item) {
+        size_t tail = this->tail.load(std::memory_order_relaxed);
+        Cell &cell = cells[tail & (Capacity - 1)];
+        if (cell.sequence.load(std::memory_order_acquire) != tail + 1) {
+            return false;
+        }
+
+        item = cell.item;
+        cell.sequence.store(tail + Capacity, std::memory_order_release);
+        this->tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool empty() const { return size() == 0; }
+
+    // Claimed cells, including ones still being written
+    size_t size() const {
+        return head.load(std::memory_order_acquire) -
+               tail.load(std::memory_order_acquire);
+    }
+
+    static constexpr size_t capacity() { return Capacity; }
+
+    // Number of items rejected because the ring was full
+    uint32_t getOverflowCount() const {
+        return overflows.load(std::memory_order_relaxed);
+    }
+
+  private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T item = {};
+    };
+
+    Cell cells[Capacity];
+    std::atomic<size_t> head{0};
+    std::atomic<size_t> tail{0};
+    std::atomic<uint32_t> overflows{0};
+};
+
+#endif  // OSSM_SOFTWARE_MPSCRING_H
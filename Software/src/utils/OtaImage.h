@@ -0,0 +1,89 @@
+#ifndef OSSM_SOFTWARE_OTAIMAGE_H
+#define OSSM_SOFTWARE_OTAIMAGE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+/**
+ * Compressed firmware image, as written by support/compress_firmware.py.
+ * The firmware is cut into chunks of OTA_CHUNK_SIZE bytes that are zlib
+ * compressed one by one, so a download can resume at any chunk boundary
+ * with an HTTP Range request and each chunk inflates into a single buffer.
+ *
+ *   OtaImageHeader
+ *   uint32 offsets[chunkCount + 1]  file offset of every chunk and of the end
+ *   uint32 crcs[chunkCount]         CRC32 of every chunk after inflating
+ *   chunks
+ *
+ * All values are little endian.
+ */
+
+#define OTA_IMAGE_MAGIC "OSZ1"
+// Inflating needs the whole chunk in RAM, 32KiB is also the deflate window
+#define OTA_CHUNK_SIZE 32768
+// Enough for a 4MB app partition
+#define OTA_MAX_CHUNKS 128
+
+struct __attribute__((packed)) OtaImageHeader {
+    char magic[4];
+    uint32_t imageSize;   // Size of the firmware after inflating
+    uint32_t chunkSize;   // Always OTA_CHUNK_SIZE
+    uint32_t chunkCount;  // imageSize / chunkSize rounded up
+};
+
+static_assert(sizeof(OtaImageHeader) == 16, "OtaImageHeader must stay packed");
+
+// Bytes of the offset and CRC tables that follow the header
+inline size_t otaIndexSize(uint32_t chunkCount) {
+    return (2 * size_t(chunkCount) + 1) * sizeof(uint32_t);
+}
+
+inline bool isValidOtaHeader(const OtaImageHeader &header,
+                             size_t partitionSize) {
+    return memcmp(header.magic, OTA_IMAGE_MAGIC, 4) == 0 &&
+           header.chunkSize == OTA_CHUNK_SIZE && header.imageSize > 0 &&
+           header.imageSize <= partitionSize &&
+           header.chunkCount <= OTA_MAX_CHUNKS &&
+           header.chunkCount ==
+               (header.imageSize + OTA_CHUNK_SIZE - 1) / OTA_CHUNK_SIZE;
+}
+
+// Offsets must start right after the index, grow and chunks must fit into
+// the inflate buffer even if they didn't compress at all (plus zlib framing)
+inline bool isValidOtaIndex(const OtaImageHeader &header,
+                            const uint32_t *offsets) {
+    uint32_t first = sizeof(OtaImageHeader) + otaIndexSize(header.chunkCount);
+    if (offsets[0] != first) {
+        return false;
+    }
+    for (uint32_t i = 0; i < header.chunkCount; i++) {
+        if (offsets[i + 1] <= offsets[i] ||
+            offsets[i + 1] - offsets[i] > OTA_CHUNK_SIZE + 1024) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Size of a chunk after inflating, only the last one may be shorter
+inline uint32_t otaChunkLength(const OtaImageHeader &header, uint32_t chunk) {
+    uint32_t start = chunk * header.chunkSize;
+    uint32_t remaining = header.imageSize - start;
+    return remaining < header.chunkSize ? remaining : header.chunkSize;
+}
+
+// Chunk a download continues at. Progress only counts for the same image
+// (identified by the CRC of its header and index), going to the same
+// partition.
+inline uint32_t otaResumeChunk(uint32_t savedImage, uint32_t savedPartition,
+                               uint32_t savedChunk, uint32_t image,
+                               uint32_t partition, uint32_t chunkCount) {
+    if (savedImage != image || savedPartition != partition ||
+        savedChunk > chunkCount) {
+        return 0;
+    }
+    return savedChunk;
+}
+
+#endif  // OSSM_SOFTWARE_OTAIMAGE_H
@@ -0,0 +1,79 @@
+#ifndef OSSM_SOFTWARE_PACKBITS_H
+#define OSSM_SOFTWARE_PACKBITS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+/**
+ * An XBM image in flash, packed by support/pack_assets.py: every row XORed
+ * with the one above, then run length encoded with PackBits. Unpacked it is
+ * height rows of xbmRowBytes(width).
+ */
+struct PackedXbm {
+    uint8_t width;
+    uint8_t height;
+    uint16_t packedSize;
+    const uint8_t* data;
+};
+
+/**
+ * Unpacks PackBits: a header n of 0..127 is followed by n + 1 bytes taken
+ * as they are, one of 129..255 by a byte that repeats 257 - n times. 128 is
+ * skipped. Stops at the end of the input, or when out is full.
+ * @return number of bytes written
+ */
+inline size_t unpackBits(const uint8_t* packed, size_t packedSize,
+                         uint8_t* out, size_t outSize) {
+    size_t in = 0;
+    size_t written = 0;
+    while (in < packedSize && written < outSize) {
+        uint8_t header = packed[in++];
+        if (header < 128) {
+            size_t count = header + 1;
+            if (count > packedSize - in) {
+                count = packedSize - in;
+            }
+            if (count > outSize - written) {
+                count = outSize - written;
+            }
+            memcpy(out + written, packed + in, count);
+            in += count;
+            written += count;
+        } else if (header > 128 && in < packedSize) {
+            size_t count = 257 - header;
+            if (count > outSize - written) {
+                count = outSize - written;
+            }
+            memset(out + written, packed[in++], count);
+            written += count;
+        }
+    }
+    return written;
+}
+
+inline size_t xbmRowBytes(uint8_t width) { return (width + 7) / 8; }
+
+inline size_t xbmSize(const PackedXbm& image) {
+    return xbmRowBytes(image.width) * image.height;
+}
+
+/**
+ * Unpacks a PackedXbm into out, ready for drawXBM.
+ * @return false if out is too small or the data is short
+ */
+inline bool unpackXbm(const PackedXbm& image, uint8_t* out,
+                      size_t outSize) {
+    size_t size = xbmSize(image);
+    if (size > outSize ||
+        unpackBits(image.data, image.packedSize, out, size) != size) {
+        return false;
+    }
+    size_t rowBytes = xbmRowBytes(image.width);
+    for (size_t i = rowBytes; i < size; i++) {
+        out[i] ^= out[i - rowBytes];
+    }
+    return true;
+}
+
+#endif  // OSSM_SOFTWARE_PACKBITS_H
@@ -0,0 +1,33 @@
+#ifndef OSSM_SOFTWARE_PROFILESTATS_H
+#define OSSM_SOFTWARE_PROFILESTATS_H
+
+#include <cstdint>
+
+#include "structs/ProfileRecord.h"
+
+/**
+ * Count, min, mean and max of the cycles one probe took. Cheap enough to add
+ * to on every call of a hot path. Not thread safe, the profiler locks.
+ */
+struct ProfileStats {
+    uint32_t count = 0;
+    uint32_t minimum = UINT32_MAX;
+    uint32_t maximum = 0;
+    uint64_t total = 0;
+
+    void add(uint32_t cycles) {
+        count++;
+        total += cycles;
+        minimum = cycles < minimum ? cycles : minimum;
+        maximum = cycles > maximum ? cycles : maximum;
+    }
+
+    uint32_t mean() const { return count > 0 ? uint32_t(total / count) : 0; }
+
+    ProfileRecord toRecord(ProfileProbe probe) const {
+        return {(uint8_t)probe, count, count > 0 ? minimum : 0, mean(),
+                maximum};
+    }
+};
+
+#endif  // OSSM_SOFTWARE_PROFILESTATS_H
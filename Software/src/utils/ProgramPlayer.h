@@ -0,0 +1,208 @@
+#ifndef OSSM_SOFTWARE_PROGRAMPLAYER_H
+#define OSSM_SOFTWARE_PROGRAMPLAYER_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "structs/CommandValue.h"
+#include "utils/easing.h"
+
+#define PROGRAM_MAX_STEPS 128
+
+// How a parameter moves from its previous step to the next one
+enum class ProgramEasing : uint8_t {
+    jump,       // Holds the previous value, takes the new one at its time
+    linear,
+    inOutSine,  // As the fail-safe ramp
+};
+
+// A parameter reaches a value at a time of the program, easing over from
+// its previous step. Before its first step it keeps the value it had when
+// the program started. The pattern always jumps.
+struct ProgramStep {
+    uint32_t timeMs;
+    uint8_t parameter;  // SetValue
+    ProgramEasing easing;
+    uint16_t value;  // Hundredths of a percent, as the set values
+};
+
+/**
+ * Settings over time, a fixed list of steps ordered by time. Evaluating it
+ * doesn't keep any state, so values can be taken at any time of the program.
+ */
+class Program {
+  public:
+    void clear() {
+        count = 0;
+        mask = 0;
+    }
+
+    size_t size() const { return count; }
+
+    size_t available() const { return PROGRAM_MAX_STEPS - count; }
+
+    // False if the program is full, or the step doesn't come after the
+    // previous one or is out of range.
+    bool append(const ProgramStep& step) {
+        bool isValid =
+            step.parameter < setValueCount &&
+            step.easing <= ProgramEasing::inOutSine &&
+            step.value <= 100 * setValueScale &&
+            (step.parameter != setValuePattern ||
+             step.value % setValueScale == 0) &&
+            (count == 0 || step.timeMs >= steps[count - 1].timeMs);
+        if (!isValid || count == PROGRAM_MAX_STEPS) {
+            return false;
+        }
+        steps[count++] = step;
+        mask |= 1 << step.parameter;
+        return true;
+    }
+
+    // Time of the last step
+    uint32_t getDurationMs() const {
+        return count > 0 ? steps[count - 1].timeMs : 0;
+    }
+
+    // SetValue bits of the parameters the program sets
+    uint8_t getMask() const { return mask; }
+
+    // Values of the masked parameters at time ms, starting from the values
+    // in from. Other values are left alone.
+    void valuesAt(uint32_t ms, const int* from, int* values) const {
+        for (int parameter = 0; parameter < setValueCount; parameter++) {
+            if (mask & (1 << parameter)) {
+                values[parameter] = valueAt(parameter, ms, from[parameter]);
+            }
+        }
+    }
+
+  private:
+    int valueAt(int parameter, uint32_t ms, int from) const {
+        uint32_t previousMs = 0;
+        int previous = from;
+        for (size_t i = 0; i < count; i++) {
+            const ProgramStep& step = steps[i];
+            if (step.parameter != parameter) {
+                continue;
+            }
+            if (step.timeMs <= ms) {
+                previousMs = step.timeMs;
+                previous = step.value;
+                continue;
+            }
+
+            if (parameter == setValuePattern ||
+                step.easing == ProgramEasing::jump) {
+                return previous;
+            }
+            float progress =
+                float(ms - previousMs) / float(step.timeMs - previousMs);
+            Easing easing = step.easing == ProgramEasing::inOutSine
+                                ? Easing::inOutSine
+                                : Easing::linear;
+            return previous +
+                   int((step.value - previous) * ease(easing, progress) +
+                       (step.value > previous ? 0.5f : -0.5f));
+        }
+        return previous;
+    }
+
+    ProgramStep steps[PROGRAM_MAX_STEPS];
+    size_t count = 0;
+    uint8_t mask = 0;
+};
+
+enum class ProgramState : uint8_t { idle, playing, paused, finished };
+
+/**
+ * Plays a Program on the millis() clock: pausing stops its time, a looping
+ * program starts over from the values it ended with. Not thread safe, the
+ * caller locks.
+ */
+class ProgramPlayer {
+  public:
+    // Starts from the beginning, with the current settings as the values
+    // before the first steps
+    void play(uint32_t nowMs, bool isLooping, const int* current) {
+        state = ProgramState::playing;
+        origin = nowMs;
+        loops = 0;
+        this->isLooping = isLooping;
+        for (int i = 0; i < setValueCount; i++) {
+            from[i] = current[i];
+        }
+    }
+
+    void pause(uint32_t nowMs) {
+        if (state == ProgramState::playing) {
+            state = ProgramState::paused;
+            pausedMs = nowMs - origin;
+        }
+    }
+
+    void resume(uint32_t nowMs) {
+        if (state == ProgramState::paused) {
+            state = ProgramState::playing;
+            origin = nowMs - pausedMs;
+        }
+    }
+
+    void stop() { state = ProgramState::idle; }
+
+    ProgramState getState() const { return state; }
+
+    bool isActive() const {
+        return state == ProgramState::playing || state == ProgramState::paused;
+    }
+
+    // Playing without looping, so it comes to an end by itself
+    bool isPlayingOnce() const {
+        return state == ProgramState::playing && !isLooping;
+    }
+
+    // Time of the current pass through the program
+    uint32_t time(uint32_t nowMs) const {
+        if (state == ProgramState::paused) {
+            return pausedMs;
+        }
+        return state == ProgramState::playing ? nowMs - origin : 0;
+    }
+
+    // Passes completed by a looping program
+    uint32_t getLoops() const { return loops; }
+
+    // Values due now, false unless playing. A program that isn't looping
+    // finishes with the values of its last steps.
+    bool update(const Program& program, uint32_t nowMs, int* values) {
+        if (state != ProgramState::playing) {
+            return false;
+        }
+
+        uint32_t duration = program.getDurationMs();
+        uint32_t ms = nowMs - origin;
+        while (ms >= duration && isLooping && duration > 0) {
+            program.valuesAt(duration, from, from);
+            origin += duration;
+            ms -= duration;
+            loops++;
+        }
+        if (ms >= duration) {
+            ms = duration;
+            state = ProgramState::finished;
+        }
+
+        program.valuesAt(ms, from, values);
+        return true;
+    }
+
+  private:
+    ProgramState state = ProgramState::idle;
+    uint32_t origin = 0;
+    uint32_t pausedMs = 0;
+    uint32_t loops = 0;
+    bool isLooping = false;
+    int from[setValueCount] = {};
+};
+
+#endif  // OSSM_SOFTWARE_PROGRAMPLAYER_H
@@ -0,0 +1,35 @@
+#ifndef OSSM_SOFTWARE_RAILCALIBRATION_H
+#define OSSM_SOFTWARE_RAILCALIBRATION_H
+
+#include <cmath>
+
+/**
+ * What a full homing measured, kept in NVS so a later homing only has to
+ * confirm it. Positions are in steps from the homed zero, which sits
+ * backOffSteps in front of the rear end of the rail.
+ */
+struct RailCalibration {
+    float strokeSteps = 0;
+    float sensorOffset = 0;  // Idle current in percent
+
+    bool isValid(float minStrokeSteps, float maxStrokeSteps) const {
+        return std::isfinite(strokeSteps) && std::isfinite(sensorOffset) &&
+               strokeSteps > minStrokeSteps && strokeSteps <= maxStrokeSteps &&
+               sensorOffset >= 0 && sensorOffset <= 100;
+    }
+};
+
+// The idle current must not have moved much, a different reading hints at a
+// changed setup.
+inline bool isSensorOffsetConfirmed(const RailCalibration &calibration,
+                                    float sensorOffset, float tolerance) {
+    return std::fabs(sensorOffset - calibration.sensorOffset) <= tolerance;
+}
+
+// The touch-off has to find the rear end where the homed zero puts it.
+inline bool isTouchOffConfirmed(float stallPosition, float backOffSteps,
+                                float toleranceSteps) {
+    return std::fabs(stallPosition - backOffSteps) <= toleranceSteps;
+}
+
+#endif  // OSSM_SOFTWARE_RAILCALIBRATION_H
@@ -6,11 +6,15 @@
 
 #include <boost/sml.hpp>
 
+#include "services/profiler.h"
+
 /**
  * @brief ESP32RecursiveMutex class provides a recursive mutex functionality
  * using FreeRTOS primitives. It mimics the behavior of std::recursive_mutex.
  *
- * This is primarily used to make the OSSMState machine thread safe.
+ * This is primarily used to make the OSSMState machine thread safe. SML
+ * holds it for every process_event, so with OSSM_PROFILE the time from
+ * taking it to giving it back is profiled as ProfileProbe::processEvent.
  */
 class ESP32RecursiveMutex {
   public:
@@ -22,15 +26,33 @@ class ESP32RecursiveMutex {
 
     // Locks the mutex. If the mutex is already locked by the same task,
     // the function will return immediately instead of blocking.
-    void lock() { xSemaphoreTakeRecursive(mutex, portMAX_DELAY); }
+    void lock() {
+        xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+        taken();
+    }
 
     // Unlocks the mutex.
-    void unlock() { xSemaphoreGiveRecursive(mutex); }
+    void unlock() {
+#if OSSM_PROFILE
+        // Only the holder gets here, events sent from actions are nested
+        if (--depth == 0) {
+            recordProfile(ProfileProbe::processEvent,
+                          esp_cpu_get_cycle_count() - takenAt);
+        }
+#endif
+        xSemaphoreGiveRecursive(mutex);
+    }
 
     // Tries to lock the mutex. If the mutex is not available, the function
     // will return immediately with 'false'. If the mutex is available,
     // the function will lock the mutex and return 'true'.
-    bool try_lock() { return xSemaphoreTakeRecursive(mutex, 0) == pdTRUE; }
+    bool try_lock() {
+        if (xSemaphoreTakeRecursive(mutex, 0) != pdTRUE) {
+            return false;
+        }
+        taken();
+        return true;
+    }
 
     // Copy constructor and copy assignment operator are deleted
     // to prevent copying of ESP32RecursiveMutex objects.
@@ -40,5 +62,19 @@ class ESP32RecursiveMutex {
   private:
     // Handle for the recursive mutex
     SemaphoreHandle_t mutex;
+
+#if OSSM_PROFILE
+    // Nesting of the holder and when it took the mutex
+    int depth = 0;
+    uint32_t takenAt = 0;
+#endif
+
+    void taken() {
+#if OSSM_PROFILE
+        if (depth++ == 0) {
+            takenAt = esp_cpu_get_cycle_count();
+        }
+#endif
+    }
 };
 #endif  // OSSM_SOFTWARE_RECURSIVEMUTEX_H
\ No newline at end of file
@@ -0,0 +1,73 @@
+#ifndef OSSM_SOFTWARE_SEQLOCK_H
+#define OSSM_SOFTWARE_SEQLOCK_H
+
+#include <atomic>
+#include <cstdint>
+
+/**
+ * Sequence lock around a small trivially copyable struct.
+ *
+ * The writer bumps the sequence to an odd number, changes the value and
+ * bumps it to the next even number. Readers copy the value and retry if the
+ * sequence was odd or moved while copying, so every load returns fields that
+ * were published together. Readers never block the writer.
+ *
+ * Only one writer may be active at a time, callers that write from several
+ * tasks must serialize write() themselves. Keep writes short: a reader
+ * spins while a write is in progress.
+ */
+template <typename T>
+class Seqlock {
+  public:
+    explicit Seqlock(const T &initial = T{}) : value(initial) {}
+
+    // Writer side. update receives the value by reference and may change any
+    // field, readers see all changes at once.
+    template <typename Update>
+    void write(Update update) {
+        uint32_t sequence = this->sequence.load(std::memory_order_relaxed);
+        this->sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        update(value);
+
+        this->sequence.store(sequence + 2, std::memory_order_release);
+    }
+
+    // Consistent copy of the value. If version is given it receives the
+    // version the copy belongs to.
+    T load(uint32_t *version = nullptr) const {
+        T copy;
+        uint32_t before;
+        uint32_t after;
+        do {
+            before = sequence.load(std::memory_order_acquire);
+            if (before & 1) {
+                continue;
+            }
+            copy = value;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            after = sequence.load(std::memory_order_relaxed);
+            if (before == after) {
+                break;
+            }
+        } while (true);
+
+        if (version != nullptr) {
+            *version = before;
+        }
+        return copy;
+    }
+
+    // Version of the last completed write. Comparing it with the version of
+    // an earlier load() tells whether anything changed since.
+    uint32_t getVersion() const {
+        return sequence.load(std::memory_order_acquire) & ~1u;
+    }
+
+  private:
+    T value;
+    std::atomic<uint32_t> sequence{0};
+};
+
+#endif  // OSSM_SOFTWARE_SEQLOCK_H
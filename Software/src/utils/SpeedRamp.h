@@ -0,0 +1,52 @@
+#ifndef OSSM_SOFTWARE_SPEEDRAMP_H
+#define OSSM_SOFTWARE_SPEEDRAMP_H
+
+#include <cstdint>
+
+#include "utils/easing.h"
+
+/**
+ * A speed transition the motion tasks follow on their own, e.g. the fail-safe
+ * slow down after the BLE connection is lost. It only describes the ramp,
+ * at(now) evaluates it, so it can be published through a Seqlock and every
+ * reader computes the same speed for the same time.
+ *
+ * A default constructed ramp is never active.
+ */
+class SpeedRamp {
+  public:
+    SpeedRamp() = default;
+
+    SpeedRamp(float from, float to, uint32_t startMs, uint32_t durationMs,
+              Easing easing = Easing::inOutSine)
+        : from(from),
+          to(to),
+          startMs(startMs),
+          durationMs(durationMs),
+          easing(easing) {}
+
+    // Unsigned differences keep this right across a wrap of millis()
+    bool isActive(uint32_t now) const {
+        return durationMs > 0 && now - startMs < durationMs;
+    }
+
+    // Speed at now, the target once the ramp is over
+    float at(uint32_t now) const {
+        if (!isActive(now)) {
+            return to;
+        }
+        float progress = float(now - startMs) / float(durationMs);
+        return from + (to - from) * ease(easing, progress);
+    }
+
+    float getTarget() const { return to; }
+
+  private:
+    float from = 0;
+    float to = 0;
+    uint32_t startMs = 0;
+    uint32_t durationMs = 0;
+    Easing easing = Easing::linear;
+};
+
+#endif  // OSSM_SOFTWARE_SPEEDRAMP_H
@@ -0,0 +1,72 @@
+#ifndef OSSM_SOFTWARE_SPSCRING_H
+#define OSSM_SOFTWARE_SPSCRING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Bounded single-producer/single-consumer ring buffer.
+ *
+ * The producer only writes head, the consumer only writes tail, so push and
+ * pop are wait-free and never allocate. Items are copied in and out by value.
+ * A full ring rejects new items and counts them as overflows.
+ *
+ * Capacity must be a power of two.
+ */
+template <typename T, size_t Capacity>
+class SpscRing {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0,
+                  "SpscRing capacity must be a power of two");
+
+  public:
+    // Producer side
+    bool push(const T &item) {
+        size_t head = this->head.load(std::memory_order_relaxed);
+        if (head - tail.load(std::memory_order_acquire) == Capacity) {
+            overflows.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        items[head & (Capacity - 1)] = item;
+        this->head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side
+    bool pop(T &item) {
+        size_t tail = this->tail.load(std::memory_order_relaxed);
+        if (head.load(std::memory_order_acquire) == tail) {
+            return false;
+        }
+
+        item = items[tail & (Capacity - 1)];
+        this->tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool empty() const {
+        return head.load(std::memory_order_acquire) ==
+               tail.load(std::memory_order_acquire);
+    }
+
+    size_t size() const {
+        return head.load(std::memory_order_acquire) -
+               tail.load(std::memory_order_acquire);
+    }
+
+    static constexpr size_t capacity() { return Capacity; }
+
+    // Number of items rejected because the ring was full
+    uint32_t getOverflowCount() const {
+        return overflows.load(std::memory_order_relaxed);
+    }
+
+  private:
+    T items[Capacity] = {};
+    std::atomic<size_t> head{0};
+    std::atomic<size_t> tail{0};
+    std::atomic<uint32_t> overflows{0};
+};
+
+#endif  // OSSM_SOFTWARE_SPSCRING_H
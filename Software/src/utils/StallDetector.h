@@ -0,0 +1,80 @@
+#ifndef OSSM_SOFTWARE_STALLDETECTOR_H
+#define OSSM_SOFTWARE_STALLDETECTOR_H
+
+#include <atomic>
+#include <cstddef>
+
+/**
+ * Detects the hard stop during sensorless homing from a stream of current
+ * samples (in percent, offset already removed).
+ *
+ * Two windows of Window samples are compared. A stall is reported when the
+ * mean of the newest window exceeds the absolute limit, or when it rises by
+ * more than stepThreshold over the previous window while already above half
+ * the limit. The first blankingSamples after a reset are ignored to skip the
+ * current spike of accelerating from standstill.
+ *
+ * update() is called from the sampling task, hasStalled() from anywhere.
+ */
+template <size_t Window = 8>
+class StallDetector {
+  public:
+    StallDetector(float limit, float stepThreshold, size_t blankingSamples)
+        : limit(limit),
+          stepThreshold(stepThreshold),
+          blankingSamples(blankingSamples) {}
+
+    void reset() {
+        count = 0;
+        next = 0;
+        stalled.store(false);
+    }
+
+    // Returns true once a stall has been detected.
+    bool update(float sample) {
+        samples[next] = sample;
+        next = (next + 1) % (2 * Window);
+        count++;
+
+        if (count < blankingSamples || count < 2 * Window) {
+            return stalled.load();
+        }
+
+        float newest = 0;
+        float previous = 0;
+        for (size_t i = 0; i < Window; i++) {
+            newest += samples[(next + 2 * Window - 1 - i) % (2 * Window)];
+            previous += samples[(next + Window - 1 - i) % (2 * Window)];
+        }
+        newest /= Window;
+        previous /= Window;
+
+        bool overLimit = newest > limit;
+        bool stepChange =
+            newest - previous > stepThreshold && newest > 0.5f * limit;
+
+        if (overLimit || stepChange) {
+            lastMean = newest;
+            stalled.store(true);
+        }
+        return stalled.load();
+    }
+
+    bool hasStalled() const { return stalled.load(); }
+
+    // Mean current of the window that triggered the stall
+    float getStallCurrent() const { return lastMean; }
+
+  private:
+    float limit;
+    float stepThreshold;
+    size_t blankingSamples;
+
+    float samples[2 * Window] = {};
+    size_t count = 0;
+    size_t next = 0;
+    float lastMean = 0;
+    std::atomic<bool> stalled{false};
+};
+
+#endif  // OSSM_SOFTWARE_STALLDETECTOR_H
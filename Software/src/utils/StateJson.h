@@ -0,0 +1,39 @@
+#ifndef OSSM_SOFTWARE_STATEJSON_H
+#define OSSM_SOFTWARE_STATEJSON_H
+
+#include <cstdio>
+
+#include "structs/LinkStatus.h"
+#include "structs/SettingPercents.h"
+
+// Writes the JSON sent on the state characteristic into buffer and returns
+// the length. The "link" object is left out without a connection (nullptr).
+// Truncated if the buffer is too small, 160 bytes always fit.
+inline size_t formatStateJson(char *buffer, size_t size, const char *state,
+                              const SettingPercents &setting,
+                              const LinkStatus *link) {
+    int length = snprintf(
+        buffer, size,
+        "{\"state\":\"%s\",\"speed\":%d,\"stroke\":%d,\"sensation\":%d,"
+        "\"depth\":%d,\"pattern\":%d",
+        state, (int)setting.speed, (int)setting.stroke, (int)setting.sensation,
+        (int)setting.depth, static_cast<int>(setting.pattern));
+
+    if (link != nullptr && length > 0 && (size_t)length < size) {
+        length += snprintf(buffer + length, size - length,
+                           ",\"link\":{\"interval\":%.2f,\"latency\":%u,"
+                           "\"mtu\":%u,\"phy\":%u}",
+                           link->interval * 1.25f, link->latency, link->mtu,
+                           link->phy);
+    }
+    if (length > 0 && (size_t)length < size) {
+        length += snprintf(buffer + length, size - length, "}");
+    }
+
+    if (length <= 0) {
+        return 0;
+    }
+    return (size_t)length < size ? (size_t)length : size - 1;
+}
+
+#endif  // OSSM_SOFTWARE_STATEJSON_H
@@ -5,12 +5,93 @@
 
 #include <cassert>
 
+#include <cstring>
+
 #include "boost/sml.hpp"
 #include "constants/LogTags.h"
+#include "ossm/Events.h"
+#include "ossm/States.h"
+#include "services/communication/events.h"
+#include "services/netlog.h"
+#include "structs/StateTraceRecord.h"
+#include "utils/TraceRing.h"
 
 namespace sml = boost::sml;
 using namespace sml;
 
+/**
+ * State trace: a RAM ring of the newest state machine events, guard results
+ * and state changes. Recording is a few stores under a spinlock, so it stays
+ * on in production. Build with -DOSSM_STATE_TRACE=0 to compile it out.
+ */
+#ifndef OSSM_STATE_TRACE
+#define OSSM_STATE_TRACE 1
+#endif
+
+#define STATE_TRACE_LENGTH 64
+
+#if OSSM_STATE_TRACE
+extern TraceRing<StateTraceRecord, STATE_TRACE_LENGTH> stateTrace;
+extern portMUX_TYPE stateTraceLock;
+#endif
+
+inline void traceState(StateTraceKind kind, EventId event, StateId src,
+                       StateId dst = StateId::unknown) {
+#if OSSM_STATE_TRACE
+    StateTraceRecord record = {(uint32_t)millis(), kind, (uint8_t)event,
+                               (uint8_t)src, (uint8_t)dst};
+    portENTER_CRITICAL(&stateTraceLock);
+    stateTrace.record(record);
+    portEXIT_CRITICAL(&stateTraceLock);
+#if OSSM_NET_LOG
+    netLogRecord(NetLogRecord::stateTrace, &record, sizeof(record));
+#endif
+#endif
+}
+
+// Copies up to max of the newest records, oldest first.
+inline size_t copyStateTrace(StateTraceRecord* out, size_t max) {
+#if OSSM_STATE_TRACE
+    portENTER_CRITICAL(&stateTraceLock);
+    size_t count = stateTrace.copyLatest(out, max);
+    portEXIT_CRITICAL(&stateTraceLock);
+    return count;
+#else
+    return 0;
+#endif
+}
+
+// Prints the trace to the serial log, oldest first.
+inline void dumpStateTrace() {
+    static const char* const kindNames[] = {"event", "pass", "fail", "state"};
+    StateTraceRecord records[STATE_TRACE_LENGTH];
+    size_t count = copyStateTrace(records, STATE_TRACE_LENGTH);
+
+    ESP_LOGI(STATE_MACHINE_TAG, "State trace, %u records:", (unsigned)count);
+    for (size_t i = 0; i < count; i++) {
+        const StateTraceRecord& record = records[i];
+        ESP_LOGI(STATE_MACHINE_TAG, "%10lu %-5s event %3u %s -> %s",
+                 (unsigned long)record.timeMs, kindNames[(int)record.kind],
+                 record.event, stateName((StateId)record.src),
+                 stateName((StateId)record.dst));
+    }
+}
+
+// Maps a logged SML state to its StateId at compile time. States that aren't
+// named strings (like X) map to StateId::unknown.
+template <class TState>
+struct StateIdOf {
+    static constexpr StateId value = StateId::unknown;
+};
+
+template <char... Chrs>
+struct StateIdOf<sml::aux::string<sml::aux::string<char, Chrs...>>> {
+    static constexpr char name[] = {Chrs..., 0};
+    static constexpr StateId value = stateIdFromName(name);
+    static_assert(value != StateId::unknown,
+                  "State is missing from StateId in ossm/States.h");
+};
+
 /**
  * @brief Logs state machine events for the OSSM class.
  *
@@ -23,20 +104,33 @@ using namespace sml;
 struct StateLogger {
     template <class SM, class TEvent>
     [[gnu::used]] void log_process_event(const TEvent&) {
+        constexpr EventId event = EventIdOf<TEvent>::value;
+        if (event != EventId::internal) {
+            lastEvent = event;
+            traceState(StateTraceKind::event, event, getStateId());
+        }
+
         ESP_LOGV(STATE_MACHINE_TAG, "%s", sml::aux::get_type_name<SM>());
-        String eventName = String(sml::aux::get_type_name<TEvent>());
+        const char* eventName = sml::aux::get_type_name<TEvent>();
         // if the event name starts with " boost::ext::sml" then only TRACE it
         // to reduce verbosity
-        if (eventName.startsWith("boost::ext::sml")) {
-            ESP_LOGV(STATE_MACHINE_TAG, "%s", eventName.c_str());
+        if (strncmp(eventName, "boost::ext::sml", 15) == 0) {
+            ESP_LOGV(STATE_MACHINE_TAG, "%s", eventName);
         } else {
-            ESP_LOGD(STATE_MACHINE_TAG, "%s", eventName.c_str());
+            ESP_LOGD(STATE_MACHINE_TAG, "%s", eventName);
         }
     }
 
     template <class SM, class TGuard, class TEvent>
     [[gnu::used]] void log_guard(const TGuard&, const TEvent&, bool result) {
-        String resultString = result ? "[PASS]" : "[DO NOT PASS]";
+        constexpr EventId event = EventIdOf<TEvent>::value;
+        if (event != EventId::internal) {
+            traceState(result ? StateTraceKind::guardPassed
+                              : StateTraceKind::guardFailed,
+                       event, getStateId());
+        }
+
+        const char* resultString = result ? "[PASS]" : "[DO NOT PASS]";
         ESP_LOGV(STATE_MACHINE_TAG, "%s: %s", resultString,
                  sml::aux::get_type_name<SM>());
         ESP_LOGD(STATE_MACHINE_TAG, "%s: %s, %s", resultString,
@@ -54,6 +148,16 @@ struct StateLogger {
                                         const TDstState& dst) {
         ESP_LOGV(STATE_MACHINE_TAG, "%s", sml::aux::get_type_name<SM>());
         ESP_LOGD(STATE_MACHINE_TAG, "%s -> %s", src.c_str(), dst.c_str());
+        constexpr StateId id = StateIdOf<TDstState>::value;
+        traceState(StateTraceKind::stateChange, lastEvent,
+                   StateIdOf<TSrcState>::value, id);
+        currentStateId.store(id, std::memory_order_relaxed);
+        currentModeId.store(modeOf(id), std::memory_order_relaxed);
+        signalNimble(NimbleEvents::stateChange);
     }
+
+  private:
+    // The event that caused the next state change
+    EventId lastEvent = EventId::internal;
 };
 #endif  // OSSM_SOFTWARE_STATELOGGER_H
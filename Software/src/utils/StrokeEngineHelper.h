@@ -5,6 +5,7 @@
 #include "../../lib/StrokeEngine/src/StrokeEngine.h"
 #include "constants/Config.h"
 #include "constants/Pins.h"
+#include "utils/LimitSearch.h"
 
 /*#################################################################################################
 ##
@@ -29,6 +30,14 @@ static motorProperties servoMotor{
     .directionPin = Pins::Driver::motorDirectionPin,
     .enablePin = Pins::Driver::motorEnablePin};
 
+// Hands the limits of this machine to servoMotor, before Stroker.begin()
+static void applyMachineLimits(const MachineLimits &limits) {
+    servoMotor.maxSpeed =
+        60 * (limits.maxSpeedMmPerSecond /
+              (Config::Driver::pulleyToothCount * Config::Driver::beltPitchMm));
+    servoMotor.maxAcceleration = limits.maxAcceleration;
+}
+
 static bool isChangeSignificant(float oldPct, float newPct) {
     return oldPct != newPct &&
            (abs(newPct - oldPct) > 2 || newPct == 0 || newPct == 100);
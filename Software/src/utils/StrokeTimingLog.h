@@ -0,0 +1,56 @@
+#ifndef OSSM_SOFTWARE_STROKETIMINGLOG_H
+#define OSSM_SOFTWARE_STROKETIMINGLOG_H
+
+#include <Arduino.h>
+
+#include <cstdio>
+
+#include "StrokeEngine.h"
+#include "constants/LogTags.h"
+#include "services/stepper.h"
+
+// Prints one histogram as "name: count min/mean/max unit | buckets...".
+template <uint32_t Offset, uint32_t Width>
+inline void logTimingHistogram(const char* name, const char* unit,
+                               const TimingHistogram<Offset, Width>& histogram) {
+    char buckets[TIMING_BUCKETS * 6 + 1];
+    size_t length = 0;
+    for (int i = 0; i < TIMING_BUCKETS; i++) {
+        length += snprintf(buckets + length, sizeof(buckets) - length, " %u",
+                           (unsigned)histogram.buckets[i]);
+    }
+
+    ESP_LOGI(STROKE_TIMING_TAG,
+             "%-8s %6lu  min %lu  mean %lu  max %lu %s, from %lu by %lu |%s",
+             name, (unsigned long)histogram.count,
+             (unsigned long)(histogram.count > 0 ? histogram.minimum : 0),
+             (unsigned long)histogram.mean(), (unsigned long)histogram.maximum,
+             unit, (unsigned long)Offset, (unsigned long)Width, buckets);
+}
+
+// Prints the stroke timing and clipping statistics of the current session to
+// the serial log.
+inline void dumpStrokeTiming() {
+    StrokeTiming timing;
+    Stroker.getTiming(&timing);
+
+    ESP_LOGI(STROKE_TIMING_TAG, "Stroke timing, session of %lu ms:",
+             (unsigned long)timing.sessionMs);
+    logTimingHistogram("reversal", "us", timing.reversal);
+    logTimingHistogram("period", "%", timing.period);
+    logTimingHistogram("latency", "us", timing.latency);
+
+    ClipCounters clipping;
+    Stroker.getClipping(&clipping);
+    ESP_LOGI(STROKE_TIMING_TAG,
+             "clipping speed %lu  accel %lu  stretched %lu  retarget %lu  "
+             "rejected %lu  not traced %lu",
+             (unsigned long)clipping.events[CLIP_SPEED],
+             (unsigned long)clipping.events[CLIP_ACCELERATION],
+             (unsigned long)clipping.events[CLIP_DURATION],
+             (unsigned long)clipping.events[CLIP_RETARGET],
+             (unsigned long)clipping.events[CLIP_REJECTED],
+             (unsigned long)clipping.dropped);
+}
+
+#endif  // OSSM_SOFTWARE_STROKETIMINGLOG_H
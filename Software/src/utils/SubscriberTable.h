@@ -0,0 +1,91 @@
+#ifndef OSSM_SOFTWARE_SUBSCRIBERTABLE_H
+#define OSSM_SOFTWARE_SUBSCRIBERTABLE_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Subscribers of a notifying characteristic and the version of the value
+ * each of them has seen. Subscribers that are behind (typically because
+ * they just subscribed) are caught up one by one, everyone else only gets
+ * the notifications of actual changes.
+ *
+ * Not thread safe, guard it if subscriptions change on another task.
+ */
+template <size_t Capacity>
+class SubscriberTable {
+  public:
+    // A new subscriber hasn't seen any version yet
+    void subscribe(uint16_t conn) {
+        Entry* entry = find(conn);
+        if (entry == nullptr) {
+            entry = find(noConnection);
+        }
+        if (entry != nullptr) {
+            entry->conn = conn;
+            entry->isBehind = true;
+        }
+    }
+
+    void unsubscribe(uint16_t conn) {
+        Entry* entry = find(conn);
+        if (entry != nullptr) {
+            entry->conn = noConnection;
+        }
+    }
+
+    // Everyone subscribed right now receives the broadcast of version
+    void markAllSent(uint32_t version) {
+        for (Entry& entry : entries) {
+            entry.sent = version;
+            entry.isBehind = false;
+        }
+    }
+
+    // Calls send(conn) for every subscriber that hasn't seen version and
+    // marks it as sent. Returns the number of calls.
+    template <typename Send>
+    size_t catchUp(uint32_t version, Send send) {
+        size_t sent = 0;
+        for (Entry& entry : entries) {
+            if (entry.conn != noConnection &&
+                (entry.isBehind || entry.sent != version)) {
+                send(entry.conn);
+                entry.sent = version;
+                entry.isBehind = false;
+                sent++;
+            }
+        }
+        return sent;
+    }
+
+    size_t count() const {
+        size_t count = 0;
+        for (const Entry& entry : entries) {
+            count += entry.conn != noConnection;
+        }
+        return count;
+    }
+
+  private:
+    static constexpr uint16_t noConnection = 0xFFFF;
+
+    struct Entry {
+        uint16_t conn = noConnection;
+        uint32_t sent = 0;
+        bool isBehind = false;
+    };
+
+    Entry entries[Capacity];
+
+    Entry* find(uint16_t conn) {
+        for (Entry& entry : entries) {
+            if (entry.conn == conn) {
+                return &entry;
+            }
+        }
+        return nullptr;
+    }
+};
+
+#endif  // OSSM_SOFTWARE_SUBSCRIBERTABLE_H
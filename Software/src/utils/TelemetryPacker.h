@@ -0,0 +1,106 @@
+#ifndef OSSM_SOFTWARE_TELEMETRYPACKER_H
+#define OSSM_SOFTWARE_TELEMETRYPACKER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "structs/TelemetrySample.h"
+
+/**
+ * Packs telemetry samples into one notification, see BLE_Protocol.md.
+ *
+ * The first sample is sent in full in the header, every further sample as
+ * int16 deltas of position and velocity to the one before, followed by one
+ * clipping bit per sample. A sample that doesn't fit, or whose deltas don't
+ * fit an int16, is rejected and starts the next packet.
+ *
+ * Layout (little endian, as the ESP32 stores it):
+ *   0  uint16 sequence     4  uint32 time of the first sample
+ *   2  uint8  count        8  int32  position of the first sample
+ *   3  uint8  intervalMs  12  int32  velocity of the first sample
+ *  16  int16[2] deltas per further sample, then uint8[(count + 7) / 8] bits
+ */
+template <size_t MaxBytes>
+class TelemetryPacker {
+  public:
+    static constexpr size_t headerSize = 16;
+    static constexpr size_t deltaSize = 4;
+
+    // Starts a new packet of at most limit bytes, e.g. MTU - 3.
+    void begin(uint16_t sequence, uint8_t intervalMs, size_t limit) {
+        this->limit = limit < MaxBytes ? limit : MaxBytes;
+        count = 0;
+        memcpy(buffer, &sequence, sizeof(sequence));
+        buffer[3] = intervalMs;
+    }
+
+    bool add(const TelemetrySample &sample) {
+        if (count == 0) {
+            if (limit < headerSize + 1) {
+                return false;
+            }
+            memcpy(buffer + 4, &sample.timeMs, sizeof(sample.timeMs));
+            memcpy(buffer + 8, &sample.position, sizeof(sample.position));
+            memcpy(buffer + 12, &sample.velocity, sizeof(sample.velocity));
+        } else {
+            if (count == UINT8_MAX || sizeFor(count + 1) > limit) {
+                return false;
+            }
+            int32_t position = sample.position - last.position;
+            int32_t velocity = sample.velocity - last.velocity;
+            if (!fitsInt16(position) || !fitsInt16(velocity)) {
+                return false;
+            }
+
+            int16_t deltas[2] = {(int16_t)position, (int16_t)velocity};
+            memcpy(buffer + headerSize + (count - 1) * deltaSize, deltas,
+                   deltaSize);
+        }
+
+        clipping[count / 8] = (count % 8 == 0 ? 0 : clipping[count / 8]) |
+                              (sample.clipping ? 1 << (count % 8) : 0);
+        last = sample;
+        count++;
+        return true;
+    }
+
+    // Appends the clipping bits, returns the length of the packet.
+    size_t finish() {
+        buffer[2] = (uint8_t)count;
+        size_t length = headerSize + (count > 0 ? (count - 1) * deltaSize : 0);
+        memcpy(buffer + length, clipping, bitBytes(count));
+        return length + bitBytes(count);
+    }
+
+    const uint8_t *data() const { return buffer; }
+    size_t size() const { return count; }
+
+    // Number of samples a packet of limit bytes holds.
+    static size_t capacity(size_t limit) {
+        size_t samples = 0;
+        while (samples < UINT8_MAX && sizeFor(samples + 1) <= limit) {
+            samples++;
+        }
+        return samples;
+    }
+
+  private:
+    static size_t bitBytes(size_t samples) { return (samples + 7) / 8; }
+
+    static size_t sizeFor(size_t samples) {
+        return headerSize + (samples - 1) * deltaSize + bitBytes(samples);
+    }
+
+    static bool fitsInt16(int32_t value) {
+        return value >= INT16_MIN && value <= INT16_MAX;
+    }
+
+    uint8_t buffer[MaxBytes] = {};
+    uint8_t clipping[(MaxBytes + 7) / 8] = {};
+    size_t limit = MaxBytes;
+    size_t count = 0;
+    TelemetrySample last = {};
+};
+
+#endif  // OSSM_SOFTWARE_TELEMETRYPACKER_H
@@ -0,0 +1,67 @@
+#ifndef OSSM_SOFTWARE_TRACERING_H
+#define OSSM_SOFTWARE_TRACERING_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Fixed size ring of trace records that always keeps the newest entries.
+ *
+ * Recording is a copy and an increment, it never allocates or formats. The
+ * ring is not synchronized, callers that record and read from different tasks
+ * have to lock around it.
+ *
+ * Capacity must be a power of two.
+ */
+template <typename T, size_t Capacity>
+class TraceRing {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0,
+                  "TraceRing capacity must be a power of two");
+
+  public:
+    void record(const T &item) {
+        items[recorded & (Capacity - 1)] = item;
+        recorded++;
+    }
+
+    // Copies up to max of the newest records into out, oldest first.
+    size_t copyLatest(T *out, size_t max) const {
+        size_t count = size() < max ? size() : max;
+        uint32_t first = recorded - count;
+
+        for (size_t i = 0; i < count; i++) {
+            out[i] = items[(first + i) & (Capacity - 1)];
+        }
+        return count;
+    }
+
+    // Copies up to max records starting at index first of the ones held,
+    // 0 being the oldest.
+    size_t copyFrom(size_t first, T *out, size_t max) const {
+        if (first >= size()) {
+            return 0;
+        }
+        size_t count = size() - first < max ? size() - first : max;
+        uint32_t start = recorded - size() + first;
+
+        for (size_t i = 0; i < count; i++) {
+            out[i] = items[(start + i) & (Capacity - 1)];
+        }
+        return count;
+    }
+
+    size_t size() const { return recorded < Capacity ? recorded : Capacity; }
+
+    static constexpr size_t capacity() { return Capacity; }
+
+    // Total number of records, including the ones that were overwritten
+    uint32_t getRecordedCount() const { return recorded; }
+
+    void clear() { recorded = 0; }
+
+  private:
+    T items[Capacity] = {};
+    uint32_t recorded = 0;
+};
+
+#endif  // OSSM_SOFTWARE_TRACERING_H
@@ -0,0 +1,30 @@
+#ifndef OSSM_SOFTWARE_XBM_H
+#define OSSM_SOFTWARE_XBM_H
+
+#include <cstdint>
+#include <cstring>
+
+// Bytes per row of an XBM image
+constexpr int xbmRowBytes(int width) { return (width + 7) / 8; }
+
+/**
+ * Copies width x height pixels from the top left of a U8G2 page buffer into
+ * an XBM image. Page buffers are rows of 8 pixel high tiles, each byte is a
+ * column of a tile with the top pixel in the lowest bit. XBM images have
+ * bytes along the rows with the leftmost pixel in the lowest bit.
+ */
+inline void pageToXbm(const uint8_t* page, int pageWidth, int width,
+                      int height, uint8_t* xbm) {
+    memset(xbm, 0, xbmRowBytes(width) * height);
+    for (int y = 0; y < height; y++) {
+        const uint8_t* tileRow = page + (y / 8) * pageWidth;
+        uint8_t* row = xbm + y * xbmRowBytes(width);
+        for (int x = 0; x < width; x++) {
+            if (tileRow[x] & (1 << (y % 8))) {
+                row[x / 8] |= 1 << (x % 8);
+            }
+        }
+    }
+}
+
+#endif  // OSSM_SOFTWARE_XBM_H
@@ -2,6 +2,7 @@
 #define OSSM_SOFTWARE_ANALOG_H
 
 #include "Arduino.h"
+#include "services/profiler.h"
 
 typedef struct {
     int pinNumber;
@@ -10,6 +11,7 @@ typedef struct {
 
 // public static function to get the analog value of a pin
 static float getAnalogAveragePercent(SampleOnPin sampleOnPin) {
+    OSSM_PROFILE_SCOPE(analogSample);
     int sum = 0;
     float average;
     float percentage;
@@ -0,0 +1,29 @@
+#ifndef OSSM_SOFTWARE_EASING_H
+#define OSSM_SOFTWARE_EASING_H
+
+#include <cmath>
+
+// Easing curves map the progress of a transition (0 to 1) to the share of
+// the change applied so far (0 to 1).
+enum class Easing {
+    linear,
+    inOutSine,  // starts and ends gently
+};
+
+inline float easeInOutSine(float t) {
+    return 0.5f * (1.0f - cosf(float(M_PI) * t));
+}
+
+inline float ease(Easing easing, float t) {
+    t = t < 0.0f ? 0.0f : (t > 1.0f ? 1.0f : t);
+
+    switch (easing) {
+        case Easing::inOutSine:
+            return easeInOutSine(t);
+        case Easing::linear:
+        default:
+            return t;
+    }
+}
+
+#endif  // OSSM_SOFTWARE_EASING_H
@@ -0,0 +1,78 @@
+#ifndef OSSM_SOFTWARE_FILTERS_H
+#define OSSM_SOFTWARE_FILTERS_H
+
+#include <cstddef>
+
+// First order low pass, y += alpha * (x - y). The first sample initializes
+// the output so there is no ramp up from zero.
+class IirFilter {
+  public:
+    explicit IirFilter(float alpha = 0.05f) : alpha(alpha) {}
+
+    float update(float sample) {
+        if (!primed) {
+            value = sample;
+            primed = true;
+        } else {
+            value += alpha * (sample - value);
+        }
+        return value;
+    }
+
+    float get() const { return value; }
+
+    void setAlpha(float newAlpha) { alpha = newAlpha; }
+
+    void reset() { primed = false; }
+
+  private:
+    float alpha;
+    float value = 0;
+    bool primed = false;
+};
+
+// Running median over the last Window samples. Rejects single sample spikes
+// that an IIR filter would smear out.
+template <size_t Window = 5>
+class MedianFilter {
+    static_assert(Window % 2 == 1, "MedianFilter window must be odd");
+
+  public:
+    float update(float sample) {
+        samples[next] = sample;
+        next = (next + 1) % Window;
+        if (count < Window) {
+            count++;
+        }
+
+        // Insertion sort of a copy, Window is small
+        float sorted[Window];
+        for (size_t i = 0; i < count; i++) {
+            float v = samples[i];
+            size_t j = i;
+            while (j > 0 && sorted[j - 1] > v) {
+                sorted[j] = sorted[j - 1];
+                j--;
+            }
+            sorted[j] = v;
+        }
+
+        value = sorted[count / 2];
+        return value;
+    }
+
+    float get() const { return value; }
+
+    void reset() {
+        count = 0;
+        next = 0;
+    }
+
+  private:
+    float samples[Window] = {};
+    size_t count = 0;
+    size_t next = 0;
+    float value = 0;
+};
+
+#endif  // OSSM_SOFTWARE_FILTERS_H
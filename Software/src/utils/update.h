@@ -7,6 +7,8 @@
 
 #include "ArduinoJson.h"
 #include "constants/LogTags.h"
+#include "services/json.h"
+#include "services/ota.h"
 
 #ifndef SW_VERSION
 #define SW_VERSION "0.0.0"
@@ -40,7 +42,7 @@ static auto isUpdateAvailable = []() {
     WiFiClient client;
     http.begin(client, serverNameBubble);
     http.addHeader("Content-Type", "application/json");
-    JsonDocument doc;
+    JsonDocument doc(&jsonAllocator);
     // Add values in the document
     doc["ossmSwVersion"] = SW_VERSION;
     String requestBody;
@@ -51,7 +53,7 @@ static auto isUpdateAvailable = []() {
     String payload = "{}";
     payload = http.getString();
     ESP_LOGD(UPDATE_TAG, "HTTP Response code: %d", httpResponseCode);
-    JsonDocument bubbleResponse;
+    JsonDocument bubbleResponse(&jsonAllocator);
     deserializeJson(bubbleResponse, payload);
     bool response_needUpdate = bubbleResponse["response"]["needUpdate"];
 
@@ -65,20 +67,37 @@ static auto isUpdateAvailable = []() {
     return response_needUpdate;
 };
 
-auto updateOSSM = []() {
-    // check if we're online
-
-    WiFiClient client;
-    String url = "http://d2sy3zdr3r1gt5.cloudfront.net/firmware.bin";
+// Prefers the compressed image next to firmware.bin, which downloads about
+// half the data and resumes after a dropout. Falls back to the plain image
+// if the server doesn't have one. progress gets the written percentage.
+static void updateOSSM(OtaProgress progress) {
+    String url = "http://d2sy3zdr3r1gt5.cloudfront.net/firmware";
 
 #ifdef VERSIONDEV
-    url = "http://d2sy3zdr3r1gt5.cloudfront.net/firmware-dev.bin";
+    url = "http://d2sy3zdr3r1gt5.cloudfront.net/firmware-dev";
 #endif
 #ifdef VERSIONSTAGING
-    url = "http://d2sy3zdr3r1gt5.cloudfront.net/firmware-dev.bin";
+    url = "http://d2sy3zdr3r1gt5.cloudfront.net/firmware-dev";
 #endif
 
-    t_httpUpdate_return ret = httpUpdate.update(client, url);
+    OtaResult result = updateFromCompressedImage(url + ".osz", progress);
+    if (result == OtaResult::ok) {
+        ESP_LOGD("UTILS", "HTTP_UPDATE_OK");
+        ESP.restart();
+        return;
+    }
+    if (result == OtaResult::failed) {
+        ESP_LOGD("UTILS", "Compressed update failed");
+        return;
+    }
+
+    WiFiClient client;
+    httpUpdate.onProgress([&progress](int written, int total) {
+        if (total > 0) {
+            progress(int(100LL * written / total));
+        }
+    });
+    t_httpUpdate_return ret = httpUpdate.update(client, url + ".bin");
 
     switch (ret) {
         case HTTP_UPDATE_FAILED:
@@ -97,6 +116,6 @@ auto updateOSSM = []() {
     }
 
     client.stop();
-};
+}
 
 #endif  // SOFTWARE_UPDATE_H
@@ -0,0 +1,72 @@
+"""Packs firmware.bin into the compressed, resumable image the OSSM updates from.
+
+The firmware is cut into 32KiB chunks that are zlib compressed one by one,
+see src/utils/OtaImage.h for the layout. Upload the result next to
+firmware.bin as firmware.osz (firmware-dev.osz for dev builds), the OSSM
+falls back to the plain image if there is none.
+
+    python compress_firmware.py .pio/build/esp32dev/firmware.bin firmware.osz
+"""
+
+import argparse
+import struct
+import zlib
+
+MAGIC = b"OSZ1"
+CHUNK_SIZE = 32768
+MAX_CHUNKS = 128
+
+
+def pack(firmware):
+    chunks = [firmware[i:i + CHUNK_SIZE] for i in range(0, len(firmware), CHUNK_SIZE)]
+    if len(chunks) > MAX_CHUNKS:
+        raise ValueError(f"{len(firmware)} bytes don't fit into {MAX_CHUNKS} chunks")
+
+    compressed = [zlib.compress(chunk, 9) for chunk in chunks]
+    crcs = [zlib.crc32(chunk) for chunk in chunks]
+
+    offset = 16 + (2 * len(chunks) + 1) * 4
+    offsets = []
+    for data in compressed:
+        offsets.append(offset)
+        offset += len(data)
+    offsets.append(offset)
+
+    header = MAGIC + struct.pack("<III", len(firmware), CHUNK_SIZE, len(chunks))
+    index = struct.pack(f"<{len(offsets)}I{len(crcs)}I", *offsets, *crcs)
+    return header + index + b"".join(compressed)
+
+
+def unpack(image):
+    """Inverse of pack, checks every chunk like the firmware does"""
+    if image[:4] != MAGIC:
+        raise ValueError("not a compressed image")
+    size, chunk_size, count = struct.unpack_from("<III", image, 4)
+    offsets = struct.unpack_from(f"<{count + 1}I", image, 16)
+    crcs = struct.unpack_from(f"<{count}I", image, 16 + (count + 1) * 4)
+
+    firmware = b""
+    for i in range(count):
+        chunk = zlib.decompress(image[offsets[i]:offsets[i + 1]])
+        if zlib.crc32(chunk) != crcs[i]:
+            raise ValueError(f"CRC mismatch in chunk {i}")
+        firmware += chunk
+    if len(firmware) != size or chunk_size != CHUNK_SIZE:
+        raise ValueError("size mismatch")
+    return firmware
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("firmware", help="firmware.bin built by PlatformIO")
+    parser.add_argument("output", help="compressed image to write")
+    args = parser.parse_args()
+
+    with open(args.firmware, "rb") as f:
+        firmware = f.read()
+    image = pack(firmware)
+    assert unpack(image) == firmware
+
+    with open(args.output, "wb") as f:
+        f.write(image)
+    print(f"{len(firmware)} -> {len(image)} bytes ({100 * len(image) / len(firmware):.0f}%)")
@@ -0,0 +1,205 @@
+"""Measures how long BLE commands take to reach the OSSM's motor.
+
+Sends binary speed commands with sequence numbers and collects the stage
+timestamps the firmware notifies on the command latency characteristic:
+
+    write -> received -> dispatched -> applied -> moving
+
+write -> received isn't visible to the device, it is estimated as half the
+round trip of the acknowledgement. Everything after that is measured on the
+device. The connection interval is chosen by the firmware per state, it is
+read from the state characteristic and printed with every run.
+
+    poetry run python latency.py --rates 2,5,10 --count 100
+    poetry run python latency.py --mode start     # first step from standstill
+    poetry run python latency.py --state menu     # relaxed link, no motion
+"""
+
+import argparse
+import asyncio
+import contextlib
+import csv
+import json
+import struct
+import time
+
+from bleak import BleakClient, BleakScanner
+
+SERVICE_UUID = "522b443a-4f53-534d-0001-420badbabe69"
+BINARY_COMMAND_UUID = "522b443a-4f53-534d-1020-420badbabe69"
+STATE_UUID = "522b443a-4f53-534d-2000-420badbabe69"
+LATENCY_UUID = "522b443a-4f53-534d-e004-420badbabe69"
+
+SET_SPEED = 0x01
+GO_TO_STROKE_ENGINE = 0x10
+GO_TO_MENU = 0x13
+
+RECORD = struct.Struct("<BBIIII")
+STAGES = ["received", "dispatched", "applied", "moving"]
+
+
+def frame(opcode, value, seq=None):
+    if seq is None:
+        return struct.pack("<BH", opcode, value)
+    return struct.pack("<BHB", opcode, value, seq)
+
+
+def percentile(values, p):
+    if not values:
+        return None
+    values = sorted(values)
+    index = min(len(values) - 1, max(0, round(p / 100 * (len(values) - 1))))
+    return values[index]
+
+
+class Harness:
+    def __init__(self, client):
+        self.client = client
+        self.state = {}
+        self.written = {}  # seq -> write time
+        self.rtt = {}  # seq -> ack round trip
+        self.records = {}  # seq -> stage times relative to received
+        self.seq = 0
+
+    def on_state(self, sender, data):
+        self.state = json.loads(data.decode())
+
+    def on_ack(self, sender, data):
+        if len(data) >= 2 and data[1] == 0 and data[0] in self.written:
+            self.rtt.setdefault(data[0], time.perf_counter() - self.written[data[0]])
+
+    def on_record(self, sender, data):
+        seq, stages, _, dispatched, applied, moving = RECORD.unpack(data)
+        times = {"received": 0}
+        for bit, (stage, value) in enumerate(
+            zip(STAGES[1:], (dispatched, applied, moving)), start=1
+        ):
+            if stages & (1 << bit):
+                times[stage] = value / 1000.0
+        self.records[seq] = times
+
+    async def start(self):
+        await self.client.start_notify(STATE_UUID, self.on_state)
+        await self.client.start_notify(BINARY_COMMAND_UUID, self.on_ack)
+        await self.client.start_notify(LATENCY_UUID, self.on_record)
+
+    async def send(self, opcode, value, probe=True):
+        """Writes a command, only frames with a sequence number are probed"""
+        if not probe:
+            await self.client.write_gatt_char(
+                BINARY_COMMAND_UUID, frame(opcode, value), response=False
+            )
+            return None
+        self.seq = (self.seq + 1) % 256
+        self.written[self.seq] = time.perf_counter()
+        self.rtt.pop(self.seq, None)
+        self.records.pop(self.seq, None)
+        await self.client.write_gatt_char(
+            BINARY_COMMAND_UUID, frame(opcode, value, self.seq), response=False
+        )
+        return self.seq
+
+    async def wait_for_state(self, prefix, timeout):
+        deadline = time.monotonic() + timeout
+        while not self.state.get("state", "").startswith(prefix):
+            if time.monotonic() > deadline:
+                raise TimeoutError(f"OSSM didn't reach {prefix}: {self.state}")
+            await asyncio.sleep(0.1)
+
+    async def run(self, rate, count, mode, speed):
+        """Sends count commands at rate per second, returns the samples in ms"""
+        period = 1.0 / rate
+        sent = []
+        for i in range(count):
+            if mode == "start":
+                # Every other command starts the machine from standstill, the
+                # stops aren't probed so they don't hold up the next start
+                value = speed if i % 2 else 0
+            else:
+                value = speed + (i % 2) * 5
+            seq = await self.send(SET_SPEED, value, probe=value > 0)
+            if seq is not None:
+                sent.append(seq)
+            await asyncio.sleep(period)
+        # Records are notified after the first step or a 500ms timeout
+        await asyncio.sleep(1.0)
+
+        samples = []
+        for seq in sent:
+            if seq not in self.records or seq not in self.rtt:
+                continue
+            write = self.rtt[seq] * 1000.0 / 2
+            sample = {"write": 0.0}
+            for stage, value in self.records[seq].items():
+                sample[stage] = write + value
+            samples.append(sample)
+        return samples
+
+
+def report(label, rate, link, samples, sent, writer):
+    interval = link.get("interval", "?")
+    print(f"\n{label}: {rate}/s, interval {interval}ms, latency {link.get('latency', '?')}, "
+          f"{len(samples)} of {sent} commands probed")
+    print(f"  {'stage':<12}{'n':>6}{'p50':>10}{'p95':>10}{'p99':>10}")
+    for stage in STAGES:
+        values = [s[stage] for s in samples if stage in s]
+        row = [percentile(values, p) for p in (50, 95, 99)]
+        text = "".join(f"{v:>10.2f}" if v is not None else f"{'-':>10}" for v in row)
+        print(f"  {stage:<12}{len(values):>6}{text}")
+        if writer and values:
+            writer.writerow([label, rate, interval, stage, len(values), *row])
+
+
+async def find_address(name):
+    device = await BleakScanner.find_device_by_filter(
+        lambda d, ad: SERVICE_UUID in ad.service_uuids or d.name == name
+    )
+    if device is None:
+        raise RuntimeError(f"No {name} found")
+    return device.address
+
+
+async def main(args):
+    address = args.address or await find_address("OSSM")
+    async with BleakClient(address) as client:
+        harness = Harness(client)
+        await harness.start()
+
+        if args.state == "strokeEngine":
+            await harness.send(GO_TO_STROKE_ENGINE, 0)
+            await harness.wait_for_state("strokeEngine", 60)
+        else:
+            await harness.send(GO_TO_MENU, 0)
+            await harness.wait_for_state("menu", 10)
+        # Let the link settle on the parameters of the state
+        await asyncio.sleep(2.0)
+
+        with open(args.csv, "a", newline="") if args.csv else contextlib.nullcontext() as out:
+            writer = csv.writer(out) if out else None
+            for rate in args.rates:
+                count = args.count * (2 if args.mode == "start" else 1)
+                samples = await harness.run(rate, count, args.mode, args.speed)
+                sent = count // 2 if args.mode == "start" else count
+                report(args.label, rate, harness.state.get("link", {}), samples,
+                       sent, writer)
+
+        await harness.send(SET_SPEED, 0)
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--address", help="skip scanning and connect to this device")
+    parser.add_argument("--rates", default="2,5,10,20",
+                        type=lambda s: [float(r) for r in s.split(",")],
+                        help="commands per second, comma separated")
+    parser.add_argument("--count", type=int, default=100,
+                        help="probed commands per rate")
+    parser.add_argument("--mode", choices=["speed", "start"], default="speed",
+                        help="speed: change the speed while moving, "
+                             "start: alternate stop and start")
+    parser.add_argument("--state", choices=["strokeEngine", "menu"],
+                        default="strokeEngine")
+    parser.add_argument("--speed", type=int, default=30, help="speed in percent")
+    parser.add_argument("--label", default="run", help="name of the run in the report")
+    parser.add_argument("--csv", help="append the percentiles to this file")
+    asyncio.run(main(parser.parse_args()))
@@ -0,0 +1,175 @@
+"""Packs the display assets into smaller flash data.
+
+images: run length encodes the XBM images in support/images with PackBits
+into src/constants/PackedImages.h, see src/utils/PackBits.h. Each row is
+XORed with the one above first, which turns the solid parts of a logo into
+runs of zeros. The OSSM unpacks them into a scratch buffer when drawn. Edit or add the .xbm
+files (as exported by GIMP), then run
+
+    python pack_assets.py images
+
+glyphs: lists the characters the copy in src/constants/copy uses beyond
+printable ASCII, and the glyph map to cut the U8G2 fonts down to them with
+bdfconv (-m). Without any, build with -DOSSM_ASCII_FONTS for the "r" fonts,
+which only hold ASCII.
+
+    python pack_assets.py glyphs
+"""
+
+import argparse
+import pathlib
+import re
+
+SOFTWARE = pathlib.Path(__file__).resolve().parent.parent
+IMAGES = SOFTWARE / "support" / "images"
+HEADER = SOFTWARE / "src" / "constants" / "PackedImages.h"
+COPY = SOFTWARE / "src" / "constants" / "copy"
+
+# The OSSM unpacks into a buffer of a full screen, 128x64
+MAX_UNPACKED = 128 * 64 // 8
+
+
+def pack_bits(data):
+    """PackBits: runs of 2 or more bytes become a header and the byte"""
+    packed = bytearray()
+    literal = bytearray()
+
+    def flush():
+        while literal:
+            chunk = literal[:128]
+            packed.append(len(chunk) - 1)
+            packed.extend(chunk)
+            del literal[:128]
+
+    i = 0
+    while i < len(data):
+        run = 1
+        while i + run < len(data) and data[i + run] == data[i] and run < 128:
+            run += 1
+        if run >= 2:
+            flush()
+            packed.append(257 - run)
+            packed.append(data[i])
+            i += run
+        else:
+            literal.append(data[i])
+            i += 1
+    flush()
+    return bytes(packed)
+
+
+def unpack_bits(packed, size):
+    """Inverse of pack_bits, like unpackBits() on the OSSM"""
+    out = bytearray()
+    i = 0
+    while i < len(packed) and len(out) < size:
+        header = packed[i]
+        i += 1
+        if header < 128:
+            out.extend(packed[i:i + header + 1])
+            i += header + 1
+        elif header > 128:
+            out.extend(packed[i:i + 1] * (257 - header))
+            i += 1
+    return bytes(out[:size])
+
+
+def delta_rows(data, row_bytes):
+    """XOR of every row with the one above, like unpackXbm() undoes it"""
+    return bytes(b ^ data[i - row_bytes] if i >= row_bytes else b
+                 for i, b in enumerate(data))
+
+
+def undelta_rows(data, row_bytes):
+    out = bytearray(data)
+    for i in range(row_bytes, len(out)):
+        out[i] ^= out[i - row_bytes]
+    return bytes(out)
+
+
+def read_xbm(path):
+    text = path.read_text()
+    width = int(re.search(r"_width\s+(\d+)", text).group(1))
+    height = int(re.search(r"_height\s+(\d+)", text).group(1))
+    body = text[text.index("{") + 1:text.rindex("}")]
+    data = bytes(int(value, 16) for value in re.findall(r"0x[0-9a-fA-F]+", body))
+    if len(data) != (width + 7) // 8 * height:
+        raise ValueError(f"{path.name}: {len(data)} bytes for {width}x{height}")
+    return width, height, data
+
+
+def byte_lines(data, indent="        "):
+    lines = []
+    for i in range(0, len(data), 12):
+        lines.append(indent + ", ".join(f"0x{b:02x}" for b in data[i:i + 12]) + ",")
+    return "\n".join(lines)
+
+
+def pack_images():
+    parts = []
+    total_raw = 0
+    total_packed = 0
+    for path in sorted(IMAGES.glob("*.xbm")):
+        width, height, data = read_xbm(path)
+        if len(data) > MAX_UNPACKED:
+            raise ValueError(f"{path.name} is larger than the screen")
+        row_bytes = (width + 7) // 8
+        packed = pack_bits(delta_rows(data, row_bytes))
+        assert undelta_rows(unpack_bits(packed, len(data)), row_bytes) == data
+
+        name = path.stem
+        parts.append(
+            f"    // {width}x{height}, {len(data)} bytes unpacked\n"
+            f"    const uint8_t {name}Data[] PROGMEM = {{\n"
+            f"{byte_lines(packed)}\n"
+            f"    }};\n"
+            f"    const PackedXbm {name} = {{{width}, {height}, {len(packed)}, {name}Data}};\n")
+        total_raw += len(data)
+        total_packed += len(packed)
+        print(f"{name}: {len(data)} -> {len(packed)} bytes")
+
+    HEADER.write_text(
+        "#ifndef OSSM_SOFTWARE_PACKEDIMAGES_H\n"
+        "#define OSSM_SOFTWARE_PACKEDIMAGES_H\n"
+        "\n"
+        "#include <Arduino.h>\n"
+        "\n"
+        '#include "utils/PackBits.h"\n'
+        "\n"
+        "// Generated by support/pack_assets.py from support/images, don't edit.\n"
+        "namespace Images {\n"
+        + "\n".join(parts)
+        + "}\n"
+        "\n"
+        "#endif  // OSSM_SOFTWARE_PACKEDIMAGES_H\n")
+    print(f"{total_raw} -> {total_packed} bytes, {HEADER.relative_to(SOFTWARE)}")
+
+
+def copy_strings(path):
+    """The string literals of a copy file, escapes resolved"""
+    text = path.read_text(encoding="utf-8")
+    literals = re.findall(r'"((?:[^"\\]|\\.)*)"', text)
+    return "".join(bytes(s, "utf-8").decode("unicode_escape").encode("latin-1").decode("utf-8")
+                   for s in literals)
+
+
+def list_glyphs():
+    for path in sorted(COPY.glob("*.h")):
+        extra = sorted({c for c in copy_strings(path) if not 32 <= ord(c) < 127})
+        if not extra:
+            print(f"{path.name}: ASCII only, -DOSSM_ASCII_FONTS fits")
+            continue
+        glyphs = ",".join(str(ord(c)) for c in extra)
+        print(f"{path.name}: {''.join(extra)}")
+        print(f"    bdfconv -m '32-126,{glyphs}'")
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("asset", choices=["images", "glyphs"])
+    args = parser.parse_args()
+
+    if args.asset == "images":
+        pack_images()
+    else:
+        list_glyphs()
@@ -0,0 +1,236 @@
+// Cycle counts of the hot paths, measured on the ESP32 itself. Every result
+// is printed as one CSV row prefixed with "BENCH," so a run can be diffed
+// against a baseline:
+//
+//   BENCH,name,calls,mean,min,max
+//
+// mean, min and max are CPU cycles per call with the measuring overhead
+// subtracted. Interrupts are left on, min is the figure to compare.
+
+#include <Arduino.h>
+
+#include <string_view>
+
+#include "U8g2lib.h"
+#include "command/commands.hpp"
+#include "constants/Pins.h"
+#include "esp_cpu.h"
+#include "pattern.h"
+#include "unity.h"
+#include "utils/StateJson.h"
+
+// Geometry of a default OSSM in steps
+#define BENCH_STEPS_PER_MM 20
+#define BENCH_MAX_STEP 2760
+#define BENCH_MAX_SPEED (666 * BENCH_STEPS_PER_MM)
+#define BENCH_MAX_ACCELERATION (10000 * BENCH_STEPS_PER_MM)
+
+static uint32_t overhead = 0;
+
+struct BenchResult {
+    uint32_t calls = 0;
+    uint64_t total = 0;
+    uint32_t minimum = UINT32_MAX;
+    uint32_t maximum = 0;
+
+    void print(const char *name) const {
+        Serial.printf("BENCH,%s,%lu,%lu,%lu,%lu\n", name,
+                      (unsigned long)calls,
+                      (unsigned long)(calls > 0 ? total / calls : 0),
+                      (unsigned long)minimum, (unsigned long)maximum);
+    }
+};
+
+// Times calls of function(i) and adds them to result
+template <typename Function>
+static void measure(BenchResult &result, uint32_t calls, Function function) {
+    for (uint32_t i = 0; i < calls; i++) {
+        uint32_t start = esp_cpu_get_cycle_count();
+        function(i);
+        uint32_t cycles = esp_cpu_get_cycle_count() - start;
+        cycles = cycles > overhead ? cycles - overhead : 0;
+
+        result.calls++;
+        result.total += cycles;
+        result.minimum = min(result.minimum, cycles);
+        result.maximum = max(result.maximum, cycles);
+    }
+}
+
+// Keeps results alive, so the compiler can't drop the measured code
+static volatile int sink = 0;
+
+static const char *const commands[] = {
+    "go:strokeEngine",  "go:simplePenetration", "set:speed:42",
+    "set:stroke:100",   "set:sensation:7",      "stream:63:250",
+    "set:bogus:10",     "set:speed:05"};
+static const size_t commandCount = sizeof(commands) / sizeof(commands[0]);
+
+void setUp(void) {
+    // Set up before each test
+}
+
+void tearDown(void) {
+    // Clean up after each test
+}
+
+void test_Overhead(void) {
+    // Cost of an empty measurement, subtracted from all others
+    BenchResult result;
+    measure(result, 1000, [](uint32_t i) { sink = i; });
+    overhead = result.minimum;
+    result.print("overhead");
+    TEST_ASSERT_TRUE(result.minimum < 100);
+}
+
+void test_Patterns(void) {
+    const float sensations[] = {-100, -50, 0, 50, 100};
+    const int strokes[] = {BENCH_MAX_STEP / 4, BENCH_MAX_STEP / 2,
+                           BENCH_MAX_STEP};
+    const int depths[] = {BENCH_MAX_STEP / 2, BENCH_MAX_STEP};
+
+    for (unsigned int p = 0; p < patternTableSize; p++) {
+        Pattern *pattern = patternTable[p];
+        BenchResult result;
+
+        pattern->setSpeedLimit(BENCH_MAX_SPEED, BENCH_MAX_ACCELERATION,
+                               BENCH_STEPS_PER_MM);
+        pattern->setTimeOfStroke(1.0);
+        for (float sensation : sensations) {
+            for (int stroke : strokes) {
+                for (int depth : depths) {
+                    pattern->setSensation(sensation);
+                    pattern->setStroke(stroke);
+                    pattern->setDepth(depth);
+                    measure(result, 100, [pattern](uint32_t i) {
+                        sink = pattern->nextTarget(i).speed;
+                    });
+                }
+            }
+        }
+
+        char name[48];
+        snprintf(name, sizeof(name), "nextTarget:%s", pattern->getName());
+        result.print(name);
+        TEST_ASSERT_EQUAL(100 * 5 * 3 * 2, result.calls);
+    }
+}
+
+void test_PatternCycles(void) {
+    // Steady state of the planner: same parameters, one index after another
+    for (unsigned int p = 0; p < patternTableSize; p++) {
+        Pattern *pattern = patternTable[p];
+        BenchResult result;
+
+        pattern->setSpeedLimit(BENCH_MAX_SPEED, BENCH_MAX_ACCELERATION,
+                               BENCH_STEPS_PER_MM);
+        pattern->setTimeOfStroke(1.0);
+        pattern->setSensation(0);
+        pattern->setStroke(BENCH_MAX_STEP / 2);
+        pattern->setDepth(BENCH_MAX_STEP);
+        measure(result, 1000, [pattern](uint32_t i) {
+            sink = pattern->target(i).speed;
+        });
+
+        char name[48];
+        snprintf(name, sizeof(name), "target:%s", pattern->getName());
+        result.print(name);
+    }
+}
+
+void test_MapSensationToFactor(void) {
+    BenchResult result;
+    measure(result, 2000, [](uint32_t i) {
+        sink = int(1000 * mapSensationToFactor(5.0, float(i % 201) - 100.0,
+                                               float(i % 21) - 10.0));
+    });
+    result.print("mapSensationToFactor");
+
+    static const SensationTable<> table(5.0);
+    BenchResult lookup;
+    measure(lookup, 2000, [](uint32_t i) {
+        sink = int(1000 * table(float(i % 201) - 100.0));
+    });
+    lookup.print("SensationTable");
+    TEST_ASSERT_TRUE(lookup.minimum <= result.minimum);
+}
+
+void test_CommandFromString(void) {
+    BenchResult result;
+    measure(result, 1000, [](uint32_t i) {
+        sink = commandFromString(commands[i % commandCount]).value;
+    });
+    result.print("commandFromString");
+    TEST_ASSERT_EQUAL(1000, result.calls);
+}
+
+void test_StateJson(void) {
+    SettingPercents setting = {.speed = 42,
+                               .stroke = 80,
+                               .sensation = 50,
+                               .depth = 33,
+                               .pattern = StrokePatterns::SimpleStroke,
+                               .speedKnob = 42};
+    LinkStatus link = {.interval = 12, .latency = 0, .timeout = 400,
+                       .mtu = 247, .phy = 2};
+    char buffer[160];
+
+    BenchResult idle;
+    measure(idle, 500, [&](uint32_t) {
+        sink = formatStateJson(buffer, sizeof(buffer), "strokeEngine.idle",
+                               setting, nullptr);
+    });
+    idle.print("getCurrentState");
+
+    BenchResult connected;
+    measure(connected, 500, [&](uint32_t) {
+        sink = formatStateJson(buffer, sizeof(buffer), "strokeEngine.idle",
+                               setting, &link);
+    });
+    connected.print("getCurrentState:link");
+    TEST_ASSERT_TRUE(connected.minimum >= idle.minimum);
+}
+
+void test_SendBuffer(void) {
+    U8G2_SSD1306_128X64_NONAME_F_HW_I2C display(U8G2_R0,
+                                                Pins::Display::oledReset,
+                                                Pins::Remote::displayClock,
+                                                Pins::Remote::displayData);
+    display.setBusClock(400000);
+    display.begin();
+    display.clearBuffer();
+    display.drawFrame(0, 0, 128, 64);
+    display.drawBox(8, 8, 48, 48);
+
+    BenchResult result;
+    measure(result, 20, [&](uint32_t) { display.sendBuffer(); });
+    result.print("sendBuffer");
+    TEST_ASSERT_EQUAL(20, result.calls);
+}
+
+int runUnityTests() {
+    UNITY_BEGIN();
+    RUN_TEST(test_Overhead);
+    RUN_TEST(test_Patterns);
+    RUN_TEST(test_PatternCycles);
+    RUN_TEST(test_MapSensationToFactor);
+    RUN_TEST(test_CommandFromString);
+    RUN_TEST(test_StateJson);
+    RUN_TEST(test_SendBuffer);
+    return UNITY_END();
+}
+
+// WARNING!!! PLEASE REMOVE UNNECESSARY MAIN IMPLEMENTATIONS //
+
+/**
+ * For Arduino framework
+ */
+void setup() {
+    // Wait ~2 seconds before the Unity test runner
+    // establishes connection with a board Serial interface
+    delay(2000);
+
+    runUnityTests();
+}
+
+void loop() {}
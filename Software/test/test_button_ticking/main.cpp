@@ -0,0 +1,138 @@
+#include <vector>
+
+#include "unity.h"
+#include "utils/ButtonTicking.h"
+
+void setUp(void) {
+    // Set up before each test
+}
+
+void tearDown(void) {
+    // Clean up after each test
+}
+
+static constexpr uint32_t debounceMs = 50;
+static constexpr uint32_t clickMs = 400;
+static constexpr uint32_t tickMs = 10;
+
+/**
+ * The part of OneButton the input task relies on: a level only counts once
+ * it held for debounceMs, and a click fires clickMs after the release.
+ */
+class DebouncedButton {
+  public:
+    void tick(bool level, uint32_t now) {
+        if (level != lastLevel) {
+            lastLevel = level;
+            levelSince = now;
+        }
+        if (now - levelSince >= debounceMs) {
+            debounced = level;
+        }
+
+        if (state == State::idle && debounced) {
+            state = State::down;
+        } else if (state == State::down && !debounced) {
+            state = State::up;
+            releasedAt = now;
+        } else if (state == State::up && now - releasedAt > clickMs) {
+            clicks++;
+            state = State::idle;
+        }
+    }
+
+    bool isIdle() const { return state == State::idle; }
+
+    int clicks = 0;
+
+  private:
+    enum class State { idle, down, up };
+    State state = State::idle;
+    bool lastLevel = false;
+    bool debounced = false;
+    uint32_t levelSince = 0;
+    uint32_t releasedAt = 0;
+};
+
+struct Edge {
+    uint32_t timeMs;
+    bool level;
+};
+
+/**
+ * Runs the input task on the edges until endMs: it wakes on every edge, or
+ * after tickMs while the button is ticking, and sleeps otherwise.
+ * @return the clicks the button saw
+ */
+static int runInputTask(const std::vector<Edge> &edges, uint32_t endMs,
+                        bool isCheckingDebounce) {
+    DebouncedButton button;
+    bool level = false;
+    uint32_t lastEdgeMs = 0;
+    size_t next = 0;
+    uint32_t now = 0;
+
+    while (now < endMs) {
+        while (next < edges.size() && edges[next].timeMs <= now) {
+            level = edges[next].level;
+            lastEdgeMs = edges[next].timeMs;
+            next++;
+        }
+        button.tick(level, now);
+
+        bool isTicking =
+            isCheckingDebounce
+                ? isButtonTicking(button.isIdle(), now * 1000,
+                                  lastEdgeMs * 1000, debounceMs * 1000)
+                : !button.isIdle();
+        uint32_t wake = next < edges.size() ? edges[next].timeMs : endMs;
+        if (isTicking && now + tickMs < wake) {
+            wake = now + tickMs;
+        }
+        now = wake;
+    }
+    return button.clicks;
+}
+
+void test_Ticking(void) {
+    TEST_ASSERT_TRUE(isButtonTicking(false, 1000000, 0, 50000));
+    TEST_ASSERT_TRUE(isButtonTicking(true, 50000, 0, 50000));
+    TEST_ASSERT_FALSE(isButtonTicking(true, 50001, 0, 50000));
+
+    // Across a wrap of the microseconds
+    TEST_ASSERT_TRUE(isButtonTicking(true, 10000, 0xffffff00, 50000));
+}
+
+void test_BouncingPressIsClicked(void) {
+    std::vector<Edge> edges = {{1000, true},  {1002, false}, {1003, true},
+                               {1005, false}, {1006, true},  {1200, false},
+                               {1201, true},  {1203, false}};
+
+    TEST_ASSERT_EQUAL(1, runInputTask(edges, 3000, true));
+
+    // Sleeping as soon as OneButton is idle loses the press, no tick comes
+    // after the level settled
+    TEST_ASSERT_EQUAL(0, runInputTask(edges, 3000, false));
+}
+
+void test_BounceWithoutPressIsIgnored(void) {
+    std::vector<Edge> edges = {{1000, true}, {1001, false}, {1002, true},
+                               {1003, false}};
+
+    TEST_ASSERT_EQUAL(0, runInputTask(edges, 3000, true));
+}
+
+int runUnityTests(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_Ticking);
+    RUN_TEST(test_BouncingPressIsClicked);
+    RUN_TEST(test_BounceWithoutPressIsIgnored);
+    return UNITY_END();
+}
+
+// WARNING!!! PLEASE REMOVE UNNECESSARY MAIN IMPLEMENTATIONS //
+
+/**
+ * For native dev-platform or for some embedded frameworks
+ */
+int main(void) { return runUnityTests(); }
@@ -0,0 +1,86 @@
+#include <cstring>
+
+#include "unity.h"
+#include "utils/Catalog.h"
+
+static const char blob[] = "{\"v\":1,\"patterns\":[]}";
+static const size_t blobLength = sizeof(blob) - 1;
+
+void setUp(void) {
+    // Set up before each test
+}
+
+void tearDown(void) {
+    // Clean up after each test
+}
+
+void test_HashIsFnv1a(void) {
+    TEST_ASSERT_EQUAL_HEX32(0x811C9DC5, catalogHash(nullptr, 0));
+    TEST_ASSERT_EQUAL_HEX32(0xE40C292C, catalogHash((const uint8_t*)"a", 1));
+}
+
+void test_HashChangesWithContent(void) {
+    char other[sizeof(blob)];
+    memcpy(other, blob, sizeof(blob));
+    other[5] = '2';
+
+    TEST_ASSERT_NOT_EQUAL(catalogHash((const uint8_t*)blob, blobLength),
+                          catalogHash((const uint8_t*)other, blobLength));
+}
+
+void test_InfoDescribesBlob(void) {
+    CatalogInfo info = catalogInfo((const uint8_t*)blob, blobLength);
+
+    TEST_ASSERT_EQUAL(CATALOG_VERSION, info.version);
+    TEST_ASSERT_EQUAL(blobLength, info.length);
+    TEST_ASSERT_EQUAL_HEX32(catalogHash((const uint8_t*)blob, blobLength),
+                            info.hash);
+}
+
+void test_ChunksReassembleBlob(void) {
+    uint8_t chunk[10];
+    char received[sizeof(blob)] = {};
+    uint32_t offset = 0;
+    int chunks = 0;
+
+    size_t length;
+    while ((length = catalogChunk((const uint8_t*)blob, blobLength, offset,
+                                  chunk, sizeof(chunk))) > 0) {
+        uint32_t at = chunk[0] | (chunk[1] << 8) | (chunk[2] << 16) |
+                      ((uint32_t)chunk[3] << 24);
+        TEST_ASSERT_EQUAL(offset, at);
+        memcpy(received + at, chunk + catalogChunkHeader,
+               length - catalogChunkHeader);
+        offset += length - catalogChunkHeader;
+        chunks++;
+    }
+
+    TEST_ASSERT_EQUAL(blobLength, offset);
+    TEST_ASSERT_EQUAL((blobLength + 5) / 6, chunks);
+    TEST_ASSERT_EQUAL_STRING(blob, received);
+}
+
+void test_ChunkPastTheEndIsEmpty(void) {
+    uint8_t chunk[10];
+    TEST_ASSERT_EQUAL(0, catalogChunk((const uint8_t*)blob, blobLength,
+                                      blobLength, chunk, sizeof(chunk)));
+    TEST_ASSERT_EQUAL(0, catalogChunk((const uint8_t*)blob, blobLength, 0,
+                                      chunk, catalogChunkHeader));
+}
+
+int runUnityTests() {
+    UNITY_BEGIN();
+    RUN_TEST(test_HashIsFnv1a);
+    RUN_TEST(test_HashChangesWithContent);
+    RUN_TEST(test_InfoDescribesBlob);
+    RUN_TEST(test_ChunksReassembleBlob);
+    RUN_TEST(test_ChunkPastTheEndIsEmpty);
+    return UNITY_END();
+}
+
+// WARNING!!! PLEASE REMOVE UNNECESSARY MAIN IMPLEMENTATIONS //
+
+/**
+ * For native dev-platform or for some embedded frameworks
+ */
+int main(void) { return runUnityTests(); }
@@ -0,0 +1,101 @@
+#include "ClipLog.h"
+#include "unity.h"
+
+void setUp(void) {
+    // Set up before each test
+}
+
+void tearDown(void) {
+    // Clean up after each test
+}
+
+void test_EventsComeOutInOrder(void) {
+    ClipLog<4> log;
+    log.setTracing(true);
+    log.record(CLIP_SPEED, 14000, 13320, 1000);
+    log.record(CLIP_DURATION, 200000, 250000, 2000);
+
+    ClipEvent event;
+    TEST_ASSERT_TRUE(log.pop(event));
+    TEST_ASSERT_EQUAL(CLIP_SPEED, event.type);
+    TEST_ASSERT_EQUAL(14000, event.requested);
+    TEST_ASSERT_EQUAL(13320, event.limited);
+    TEST_ASSERT_EQUAL(1000, event.time);
+    TEST_ASSERT_TRUE(log.pop(event));
+    TEST_ASSERT_EQUAL(CLIP_DURATION, event.type);
+    TEST_ASSERT_FALSE(log.pop(event));
+}
+
+void test_FullTraceOnlyCounts(void) {
+    ClipLog<2> log;
+    log.setTracing(true);
+    for (int i = 0; i < 5; i++) {
+        log.record(CLIP_ACCELERATION, 300000 + i, 200000, i);
+    }
+
+    ClipCounters counters;
+    log.getCounters(&counters);
+    TEST_ASSERT_EQUAL(5, counters.events[CLIP_ACCELERATION]);
+    TEST_ASSERT_EQUAL(3, counters.dropped);
+
+    // The oldest events are kept
+    ClipEvent event;
+    TEST_ASSERT_TRUE(log.pop(event));
+    TEST_ASSERT_EQUAL(300000, event.requested);
+    TEST_ASSERT_TRUE(log.pop(event));
+    TEST_ASSERT_EQUAL(300001, event.requested);
+    TEST_ASSERT_FALSE(log.pop(event));
+
+    // Room again once the trace is taken
+    log.record(CLIP_REJECTED, -1, 0, 10);
+    TEST_ASSERT_TRUE(log.pop(event));
+    TEST_ASSERT_EQUAL(CLIP_REJECTED, event.type);
+}
+
+void test_CountsWithoutTracing(void) {
+    ClipLog<4> log;
+    log.record(CLIP_RETARGET, 200000, 260000, 0);
+    log.record(CLIP_RETARGET, 200000, 240000, 0);
+
+    ClipCounters counters;
+    log.getCounters(&counters);
+    TEST_ASSERT_EQUAL(2, counters.events[CLIP_RETARGET]);
+    TEST_ASSERT_EQUAL(0, counters.dropped);
+    ClipEvent event;
+    TEST_ASSERT_FALSE(log.pop(event));
+}
+
+void test_ResetClearsCounters(void) {
+    ClipLog<4> log;
+    log.setTracing(true);
+    log.record(CLIP_SPEED, 2, 1, 0);
+    log.record(CLIP_TYPES, 2, 1, 0);
+    log.reset();
+
+    ClipCounters counters;
+    log.getCounters(&counters);
+    for (int i = 0; i < CLIP_TYPES; i++) {
+        TEST_ASSERT_EQUAL(0, counters.events[i]);
+    }
+
+    // Events already traced are still printed
+    ClipEvent event;
+    TEST_ASSERT_TRUE(log.pop(event));
+    TEST_ASSERT_FALSE(log.pop(event));
+}
+
+int runUnityTests() {
+    UNITY_BEGIN();
+    RUN_TEST(test_EventsComeOutInOrder);
+    RUN_TEST(test_FullTraceOnlyCounts);
+    RUN_TEST(test_CountsWithoutTracing);
+    RUN_TEST(test_ResetClearsCounters);
+    return UNITY_END();
+}
+
+// WARNING!!! PLEASE REMOVE UNNECESSARY MAIN IMPLEMENTATIONS //
+
+/**
+ * For native dev-platform or for some embedded frameworks
+ */
+int main(void) { return runUnityTests(); }
@@ -0,0 +1,72 @@
+#include <vector>
+
+#include "command/coalescer.hpp"
+#include "unity.h"
+
+static std::vector<CommandValue> applied;
+
+void setUp(void) { applied.clear(); }
+
+void tearDown(void) {
+    // Clean up after each test
+}
+
+static void apply(const CommandValue &command) { applied.push_back(command); }
+
+void test_KeepsNewestValue(void) {
+    CommandCoalescer coalescer;
+    TEST_ASSERT_TRUE(coalescer.add({Commands::setSpeed, 10}));
+    TEST_ASSERT_TRUE(coalescer.add({Commands::setSpeed, 20}));
+    TEST_ASSERT_TRUE(coalescer.add({Commands::setSpeed, 30}));
+    coalescer.flush(apply);
+
+    TEST_ASSERT_EQUAL(1, applied.size());
+    TEST_ASSERT_EQUAL(Commands::setSpeed, applied[0].command);
+    TEST_ASSERT_EQUAL(30, applied[0].value);
+    TEST_ASSERT_EQUAL(2, coalescer.getSupersededCount());
+}
+
+void test_ParametersAreIndependent(void) {
+    CommandCoalescer coalescer;
+    coalescer.add({Commands::setDepth, 40});
+    coalescer.add({Commands::setSpeed, 50});
+    coalescer.add({Commands::setStroke, 60});
+    coalescer.flush(apply);
+
+    TEST_ASSERT_EQUAL(3, applied.size());
+    TEST_ASSERT_EQUAL(0, coalescer.getSupersededCount());
+}
+
+void test_FlushClearsPending(void) {
+    CommandCoalescer coalescer;
+    coalescer.add({Commands::setSpeed, 10});
+    coalescer.flush(apply);
+    coalescer.flush(apply);
+
+    TEST_ASSERT_EQUAL(1, applied.size());
+}
+
+void test_OtherCommandsPassThrough(void) {
+    CommandCoalescer coalescer;
+    TEST_ASSERT_FALSE(coalescer.add({Commands::goToStrokeEngine, 0}));
+    TEST_ASSERT_FALSE(coalescer.add({Commands::streamPosition, 50, 100}));
+    coalescer.flush(apply);
+
+    TEST_ASSERT_EQUAL(0, applied.size());
+}
+
+int runUnityTests() {
+    UNITY_BEGIN();
+    RUN_TEST(test_KeepsNewestValue);
+    RUN_TEST(test_ParametersAreIndependent);
+    RUN_TEST(test_FlushClearsPending);
+    RUN_TEST(test_OtherCommandsPassThrough);
+    return UNITY_END();
+}
+
+// WARNING!!! PLEASE REMOVE UNNECESSARY MAIN IMPLEMENTATIONS //
+
+/**
+ * For native dev-platform or for some embedded frameworks
+ */
+int main(void) { return runUnityTests(); }
@@ -0,0 +1,134 @@
+#include "unity.h"
+#include "utils/CoexPlan.h"
+#include "utils/ConnEventMonitor.h"
+
+// 7.5ms, the fast interval of play modes
+static const uint16_t interval = 6;
+static const int64_t intervalUs = 7500;
+
+void setUp(void) {
+    // Set up before each test
+}
+
+void tearDown(void) {
+    // Clean up after each test
+}
+
+void test_PlayModesPreferBle(void) {
+    CoexPlan full = {false, CoexWifi::full};
+    CoexPlan sleep = {true, CoexWifi::sleep};
+    CoexPlan off = {true, CoexWifi::off};
+
+    TEST_ASSERT_TRUE(planCoex(CoexPolicy::preferBle,
+                              StateId::strokeEnginePattern, true,
+                              false) == sleep);
+    TEST_ASSERT_TRUE(planCoex(CoexPolicy::bleOnly, StateId::streamingIdle,
+                              true, false) == off);
+    TEST_ASSERT_TRUE(planCoex(CoexPolicy::balanced, StateId::streaming, true,
+                              false) == full);
+
+    // WiFi control keeps more of the WiFi
+    CoexPlan awake = {true, CoexWifi::full};
+    TEST_ASSERT_TRUE(planCoex(CoexPolicy::preferBle, StateId::streaming,
+                              true, true) == awake);
+    TEST_ASSERT_TRUE(planCoex(CoexPolicy::bleOnly, StateId::streaming, true,
+                              true) == sleep);
+}
+
+void test_WifiIsFullOutsidePlay(void) {
+    CoexPlan full = {false, CoexWifi::full};
+    TEST_ASSERT_TRUE(planCoex(CoexPolicy::bleOnly, StateId::updateChecking,
+                              true, false) == full);
+    TEST_ASSERT_TRUE(planCoex(CoexPolicy::bleOnly, StateId::wifiIdle, true,
+                              false) == full);
+    TEST_ASSERT_TRUE(planCoex(CoexPolicy::bleOnly, StateId::menuIdle, true,
+                              false) == full);
+    // Nothing to prefer without a client
+    TEST_ASSERT_TRUE(planCoex(CoexPolicy::bleOnly, StateId::strokeEngine,
+                              false, false) == full);
+}
+
+void test_SteadyWritesMissNothing(void) {
+    ConnEventMonitor monitor;
+    int64_t now = 1000000;
+    for (int i = 0; i < 100; i++) {
+        // Some jitter, and a second write in the same event now and then
+        monitor.record(now + (i % 3) * 400, interval);
+        if (i % 10 == 0) {
+            monitor.record(now + 1000, interval);
+        }
+        now += intervalUs;
+    }
+    // 99 gaps, the first ones only teach the cadence
+    TEST_ASSERT_EQUAL(99 - ConnEventMonitor::learnGaps, monitor.getEvents());
+    TEST_ASSERT_EQUAL(0, monitor.getMissed());
+    TEST_ASSERT_INT_WITHIN(500, 7500, monitor.getCadenceUs());
+}
+
+void test_CadenceBetweenIntervals(void) {
+    // 50Hz on 7.5ms lands on every second or third event
+    ConnEventMonitor monitor;
+    int64_t now = 0;
+    for (int i = 0; i < 60; i++) {
+        monitor.record(now, interval);
+        now += i % 3 == 0 ? 2 * intervalUs : 3 * intervalUs;
+    }
+    TEST_ASSERT_EQUAL(0, monitor.getMissed());
+}
+
+void test_LateWritesCountMissedEvents(void) {
+    ConnEventMonitor monitor;
+    int64_t now = 0;
+    for (int i = 0; i < 20; i++) {
+        monitor.record(now, interval);
+        now += intervalUs;
+    }
+    // Two events taken by the WiFi, then back on time
+    now += 2 * intervalUs;
+    monitor.record(now, interval);
+    now += intervalUs;
+    monitor.record(now, interval);
+    TEST_ASSERT_EQUAL(2, monitor.getMissed());
+    TEST_ASSERT_EQUAL(2, monitor.getWorstRun());
+    TEST_ASSERT_EQUAL(19 - ConnEventMonitor::learnGaps + 3 + 1,
+                      monitor.getEvents());
+}
+
+void test_PausesAreNotMisses(void) {
+    ConnEventMonitor monitor;
+    int64_t now = 0;
+    for (int i = 0; i < 10; i++) {
+        monitor.record(now, interval);
+        now += intervalUs;
+    }
+    // The client stopped for a second, then writes at a new cadence
+    now += 1000000;
+    for (int i = 0; i < 10; i++) {
+        monitor.record(now, interval);
+        now += 4 * intervalUs;
+    }
+    TEST_ASSERT_EQUAL(0, monitor.getMissed());
+    TEST_ASSERT_EQUAL(4 * 7500, monitor.getCadenceUs());
+
+    monitor.reset();
+    TEST_ASSERT_EQUAL(0, monitor.getEvents());
+    TEST_ASSERT_EQUAL(0, monitor.getCadenceUs());
+}
+
+int runUnityTests(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_PlayModesPreferBle);
+    RUN_TEST(test_WifiIsFullOutsidePlay);
+    RUN_TEST(test_SteadyWritesMissNothing);
+    RUN_TEST(test_CadenceBetweenIntervals);
+    RUN_TEST(test_LateWritesCountMissedEvents);
+    RUN_TEST(test_PausesAreNotMisses);
+    return UNITY_END();
+}
+
+// WARNING!!! PLEASE REMOVE UNNECESSARY MAIN IMPLEMENTATIONS //
+
+/**
+ * For native dev-platform or for some embedded frameworks
+ */
+int main(void) { return runUnityTests(); }
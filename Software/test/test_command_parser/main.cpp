@@ -0,0 +1,206 @@
+#include <cstring>
+#include <regex>
+#include <string>
+#include <vector>
+
+#include "command/commands.hpp"
+#include "command/gpio.hpp"
+#include "unity.h"
+
+// The grammars the parsers replaced, kept here as the reference. The parsers
+// may reject more (ranges, non canonical numbers), never accept more.
+static const std::regex commandGrammar(
+    R"(go:(simplePenetration|strokeEngine|streaming|menu)|set:(speed|stroke|depth|sensation|pattern):\d+(\.\d{1,2})?(;(speed|stroke|depth|sensation|pattern):\d+(\.\d{1,2})?)*|stream:\d+:\d+)");
+static const std::regex gpioGrammar(R"(^\s*(\d+)\s*:(low|high|0|1)\s*$)",
+                                    std::regex::icase);
+
+static const char* const seeds[] = {
+    "go:strokeEngine",
+    "go:simplePenetration",
+    "go:streaming",
+    "go:menu",
+    "set:speed:50",
+    "set:stroke:99.99",
+    "set:depth:0.5",
+    "set:sensation:100",
+    "set:pattern:3",
+    "set:speed:50;depth:30",
+    "set:speed:100;stroke:99.99;depth:100;sensation:0.1;pattern:100",
+    "stream:12:250",
+    "stream:100:65535",
+    "1:high",
+    " 4 :LOW ",
+    "2:0",
+    "3:1\n"};
+static const int seedCount = sizeof(seeds) / sizeof(seeds[0]);
+
+// Characters the mutations insert, biased towards the ones the grammars use
+static const char alphabet[] = "0123456789:;.-+ \t\nsetgoamlhwipdkrncHILO";
+
+static uint32_t random32(uint32_t& state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+static std::string mutate(uint32_t& state) {
+    std::string str = seeds[random32(state) % seedCount];
+    int mutations = 1 + random32(state) % 3;
+    for (int i = 0; i < mutations; i++) {
+        size_t at = str.empty() ? 0 : random32(state) % str.size();
+        char c = alphabet[random32(state) % (sizeof(alphabet) - 1)];
+        switch (random32(state) % 5) {
+            case 0:
+                str.insert(at, 1, c);
+                break;
+            case 1:
+                if (!str.empty()) str.erase(at, 1);
+                break;
+            case 2:
+                if (!str.empty()) str[at] = c;
+                break;
+            case 3:
+                if (!str.empty()) str[at] = (char)random32(state);
+                break;
+            case 4:
+                str = str.substr(0, at);
+                break;
+        }
+    }
+    return str;
+}
+
+static bool sameCommand(const CommandValue& a, const CommandValue& b) {
+    if (a.command != b.command || a.value != b.value) {
+        return false;
+    }
+    if (a.command == Commands::streamPosition) {
+        return a.time == b.time;
+    }
+    if (a.command == Commands::setValues) {
+        for (int i = 0; i < setValueCount; i++) {
+            if ((a.value & (1 << i)) && a.values[i] != b.values[i]) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void setUp(void) {
+    // Set up before each test
+}
+
+void tearDown(void) {
+    // Clean up after each test
+}
+
+void test_SeedsParse(void) {
+    for (int i = 0; i < seedCount; i++) {
+        CommandValue command = {Commands::ignore, 0};
+        int index = 0;
+        bool isHigh = false;
+        size_t length = strlen(seeds[i]);
+        TEST_ASSERT_TRUE(parseCommand(seeds[i], length, command) ||
+                         parseGpioCommand(seeds[i], length, index, isHigh));
+    }
+}
+
+void test_RejectedLeavesCommandAlone(void) {
+    const char* invalid[] = {"",           "go:",        "go:menux",
+                             "set:",       "set:speed",  "set:speed:",
+                             "set:speed:5;", "stream:",  "stream:1:",
+                             "ste",        "set:speed:50;depth:30;"};
+    for (const char* str : invalid) {
+        CommandValue command = {Commands::setDepth, 42};
+        TEST_ASSERT_FALSE(parseCommand(str, strlen(str), command));
+        TEST_ASSERT_TRUE(command.command == Commands::setDepth);
+        TEST_ASSERT_EQUAL(42, command.value);
+    }
+}
+
+void test_GpioCommands(void) {
+    int index = 0;
+    bool isHigh = false;
+    TEST_ASSERT_TRUE(parseGpioCommand("2:HIGH", 6, index, isHigh));
+    TEST_ASSERT_EQUAL(2, index);
+    TEST_ASSERT_TRUE(isHigh);
+    TEST_ASSERT_TRUE(parseGpioCommand(" 03\t:low  ", 10, index, isHigh));
+    TEST_ASSERT_EQUAL(3, index);
+    TEST_ASSERT_FALSE(isHigh);
+
+    // Out of range indices are well formed, the pin lookup rejects them
+    const char* huge = "99999999999999:1";
+    TEST_ASSERT_TRUE(parseGpioCommand(huge, strlen(huge), index, isHigh));
+    TEST_ASSERT_TRUE(index > 4);
+
+    const char* invalid[] = {"1: high", "1:hi", "1:10", ":1", "1", "a:1",
+                             "1:high x", "-1:0"};
+    for (const char* str : invalid) {
+        TEST_ASSERT_FALSE(parseGpioCommand(str, strlen(str), index, isHigh));
+    }
+}
+
+// Mutated commands never get past the reference grammar, and what they
+// decode to survives a round trip through its text form.
+void test_FuzzCommands(void) {
+    uint32_t state = 0x2545F491;
+    int accepted = 0;
+    for (int i = 0; i < 20000; i++) {
+        std::string str = mutate(state);
+        // Exactly sized, so reads past the end show under a sanitizer
+        std::vector<char> received(str.begin(), str.end());
+
+        CommandValue command = {Commands::ignore, 0};
+        if (!parseCommand(received.data(), received.size(), command)) {
+            continue;
+        }
+        accepted++;
+        TEST_ASSERT_TRUE_MESSAGE(std::regex_match(str, commandGrammar),
+                                 str.c_str());
+
+        char text[80];
+        size_t length = commandToString(command, text, sizeof(text));
+        CommandValue again = {Commands::ignore, 0};
+        TEST_ASSERT_TRUE_MESSAGE(parseCommand(text, length, again),
+                                 str.c_str());
+        TEST_ASSERT_TRUE_MESSAGE(sameCommand(command, again), str.c_str());
+    }
+    // Enough mutations stay valid to exercise the decoding
+    TEST_ASSERT_TRUE(accepted > 200);
+}
+
+// The GPIO grammar has no ranges, so the parser accepts exactly what the
+// reference accepts.
+void test_FuzzGpio(void) {
+    uint32_t state = 0x9E3779B9;
+    for (int i = 0; i < 20000; i++) {
+        std::string str = mutate(state);
+        std::vector<char> received(str.begin(), str.end());
+
+        int index = -1;
+        bool isHigh = false;
+        bool isParsed =
+            parseGpioCommand(received.data(), received.size(), index, isHigh);
+        TEST_ASSERT_EQUAL_MESSAGE(std::regex_match(str, gpioGrammar),
+                                  isParsed, str.c_str());
+    }
+}
+
+int runUnityTests(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_SeedsParse);
+    RUN_TEST(test_RejectedLeavesCommandAlone);
+    RUN_TEST(test_GpioCommands);
+    RUN_TEST(test_FuzzCommands);
+    RUN_TEST(test_FuzzGpio);
+    return UNITY_END();
+}
+
+// WARNING!!! PLEASE REMOVE UNNECESSARY MAIN IMPLEMENTATIONS //
+
+/**
+ * For native dev-platform or for some embedded frameworks
+ */
+int main(void) { return runUnityTests(); }
@@ -0,0 +1,164 @@
+#include "command/commands.hpp"
+#include "unity.h"
+
+void setUp(void) {
+    // Set up before each test
+}
+
+void tearDown(void) {
+    // Clean up after each test
+}
+
+void test_GoCommands(void) {
+    TEST_ASSERT_TRUE(commandFromString("go:strokeEngine").command ==
+                     Commands::goToStrokeEngine);
+    TEST_ASSERT_TRUE(commandFromString("go:streaming").command ==
+                     Commands::goToStreaming);
+    TEST_ASSERT_TRUE(commandFromString("go:menu").command ==
+                     Commands::goToMenu);
+    TEST_ASSERT_TRUE(commandFromString("go:unknown").command ==
+                     Commands::ignore);
+    TEST_ASSERT_TRUE(commandFromString("go:menu ").command ==
+                     Commands::ignore);
+}
+
+void test_SetCommands(void) {
+    CommandValue command = commandFromString("set:speed:42");
+    TEST_ASSERT_TRUE(command.command == Commands::setSpeed);
+    TEST_ASSERT_EQUAL(42 * setValueScale, command.value);
+
+    command = commandFromString("set:depth:0");
+    TEST_ASSERT_TRUE(command.command == Commands::setDepth);
+    TEST_ASSERT_EQUAL(0, command.value);
+
+    TEST_ASSERT_TRUE(commandFromString("set:stroke:100").command ==
+                     Commands::setStroke);
+    TEST_ASSERT_TRUE(commandFromString("set:bogus:10").command ==
+                     Commands::ignore);
+}
+
+void test_FineValues(void) {
+    CommandValue command = commandFromString("set:speed:50.25");
+    TEST_ASSERT_TRUE(command.command == Commands::setSpeed);
+    TEST_ASSERT_EQUAL(5025, command.value);
+    TEST_ASSERT_EQUAL_FLOAT(50.25, percentOf(command.value));
+
+    TEST_ASSERT_EQUAL(50, commandFromString("set:depth:0.5").value);
+    TEST_ASSERT_EQUAL(10000, commandFromString("set:stroke:100.00").value);
+
+    command = commandFromString("set:speed:0.01;pattern:2");
+    TEST_ASSERT_TRUE(command.command == Commands::setValues);
+    TEST_ASSERT_EQUAL(1, command.values[setValueSpeed]);
+    TEST_ASSERT_EQUAL(2 * setValueScale, command.values[setValuePattern]);
+
+    const char* invalid[] = {"set:speed:50.",   "set:speed:50.123",
+                             "set:speed:100.01", "set:speed:.5",
+                             "set:speed:50.-1",  "set:pattern:2.5"};
+    for (const char* str : invalid) {
+        TEST_ASSERT_TRUE(commandFromString(str).command == Commands::ignore);
+    }
+
+    command = commandFromString("set:speed:50.25;depth:3.5");
+    TEST_ASSERT_EQUAL(350, command.values[setValueDepth]);
+}
+
+void test_RejectsNonCanonicalNumbers(void) {
+    const char* invalid[] = {"set:speed:",    "set:speed:101", "set:speed:05",
+                             "set:speed:+5",  "set:speed:5 ",  "set:speed:-1",
+                             "set:speed:1e2", "set:speed"};
+    for (const char* str : invalid) {
+        TEST_ASSERT_TRUE(commandFromString(str).command == Commands::ignore);
+    }
+}
+
+void test_SetValuesCommands(void) {
+    CommandValue command = commandFromString("set:speed:50;depth:30");
+    TEST_ASSERT_TRUE(command.command == Commands::setValues);
+    TEST_ASSERT_EQUAL((1 << setValueSpeed) | (1 << setValueDepth),
+                      command.value);
+    TEST_ASSERT_EQUAL(50 * setValueScale, command.values[setValueSpeed]);
+    TEST_ASSERT_EQUAL(30 * setValueScale, command.values[setValueDepth]);
+    TEST_ASSERT_TRUE(isMotionCommand(command));
+
+    command = commandFromString("set:stroke:80;pattern:2");
+    TEST_ASSERT_TRUE(command.command == Commands::setValues);
+    TEST_ASSERT_FALSE(isMotionCommand(command));
+
+    // One bad value rejects them all
+    const char* invalid[] = {"set:speed:50;depth:101", "set:speed:50;",
+                             "set:speed:50;speed:60", "set:speed:50;bogus:1",
+                             "set:speed:50;depth"};
+    for (const char* str : invalid) {
+        TEST_ASSERT_TRUE(commandFromString(str).command == Commands::ignore);
+    }
+
+    command = commandFromString(
+        "set:speed:50;stroke:80;depth:60;sensation:10;pattern:2");
+    TEST_ASSERT_EQUAL(0x1F, command.value);
+    TEST_ASSERT_EQUAL(10 * setValueScale, command.values[setValueSensation]);
+}
+
+void test_StreamCommands(void) {
+    CommandValue command = commandFromString("stream:50:1000");
+    TEST_ASSERT_TRUE(command.command == Commands::streamPosition);
+    TEST_ASSERT_EQUAL(50, command.value);
+    TEST_ASSERT_EQUAL(1000, command.time);
+
+    TEST_ASSERT_TRUE(commandFromString("stream:50").command ==
+                     Commands::ignore);
+    TEST_ASSERT_TRUE(commandFromString("stream:50:65536").command ==
+                     Commands::ignore);
+}
+
+void test_ViewIsNotTerminated(void) {
+    // BLE values are not null terminated, only the view length counts
+    const char received[] = "set:speed:7123";
+    CommandValue command =
+        commandFromString(std::string_view(received, sizeof(received) - 4));
+    TEST_ASSERT_TRUE(command.command == Commands::setSpeed);
+    TEST_ASSERT_EQUAL(7 * setValueScale, command.value);
+}
+
+void test_RoundTrip(void) {
+    const char* commands[] = {
+        "go:simplePenetration", "set:sensation:73", "set:pattern:3",
+        "stream:12:250", "set:speed:50.25", "set:depth:0.5",
+        "set:speed:100;stroke:99.99;depth:100;sensation:0.1;pattern:100"};
+    char buffer[64];
+    for (const char* str : commands) {
+        size_t length =
+            commandToString(commandFromString(str), buffer, sizeof(buffer));
+        TEST_ASSERT_EQUAL_STRING(str, buffer);
+        TEST_ASSERT_EQUAL(strlen(str), length);
+    }
+}
+
+void test_MotionCommands(void) {
+    TEST_ASSERT_TRUE(isMotionCommand(Commands::goToStrokeEngine));
+    TEST_ASSERT_TRUE(isMotionCommand(Commands::setSpeed));
+    TEST_ASSERT_TRUE(isMotionCommand(Commands::streamPosition));
+    TEST_ASSERT_FALSE(isMotionCommand(Commands::goToMenu));
+    TEST_ASSERT_FALSE(isMotionCommand(Commands::setDepth));
+    TEST_ASSERT_FALSE(isMotionCommand(Commands::ignore));
+}
+
+int runUnityTests() {
+    UNITY_BEGIN();
+    RUN_TEST(test_GoCommands);
+    RUN_TEST(test_SetCommands);
+    RUN_TEST(test_FineValues);
+    RUN_TEST(test_RejectsNonCanonicalNumbers);
+    RUN_TEST(test_SetValuesCommands);
+    RUN_TEST(test_StreamCommands);
+    RUN_TEST(test_ViewIsNotTerminated);
+    RUN_TEST(test_RoundTrip);
+    RUN_TEST(test_MotionCommands);
+    return UNITY_END();
+}
+
+// WARNING!!! PLEASE REMOVE UNNECESSARY MAIN IMPLEMENTATIONS //
+
+/**
+ * For native dev-platform or for some embedded frameworks
+ */
+int main(void) { return runUnityTests(); }
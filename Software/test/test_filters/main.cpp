@@ -0,0 +1,60 @@
+#include "unity.h"
+#include "utils/filters.h"
+
+void setUp(void) {
+    // Set up before each test
+}
+
+void tearDown(void) {
+    // Clean up after each test
+}
+
+void test_IirStartsAtFirstSample(void) {
+    IirFilter filter(0.1f);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 50.0f, filter.update(50.0f));
+}
+
+void test_IirConverges(void) {
+    IirFilter filter(0.5f);
+    filter.update(0.0f);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 50.0f, filter.update(100.0f));
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 75.0f, filter.update(100.0f));
+    for (int i = 0; i < 50; i++) {
+        filter.update(100.0f);
+    }
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 100.0f, filter.get());
+}
+
+void test_MedianRejectsSpike(void) {
+    MedianFilter<5> filter;
+    filter.update(10.0f);
+    filter.update(10.0f);
+    filter.update(10.0f);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 10.0f, filter.update(4096.0f));
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 10.0f, filter.update(10.0f));
+}
+
+void test_MedianFollowsStep(void) {
+    MedianFilter<3> filter;
+    filter.update(0.0f);
+    filter.update(0.0f);
+    filter.update(0.0f);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 0.0f, filter.update(20.0f));
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 20.0f, filter.update(20.0f));
+}
+
+int runUnityTests() {
+    UNITY_BEGIN();
+    RUN_TEST(test_IirStartsAtFirstSample);
+    RUN_TEST(test_IirConverges);
+    RUN_TEST(test_MedianRejectsSpike);
+    RUN_TEST(test_MedianFollowsStep);
+    return UNITY_END();
+}
+
+// WARNING!!! PLEASE REMOVE UNNECESSARY MAIN IMPLEMENTATIONS //
+
+/**
+ * For native dev-platform or for some embedded frameworks
+ */
+int main(void) { return runUnityTests(); }
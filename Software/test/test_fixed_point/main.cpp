@@ -0,0 +1,108 @@
+#include "FixedPoint.h"
+#include "pattern.h"
+#include "unity.h"
+
+void setUp(void) {
+    // Set up before each test
+}
+
+void tearDown(void) {
+    // Clean up after each test
+}
+
+void test_Conversion(void) {
+    TEST_ASSERT_EQUAL(Q16_ONE, toQ16(1.0));
+    TEST_ASSERT_EQUAL(-Q16_ONE / 2, toQ16(-0.5));
+    TEST_ASSERT_FLOAT_WITHIN(1e-4, 1.5, fromQ16(toQ16(1.5)));
+    TEST_ASSERT_EQUAL(toQ16(4.0), q16Rate(0.25));
+    TEST_ASSERT_EQUAL(0, q16Rate(0.0));
+}
+
+void test_MultiplyTruncatesTowardsZero(void) {
+    TEST_ASSERT_EQUAL(int(1001 * 0.7), q16Multiply(1001, toQ16(0.7)));
+    TEST_ASSERT_EQUAL(int(-1001 * 0.7), q16Multiply(-1001, toQ16(0.7)));
+    TEST_ASSERT_EQUAL(0, q16Multiply(1, toQ16(0.5) - 1));
+}
+
+void test_SpeedMatchesFloat(void) {
+    // Strokes up to 4000 steps taking 0.1 s to 30 s
+    for (int stroke = 0; stroke <= 4000; stroke += 37) {
+        for (float time = 0.1; time < 30.0; time *= 1.17) {
+            int expected = int(1.5 * stroke / time);
+            int actual = q16Scale(stroke, toQ16(1.5), q16Rate(time));
+            TEST_ASSERT_TRUE(abs(expected - actual) <= 1);
+        }
+    }
+}
+
+void test_AccelerationMatchesFloat(void) {
+    for (int speed = 0; speed <= 40000; speed += 331) {
+        for (float time = 0.1; time < 30.0; time *= 1.17) {
+            int expected = int(3.0 * speed / time);
+            int actual = q16Scale(speed, toQ16(3.0), q16Rate(time));
+            TEST_ASSERT_TRUE(abs(expected - actual) <= 1);
+        }
+    }
+}
+
+void test_SimpleStrokeMatchesFloat(void) {
+    SimpleStroke pattern("Simple Stroke");
+    pattern.setStroke(3000);
+    pattern.setDepth(3500);
+
+    for (float speed = 0.5; speed < 60.0; speed *= 1.3) {
+        pattern.setTimeOfStroke(speed);
+        float time = 0.5 * speed;
+        int expectedSpeed = int(1.5 * 3000 / time);
+        int expectedAcceleration = int(3.0 * expectedSpeed / time);
+
+        motionParameter move = pattern.nextTarget(1);
+        TEST_ASSERT_TRUE(abs(expectedSpeed - move.speed) <= 1);
+        TEST_ASSERT_TRUE(abs(expectedAcceleration - move.acceleration) <= 1);
+        TEST_ASSERT_EQUAL(500, move.stroke);
+    }
+}
+
+void test_RoboStrokeMatchesFloat(void) {
+    RoboStroke pattern("Robo Stroke");
+    pattern.setStroke(2000);
+    pattern.setDepth(2000);
+
+    for (float sensation = -100; sensation <= 100; sensation += 25) {
+        pattern.setSensation(sensation);
+        float x = sensation >= 0
+                      ? fscale(0.0, 100.0, 1.0 / 3.0, 0.5, sensation, 0.0)
+                      : fscale(0.0, 100.0, 1.0 / 3.0, 0.05, -sensation, 0.0);
+
+        for (float speed = 0.5; speed < 60.0; speed *= 1.5) {
+            pattern.setTimeOfStroke(speed);
+            float time = 0.5 * speed;
+            float expectedSpeed = 2000.0f / ((1 - x) * time);
+            float expectedAcceleration = expectedSpeed / (x * time);
+
+            motionParameter move = pattern.nextTarget(0);
+            TEST_ASSERT_TRUE(abs(int(expectedSpeed) - move.speed) <= 1);
+            TEST_ASSERT_TRUE(
+                abs(int(expectedAcceleration) - move.acceleration) <= 1);
+            TEST_ASSERT_EQUAL(2000, move.stroke);
+        }
+    }
+}
+
+int runUnityTests() {
+    UNITY_BEGIN();
+    RUN_TEST(test_Conversion);
+    RUN_TEST(test_MultiplyTruncatesTowardsZero);
+    RUN_TEST(test_SpeedMatchesFloat);
+    RUN_TEST(test_AccelerationMatchesFloat);
+    RUN_TEST(test_SimpleStrokeMatchesFloat);
+    RUN_TEST(test_RoboStrokeMatchesFloat);
+    return UNITY_END();
+}
+
+// WARNING!!! PLEASE REMOVE UNNECESSARY MAIN IMPLEMENTATIONS //
+
+/**
+ * For native dev-platform or for some embedded frameworks
+ */
+int main(void) { return runUnityTests(); }
@@ -0,0 +1,201 @@
+#include "command/frames.hpp"
+#include "unity.h"
+
+void setUp(void) {
+    // Set up before each test
+}
+
+void tearDown(void) {
+    // Clean up after each test
+}
+
+void test_SetSpeed(void) {
+    const uint8_t frame[] = {Opcode::setSpeed, 75, 0};
+    CommandValue command;
+    uint8_t seq = 0xFF;
+    TEST_ASSERT_EQUAL(FrameStatus::ok,
+                      decodeCommandFrame(frame, sizeof(frame), command, seq));
+    TEST_ASSERT_EQUAL(Commands::setSpeed, command.command);
+    TEST_ASSERT_EQUAL(75 * setValueScale, command.value);
+    TEST_ASSERT_EQUAL(0, seq);
+}
+
+void test_SequenceNumber(void) {
+    const uint8_t frame[] = {Opcode::setDepth, 10, 0, 42};
+    CommandValue command;
+    uint8_t seq = 0;
+    TEST_ASSERT_EQUAL(FrameStatus::ok,
+                      decodeCommandFrame(frame, sizeof(frame), command, seq));
+    TEST_ASSERT_EQUAL(Commands::setDepth, command.command);
+    TEST_ASSERT_EQUAL(10 * setValueScale, command.value);
+    TEST_ASSERT_EQUAL(42, seq);
+}
+
+void test_GoTo(void) {
+    const uint8_t frame[] = {Opcode::goToStrokeEngine, 0, 0};
+    CommandValue command;
+    uint8_t seq = 0;
+    TEST_ASSERT_EQUAL(FrameStatus::ok,
+                      decodeCommandFrame(frame, sizeof(frame), command, seq));
+    TEST_ASSERT_EQUAL(Commands::goToStrokeEngine, command.command);
+}
+
+void test_StreamPosition(void) {
+    // position 80, time 0x0102 = 258ms, seq 7
+    const uint8_t frame[] = {Opcode::streamPosition, 80, 0, 0x02, 0x01, 7};
+    CommandValue command;
+    uint8_t seq = 0;
+    TEST_ASSERT_EQUAL(FrameStatus::ok,
+                      decodeCommandFrame(frame, sizeof(frame), command, seq));
+    TEST_ASSERT_EQUAL(Commands::streamPosition, command.command);
+    TEST_ASSERT_EQUAL(80, command.value);
+    TEST_ASSERT_EQUAL(258, command.time);
+    TEST_ASSERT_EQUAL(7, seq);
+}
+
+void test_Malformed(void) {
+    const uint8_t shortFrame[] = {Opcode::setSpeed, 75};
+    const uint8_t longFrame[] = {Opcode::setSpeed, 75, 0, 1, 2};
+    const uint8_t shortStream[] = {Opcode::streamPosition, 80, 0, 1};
+    CommandValue command;
+    uint8_t seq = 0;
+    TEST_ASSERT_EQUAL(
+        FrameStatus::malformed,
+        decodeCommandFrame(shortFrame, sizeof(shortFrame), command, seq));
+    TEST_ASSERT_EQUAL(
+        FrameStatus::malformed,
+        decodeCommandFrame(longFrame, sizeof(longFrame), command, seq));
+    TEST_ASSERT_EQUAL(
+        FrameStatus::malformed,
+        decodeCommandFrame(shortStream, sizeof(shortStream), command, seq));
+    TEST_ASSERT_EQUAL(FrameStatus::malformed,
+                      decodeCommandFrame(nullptr, 0, command, seq));
+}
+
+void test_UnknownOpcode(void) {
+    const uint8_t frame[] = {0x7F, 0, 0};
+    CommandValue command;
+    uint8_t seq = 0;
+    TEST_ASSERT_EQUAL(FrameStatus::unknownOpcode,
+                      decodeCommandFrame(frame, sizeof(frame), command, seq));
+    TEST_ASSERT_EQUAL(Commands::ignore, command.command);
+}
+
+void test_OutOfRange(void) {
+    // 0x0100 = 256
+    const uint8_t frame[] = {Opcode::setStroke, 0x00, 0x01};
+    CommandValue command;
+    uint8_t seq = 0;
+    TEST_ASSERT_EQUAL(FrameStatus::outOfRange,
+                      decodeCommandFrame(frame, sizeof(frame), command, seq));
+    TEST_ASSERT_EQUAL(Commands::ignore, command.command);
+}
+
+void test_SetValues(void) {
+    // speed 50 and depth 30, seq 9
+    const uint8_t mask = (1 << setValueSpeed) | (1 << setValueDepth);
+    const uint8_t frame[] = {Opcode::setValues, mask, 50, 0, 30, 0, 9};
+    CommandValue command;
+    uint8_t seq = 0;
+    TEST_ASSERT_EQUAL(FrameStatus::ok,
+                      decodeCommandFrame(frame, sizeof(frame), command, seq));
+    TEST_ASSERT_EQUAL(Commands::setValues, command.command);
+    TEST_ASSERT_EQUAL(mask, command.value);
+    TEST_ASSERT_EQUAL(50 * setValueScale, command.values[setValueSpeed]);
+    TEST_ASSERT_EQUAL(30 * setValueScale, command.values[setValueDepth]);
+    TEST_ASSERT_EQUAL(9, seq);
+    TEST_ASSERT_EQUAL(6, commandFramePayload(frame, sizeof(frame)));
+}
+
+void test_SetValuesMalformed(void) {
+    // No values, an unknown parameter and a value missing
+    const uint8_t empty[] = {Opcode::setValues, 0};
+    const uint8_t unknown[] = {Opcode::setValues, 0x21, 50, 0, 1, 0};
+    const uint8_t missing[] = {Opcode::setValues, 0x03, 50, 0};
+    CommandValue command;
+    uint8_t seq = 0;
+    TEST_ASSERT_EQUAL(FrameStatus::malformed,
+                      decodeCommandFrame(empty, sizeof(empty), command, seq));
+    TEST_ASSERT_EQUAL(
+        FrameStatus::malformed,
+        decodeCommandFrame(unknown, sizeof(unknown), command, seq));
+    TEST_ASSERT_EQUAL(
+        FrameStatus::malformed,
+        decodeCommandFrame(missing, sizeof(missing), command, seq));
+}
+
+void test_SetValuesOutOfRange(void) {
+    // A single value beyond the range rejects all of them
+    const uint8_t frame[] = {Opcode::setValues, 0x03, 50, 0, 101, 0};
+    CommandValue command;
+    uint8_t seq = 0;
+    TEST_ASSERT_EQUAL(FrameStatus::outOfRange,
+                      decodeCommandFrame(frame, sizeof(frame), command, seq));
+    TEST_ASSERT_EQUAL(Commands::ignore, command.command);
+}
+
+void test_FineValues(void) {
+    // 0x13A1 = 5025, 50.25%
+    const uint8_t speed[] = {Opcode::fine | Opcode::setSpeed, 0xA1, 0x13};
+    CommandValue command;
+    uint8_t seq = 0;
+    TEST_ASSERT_EQUAL(FrameStatus::ok,
+                      decodeCommandFrame(speed, sizeof(speed), command, seq));
+    TEST_ASSERT_EQUAL(Commands::setSpeed, command.command);
+    TEST_ASSERT_EQUAL(5025, command.value);
+
+    // Stroke 99.99% and pattern 2 together, seq 3
+    const uint8_t values[] = {Opcode::fine | Opcode::setValues,
+                              (1 << setValueStroke) | (1 << setValuePattern),
+                              0x0F, 0x27, 0xC8, 0x00, 3};
+    TEST_ASSERT_EQUAL(FrameStatus::ok,
+                      decodeCommandFrame(values, sizeof(values), command, seq));
+    TEST_ASSERT_EQUAL(Commands::setValues, command.command);
+    TEST_ASSERT_EQUAL(9999, command.values[setValueStroke]);
+    TEST_ASSERT_EQUAL(200, command.values[setValuePattern]);
+    TEST_ASSERT_EQUAL(3, seq);
+}
+
+void test_FineOutOfRange(void) {
+    // 10001 and a pattern between two indices
+    const uint8_t depth[] = {Opcode::fine | Opcode::setDepth, 0x11, 0x27};
+    const uint8_t pattern[] = {Opcode::fine | Opcode::setPattern, 250, 0};
+    CommandValue command;
+    uint8_t seq = 0;
+    TEST_ASSERT_EQUAL(FrameStatus::outOfRange,
+                      decodeCommandFrame(depth, sizeof(depth), command, seq));
+    TEST_ASSERT_EQUAL(
+        FrameStatus::outOfRange,
+        decodeCommandFrame(pattern, sizeof(pattern), command, seq));
+    TEST_ASSERT_EQUAL(Commands::ignore, command.command);
+
+    // Only the set opcodes have a fine form
+    const uint8_t stream[] = {Opcode::fine | Opcode::streamPosition, 0, 0};
+    TEST_ASSERT_EQUAL(
+        FrameStatus::unknownOpcode,
+        decodeCommandFrame(stream, sizeof(stream), command, seq));
+}
+
+int runUnityTests() {
+    UNITY_BEGIN();
+    RUN_TEST(test_SetSpeed);
+    RUN_TEST(test_SequenceNumber);
+    RUN_TEST(test_GoTo);
+    RUN_TEST(test_StreamPosition);
+    RUN_TEST(test_Malformed);
+    RUN_TEST(test_UnknownOpcode);
+    RUN_TEST(test_OutOfRange);
+    RUN_TEST(test_SetValues);
+    RUN_TEST(test_SetValuesMalformed);
+    RUN_TEST(test_SetValuesOutOfRange);
+    RUN_TEST(test_FineValues);
+    RUN_TEST(test_FineOutOfRange);
+    return UNITY_END();
+}
+
+// WARNING!!! PLEASE REMOVE UNNECESSARY MAIN IMPLEMENTATIONS //
+
+/**
+ * For native dev-platform or for some embedded frameworks
+ */
+int main(void) { return runUnityTests(); }
@@ -0,0 +1,97 @@
+#include "unity.h"
+#include "utils/AccelerationGovernor.h"
+
+void setUp(void) {
+    // Set up before each test
+}
+
+void tearDown(void) {
+    // Clean up after each test
+}
+
+// Feeds count windows of the same current, returns the number of changes
+template <size_t Window>
+static int feed(AccelerationGovernor<Window> &governor, float current,
+                int windows) {
+    int changes = 0;
+    for (size_t i = 0; i < windows * Window; i++) {
+        changes += governor.update(current);
+    }
+    return changes;
+}
+
+void test_FullScaleWhileUnloaded(void) {
+    AccelerationGovernor<4> governor(3.0f, 2.0f, 0.5f, 3);
+    governor.reset();
+    TEST_ASSERT_EQUAL(0, feed(governor, 1.0f, 100));
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, governor.getScale());
+}
+
+void test_DeratesInProportionToTheLoad(void) {
+    AccelerationGovernor<4> governor(3.0f, 2.0f, 0.5f, 3);
+    governor.reset();
+
+    // 20% over the threshold
+    TEST_ASSERT_EQUAL(1, feed(governor, 3.6f, 1));
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 0.8f, governor.getScale());
+
+    // Still over it: keep going down, but not below the minimum
+    feed(governor, 3.6f, 1);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 0.65f, governor.getScale());
+    feed(governor, 10.0f, 10);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 0.5f, governor.getScale());
+}
+
+void test_JustOverTheThresholdTakesOneStep(void) {
+    AccelerationGovernor<4> governor(3.0f, 2.0f, 0.5f, 3);
+    governor.reset();
+    TEST_ASSERT_EQUAL(1, feed(governor, 3.01f, 1));
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 0.95f, governor.getScale());
+}
+
+void test_RestoresSlowlyOnceQuiet(void) {
+    AccelerationGovernor<4> governor(3.0f, 2.0f, 0.5f, 3);
+    governor.reset();
+    feed(governor, 6.0f, 1);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 0.5f, governor.getScale());
+
+    // Between the thresholds nothing changes
+    TEST_ASSERT_EQUAL(0, feed(governor, 2.5f, 20));
+
+    // One step per three quiet windows
+    TEST_ASSERT_EQUAL(0, feed(governor, 1.0f, 2));
+    TEST_ASSERT_EQUAL(1, feed(governor, 1.0f, 1));
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 0.55f, governor.getScale());
+
+    // A load in between starts the count over
+    feed(governor, 1.0f, 2);
+    feed(governor, 2.5f, 1);
+    TEST_ASSERT_EQUAL(0, feed(governor, 1.0f, 2));
+
+    feed(governor, 1.0f, 100);
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, governor.getScale());
+}
+
+void test_DisabledWithoutThreshold(void) {
+    AccelerationGovernor<4> governor(0.0f, 0.0f, 0.5f, 3);
+    governor.reset();
+    TEST_ASSERT_EQUAL(0, feed(governor, 50.0f, 10));
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, governor.getScale());
+}
+
+int runUnityTests() {
+    UNITY_BEGIN();
+    RUN_TEST(test_FullScaleWhileUnloaded);
+    RUN_TEST(test_DeratesInProportionToTheLoad);
+    RUN_TEST(test_JustOverTheThresholdTakesOneStep);
+    RUN_TEST(test_RestoresSlowlyOnceQuiet);
+    RUN_TEST(test_DisabledWithoutThreshold);
+    return UNITY_END();
+}
+
+// WARNING!!! PLEASE REMOVE UNNECESSARY MAIN IMPLEMENTATIONS //
+
+/**
+ * For native dev-platform or for some embedded frameworks
+ */
+int main(void) { return runUnityTests(); }
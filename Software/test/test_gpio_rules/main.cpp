@@ -0,0 +1,160 @@
+#include <cstring>
+#include <vector>
+
+#include "command/gpio.hpp"
+#include "unity.h"
+#include "utils/GpioRules.h"
+
+// 20 steps per mm, as on the simulated machine
+static const float stepsPerMm = 20.0;
+
+static GpioRule makeRule(uint8_t index, GpioTrigger trigger,
+                         GpioAction action, float positionMm = 0) {
+    GpioRule rule;
+    rule.index = index;
+    rule.trigger = trigger;
+    rule.action = action;
+    rule.positionMm = positionMm;
+    return rule;
+}
+
+void setUp(void) {
+    // Set up before each test
+}
+
+void tearDown(void) {
+    // Clean up after each test
+}
+
+void test_EmptyTable(void) {
+    GpioRuleTable<> table(stepsPerMm);
+    int fired = 0;
+    auto fire = [&](const GpioRule&) { fired++; };
+    table.finish(0, 1000, fire);
+    table.sample(0, fire);
+    table.sample(2000, fire);
+    TEST_ASSERT_TRUE(table.empty());
+    TEST_ASSERT_FALSE(table.hasThresholds());
+    TEST_ASSERT_EQUAL(0, fired);
+    TEST_ASSERT_FALSE(table.set(GPIO_RULE_COUNT, GpioRule()));
+}
+
+void test_DepthAndRetract(void) {
+    GpioRuleTable<> table(stepsPerMm);
+    table.set(0, makeRule(1, GpioTrigger::depth, GpioAction::high));
+    table.set(3, makeRule(2, GpioTrigger::retract, GpioAction::low));
+    TEST_ASSERT_FALSE(table.hasThresholds());
+
+    std::vector<int> fired;
+    auto fire = [&](const GpioRule& rule) { fired.push_back(rule.index); };
+    table.finish(100, 2000, fire);
+    table.finish(2000, 100, fire);
+    table.finish(100, 100, fire);
+    TEST_ASSERT_EQUAL(2, fired.size());
+    TEST_ASSERT_EQUAL(1, fired[0]);
+    TEST_ASSERT_EQUAL(2, fired[1]);
+
+    // Cleared slots stay quiet
+    table.set(0, GpioRule());
+    fired.clear();
+    table.finish(100, 2000, fire);
+    TEST_ASSERT_EQUAL(0, fired.size());
+}
+
+void test_CrossingsFollowTheDirection(void) {
+    GpioRuleTable<> table(stepsPerMm);
+    table.set(0, makeRule(1, GpioTrigger::inward, GpioAction::pulse, 50.0));
+    table.set(1, makeRule(2, GpioTrigger::outward, GpioAction::low, 50.0));
+    TEST_ASSERT_TRUE(table.hasThresholds());
+
+    std::vector<int> fired;
+    auto fire = [&](const GpioRule& rule) { fired.push_back(rule.index); };
+
+    // The first sample only sets the start, even beyond the threshold
+    table.sample(1500, fire);
+    TEST_ASSERT_EQUAL(0, fired.size());
+
+    // Out across 1000 steps, back in onto it exactly, then standing there
+    table.sample(1001, fire);
+    table.sample(990, fire);
+    TEST_ASSERT_EQUAL(1, fired.size());
+    TEST_ASSERT_EQUAL(2, fired[0]);
+    table.sample(1000, fire);
+    table.sample(1000, fire);
+    table.sample(1010, fire);
+    TEST_ASSERT_EQUAL(2, fired.size());
+    TEST_ASSERT_EQUAL(1, fired[1]);
+
+    // Reaching it from deeper crosses out, leaving it again fires nothing
+    table.sample(1000, fire);
+    TEST_ASSERT_EQUAL(3, fired.size());
+    table.sample(999, fire);
+    TEST_ASSERT_EQUAL(3, fired.size());
+}
+
+void test_ResetForgetsPosition(void) {
+    GpioRuleTable<> table(stepsPerMm);
+    table.set(0, makeRule(1, GpioTrigger::inward, GpioAction::high, 10.0));
+    int fired = 0;
+    auto fire = [&](const GpioRule&) { fired++; };
+    table.sample(0, fire);
+    table.resetPosition();
+    table.sample(400, fire);
+    TEST_ASSERT_EQUAL(0, fired);
+    table.sample(100, fire);
+    table.sample(300, fire);
+    TEST_ASSERT_EQUAL(1, fired);
+}
+
+void test_ParseRules(void) {
+    int slot = -1;
+    GpioRule rule;
+    const char* depth = "rule:0:2:depth:pulse:20";
+    TEST_ASSERT_TRUE(parseGpioRule(depth, strlen(depth), slot, rule));
+    TEST_ASSERT_EQUAL(0, slot);
+    TEST_ASSERT_EQUAL(2, rule.index);
+    TEST_ASSERT_TRUE(rule.trigger == GpioTrigger::depth);
+    TEST_ASSERT_TRUE(rule.action == GpioAction::pulse);
+    TEST_ASSERT_EQUAL(20, rule.pulseMs);
+
+    const char* crossing = "rule:7:4:out:72.5:toggle";
+    TEST_ASSERT_TRUE(parseGpioRule(crossing, strlen(crossing), slot, rule));
+    TEST_ASSERT_EQUAL(7, slot);
+    TEST_ASSERT_TRUE(rule.trigger == GpioTrigger::outward);
+    TEST_ASSERT_TRUE(rule.action == GpioAction::toggle);
+    TEST_ASSERT_EQUAL_FLOAT(72.5, rule.positionMm);
+
+    const char* off = "rule:3:off";
+    TEST_ASSERT_TRUE(parseGpioRule(off, strlen(off), slot, rule));
+    TEST_ASSERT_EQUAL(3, slot);
+    TEST_ASSERT_EQUAL(0, rule.index);
+
+    const char* invalid[] = {"rule:8:1:depth:high",   "rule:0:5:depth:high",
+                             "rule:0:0:depth:high",   "rule:0:1:in:high",
+                             "rule:0:1:depth:pulse",  "rule:0:1:depth:pulse:0",
+                             "rule:0:1:depth:high:5", "rule:0:1:in:1000.5:low",
+                             "rule:0:1:depth",        "rule:0:offx",
+                             "rule::1:depth:high",    "1:high"};
+    for (const char* str : invalid) {
+        slot = -1;
+        TEST_ASSERT_FALSE(parseGpioRule(str, strlen(str), slot, rule));
+        TEST_ASSERT_EQUAL(-1, slot);
+    }
+}
+
+int runUnityTests(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_EmptyTable);
+    RUN_TEST(test_DepthAndRetract);
+    RUN_TEST(test_CrossingsFollowTheDirection);
+    RUN_TEST(test_ResetForgetsPosition);
+    RUN_TEST(test_ParseRules);
+    return UNITY_END();
+}
+
+// WARNING!!! PLEASE REMOVE UNNECESSARY MAIN IMPLEMENTATIONS //
+
+/**
+ * For native dev-platform or for some embedded frameworks
+ */
+int main(void) { return runUnityTests(); }
@@ -0,0 +1,102 @@
+#include "unity.h"
+#include "utils/HeapTrend.h"
+
+void setUp(void) {
+    // Set up before each test
+}
+
+void tearDown(void) {
+    // Clean up after each test
+}
+
+void test_Fragmentation(void) {
+    TEST_ASSERT_EQUAL(0, fragmentationOf(0, 0));
+    TEST_ASSERT_EQUAL(0, fragmentationOf(100000, 100000));
+    TEST_ASSERT_EQUAL(75, fragmentationOf(100000, 25000));
+    TEST_ASSERT_EQUAL(100, fragmentationOf(100000, 0));
+}
+
+void test_FragmentedClearsWithMargin(void) {
+    HeapTrend trend(60, 16384, 60, 5);
+    TEST_ASSERT_EQUAL(0, trend.add(100000, 50000));
+    TEST_ASSERT_EQUAL(HeapAlert::fragmented, trend.add(100000, 40000));
+    TEST_ASSERT_EQUAL(60, trend.getFragmentation());
+
+    // Hovering around the limit raises it only once
+    TEST_ASSERT_EQUAL(0, trend.add(100000, 45000));
+    TEST_ASSERT_EQUAL(0, trend.add(100000, 40000));
+    TEST_ASSERT_EQUAL(HeapAlert::fragmented, trend.getAlerts());
+
+    TEST_ASSERT_EQUAL(0, trend.add(100000, 51000));
+    TEST_ASSERT_EQUAL(0, trend.getAlerts());
+    TEST_ASSERT_EQUAL(60, trend.getPeakFragmentation());
+}
+
+void test_LowBlockClearsWithMargin(void) {
+    HeapTrend trend(60, 16000, 60, 5);
+    TEST_ASSERT_EQUAL(HeapAlert::lowBlock, trend.add(20000, 15000));
+    TEST_ASSERT_EQUAL(0, trend.add(20000, 19000));
+    TEST_ASSERT_EQUAL(HeapAlert::lowBlock, trend.getAlerts());
+    TEST_ASSERT_EQUAL(0, trend.add(20000, 20000));
+    TEST_ASSERT_EQUAL(0, trend.getAlerts());
+}
+
+void test_ShrinkingAfterPeriodsInARow(void) {
+    HeapTrend trend(90, 1000, 4, 3);
+    uint32_t largest = 80000;
+    uint8_t raised = 0;
+    int samples = 0;
+    // The first period only sets the baseline, three lower ones raise it
+    while (raised == 0 && samples < 100) {
+        raised = trend.add(100000, largest);
+        if (++samples % 4 == 0) {
+            largest -= 1000;
+        }
+    }
+    TEST_ASSERT_EQUAL(HeapAlert::shrinking, raised);
+    TEST_ASSERT_EQUAL(16, samples);
+    TEST_ASSERT_EQUAL(3, trend.getShrinkRun());
+
+    // A period that holds its minimum ends the run
+    for (int i = 0; i < 4; i++) {
+        trend.add(100000, largest + 1000);
+    }
+    TEST_ASSERT_EQUAL(0, trend.getShrinkRun());
+    TEST_ASSERT_EQUAL(0, trend.getAlerts());
+}
+
+void test_BudgetRefusesWhatDoesNotFit(void) {
+    MemoryBudget budget(1000);
+    TEST_ASSERT_TRUE(budget.reserve(600));
+    TEST_ASSERT_FALSE(budget.reserve(500));
+    TEST_ASSERT_EQUAL(1, budget.getFailures());
+    TEST_ASSERT_TRUE(budget.reserve(400));
+    TEST_ASSERT_EQUAL(1000, budget.getUsed());
+
+    budget.release(600);
+    TEST_ASSERT_EQUAL(400, budget.getUsed());
+    TEST_ASSERT_EQUAL(1000, budget.getPeak());
+
+    // Releasing more than is used stops at 0
+    budget.release(1000);
+    TEST_ASSERT_EQUAL(0, budget.getUsed());
+    budget.fail();
+    TEST_ASSERT_EQUAL(2, budget.getFailures());
+}
+
+int runUnityTests(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_Fragmentation);
+    RUN_TEST(test_FragmentedClearsWithMargin);
+    RUN_TEST(test_LowBlockClearsWithMargin);
+    RUN_TEST(test_ShrinkingAfterPeriodsInARow);
+    RUN_TEST(test_BudgetRefusesWhatDoesNotFit);
+    return UNITY_END();
+}
+
+// WARNING!!! PLEASE REMOVE UNNECESSARY MAIN IMPLEMENTATIONS //
+
+/**
+ * For native dev-platform or for some embedded frameworks
+ */
+int main(void) { return runUnityTests(); }
@@ -0,0 +1,125 @@
+#include "Keyframes.h"
+#include "pattern.h"
+#include "unity.h"
+
+void setUp(void) {
+    // Set up before each test
+}
+
+void tearDown(void) {
+    // Clean up after each test
+}
+
+void test_DecodesPoints(void) {
+    const uint8_t data[] = {1, 3, 100, 0, 1, 0, 50, 20, 0, 1, 0, 25, 2, 1};
+    KeyframeTable table;
+    TEST_ASSERT_TRUE(decodeKeyframes(data, sizeof(data), table));
+    TEST_ASSERT_EQUAL(3, table.count);
+    TEST_ASSERT_EQUAL(100, table.points[0].position);
+    TEST_ASSERT_EQUAL(0, table.points[0].accel);
+    TEST_ASSERT_EQUAL(1, table.points[0].time);
+    TEST_ASSERT_EQUAL(20, table.points[1].accel);
+    TEST_ASSERT_EQUAL(256, table.points[1].time);
+    TEST_ASSERT_EQUAL(0, table.points[2].position);
+    TEST_ASSERT_EQUAL(258, table.points[2].time);
+}
+
+void test_RejectsInvalidTables(void) {
+    KeyframeTable table = defaultKeyframes();
+    const uint8_t version[] = {2, 2, 100, 0, 1, 0, 0, 0, 1, 0};
+    const uint8_t tooFew[] = {1, 1, 100, 0, 1, 0};
+    const uint8_t truncated[] = {1, 2, 100, 0, 1, 0, 0, 0, 1};
+    const uint8_t position[] = {1, 2, 101, 0, 1, 0, 0, 0, 1, 0};
+    const uint8_t accel[] = {1, 2, 100, 51, 1, 0, 0, 0, 1, 0};
+    const uint8_t time[] = {1, 2, 100, 0, 0, 0, 0, 0, 1, 0};
+
+    TEST_ASSERT_FALSE(decodeKeyframes(version, sizeof(version), table));
+    TEST_ASSERT_FALSE(decodeKeyframes(tooFew, sizeof(tooFew), table));
+    TEST_ASSERT_FALSE(decodeKeyframes(truncated, sizeof(truncated), table));
+    TEST_ASSERT_FALSE(decodeKeyframes(position, sizeof(position), table));
+    TEST_ASSERT_FALSE(decodeKeyframes(accel, sizeof(accel), table));
+    TEST_ASSERT_FALSE(decodeKeyframes(time, sizeof(time), table));
+    TEST_ASSERT_FALSE(decodeKeyframes(version, 0, table));
+
+    // Left as it was
+    TEST_ASSERT_EQUAL(2, table.count);
+    TEST_ASSERT_EQUAL(100, table.points[0].position);
+}
+
+void test_DefaultMatchesSimpleStroke(void) {
+    SimpleStroke simple("Simple Stroke");
+    TablePattern custom("Custom");
+
+    for (int stroke = 100; stroke <= 4000; stroke += 390) {
+        for (float speed = 0.2; speed < 30.0; speed *= 1.37) {
+            simple.setTimeOfStroke(speed);
+            simple.setStroke(stroke);
+            simple.setDepth(5000);
+            custom.setTimeOfStroke(speed);
+            custom.setStroke(stroke);
+            custom.setDepth(5000);
+
+            for (int index = 0; index < 4; index++) {
+                motionParameter expected = simple.nextTarget(index);
+                motionParameter actual = custom.nextTarget(index);
+                TEST_ASSERT_EQUAL(expected.stroke, actual.stroke);
+                TEST_ASSERT_TRUE(abs(expected.speed - actual.speed) <= 1);
+                TEST_ASSERT_TRUE(
+                    abs(expected.acceleration - actual.acceleration) <= 4);
+                TEST_ASSERT_FALSE(actual.skip);
+            }
+        }
+    }
+}
+
+void test_PlaysUploadedTable(void) {
+    // A quick half stroke in, the rest of the way in, all the way out slowly
+    const uint8_t data[] = {1, 3, 50, 25, 1, 0, 100, 0, 1, 0, 0, 50, 2, 0};
+    KeyframeTable table;
+    TEST_ASSERT_TRUE(decodeKeyframes(data, sizeof(data), table));
+
+    TablePattern custom("Custom");
+    custom.setTimeOfStroke(2.0);
+    custom.setStroke(1000);
+    custom.setDepth(3000);
+    custom.setKeyframes(table);
+
+    // 0.5s for 500 steps, a quarter of the time accelerating
+    motionParameter move = custom.nextTarget(0);
+    TEST_ASSERT_EQUAL(2500, move.stroke);
+    TEST_ASSERT_EQUAL(1333, move.speed);
+    TEST_ASSERT_EQUAL(10664, move.acceleration);
+
+    move = custom.nextTarget(1);
+    TEST_ASSERT_EQUAL(3000, move.stroke);
+
+    // 1s for 1000 steps, half of it accelerating
+    move = custom.nextTarget(2);
+    TEST_ASSERT_EQUAL(2000, move.stroke);
+    TEST_ASSERT_EQUAL(2000, move.speed);
+    TEST_ASSERT_EQUAL(4000, move.acceleration);
+
+    // Wraps around to the first point
+    TEST_ASSERT_EQUAL(2500, custom.nextTarget(3).stroke);
+
+    // Follows the stroke without another upload
+    custom.setStroke(500);
+    TEST_ASSERT_EQUAL(2750, custom.nextTarget(0).stroke);
+    TEST_ASSERT_EQUAL(2500, custom.nextTarget(2).stroke);
+}
+
+int runUnityTests() {
+    UNITY_BEGIN();
+    RUN_TEST(test_DecodesPoints);
+    RUN_TEST(test_RejectsInvalidTables);
+    RUN_TEST(test_DefaultMatchesSimpleStroke);
+    RUN_TEST(test_PlaysUploadedTable);
+    return UNITY_END();
+}
+
+// WARNING!!! PLEASE REMOVE UNNECESSARY MAIN IMPLEMENTATIONS //
+
+/**
+ * For native dev-platform or for some embedded frameworks
+ */
+int main(void) { return runUnityTests(); }
@@ -0,0 +1,79 @@
+#include "unity.h"
+#include "utils/LatencyProbe.h"
+
+void setUp(void) {
+    // Set up before each test
+}
+
+void tearDown(void) {
+    // Clean up after each test
+}
+
+void test_StagesAreRelativeToReceived(void) {
+    LatencyProbe probe;
+    TEST_ASSERT_TRUE(probe.begin(7, 1000));
+    TEST_ASSERT_TRUE(probe.mark(LatencyStage::dispatched, 1300));
+    TEST_ASSERT_TRUE(probe.mark(LatencyStage::applied, 5000));
+    TEST_ASSERT_TRUE(probe.mark(LatencyStage::moving, 5250));
+
+    LatencyRecord record = probe.finish();
+    TEST_ASSERT_EQUAL(7, record.seq);
+    TEST_ASSERT_EQUAL(0x0F, record.stages);
+    TEST_ASSERT_EQUAL(1000, record.receivedUs);
+    TEST_ASSERT_EQUAL(300, record.dispatchedUs);
+    TEST_ASSERT_EQUAL(4000, record.appliedUs);
+    TEST_ASSERT_EQUAL(4250, record.movingUs);
+    TEST_ASSERT_FALSE(probe.isActive());
+}
+
+void test_StagesKeepTheirOrder(void) {
+    LatencyProbe probe;
+    probe.begin(1, 0);
+
+    // A move planned before the command got dispatched doesn't count
+    TEST_ASSERT_FALSE(probe.mark(LatencyStage::applied, 100));
+    TEST_ASSERT_TRUE(probe.mark(LatencyStage::dispatched, 200));
+    TEST_ASSERT_FALSE(probe.mark(LatencyStage::dispatched, 300));
+    TEST_ASSERT_TRUE(probe.mark(LatencyStage::applied, 400));
+
+    LatencyRecord record = probe.finish();
+    TEST_ASSERT_EQUAL(0x07, record.stages);
+    TEST_ASSERT_EQUAL(200, record.dispatchedUs);
+    TEST_ASSERT_EQUAL(400, record.appliedUs);
+    TEST_ASSERT_EQUAL(0, record.movingUs);
+}
+
+void test_OneCommandAtATime(void) {
+    LatencyProbe probe;
+    TEST_ASSERT_FALSE(probe.mark(LatencyStage::dispatched, 10));
+    TEST_ASSERT_TRUE(probe.begin(1, 0));
+    TEST_ASSERT_FALSE(probe.begin(2, 50));
+
+    probe.finish();
+    TEST_ASSERT_TRUE(probe.begin(3, 100));
+    TEST_ASSERT_EQUAL(3, probe.finish().seq);
+}
+
+void test_ElapsedWrapsAround(void) {
+    LatencyProbe probe;
+    probe.begin(1, 0xFFFFFF00);
+    TEST_ASSERT_EQUAL(0x200, probe.elapsed(0x100));
+    TEST_ASSERT_TRUE(probe.mark(LatencyStage::dispatched, 0x100));
+    TEST_ASSERT_EQUAL(0x200, probe.finish().dispatchedUs);
+}
+
+int runUnityTests() {
+    UNITY_BEGIN();
+    RUN_TEST(test_StagesAreRelativeToReceived);
+    RUN_TEST(test_StagesKeepTheirOrder);
+    RUN_TEST(test_OneCommandAtATime);
+    RUN_TEST(test_ElapsedWrapsAround);
+    return UNITY_END();
+}
+
+// WARNING!!! PLEASE REMOVE UNNECESSARY MAIN IMPLEMENTATIONS //
+
+/**
+ * For native dev-platform or for some embedded frameworks
+ */
+int main(void) { return runUnityTests(); }
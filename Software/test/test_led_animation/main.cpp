@@ -0,0 +1,88 @@
+#include "unity.h"
+#include "utils/LedAnimation.h"
+
+void setUp(void) {
+    // Set up before each test
+}
+
+void tearDown(void) {
+    // Clean up after each test
+}
+
+static LedAnimation animation(LedEffect effect, uint16_t periodMs,
+                              uint8_t from, uint8_t to) {
+    LedAnimation a;
+    a.effect = effect;
+    a.color = 0x0000FF;
+    a.periodMs = periodMs;
+    a.from = from;
+    a.to = to;
+    a.startMs = 1000;
+    return a;
+}
+
+void test_SolidKeepsColor(void) {
+    LedFrame frame =
+        renderLedAnimation(animation(LedEffect::solid, 0, 0, 200), 5000);
+    TEST_ASSERT_EQUAL_HEX32(0x0000FF, frame.color);
+    TEST_ASSERT_FALSE(frame.isHue);
+    TEST_ASSERT_EQUAL(200, frame.level);
+}
+
+void test_BreatheGoesUpAndDown(void) {
+    LedAnimation a = animation(LedEffect::breathe, 1000, 30, 230);
+    TEST_ASSERT_EQUAL(30, renderLedAnimation(a, 1000).level);
+    TEST_ASSERT_EQUAL(130, renderLedAnimation(a, 1250).level);
+    TEST_ASSERT_EQUAL(230, renderLedAnimation(a, 1500).level);
+    TEST_ASSERT_EQUAL(130, renderLedAnimation(a, 1750).level);
+    // Next cycle
+    TEST_ASSERT_EQUAL(30, renderLedAnimation(a, 3000).level);
+}
+
+void test_FadeHoldsTheEnd(void) {
+    LedAnimation a = animation(LedEffect::fade, 2000, 255, 30);
+    TEST_ASSERT_EQUAL(255, renderLedAnimation(a, 1000).level);
+    TEST_ASSERT_EQUAL(143, renderLedAnimation(a, 2000).level);
+    TEST_ASSERT_EQUAL(30, renderLedAnimation(a, 3000).level);
+    TEST_ASSERT_EQUAL(30, renderLedAnimation(a, 90000).level);
+}
+
+void test_RainbowCyclesHue(void) {
+    LedAnimation a = animation(LedEffect::rainbow, 1000, 0, 255);
+    LedFrame frame = renderLedAnimation(a, 1500);
+    TEST_ASSERT_TRUE(frame.isHue);
+    TEST_ASSERT_EQUAL(128, frame.hue);
+    TEST_ASSERT_EQUAL(0, renderLedAnimation(a, 2000).hue);
+}
+
+void test_SameTimeSameFrame(void) {
+    LedAnimation a = animation(LedEffect::breathe, 1000, 0, 255);
+    TEST_ASSERT_TRUE(renderLedAnimation(a, 1300) == renderLedAnimation(a, 1300));
+    TEST_ASSERT_TRUE(renderLedAnimation(a, 1100) != renderLedAnimation(a, 1300));
+}
+
+void test_Duration(void) {
+    LedAnimation a = animation(LedEffect::solid, 0, 0, 255);
+    TEST_ASSERT_FALSE(a.isDone(1000000));
+    a.durationMs = 500;
+    TEST_ASSERT_FALSE(a.isDone(1499));
+    TEST_ASSERT_TRUE(a.isDone(1500));
+}
+
+int runUnityTests() {
+    UNITY_BEGIN();
+    RUN_TEST(test_SolidKeepsColor);
+    RUN_TEST(test_BreatheGoesUpAndDown);
+    RUN_TEST(test_FadeHoldsTheEnd);
+    RUN_TEST(test_RainbowCyclesHue);
+    RUN_TEST(test_SameTimeSameFrame);
+    RUN_TEST(test_Duration);
+    return UNITY_END();
+}
+
+// WARNING!!! PLEASE REMOVE UNNECESSARY MAIN IMPLEMENTATIONS //
+
+/**
+ * For native dev-platform or for some embedded frameworks
+ */
+int main(void) { return runUnityTests(); }
@@ -0,0 +1,100 @@
+#include "unity.h"
+#include "utils/LimitSearch.h"
+
+static const MachineLimits start = {200.0f, 5000.0f};
+static const MachineLimits ceiling = {1000.0f, 40000.0f};
+
+void setUp(void) {
+    // Set up before each test
+}
+
+void tearDown(void) {
+    // Clean up after each test
+}
+
+// Runs the search against a machine that is reliable up to machine
+static LimitSearch searchUpTo(const MachineLimits &machine) {
+    LimitSearch search(start, ceiling, 1.2f, 2, 0.8f);
+    while (!search.isDone()) {
+        const MachineLimits &trial = search.next();
+        search.report(
+            trial.maxSpeedMmPerSecond <= machine.maxSpeedMmPerSecond &&
+            trial.maxAcceleration <= machine.maxAcceleration);
+    }
+    return search;
+}
+
+void test_FindsTheLimitsWithMargin(void) {
+    LimitSearch search = searchUpTo({500.0f, 12000.0f});
+    TEST_ASSERT_TRUE(search.hasResult());
+
+    // 200 * 1.2^5 was the fastest trial, the bisections above it failed
+    MachineLimits result = search.result();
+    TEST_ASSERT_FLOAT_WITHIN(0.1f, 0.8f * 497.664f,
+                             result.maxSpeedMmPerSecond);
+    // 12441.6 failed, the bisections below it held
+    TEST_ASSERT_FLOAT_WITHIN(1.0f, 0.8f * 11923.2f, result.maxAcceleration);
+    TEST_ASSERT_EQUAL(9 + 7, search.getTrials());
+}
+
+void test_SpeedIsSearchedFirst(void) {
+    LimitSearch search(start, ceiling, 1.2f, 2, 0.8f);
+    TEST_ASSERT_EQUAL((int)LimitSearch::Phase::speed, (int)search.getPhase());
+    search.report(true);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 240.0f, search.next().maxSpeedMmPerSecond);
+    TEST_ASSERT_EQUAL_FLOAT(5000.0f, search.next().maxAcceleration);
+
+    // The first failure bisects
+    search.report(false);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 220.0f, search.next().maxSpeedMmPerSecond);
+    search.report(true);
+    search.report(true);
+
+    // The acceleration phase runs at the fastest reliable speed
+    TEST_ASSERT_EQUAL((int)LimitSearch::Phase::acceleration,
+                      (int)search.getPhase());
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 230.0f, search.next().maxSpeedMmPerSecond);
+    TEST_ASSERT_FLOAT_WITHIN(0.1f, 6000.0f, search.next().maxAcceleration);
+}
+
+void test_StopsAtTheCeiling(void) {
+    LimitSearch search = searchUpTo({5000.0f, 100000.0f});
+    TEST_ASSERT_TRUE(search.hasResult());
+    TEST_ASSERT_EQUAL_FLOAT(800.0f, search.result().maxSpeedMmPerSecond);
+    TEST_ASSERT_EQUAL_FLOAT(32000.0f, search.result().maxAcceleration);
+}
+
+void test_UnreliableStartHasNoResult(void) {
+    LimitSearch search = searchUpTo({100.0f, 1000.0f});
+    TEST_ASSERT_TRUE(search.isDone());
+    TEST_ASSERT_FALSE(search.hasResult());
+    TEST_ASSERT_EQUAL(1, search.getTrials());
+}
+
+void test_StoredLimits(void) {
+    MachineLimits floor = {160.0f, 4000.0f};
+    TEST_ASSERT_TRUE(MachineLimits({400.0f, 9000.0f}).isValid(floor, ceiling));
+    TEST_ASSERT_FALSE(MachineLimits({0.0f, 0.0f}).isValid(floor, ceiling));
+    TEST_ASSERT_FALSE(
+        MachineLimits({1200.0f, 9000.0f}).isValid(floor, ceiling));
+
+    // A stroke of 200mm at 5000mm/s² peaks at 1000mm/s
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 1000.0f, reachableSpeed(5000.0f, 200.0f));
+}
+
+int runUnityTests(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_FindsTheLimitsWithMargin);
+    RUN_TEST(test_SpeedIsSearchedFirst);
+    RUN_TEST(test_StopsAtTheCeiling);
+    RUN_TEST(test_UnreliableStartHasNoResult);
+    RUN_TEST(test_StoredLimits);
+    return UNITY_END();
+}
+
+// WARNING!!! PLEASE REMOVE UNNECESSARY MAIN IMPLEMENTATIONS //
+
+/**
+ * For native dev-platform or for some embedded frameworks
+ */
+int main(void) { return runUnityTests(); }
@@ -0,0 +1,128 @@
+#include <cstring>
+
+#include "unity.h"
+#include "utils/LogRing.h"
+
+void setUp(void) {
+    // Set up before each test
+}
+
+void tearDown(void) {
+    // Clean up after each test
+}
+
+void test_EmptyRing(void) {
+    LogRing<64> ring;
+    uint8_t type = 0;
+    char payload[16];
+    TEST_ASSERT_TRUE(ring.empty());
+    TEST_ASSERT_EQUAL(-1, ring.pop(type, payload, sizeof(payload)));
+}
+
+void test_RecordsInOrder(void) {
+    LogRing<64> ring;
+    uint32_t trace = 0x12345678;
+    TEST_ASSERT_TRUE(ring.push(0, "first", 5));
+    TEST_ASSERT_TRUE(ring.push(1, &trace, sizeof(trace)));
+    TEST_ASSERT_TRUE(ring.push(0, "", 0));
+    TEST_ASSERT_EQUAL(3 * 3 + 5 + 4, ring.used());
+
+    uint8_t type = 0xFF;
+    char payload[16];
+    TEST_ASSERT_EQUAL(5, ring.pop(type, payload, sizeof(payload)));
+    TEST_ASSERT_EQUAL(0, type);
+    TEST_ASSERT_EQUAL_MEMORY("first", payload, 5);
+
+    uint32_t popped = 0;
+    TEST_ASSERT_EQUAL(4, ring.pop(type, &popped, sizeof(popped)));
+    TEST_ASSERT_EQUAL(1, type);
+    TEST_ASSERT_EQUAL_HEX32(trace, popped);
+
+    TEST_ASSERT_EQUAL(0, ring.pop(type, payload, sizeof(payload)));
+    TEST_ASSERT_TRUE(ring.empty());
+}
+
+void test_FullRingDropsNewRecords(void) {
+    LogRing<16> ring;
+    TEST_ASSERT_TRUE(ring.push(0, "01234567", 8));
+    TEST_ASSERT_FALSE(ring.push(0, "abcd", 4));
+    TEST_ASSERT_TRUE(ring.push(0, "ab", 2));
+    TEST_ASSERT_FALSE(ring.push(0, "", 0));
+    TEST_ASSERT_EQUAL(2, ring.getDroppedCount());
+
+    // Too large for an empty ring as well
+    LogRing<16> empty;
+    char large[16] = {};
+    TEST_ASSERT_FALSE(empty.push(0, large, sizeof(large)));
+    TEST_ASSERT_TRUE(empty.empty());
+
+    uint8_t type = 0;
+    char payload[16];
+    TEST_ASSERT_EQUAL(8, ring.pop(type, payload, sizeof(payload)));
+    TEST_ASSERT_EQUAL_MEMORY("01234567", payload, 8);
+    TEST_ASSERT_EQUAL(2, ring.pop(type, payload, sizeof(payload)));
+    TEST_ASSERT_EQUAL_MEMORY("ab", payload, 2);
+}
+
+void test_LongRecordIsTruncated(void) {
+    LogRing<64> ring;
+    ring.push(0, "truncated", 9);
+    ring.push(2, "next", 4);
+
+    uint8_t type = 0;
+    char payload[8];
+    TEST_ASSERT_EQUAL(5, ring.pop(type, payload, 5));
+    TEST_ASSERT_EQUAL_MEMORY("trunc", payload, 5);
+
+    // The rest of the long record is skipped
+    TEST_ASSERT_EQUAL(4, ring.pop(type, payload, sizeof(payload)));
+    TEST_ASSERT_EQUAL(2, type);
+    TEST_ASSERT_EQUAL_MEMORY("next", payload, 4);
+    TEST_ASSERT_TRUE(ring.empty());
+}
+
+void test_WrapAround(void) {
+    LogRing<32> ring;
+    uint8_t type = 0;
+    char payload[16];
+    for (int i = 0; i < 200; i++) {
+        char record[8];
+        int length = snprintf(record, sizeof(record), "r%d", i);
+        TEST_ASSERT_TRUE(ring.push(i & 0xFF, record, length));
+
+        // Let a few records pile up, so they wrap at varying offsets
+        while (ring.used() > 16) {
+            TEST_ASSERT_GREATER_THAN(0, ring.pop(type, payload, 16));
+        }
+    }
+
+    // Whatever is left comes out whole and in order
+    int last = -1;
+    int popped;
+    while ((popped = ring.pop(type, payload, sizeof(payload) - 1)) >= 0) {
+        payload[popped] = 0;
+        int index = atoi(payload + 1);
+        TEST_ASSERT_EQUAL(index & 0xFF, type);
+        TEST_ASSERT_GREATER_THAN(last, index);
+        last = index;
+    }
+    TEST_ASSERT_EQUAL(199, last);
+    TEST_ASSERT_EQUAL(0, ring.getDroppedCount());
+}
+
+int runUnityTests(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_EmptyRing);
+    RUN_TEST(test_RecordsInOrder);
+    RUN_TEST(test_FullRingDropsNewRecords);
+    RUN_TEST(test_LongRecordIsTruncated);
+    RUN_TEST(test_WrapAround);
+    return UNITY_END();
+}
+
+// WARNING!!! PLEASE REMOVE UNNECESSARY MAIN IMPLEMENTATIONS //
+
+/**
+ * For native dev-platform or for some embedded frameworks
+ */
+int main(void) { return runUnityTests(); }
@@ -0,0 +1,120 @@
+#include <thread>
+#include <vector>
+
+#include "unity.h"
+#include "utils/MpscRing.h"
+
+void setUp(void) {
+    // Set up before each test
+}
+
+void tearDown(void) {
+    // Clean up after each test
+}
+
+void test_FirstInFirstOut(void) {
+    MpscRing<int, 4> ring;
+    int item = 0;
+    TEST_ASSERT_TRUE(ring.empty());
+    TEST_ASSERT_FALSE(ring.pop(item));
+
+    TEST_ASSERT_TRUE(ring.push(1));
+    TEST_ASSERT_TRUE(ring.push(2));
+    TEST_ASSERT_TRUE(ring.push(3));
+    TEST_ASSERT_EQUAL(3, ring.size());
+
+    TEST_ASSERT_TRUE(ring.pop(item));
+    TEST_ASSERT_EQUAL(1, item);
+    TEST_ASSERT_TRUE(ring.pop(item));
+    TEST_ASSERT_EQUAL(2, item);
+    TEST_ASSERT_TRUE(ring.pop(item));
+    TEST_ASSERT_EQUAL(3, item);
+    TEST_ASSERT_TRUE(ring.empty());
+}
+
+void test_OverflowKeepsTheOldest(void) {
+    MpscRing<int, 2> ring;
+    int item = 0;
+    TEST_ASSERT_TRUE(ring.push(1));
+    TEST_ASSERT_TRUE(ring.push(2));
+    TEST_ASSERT_FALSE(ring.push(3));
+    TEST_ASSERT_EQUAL(1, ring.getOverflowCount());
+
+    TEST_ASSERT_TRUE(ring.pop(item));
+    TEST_ASSERT_EQUAL(1, item);
+    TEST_ASSERT_TRUE(ring.push(4));
+    TEST_ASSERT_TRUE(ring.pop(item));
+    TEST_ASSERT_EQUAL(2, item);
+    TEST_ASSERT_TRUE(ring.pop(item));
+    TEST_ASSERT_EQUAL(4, item);
+}
+
+void test_WrapAround(void) {
+    MpscRing<int, 4> ring;
+    int item = 0;
+    for (int i = 0; i < 100; i++) {
+        TEST_ASSERT_TRUE(ring.push(i));
+        TEST_ASSERT_TRUE(ring.pop(item));
+        TEST_ASSERT_EQUAL(i, item);
+    }
+    TEST_ASSERT_TRUE(ring.empty());
+}
+
+void test_ProducersNeverLoseItems(void) {
+    // Every producer pushes its id and a counter, the consumer sees each
+    // producer's items complete and in order
+    const int producers = 4;
+    const int perProducer = 20000;
+    MpscRing<int, 16> ring;
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; p++) {
+        threads.emplace_back([&ring, p]() {
+            for (int i = 0; i < perProducer; i++) {
+                while (!ring.push(p * perProducer + i)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    int next[producers] = {};
+    int received = 0;
+    bool isOrdered = true;
+    while (received < producers * perProducer) {
+        int item;
+        if (!ring.pop(item)) {
+            std::this_thread::yield();
+            continue;
+        }
+        int p = item / perProducer;
+        isOrdered = isOrdered && item % perProducer == next[p];
+        next[p]++;
+        received++;
+    }
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+
+    TEST_ASSERT_TRUE(isOrdered);
+    TEST_ASSERT_TRUE(ring.empty());
+    for (int p = 0; p < producers; p++) {
+        TEST_ASSERT_EQUAL(perProducer, next[p]);
+    }
+}
+
+int runUnityTests(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_FirstInFirstOut);
+    RUN_TEST(test_OverflowKeepsTheOldest);
+    RUN_TEST(test_WrapAround);
+    RUN_TEST(test_ProducersNeverLoseItems);
+    return UNITY_END();
+}
+
+// WARNING!!! PLEASE REMOVE UNNECESSARY MAIN IMPLEMENTATIONS //
+
+/**
+ * For native dev-platform or for some embedded frameworks
+ */
+int main(void) { return runUnityTests(); }
@@ -0,0 +1,99 @@
+#include "unity.h"
+#include "utils/OtaImage.h"
+
+#define PARTITION_SIZE 0x1E0000
+
+void setUp(void) {
+    // Set up before each test
+}
+
+void tearDown(void) {
+    // Clean up after each test
+}
+
+static OtaImageHeader makeHeader(uint32_t imageSize) {
+    OtaImageHeader header = {};
+    memcpy(header.magic, OTA_IMAGE_MAGIC, 4);
+    header.imageSize = imageSize;
+    header.chunkSize = OTA_CHUNK_SIZE;
+    header.chunkCount = (imageSize + OTA_CHUNK_SIZE - 1) / OTA_CHUNK_SIZE;
+    return header;
+}
+
+void test_AcceptsValidHeader(void) {
+    OtaImageHeader header = makeHeader(3 * OTA_CHUNK_SIZE + 100);
+    TEST_ASSERT_EQUAL(4, header.chunkCount);
+    TEST_ASSERT_TRUE(isValidOtaHeader(header, PARTITION_SIZE));
+    TEST_ASSERT_EQUAL(9 * sizeof(uint32_t), otaIndexSize(4));
+}
+
+void test_RejectsBrokenHeaders(void) {
+    OtaImageHeader header = makeHeader(100000);
+    header.magic[3] = '2';
+    TEST_ASSERT_FALSE(isValidOtaHeader(header, PARTITION_SIZE));
+
+    header = makeHeader(100000);
+    header.chunkCount++;
+    TEST_ASSERT_FALSE(isValidOtaHeader(header, PARTITION_SIZE));
+
+    header = makeHeader(100000);
+    header.chunkSize = 4096;
+    TEST_ASSERT_FALSE(isValidOtaHeader(header, PARTITION_SIZE));
+
+    // Larger than the partition
+    header = makeHeader(PARTITION_SIZE + 1);
+    TEST_ASSERT_FALSE(isValidOtaHeader(header, PARTITION_SIZE));
+}
+
+void test_ChecksIndex(void) {
+    OtaImageHeader header = makeHeader(2 * OTA_CHUNK_SIZE + 10);
+    uint32_t first = sizeof(OtaImageHeader) + otaIndexSize(3);
+    uint32_t offsets[4] = {first, first + 20000, first + 30000, first + 30010};
+    TEST_ASSERT_TRUE(isValidOtaIndex(header, offsets));
+
+    // Chunks can't overlap
+    offsets[2] = offsets[1];
+    TEST_ASSERT_FALSE(isValidOtaIndex(header, offsets));
+
+    // Nor be larger than an incompressible chunk
+    offsets[2] = offsets[1] + OTA_CHUNK_SIZE + 2000;
+    offsets[3] = offsets[2] + 10;
+    TEST_ASSERT_FALSE(isValidOtaIndex(header, offsets));
+
+    // The first chunk follows the index
+    offsets[0] = first + 1;
+    TEST_ASSERT_FALSE(isValidOtaIndex(header, offsets));
+}
+
+void test_LastChunkIsShorter(void) {
+    OtaImageHeader header = makeHeader(2 * OTA_CHUNK_SIZE + 10);
+    TEST_ASSERT_EQUAL(OTA_CHUNK_SIZE, otaChunkLength(header, 0));
+    TEST_ASSERT_EQUAL(OTA_CHUNK_SIZE, otaChunkLength(header, 1));
+    TEST_ASSERT_EQUAL(10, otaChunkLength(header, 2));
+}
+
+void test_ResumesSameImageOnly(void) {
+    TEST_ASSERT_EQUAL(7, otaResumeChunk(0xABCD, 0x10000, 7, 0xABCD, 0x10000, 20));
+    // Another image, or another partition, starts over
+    TEST_ASSERT_EQUAL(0, otaResumeChunk(0xABCD, 0x10000, 7, 0x1234, 0x10000, 20));
+    TEST_ASSERT_EQUAL(0, otaResumeChunk(0xABCD, 0x10000, 7, 0xABCD, 0x200000, 20));
+    // Nonsense progress
+    TEST_ASSERT_EQUAL(0, otaResumeChunk(0xABCD, 0x10000, 21, 0xABCD, 0x10000, 20));
+}
+
+int runUnityTests() {
+    UNITY_BEGIN();
+    RUN_TEST(test_AcceptsValidHeader);
+    RUN_TEST(test_RejectsBrokenHeaders);
+    RUN_TEST(test_ChecksIndex);
+    RUN_TEST(test_LastChunkIsShorter);
+    RUN_TEST(test_ResumesSameImageOnly);
+    return UNITY_END();
+}
+
+// WARNING!!! PLEASE REMOVE UNNECESSARY MAIN IMPLEMENTATIONS //
+
+/**
+ * For native dev-platform or for some embedded frameworks
+ */
+int main(void) { return runUnityTests(); }
@@ -0,0 +1,88 @@
+#include "unity.h"
+#include "utils/PackBits.h"
+
+void setUp(void) {
+    // Set up before each test
+}
+
+void tearDown(void) {
+    // Clean up after each test
+}
+
+void test_LiteralsAndRuns(void) {
+    // 3 literals, a run of 4, 128 as a no-op, a run of 2
+    const uint8_t packed[] = {0x02, 0x01, 0x02, 0x03, 0xfd, 0xaa,
+                              0x80, 0xff, 0x55};
+    const uint8_t expected[] = {0x01, 0x02, 0x03, 0xaa, 0xaa,
+                                0xaa, 0xaa, 0x55, 0x55};
+    uint8_t out[16] = {0};
+
+    TEST_ASSERT_EQUAL(sizeof(expected),
+                      unpackBits(packed, sizeof(packed), out, sizeof(out)));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, out, sizeof(expected));
+}
+
+void test_LongestRun(void) {
+    const uint8_t packed[] = {0x81, 0x0f};
+    uint8_t out[200] = {0};
+
+    TEST_ASSERT_EQUAL(128, unpackBits(packed, sizeof(packed), out, 200));
+    TEST_ASSERT_EQUAL_UINT8(0x0f, out[127]);
+    TEST_ASSERT_EQUAL_UINT8(0x00, out[128]);
+}
+
+void test_StopsWhenOutputIsFull(void) {
+    const uint8_t packed[] = {0xfb, 0x11, 0x03, 0x01, 0x02, 0x03, 0x04};
+    uint8_t out[8] = {0};
+
+    TEST_ASSERT_EQUAL(4, unpackBits(packed, sizeof(packed), out, 4));
+    TEST_ASSERT_EQUAL(8, unpackBits(packed, sizeof(packed), out, 8));
+    TEST_ASSERT_EQUAL_UINT8(0x01, out[6]);
+    TEST_ASSERT_EQUAL_UINT8(0x02, out[7]);
+}
+
+void test_StopsAtEndOfInput(void) {
+    // A literal that claims more bytes than there are, and a run without
+    // its byte
+    const uint8_t literal[] = {0x05, 0x01, 0x02};
+    const uint8_t run[] = {0xfe};
+    uint8_t out[8] = {0};
+
+    TEST_ASSERT_EQUAL(2, unpackBits(literal, sizeof(literal), out, 8));
+    TEST_ASSERT_EQUAL(0, unpackBits(run, sizeof(run), out, 8));
+}
+
+void test_XbmUndoesRowDelta(void) {
+    // 10x3: two bytes a row, the rows 0xff 0x03, 0xff 0x03, 0x00 0x01.
+    // The delta rows are 0xff 0x03, 0x00 0x00, 0xff 0x02.
+    const uint8_t data[] = {0x01, 0xff, 0x03, 0xff, 0x00, 0x01, 0xff, 0x02};
+    const uint8_t expected[] = {0xff, 0x03, 0xff, 0x03, 0x00, 0x01};
+    PackedXbm image = {10, 3, sizeof(data), data};
+    uint8_t out[8] = {0};
+
+    TEST_ASSERT_EQUAL(6, xbmSize(image));
+    TEST_ASSERT_TRUE(unpackXbm(image, out, sizeof(out)));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, out, sizeof(expected));
+
+    // Too small a buffer, or too little data
+    TEST_ASSERT_FALSE(unpackXbm(image, out, 5));
+    image.packedSize = 5;
+    TEST_ASSERT_FALSE(unpackXbm(image, out, sizeof(out)));
+}
+
+int runUnityTests(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_LiteralsAndRuns);
+    RUN_TEST(test_LongestRun);
+    RUN_TEST(test_StopsWhenOutputIsFull);
+    RUN_TEST(test_StopsAtEndOfInput);
+    RUN_TEST(test_XbmUndoesRowDelta);
+    return UNITY_END();
+}
+
+// WARNING!!! PLEASE REMOVE UNNECESSARY MAIN IMPLEMENTATIONS //
+
+/**
+ * For native dev-platform or for some embedded frameworks
+ */
+int main(void) { return runUnityTests(); }
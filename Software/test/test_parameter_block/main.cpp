@@ -0,0 +1,105 @@
+#include <thread>
+
+#include "ParameterBlock.h"
+#include "unity.h"
+
+struct Pair {
+    int a;
+    int b;
+};
+
+void setUp(void) {
+    // Set up before each test
+}
+
+void tearDown(void) {
+    // Clean up after each test
+}
+
+void test_NothingToTakeAtFirst(void) {
+    ParameterBlock<Pair> block;
+    Pair pair = {7, 8};
+    TEST_ASSERT_FALSE(block.isFresh());
+    TEST_ASSERT_FALSE(block.take(pair));
+    TEST_ASSERT_EQUAL(7, pair.a);
+}
+
+void test_TakeReturnsPublished(void) {
+    ParameterBlock<Pair> block;
+    block.publish({1, 2});
+    TEST_ASSERT_TRUE(block.isFresh());
+
+    Pair pair = {};
+    TEST_ASSERT_TRUE(block.take(pair));
+    TEST_ASSERT_EQUAL(1, pair.a);
+    TEST_ASSERT_EQUAL(2, pair.b);
+
+    // Taken once only
+    TEST_ASSERT_FALSE(block.isFresh());
+    TEST_ASSERT_FALSE(block.take(pair));
+}
+
+void test_LatestWins(void) {
+    ParameterBlock<Pair> block;
+    for (int i = 1; i <= 5; i++) {
+        block.publish({i, -i});
+    }
+
+    Pair pair = {};
+    TEST_ASSERT_TRUE(block.take(pair));
+    TEST_ASSERT_EQUAL(5, pair.a);
+    TEST_ASSERT_FALSE(block.take(pair));
+
+    block.publish({6, -6});
+    TEST_ASSERT_TRUE(block.take(pair));
+    TEST_ASSERT_EQUAL(6, pair.a);
+}
+
+void test_TakesAreConsistent(void) {
+    ParameterBlock<Pair> block;
+    std::atomic<bool> done{false};
+
+    // The writer always keeps b == -a, a torn take would break that
+    std::thread writer([&]() {
+        for (int i = 1; i <= 100000; i++) {
+            block.publish({i, -i});
+        }
+        done = true;
+    });
+
+    int torn = 0;
+    int backwards = 0;
+    Pair last = {0, 0};
+    Pair pair;
+    while (!done) {
+        if (block.take(pair)) {
+            torn += pair.a != -pair.b;
+            backwards += pair.a <= last.a;
+            last = pair;
+        }
+    }
+    writer.join();
+    if (block.take(pair)) {
+        last = pair;
+    }
+
+    TEST_ASSERT_EQUAL(0, torn);
+    TEST_ASSERT_EQUAL(0, backwards);
+    TEST_ASSERT_EQUAL(100000, last.a);
+}
+
+int runUnityTests() {
+    UNITY_BEGIN();
+    RUN_TEST(test_NothingToTakeAtFirst);
+    RUN_TEST(test_TakeReturnsPublished);
+    RUN_TEST(test_LatestWins);
+    RUN_TEST(test_TakesAreConsistent);
+    return UNITY_END();
+}
+
+// WARNING!!! PLEASE REMOVE UNNECESSARY MAIN IMPLEMENTATIONS //
+
+/**
+ * For native dev-platform or for some embedded frameworks
+ */
+int main(void) { return runUnityTests(); }
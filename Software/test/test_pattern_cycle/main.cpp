@@ -0,0 +1,117 @@
+#include "pattern.h"
+#include "unity.h"
+
+void setUp(void) {
+    // Set up before each test
+}
+
+void tearDown(void) {
+    // Clean up after each test
+}
+
+static void setParameters(Pattern &pattern, int stroke, float sensation) {
+    pattern.setSpeedLimit(13320, 200000, 20);
+    pattern.setTimeOfStroke(1.0);
+    pattern.setStroke(stroke);
+    pattern.setDepth(2760);
+    pattern.setSensation(sensation);
+}
+
+static void assertSameMove(const motionParameter &expected,
+                           const motionParameter &actual) {
+    TEST_ASSERT_EQUAL(expected.stroke, actual.stroke);
+    TEST_ASSERT_EQUAL(expected.speed, actual.speed);
+    TEST_ASSERT_EQUAL(expected.acceleration, actual.acceleration);
+    TEST_ASSERT_EQUAL(expected.skip, actual.skip);
+    TEST_ASSERT_EQUAL(expected.jerk, actual.jerk);
+    TEST_ASSERT_EQUAL_FLOAT(expected.aux[0], actual.aux[0]);
+}
+
+// The cached moves are the ones nextTarget() computes, index by index
+template <class TPattern>
+static void assertCycleMatches(const char *name) {
+    const float sensations[] = {-100, -30, 0, 60, 100};
+    for (float sensation : sensations) {
+        TPattern reference(name);
+        TPattern cached(name);
+        setParameters(reference, 2000, sensation);
+        setParameters(cached, 2000, sensation);
+        TEST_ASSERT_TRUE(cached.cycleLength() > 0);
+
+        for (unsigned int index = 0; index < 200; index++) {
+            assertSameMove(reference.nextTarget(index), cached.target(index));
+        }
+    }
+}
+
+void test_CycleMatchesNextTarget(void) {
+    assertCycleMatches<SimpleStroke>("Simple Stroke");
+    assertCycleMatches<TeasingPounding>("Teasing Pounding");
+    assertCycleMatches<RoboStroke>("Robo Stroke");
+    assertCycleMatches<HalfnHalf>("Half'n'Half");
+    assertCycleMatches<Deeper>("Deeper");
+    assertCycleMatches<Insist>("Insist");
+    assertCycleMatches<Struggle>("Struggle");
+    assertCycleMatches<Twist>("Twist");
+}
+
+void test_NewParametersInvalidate(void) {
+    Deeper deeper("Deeper");
+    setParameters(deeper, 2000, 0);
+    motionParameter before = deeper.target(4);
+
+    deeper.setStroke(1000);
+    motionParameter after = deeper.target(4);
+    TEST_ASSERT_TRUE(after.speed < before.speed);
+    TEST_ASSERT_EQUAL(2760 - 1000, deeper.target(5).stroke);
+
+    // The ramp length follows the sensation
+    deeper.setSensation(100);
+    TEST_ASSERT_EQUAL(64, deeper.cycleLength());
+    deeper.setSpeedLimit(6000, 200000, 20);
+    Deeper reference("Deeper");
+    setParameters(reference, 1000, 100);
+    for (unsigned int index = 0; index < 64; index++) {
+        assertSameMove(reference.nextTarget(index), deeper.target(index));
+    }
+}
+
+void test_SwitchingPatternsRecomputes(void) {
+    SimpleStroke simple("Simple Stroke");
+    Insist insist("Insist");
+    setParameters(simple, 2000, 0);
+    setParameters(insist, 2000, 50);
+
+    // Same index, but each pattern gets its own moves
+    for (int round = 0; round < 3; round++) {
+        TEST_ASSERT_EQUAL(2760 - 2000, simple.target(1).stroke);
+        TEST_ASSERT_EQUAL(2760 - 1000, insist.target(1).stroke);
+    }
+}
+
+void test_PatternsWithPausesOptOut(void) {
+    StopNGo stopNGo("Stop'n'Go");
+    Knot knot("Knot");
+    TEST_ASSERT_EQUAL(0, stopNGo.cycleLength());
+    TEST_ASSERT_EQUAL(0, knot.cycleLength());
+    TEST_ASSERT_EQUAL(0, scriptPattern.cycleLength());
+
+    // Still asked every time, a script without a clock has nothing to play
+    TEST_ASSERT_TRUE(scriptPattern.target(0).skip);
+}
+
+int runUnityTests(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_CycleMatchesNextTarget);
+    RUN_TEST(test_NewParametersInvalidate);
+    RUN_TEST(test_SwitchingPatternsRecomputes);
+    RUN_TEST(test_PatternsWithPausesOptOut);
+    return UNITY_END();
+}
+
+// WARNING!!! PLEASE REMOVE UNNECESSARY MAIN IMPLEMENTATIONS //
+
+/**
+ * For native dev-platform or for some embedded frameworks
+ */
+int main(void) { return runUnityTests(); }
@@ -0,0 +1,149 @@
+#include "PatternMath.h"
+#include "unity.h"
+
+void setUp(void) {
+    // Set up before each test
+}
+
+void tearDown(void) {
+    // Clean up after each test
+}
+
+void test_LinearTableIsExact(void) {
+    FscaleTable<2> table(1.0, 5.0);
+    for (float x = 0; x <= 100; x += 2.5) {
+        TEST_ASSERT_FLOAT_WITHIN(1e-5, fscale(0.0, 100.0, 1.0, 5.0, x, 0.0),
+                                 table(x));
+    }
+}
+
+void test_InvertedRange(void) {
+    FscaleTable<2> table(1.0 / 3.0, 0.05);
+    for (float x = 0; x <= 100; x += 5) {
+        TEST_ASSERT_FLOAT_WITHIN(
+            1e-5, fscale(0.0, 100.0, 1.0 / 3.0, 0.05, x, 0.0), table(x));
+    }
+}
+
+void test_CurvedTableIsClose(void) {
+    FscaleTable<> table(1.0, 10.0, -5.0);
+    for (float x = 0; x <= 100; x += 0.7) {
+        TEST_ASSERT_FLOAT_WITHIN(0.01, fscale(0.0, 100.0, 1.0, 10.0, x, -5.0),
+                                 table(x));
+    }
+}
+
+void test_SteepStartIsApproximate(void) {
+    // Positive curves rise steeply near 0, the first interval is the worst
+    FscaleTable<> table(1.0, 10.0, 2.0);
+    for (float x = 0; x <= 100; x += 0.7) {
+        TEST_ASSERT_FLOAT_WITHIN(0.15, fscale(0.0, 100.0, 1.0, 10.0, x, 2.0),
+                                 table(x));
+    }
+}
+
+void test_InputIsConstrained(void) {
+    FscaleTable<> table(2.0, 4.0);
+    TEST_ASSERT_FLOAT_WITHIN(1e-5, 2.0, table(-20));
+    TEST_ASSERT_FLOAT_WITHIN(1e-5, 4.0, table(150));
+}
+
+void test_SensationTableMatches(void) {
+    SensationTable<> table(3.0, 2.0);
+    TEST_ASSERT_FLOAT_WITHIN(1e-5, 1.0, table(0));
+    for (float s = -100; s <= 100; s += 1.5) {
+        TEST_ASSERT_FLOAT_WITHIN(0.05, mapSensationToFactor(3.0, s, 2.0),
+                                 table(s));
+    }
+}
+
+void test_WithinLimitsIsUntouched(void) {
+    float speed = 1000, acceleration = 3000;
+    TEST_ASSERT_EQUAL_FLOAT(
+        1.5, planWithinLimits(1000, 1.5, 2000, 5000, speed, acceleration));
+    TEST_ASSERT_EQUAL_FLOAT(1000, speed);
+    TEST_ASSERT_EQUAL_FLOAT(3000, acceleration);
+}
+
+void test_ReshapedToKeepTime(void) {
+    // 1/3 trapezoid over 1000 steps in 0.5s asks for 3000 steps/s
+    float speed = 3000, acceleration = 18000;
+    float time = planWithinLimits(1000, 0.5, 2800, 20000, speed, acceleration);
+    TEST_ASSERT_EQUAL_FLOAT(0.5, time);
+    TEST_ASSERT_TRUE(speed <= 2800);
+    TEST_ASSERT_TRUE(acceleration <= 20000);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3, 0.5,
+                             trapezoidalMoveTime(1000, speed, acceleration));
+}
+
+void test_TimeOptimalWhenTooFast(void) {
+    float speed = 30000, acceleration = 180000;
+    float time = planWithinLimits(1000, 0.05, 2000, 10000, speed, acceleration);
+    TEST_ASSERT_EQUAL_FLOAT(2000, speed);
+    TEST_ASSERT_EQUAL_FLOAT(10000, acceleration);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4, 0.7, time);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4, time,
+                             trapezoidalMoveTime(1000, speed, acceleration));
+
+    // Too short for the top speed ends up triangular
+    speed = 30000, acceleration = 180000;
+    time = planWithinLimits(100, 0.01, 2000, 10000, speed, acceleration);
+    TEST_ASSERT_FLOAT_WITHIN(1e-2, 1000, speed);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4, 0.2, time);
+}
+
+void test_RetargetKeepsAccelerationIfItCanBrake(void) {
+    // 1000 steps/s brake in 100 steps at 5000 steps/s², 400 are left
+    TEST_ASSERT_EQUAL_FLOAT(5000, retargetAcceleration(400, 1000, 5000,
+                                                       20000, 800));
+    TEST_ASSERT_EQUAL_FLOAT(5000, retargetAcceleration(-400, -1000, 5000,
+                                                       20000, 800));
+    TEST_ASSERT_EQUAL_FLOAT(5000, retargetAcceleration(0, 0, 5000, 20000, 0));
+}
+
+void test_RetargetBrakesToTheTarget(void) {
+    // Only 50 steps left: brake with v²/2d to stop right there
+    float acceleration = retargetAcceleration(50, 1000, 5000, 20000, 800);
+    TEST_ASSERT_EQUAL_FLOAT(10000, acceleration);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3, 0.1, trapezoidalMoveTime(50, 2000,
+                                                            acceleration,
+                                                            1000));
+
+    // Beyond the limit of the machine it overshoots at the limit
+    TEST_ASSERT_EQUAL_FLOAT(20000,
+                            retargetAcceleration(-10, -1000, 5000, 20000, 800));
+}
+
+void test_RetargetTurnsAroundWithinTheEnvelope(void) {
+    // Away from the target the room to the end of the envelope counts
+    TEST_ASSERT_EQUAL_FLOAT(5000, retargetAcceleration(-400, 1000, 5000,
+                                                       20000, 800));
+    TEST_ASSERT_EQUAL_FLOAT(12500, retargetAcceleration(-400, 1000, 5000,
+                                                        20000, 40));
+    TEST_ASSERT_EQUAL_FLOAT(20000, retargetAcceleration(400, -1000, 5000,
+                                                        20000, 0));
+}
+
+int runUnityTests() {
+    UNITY_BEGIN();
+    RUN_TEST(test_LinearTableIsExact);
+    RUN_TEST(test_InvertedRange);
+    RUN_TEST(test_CurvedTableIsClose);
+    RUN_TEST(test_SteepStartIsApproximate);
+    RUN_TEST(test_InputIsConstrained);
+    RUN_TEST(test_SensationTableMatches);
+    RUN_TEST(test_WithinLimitsIsUntouched);
+    RUN_TEST(test_ReshapedToKeepTime);
+    RUN_TEST(test_TimeOptimalWhenTooFast);
+    RUN_TEST(test_RetargetKeepsAccelerationIfItCanBrake);
+    RUN_TEST(test_RetargetBrakesToTheTarget);
+    RUN_TEST(test_RetargetTurnsAroundWithinTheEnvelope);
+    return UNITY_END();
+}
+
+// WARNING!!! PLEASE REMOVE UNNECESSARY MAIN IMPLEMENTATIONS //
+
+/**
+ * For native dev-platform or for some embedded frameworks
+ */
+int main(void) { return runUnityTests(); }
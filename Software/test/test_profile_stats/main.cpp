@@ -0,0 +1,57 @@
+#include "unity.h"
+#include "utils/ProfileStats.h"
+
+void setUp(void) {
+    // Set up before each test
+}
+
+void tearDown(void) {
+    // Clean up after each test
+}
+
+void test_EmptyStats(void) {
+    ProfileStats stats;
+    ProfileRecord record = stats.toRecord(ProfileProbe::ledShow);
+    TEST_ASSERT_EQUAL((uint8_t)ProfileProbe::ledShow, record.probe);
+    TEST_ASSERT_EQUAL(0, record.count);
+    TEST_ASSERT_EQUAL(0, record.minCycles);
+    TEST_ASSERT_EQUAL(0, record.meanCycles);
+    TEST_ASSERT_EQUAL(0, record.maxCycles);
+}
+
+void test_MinMeanMax(void) {
+    ProfileStats stats;
+    stats.add(300);
+    stats.add(100);
+    stats.add(200);
+
+    ProfileRecord record = stats.toRecord(ProfileProbe::stroking);
+    TEST_ASSERT_EQUAL(3, record.count);
+    TEST_ASSERT_EQUAL(100, record.minCycles);
+    TEST_ASSERT_EQUAL(200, record.meanCycles);
+    TEST_ASSERT_EQUAL(300, record.maxCycles);
+}
+
+void test_TotalDoesNotOverflow(void) {
+    // The total of slow calls outgrows 32 bits after the second one
+    ProfileStats stats;
+    for (int i = 0; i < 1000; i++) {
+        stats.add(4000000000u);
+    }
+    TEST_ASSERT_EQUAL(4000000000u, stats.mean());
+}
+
+int runUnityTests(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_EmptyStats);
+    RUN_TEST(test_MinMeanMax);
+    RUN_TEST(test_TotalDoesNotOverflow);
+    return UNITY_END();
+}
+
+// WARNING!!! PLEASE REMOVE UNNECESSARY MAIN IMPLEMENTATIONS //
+
+/**
+ * For native dev-platform or for some embedded frameworks
+ */
+int main(void) { return runUnityTests(); }
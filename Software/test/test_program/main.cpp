@@ -0,0 +1,197 @@
+#include <cstring>
+
+#include "command/program.hpp"
+#include "unity.h"
+#include "utils/ProgramPlayer.h"
+
+static const int start[setValueCount] = {1000, 5000, 6000, 5000, 200};
+
+static ProgramStep makeStep(uint32_t timeMs, int parameter, int value,
+                            ProgramEasing easing = ProgramEasing::linear) {
+    return {timeMs, (uint8_t)parameter, easing, (uint16_t)value};
+}
+
+// Speed ramp 0-1000ms from the start to 50%, then to 20% by 2000ms, and a
+// pattern change at 1500ms
+static void warmUp(Program& program) {
+    program.clear();
+    program.append(makeStep(1000, setValueSpeed, 5000));
+    program.append(makeStep(1500, setValuePattern, 500));
+    program.append(
+        makeStep(2000, setValueSpeed, 2000, ProgramEasing::inOutSine));
+}
+
+void setUp(void) {
+    // Set up before each test
+}
+
+void tearDown(void) {
+    // Clean up after each test
+}
+
+void test_ValuesFollowTheSteps(void) {
+    Program program;
+    warmUp(program);
+    TEST_ASSERT_EQUAL(2000, program.getDurationMs());
+    TEST_ASSERT_EQUAL((1 << setValueSpeed) | (1 << setValuePattern),
+                      program.getMask());
+
+    int values[setValueCount] = {-1, -1, -1, -1, -1};
+    program.valuesAt(0, start, values);
+    TEST_ASSERT_EQUAL(1000, values[setValueSpeed]);
+    TEST_ASSERT_EQUAL(200, values[setValuePattern]);
+    // Parameters without steps are left alone
+    TEST_ASSERT_EQUAL(-1, values[setValueStroke]);
+
+    program.valuesAt(500, start, values);
+    TEST_ASSERT_EQUAL(3000, values[setValueSpeed]);
+    program.valuesAt(1000, start, values);
+    TEST_ASSERT_EQUAL(5000, values[setValueSpeed]);
+
+    // Halfway through the sine the value is in the middle, gentle at the
+    // ends. The pattern jumps at its time.
+    program.valuesAt(1499, start, values);
+    TEST_ASSERT_EQUAL(200, values[setValuePattern]);
+    program.valuesAt(1500, start, values);
+    TEST_ASSERT_EQUAL(3500, values[setValueSpeed]);
+    TEST_ASSERT_EQUAL(500, values[setValuePattern]);
+    program.valuesAt(1100, start, values);
+    TEST_ASSERT_TRUE(values[setValueSpeed] > 4850);
+
+    program.valuesAt(5000, start, values);
+    TEST_ASSERT_EQUAL(2000, values[setValueSpeed]);
+}
+
+void test_JumpHoldsUntilItsTime(void) {
+    Program program;
+    program.append(makeStep(0, setValueDepth, 2000));
+    program.append(makeStep(1000, setValueDepth, 8000, ProgramEasing::jump));
+
+    int values[setValueCount] = {};
+    program.valuesAt(0, start, values);
+    TEST_ASSERT_EQUAL(2000, values[setValueDepth]);
+    program.valuesAt(999, start, values);
+    TEST_ASSERT_EQUAL(2000, values[setValueDepth]);
+    program.valuesAt(1000, start, values);
+    TEST_ASSERT_EQUAL(8000, values[setValueDepth]);
+}
+
+void test_InvalidStepsAreRejected(void) {
+    Program program;
+    TEST_ASSERT_FALSE(program.append(makeStep(0, setValueCount, 0)));
+    TEST_ASSERT_FALSE(program.append(makeStep(0, setValueSpeed, 10001)));
+    TEST_ASSERT_FALSE(program.append(makeStep(0, setValuePattern, 150)));
+    TEST_ASSERT_FALSE(
+        program.append(makeStep(0, setValueSpeed, 0, (ProgramEasing)3)));
+    TEST_ASSERT_TRUE(program.append(makeStep(100, setValueSpeed, 0)));
+    TEST_ASSERT_FALSE(program.append(makeStep(99, setValueStroke, 0)));
+    TEST_ASSERT_EQUAL(1, program.size());
+
+    for (int i = 1; i < PROGRAM_MAX_STEPS; i++) {
+        TEST_ASSERT_TRUE(program.append(makeStep(100 + i, setValueSpeed, 0)));
+    }
+    TEST_ASSERT_FALSE(program.append(makeStep(1000, setValueSpeed, 0)));
+}
+
+void test_PauseStopsTheClock(void) {
+    Program program;
+    warmUp(program);
+    ProgramPlayer player;
+    int values[setValueCount] = {};
+    TEST_ASSERT_FALSE(player.update(program, 0, values));
+
+    player.play(10000, false, start);
+    TEST_ASSERT_TRUE(player.update(program, 10500, values));
+    TEST_ASSERT_EQUAL(3000, values[setValueSpeed]);
+    TEST_ASSERT_TRUE(player.isPlayingOnce());
+
+    player.pause(10500);
+    TEST_ASSERT_TRUE(player.isActive());
+    TEST_ASSERT_FALSE(player.isPlayingOnce());
+    TEST_ASSERT_FALSE(player.update(program, 20000, values));
+    TEST_ASSERT_EQUAL(500, player.time(20000));
+
+    player.resume(30000);
+    TEST_ASSERT_TRUE(player.update(program, 30500, values));
+    TEST_ASSERT_EQUAL(5000, values[setValueSpeed]);
+
+    // Finishes on the values of the last steps
+    TEST_ASSERT_TRUE(player.update(program, 40000, values));
+    TEST_ASSERT_EQUAL(2000, values[setValueSpeed]);
+    TEST_ASSERT_EQUAL(500, values[setValuePattern]);
+    TEST_ASSERT_TRUE(player.getState() == ProgramState::finished);
+    TEST_ASSERT_FALSE(player.isActive());
+    TEST_ASSERT_FALSE(player.isPlayingOnce());
+    TEST_ASSERT_FALSE(player.update(program, 40100, values));
+}
+
+void test_LoopsStartFromTheirEnd(void) {
+    Program program;
+    program.append(makeStep(1000, setValueStroke, 8000));
+    ProgramPlayer player;
+    player.play(0, true, start);
+
+    int values[setValueCount] = {};
+    player.update(program, 500, values);
+    TEST_ASSERT_EQUAL(6500, values[setValueStroke]);
+
+    // The second pass starts at 80%, so holds it. Skipped passes count.
+    player.update(program, 3500, values);
+    TEST_ASSERT_EQUAL(8000, values[setValueStroke]);
+    TEST_ASSERT_EQUAL(3, player.getLoops());
+    TEST_ASSERT_EQUAL(500, player.time(3500));
+    TEST_ASSERT_TRUE(player.getState() == ProgramState::playing);
+    TEST_ASSERT_FALSE(player.isPlayingOnce());
+
+    player.stop();
+    TEST_ASSERT_FALSE(player.update(program, 4000, values));
+}
+
+void test_AppendChunks(void) {
+    Program program;
+    // first 0, two steps: 0ms speed linear 0, 30000ms speed sine 40%
+    const uint8_t chunk[] = {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                             0x01, 0x00, 0x00, 0x30, 0x75, 0x00, 0x00,
+                             0x00, 0x02, 0xA0, 0x0F};
+    TEST_ASSERT_TRUE(appendProgramChunk(program, chunk, sizeof(chunk)) ==
+                     ProgramResult::ok);
+    TEST_ASSERT_EQUAL(2, program.size());
+    TEST_ASSERT_EQUAL(30000, program.getDurationMs());
+
+    // Resent chunks only add what is new, later ones wait for the gap
+    TEST_ASSERT_TRUE(appendProgramChunk(program, chunk, sizeof(chunk)) ==
+                     ProgramResult::ok);
+    TEST_ASSERT_EQUAL(2, program.size());
+    uint8_t gap[sizeof(chunk)];
+    memcpy(gap, chunk, sizeof(chunk));
+    gap[0] = 3;
+    TEST_ASSERT_TRUE(appendProgramChunk(program, gap, sizeof(gap)) ==
+                     ProgramResult::gap);
+
+    // Time before the previous step
+    uint8_t late[] = {0x02, 0x00, 0x10, 0x00, 0x00, 0x00, 0x01, 0x01,
+                      0x00, 0x00};
+    TEST_ASSERT_TRUE(appendProgramChunk(program, late, sizeof(late)) ==
+                     ProgramResult::invalid);
+    TEST_ASSERT_TRUE(appendProgramChunk(program, late, 9) ==
+                     ProgramResult::malformed);
+    TEST_ASSERT_EQUAL(2, program.size());
+}
+
+int runUnityTests(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_ValuesFollowTheSteps);
+    RUN_TEST(test_JumpHoldsUntilItsTime);
+    RUN_TEST(test_InvalidStepsAreRejected);
+    RUN_TEST(test_PauseStopsTheClock);
+    RUN_TEST(test_LoopsStartFromTheirEnd);
+    RUN_TEST(test_AppendChunks);
+    return UNITY_END();
+}
+
+// WARNING!!! PLEASE REMOVE UNNECESSARY MAIN IMPLEMENTATIONS //
+
+/**
+ * For native dev-platform or for some embedded frameworks
+ */
+int main(void) { return runUnityTests(); }
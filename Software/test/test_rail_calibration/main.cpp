@@ -0,0 +1,57 @@
+#include "unity.h"
+#include "utils/RailCalibration.h"
+
+void setUp(void) {
+    // Set up before each test
+}
+
+void tearDown(void) {
+    // Clean up after each test
+}
+
+void test_ValidCalibration(void) {
+    RailCalibration calibration = {2000, 12.5f};
+    TEST_ASSERT_TRUE(calibration.isValid(500, 6800));
+}
+
+void test_RejectsImpossibleStrokes(void) {
+    // Nothing stored yet
+    TEST_ASSERT_FALSE(RailCalibration().isValid(500, 6800));
+    TEST_ASSERT_FALSE((RailCalibration{400, 12.5f}).isValid(500, 6800));
+    TEST_ASSERT_FALSE((RailCalibration{7000, 12.5f}).isValid(500, 6800));
+    TEST_ASSERT_FALSE((RailCalibration{NAN, 12.5f}).isValid(500, 6800));
+    TEST_ASSERT_FALSE((RailCalibration{2000, -1}).isValid(500, 6800));
+}
+
+void test_SensorOffset(void) {
+    RailCalibration calibration = {2000, 12.5f};
+    TEST_ASSERT_TRUE(isSensorOffsetConfirmed(calibration, 12.8f, 0.5f));
+    TEST_ASSERT_TRUE(isSensorOffsetConfirmed(calibration, 12.1f, 0.5f));
+    TEST_ASSERT_FALSE(isSensorOffsetConfirmed(calibration, 13.1f, 0.5f));
+}
+
+void test_TouchOff(void) {
+    // The end of the rail is 200 steps behind the homed zero
+    TEST_ASSERT_TRUE(isTouchOffConfirmed(200, 200, 100));
+    TEST_ASSERT_TRUE(isTouchOffConfirmed(130, 200, 100));
+    TEST_ASSERT_TRUE(isTouchOffConfirmed(290, 200, 100));
+    // Pushed while the motor was off
+    TEST_ASSERT_FALSE(isTouchOffConfirmed(-400, 200, 100));
+    TEST_ASSERT_FALSE(isTouchOffConfirmed(350, 200, 100));
+}
+
+int runUnityTests() {
+    UNITY_BEGIN();
+    RUN_TEST(test_ValidCalibration);
+    RUN_TEST(test_RejectsImpossibleStrokes);
+    RUN_TEST(test_SensorOffset);
+    RUN_TEST(test_TouchOff);
+    return UNITY_END();
+}
+
+// WARNING!!! PLEASE REMOVE UNNECESSARY MAIN IMPLEMENTATIONS //
+
+/**
+ * For native dev-platform or for some embedded frameworks
+ */
+int main(void) { return runUnityTests(); }
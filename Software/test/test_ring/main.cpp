@@ -0,0 +1,82 @@
+#include "unity.h"
+#include "utils/SpscRing.h"
+
+void setUp(void) {
+    // Set up before each test
+}
+
+void tearDown(void) {
+    // Clean up after each test
+}
+
+void test_EmptyRing(void) {
+    SpscRing<int, 4> ring;
+    int item = 0;
+    TEST_ASSERT_TRUE(ring.empty());
+    TEST_ASSERT_EQUAL(0, ring.size());
+    TEST_ASSERT_FALSE(ring.pop(item));
+}
+
+void test_FirstInFirstOut(void) {
+    SpscRing<int, 4> ring;
+    int item = 0;
+    TEST_ASSERT_TRUE(ring.push(1));
+    TEST_ASSERT_TRUE(ring.push(2));
+    TEST_ASSERT_TRUE(ring.push(3));
+    TEST_ASSERT_EQUAL(3, ring.size());
+
+    TEST_ASSERT_TRUE(ring.pop(item));
+    TEST_ASSERT_EQUAL(1, item);
+    TEST_ASSERT_TRUE(ring.pop(item));
+    TEST_ASSERT_EQUAL(2, item);
+    TEST_ASSERT_TRUE(ring.pop(item));
+    TEST_ASSERT_EQUAL(3, item);
+    TEST_ASSERT_TRUE(ring.empty());
+}
+
+void test_OverflowIsCounted(void) {
+    SpscRing<int, 2> ring;
+    int item = 0;
+    TEST_ASSERT_TRUE(ring.push(1));
+    TEST_ASSERT_TRUE(ring.push(2));
+    TEST_ASSERT_FALSE(ring.push(3));
+    TEST_ASSERT_FALSE(ring.push(4));
+    TEST_ASSERT_EQUAL(2, ring.getOverflowCount());
+
+    // The oldest items are kept
+    TEST_ASSERT_TRUE(ring.pop(item));
+    TEST_ASSERT_EQUAL(1, item);
+    TEST_ASSERT_TRUE(ring.push(5));
+    TEST_ASSERT_TRUE(ring.pop(item));
+    TEST_ASSERT_EQUAL(2, item);
+    TEST_ASSERT_TRUE(ring.pop(item));
+    TEST_ASSERT_EQUAL(5, item);
+}
+
+void test_WrapAround(void) {
+    SpscRing<int, 4> ring;
+    int item = 0;
+    for (int i = 0; i < 100; i++) {
+        TEST_ASSERT_TRUE(ring.push(i));
+        TEST_ASSERT_TRUE(ring.pop(item));
+        TEST_ASSERT_EQUAL(i, item);
+    }
+    TEST_ASSERT_TRUE(ring.empty());
+    TEST_ASSERT_EQUAL(0, ring.getOverflowCount());
+}
+
+int runUnityTests() {
+    UNITY_BEGIN();
+    RUN_TEST(test_EmptyRing);
+    RUN_TEST(test_FirstInFirstOut);
+    RUN_TEST(test_OverflowIsCounted);
+    RUN_TEST(test_WrapAround);
+    return UNITY_END();
+}
+
+// WARNING!!! PLEASE REMOVE UNNECESSARY MAIN IMPLEMENTATIONS //
+
+/**
+ * For native dev-platform or for some embedded frameworks
+ */
+int main(void) { return runUnityTests(); }
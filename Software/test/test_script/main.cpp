@@ -0,0 +1,181 @@
+#include "command/script.hpp"
+#include "unity.h"
+
+static ScriptAction storage[4];
+static ScriptBuffer buffer;
+
+void setUp(void) {
+    // Set up before each test
+    buffer.clear();
+    buffer.begin(storage, 4);
+}
+
+void tearDown(void) {
+    // Clean up after each test
+}
+
+// Append message payload with count actions 100ms apart from first on
+static size_t chunk(uint8_t *data, uint32_t first, uint32_t count) {
+    size_t length = 0;
+    for (int i = 0; i < 4; i++) data[length++] = (first >> (8 * i)) & 0xFF;
+    for (uint32_t n = first; n < first + count; n++) {
+        uint32_t time = 100 * n;
+        for (int i = 0; i < 4; i++) data[length++] = (time >> (8 * i)) & 0xFF;
+        data[length++] = n % 2 ? 100 : 0;
+    }
+    return length;
+}
+
+void test_PushAndPop(void) {
+    ScriptAction action;
+    TEST_ASSERT_FALSE(buffer.peek(action));
+    TEST_ASSERT_TRUE(buffer.push({100, 50}));
+    TEST_ASSERT_TRUE(buffer.push({200, 60}));
+    TEST_ASSERT_EQUAL(2, buffer.appended());
+    TEST_ASSERT_EQUAL(2, buffer.available());
+
+    TEST_ASSERT_TRUE(buffer.peek(action));
+    TEST_ASSERT_EQUAL(100, action.time);
+    buffer.pop();
+    TEST_ASSERT_TRUE(buffer.peek(action));
+    TEST_ASSERT_EQUAL(60, action.position);
+    TEST_ASSERT_EQUAL(3, buffer.available());
+}
+
+void test_RejectsFullAndUnordered(void) {
+    TEST_ASSERT_TRUE(buffer.push({100, 0}));
+    TEST_ASSERT_FALSE(buffer.push({100, 0}));
+    TEST_ASSERT_FALSE(buffer.push({50, 0}));
+    TEST_ASSERT_TRUE(buffer.push({200, 0}));
+    TEST_ASSERT_TRUE(buffer.push({300, 0}));
+    TEST_ASSERT_TRUE(buffer.push({400, 0}));
+    TEST_ASSERT_FALSE(buffer.push({500, 0}));
+    TEST_ASSERT_EQUAL(0, buffer.available());
+
+    // Played actions make room again, wrapping around
+    ScriptAction action;
+    buffer.peek(action);
+    buffer.pop();
+    TEST_ASSERT_TRUE(buffer.push({500, 0}));
+    for (uint32_t time = 200; time <= 500; time += 100) {
+        TEST_ASSERT_TRUE(buffer.peek(action));
+        TEST_ASSERT_EQUAL(time, action.time);
+        buffer.pop();
+    }
+    TEST_ASSERT_FALSE(buffer.peek(action));
+}
+
+void test_ClearDropsEverything(void) {
+    ScriptAction action;
+    buffer.push({100, 0});
+    buffer.push({200, 0});
+    TEST_ASSERT_TRUE(buffer.peek(action));
+
+    buffer.clear();
+    TEST_ASSERT_EQUAL(0, buffer.appended());
+    TEST_ASSERT_EQUAL(4, buffer.available());
+
+    // A new script may start over at time 0, the peeked action is gone
+    TEST_ASSERT_TRUE(buffer.push({0, 30}));
+    buffer.pop();
+    TEST_ASSERT_TRUE(buffer.peek(action));
+    TEST_ASSERT_EQUAL(0, action.time);
+    TEST_ASSERT_EQUAL(30, action.position);
+}
+
+void test_AppendsChunks(void) {
+    uint8_t data[64];
+    ScriptAction action;
+
+    size_t length = chunk(data, 0, 2);
+    TEST_ASSERT_EQUAL(ScriptResult::ok,
+                      appendScriptChunk(buffer, data, length));
+    TEST_ASSERT_EQUAL(2, buffer.appended());
+
+    // Resent and overlapping chunks only add what is new
+    TEST_ASSERT_EQUAL(ScriptResult::ok,
+                      appendScriptChunk(buffer, data, length));
+    length = chunk(data, 1, 2);
+    TEST_ASSERT_EQUAL(ScriptResult::ok,
+                      appendScriptChunk(buffer, data, length));
+    TEST_ASSERT_EQUAL(3, buffer.appended());
+
+    // Gaps are refused
+    length = chunk(data, 4, 1);
+    TEST_ASSERT_EQUAL(ScriptResult::gap,
+                      appendScriptChunk(buffer, data, length));
+
+    // Only what fits is taken
+    length = chunk(data, 3, 3);
+    TEST_ASSERT_EQUAL(ScriptResult::full,
+                      appendScriptChunk(buffer, data, length));
+    TEST_ASSERT_EQUAL(4, buffer.appended());
+
+    TEST_ASSERT_TRUE(buffer.peek(action));
+    TEST_ASSERT_EQUAL(0, action.time);
+    buffer.pop();
+    TEST_ASSERT_TRUE(buffer.peek(action));
+    TEST_ASSERT_EQUAL(100, action.time);
+    TEST_ASSERT_EQUAL(100, action.position);
+}
+
+void test_RejectsMalformedChunks(void) {
+    uint8_t data[64];
+    size_t length = chunk(data, 0, 2);
+    TEST_ASSERT_EQUAL(ScriptResult::malformed,
+                      appendScriptChunk(buffer, data, 3));
+    TEST_ASSERT_EQUAL(ScriptResult::malformed,
+                      appendScriptChunk(buffer, data, length - 1));
+
+    data[8] = 101;
+    TEST_ASSERT_EQUAL(ScriptResult::invalid,
+                      appendScriptChunk(buffer, data, length));
+    TEST_ASSERT_EQUAL(0, buffer.appended());
+}
+
+void test_ClockFollowsResyncs(void) {
+    ScriptClock clock;
+    TEST_ASSERT_FALSE(clock.isRunning());
+
+    clock.start(5000, 1000);
+    TEST_ASSERT_TRUE(clock.isRunning());
+    TEST_ASSERT_EQUAL(5000, clock.now(1000));
+    TEST_ASSERT_EQUAL(6000, clock.now(2000));
+
+    // Jitter is smoothed, the clock moves half way
+    clock.resync(6040, 2000);
+    TEST_ASSERT_EQUAL(6020, clock.now(2000));
+    clock.resync(5980, 2000);
+    TEST_ASSERT_EQUAL(6000, clock.now(2000));
+
+    // Seeks are followed at once, also backwards
+    clock.resync(60000, 2000);
+    TEST_ASSERT_EQUAL(60000, clock.now(2000));
+    clock.resync(1000, 3000);
+    TEST_ASSERT_EQUAL(1000, clock.now(3000));
+
+    // Wraps around with the millisecond counter
+    clock.start(0, 0xFFFFFF00);
+    TEST_ASSERT_EQUAL(0x200, clock.now(0x100));
+
+    clock.stop();
+    TEST_ASSERT_FALSE(clock.isRunning());
+}
+
+int runUnityTests() {
+    UNITY_BEGIN();
+    RUN_TEST(test_PushAndPop);
+    RUN_TEST(test_RejectsFullAndUnordered);
+    RUN_TEST(test_ClearDropsEverything);
+    RUN_TEST(test_AppendsChunks);
+    RUN_TEST(test_RejectsMalformedChunks);
+    RUN_TEST(test_ClockFollowsResyncs);
+    return UNITY_END();
+}
+
+// WARNING!!! PLEASE REMOVE UNNECESSARY MAIN IMPLEMENTATIONS //
+
+/**
+ * For native dev-platform or for some embedded frameworks
+ */
+int main(void) { return runUnityTests(); }
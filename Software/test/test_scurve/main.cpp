@@ -0,0 +1,105 @@
+#include "SCurve.h"
+#include "unity.h"
+
+void setUp(void) {
+    // Set up before each test
+}
+
+void tearDown(void) {
+    // Clean up after each test
+}
+
+// Samples the profile and checks it against the limits
+static void checkProfile(float distance, float speed, float acceleration,
+                         float jerk) {
+    SCurveProfile profile;
+    TEST_ASSERT_TRUE(profile.plan(distance, speed, acceleration, jerk));
+
+    float duration = profile.getDuration();
+    float dt = duration / 400;
+    float lastPosition = 0;
+    float lastSpeed = 0;
+    float maxSpeed = 0;
+    float maxAcceleration = 0;
+
+    for (int i = 1; i <= 400; i++) {
+        float position = profile.positionAt(i * dt);
+        float currentSpeed = (position - lastPosition) / dt;
+        TEST_ASSERT_TRUE(position >= lastPosition - 1e-3);
+
+        maxSpeed = fmax(maxSpeed, currentSpeed);
+        maxAcceleration =
+            fmax(maxAcceleration, fabs(currentSpeed - lastSpeed) / dt);
+        lastPosition = position;
+        lastSpeed = currentSpeed;
+    }
+
+    TEST_ASSERT_FLOAT_WITHIN(1e-3 * distance, distance, lastPosition);
+    TEST_ASSERT_FLOAT_WITHIN(1e-2 * distance, 0.5 * distance,
+                             profile.positionAt(0.5 * duration));
+    TEST_ASSERT_TRUE(maxSpeed <= speed * 1.01);
+    TEST_ASSERT_TRUE(maxAcceleration <= acceleration * 1.05);
+}
+
+void test_LongMoveCruises(void) {
+    SCurveProfile profile;
+    profile.plan(10000, 5000, 20000, 200000);
+    TEST_ASSERT_FLOAT_WITHIN(1, 5000, profile.getPeakSpeed());
+    TEST_ASSERT_FLOAT_WITHIN(1, 20000, profile.getPeakAcceleration());
+    checkProfile(10000, 5000, 20000, 200000);
+}
+
+void test_ShortMoveLowersSpeed(void) {
+    SCurveProfile profile;
+    profile.plan(500, 5000, 20000, 200000);
+    TEST_ASSERT_TRUE(profile.getPeakSpeed() < 5000);
+    checkProfile(500, 5000, 20000, 200000);
+}
+
+void test_TinyMoveOnlyRampsJerk(void) {
+    SCurveProfile profile;
+    profile.plan(20, 5000, 20000, 200000);
+    TEST_ASSERT_TRUE(profile.getPeakAcceleration() < 20000);
+    checkProfile(20, 5000, 20000, 200000);
+}
+
+void test_SlowSpeedLimitsAcceleration(void) {
+    // Top speed is reached before top acceleration
+    SCurveProfile profile;
+    profile.plan(10000, 1000, 20000, 200000);
+    TEST_ASSERT_TRUE(profile.getPeakAcceleration() < 20000);
+    checkProfile(10000, 1000, 20000, 200000);
+}
+
+void test_SlowerThanTrapezoid(void) {
+    SCurveProfile profile;
+    profile.plan(4000, 4000, 16000, 100000);
+    float trapezoid = 4000.0 / 4000 + 4000.0 / 16000;
+    TEST_ASSERT_TRUE(profile.getDuration() > trapezoid);
+}
+
+void test_NoMove(void) {
+    SCurveProfile profile;
+    TEST_ASSERT_FALSE(profile.plan(0, 1000, 1000, 1000));
+    TEST_ASSERT_FALSE(profile.plan(100, 1000, 1000, 0));
+    TEST_ASSERT_EQUAL(0, profile.getDuration());
+    TEST_ASSERT_EQUAL(0, profile.positionAt(1.0));
+}
+
+int runUnityTests() {
+    UNITY_BEGIN();
+    RUN_TEST(test_LongMoveCruises);
+    RUN_TEST(test_ShortMoveLowersSpeed);
+    RUN_TEST(test_TinyMoveOnlyRampsJerk);
+    RUN_TEST(test_SlowSpeedLimitsAcceleration);
+    RUN_TEST(test_SlowerThanTrapezoid);
+    RUN_TEST(test_NoMove);
+    return UNITY_END();
+}
+
+// WARNING!!! PLEASE REMOVE UNNECESSARY MAIN IMPLEMENTATIONS //
+
+/**
+ * For native dev-platform or for some embedded frameworks
+ */
+int main(void) { return runUnityTests(); }
@@ -0,0 +1,93 @@
+#include <thread>
+
+#include "unity.h"
+#include "utils/Seqlock.h"
+
+struct Pair {
+    int a;
+    int b;
+};
+
+void setUp(void) {
+    // Set up before each test
+}
+
+void tearDown(void) {
+    // Clean up after each test
+}
+
+void test_LoadReturnsInitialValue(void) {
+    Seqlock<Pair> lock({1, 2});
+    uint32_t version = 99;
+    Pair pair = lock.load(&version);
+    TEST_ASSERT_EQUAL(1, pair.a);
+    TEST_ASSERT_EQUAL(2, pair.b);
+    TEST_ASSERT_EQUAL(lock.getVersion(), version);
+}
+
+void test_WriteChangesVersion(void) {
+    Seqlock<Pair> lock({0, 0});
+    uint32_t version = 0;
+    lock.load(&version);
+
+    lock.write([](Pair &pair) { pair.a = 5; });
+    TEST_ASSERT_NOT_EQUAL(version, lock.getVersion());
+
+    Pair pair = lock.load(&version);
+    TEST_ASSERT_EQUAL(5, pair.a);
+    TEST_ASSERT_EQUAL(0, pair.b);
+    TEST_ASSERT_EQUAL(lock.getVersion(), version);
+}
+
+void test_VersionIsEven(void) {
+    Seqlock<Pair> lock;
+    for (int i = 0; i < 5; i++) {
+        lock.write([i](Pair &pair) { pair.a = i; });
+        TEST_ASSERT_EQUAL(0, lock.getVersion() & 1);
+    }
+    TEST_ASSERT_EQUAL(10, lock.getVersion());
+}
+
+void test_ReadsAreConsistent(void) {
+    Seqlock<Pair> lock({0, 0});
+    std::atomic<bool> done{false};
+
+    // The writer always keeps b == -a, a torn read would break that
+    std::thread writer([&]() {
+        for (int i = 1; i <= 100000; i++) {
+            lock.write([i](Pair &pair) {
+                pair.a = i;
+                pair.b = -i;
+            });
+        }
+        done = true;
+    });
+
+    int torn = 0;
+    while (!done) {
+        Pair pair = lock.load();
+        if (pair.a != -pair.b) {
+            torn++;
+        }
+    }
+    writer.join();
+
+    TEST_ASSERT_EQUAL(0, torn);
+    TEST_ASSERT_EQUAL(100000, lock.load().a);
+}
+
+int runUnityTests() {
+    UNITY_BEGIN();
+    RUN_TEST(test_LoadReturnsInitialValue);
+    RUN_TEST(test_WriteChangesVersion);
+    RUN_TEST(test_VersionIsEven);
+    RUN_TEST(test_ReadsAreConsistent);
+    return UNITY_END();
+}
+
+// WARNING!!! PLEASE REMOVE UNNECESSARY MAIN IMPLEMENTATIONS //
+
+/**
+ * For native dev-platform or for some embedded frameworks
+ */
+int main(void) { return runUnityTests(); }
@@ -0,0 +1,72 @@
+#include "SessionCounter.h"
+#include "unity.h"
+
+void setUp(void) {
+    // Set up before each test
+}
+
+void tearDown(void) {
+    // Clean up after each test
+}
+
+void test_OutAndBackIsOneStroke(void) {
+    SessionCounter session;
+    session.reset(0);
+
+    session.reach(-1000);
+    TEST_ASSERT_EQUAL(0, session.getStrokes());
+    session.reach(0);
+    TEST_ASSERT_EQUAL(1, session.getStrokes());
+    session.reach(-1000);
+    session.reach(0);
+    TEST_ASSERT_EQUAL(2, session.getStrokes());
+    TEST_ASSERT_EQUAL(4000, session.getSteps());
+}
+
+void test_RetargetedMovesAddUp(void) {
+    SessionCounter session;
+    session.reset(100);
+
+    // Retargeted twice on the way out, still one direction
+    session.reach(300);
+    session.reach(500);
+    session.reach(800);
+    session.reach(100);
+    TEST_ASSERT_EQUAL(1, session.getStrokes());
+    TEST_ASSERT_EQUAL(1400, session.getSteps());
+
+    // Standing still changes nothing
+    session.reach(100);
+    TEST_ASSERT_EQUAL(1, session.getStrokes());
+    TEST_ASSERT_EQUAL(1400, session.getSteps());
+}
+
+void test_ResetStartsOver(void) {
+    SessionCounter session;
+    session.reset(0);
+    session.reach(500);
+    session.reach(0);
+
+    // A new session starts at the position the machine is at
+    session.reset(-200);
+    TEST_ASSERT_EQUAL(0, session.getStrokes());
+    TEST_ASSERT_EQUAL(0, session.getSteps());
+    session.reach(0);
+    TEST_ASSERT_EQUAL(200, session.getSteps());
+    TEST_ASSERT_EQUAL(0, session.getStrokes());
+}
+
+int runUnityTests() {
+    UNITY_BEGIN();
+    RUN_TEST(test_OutAndBackIsOneStroke);
+    RUN_TEST(test_RetargetedMovesAddUp);
+    RUN_TEST(test_ResetStartsOver);
+    return UNITY_END();
+}
+
+// WARNING!!! PLEASE REMOVE UNNECESSARY MAIN IMPLEMENTATIONS //
+
+/**
+ * For native dev-platform or for some embedded frameworks
+ */
+int main(void) { return runUnityTests(); }
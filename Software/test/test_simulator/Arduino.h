@@ -0,0 +1,130 @@
+#ifndef SOFTWARE_SIM_ARDUINO_H
+#define SOFTWARE_SIM_ARDUINO_H
+
+// The parts of the Arduino core the StrokeEngine uses, on top of the
+// simulator's virtual clock. Serial output is dropped unless SIM_VERBOSE is
+// defined.
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+#include "Simulator.h"
+#include "esp_timer.h"
+
+using std::abs;
+using std::max;
+using std::min;
+
+typedef uint8_t byte;
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+#define INPUT_PULLDOWN 0x09
+
+#define PROGMEM
+#define F(string) (string)
+#define FPSTR(string) (string)
+
+#define constrain(amt, low, high) \
+    ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+inline long map(long x, long inMin, long inMax, long outMin, long outMax) {
+    return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+
+inline unsigned long millis() { return (unsigned long)(Sim::now() / 1000); }
+inline unsigned long micros() { return (unsigned long)Sim::now(); }
+inline void delay(unsigned long ms) { vTaskDelay(ms / portTICK_PERIOD_MS); }
+
+inline void pinMode(uint8_t pin, uint8_t mode) {}
+inline void digitalWrite(uint8_t pin, uint8_t level) { Sim::setPin(pin, level); }
+inline int digitalRead(uint8_t pin) { return Sim::getPin(pin); }
+
+class String {
+  public:
+    String(const char *str = "") : _str(str) {}
+    String(const std::string &str) : _str(str) {}
+    String(char c) : _str(1, c) {}
+    String(int value) : _str(std::to_string(value)) {}
+    String(unsigned int value) : _str(std::to_string(value)) {}
+    String(long value) : _str(std::to_string(value)) {}
+    String(unsigned long value) : _str(std::to_string(value)) {}
+    String(double value, unsigned int decimals = 2) {
+        char buffer[32];
+        snprintf(buffer, sizeof(buffer), "%.*f", decimals, value);
+        _str = buffer;
+    }
+
+    const char *c_str() const { return _str.c_str(); }
+    unsigned int length() const { return _str.size(); }
+
+    String &operator+=(const String &other) {
+        _str += other._str;
+        return *this;
+    }
+    friend String operator+(const String &a, const String &b) {
+        return String(a._str + b._str);
+    }
+    friend String operator+(const char *a, const String &b) {
+        return String(a + b._str);
+    }
+    bool operator==(const String &other) const { return _str == other._str; }
+
+  private:
+    std::string _str;
+};
+
+class HardwareSerial {
+  public:
+    void begin(unsigned long baud) {}
+    void print(const String &value) { write(value.c_str()); }
+    void print(const char *value) { write(value); }
+    void print(char value) { write(String(value).c_str()); }
+    void print(int value) { write(String(value).c_str()); }
+    void print(unsigned int value) { write(String(value).c_str()); }
+    void print(long value) { write(String(value).c_str()); }
+    void print(unsigned long value) { write(String(value).c_str()); }
+    void print(double value, int decimals = 2) {
+        write(String(value, decimals).c_str());
+    }
+    template <typename T>
+    void println(const T &value) {
+        print(value);
+        write("\n");
+    }
+    void println() { write("\n"); }
+
+  private:
+    void write(const char *str) {
+#ifdef SIM_VERBOSE
+        fputs(str, stdout);
+#endif
+    }
+};
+
+inline HardwareSerial Serial;
+
+// The esp_log macros the shared command code uses, dropped like Serial
+#ifdef SIM_VERBOSE
+#define SIM_LOG(tag, format, ...) \
+    printf("%s: " format "\n", tag, ##__VA_ARGS__)
+#else
+#define SIM_LOG(tag, format, ...) ((void)(tag))
+#endif
+#define ESP_LOGE SIM_LOG
+#define ESP_LOGW SIM_LOG
+#define ESP_LOGI SIM_LOG
+#define ESP_LOGD SIM_LOG
+#define ESP_LOGV SIM_LOG
+
+#endif  // SOFTWARE_SIM_ARDUINO_H
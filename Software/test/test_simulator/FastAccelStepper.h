@@ -0,0 +1,345 @@
+#ifndef SOFTWARE_SIM_FASTACCELSTEPPER_H
+#define SOFTWARE_SIM_FASTACCELSTEPPER_H
+
+/**
+ * Simulated FastAccelStepper. Instead of generating pulses it integrates the
+ * ramp in virtual time: accelerate with the set rate up to the top speed,
+ * cruise and decelerate to a stop at the target. Like the real ramp
+ * generator a new target is taken on the fly, overshooting and coming back
+ * if it is too close to stop in time. Timed moves and entries of the command
+ * queue play out one after the other at constant speed.
+ */
+
+#include <math.h>
+#include <stdint.h>
+
+#include <deque>
+
+#include "Simulator.h"
+
+#define TICKS_PER_S 16000000L
+
+#define MOVE_OK 0
+#define MOVE_ERR_NO_DIRECTION_PIN -1
+#define MOVE_ERR_SPEED_IS_UNDEFINED -2
+#define MOVE_ERR_ACCELERATION_IS_UNDEFINED -3
+
+#define MOVE_TIMED_OK 0
+#define MOVE_TIMED_EMPTY 3
+#define MOVE_TIMED_BUSY 5
+#define MOVE_TIMED_TOO_LARGE_ERROR -4
+
+#define AQE_OK 0
+#define AQE_QUEUE_FULL 1
+#define AQE_ERROR_TICKS_TOO_LOW -1
+#define AQE_ERROR_EMPTY_QUEUE_TO_START -2
+
+struct stepper_command_s {
+    uint16_t ticks;
+    uint8_t steps;
+    bool count_up;
+};
+
+// Entries the command queue of the real stepper holds
+#define SIM_QUEUE_LENGTH 32
+// CPU time a call to isRunning() costs, so busy-waiting advances the clock
+#define SIM_POLL_US 1
+
+class FastAccelStepper {
+  public:
+    void setDirectionPin(uint8_t pin, bool dirHighCountsUp = true,
+                         uint16_t dirChangeDelayUs = 0) {}
+    void setEnablePin(uint8_t pin, bool lowActive = true) {}
+    void setAutoEnable(bool autoEnable) {}
+    bool enableOutputs() { return _enabled = true; }
+    bool disableOutputs() {
+        _enabled = false;
+        return true;
+    }
+    bool isEnabled() const { return _enabled; }
+
+    int8_t setSpeedInHz(uint32_t speed) {
+        if (speed == 0) {
+            return -1;
+        }
+        _maxSpeed = speed;
+        return 0;
+    }
+    uint32_t getSpeedInMilliHz() const { return _maxSpeed * 1000; }
+
+    int8_t setAcceleration(int32_t acceleration) {
+        if (acceleration <= 0) {
+            return -1;
+        }
+        _acceleration = acceleration;
+        return 0;
+    }
+    int32_t getAcceleration() const { return _acceleration; }
+
+    // Speed and acceleration take effect right away in the simulation
+    void applySpeedAcceleration() {}
+
+    int32_t getCurrentPosition() {
+        _update();
+        return int32_t(lround(_position));
+    }
+    void setCurrentPosition(int32_t position) {
+        _update();
+        _target += position - int32_t(lround(_position));
+        _queueEnd += position - int32_t(lround(_position));
+        _position = position;
+    }
+    int32_t targetPos() const { return _target; }
+
+    int32_t getCurrentSpeedInMilliHz(bool realtime = true) {
+        _update();
+        return int32_t(_speed * 1000.0);
+    }
+
+    bool isRunning() {
+        Sim::spin(SIM_POLL_US);
+        _update();
+        return _ramping || !_slices.empty();
+    }
+
+    int8_t moveTo(int32_t position, bool blocking = false) {
+        _update();
+        if (_maxSpeed == 0) {
+            return MOVE_ERR_SPEED_IS_UNDEFINED;
+        }
+        if (_acceleration == 0) {
+            return MOVE_ERR_ACCELERATION_IS_UNDEFINED;
+        }
+        _target = position;
+        _queueEnd = position;
+        if (_ramping || position != int32_t(lround(_position))) {
+            _ramping = true;
+            _moves++;
+        }
+        return MOVE_OK;
+    }
+
+    int8_t move(int32_t distance, bool blocking = false) {
+        _update();
+        bool running = _ramping || !_slices.empty();
+        int32_t from = running ? _target : int32_t(lround(_position));
+        return moveTo(from + distance, blocking);
+    }
+
+    // Decelerate to a stop as fast as the acceleration allows
+    void stopMove() {
+        _update();
+        if (_ramping) {
+            double stopping =
+                _speed * fabs(_speed) / (2.0 * double(_acceleration));
+            _target = int32_t(lround(_position + stopping));
+            _queueEnd = _target;
+        }
+    }
+
+    void forceStop() {
+        _update();
+        _slices.clear();
+        _ramping = false;
+        _speed = 0.0;
+        _target = int32_t(lround(_position));
+        _queueEnd = _target;
+    }
+
+    void forceStopAndNewPosition(int32_t position) {
+        forceStop();
+        setCurrentPosition(position);
+    }
+
+    int8_t moveTimed(int16_t steps, uint32_t duration,
+                     uint32_t *actualDuration = NULL, bool start = true) {
+        _update();
+        if (_ramping || _slices.size() >= SIM_QUEUE_LENGTH) {
+            return MOVE_TIMED_BUSY;
+        }
+        if (duration == 0) {
+            return MOVE_TIMED_TOO_LARGE_ERROR;
+        }
+        if (_slices.empty()) {
+            _queueEnd = int32_t(lround(_position));
+        }
+
+        _queueEnd += steps;
+        _slices.push_back({double(duration) / TICKS_PER_S,
+                           double(steps) * TICKS_PER_S / duration, _queueEnd});
+        _target = _queueEnd;
+        if (actualDuration != NULL) {
+            *actualDuration = duration;
+        }
+        return _slices.size() == 1 ? MOVE_TIMED_EMPTY : MOVE_TIMED_OK;
+    }
+
+    int8_t addQueueEntry(const struct stepper_command_s *cmd,
+                         bool start = true) {
+        _update();
+        if (_ramping || _slices.size() >= SIM_QUEUE_LENGTH) {
+            return AQE_QUEUE_FULL;
+        }
+        if (cmd->ticks == 0) {
+            return AQE_ERROR_TICKS_TOO_LOW;
+        }
+        if (_slices.empty()) {
+            _queueEnd = int32_t(lround(_position));
+        }
+
+        // Steps at equal intervals, or a pause without any
+        int32_t steps = cmd->count_up ? cmd->steps : -int32_t(cmd->steps);
+        uint32_t ticks =
+            uint32_t(cmd->ticks) * (cmd->steps > 0 ? cmd->steps : 1);
+        _queueEnd += steps;
+        _slices.push_back({double(ticks) / TICKS_PER_S,
+                           double(steps) * TICKS_PER_S / ticks, _queueEnd});
+        _target = _queueEnd;
+        _entries++;
+        return AQE_OK;
+    }
+
+    uint32_t ticksInQueue() {
+        _update();
+        double seconds = 0.0;
+        for (const Slice &slice : _slices) {
+            seconds += slice.remaining;
+        }
+        return uint32_t(seconds * TICKS_PER_S);
+    }
+
+    // Statistics of the simulation
+    double getPeakSpeed() const { return _peakSpeed; }
+    void resetPeakSpeed() {
+        _update();
+        _peakSpeed = fabs(_speed);
+    }
+    // Speed the queued entries end at [steps/s]
+    double getQueueEndSpeed() const {
+        return _slices.empty() ? 0.0 : _slices.back().speed;
+    }
+    uint32_t getMoves() const { return _moves; }
+    uint32_t getQueueEntries() const { return _entries; }
+
+  private:
+    struct Slice {
+        double remaining;  // [s]
+        double speed;      // [steps/s]
+        int32_t end;       // position at the end of the slice
+    };
+
+    void _update() {
+        int64_t now = Sim::now();
+        double dt = (now - _lastUpdate) / 1.0e6;
+        _lastUpdate = now;
+
+        while (dt > 0.0 && !_slices.empty()) {
+            Slice &slice = _slices.front();
+            double step = fmin(dt, slice.remaining);
+            _position += slice.speed * step;
+            _speed = slice.speed;
+            _peakSpeed = fmax(_peakSpeed, fabs(_speed));
+            slice.remaining -= step;
+            dt -= step;
+            if (slice.remaining <= 1e-9) {
+                _position = slice.end;
+                _slices.pop_front();
+            }
+        }
+        if (_slices.empty() && !_ramping) {
+            _speed = 0.0;
+        }
+
+        _advanceRamp(dt);
+        _peakSpeed = fmax(_peakSpeed, fabs(_speed));
+    }
+
+    // Piecewise exact integration of the ramp, one phase per iteration
+    void _advanceRamp(double dt) {
+        const double a = _acceleration;
+        const double vmax = _maxSpeed;
+
+        for (int phase = 0; dt > 0.0 && _ramping && phase < 64; phase++) {
+            double distance = _target - _position;
+            if (fabs(distance) < 0.5 && fabs(_speed) < 1e-6) {
+                _position = _target;
+                _speed = 0.0;
+                _ramping = false;
+                break;
+            }
+
+            // Work towards the target in positive direction
+            double dir = distance > 0.0   ? 1.0
+                         : distance < 0.0 ? -1.0
+                         : (_speed > 0.0 ? 1.0 : -1.0);
+            double x = distance * dir;
+            double u = _speed * dir;
+            double time = 0.0;
+            double accel = 0.0;
+            bool braking = false;
+
+            if (u < 0.0) {
+                // Moving away: turn around first
+                time = -u / a;
+                accel = a;
+            } else if (u * u / (2.0 * a) >= x - 1e-6) {
+                // Stopping distance reached, or already too close
+                time = u / a;
+                accel = -a;
+                braking = true;
+            } else if (u > vmax) {
+                time = (u - vmax) / a;
+                accel = -a;
+            } else if (u < vmax - 1e-6) {
+                // Accelerate up to top speed or the braking point
+                double peak = fmin(sqrt((2.0 * a * x + u * u) / 2.0), vmax);
+                time = (peak - u) / a;
+                accel = a;
+            } else {
+                u = vmax;
+                time = (x - vmax * vmax / (2.0 * a)) / vmax;
+            }
+
+            double step = fmin(dt, fmax(time, 0.0));
+            _position += dir * (u * step + 0.5 * accel * step * step);
+            _speed = dir * (u + accel * step);
+            dt -= step;
+
+            if (braking && step >= time) {
+                _speed = 0.0;
+            }
+        }
+
+        // Came to a stop at the target right at the end of the interval
+        if (_ramping && fabs(_target - _position) < 0.5 &&
+            fabs(_speed) < 1e-6) {
+            _position = _target;
+            _speed = 0.0;
+            _ramping = false;
+        }
+    }
+
+    bool _enabled = false;
+    uint32_t _maxSpeed = 0;
+    int32_t _acceleration = 0;
+    double _position = 0.0;
+    double _speed = 0.0;
+    int32_t _target = 0;
+    int32_t _queueEnd = 0;
+    bool _ramping = false;
+    std::deque<Slice> _slices;
+    int64_t _lastUpdate = 0;
+    double _peakSpeed = 0.0;
+    uint32_t _moves = 0;
+    uint32_t _entries = 0;
+};
+
+class FastAccelStepperEngine {
+  public:
+    void init(uint8_t cpuCore = 0) {}
+    FastAccelStepper *stepperConnectToPin(uint8_t stepPin) {
+        return new FastAccelStepper();
+    }
+};
+
+#endif  // SOFTWARE_SIM_FASTACCELSTEPPER_H
@@ -0,0 +1,352 @@
+#include "Replayer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <string>
+
+#include "Arduino.h"
+#include "command/coalescer.hpp"
+#include "command/commands.hpp"
+#include "command/frames.hpp"
+#include "esp_timer.h"
+#include "utils/SpscRing.h"
+
+// As COMMAND_QUEUE_LENGTH and NimbleEvents::pollTicks of the firmware
+#define REPLAY_QUEUE_LENGTH 32
+static const TickType_t replayPollTicks = pdMS_TO_TICKS(50);
+
+struct ReplayItem {
+    CommandValue command;
+    int64_t receivedUs;
+};
+
+struct Replay {
+    StrokeEngine *engine;
+    float travelMm;
+    const CommandCaptureRecord *records;
+    std::vector<int64_t> dueUs;
+    size_t next = 0;
+    int64_t startUs = 0;
+
+    esp_timer_handle_t timer = nullptr;
+    TaskHandle_t loopTask = nullptr;
+    SpscRing<ReplayItem, REPLAY_QUEUE_LENGTH> queue;
+    bool isDone = false;
+    bool isFinished = false;
+
+    ReplayStats stats;
+    std::vector<int64_t> latencies;
+    uint64_t depthSum = 0;
+    int64_t decodeNs = 0;
+};
+
+static int64_t hostNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+CommandCaptureRecord makeCaptureRecord(uint32_t timeUs, CaptureSource source,
+                                       const void *data, size_t length) {
+    CommandCaptureRecord record = {};
+    record.timeUs = timeUs;
+    record.source = (uint8_t)source;
+    record.length = length < 255 ? length : 255;
+    memcpy(record.data, data, std::min(length, (size_t)COMMAND_CAPTURE_DATA));
+    return record;
+}
+
+static bool decodeRecord(const CommandCaptureRecord &record,
+                         CommandValue &command) {
+    if ((CaptureSource)record.source == CaptureSource::text) {
+        return parseCommand((const char *)record.data, record.length,
+                            command);
+    }
+    uint8_t seq = 0;
+    return decodeCommandFrame(record.data, record.length, command, seq) ==
+           FrameStatus::ok;
+}
+
+// The BLE host task (or UDP control) receiving the next write
+static void deliver(void *arg) {
+    Replay &replay = *(Replay *)arg;
+    const CommandCaptureRecord &record = replay.records[replay.next];
+    replay.stats.writes++;
+
+    CommandValue command = {Commands::ignore, 0};
+    int64_t started = hostNs();
+    bool isDecoded = record.length <= COMMAND_CAPTURE_DATA &&
+                     decodeRecord(record, command);
+    replay.decodeNs += hostNs() - started;
+
+    if (record.length > COMMAND_CAPTURE_DATA) {
+        replay.stats.truncated++;
+    } else if (!isDecoded) {
+        replay.stats.rejected++;
+    } else if (!replay.queue.push({command, Sim::now()})) {
+        replay.stats.dropped++;
+    } else {
+        size_t depth = replay.queue.size();
+        replay.stats.maxQueueDepth = std::max(replay.stats.maxQueueDepth,
+                                              depth);
+        replay.depthSum += depth;
+        xTaskNotifyGive(replay.loopTask);
+    }
+
+    if (++replay.next < replay.dueUs.size()) {
+        int64_t due = replay.startUs + replay.dueUs[replay.next];
+        esp_timer_start_once(replay.timer,
+                             std::max(due - Sim::now(), (int64_t)0));
+    }
+}
+
+static void applySpeed(StrokeEngine &engine, float speed) {
+    if (speed < 0.1f) {
+        engine.stopMotion();
+    } else if (engine.getState() == READY) {
+        engine.startPattern();
+    }
+    engine.setSpeed(speed * 3, true);
+}
+
+static void applyValue(Replay &replay, SetValue value, int hundredths) {
+    StrokeEngine &engine = *replay.engine;
+    float percent = percentOf(hundredths);
+    switch (value) {
+        case setValueSpeed:
+            applySpeed(engine, percent);
+            break;
+        case setValueStroke:
+            engine.setStroke(0.01f * percent * replay.travelMm, true);
+            break;
+        case setValueDepth:
+            engine.setDepth(0.01f * percent * replay.travelMm, true);
+            break;
+        case setValueSensation:
+            engine.setSensation(percent * 2.0f - 100.0f, true);
+            break;
+        default:
+            engine.setPattern(
+                hundredths / setValueScale % engine.getNumberOfPattern(),
+                false);
+            break;
+    }
+}
+
+// What OSSM::ble_command and the stroke engine task make of a command
+static void applyCommand(Replay &replay, const CommandValue &command) {
+    StrokeEngine &engine = *replay.engine;
+    replay.stats.applied++;
+    switch (command.command) {
+        case Commands::setSpeed:
+            applyValue(replay, setValueSpeed, command.value);
+            break;
+        case Commands::setStroke:
+            applyValue(replay, setValueStroke, command.value);
+            break;
+        case Commands::setDepth:
+            applyValue(replay, setValueDepth, command.value);
+            break;
+        case Commands::setSensation:
+            applyValue(replay, setValueSensation, command.value);
+            break;
+        case Commands::setPattern:
+            applyValue(replay, setValuePattern, command.value);
+            break;
+        case Commands::setValues:
+            engine.beginUpdate();
+            for (int i = 0; i < setValueCount; i++) {
+                if (command.value & (1 << i)) {
+                    applyValue(replay, (SetValue)i, command.values[i]);
+                }
+            }
+            engine.endUpdate();
+            break;
+        case Commands::streamPosition:
+            if (engine.getState() == STREAMING) {
+                float position = engine.getDepth() - engine.getStroke() +
+                                 0.01f * command.value * engine.getStroke();
+                engine.streamTo(std::max(position, 0.0f), command.time);
+            }
+            break;
+        default:
+            // Mode changes and scripts need the state machine
+            break;
+    }
+}
+
+// nimbleLoop: drains the queue on every signal, like applyQueuedCommands
+static void replayLoop(void *arg) {
+    Replay &replay = *(Replay *)arg;
+    CommandCoalescer coalescer;
+    auto apply = [&](const CommandValue &command) {
+        applyCommand(replay, command);
+    };
+
+    while (!replay.isDone) {
+        ulTaskNotifyTake(pdTRUE, replayPollTicks);
+
+        ReplayItem item;
+        bool isProcessed = false;
+        while (replay.queue.pop(item)) {
+            isProcessed = true;
+            replay.latencies.push_back(Sim::now() - item.receivedUs);
+            if (!coalescer.add(item.command)) {
+                coalescer.flush(apply);
+                apply(item.command);
+            }
+        }
+        if (isProcessed) {
+            coalescer.flush(apply);
+        }
+    }
+
+    replay.stats.superseded = coalescer.getSupersededCount();
+    replay.isFinished = true;
+    vTaskDelete(nullptr);
+}
+
+ReplayStats replayCapture(StrokeEngine *engine,
+                          const CommandCaptureRecord *records, size_t count,
+                          float speedup, float travelMm) {
+    Replay replay;
+    replay.engine = engine;
+    replay.travelMm = travelMm;
+    replay.records = records;
+
+    // Captured times wrap after 71 minutes, their differences don't
+    int64_t elapsedUs = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (i > 0) {
+            elapsedUs += (uint32_t)(records[i].timeUs - records[i - 1].timeUs);
+        }
+        replay.dueUs.push_back(int64_t(elapsedUs / speedup));
+    }
+
+    int64_t loopNsBefore = Sim::cpuTime("nimbleLoop");
+    xTaskCreate(replayLoop, "nimbleLoop", 4 * configMINIMAL_STACK_SIZE,
+                &replay, 5, &replay.loopTask);
+    esp_timer_create_args_t timerArgs = {};
+    timerArgs.callback = &deliver;
+    timerArgs.arg = &replay;
+    timerArgs.name = "replay";
+    esp_timer_create(&timerArgs, &replay.timer);
+
+    replay.startUs = Sim::now();
+    if (count > 0) {
+        esp_timer_start_once(replay.timer, 0);
+        Sim::runFor(replay.dueUs.back());
+    }
+    // Until the last command went through
+    while (replay.next < count || !replay.queue.empty()) {
+        Sim::runFor(1000);
+    }
+    ReplayStats stats = replay.stats;
+    stats.durationUs = Sim::now() - replay.startUs;
+    int64_t loopNs = Sim::cpuTime("nimbleLoop") - loopNsBefore;
+
+    replay.isDone = true;
+    xTaskNotifyGive(replay.loopTask);
+    while (!replay.isFinished) {
+        Sim::runFor(1000);
+    }
+    esp_timer_delete(replay.timer);
+    stats.superseded = replay.stats.superseded;
+
+    std::vector<int64_t> &latencies = replay.latencies;
+    if (!latencies.empty()) {
+        std::sort(latencies.begin(), latencies.end());
+        int64_t sum = 0;
+        for (int64_t latency : latencies) {
+            sum += latency;
+        }
+        stats.meanLatencyUs = sum / (int64_t)latencies.size();
+        stats.p99LatencyUs = latencies[latencies.size() * 99 / 100];
+        stats.maxLatencyUs = latencies.back();
+        stats.meanQueueDepth = double(replay.depthSum) / latencies.size();
+        stats.loopNsPerCommand = loopNs / (int64_t)latencies.size();
+    }
+    if (stats.writes > 0) {
+        stats.decodeNsPerWrite = replay.decodeNs / stats.writes;
+    }
+    return stats;
+}
+
+// Lines as dumpCapture() prints them, after the log prefix:
+//   <time> <source> <length> <hex>
+static bool parseDumpLine(const char *line, CommandCaptureRecord &record) {
+    static const char *const sourceNames[] = {"text", "binary", "udp"};
+    for (int source = 0; source < 3; source++) {
+        std::string name = std::string(" ") + sourceNames[source] + " ";
+        const char *at = strstr(line, name.c_str());
+        if (at == nullptr) {
+            continue;
+        }
+
+        // The time is the number right before the source
+        const char *start = at;
+        while (start > line && start[-1] >= '0' && start[-1] <= '9') {
+            start--;
+        }
+        unsigned long time = 0;
+        unsigned length = 0;
+        char hex[2 * COMMAND_CAPTURE_DATA + 2] = "";
+        if (start == at || sscanf(start, "%lu", &time) != 1 ||
+            sscanf(at + name.size(), "%u %117s", &length, hex) < 1) {
+            return false;
+        }
+
+        uint8_t data[COMMAND_CAPTURE_DATA] = {};
+        size_t bytes = strlen(hex) / 2;
+        for (size_t i = 0; i < bytes && i < COMMAND_CAPTURE_DATA; i++) {
+            unsigned byte = 0;
+            sscanf(hex + 2 * i, "%2x", &byte);
+            data[i] = byte;
+        }
+        record = makeCaptureRecord(time, (CaptureSource)source, data,
+                                   std::min((size_t)length, bytes));
+        record.length = length;
+        return true;
+    }
+    return false;
+}
+
+std::vector<CommandCaptureRecord> loadCapture(const char *path) {
+    std::vector<CommandCaptureRecord> records;
+    FILE *file = fopen(path, "rb");
+    if (file == nullptr) {
+        return records;
+    }
+
+    size_t pathLength = strlen(path);
+    CommandCaptureRecord record;
+    if (pathLength > 4 && strcmp(path + pathLength - 4, ".bin") == 0) {
+        while (fread(&record, sizeof(record), 1, file) == 1) {
+            records.push_back(record);
+        }
+    } else {
+        char line[512];
+        while (fgets(line, sizeof(line), file) != nullptr) {
+            if (parseDumpLine(line, record)) {
+                records.push_back(record);
+            }
+        }
+    }
+    fclose(file);
+    return records;
+}
+
+void printReplayStats(const char *name, const ReplayStats &stats) {
+    printf("%s: %u writes in %.1fs, %u applied, %u superseded, %u rejected, "
+           "%u truncated, %u dropped\n",
+           name, stats.writes, stats.durationUs / 1e6, stats.applied,
+           stats.superseded, stats.rejected, stats.truncated, stats.dropped);
+    printf("%s: latency mean %lldus, p99 %lldus, max %lldus; queue depth "
+           "mean %.2f, max %zu; decode %lldns/write, loop %lldns/command\n",
+           name, (long long)stats.meanLatencyUs,
+           (long long)stats.p99LatencyUs, (long long)stats.maxLatencyUs,
+           stats.meanQueueDepth, stats.maxQueueDepth,
+           (long long)stats.decodeNsPerWrite,
+           (long long)stats.loopNsPerCommand);
+}
@@ -0,0 +1,57 @@
+#ifndef SOFTWARE_REPLAYER_H
+#define SOFTWARE_REPLAYER_H
+
+/**
+ * Plays captured command writes (see services/capture.h) back against a
+ * StrokeEngine in the simulator. The writes arrive from an esp_timer at
+ * their captured times, divided by speedup, and are decoded the way the
+ * characteristics decode them. A "nimbleLoop" task drains the queue,
+ * coalesces set commands and applies them the way the stroke engine task of
+ * the OSSM does, so the stats show what the write pattern of an app costs
+ * the command path.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+#include "StrokeEngine.h"
+#include "structs/CommandCaptureRecord.h"
+
+struct ReplayStats {
+    uint32_t writes = 0;      // Records played
+    uint32_t truncated = 0;   // Cut off by the capture, skipped
+    uint32_t rejected = 0;    // Failed to decode
+    uint32_t dropped = 0;     // The queue was full
+    uint32_t superseded = 0;  // Replaced by a newer set command
+    uint32_t applied = 0;     // Handed to the engine
+    size_t maxQueueDepth = 0;  // Commands queued, including the new one
+    double meanQueueDepth = 0;
+    // Virtual time from the write until nimbleLoop took the command
+    int64_t meanLatencyUs = 0;
+    int64_t p99LatencyUs = 0;
+    int64_t maxLatencyUs = 0;
+    // Host time decoding a write, and nimbleLoop spent per command
+    int64_t decodeNsPerWrite = 0;
+    int64_t loopNsPerCommand = 0;
+    int64_t durationUs = 0;  // Virtual time the replay took
+};
+
+// Builds a record as the capture would, for traces written by hand
+CommandCaptureRecord makeCaptureRecord(uint32_t timeUs, CaptureSource source,
+                                       const void *data, size_t length);
+
+// Replays count records on a running engine. Stroke and depth percentages
+// are of travelMm.
+ReplayStats replayCapture(StrokeEngine *engine,
+                          const CommandCaptureRecord *records, size_t count,
+                          float speedup, float travelMm);
+
+// Loads a capture: raw records as downloaded if the path ends in .bin, the
+// lines dumpCapture() printed otherwise. Empty if it can't be read.
+std::vector<CommandCaptureRecord> loadCapture(const char *path);
+
+void printReplayStats(const char *name, const ReplayStats &stats);
+
+#endif  // SOFTWARE_REPLAYER_H
@@ -0,0 +1,524 @@
+#include "Simulator.h"
+
+#include <chrono>
+#include <climits>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "esp_timer.h"
+
+// What a blocked task waits for
+enum class Wait { none, delay, notify, suspend, semaphore, queue };
+
+struct SimTask {
+    std::string name;
+    UBaseType_t priority = 0;
+    TaskFunction_t function = nullptr;
+    void *parameter = nullptr;
+    std::thread thread;
+    std::condition_variable wakeup;
+
+    bool ready = false;
+    Wait wait = Wait::none;
+    void *waitingOn = nullptr;
+    int64_t wakeAt = INT64_MAX;
+    uint64_t readySince = 0;  // FIFO order among equal priorities
+    uint32_t notifications = 0;
+    bool deleted = false;
+    bool finished = false;
+
+    int64_t cpuNs = 0;
+    uint32_t wakeups = 0;
+};
+
+struct SimSemaphore {
+    bool taken;
+};
+
+struct SimQueue {
+    size_t length;
+    size_t itemSize;
+    std::deque<std::vector<uint8_t>> items;
+};
+
+struct esp_timer {
+    esp_timer_cb_t callback;
+    void *arg;
+    bool armed;
+    int64_t due;
+    int64_t period;
+};
+
+// Thrown out of a blocking call to end a task
+struct SimExit {};
+
+static std::mutex simLock;
+static SimTask *current = nullptr;
+static SimTask *mainTask = nullptr;
+static std::vector<SimTask *> tasks;
+static std::vector<esp_timer *> timers;
+static std::map<int, int> pins;
+static int64_t virtualTime = 0;
+static uint64_t readySequence = 0;
+static bool exiting = false;
+static std::chrono::steady_clock::time_point runningSince;
+
+static void makeReady(SimTask *task) {
+    if (task->deleted || task->finished) {
+        return;
+    }
+    task->ready = true;
+    task->wait = Wait::none;
+    task->waitingOn = nullptr;
+    task->wakeAt = INT64_MAX;
+    task->readySince = ++readySequence;
+    task->wakeups++;
+}
+
+static void wakeWaiters(Wait wait, void *object) {
+    for (SimTask *task : tasks) {
+        if (!task->ready && task->wait == wait && task->waitingOn == object) {
+            makeReady(task);
+        }
+    }
+}
+
+static void fireTimers() {
+    while (true) {
+        esp_timer *next = nullptr;
+        for (esp_timer *timer : timers) {
+            if (timer->armed && timer->due <= virtualTime &&
+                (next == nullptr || timer->due < next->due)) {
+                next = timer;
+            }
+        }
+        if (next == nullptr) {
+            return;
+        }
+
+        if (next->period > 0) {
+            next->due += next->period;
+        } else {
+            next->armed = false;
+        }
+        next->callback(next->arg);
+    }
+}
+
+// Picks the task to run next, advancing the clock while everyone waits
+static SimTask *pickNext() {
+    while (true) {
+        fireTimers();
+        for (SimTask *task : tasks) {
+            if (!task->ready && task->wakeAt <= virtualTime) {
+                makeReady(task);
+            }
+        }
+
+        SimTask *next = nullptr;
+        for (SimTask *task : tasks) {
+            if (task->ready &&
+                (next == nullptr || task->priority > next->priority ||
+                 (task->priority == next->priority &&
+                  task->readySince < next->readySince))) {
+                next = task;
+            }
+        }
+        if (next != nullptr) {
+            return next;
+        }
+
+        int64_t wake = INT64_MAX;
+        for (SimTask *task : tasks) {
+            wake = task->wakeAt < wake ? task->wakeAt : wake;
+        }
+        for (esp_timer *timer : timers) {
+            if (timer->armed && timer->due < wake) {
+                wake = timer->due;
+            }
+        }
+        if (wake == INT64_MAX) {
+            fprintf(stderr, "Simulator deadlock: every task waits forever\n");
+            abort();
+        }
+        virtualTime = wake;
+    }
+}
+
+static void account(SimTask *task) {
+    task->cpuNs += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       std::chrono::steady_clock::now() - runningSince)
+                       .count();
+}
+
+// Passes the CPU on and returns once self is scheduled again
+static void handOver(SimTask *self, SimTask *next) {
+    account(self);
+    std::unique_lock<std::mutex> guard(simLock);
+    current = next;
+    next->wakeup.notify_one();
+    self->wakeup.wait(guard, [self] { return current == self; });
+    runningSince = std::chrono::steady_clock::now();
+}
+
+static void reschedule() {
+    SimTask *self = current;
+    SimTask *next = pickNext();
+    if (next != self) {
+        handOver(self, next);
+    }
+    if (exiting && self != mainTask) {
+        throw SimExit();
+    }
+}
+
+static int64_t deadline(TickType_t ticks) {
+    if (ticks == portMAX_DELAY) {
+        return INT64_MAX;
+    }
+    return virtualTime + int64_t(ticks) * portTICK_PERIOD_MS * 1000;
+}
+
+static void block(Wait wait, void *object, int64_t wakeAt) {
+    current->ready = false;
+    current->wait = wait;
+    current->waitingOn = object;
+    current->wakeAt = wakeAt;
+    reschedule();
+}
+
+static void runTask(SimTask *task) {
+    {
+        std::unique_lock<std::mutex> guard(simLock);
+        task->wakeup.wait(guard, [task] { return current == task; });
+    }
+    runningSince = std::chrono::steady_clock::now();
+
+    if (!exiting) {
+        try {
+            task->function(task->parameter);
+        } catch (const SimExit &) {
+        }
+    }
+
+    account(task);
+    task->finished = true;
+    task->ready = false;
+    task->wakeAt = INT64_MAX;
+
+    SimTask *next = exiting ? mainTask : pickNext();
+    std::unique_lock<std::mutex> guard(simLock);
+    current = next;
+    next->wakeup.notify_one();
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char *name,
+                                   uint32_t stackSize, void *parameter,
+                                   UBaseType_t priority, TaskHandle_t *handle,
+                                   BaseType_t core) {
+    SimTask *task = new SimTask();
+    task->name = name;
+    task->priority = priority;
+    task->function = function;
+    task->parameter = parameter;
+    tasks.push_back(task);
+    makeReady(task);
+    task->wakeups = 0;
+    task->thread = std::thread(runTask, task);
+
+    if (handle != nullptr) {
+        *handle = task;
+    }
+    return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t function, const char *name,
+                       uint32_t stackSize, void *parameter,
+                       UBaseType_t priority, TaskHandle_t *handle) {
+    return xTaskCreatePinnedToCore(function, name, stackSize, parameter,
+                                   priority, handle, 0);
+}
+
+void vTaskDelete(TaskHandle_t task) {
+    if (task == nullptr || task == current) {
+        throw SimExit();
+    }
+    task->deleted = true;
+    task->ready = false;
+    task->wait = Wait::suspend;
+    task->wakeAt = INT64_MAX;
+}
+
+void vTaskDelay(TickType_t ticks) {
+    if (ticks == 0) {
+        current->readySince = ++readySequence;
+        reschedule();
+        return;
+    }
+    block(Wait::delay, nullptr, deadline(ticks));
+}
+
+void vTaskSuspend(TaskHandle_t task) {
+    if (task == nullptr || task == current) {
+        block(Wait::suspend, nullptr, INT64_MAX);
+        return;
+    }
+    task->ready = false;
+    task->wait = Wait::suspend;
+    task->waitingOn = nullptr;
+    task->wakeAt = INT64_MAX;
+}
+
+void vTaskResume(TaskHandle_t task) {
+    if (task != nullptr && !task->ready && task->wait == Wait::suspend) {
+        makeReady(task);
+    }
+}
+
+TickType_t xTaskGetTickCount() {
+    return TickType_t(virtualTime / 1000 / portTICK_PERIOD_MS);
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle() { return current; }
+
+uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticks) {
+    SimTask *self = current;
+    if (self->notifications == 0 && ticks > 0) {
+        block(Wait::notify, self, deadline(ticks));
+    }
+
+    uint32_t value = self->notifications;
+    if (value > 0) {
+        self->notifications = clearOnExit ? 0 : value - 1;
+    }
+    return value;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+    if (task == nullptr) {
+        return pdFAIL;
+    }
+    task->notifications++;
+    if (!task->ready && task->wait == Wait::notify) {
+        makeReady(task);
+    }
+    return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *woken) {
+    xTaskNotifyGive(task);
+    if (woken != nullptr) {
+        *woken = pdFALSE;
+    }
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex() { return new SimSemaphore{false}; }
+
+SemaphoreHandle_t xSemaphoreCreateBinary() { return new SimSemaphore{true}; }
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks) {
+    int64_t until = deadline(ticks);
+    while (semaphore->taken) {
+        if (ticks == 0 || virtualTime >= until) {
+            return pdFALSE;
+        }
+        block(Wait::semaphore, semaphore, until);
+    }
+    semaphore->taken = true;
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) {
+    semaphore->taken = false;
+    wakeWaiters(Wait::semaphore, semaphore);
+    return pdTRUE;
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize) {
+    return new SimQueue{length, itemSize, {}};
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item,
+                      TickType_t ticks) {
+    int64_t until = deadline(ticks);
+    while (queue->items.size() >= queue->length) {
+        if (ticks == 0 || virtualTime >= until) {
+            return errQUEUE_FULL;
+        }
+        block(Wait::queue, queue, until);
+    }
+
+    const uint8_t *bytes = static_cast<const uint8_t *>(item);
+    queue->items.emplace_back(bytes, bytes + queue->itemSize);
+    wakeWaiters(Wait::queue, queue);
+    return pdTRUE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t ticks) {
+    int64_t until = deadline(ticks);
+    while (queue->items.empty()) {
+        if (ticks == 0 || virtualTime >= until) {
+            return pdFALSE;
+        }
+        block(Wait::queue, queue, until);
+    }
+
+    memcpy(item, queue->items.front().data(), queue->itemSize);
+    queue->items.pop_front();
+    wakeWaiters(Wait::queue, queue);
+    return pdTRUE;
+}
+
+BaseType_t xQueueReset(QueueHandle_t queue) {
+    queue->items.clear();
+    wakeWaiters(Wait::queue, queue);
+    return pdPASS;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) {
+    return queue->items.size();
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *args,
+                           esp_timer_handle_t *handle) {
+    if (args == nullptr || args->callback == nullptr || handle == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *handle = new esp_timer{args->callback, args->arg, false, 0, 0};
+    timers.push_back(*handle);
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout) {
+    if (timer->armed) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    timer->armed = true;
+    timer->due = virtualTime + int64_t(timeout);
+    timer->period = 0;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer,
+                                   uint64_t period) {
+    if (timer->armed) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    timer->armed = true;
+    timer->due = virtualTime + int64_t(period);
+    timer->period = int64_t(period);
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer) {
+    if (!timer->armed) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    timer->armed = false;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer) {
+    for (size_t i = 0; i < timers.size(); i++) {
+        if (timers[i] == timer) {
+            timers.erase(timers.begin() + i);
+            break;
+        }
+    }
+    delete timer;
+    return ESP_OK;
+}
+
+bool esp_timer_is_active(esp_timer_handle_t timer) { return timer->armed; }
+
+int64_t esp_timer_get_time() { return virtualTime; }
+
+namespace Sim {
+    void reset() {
+        if (mainTask != nullptr) {
+            shutdown();
+        }
+
+        virtualTime = 0;
+        readySequence = 0;
+        pins.clear();
+
+        mainTask = new SimTask();
+        mainTask->name = "main";
+        mainTask->priority = 1;
+        makeReady(mainTask);
+        tasks.push_back(mainTask);
+        current = mainTask;
+        runningSince = std::chrono::steady_clock::now();
+    }
+
+    void shutdown() {
+        // Every task throws out of its blocking call and hands back to main
+        exiting = true;
+        for (SimTask *task : tasks) {
+            if (task != mainTask && !task->finished) {
+                handOver(mainTask, task);
+            }
+        }
+        for (SimTask *task : tasks) {
+            if (task->thread.joinable()) {
+                task->thread.join();
+            }
+            delete task;
+        }
+        tasks.clear();
+
+        // Timers belong to the objects that created them, which are gone
+        timers.clear();
+
+        exiting = false;
+        mainTask = nullptr;
+        current = nullptr;
+    }
+
+    void runFor(int64_t us) {
+        block(Wait::delay, nullptr, virtualTime + us);
+    }
+
+    void spin(int64_t us) {
+        virtualTime += us;
+        fireTimers();
+    }
+
+    int64_t now() { return virtualTime; }
+
+    int64_t cpuTime(const char *name) {
+        int64_t total = 0;
+        for (SimTask *task : tasks) {
+            if (task->name == name) {
+                total += task->cpuNs;
+            }
+        }
+        return total;
+    }
+
+    uint32_t wakeups(const char *name) {
+        uint32_t total = 0;
+        for (SimTask *task : tasks) {
+            if (task->name == name) {
+                total += task->wakeups;
+            }
+        }
+        return total;
+    }
+
+    void setPin(int pin, int level) { pins[pin] = level; }
+
+    int getPin(int pin) {
+        auto level = pins.find(pin);
+        return level != pins.end() ? level->second : 0;
+    }
+}  // namespace Sim
@@ -0,0 +1,106 @@
+#ifndef SOFTWARE_SIMULATOR_H
+#define SOFTWARE_SIMULATOR_H
+
+/**
+ * Host simulator for the StrokeEngine: a FreeRTOS shim that runs every task
+ * on its own thread in virtual time. Only one task runs at a time and it runs
+ * until it blocks, then the highest priority ready task continues. Once all
+ * tasks are blocked the clock jumps to the next timeout or esp_timer, so a
+ * session of hours plays out in well under a second.
+ *
+ * The calling thread becomes the "main" task on Sim::reset() and lets the
+ * other tasks run with Sim::runFor().
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct SimTask *TaskHandle_t;
+typedef struct SimSemaphore *SemaphoreHandle_t;
+typedef struct SimQueue *QueueHandle_t;
+typedef void (*TaskFunction_t)(void *);
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS pdTRUE
+#define pdFAIL pdFALSE
+#define errQUEUE_FULL pdFALSE
+#define portMAX_DELAY ((TickType_t)0xffffffffUL)
+#define portTICK_PERIOD_MS ((TickType_t)1)
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms) / portTICK_PERIOD_MS)
+#define configMAX_PRIORITIES 25
+#define configMINIMAL_STACK_SIZE 768
+#define tskIDLE_PRIORITY 0
+#define IRAM_ATTR
+
+// Only one task runs at a time, critical sections are free
+typedef struct {
+    int owner;
+} portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED {0}
+#define portENTER_CRITICAL(mux) ((void)(mux))
+#define portEXIT_CRITICAL(mux) ((void)(mux))
+#define portENTER_CRITICAL_ISR(mux) ((void)(mux))
+#define portEXIT_CRITICAL_ISR(mux) ((void)(mux))
+#define portYIELD_FROM_ISR(...) ((void)0)
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char *name,
+                                   uint32_t stackSize, void *parameter,
+                                   UBaseType_t priority, TaskHandle_t *handle,
+                                   BaseType_t core);
+BaseType_t xTaskCreate(TaskFunction_t function, const char *name,
+                       uint32_t stackSize, void *parameter,
+                       UBaseType_t priority, TaskHandle_t *handle);
+void vTaskDelete(TaskHandle_t task);
+void vTaskDelay(TickType_t ticks);
+void vTaskSuspend(TaskHandle_t task);
+void vTaskResume(TaskHandle_t task);
+TickType_t xTaskGetTickCount();
+TaskHandle_t xTaskGetCurrentTaskHandle();
+uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticks);
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *woken);
+
+SemaphoreHandle_t xSemaphoreCreateMutex();
+SemaphoreHandle_t xSemaphoreCreateBinary();
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore);
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize);
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t ticks);
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t ticks);
+BaseType_t xQueueReset(QueueHandle_t queue);
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue);
+
+namespace Sim {
+    // Starts a new virtual machine at time 0. Ends tasks of a previous run.
+    void reset();
+
+    // Ends all tasks. Call it before the objects they use go out of scope.
+    void shutdown();
+
+    // Lets the other tasks run for the given virtual time in [µs]
+    void runFor(int64_t us);
+
+    // The calling task keeps the CPU busy for us [µs], e.g. while polling
+    void spin(int64_t us);
+
+    // Virtual time since reset() in [µs]
+    int64_t now();
+
+    // Host time the tasks of that name spent running in [ns]
+    int64_t cpuTime(const char *name);
+
+    // Number of times the tasks of that name were woken up
+    uint32_t wakeups(const char *name);
+
+    // Level digitalRead() returns for a pin
+    void setPin(int pin, int level);
+    int getPin(int pin);
+}  // namespace Sim
+
+#endif  // SOFTWARE_SIMULATOR_H
@@ -0,0 +1,13 @@
+#ifndef SOFTWARE_SIM_ESP_CPU_H
+#define SOFTWARE_SIM_ESP_CPU_H
+
+#include <stdint.h>
+
+#include "esp_timer.h"
+
+// Cycle counter of a 240 MHz core, running on the virtual clock
+inline uint32_t esp_cpu_get_cycle_count() {
+    return (uint32_t)(esp_timer_get_time() * 240);
+}
+
+#endif  // SOFTWARE_SIM_ESP_CPU_H
@@ -0,0 +1,601 @@
+// Runs the StrokeEngine and all patterns on the host against a simulated
+// FastAccelStepper in virtual time. The headers next to this file stand in for
+// the Arduino core, FreeRTOS, esp_timer and FastAccelStepper, so it needs a
+// native environment, e.g.
+//
+//   g++ -std=gnu++17 -Itest/test_simulator -Isrc -Ilib/StrokeEngine/src
+//       test/test_simulator/*.cpp lib/StrokeEngine/src/*.cpp -lpthread
+
+#include <chrono>
+
+#include "FastAccelStepper.h"
+#include "PatternMath.h"
+#include "Replayer.h"
+#include "StrokeEngine.h"
+#include "unity.h"
+
+static machineGeometry machine = {.physicalTravel = 150.0,
+                                  .keepoutBoundary = 6.0};
+
+static motorProperties motor = {.maxSpeed = 666.0,
+                                .maxAcceleration = 10000.0,
+                                .stepsPerMillimeter = 20.0,
+                                .invertDirection = true,
+                                .enableActiveLow = true,
+                                .stepPin = 14,
+                                .directionPin = 27,
+                                .enablePin = 26};
+
+static const int maxStep = int(0.5 + (150.0 - 2 * 6.0) * 20.0);
+
+static FastAccelStepper *stepper = nullptr;
+static StrokeEngine *engine = nullptr;
+
+void setUp(void) {
+    Sim::reset();
+    stepper = new FastAccelStepper();
+    engine = new StrokeEngine();
+}
+
+void tearDown(void) {
+    // Tasks must be gone before the engine they run on
+    Sim::shutdown();
+    delete engine;
+    delete stepper;
+}
+
+// Homes the engine and starts a pattern from the middle of the machine
+static void startPattern(int pattern, LoopMode mode, float speed = 60.0) {
+    engine->begin(&machine, &motor, stepper);
+    engine->setLoopMode(mode);
+    engine->thisIsHome();
+    Sim::runFor(2000000);
+
+    engine->setPattern(pattern, false);
+    engine->setDepth(120.0, false);
+    engine->setStroke(80.0, false);
+    engine->setSensation(0.0, false);
+    engine->setSpeed(speed, false);
+    engine->resetTiming();
+    TEST_ASSERT_TRUE(engine->startPattern());
+}
+
+void test_RampReachesTargetOnTime(void) {
+    stepper->setSpeedInHz(2000);
+    stepper->setAcceleration(8000);
+    stepper->moveTo(3000);
+    int64_t duration = int64_t(trapezoidalMoveTime(3000, 2000, 8000) * 1.0e6);
+
+    Sim::runFor(duration - 50000);
+    TEST_ASSERT_TRUE(stepper->isRunning());
+    TEST_ASSERT_TRUE(stepper->getCurrentPosition() < 3000);
+
+    Sim::runFor(51000);
+    TEST_ASSERT_FALSE(stepper->isRunning());
+    TEST_ASSERT_EQUAL(3000, stepper->getCurrentPosition());
+    TEST_ASSERT_TRUE(stepper->getPeakSpeed() <= 2000.5);
+}
+
+void test_RampOvershootsCloseTarget(void) {
+    stepper->setSpeedInHz(2000);
+    stepper->setAcceleration(8000);
+    stepper->moveTo(3000);
+    Sim::runFor(500000);
+
+    // Too close to stop in time: overshoot and come back
+    int32_t position = stepper->getCurrentPosition();
+    stepper->moveTo(position);
+    Sim::runFor(50000);
+    TEST_ASSERT_TRUE(stepper->getCurrentPosition() > position);
+
+    Sim::runFor(2000000);
+    TEST_ASSERT_FALSE(stepper->isRunning());
+    TEST_ASSERT_EQUAL(position, stepper->getCurrentPosition());
+}
+
+void test_TimedMovesPlayInOrder(void) {
+    TEST_ASSERT_EQUAL(MOVE_TIMED_EMPTY,
+                      stepper->moveTimed(100, TICKS_PER_S / 100));
+    TEST_ASSERT_EQUAL(MOVE_TIMED_OK,
+                      stepper->moveTimed(-40, TICKS_PER_S / 100));
+    TEST_ASSERT_EQUAL(TICKS_PER_S / 50, stepper->ticksInQueue());
+
+    Sim::runFor(5000);
+    TEST_ASSERT_EQUAL(50, stepper->getCurrentPosition());
+    Sim::runFor(10000);
+    TEST_ASSERT_EQUAL(80, stepper->getCurrentPosition());
+    Sim::runFor(10000);
+    TEST_ASSERT_FALSE(stepper->isRunning());
+    TEST_ASSERT_EQUAL(60, stepper->getCurrentPosition());
+}
+
+void test_TasksRunInVirtualTime(void) {
+    auto start = std::chrono::steady_clock::now();
+    startPattern(0, LOOP_MOVE_COMPLETION);
+
+    // Ten minutes of SimpleStroke at 60 strokes per minute
+    Sim::runFor(600000000);
+    double wall = std::chrono::duration<double>(
+                      std::chrono::steady_clock::now() - start)
+                      .count();
+
+    StrokeTiming timing;
+    engine->getTiming(&timing);
+    TEST_ASSERT_TRUE(timing.period.count >= 1190);
+    TEST_ASSERT_TRUE(timing.period.mean() >= 98 &&
+                     timing.period.mean() <= 105);
+    TEST_ASSERT_TRUE(wall < 60.0);
+
+    printf("SimpleStroke: %u moves, period %u%%, latency %uus, "
+           "%.0fx real time, planning %lldns per move\n",
+           (unsigned)timing.period.count, (unsigned)timing.period.mean(),
+           (unsigned)timing.latency.mean(), 600.0 / wall,
+           (long long)(Sim::cpuTime("Planning") /
+                       (timing.period.count + 1)));
+}
+
+void test_SCurveKeepsRhythm(void) {
+    startPattern(0, LOOP_MOVE_COMPLETION);
+    engine->stopMotion();
+    engine->setJerk(100000.0);
+    engine->resetTiming();
+    uint32_t moves = stepper->getMoves();
+    TEST_ASSERT_TRUE(engine->startPattern());
+    Sim::runFor(120000000);
+
+    // Moves are fed into the command queue, the ramp generator stays unused
+    StrokeTiming timing;
+    engine->getTiming(&timing);
+    TEST_ASSERT_EQUAL(moves, stepper->getMoves());
+    TEST_ASSERT_TRUE(stepper->getQueueEntries() > 0);
+    // Each S-curve takes a little longer than the trapezoid it replaces
+    TEST_ASSERT_TRUE(timing.period.count >= 225);
+    TEST_ASSERT_TRUE(timing.period.mean() >= 98 &&
+                     timing.period.mean() <= 105);
+}
+
+void test_SCurveBrakesToAStop(void) {
+    startPattern(0, LOOP_MOVE_COMPLETION);
+    engine->stopMotion();
+    engine->setJerk(100000.0);
+    TEST_ASSERT_TRUE(engine->startPattern());
+
+    // Halfway through a stroke the queued slices play, then a tail brakes
+    Sim::runFor(2250000);
+    TEST_ASSERT_TRUE(stepper->isRunning());
+    TEST_ASSERT_TRUE(stepper->ticksInQueue() > 0);
+    int32_t position = stepper->getCurrentPosition();
+    int32_t queued = abs(stepper->targetPos() - position);
+    double speed = fabs(stepper->getQueueEndSpeed());
+    TEST_ASSERT_TRUE(speed > 0.0);
+    stepper->resetPeakSpeed();
+    engine->stopMotion();
+    TEST_ASSERT_FALSE(stepper->isRunning());
+
+    // Never faster than the last slice and within its braking distance,
+    // plus what was queued and the rest of the slice that was fed
+    double a = motor.maxAcceleration * motor.stepsPerMillimeter;
+    double j = 100000.0 * motor.stepsPerMillimeter;
+    double peak = fmin(a, sqrt(speed * j));
+    double braking = speed * (speed / peak + peak / j) / 2.0;
+    double slice = speed * SCURVE_SLICE_MS / 1000.0;
+    TEST_ASSERT_TRUE(stepper->getPeakSpeed() <= speed + 1.0);
+    int32_t travel = abs(stepper->getCurrentPosition() - position);
+    TEST_ASSERT_TRUE(travel > queued);
+    TEST_ASSERT_TRUE(travel <= queued + braking + slice + 2.0);
+
+    // The position stays where the steps took the motor
+    Sim::runFor(SCURVE_LOOKAHEAD_MS * 2000);
+    TEST_ASSERT_FALSE(stepper->isRunning());
+    TEST_ASSERT_EQUAL(stepper->targetPos(), stepper->getCurrentPosition());
+}
+
+void test_EveryPatternStaysInside(void) {
+    startPattern(0, LOOP_MOVE_COMPLETION, 90.0);
+    // Knot crawls at low sensations
+    engine->setSensation(50.0, false);
+    const int32_t maxSpeed = int32_t(666.0 * 20.0) * 1000;
+
+    for (unsigned int pattern = 0; pattern < engine->getNumberOfPattern();
+         pattern++) {
+        engine->stopMotion();
+        engine->setPattern(pattern, false);
+        engine->resetTiming();
+        uint32_t moves = stepper->getMoves();
+        TEST_ASSERT_TRUE(engine->startPattern());
+
+        // Two minutes per pattern, checked every 5ms
+        for (int i = 0; i < 24000; i++) {
+            Sim::runFor(5000);
+            int32_t position = stepper->getCurrentPosition();
+            TEST_ASSERT_TRUE(position >= 0 && position <= maxStep);
+            TEST_ASSERT_TRUE(abs(stepper->getCurrentSpeedInMilliHz()) <=
+                             maxSpeed);
+        }
+
+        StrokeTiming timing;
+        engine->getTiming(&timing);
+        printf("%-18s %5u moves, period %3u%%, reversal %6uus\n",
+               patternTable[pattern]->getName(),
+               (unsigned)(stepper->getMoves() - moves),
+               (unsigned)timing.period.mean(),
+               (unsigned)timing.reversal.mean());
+        TEST_ASSERT_TRUE(stepper->getMoves() - moves > 10);
+    }
+}
+
+void test_MoveCompletionBeatsPolling(void) {
+    startPattern(0, LOOP_POLLING);
+    Sim::runFor(120000000);
+    StrokeTiming polling;
+    engine->getTiming(&polling);
+
+    engine->stopMotion();
+    engine->setLoopMode(LOOP_MOVE_COMPLETION);
+    engine->resetTiming();
+    engine->startPattern();
+    Sim::runFor(120000000);
+    StrokeTiming completion;
+    engine->getTiming(&completion);
+
+    TEST_ASSERT_TRUE(completion.latency.mean() < polling.latency.mean());
+    TEST_ASSERT_TRUE(completion.latency.mean() < 1000);
+}
+
+void test_LoopTimerBeatsPolling(void) {
+    startPattern(0, LOOP_POLLING);
+    Sim::runFor(120000000);
+    StrokeTiming polling;
+    engine->getTiming(&polling);
+
+    engine->stopMotion();
+    engine->setLoopMode(LOOP_TIMER);
+    engine->setLoopRate(10000);
+    TEST_ASSERT_EQUAL(LOOP_RATE_MAX_HZ, engine->getLoopRate());
+    engine->resetTiming();
+    engine->startPattern();
+    Sim::runFor(120000000);
+    StrokeTiming timer;
+    engine->getTiming(&timer);
+
+    // Never later than one period of the loop timer
+    TEST_ASSERT_TRUE(timer.latency.mean() < polling.latency.mean());
+    TEST_ASSERT_TRUE(timer.latency.maximum <= 500);
+}
+
+void test_ScriptPlaysOnItsClock(void) {
+    static ScriptAction storage[64];
+    scriptPattern.buffer.begin(storage, 64);
+    scriptPattern.buffer.clear();
+    for (uint32_t i = 0; i < 40; i++) {
+        scriptPattern.buffer.push({1000 + 400 * i, uint8_t(i % 2 ? 100 : 0)});
+    }
+
+    engine->begin(&machine, &motor, stepper);
+    engine->setLoopMode(LOOP_MOVE_COMPLETION);
+    engine->thisIsHome();
+    Sim::runFor(2000000);
+    engine->setDepth(120.0, false);
+    engine->setStroke(80.0, false);
+
+    // The script is at 500ms when it starts
+    scriptPattern.clock.start(500, millis());
+    TEST_ASSERT_TRUE(engine->startScript());
+    int64_t start = Sim::now() - 500000;
+
+    // Every action is reached on time
+    int depth = int(120.0 * 20.0);
+    int out = depth - int(80.0 * 20.0);
+    for (uint32_t i = 1; i < 40; i++) {
+        Sim::runFor(start + (1000 + 400 * i) * 1000 - Sim::now());
+        int target = i % 2 ? depth : out;
+        TEST_ASSERT_TRUE(abs(stepper->getCurrentPosition() - target) <= 2);
+    }
+
+    // Without actions the machine holds its position
+    Sim::runFor(1000000);
+    int32_t position = stepper->getCurrentPosition();
+    Sim::runFor(1000000);
+    TEST_ASSERT_EQUAL(position, stepper->getCurrentPosition());
+    scriptPattern.clock.stop();
+}
+
+void test_RetargetBrakesWithoutOvershoot(void) {
+    startPattern(0, LOOP_MOVE_COMPLETION);
+
+    // Cruising out towards the depth at 120mm
+    while (stepper->getCurrentPosition() < 1300 ||
+           stepper->getCurrentSpeedInMilliHz() <= 0) {
+        Sim::runFor(1000);
+    }
+
+    // Too close to the new depth to stop with the acceleration of the stroke
+    engine->setDepth(80.0, true);
+    int depth = int(80.0 * 20.0);
+    int32_t peak = 0;
+    int32_t speed = stepper->getCurrentSpeedInMilliHz();
+    for (int i = 0; i < 500; i++) {
+        Sim::runFor(1000);
+        peak = max(peak, stepper->getCurrentPosition());
+
+        // Speed changes smoothly, never more than the machine can accelerate
+        int32_t now = stepper->getCurrentSpeedInMilliHz();
+        TEST_ASSERT_TRUE(abs(now - speed) <= int32_t(10000.0 * 20.0) + 1000);
+        speed = now;
+    }
+    TEST_ASSERT_TRUE(peak >= depth - 2 && peak <= depth + 2);
+
+    // The brake is counted, and printed without holding up the motion
+    ClipCounters clipping;
+    engine->getClipping(&clipping);
+    TEST_ASSERT_TRUE(clipping.events[CLIP_RETARGET] >= 1);
+}
+
+void test_SettingsApplyWithNextStroke(void) {
+    startPattern(0, LOOP_MOVE_COMPLETION);
+    Sim::runFor(3000000);
+
+    // Published to the motion tasks, picked up without applyNow as well
+    engine->setDepth(100.0, false);
+    engine->setStroke(40.0, false);
+    Sim::runFor(3000000);
+    int32_t lowest = maxStep;
+    int32_t highest = 0;
+    for (int i = 0; i < 3000; i++) {
+        Sim::runFor(1000);
+        lowest = min(lowest, stepper->getCurrentPosition());
+        highest = max(highest, stepper->getCurrentPosition());
+    }
+    TEST_ASSERT_INT_WITHIN(2, int(100.0 * 20.0), highest);
+    TEST_ASSERT_INT_WITHIN(2, int(60.0 * 20.0), lowest);
+    TEST_ASSERT_EQUAL_FLOAT(100.0, engine->getDepth());
+}
+
+void test_UpdateAppliesTogether(void) {
+    startPattern(0, LOOP_MOVE_COMPLETION);
+    Sim::runFor(3000000);
+
+    // Held back until the update ends, even though applyNow is asked for
+    engine->beginUpdate();
+    engine->setDepth(100.0, true);
+    Sim::runFor(2000000);
+    engine->setStroke(40.0, true);
+    int32_t highest = 0;
+    for (int i = 0; i < 3000; i++) {
+        Sim::runFor(1000);
+        highest = max(highest, stepper->getCurrentPosition());
+    }
+    TEST_ASSERT_INT_WITHIN(2, int(120.0 * 20.0), highest);
+
+    engine->endUpdate();
+    Sim::runFor(3000000);
+    int32_t lowest = maxStep;
+    highest = 0;
+    for (int i = 0; i < 3000; i++) {
+        Sim::runFor(1000);
+        lowest = min(lowest, stepper->getCurrentPosition());
+        highest = max(highest, stepper->getCurrentPosition());
+    }
+    TEST_ASSERT_INT_WITHIN(2, int(100.0 * 20.0), highest);
+    TEST_ASSERT_INT_WITHIN(2, int(60.0 * 20.0), lowest);
+}
+
+void test_TwistArrivesWithStroke(void) {
+    // Half a turn of twist at 800 steps per turn
+    machineGeometry twistTravel = {.physicalTravel = 180.0,
+                                   .keepoutBoundary = 0.0};
+    motorProperties twistMotor = {.maxSpeed = 720.0,
+                                  .maxAcceleration = 7200.0,
+                                  .stepsPerMillimeter = 800.0 / 360.0,
+                                  .invertDirection = false,
+                                  .enableActiveLow = true,
+                                  .stepPin = 17,
+                                  .directionPin = 16,
+                                  .enablePin = 4};
+    FastAccelStepper twist;
+    TEST_ASSERT_FALSE(engine->attachAxis(STROKE_ENGINE_AUX_AXES, &twistTravel,
+                                         &twistMotor, &twist));
+    TEST_ASSERT_TRUE(engine->attachAxis(0, &twistTravel, &twistMotor, &twist));
+
+    // Twist pattern at sensation 0 turns a quarter of the travel each way
+    startPattern(10, LOOP_MOVE_COMPLETION);
+    TEST_ASSERT_EQUAL_FLOAT(0.0, engine->getAxisPosition(0));
+    Sim::runFor(2000000);
+
+    int reversals = 0;
+    int32_t previous = stepper->getCurrentPosition();
+    int direction = 0;
+    for (int i = 0; i < 5000; i++) {
+        Sim::runFor(1000);
+        int32_t position = stepper->getCurrentPosition();
+        int now = position > previous ? 1 : position < previous ? -1 : 0;
+        previous = position;
+        if (now == 0) {
+            continue;
+        }
+
+        // Turned in with the stroke at the depth, back at the retract
+        if (direction != 0 && now != direction) {
+            float expected = position > 1600 ? 0.5 : -0.5;
+            TEST_ASSERT_FLOAT_WITHIN(0.02, expected,
+                                     engine->getAxisPosition(0));
+            reversals++;
+        }
+        direction = now;
+    }
+    TEST_ASSERT_TRUE(reversals >= 8);
+
+    // Nothing may touch the stepper once this test is over
+    engine->stopMotion();
+    TEST_ASSERT_TRUE(engine->attachAxis(0, &twistTravel, &twistMotor, NULL));
+    TEST_ASSERT_EQUAL_FLOAT(0.0, engine->getAxisPosition(0));
+}
+
+void test_SessionCountsStrokes(void) {
+    static SessionCounter session;
+    startPattern(0, LOOP_MOVE_COMPLETION);
+    session.reset(stepper->getCurrentPosition());
+    engine->setSessionCounter(&session);
+
+    // One minute of SimpleStroke at 60 strokes per minute, 80mm each way
+    Sim::runFor(60000000);
+    engine->setSessionCounter(NULL);
+    TEST_ASSERT_TRUE(session.getStrokes() >= 58 && session.getStrokes() <= 61);
+    TEST_ASSERT_TRUE(abs(int32_t(session.getSteps()) -
+                         int32_t(session.getStrokes()) * 2 * 1600) <= 3200);
+}
+
+// Edges seen by the segment callback
+static struct {
+    int starts;
+    int finishes;
+    int misplaced;
+    int repeated;
+    int from;
+    int to;
+    bool wasDeeper;
+} segments;
+
+static void onSegment(SegmentEdge edge, int from, int to) {
+    if (edge == SEGMENT_START) {
+        segments.starts++;
+        segments.from = from;
+        segments.to = to;
+        return;
+    }
+
+    // A finish belongs to the last start, and the servo is at its target
+    if (from != segments.from || to != segments.to ||
+        stepper->getCurrentPosition() != to) {
+        segments.misplaced++;
+    }
+    // SimpleStroke arrives at depth and retract in turns
+    bool isDeeper = to > from;
+    if (segments.finishes > 0 && isDeeper == segments.wasDeeper) {
+        segments.repeated++;
+    }
+    segments.wasDeeper = isDeeper;
+    segments.finishes++;
+}
+
+void test_SegmentEdgesFollowTheStroke(void) {
+    segments = {};
+    engine->registerSegmentCallback(onSegment);
+    startPattern(0, LOOP_MOVE_COMPLETION);
+
+    // 30 strokes of SimpleStroke at 60 strokes per minute
+    Sim::runFor(30000000);
+    engine->registerSegmentCallback(NULL);
+
+    TEST_ASSERT_EQUAL(0, segments.misplaced);
+    TEST_ASSERT_EQUAL(0, segments.repeated);
+    TEST_ASSERT_TRUE(segments.finishes >= 58 && segments.finishes <= 61);
+    TEST_ASSERT_TRUE(segments.starts - segments.finishes <= 1);
+}
+
+// A slider drag in text commands at 200Hz with binary stroke and depth frames
+// in between, a burst of writes and two writes that don't make it
+static std::vector<CommandCaptureRecord> sliderTrace() {
+    std::vector<CommandCaptureRecord> trace;
+    uint32_t start = 0xFFF00000;  // Wraps during the trace
+    for (uint32_t i = 0; i < 400; i++) {
+        char text[24];
+        int length = snprintf(text, sizeof(text), "set:speed:%u", 20 + i / 8);
+        trace.push_back(makeCaptureRecord(start + 5000 * i,
+                                          CaptureSource::text, text, length));
+        if (i % 2 == 0) {
+            uint8_t stroke = 40 + i / 20;
+            uint8_t frame[] = {0x06, 0x06, stroke, 0, 90, 0};
+            trace.push_back(makeCaptureRecord(start + 5000 * i + 2500,
+                                              CaptureSource::binary, frame,
+                                              sizeof(frame)));
+        }
+    }
+    for (int i = 0; i < 20; i++) {
+        const char *burst = "set:sensation:60";
+        trace.insert(trace.begin() + 300,
+                     makeCaptureRecord(trace[300].timeUs, CaptureSource::text,
+                                       burst, strlen(burst)));
+    }
+    const char *invalid = "set:speed:";
+    trace.insert(trace.begin() + 100,
+                 makeCaptureRecord(trace[100].timeUs, CaptureSource::text,
+                                   invalid, strlen(invalid)));
+    CommandCaptureRecord truncated = trace[200];
+    truncated.length = COMMAND_CAPTURE_DATA + 4;
+    trace.insert(trace.begin() + 200, truncated);
+    return trace;
+}
+
+void test_ReplayedWritesKeepUp(void) {
+    std::vector<CommandCaptureRecord> trace = sliderTrace();
+    startPattern(0, LOOP_MOVE_COMPLETION, 30.0);
+    Sim::runFor(1000000);
+    const char *name = "Slider trace";
+    ReplayStats stats = replayCapture(engine, trace.data(), trace.size(), 1.0,
+                                      maxStep / 20.0);
+    printReplayStats(name, stats);
+
+    TEST_ASSERT_EQUAL(trace.size(), stats.writes);
+    TEST_ASSERT_EQUAL(1, stats.rejected);
+    TEST_ASSERT_EQUAL(1, stats.truncated);
+    TEST_ASSERT_EQUAL(0, stats.dropped);
+    // The burst queues up, everything else is taken right away
+    TEST_ASSERT_TRUE(stats.maxQueueDepth >= 20);
+    TEST_ASSERT_TRUE(stats.p99LatencyUs <= 1000);
+    TEST_ASSERT_TRUE(stats.superseded >= 19);
+    TEST_ASSERT_TRUE(stats.durationUs < 2100000);
+
+    // The engine ends with the newest values
+    TEST_ASSERT_EQUAL_FLOAT((20 + 399 / 8) * 3, engine->getSpeed());
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 0.90 * maxStep / 20.0, engine->getDepth());
+
+    // Twenty times faster, the same writes still all get through
+    ReplayStats fast = replayCapture(engine, trace.data(), trace.size(), 20.0,
+                                     maxStep / 20.0);
+    printReplayStats("Slider trace x20", fast);
+    TEST_ASSERT_EQUAL(0, fast.dropped);
+    TEST_ASSERT_TRUE(fast.durationUs < 200000);
+    TEST_ASSERT_EQUAL_FLOAT((20 + 399 / 8) * 3, engine->getSpeed());
+
+    // A capture of a real app, OSSM_REPLAY_TRACE=<file> [OSSM_REPLAY_SPEEDUP]
+    const char *path = getenv("OSSM_REPLAY_TRACE");
+    if (path != nullptr) {
+        std::vector<CommandCaptureRecord> capture = loadCapture(path);
+        const char *speedup = getenv("OSSM_REPLAY_SPEEDUP");
+        TEST_ASSERT_TRUE_MESSAGE(!capture.empty(), path);
+        printReplayStats(path, replayCapture(engine, capture.data(),
+                                             capture.size(),
+                                             speedup ? atof(speedup) : 1.0,
+                                             maxStep / 20.0));
+    }
+}
+
+int runUnityTests() {
+    UNITY_BEGIN();
+    RUN_TEST(test_RampReachesTargetOnTime);
+    RUN_TEST(test_RampOvershootsCloseTarget);
+    RUN_TEST(test_TimedMovesPlayInOrder);
+    RUN_TEST(test_TasksRunInVirtualTime);
+    RUN_TEST(test_SCurveKeepsRhythm);
+    RUN_TEST(test_SCurveBrakesToAStop);
+    RUN_TEST(test_EveryPatternStaysInside);
+    RUN_TEST(test_MoveCompletionBeatsPolling);
+    RUN_TEST(test_LoopTimerBeatsPolling);
+    RUN_TEST(test_ScriptPlaysOnItsClock);
+    RUN_TEST(test_RetargetBrakesWithoutOvershoot);
+    RUN_TEST(test_SettingsApplyWithNextStroke);
+    RUN_TEST(test_UpdateAppliesTogether);
+    RUN_TEST(test_TwistArrivesWithStroke);
+    RUN_TEST(test_SessionCountsStrokes);
+    RUN_TEST(test_SegmentEdgesFollowTheStroke);
+    RUN_TEST(test_ReplayedWritesKeepUp);
+    return UNITY_END();
+}
+
+// WARNING!!! PLEASE REMOVE UNNECESSARY MAIN IMPLEMENTATIONS //
+
+/**
+ * For native dev-platform or for some embedded frameworks
+ */
+int main(void) { return runUnityTests(); }
@@ -0,0 +1,74 @@
+#include "unity.h"
+#include "utils/SpeedRamp.h"
+
+void setUp(void) {
+    // Set up before each test
+}
+
+void tearDown(void) {
+    // Clean up after each test
+}
+
+void test_EasingEndpoints(void) {
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, ease(Easing::inOutSine, 0.0f));
+    TEST_ASSERT_EQUAL_FLOAT(0.5f, ease(Easing::inOutSine, 0.5f));
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, ease(Easing::inOutSine, 1.0f));
+    TEST_ASSERT_EQUAL_FLOAT(0.25f, ease(Easing::linear, 0.25f));
+
+    // Progress outside of 0 to 1 is clamped
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, ease(Easing::linear, -1.0f));
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, ease(Easing::inOutSine, 2.0f));
+}
+
+void test_DefaultRampIsInactive(void) {
+    SpeedRamp ramp;
+    TEST_ASSERT_FALSE(ramp.isActive(0));
+    TEST_ASSERT_FALSE(ramp.isActive(12345));
+}
+
+void test_RampEasesToTarget(void) {
+    SpeedRamp ramp(80.0f, 0.0f, 1000, 2000);
+    TEST_ASSERT_TRUE(ramp.isActive(1000));
+    TEST_ASSERT_EQUAL_FLOAT(80.0f, ramp.at(1000));
+    TEST_ASSERT_EQUAL_FLOAT(40.0f, ramp.at(2000));
+    TEST_ASSERT_TRUE(ramp.at(1200) > 75.0f);
+    TEST_ASSERT_TRUE(ramp.at(2800) < 5.0f);
+
+    TEST_ASSERT_FALSE(ramp.isActive(3000));
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, ramp.at(3000));
+}
+
+void test_RampNeverRisesWhileSlowingDown(void) {
+    SpeedRamp ramp(100.0f, 10.0f, 0, 500);
+    float last = 100.0f;
+    for (uint32_t now = 0; now <= 600; now += 5) {
+        float speed = ramp.at(now);
+        TEST_ASSERT_TRUE(speed <= last);
+        TEST_ASSERT_TRUE(speed >= 10.0f);
+        last = speed;
+    }
+}
+
+void test_RampAcrossMillisWrap(void) {
+    SpeedRamp ramp(50.0f, 0.0f, 0xFFFFFF00, 0x200, Easing::linear);
+    TEST_ASSERT_TRUE(ramp.isActive(0x80));
+    TEST_ASSERT_EQUAL_FLOAT(12.5f, ramp.at(0x80));
+    TEST_ASSERT_FALSE(ramp.isActive(0x100));
+}
+
+int runUnityTests() {
+    UNITY_BEGIN();
+    RUN_TEST(test_EasingEndpoints);
+    RUN_TEST(test_DefaultRampIsInactive);
+    RUN_TEST(test_RampEasesToTarget);
+    RUN_TEST(test_RampNeverRisesWhileSlowingDown);
+    RUN_TEST(test_RampAcrossMillisWrap);
+    return UNITY_END();
+}
+
+// WARNING!!! PLEASE REMOVE UNNECESSARY MAIN IMPLEMENTATIONS //
+
+/**
+ * For native dev-platform or for some embedded frameworks
+ */
+int main(void) { return runUnityTests(); }
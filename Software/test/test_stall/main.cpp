@@ -0,0 +1,79 @@
+#include "unity.h"
+#include "utils/StallDetector.h"
+
+void setUp(void) {
+    // Set up before each test
+}
+
+void tearDown(void) {
+    // Clean up after each test
+}
+
+void test_NoStallWhileFree(void) {
+    StallDetector<4> detector(1.5f, 0.5f, 0);
+    for (int i = 0; i < 100; i++) {
+        TEST_ASSERT_FALSE(detector.update(0.3f));
+    }
+}
+
+void test_StallOverLimit(void) {
+    StallDetector<4> detector(1.5f, 10.0f, 0);
+    for (int i = 0; i < 20; i++) {
+        detector.update(0.3f);
+    }
+    for (int i = 0; i < 4; i++) {
+        detector.update(2.0f);
+    }
+    TEST_ASSERT_TRUE(detector.hasStalled());
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 2.0f, detector.getStallCurrent());
+}
+
+void test_StallOnStepChange(void) {
+    // Limit is never reached, the rise gives the stall away
+    StallDetector<4> detector(1.5f, 0.5f, 0);
+    for (int i = 0; i < 20; i++) {
+        detector.update(0.2f);
+    }
+    for (int i = 0; i < 4; i++) {
+        detector.update(1.0f);
+    }
+    TEST_ASSERT_TRUE(detector.hasStalled());
+}
+
+void test_BlankingIgnoresStartup(void) {
+    StallDetector<4> detector(1.5f, 0.5f, 50);
+    for (int i = 0; i < 20; i++) {
+        TEST_ASSERT_FALSE(detector.update(3.0f));
+    }
+    for (int i = 0; i < 40; i++) {
+        detector.update(0.3f);
+    }
+    TEST_ASSERT_FALSE(detector.hasStalled());
+}
+
+void test_ResetClearsStall(void) {
+    StallDetector<4> detector(1.5f, 0.5f, 0);
+    for (int i = 0; i < 8; i++) {
+        detector.update(3.0f);
+    }
+    TEST_ASSERT_TRUE(detector.hasStalled());
+    detector.reset();
+    TEST_ASSERT_FALSE(detector.hasStalled());
+}
+
+int runUnityTests() {
+    UNITY_BEGIN();
+    RUN_TEST(test_NoStallWhileFree);
+    RUN_TEST(test_StallOverLimit);
+    RUN_TEST(test_StallOnStepChange);
+    RUN_TEST(test_BlankingIgnoresStartup);
+    RUN_TEST(test_ResetClearsStall);
+    return UNITY_END();
+}
+
+// WARNING!!! PLEASE REMOVE UNNECESSARY MAIN IMPLEMENTATIONS //
+
+/**
+ * For native dev-platform or for some embedded frameworks
+ */
+int main(void) { return runUnityTests(); }
@@ -0,0 +1,80 @@
+#include "ossm/States.h"
+#include "unity.h"
+
+void setUp(void) {
+    // Set up before each test
+}
+
+void tearDown(void) {
+    // Clean up after each test
+}
+
+void test_NamesRoundTrip(void) {
+    for (size_t i = 0; i < stateCount; i++) {
+        StateId id = static_cast<StateId>(i);
+        TEST_ASSERT_EQUAL(i, (size_t)stateIdFromName(stateName(id)));
+    }
+}
+
+void test_IdsArePartOfTheProtocol(void) {
+    // Sent over BLE, see BLE_Protocol.md, so they must never move
+    TEST_ASSERT_EQUAL(0, (int)StateId::idle);
+    TEST_ASSERT_EQUAL(9, (int)StateId::strokeEngine);
+    TEST_ASSERT_EQUAL(27, (int)StateId::restart);
+    TEST_ASSERT_EQUAL(29, (int)StateId::autoTune);
+    TEST_ASSERT_EQUAL_STRING("strokeEngine.idle",
+                             stateName(StateId::strokeEngineIdle));
+}
+
+void test_UnknownNames(void) {
+    TEST_ASSERT_EQUAL((int)StateId::unknown, (int)stateIdFromName("nope"));
+    TEST_ASSERT_EQUAL((int)StateId::unknown, (int)stateIdFromName("menu.id"));
+    TEST_ASSERT_EQUAL_STRING("unknown", stateName(StateId::unknown));
+}
+
+void test_PrefixLookup(void) {
+    TEST_ASSERT_EQUAL((int)StateId::menu,
+                      (int)stateIdFromName("menu.idle", 4));
+    TEST_ASSERT_EQUAL((int)StateId::unknown,
+                      (int)stateIdFromName("menu.idle", 3));
+}
+
+void test_ModesOfSubStates(void) {
+    TEST_ASSERT_EQUAL((int)StateId::homing, (int)modeOf(StateId::homingQuick));
+    TEST_ASSERT_EQUAL((int)StateId::error, (int)modeOf(StateId::errorHelp));
+    TEST_ASSERT_EQUAL((int)StateId::autoTune,
+                      (int)modeOf(StateId::autoTuneRunning));
+    TEST_ASSERT_EQUAL((int)StateId::restart, (int)modeOf(StateId::restart));
+    TEST_ASSERT_EQUAL((int)StateId::unknown, (int)modeOf(StateId::unknown));
+}
+
+void test_EmergencyStopStates(void) {
+    TEST_ASSERT_TRUE(hasEmergencyStop(StateId::strokeEnginePattern));
+    TEST_ASSERT_TRUE(hasEmergencyStop(StateId::streamingPreflight));
+    TEST_ASSERT_TRUE(hasEmergencyStop(StateId::simplePenetrationIdle));
+    TEST_ASSERT_TRUE(hasEmergencyStop(StateId::autoTuneRunning));
+
+    // A long press only goes back to the menu from these
+    TEST_ASSERT_FALSE(hasEmergencyStop(StateId::simplePenetrationPreflight));
+    TEST_ASSERT_FALSE(hasEmergencyStop(StateId::autoTuneIdle));
+    TEST_ASSERT_FALSE(hasEmergencyStop(StateId::menuIdle));
+    TEST_ASSERT_FALSE(hasEmergencyStop(StateId::homingForward));
+}
+
+int runUnityTests() {
+    UNITY_BEGIN();
+    RUN_TEST(test_NamesRoundTrip);
+    RUN_TEST(test_IdsArePartOfTheProtocol);
+    RUN_TEST(test_UnknownNames);
+    RUN_TEST(test_PrefixLookup);
+    RUN_TEST(test_ModesOfSubStates);
+    RUN_TEST(test_EmergencyStopStates);
+    return UNITY_END();
+}
+
+// WARNING!!! PLEASE REMOVE UNNECESSARY MAIN IMPLEMENTATIONS //
+
+/**
+ * For native dev-platform or for some embedded frameworks
+ */
+int main(void) { return runUnityTests(); }
@@ -0,0 +1,246 @@
+#include <vector>
+
+#include "StepQueue.h"
+#include "unity.h"
+
+void setUp(void) {
+    // Set up before each test
+}
+
+void tearDown(void) {
+    // Clean up after each test
+}
+
+#define TICKS 16000000
+
+// Constant speed from 0 to end in duration
+class Ramp : public Trajectory {
+  public:
+    Ramp(float end, float duration) : _end(end), _duration(duration) {}
+    float getDuration() const override { return _duration; }
+    float positionAt(float time) const override {
+        return _end * time / _duration;
+    }
+
+  private:
+    float _end;
+    float _duration;
+};
+
+// Collects the commands of a slice and sums them up
+static std::vector<StepCommand> encode(int32_t steps, uint32_t ticks,
+                                       uint32_t minTicks, int32_t &moved,
+                                       uint64_t &duration) {
+    StepSlice slice;
+    slice.begin(steps, ticks, minTicks);
+    std::vector<StepCommand> commands;
+    StepCommand command;
+    moved = 0;
+    duration = 0;
+    while (slice.next(command)) {
+        commands.push_back(command);
+        moved += command.countUp ? command.steps : -command.steps;
+        duration += uint64_t(command.ticks) *
+                    (command.steps > 0 ? command.steps : 1);
+    }
+    TEST_ASSERT_EQUAL(slice.steps(), moved);
+    TEST_ASSERT_EQUAL(slice.ticksUsed(), duration);
+    return commands;
+}
+
+void test_FastSliceIsBatched(void) {
+    int32_t moved;
+    uint64_t duration;
+    std::vector<StepCommand> commands = encode(-600, 80000, 80, moved,
+                                               duration);
+    TEST_ASSERT_EQUAL(-600, moved);
+    TEST_ASSERT_EQUAL(80000 - 80000 % 600, duration);
+
+    // Three batches of 200 instead of 255, 255 and 90
+    TEST_ASSERT_EQUAL(3, commands.size());
+    for (const StepCommand &command : commands) {
+        TEST_ASSERT_EQUAL(200, command.steps);
+        TEST_ASSERT_EQUAL(133, command.ticks);
+        TEST_ASSERT_FALSE(command.countUp);
+    }
+}
+
+void test_SliceIsCutToTheTopSpeed(void) {
+    int32_t moved;
+    uint64_t duration;
+    encode(2000, 80000, 80, moved, duration);
+    TEST_ASSERT_EQUAL(1000, moved);
+    TEST_ASSERT_EQUAL(80000, duration);
+}
+
+void test_SlowStepsAndPausesAreSplit(void) {
+    int32_t moved;
+    uint64_t duration;
+    std::vector<StepCommand> commands = encode(1, 200000, 80, moved,
+                                               duration);
+    TEST_ASSERT_EQUAL(1, moved);
+    TEST_ASSERT_EQUAL(200000, duration);
+    TEST_ASSERT_EQUAL(1, commands[0].steps);
+    for (const StepCommand &command : commands) {
+        TEST_ASSERT_TRUE(command.ticks >= STEP_COMMAND_MAX_TICKS / 2);
+    }
+
+    commands = encode(0, 100000, 80, moved, duration);
+    TEST_ASSERT_EQUAL(0, moved);
+    TEST_ASSERT_EQUAL(100000, duration);
+    TEST_ASSERT_EQUAL(2, commands.size());
+    TEST_ASSERT_EQUAL(0, commands[1].steps);
+}
+
+void test_ExecutorPlaysTheTrajectory(void) {
+    Ramp ramp(1234.0, 0.5);
+    StepQueueExecutor executor;
+    executor.start(&ramp, -1, TICKS / 200, 80, TICKS);
+
+    int32_t position = 0;
+    uint64_t duration = 0;
+    auto push = [&](const StepCommand &command) {
+        position += command.countUp ? command.steps : -command.steps;
+        duration += uint64_t(command.ticks) *
+                    (command.steps > 0 ? command.steps : 1);
+        return true;
+    };
+    int slices = 0;
+    while (executor.feed(push)) {
+        slices++;
+        TEST_ASSERT_EQUAL(executor.getFed(), position);
+    }
+
+    TEST_ASSERT_FALSE(executor.isActive());
+    TEST_ASSERT_EQUAL(100, slices);
+    TEST_ASSERT_EQUAL(-1234, position);
+    // Time is kept to less than an interval
+    TEST_ASSERT_TRUE(duration <= TICKS / 2 && duration > TICKS / 2 - 6500);
+}
+
+void test_RefusedCommandIsOfferedAgain(void) {
+    Ramp ramp(600.0, 0.01);
+    StepQueueExecutor executor;
+    executor.start(&ramp, 1, TICKS / 200, 80, TICKS);
+
+    int32_t position = 0;
+    int room = 1;
+    auto push = [&](const StepCommand &command) {
+        if (room == 0) {
+            return false;
+        }
+        room--;
+        position += command.steps;
+        return true;
+    };
+
+    // Each slice of 300 steps takes two commands
+    TEST_ASSERT_FALSE(executor.feed(push));
+    TEST_ASSERT_EQUAL(150, position);
+    room = 1;
+    TEST_ASSERT_TRUE(executor.feed(push));
+    TEST_ASSERT_EQUAL(300, position);
+    room = 10;
+    TEST_ASSERT_TRUE(executor.feed(push));
+    TEST_ASSERT_FALSE(executor.feed(push));
+    TEST_ASSERT_EQUAL(600, position);
+}
+
+void test_StepsTooFastAreCaughtUp(void) {
+    // Three times as fast as the servo can step
+    Ramp ramp(3000.0, 0.01);
+    StepQueueExecutor executor;
+    executor.start(&ramp, 1, TICKS / 200, 80, TICKS);
+
+    int32_t position = 0;
+    auto push = [&](const StepCommand &command) {
+        position += command.steps;
+        return true;
+    };
+    int slices = 0;
+    while (executor.feed(push)) {
+        slices++;
+    }
+    TEST_ASSERT_EQUAL(3000, position);
+    TEST_ASSERT_EQUAL(3, slices);
+}
+
+void test_BrakingProfileStops(void) {
+    BrakingProfile profile;
+    TEST_ASSERT_FALSE(profile.plan(0.0, 20000.0, 400000.0));
+
+    // Reaches the top deceleration: v * (v / a + a / j) / 2
+    TEST_ASSERT_TRUE(profile.plan(-2000.0, 20000.0, 400000.0));
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 150.0, profile.getDistance());
+    TEST_ASSERT_FLOAT_WITHIN(1e-4, 0.15, profile.getDuration());
+    float last = 0.0;
+    float step = profile.getDuration() / 100;
+    for (int i = 1; i <= 100; i++) {
+        float position = profile.positionAt(i * step);
+        TEST_ASSERT_TRUE(position >= last);
+        TEST_ASSERT_TRUE(position - last <= 2000.0 * step + 1e-3);
+        last = position;
+    }
+
+    // Without jerk it is the plain v² / 2a
+    TEST_ASSERT_TRUE(profile.plan(2000.0, 20000.0, 0.0));
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 100.0, profile.getDistance());
+    TEST_ASSERT_FLOAT_WITHIN(1e-4, 0.1, profile.getDuration());
+}
+
+void test_BrakeFollowsTheQueuedSlices(void) {
+    // 2000 steps/s, mirrored
+    Ramp ramp(1000.0, 0.5);
+    StepQueueExecutor executor;
+    executor.start(&ramp, -1, TICKS / 200, 80, TICKS);
+
+    int32_t position = 0;
+    int32_t sliceSteps = 0;
+    auto push = [&](const StepCommand &command) {
+        int32_t steps = command.countUp ? command.steps : -command.steps;
+        position += steps;
+        sliceSteps += steps;
+        return true;
+    };
+    for (int i = 0; i < 10; i++) {
+        TEST_ASSERT_TRUE(executor.feed(push));
+    }
+    TEST_ASSERT_EQUAL(-100, position);
+
+    // The rest of the ramp is dropped, the tail brakes in 100 steps
+    TEST_ASSERT_TRUE(executor.brake(20000.0, 0.0));
+    TEST_ASSERT_TRUE(executor.isBraking());
+    int slices = 0;
+    for (;;) {
+        sliceSteps = 0;
+        if (executor.feed(push) == false) {
+            break;
+        }
+        slices++;
+        TEST_ASSERT_TRUE(sliceSteps <= 0 && sliceSteps >= -10);
+        TEST_ASSERT_EQUAL(executor.getFed(), position);
+    }
+    TEST_ASSERT_FALSE(executor.isActive());
+    TEST_ASSERT_EQUAL(20, slices);
+    TEST_ASSERT_EQUAL(-200, position);
+}
+
+int runUnityTests() {
+    UNITY_BEGIN();
+    RUN_TEST(test_FastSliceIsBatched);
+    RUN_TEST(test_SliceIsCutToTheTopSpeed);
+    RUN_TEST(test_SlowStepsAndPausesAreSplit);
+    RUN_TEST(test_ExecutorPlaysTheTrajectory);
+    RUN_TEST(test_RefusedCommandIsOfferedAgain);
+    RUN_TEST(test_StepsTooFastAreCaughtUp);
+    RUN_TEST(test_BrakingProfileStops);
+    RUN_TEST(test_BrakeFollowsTheQueuedSlices);
+    return UNITY_END();
+}
+
+// WARNING!!! PLEASE REMOVE UNNECESSARY MAIN IMPLEMENTATIONS //
+
+/**
+ * For native dev-platform or for some embedded frameworks
+ */
+int main(void) { return runUnityTests(); }
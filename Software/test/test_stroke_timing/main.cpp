@@ -0,0 +1,76 @@
+#include "StrokeTiming.h"
+#include "unity.h"
+
+void setUp(void) {
+    // Set up before each test
+}
+
+void tearDown(void) {
+    // Clean up after each test
+}
+
+void test_EmptyHistogram(void) {
+    TimingHistogram<0, 100> histogram;
+    histogram.reset();
+    TEST_ASSERT_EQUAL(0, histogram.count);
+    TEST_ASSERT_EQUAL(0, histogram.mean());
+    TEST_ASSERT_EQUAL(UINT32_MAX, histogram.minimum);
+}
+
+void test_ValuesLandInBuckets(void) {
+    TimingHistogram<80, 5> histogram;
+    histogram.reset();
+    histogram.record(100);
+    histogram.record(104);
+    histogram.record(105);
+    TEST_ASSERT_EQUAL(2, histogram.buckets[4]);
+    TEST_ASSERT_EQUAL(1, histogram.buckets[5]);
+    TEST_ASSERT_EQUAL(3, histogram.count);
+    TEST_ASSERT_EQUAL(100, histogram.minimum);
+    TEST_ASSERT_EQUAL(105, histogram.maximum);
+    TEST_ASSERT_EQUAL(103, histogram.mean());
+}
+
+void test_OutOfRangeIsClamped(void) {
+    TimingHistogram<80, 5> histogram;
+    histogram.reset();
+    histogram.record(10);
+    histogram.record(1000);
+    TEST_ASSERT_EQUAL(1, histogram.buckets[0]);
+    TEST_ASSERT_EQUAL(1, histogram.buckets[TIMING_BUCKETS - 1]);
+    TEST_ASSERT_EQUAL(10, histogram.minimum);
+    TEST_ASSERT_EQUAL(1000, histogram.maximum);
+}
+
+void test_BucketsSaturate(void) {
+    TimingHistogram<0, 1> histogram;
+    histogram.reset();
+    for (int i = 0; i < 70000; i++) {
+        histogram.record(0);
+    }
+    TEST_ASSERT_EQUAL(UINT16_MAX, histogram.buckets[0]);
+    TEST_ASSERT_EQUAL(70000, histogram.count);
+}
+
+void test_PackedLayout(void) {
+    // Sent as is over BLE, see BLE_Protocol.md
+    TEST_ASSERT_EQUAL(52, sizeof(TimingHistogram<0, 1>));
+    TEST_ASSERT_EQUAL(160, sizeof(StrokeTiming));
+}
+
+int runUnityTests() {
+    UNITY_BEGIN();
+    RUN_TEST(test_EmptyHistogram);
+    RUN_TEST(test_ValuesLandInBuckets);
+    RUN_TEST(test_OutOfRangeIsClamped);
+    RUN_TEST(test_BucketsSaturate);
+    RUN_TEST(test_PackedLayout);
+    return UNITY_END();
+}
+
+// WARNING!!! PLEASE REMOVE UNNECESSARY MAIN IMPLEMENTATIONS //
+
+/**
+ * For native dev-platform or for some embedded frameworks
+ */
+int main(void) { return runUnityTests(); }
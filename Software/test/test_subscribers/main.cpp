@@ -0,0 +1,99 @@
+#include <vector>
+
+#include "unity.h"
+#include "utils/SubscriberTable.h"
+
+static std::vector<uint16_t> sent;
+
+void setUp(void) { sent.clear(); }
+
+void tearDown(void) {
+    // Clean up after each test
+}
+
+static void send(uint16_t conn) { sent.push_back(conn); }
+
+void test_NewSubscriberIsCaughtUp(void) {
+    SubscriberTable<3> table;
+    table.subscribe(1);
+
+    TEST_ASSERT_EQUAL(1, table.catchUp(7, send));
+    TEST_ASSERT_EQUAL(1, sent.size());
+    TEST_ASSERT_EQUAL(1, sent[0]);
+
+    // Only once
+    TEST_ASSERT_EQUAL(0, table.catchUp(7, send));
+}
+
+void test_BroadcastCoversEveryone(void) {
+    SubscriberTable<3> table;
+    table.subscribe(1);
+    table.subscribe(2);
+    table.markAllSent(8);
+
+    TEST_ASSERT_EQUAL(0, table.catchUp(8, send));
+}
+
+void test_OnlyTheNewcomerIsCaughtUp(void) {
+    SubscriberTable<3> table;
+    table.subscribe(1);
+    table.markAllSent(8);
+    table.subscribe(2);
+
+    TEST_ASSERT_EQUAL(1, table.catchUp(8, send));
+    TEST_ASSERT_EQUAL(2, sent[0]);
+}
+
+void test_ResubscribingIsCaughtUpAgain(void) {
+    SubscriberTable<3> table;
+    table.subscribe(1);
+    table.markAllSent(8);
+    table.subscribe(1);
+
+    TEST_ASSERT_EQUAL(1, table.count());
+    TEST_ASSERT_EQUAL(1, table.catchUp(8, send));
+}
+
+void test_UnsubscribedAreSkipped(void) {
+    SubscriberTable<3> table;
+    table.subscribe(1);
+    table.subscribe(2);
+    table.unsubscribe(1);
+    table.unsubscribe(5);
+
+    TEST_ASSERT_EQUAL(1, table.count());
+    TEST_ASSERT_EQUAL(1, table.catchUp(8, send));
+    TEST_ASSERT_EQUAL(2, sent[0]);
+}
+
+void test_SlotsAreReused(void) {
+    SubscriberTable<2> table;
+    table.subscribe(1);
+    table.subscribe(2);
+    table.subscribe(3);
+    TEST_ASSERT_EQUAL(2, table.count());
+
+    table.unsubscribe(1);
+    table.subscribe(3);
+    TEST_ASSERT_EQUAL(2, table.count());
+    table.catchUp(8, send);
+    TEST_ASSERT_EQUAL(2, sent.size());
+}
+
+int runUnityTests() {
+    UNITY_BEGIN();
+    RUN_TEST(test_NewSubscriberIsCaughtUp);
+    RUN_TEST(test_BroadcastCoversEveryone);
+    RUN_TEST(test_OnlyTheNewcomerIsCaughtUp);
+    RUN_TEST(test_ResubscribingIsCaughtUpAgain);
+    RUN_TEST(test_UnsubscribedAreSkipped);
+    RUN_TEST(test_SlotsAreReused);
+    return UNITY_END();
+}
+
+// WARNING!!! PLEASE REMOVE UNNECESSARY MAIN IMPLEMENTATIONS //
+
+/**
+ * For native dev-platform or for some embedded frameworks
+ */
+int main(void) { return runUnityTests(); }
@@ -0,0 +1,105 @@
+#include "unity.h"
+#include "utils/TelemetryPacker.h"
+
+void setUp(void) {
+    // Set up before each test
+}
+
+void tearDown(void) {
+    // Clean up after each test
+}
+
+// Decodes a packet back into samples, the way a client would.
+static size_t unpack(const uint8_t *data, size_t length,
+                     TelemetrySample *samples) {
+    size_t count = data[2];
+    TelemetrySample sample = {};
+    memcpy(&sample.timeMs, data + 4, 4);
+    memcpy(&sample.position, data + 8, 4);
+    memcpy(&sample.velocity, data + 12, 4);
+    const uint8_t *bits = data + 16 + (count - 1) * 4;
+    TEST_ASSERT_EQUAL(length, 16 + (count - 1) * 4 + (count + 7) / 8);
+
+    for (size_t i = 0; i < count; i++) {
+        if (i > 0) {
+            int16_t deltas[2];
+            memcpy(deltas, data + 16 + (i - 1) * 4, 4);
+            sample.position += deltas[0];
+            sample.velocity += deltas[1];
+            sample.timeMs += data[3];
+        }
+        sample.clipping = (bits[i / 8] >> (i % 8)) & 1;
+        samples[i] = sample;
+    }
+    return count;
+}
+
+void test_RoundTrip(void) {
+    TelemetryPacker<244> packer;
+    packer.begin(7, 20, 244);
+
+    TelemetrySample input[20];
+    for (int i = 0; i < 20; i++) {
+        input[i] = {uint32_t(1000 + 20 * i), 5000 + 300 * i - 17 * i * i,
+                    -2000 + 150 * i, i % 3 == 0};
+        TEST_ASSERT_TRUE(packer.add(input[i]));
+    }
+    size_t length = packer.finish();
+
+    uint16_t sequence;
+    memcpy(&sequence, packer.data(), 2);
+    TEST_ASSERT_EQUAL(7, sequence);
+
+    TelemetrySample output[20];
+    TEST_ASSERT_EQUAL(20, unpack(packer.data(), length, output));
+    for (int i = 0; i < 20; i++) {
+        TEST_ASSERT_EQUAL(input[i].position, output[i].position);
+        TEST_ASSERT_EQUAL(input[i].velocity, output[i].velocity);
+        TEST_ASSERT_EQUAL(input[i].timeMs, output[i].timeMs);
+        TEST_ASSERT_EQUAL(input[i].clipping, output[i].clipping);
+    }
+}
+
+void test_FillsTheMtu(void) {
+    // Default MTU of 23 only fits a single sample
+    TEST_ASSERT_EQUAL(1, TelemetryPacker<244>::capacity(20));
+    TEST_ASSERT_EQUAL(56, TelemetryPacker<244>::capacity(244));
+
+    TelemetryPacker<244> packer;
+    packer.begin(0, 5, 244);
+    TelemetrySample sample = {0, 0, 0, false};
+    size_t count = 0;
+    while (packer.add(sample)) {
+        sample.position += 10;
+        count++;
+    }
+    TEST_ASSERT_EQUAL(56, count);
+    TEST_ASSERT_TRUE(packer.finish() <= 244);
+}
+
+void test_LargeDeltaStartsNewPacket(void) {
+    TelemetryPacker<244> packer;
+    packer.begin(0, 5, 244);
+    TEST_ASSERT_TRUE(packer.add({0, 0, 0, false}));
+    TEST_ASSERT_FALSE(packer.add({5, 40000, 0, false}));
+    TEST_ASSERT_EQUAL(1, packer.size());
+
+    // The rejected sample fits in a fresh packet
+    packer.begin(1, 5, 244);
+    TEST_ASSERT_TRUE(packer.add({5, 40000, 0, false}));
+}
+
+int runUnityTests() {
+    UNITY_BEGIN();
+    RUN_TEST(test_RoundTrip);
+    RUN_TEST(test_FillsTheMtu);
+    RUN_TEST(test_LargeDeltaStartsNewPacket);
+    return UNITY_END();
+}
+
+// WARNING!!! PLEASE REMOVE UNNECESSARY MAIN IMPLEMENTATIONS //
+
+/**
+ * For native dev-platform or for some embedded frameworks
+ */
+int main(void) { return runUnityTests(); }
@@ -0,0 +1,90 @@
+#include "unity.h"
+#include "utils/TraceRing.h"
+
+void setUp(void) {
+    // Set up before each test
+}
+
+void tearDown(void) {
+    // Clean up after each test
+}
+
+void test_EmptyTrace(void) {
+    TraceRing<int, 4> trace;
+    int out[4] = {};
+    TEST_ASSERT_EQUAL(0, trace.size());
+    TEST_ASSERT_EQUAL(0, trace.copyLatest(out, 4));
+}
+
+void test_CopiesOldestFirst(void) {
+    TraceRing<int, 4> trace;
+    int out[4] = {};
+    trace.record(1);
+    trace.record(2);
+    trace.record(3);
+
+    TEST_ASSERT_EQUAL(3, trace.copyLatest(out, 4));
+    TEST_ASSERT_EQUAL(1, out[0]);
+    TEST_ASSERT_EQUAL(2, out[1]);
+    TEST_ASSERT_EQUAL(3, out[2]);
+}
+
+void test_KeepsNewestWhenFull(void) {
+    TraceRing<int, 4> trace;
+    int out[4] = {};
+    for (int i = 1; i <= 10; i++) {
+        trace.record(i);
+    }
+
+    TEST_ASSERT_EQUAL(4, trace.size());
+    TEST_ASSERT_EQUAL(10, trace.getRecordedCount());
+    TEST_ASSERT_EQUAL(4, trace.copyLatest(out, 4));
+    TEST_ASSERT_EQUAL(7, out[0]);
+    TEST_ASSERT_EQUAL(10, out[3]);
+}
+
+void test_CopyLimitTakesNewest(void) {
+    TraceRing<int, 4> trace;
+    int out[2] = {};
+    for (int i = 1; i <= 6; i++) {
+        trace.record(i);
+    }
+
+    TEST_ASSERT_EQUAL(2, trace.copyLatest(out, 2));
+    TEST_ASSERT_EQUAL(5, out[0]);
+    TEST_ASSERT_EQUAL(6, out[1]);
+}
+
+void test_CopyFromPagesThroughHeld(void) {
+    TraceRing<int, 4> trace;
+    int out[4] = {};
+    for (int i = 1; i <= 6; i++) {
+        trace.record(i);
+    }
+
+    // Index 0 is the oldest record still held
+    TEST_ASSERT_EQUAL(2, trace.copyFrom(0, out, 2));
+    TEST_ASSERT_EQUAL(3, out[0]);
+    TEST_ASSERT_EQUAL(4, out[1]);
+    TEST_ASSERT_EQUAL(2, trace.copyFrom(2, out, 4));
+    TEST_ASSERT_EQUAL(5, out[0]);
+    TEST_ASSERT_EQUAL(6, out[1]);
+    TEST_ASSERT_EQUAL(0, trace.copyFrom(4, out, 4));
+}
+
+int runUnityTests() {
+    UNITY_BEGIN();
+    RUN_TEST(test_EmptyTrace);
+    RUN_TEST(test_CopiesOldestFirst);
+    RUN_TEST(test_KeepsNewestWhenFull);
+    RUN_TEST(test_CopyLimitTakesNewest);
+    RUN_TEST(test_CopyFromPagesThroughHeld);
+    return UNITY_END();
+}
+
+// WARNING!!! PLEASE REMOVE UNNECESSARY MAIN IMPLEMENTATIONS //
+
+/**
+ * For native dev-platform or for some embedded frameworks
+ */
+int main(void) { return runUnityTests(); }
@@ -0,0 +1,76 @@
+#include "unity.h"
+#include "utils/Xbm.h"
+
+// Two tile rows of a 16 pixel wide page buffer
+static uint8_t page[2 * 16];
+static uint8_t xbm[2 * 16];
+
+void setUp(void) {
+    memset(page, 0, sizeof(page));
+    memset(xbm, 0xAA, sizeof(xbm));
+}
+
+void tearDown(void) {
+    // Clean up after each test
+}
+
+void test_TopLeftPixel(void) {
+    page[0] = 0x01;
+    pageToXbm(page, 16, 8, 8, xbm);
+
+    TEST_ASSERT_EQUAL_HEX8(0x01, xbm[0]);
+    for (int y = 1; y < 8; y++) {
+        TEST_ASSERT_EQUAL_HEX8(0x00, xbm[y]);
+    }
+}
+
+void test_ColumnBecomesBitOfEachRow(void) {
+    // Third column fully set in the first tile row
+    page[2] = 0xFF;
+    pageToXbm(page, 16, 8, 8, xbm);
+
+    for (int y = 0; y < 8; y++) {
+        TEST_ASSERT_EQUAL_HEX8(0x04, xbm[y]);
+    }
+}
+
+void test_SecondTileRow(void) {
+    // Pixel at x 1, y 9
+    page[16 + 1] = 0x02;
+    pageToXbm(page, 16, 8, 12, xbm);
+
+    TEST_ASSERT_EQUAL_HEX8(0x00, xbm[8]);
+    TEST_ASSERT_EQUAL_HEX8(0x02, xbm[9]);
+    TEST_ASSERT_EQUAL_HEX8(0x00, xbm[10]);
+}
+
+void test_WideImagesUseTwoBytesPerRow(void) {
+    // Pixels at x 9, y 0 and x 0, y 1
+    page[9] = 0x01;
+    page[0] = 0x02;
+    pageToXbm(page, 16, 10, 2, xbm);
+
+    TEST_ASSERT_EQUAL(2, xbmRowBytes(10));
+    TEST_ASSERT_EQUAL_HEX8(0x00, xbm[0]);
+    TEST_ASSERT_EQUAL_HEX8(0x02, xbm[1]);
+    TEST_ASSERT_EQUAL_HEX8(0x01, xbm[2]);
+    TEST_ASSERT_EQUAL_HEX8(0x00, xbm[3]);
+    // Untouched past the image
+    TEST_ASSERT_EQUAL_HEX8(0xAA, xbm[4]);
+}
+
+int runUnityTests() {
+    UNITY_BEGIN();
+    RUN_TEST(test_TopLeftPixel);
+    RUN_TEST(test_ColumnBecomesBitOfEachRow);
+    RUN_TEST(test_SecondTileRow);
+    RUN_TEST(test_WideImagesUseTwoBytesPerRow);
+    return UNITY_END();
+}
+
+// WARNING!!! PLEASE REMOVE UNNECESSARY MAIN IMPLEMENTATIONS //
+
+/**
+ * For native dev-platform or for some embedded frameworks
+ */
+int main(void) { return runUnityTests(); }